@@ -253,24 +253,24 @@ bool ExtCaptureBridge::processSingleFrame()
 #ifdef KF5_WAYLAND_FLAGE_ON
     try {
         // 创建waylandFrame结构
-        WaylandIntegration::WaylandIntegrationPrivate::waylandFrame waylandFrame;
-        waylandFrame.timestamp = frame.timestamp;
-        waylandFrame.index = frame.index;
-        waylandFrame.width = frame.width;
-        waylandFrame.height = frame.height;
-        waylandFrame.stride = frame.stride;
+        WaylandFrame waylandFrame;
+        waylandFrame._time = frame.timestamp;
+        waylandFrame._index = frame.index;
+        waylandFrame._width = frame.width;
+        waylandFrame._height = frame.height;
+        waylandFrame._stride = frame.stride;
         
         // 复制帧数据
         size_t frameSize = static_cast<size_t>(frame.height * frame.stride);
-        waylandFrame.m_frame = new unsigned char[frameSize];
-        std::memcpy(waylandFrame.m_frame, frame.data, frameSize);
+        waylandFrame._frame = new unsigned char[frameSize];
+        std::memcpy(waylandFrame._frame, frame.data, frameSize);
         
         // 调用现有的编码逻辑
         if (m_recordAdmin && m_recordAdmin->m_pOutputStream) {
             int result = m_recordAdmin->m_pOutputStream->writeVideoFrame(waylandFrame);
             
             // 清理内存
-            delete[] waylandFrame.m_frame;
+            delete[] waylandFrame._frame;
             
             if (result >= 0) {
                 m_processedFrameCount++;
@@ -282,7 +282,7 @@ bool ExtCaptureBridge::processSingleFrame()
         }
         
         // 清理内存
-        delete[] waylandFrame.m_frame;
+        delete[] waylandFrame._frame;
         return false;
         
     } catch (const std::exception &e) {
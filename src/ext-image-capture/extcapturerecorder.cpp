@@ -7,6 +7,7 @@
 #include "extcaptureintegration.h"
 #include "extcaptureframebuffer.h"
 #include "../utils/log.h"
+#include "../utils/i420converter.h"
 
 #include <QDebug>
 #include <QDateTime>
@@ -167,6 +168,8 @@ void ExtCaptureRecorder::stopRecording()
     if (m_frameBuffer) {
         m_frameBuffer->setGetFrame(false);
     }
+
+    m_dmaBufMaps.clear();
 }
 
 ExtCaptureRecorder::RecordState ExtCaptureRecorder::state() const
@@ -308,10 +311,9 @@ void ExtCaptureRecorder::onFrameReady(const void *data, size_t size, int width,
     updateFrameTimestamps(static_cast<int64_t>(timestamp));
 
     if (m_streamingMode && m_ffmpegProcess && m_ffmpegProcess->state() == QProcess::Running) {
-        // 流式编码模式：直接写入FFmpeg
-        qint64 bytesWritten = m_ffmpegProcess->write(static_cast<const char*>(data), static_cast<qint64>(size));
-        if (bytesWritten != static_cast<qint64>(size)) {
-            qCWarning(dsrApp) << "ExtCaptureRecorder::onFrameReady: Failed to write complete frame, expected:" << size << "written:" << bytesWritten;
+        // 流式编码模式：转换为 I420 后写入FFmpeg
+        if (!writeI420Frame(m_ffmpegProcess, data, width, height, stride)) {
+            qCWarning(dsrApp) << "ExtCaptureRecorder::onFrameReady: Failed to write complete frame, size:" << size;
         }
     } else if (!m_streamingMode) {
         // 缓冲模式：添加帧到缓冲区
@@ -486,8 +488,8 @@ bool ExtCaptureRecorder::createVideoFile()
         }
     }
     
-    // 使用FFmpeg创建视频文件 - WL_SHM_FORMAT_XBGR8888 正确映射为 rgba 格式
-    QString ffmpegCmd = QString("ffmpeg -y -f rawvideo -pix_fmt rgba -s %1x%2 -r %3 -i - -c:v libx264 -pix_fmt yuv420p \"%4\"")
+    // 使用FFmpeg创建视频文件 - WL_SHM_FORMAT_XBGR8888 在进程内转换为 yuv420p 后写入
+    QString ffmpegCmd = QString("ffmpeg -y -f rawvideo -pix_fmt yuv420p -s %1x%2 -r %3 -i - -c:v libx264 -pix_fmt yuv420p \"%4\"")
                        .arg(m_frameWidth)
                        .arg(m_frameHeight)
                        .arg(m_frameRate)
@@ -508,10 +510,8 @@ bool ExtCaptureRecorder::createVideoFile()
     while (m_frameBuffer->hasFrames()) {
         ExtFrameData frame;
         if (m_frameBuffer->getFrame(frame)) {
-            // 写入原始帧数据到FFmpeg stdin
-            qint64 bytesWritten = ffmpegProcess.write(reinterpret_cast<const char*>(frame.data), 
-                                                    frame.height * frame.stride);
-            if (bytesWritten != frame.height * frame.stride) {
+            // 转换为 I420 后写入FFmpeg stdin
+            if (!writeI420Frame(&ffmpegProcess, frame.data, frame.width, frame.height, frame.stride)) {
                 qCWarning(dsrApp) << "ExtCaptureRecorder::createVideoFile: Failed to write frame" << frame.index;
                 break;
             }
@@ -579,8 +579,8 @@ bool ExtCaptureRecorder::startFFmpegProcess()
         }
     }
     
-    // 构建FFmpeg命令 - WL_SHM_FORMAT_XBGR8888 正确映射为 rgba 格式
-    QString ffmpegCmd = QString("ffmpeg -y -f rawvideo -pix_fmt rgba -s %1x%2 -r %3 -i - -c:v libx264 -pix_fmt yuv420p \"%4\"")
+    // 构建FFmpeg命令 - WL_SHM_FORMAT_XBGR8888 在进程内转换为 yuv420p 后写入
+    QString ffmpegCmd = QString("ffmpeg -y -f rawvideo -pix_fmt yuv420p -s %1x%2 -r %3 -i - -c:v libx264 -pix_fmt yuv420p \"%4\"")
                        .arg(m_frameWidth)
                        .arg(m_frameHeight)
                        .arg(m_frameRate)
@@ -731,16 +731,14 @@ bool ExtCaptureRecorder::processDmaBufferFrame(int dmaBufferFd, void *gbmBo, int
     // qCWarning(dsrApp) << "ExtCaptureRecorder::processDmaBufferFrame: Processing DMA Buffer with hardware pipeline, size:" << frame_size;
     
     QByteArray frame_data;
-    void *mapped_data = nullptr;
+    DmaBufMapCache::Access access;
     
-    // 方法1：首先尝试直接mmap DMA Buffer FD（这是标准方法）
+    // 方法1：首先尝试直接mmap DMA Buffer FD（这是标准方法），同一块缓冲区复用已有映射
     // qCWarning(dsrApp) << "ExtCaptureRecorder::processDmaBufferFrame: Attempting standard DMA-BUF mmap, fd:" << dmaBufferFd;
-    mapped_data = mmap(nullptr, frame_size, PROT_READ, MAP_SHARED, dmaBufferFd, 0);
-    
-    if (mapped_data != MAP_FAILED) {
+    if (m_dmaBufMaps.beginRead(dmaBufferFd, frame_size, access)) {
         // qCWarning(dsrApp) << "ExtCaptureRecorder::processDmaBufferFrame: *** SUCCESS! *** DMA-BUF mmap worked, copying real screen data";
-        frame_data = QByteArray(static_cast<const char*>(mapped_data), frame_size);
-        munmap(mapped_data, frame_size);
+        frame_data = QByteArray(reinterpret_cast<const char*>(access.data()), frame_size);
+        access.end();
     } else {
         int error_code = errno;
         // qCWarning(dsrApp) << "ExtCaptureRecorder::processDmaBufferFrame: DMA-BUF mmap failed with errno:" << error_code << strerror(error_code);
@@ -814,6 +812,24 @@ bool ExtCaptureRecorder::processDmaBufferFrame(int dmaBufferFd, void *gbmBo, int
 #endif
 }
 
+bool ExtCaptureRecorder::writeI420Frame(QIODevice *device, const void *data, int width, int height, int stride)
+{
+    const size_t frameSize = I420Converter::bufferSize(width, height);
+    if (!device || !data || frameSize == 0) {
+        return false;
+    }
+    if (static_cast<size_t>(m_i420Buffer.size()) != frameSize) {
+        m_i420Buffer.resize(static_cast<int>(frameSize));
+    }
+    uint8_t *buffer = reinterpret_cast<uint8_t *>(m_i420Buffer.data());
+    if (!I420Converter::convert(static_cast<const uint8_t *>(data), stride, I420Converter::RGBX, width, height,
+                                I420Converter::packedPlanes(buffer, width, height))) {
+        qCWarning(dsrApp) << "ExtCaptureRecorder::writeI420Frame: Invalid frame" << width << "x" << height << "stride:" << stride;
+        return false;
+    }
+    return device->write(m_i420Buffer.constData(), m_i420Buffer.size()) == m_i420Buffer.size();
+}
+
 void ExtCaptureRecorder::updateFrameTimestamps(int64_t timestamp)
 {
     qint64 frameTimestampNs = timestamp;
@@ -25,6 +25,8 @@
 #include <algorithm>
 #include <QDateTime>
 
+#include "../utils/dmabufmapcache.h"
+
 class ExtCaptureIntegration;
 class ExtCaptureFrameBuffer;
 
@@ -154,6 +156,11 @@ private:
     bool startFFmpegProcess();
     bool startDmaFFmpegProcess();
     bool processDmaBufferFrame(int dmaBufferFd, void *gbmBo, int width, int height, int stride);
+    /**
+     * @brief 将一帧 XBGR8888（内存中 RGBX）画面转换为 I420 后写入编码进程
+     * 传给 FFmpeg 的数据量减少到原来的 3/8，颜色转换也不再由 FFmpeg 进程完成
+     */
+    bool writeI420Frame(QIODevice *device, const void *data, int width, int height, int stride);
     void updateFrameTimestamps(int64_t timestamp);
     bool adjustVideoDurationIfNeeded();
     ExtCaptureIntegration *m_extCapture;
@@ -177,6 +184,7 @@ private:
     bool m_streamingMode;
     bool m_ffmpegStarted;
     QByteArray m_firstFrameBuffer;
+    QByteArray m_i420Buffer;    // 复用的 I420 转换缓冲区
     
     // 首帧参数（用于DMA Buffer处理）
     int m_firstFrameWidth;
@@ -187,6 +195,9 @@ private:
     qint64 m_firstFrameTimestampNs;
     qint64 m_lastFrameTimestampNs;
     QElapsedTimer m_wallClockTimer;
+
+    // DMA Buffer 映射缓存，合成器轮换使用的缓冲区只映射一次
+    DmaBufMapCache m_dmaBufMaps;
 };
 
 #endif // EXTCAPTURERECORDER_H
@@ -425,6 +425,7 @@ void MultiScreenCaptureCoordinator::cleanupSessions()
     m_screenLayouts.clear();
     m_screenFrames.clear();
     m_virtualDesktopSize = QSize();
+    m_dmaBufMaps.clear();
 }
 
 void* MultiScreenCaptureCoordinator::getWaylandOutput(QScreen* screen)
@@ -547,16 +548,14 @@ QByteArray MultiScreenCaptureCoordinator::extractDmaBufferData(int dmaBufferFd,
     qCDebug(dsrApp) << "MultiScreenCaptureCoordinator::extractDmaBufferData: Extracting DMA Buffer data, size:" << frame_size;
     
     QByteArray frame_data;
-    void *mapped_data = nullptr;
+    DmaBufMapCache::Access access;
     
-    // 方法1：首先尝试直接mmap DMA Buffer FD（这是标准方法）
+    // 方法1：首先尝试直接mmap DMA Buffer FD（这是标准方法），同一块缓冲区复用已有映射
     qCDebug(dsrApp) << "MultiScreenCaptureCoordinator::extractDmaBufferData: Attempting standard DMA-BUF mmap, fd:" << dmaBufferFd;
-    mapped_data = mmap(nullptr, frame_size, PROT_READ, MAP_SHARED, dmaBufferFd, 0);
-    
-    if (mapped_data != MAP_FAILED) {
+    if (m_dmaBufMaps.beginRead(dmaBufferFd, frame_size, access)) {
         qCDebug(dsrApp) << "MultiScreenCaptureCoordinator::extractDmaBufferData: *** SUCCESS! *** DMA-BUF mmap worked, copying real screen data";
-        frame_data = QByteArray(static_cast<const char*>(mapped_data), frame_size);
-        munmap(mapped_data, frame_size);
+        frame_data = QByteArray(reinterpret_cast<const char*>(access.data()), frame_size);
+        access.end();
     } else {
         int error_code = errno;
         qCDebug(dsrApp) << "MultiScreenCaptureCoordinator::extractDmaBufferData: DMA-BUF mmap failed with errno:" << error_code << strerror(error_code);
@@ -15,6 +15,8 @@
 #include <QMutex>
 #include <QTimer>
 
+#include "../utils/dmabufmapcache.h"
+
 class ExtCaptureManager;
 class ExtCaptureSession;
 class MultiScreenFrameCompositor;
@@ -216,6 +218,7 @@ private:
     QMutex m_frameMutex;                                    // 帧数据保护锁
     MultiScreenFrameCompositor* m_compositor;               // 帧拼接器（后续实现）
     QTimer* m_syncTimer;                                    // 同步定时器
+    DmaBufMapCache m_dmaBufMaps;                            // 各屏 DMA Buffer 的映射缓存
 };
 
 #endif // MULTISCREENCAPTURECOORDINATOR_H
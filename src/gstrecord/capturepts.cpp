@@ -0,0 +1,22 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "capturepts.h"
+
+uint64_t CapturePts::fromCaptureTime(uint64_t runningTimeNs, int64_t nowUs, int64_t captureTimeUs, uint64_t &lastPts)
+{
+    uint64_t pts = runningTimeNs;
+    if (captureTimeUs >= 0) {
+        //采集时间晚于推入时间（时钟误差）时不做调整
+        const int64_t ageNs = (nowUs - captureTimeUs) * 1000;
+        if (ageNs > 0) {
+            pts = pts > static_cast<uint64_t>(ageNs) ? pts - static_cast<uint64_t>(ageNs) : 0;
+        }
+    }
+    if (lastPts != NoPts && pts <= lastPts) {
+        pts = lastPts + 1;
+    }
+    lastPts = pts;
+    return pts;
+}
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CAPTUREPTS_H
+#define CAPTUREPTS_H
+
+#include <cstdint>
+
+/**
+ * @brief Wayland GStreamer 录屏把帧的采集时间换算为管道运行时间，与 GStreamer 无关，便于单独测试
+ *
+ * 管道时钟可能是音频时钟，与 CLOCK_MONOTONIC 起点不同：用推入时的运行时间减去这一帧从采集到推入经过的时长。
+ * 编码器要求时间戳严格递增，不大于上一帧的 PTS 时取上一帧加 1 纳秒。
+ */
+class CapturePts
+{
+public:
+    /**
+     * @brief 还没有写入过帧，与 GST_CLOCK_TIME_NONE 相同
+     */
+    static constexpr uint64_t NoPts = UINT64_MAX;
+
+    /**
+     * @param runningTimeNs 推入时管道的运行时间（纳秒）
+     * @param nowUs 推入时的 CLOCK_MONOTONIC 时间（微秒）
+     * @param captureTimeUs 采集时的 CLOCK_MONOTONIC 时间（微秒），小于 0 时使用 runningTimeNs
+     * @param lastPts 上一帧的 PTS，NoPts 表示第一帧；返回前更新为本帧的 PTS
+     * @return 本帧的 PTS（纳秒）
+     */
+    static uint64_t fromCaptureTime(uint64_t runningTimeNs, int64_t nowUs, int64_t captureTimeUs, uint64_t &lastPts);
+};
+
+#endif // CAPTUREPTS_H
@@ -0,0 +1,266 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "gstencoderselector.h"
+#include "../utils/configsettings.h"
+#include "../utils/log.h"
+
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QThread>
+#include <QtConcurrent>
+
+std::atomic<int> GstEncoderSelector::m_benchmarkGeneration(0);
+
+QList<GstEncoderSelector::Encoder> GstEncoderSelector::encoders(GstRecordX::VideoType videoType, bool h264Mkv)
+{
+    QList<Encoder> list;
+    if (videoType == GstRecordX::VideoType::ogg) {
+        //ogg不支持vp8编码，需使用theora编码，该编码器基于vp3,编码效率低，生成的视频容存在时长不正确的问题
+        list << Encoder{"theoraenc",
+                        "theoraenc  bitrate=2200 drop-frames=false keyframe-auto=false keyframe-force=5 keyframe-freq=5",
+                        "oggmux", "ogg"};
+        return list;
+    }
+    //vp8/vp9：不缓存帧（lag-in-frames=0），按核数开线程
+    list << Encoder{"vp8enc",
+                    "vp8enc min-quantizer=1 max-quantizer=50 undershoot=95 cpu-used=5 deadline=1 static-threshold=50 "
+                    "error-resilient=1 lag-in-frames=0 threads=%1 keyframe-max-dist=%2",
+                    "webmmux", "webm"};
+    //输入为 BGRx/RGBA，不限定格式时 videoconvert 会协商出 Y444（VP9 profile 1、H.264 High 4:4:4），很多播放器无法解码
+    list << Encoder{"vp9enc",
+                    "video/x-raw, format=I420 ! vp9enc min-quantizer=1 max-quantizer=50 undershoot=95 cpu-used=8 deadline=1 static-threshold=50 "
+                    "error-resilient=1 lag-in-frames=0 threads=%1 tile-columns=2 keyframe-max-dist=%2",
+                    "webmmux", "webm"};
+    if (!h264Mkv) {
+        return list;
+    }
+    //webm 不能封装 H.264，改用 matroska 容器；h264parse 转换为 matroskamux 要求的 avc 格式
+    list << Encoder{"x264enc",
+                    "video/x-raw, format=I420 ! x264enc speed-preset=ultrafast tune=zerolatency pass=qual quantizer=23 threads=%1 key-int-max=%2 ! h264parse",
+                    "matroskamux", "mkv"};
+    list << Encoder{"openh264enc",
+                    "openh264enc usage-type=screen complexity=low rate-control=quality multi-thread=%1 gop-size=%2 ! h264parse",
+                    "matroskamux", "mkv"};
+    return list;
+}
+
+QList<GstEncoderSelector::Encoder> GstEncoderSelector::candidates(GstRecordX::VideoType videoType)
+{
+    return encoders(videoType, ConfigSettings::instance()->getValue("recorder", "gst_h264_mkv").toBool());
+}
+
+QString GstEncoderSelector::encoderElement(const Encoder &encoder, int framerate)
+{
+    if (!encoder.element.contains("%1")) {
+        return encoder.element;
+    }
+    //关键帧间隔 5 秒
+    return encoder.element.arg(qMax(QThread::idealThreadCount(), 1)).arg(qMax(framerate, 1) * 5);
+}
+
+GstEncoderSelector::Encoder GstEncoderSelector::select(GstRecordX::VideoType videoType, const QSize &size, int framerate)
+{
+    const QList<Encoder> list = candidates(videoType);
+    if (list.size() == 1) {
+        return list.first();
+    }
+
+    const int index = cachedIndex(list, size, framerate);
+    if (index < 0) {
+        qCInfo(dsrApp) << "No GStreamer encoder benchmark covers" << size << framerate << "fps, using" << list.first().name;
+        return list.first();
+    }
+    qCInfo(dsrApp) << "Using cached GStreamer encoder:" << list.at(index).name;
+    return list.at(index);
+}
+
+bool GstEncoderSelector::needsBenchmark(GstRecordX::VideoType videoType, const QSize &size, int framerate)
+{
+    const QList<Encoder> list = candidates(videoType);
+    return list.size() > 1 && cachedIndex(list, size, framerate) < 0;
+}
+
+void GstEncoderSelector::benchmarkInBackground(GstRecordX::VideoType videoType, const QSize &size, int framerate)
+{
+    if (!needsBenchmark(videoType, size, framerate)) {
+        return;
+    }
+    //在调用线程取得代数，后台线程尚未开始时开始录制也能取消；之后的测速不会让这次测速恢复
+    const int generation = beginBenchmark();
+    gstInterface::initFunctions();
+    QtConcurrent::run([videoType, size, framerate, generation]() {
+        if (isCancelled(generation)) {
+            return;
+        }
+        int argc = 1;
+        gstInterface::m_gst_init(&argc, nullptr);
+        runBenchmark(videoType, size, framerate, generation);
+    });
+}
+
+int GstEncoderSelector::beginBenchmark()
+{
+    return ++m_benchmarkGeneration;
+}
+
+bool GstEncoderSelector::isCancelled(int generation)
+{
+    return m_benchmarkGeneration.load() != generation;
+}
+
+void GstEncoderSelector::runBenchmark(GstRecordX::VideoType videoType, const QSize &size, int framerate, int generation)
+{
+    const QList<Encoder> list = candidates(videoType);
+    QList<double> fps;
+    for (const Encoder &encoder : list) {
+        if (isCancelled(generation)) {
+            qCInfo(dsrApp) << "GStreamer encoder benchmark cancelled";
+            return;
+        }
+        fps << benchmark(encoder, size, framerate, generation);
+        if (isCancelled(generation)) {
+            //录制开始了，不与录制争抢 CPU，结果不完整也不缓存
+            qCInfo(dsrApp) << "GStreamer encoder benchmark cancelled";
+            return;
+        }
+        qCInfo(dsrApp) << "GStreamer encoder benchmark:" << encoder.name << size << "fps:" << fps.last();
+    }
+    const int index = pick(fps);
+    if (index < 0) {
+        qCWarning(dsrApp) << "No GStreamer encoder passed the benchmark";
+        return;
+    }
+    if (fps.at(index) < framerate) {
+        qCWarning(dsrApp) << "No GStreamer encoder reaches" << framerate << "fps, fastest:" << list.at(index).name;
+    }
+    ConfigSettings::instance()->setValue("recorder", "gst_encoder_bench", benchResult(list.at(index).name, size, framerate, list));
+}
+
+void GstEncoderSelector::cancelBenchmark()
+{
+    ++m_benchmarkGeneration;
+}
+
+int GstEncoderSelector::cachedIndex(const QList<Encoder> &list, const QSize &size, int framerate)
+{
+    //手动指定的编码器不在候选中（如 webm 未开启 gst_h264_mkv 时指定 x264enc）时忽略
+    const int manual = indexOf(list, ConfigSettings::instance()->getValue("recorder", "gst_encoder").toString());
+    if (manual >= 0) {
+        return manual;
+    }
+    //测速结果只在测速条件覆盖本次录制、且候选编码器与测速时一致时使用
+    const QStringList result = ConfigSettings::instance()->getValue("recorder", "gst_encoder_bench").toString().split(';');
+    if (result.size() != 3 || !benchCovers(result.at(1), size, framerate) || result.at(2) != candidateNames(list)) {
+        return -1;
+    }
+    return indexOf(list, result.at(0));
+}
+
+int GstEncoderSelector::indexOf(const QList<Encoder> &list, const QString &name)
+{
+    if (name.isEmpty()) {
+        return -1;
+    }
+    for (int i = 0; i < list.size(); i++) {
+        if (list.at(i).name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+double GstEncoderSelector::benchmark(const Encoder &encoder, const QSize &size, int framerate, int generation)
+{
+    const int frames = qMax(framerate, 1);
+    //画面横向移动，避免静止画面被编码器跳过；不同步时钟，按编码器的最快速度运行
+    const QString line = QString("videotestsrc num-buffers=%1 pattern=smpte horizontal-speed=4 ! "
+                                 "video/x-raw, format=I420, width=%2, height=%3, framerate=%4/1 ! %5 ! fakesink sync=false")
+                             .arg(frames)
+                             .arg(size.width() & ~1)
+                             .arg(size.height() & ~1)
+                             .arg(frames)
+                             .arg(encoderElement(encoder, framerate));
+    GError *error = nullptr;
+    GstElement *pipeline = gstInterface::m_gst_parse_launch(line.toUtf8().constData(), &error);
+    if (error != nullptr) {
+        qCDebug(dsrApp) << "GStreamer encoder" << encoder.name << "unavailable:" << error->message;
+        gstInterface::m_g_error_free(error);
+        if (pipeline) {
+            gstInterface::m_gst_object_unref(pipeline);
+        }
+        return -1;
+    }
+    if (nullptr == pipeline) {
+        return -1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    double fps = -1;
+    if (gstInterface::m_gst_element_set_state(pipeline, GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE) {
+        //分段等待，取消后最多 100 毫秒就停止
+        GstMessage *msg = nullptr;
+        while (nullptr == msg && !isCancelled(generation) && timer.elapsed() < BenchmarkTimeoutMs) {
+            msg = gstInterface::m_gst_bus_timed_pop_filtered(GST_ELEMENT_BUS(pipeline), 100 * GST_MSECOND,
+                                                             static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+        }
+        if (nullptr == msg) {
+            //超时说明一秒的画面在数秒内都编不完，远低于目标帧率
+            fps = isCancelled(generation) ? -1 : 0;
+        } else {
+            if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS) {
+                fps = frames * 1000.0 / qMax<qint64>(timer.elapsed(), 1);
+            }
+            gstInterface::m_gst_mini_object_unref(GST_MINI_OBJECT_CAST(msg));
+        }
+    }
+    gstInterface::m_gst_element_set_state(pipeline, GST_STATE_NULL);
+    gstInterface::m_gst_object_unref(pipeline);
+    return fps;
+}
+
+int GstEncoderSelector::pick(const QList<double> &fps)
+{
+    int index = -1;
+    for (int i = 0; i < fps.size(); i++) {
+        if (fps.at(i) < 0) {
+            continue;
+        }
+        if (index < 0 || fps.at(i) > fps.at(index)) {
+            index = i;
+        }
+    }
+    return index;
+}
+
+bool GstEncoderSelector::benchCovers(const QString &bench, const QSize &size, int framerate)
+{
+    static const QRegularExpression pattern("^(\\d+)x(\\d+)@(\\d+)$");
+    const QRegularExpressionMatch match = pattern.match(bench);
+    if (!match.hasMatch()) {
+        return false;
+    }
+    const qint64 measured = match.captured(1).toLongLong() * match.captured(2).toLongLong() * match.captured(3).toLongLong();
+    return measured >= static_cast<qint64>(size.width()) * size.height() * framerate;
+}
+
+QString GstEncoderSelector::benchCondition(const QSize &size, int framerate)
+{
+    return QString("%1x%2@%3").arg(size.width()).arg(size.height()).arg(framerate);
+}
+
+QString GstEncoderSelector::benchResult(const QString &encoder, const QSize &size, int framerate, const QList<Encoder> &list)
+{
+    return QString("%1;%2;%3").arg(encoder, benchCondition(size, framerate), candidateNames(list));
+}
+
+QString GstEncoderSelector::candidateNames(const QList<Encoder> &list)
+{
+    QStringList names;
+    for (const Encoder &encoder : list) {
+        names << encoder.name;
+    }
+    return names.join(',');
+}
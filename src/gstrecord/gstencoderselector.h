@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef GSTENCODERSELECTOR_H
+#define GSTENCODERSELECTOR_H
+
+#include "gstrecordx.h"
+
+#include <QList>
+#include <QSize>
+#include <QString>
+
+#include <atomic>
+
+/**
+ * @brief Gstreamer 录屏的视频编码器表及首次运行时的编码器测速
+ *
+ * 原先 webm 固定使用 vp8enc（cpu-used=5），低端 ARM 机器上 1080p30 跟不上。
+ * 这里按容器列出可用的编码器及实时编码参数，用 videotestsrc 在给定尺寸和帧率下逐个测速，选出最快的一个，
+ * 结果连同测速条件作为一个值缓存在 ConfigSettings 的 recorder/gst_encoder_bench 中。测速耗时数秒，
+ * 只在进入录屏模式时于后台线程运行，开始录制时取消；开始录制只读取缓存，录制的像素吞吐（宽 x 高 x 帧率）
+ * 不超过测速时的条件、且候选编码器与测速时相同才使用缓存，否则用默认编码器。
+ * 候选编码器只包含用户所选容器能封装的编码器；webm 不能封装 H.264，只有 recorder/gst_h264_mkv 为 true 时
+ * 才加入 x264enc/openh264enc，选中后输出 mkv。recorder/gst_encoder 不为空时视为手动指定，不再测速。
+ */
+class GstEncoderSelector
+{
+public:
+    struct Encoder {
+        /**
+         * @brief 编码器元素名，用于缓存和日志
+         */
+        QString name;
+        /**
+         * @brief 编码器管道片段，%1 为线程数，%2 为关键帧间隔（帧）
+         */
+        QString element;
+        /**
+         * @brief 复用器元素名
+         */
+        QString muxer;
+        /**
+         * @brief 输出文件扩展名
+         */
+        QString extension;
+    };
+
+    /**
+     * @brief 视频类型可用的编码器，第一个为默认编码器，测速结果相同时靠前的优先
+     * @param h264Mkv 是否加入 H.264 编码器，选中时改为输出 mkv
+     */
+    static QList<Encoder> encoders(GstRecordX::VideoType videoType, bool h264Mkv = false);
+
+    /**
+     * @brief 按 recorder/gst_h264_mkv 设置得到的候选编码器
+     */
+    static QList<Encoder> candidates(GstRecordX::VideoType videoType);
+
+    /**
+     * @brief 代入线程数和关键帧间隔后的编码器管道片段
+     */
+    static QString encoderElement(const Encoder &encoder, int framerate);
+
+    /**
+     * @brief 选择录制使用的编码器，不测速：缓存覆盖本次录制时使用缓存，否则使用默认编码器
+     */
+    static Encoder select(GstRecordX::VideoType videoType, const QSize &size, int framerate);
+
+    /**
+     * @brief 缓存是否不能覆盖给定的尺寸和帧率，需要测速
+     */
+    static bool needsBenchmark(GstRecordX::VideoType videoType, const QSize &size, int framerate);
+
+    /**
+     * @brief 缓存不能覆盖给定条件时，在后台线程中测速，立即返回
+     * 新的测速会取消之前尚未结束的测速
+     */
+    static void benchmarkInBackground(GstRecordX::VideoType videoType, const QSize &size, int framerate);
+
+    /**
+     * @brief 开始一次测速，返回这次测速的代数，之前的测速随之取消
+     */
+    static int beginBenchmark();
+
+    /**
+     * @brief 代数为 generation 的测速是否已被取消
+     */
+    static bool isCancelled(int generation);
+
+    /**
+     * @brief 逐个测速并缓存最快的编码器，阻塞数秒，只能在后台线程调用
+     * 调用前需已完成 gstInterface::initFunctions 和 gst_init；被 cancelBenchmark 取消时不缓存
+     * @param generation beginBenchmark 返回的代数
+     */
+    static void runBenchmark(GstRecordX::VideoType videoType, const QSize &size, int framerate, int generation);
+
+    /**
+     * @brief 取消所有已开始的测速，开始录制前调用
+     */
+    static void cancelBenchmark();
+
+    /**
+     * @brief 在给定尺寸和帧率下测试编码器一秒画面的编码速度
+     * @param generation beginBenchmark 返回的代数
+     * @return 每秒编码的帧数；编码器或解析器不存在、管道出错或被取消返回 -1，超时返回 0
+     */
+    static double benchmark(const Encoder &encoder, const QSize &size, int framerate, int generation);
+
+    /**
+     * @brief 从测速结果中选出最快的编码器，fps 与 encoders 的顺序一一对应
+     * @return 下标，全部不可用时返回 -1
+     */
+    static int pick(const QList<double> &fps);
+
+    /**
+     * @brief 缓存的测速条件（"宽x高@帧率"）是否覆盖本次录制
+     */
+    static bool benchCovers(const QString &bench, const QSize &size, int framerate);
+
+    static QString benchCondition(const QSize &size, int framerate);
+
+    /**
+     * @brief 测速结果的缓存值："编码器;宽x高@帧率;候选编码器"，候选编码器以逗号分隔
+     * 编码器与测速条件放在一个值中一次写入，读取时不会拿到不配套的两项
+     */
+    static QString benchResult(const QString &encoder, const QSize &size, int framerate, const QList<Encoder> &list);
+
+    static const int BenchmarkTimeoutMs = 3000;
+
+private:
+    /**
+     * @brief 缓存的编码器在 list 中的下标，缓存不存在或不能覆盖时返回 -1
+     */
+    static int cachedIndex(const QList<Encoder> &list, const QSize &size, int framerate);
+
+    static int indexOf(const QList<Encoder> &list, const QString &name);
+    static QString candidateNames(const QList<Encoder> &list);
+
+    //每次开始或取消测速时加一，测速线程发现代数变化即停止
+    static std::atomic<int> m_benchmarkGeneration;
+};
+
+#endif // GSTENCODERSELECTOR_H
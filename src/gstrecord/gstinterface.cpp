@@ -16,6 +16,7 @@ gstInterface::p_g_main_loop_quit gstInterface::m_g_main_loop_quit = nullptr;
 gstInterface::p_g_main_loop_run gstInterface::m_g_main_loop_run = nullptr;
 gstInterface::p_g_main_loop_new gstInterface::m_g_main_loop_new = nullptr;
 gstInterface::p_g_malloc gstInterface::m_g_malloc = nullptr;
+gstInterface::p_g_error_free gstInterface::m_g_error_free = nullptr;
 
 gstInterface::p_gst_init gstInterface::m_gst_init = nullptr;
 gstInterface::p_gst_element_set_state gstInterface::m_gst_element_set_state = nullptr;
@@ -32,9 +33,19 @@ gstInterface::p_gst_event_new_eos gstInterface::m_gst_event_new_eos = nullptr;
 gstInterface::p_gst_bus_timed_pop_filtered gstInterface::m_gst_bus_timed_pop_filtered = nullptr;
 gstInterface::p_gst_parse_launch gstInterface::m_gst_parse_launch = nullptr;
 gstInterface::p_gst_bin_get_type gstInterface::m_gst_bin_get_type = nullptr;
+gstInterface::p_gst_buffer_new_wrapped_full gstInterface::m_gst_buffer_new_wrapped_full = nullptr;
+gstInterface::p_gst_buffer_map gstInterface::m_gst_buffer_map = nullptr;
+gstInterface::p_gst_buffer_unmap gstInterface::m_gst_buffer_unmap = nullptr;
+gstInterface::p_gst_buffer_pool_new gstInterface::m_gst_buffer_pool_new = nullptr;
+gstInterface::p_gst_buffer_pool_get_config gstInterface::m_gst_buffer_pool_get_config = nullptr;
+gstInterface::p_gst_buffer_pool_config_set_params gstInterface::m_gst_buffer_pool_config_set_params = nullptr;
+gstInterface::p_gst_buffer_pool_set_config gstInterface::m_gst_buffer_pool_set_config = nullptr;
+gstInterface::p_gst_buffer_pool_set_active gstInterface::m_gst_buffer_pool_set_active = nullptr;
+gstInterface::p_gst_buffer_pool_acquire_buffer gstInterface::m_gst_buffer_pool_acquire_buffer = nullptr;
 
 gstInterface::p_g_type_check_instance_cast gstInterface::m_g_type_check_instance_cast = nullptr;
 gstInterface::p_g_signal_emit_by_name gstInterface::m_g_signal_emit_by_name = nullptr;
+gstInterface::p_g_signal_connect_data gstInterface::m_g_signal_connect_data = nullptr;
 gstInterface::p_g_object_set gstInterface::m_g_object_set = nullptr;
 
 
@@ -94,6 +105,7 @@ void gstInterface::initFunctions()
     m_g_main_loop_run = reinterpret_cast<p_g_main_loop_run>(m_libglib.resolve("g_main_loop_run")); // -lglib-20
     m_g_main_loop_new = reinterpret_cast<p_g_main_loop_new>(m_libglib.resolve("g_main_loop_new")); // -lglib-2.0
     m_g_malloc = reinterpret_cast<p_g_malloc>(m_libglib.resolve("g_malloc")); // -lglib-2.0
+    m_g_error_free = reinterpret_cast<p_g_error_free>(m_libglib.resolve("g_error_free")); // -lglib-2.0
 
     m_gst_init = reinterpret_cast<p_gst_init>(m_libgstreamer.resolve("gst_init")); // -lgstreamer-1.0
     m_gst_element_set_state = reinterpret_cast<p_gst_element_set_state>(m_libgstreamer.resolve("gst_element_set_state")); // -lgstreamer-1.0
@@ -110,10 +122,20 @@ void gstInterface::initFunctions()
     m_gst_bus_timed_pop_filtered = reinterpret_cast<p_gst_bus_timed_pop_filtered>(m_libgstreamer.resolve("gst_bus_timed_pop_filtered")); // -lgstreamer-1.0
     m_gst_parse_launch = reinterpret_cast<p_gst_parse_launch>(m_libgstreamer.resolve("gst_parse_launch")); // -lgstreamer-1.0
     m_gst_bin_get_type = reinterpret_cast<p_gst_bin_get_type>(m_libgstreamer.resolve("gst_bin_get_type")); // -lgstreamer-1.0
+    m_gst_buffer_new_wrapped_full = reinterpret_cast<p_gst_buffer_new_wrapped_full>(m_libgstreamer.resolve("gst_buffer_new_wrapped_full")); // -lgstreamer-1.0
+    m_gst_buffer_map = reinterpret_cast<p_gst_buffer_map>(m_libgstreamer.resolve("gst_buffer_map")); // -lgstreamer-1.0
+    m_gst_buffer_unmap = reinterpret_cast<p_gst_buffer_unmap>(m_libgstreamer.resolve("gst_buffer_unmap")); // -lgstreamer-1.0
+    m_gst_buffer_pool_new = reinterpret_cast<p_gst_buffer_pool_new>(m_libgstreamer.resolve("gst_buffer_pool_new")); // -lgstreamer-1.0
+    m_gst_buffer_pool_get_config = reinterpret_cast<p_gst_buffer_pool_get_config>(m_libgstreamer.resolve("gst_buffer_pool_get_config")); // -lgstreamer-1.0
+    m_gst_buffer_pool_config_set_params = reinterpret_cast<p_gst_buffer_pool_config_set_params>(m_libgstreamer.resolve("gst_buffer_pool_config_set_params")); // -lgstreamer-1.0
+    m_gst_buffer_pool_set_config = reinterpret_cast<p_gst_buffer_pool_set_config>(m_libgstreamer.resolve("gst_buffer_pool_set_config")); // -lgstreamer-1.0
+    m_gst_buffer_pool_set_active = reinterpret_cast<p_gst_buffer_pool_set_active>(m_libgstreamer.resolve("gst_buffer_pool_set_active")); // -lgstreamer-1.0
+    m_gst_buffer_pool_acquire_buffer = reinterpret_cast<p_gst_buffer_pool_acquire_buffer>(m_libgstreamer.resolve("gst_buffer_pool_acquire_buffer")); // -lgstreamer-1.0
 
     m_g_type_check_instance_cast = reinterpret_cast<p_g_type_check_instance_cast>(m_libgobject.resolve("g_type_check_instance_cast")); //-lgobject-2.0
     m_g_object_set = reinterpret_cast<p_g_object_set>(m_libgobject.resolve("g_object_set")); //-lgobject-2.0
     m_g_signal_emit_by_name = reinterpret_cast<p_g_signal_emit_by_name>(m_libgobject.resolve("g_signal_emit_by_name")); // -lgobject-2.0
+    m_g_signal_connect_data = reinterpret_cast<p_g_signal_connect_data>(m_libgobject.resolve("g_signal_connect_data")); // -lgobject-2.0
     qCDebug(dsrApp) << "All Glib, GStreamer, and GObject functions resolved.";
 
     qCDebug(dsrApp) << "gstreamer-1.0 function is load";
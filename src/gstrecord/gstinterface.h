@@ -37,6 +37,7 @@ public:
     typedef void(*p_g_main_loop_run)(GMainLoop *);//-lglib-2.0
     typedef GMainLoop *(*p_g_main_loop_new)(GMainContext *, gboolean);//-lglib-2.0
     typedef gpointer(*p_g_malloc)(gsize); //-lglib-2.0
+    typedef void(*p_g_error_free)(GError *); //-lglib-2.0
 
     typedef void(*p_gst_init)(int *, char **[]);//-lgstreamer-1.0
     typedef GstStateChangeReturn(*p_gst_element_set_state)(GstElement *, GstState);//-lgstreamer-1.0
@@ -53,10 +54,20 @@ public:
     typedef GstMessage *(*p_gst_bus_timed_pop_filtered)(GstBus *, GstClockTime, GstMessageType);    //-lgstreamer-1.0
     typedef GstElement *(*p_gst_parse_launch)(const gchar *, GError **);     //-lgstreamer-1.0
     typedef GType(*p_gst_bin_get_type)(void);     //-lgstreamer-1.0
+    typedef GstBuffer *(*p_gst_buffer_new_wrapped_full)(GstMemoryFlags, gpointer, gsize, gsize, gsize, gpointer, GDestroyNotify); //-lgstreamer-1.0
+    typedef gboolean(*p_gst_buffer_map)(GstBuffer *, GstMapInfo *, GstMapFlags); //-lgstreamer-1.0
+    typedef void(*p_gst_buffer_unmap)(GstBuffer *, GstMapInfo *); //-lgstreamer-1.0
+    typedef GstBufferPool *(*p_gst_buffer_pool_new)(void); //-lgstreamer-1.0
+    typedef GstStructure *(*p_gst_buffer_pool_get_config)(GstBufferPool *); //-lgstreamer-1.0
+    typedef void(*p_gst_buffer_pool_config_set_params)(GstStructure *, GstCaps *, guint, guint, guint); //-lgstreamer-1.0
+    typedef gboolean(*p_gst_buffer_pool_set_config)(GstBufferPool *, GstStructure *); //-lgstreamer-1.0
+    typedef gboolean(*p_gst_buffer_pool_set_active)(GstBufferPool *, gboolean); //-lgstreamer-1.0
+    typedef GstFlowReturn(*p_gst_buffer_pool_acquire_buffer)(GstBufferPool *, GstBuffer **, GstBufferPoolAcquireParams *); //-lgstreamer-1.0
 
     typedef GType(*p_g_type_check_instance_cast)(GTypeInstance *, GType);     //-lgobject-2.0
     typedef void(*p_g_object_set)(gpointer, const gchar *, ...);//-lgobject-2.0
     typedef void(*p_g_signal_emit_by_name)(gpointer, const gchar *, ...);//-lgobject-2.0
+    typedef gulong(*p_g_signal_connect_data)(gpointer, const gchar *, GCallback, gpointer, GClosureNotify, GConnectFlags);//-lgobject-2.0
 
     //-lglib-2.0
     static p_gst_message_parse_error m_gst_message_parse_error;
@@ -66,6 +77,7 @@ public:
     static p_g_main_loop_run m_g_main_loop_run;
     static p_g_main_loop_new m_g_main_loop_new;
     static p_g_malloc m_g_malloc;
+    static p_g_error_free m_g_error_free;
 
     //-lgstreamer-1.0
     static p_gst_init m_gst_init;
@@ -83,11 +95,21 @@ public:
     static p_gst_bus_timed_pop_filtered m_gst_bus_timed_pop_filtered;
     static p_gst_parse_launch m_gst_parse_launch;
     static p_gst_bin_get_type m_gst_bin_get_type;
+    static p_gst_buffer_new_wrapped_full m_gst_buffer_new_wrapped_full;
+    static p_gst_buffer_map m_gst_buffer_map;
+    static p_gst_buffer_unmap m_gst_buffer_unmap;
+    static p_gst_buffer_pool_new m_gst_buffer_pool_new;
+    static p_gst_buffer_pool_get_config m_gst_buffer_pool_get_config;
+    static p_gst_buffer_pool_config_set_params m_gst_buffer_pool_config_set_params;
+    static p_gst_buffer_pool_set_config m_gst_buffer_pool_set_config;
+    static p_gst_buffer_pool_set_active m_gst_buffer_pool_set_active;
+    static p_gst_buffer_pool_acquire_buffer m_gst_buffer_pool_acquire_buffer;
 
     //-lgobject-2.0
     static p_g_type_check_instance_cast m_g_type_check_instance_cast;
     static p_g_object_set m_g_object_set;
     static p_g_signal_emit_by_name m_g_signal_emit_by_name;
+    static p_g_signal_connect_data m_g_signal_connect_data;
 
 
 public:
@@ -4,8 +4,13 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "gstrecordx.h"
+#include "capturepts.h"
+#include "recordareacrop.h"
 #include "utils.h"
 #include "../utils/log.h"
+#include "../utils/recordingstats.h"
+
+#include <time.h>
 
 
 /**
@@ -68,8 +73,16 @@ void GstRecordX::initMemberVariables()
 {
     qCDebug(dsrApp) << "initMemberVariables called.";
     m_pipeline = nullptr;
+    m_videoSrc = nullptr;
+    m_videoPool = nullptr;
+    m_lastVideoPts = GST_CLOCK_TIME_NONE;
+    m_queueLatencyMs = 500;
+    m_queueLeaky = true;
+    m_droppedBuffers = 0;
     m_audioType = AudioType::None;
     m_videoType = VideoType::webm;
+    m_videoEncoder = "";
+    m_videoMuxer = "";
     m_sysDevcieName = "";
     m_micDeviceName = "";
     m_savePath = "";
@@ -108,8 +121,9 @@ void GstRecordX::x11GstStartRecord()
     //设置视频转换器
     arguments << "videoconvert";
     arguments << "videorate";
-    arguments << "queue max-size-bytes=1073741824 max-size-time=10000000000 max-size-buffers=1000";
+    arguments << getVideoQueue();
     qCDebug(dsrApp) << "Video pipeline arguments set.";
+    m_droppedBuffers = 0;
 
     //创建管道
     if (createPipeline(arguments)) {
@@ -119,6 +133,15 @@ void GstRecordX::x11GstStartRecord()
             return;
         }
         qCInfo(dsrApp) << "Gstreamer's Pipeline create successfully!";
+        //丢弃模式下统计队列溢出丢弃的帧数
+        if (m_queueLeaky) {
+            GstElement *queue = gstInterface::m_gst_bin_get_by_name(getGstBin(m_pipeline), "videoQueue");
+            if (queue) {
+                gstInterface::m_g_signal_connect_data(queue, "overrun", G_CALLBACK(GstRecordX::onVideoQueueOverrun), this,
+                                                      nullptr, static_cast<GConnectFlags>(0));
+                gstInterface::m_gst_object_unref(queue);
+            }
+        }
         //启动Gstreamer录屏管道
         GstStateChangeReturn ret = gstInterface::m_gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
         if (ret == GST_STATE_CHANGE_FAILURE) {
@@ -176,10 +199,26 @@ void GstRecordX::waylandGstStartRecord()
             return;
         }
         qCInfo(dsrApp) << "GStreamer pipeline created successfully";
-        //添加视频相关流信息
-        GstElement *videoSrc = gstInterface::m_gst_bin_get_by_name(getGstBin(m_pipeline), "videoSrc");
-        gstInterface::m_g_object_set(videoSrc, "format", GST_FORMAT_TIME, NULL);
-        gstInterface::m_g_object_set(videoSrc, "is-live", TRUE, NULL);
+        //添加视频相关流信息，appsrc 只查找一次，之后每帧直接使用
+        m_videoSrc = gstInterface::m_gst_bin_get_by_name(getGstBin(m_pipeline), "videoSrc");
+        gstInterface::m_g_object_set(m_videoSrc, "format", GST_FORMAT_TIME, NULL);
+        gstInterface::m_g_object_set(m_videoSrc, "is-live", TRUE, NULL);
+        //时间戳由采集时间给出，appsrc 不再按推入时间打时间戳；实时源声明一帧的延迟
+        gstInterface::m_g_object_set(m_videoSrc, "do-timestamp", FALSE, NULL);
+        gstInterface::m_g_object_set(m_videoSrc, "min-latency", static_cast<gint64>(GST_SECOND / qMax(m_framerate, 1)), NULL);
+        m_lastVideoPts = GST_CLOCK_TIME_NONE;
+
+        //录制区域大小的缓冲池，缓冲在下游释放后回到池中复用
+        const guint frameBytes = static_cast<guint>(m_recordArea.width() * m_recordArea.height() * 4);
+        m_videoPool = gstInterface::m_gst_buffer_pool_new();
+        GstStructure *config = gstInterface::m_gst_buffer_pool_get_config(m_videoPool);
+        gstInterface::m_gst_buffer_pool_config_set_params(config, nullptr, frameBytes, 4, 0);
+        if (!gstInterface::m_gst_buffer_pool_set_config(m_videoPool, config)
+                || !gstInterface::m_gst_buffer_pool_set_active(m_videoPool, TRUE)) {
+            qCWarning(dsrApp) << "Failed to activate video buffer pool, frame size:" << frameBytes;
+            gstInterface::m_gst_object_unref(m_videoPool);
+            m_videoPool = nullptr;
+        }
         m_gloop = gstInterface::m_g_main_loop_new(NULL, TRUE);
 
         GstBus *bus = gstInterface::m_gst_pipeline_get_bus(reinterpret_cast<GstPipeline *>(m_pipeline));
@@ -190,6 +229,7 @@ void GstRecordX::waylandGstStartRecord()
         GstStateChangeReturn ret = gstInterface::m_gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
         if (ret == GST_STATE_CHANGE_FAILURE) {
             qCWarning(dsrApp) << "Unable to set the pipeline to the playing state. Recording failed";
+            releaseWaylandVideoSource();
             gstInterface::m_gst_object_unref(m_pipeline);
             return;
         }
@@ -212,10 +252,9 @@ void GstRecordX::waylandGstStopRecord()
         return;
     }
 
-    GstElement *videoSrc = gstInterface::m_gst_bin_get_by_name(getGstBin(m_pipeline), "videoSrc");
     GstFlowReturn ret = GST_FLOW_NOT_LINKED;
-    if (videoSrc) {
-        gstInterface::m_g_signal_emit_by_name(videoSrc, "end-of-stream", &ret);
+    if (m_videoSrc) {
+        gstInterface::m_g_signal_emit_by_name(m_videoSrc, "end-of-stream", &ret);
         qCDebug(dsrApp) << "Video source end-of-stream signal emitted.";
     }
     if (GST_FLOW_OK == ret) {
@@ -224,6 +263,7 @@ void GstRecordX::waylandGstStopRecord()
         qCInfo(dsrApp) << "(wayland Gstreamer) Stopping video data writing failed! Gstreamer internal Error Code: " << ret;
     }
     stopPipeline();
+    releaseWaylandVideoSource();
     //发射wayland gstreamer录屏完成信号
     emit waylandGstRecrodFinish();
     qCInfo(dsrApp) << "Wayland GStreamer recording ended";
@@ -231,57 +271,110 @@ void GstRecordX::waylandGstStopRecord()
 }
 
 //wayland下写入视频帧
-bool GstRecordX::waylandWriteVideoFrame(const unsigned char *frame, const int framewidth, const int frameheight)
+bool GstRecordX::waylandWriteVideoFrame(const unsigned char *frame, const int framewidth, const int frameheight,
+                                        const int stride, const int64_t captureTimeUs,
+                                        GDestroyNotify release, gpointer releaseData)
 {
 #ifdef ENABLE_UNIT_TEST
-    Q_UNUSED(frame); Q_UNUSED(framewidth); Q_UNUSED(frameheight);
+    Q_UNUSED(frame); Q_UNUSED(framewidth); Q_UNUSED(frameheight); Q_UNUSED(stride); Q_UNUSED(captureTimeUs);
+    if (release) {
+        release(releaseData);
+    }
     return false; // 单测桩
 #else
+    RecordingStats::Scope statsScope(RecordingStats::GstWriteVideoFrame);
     qCDebug(dsrApp) << "waylandWriteVideoFrame called with framewidth:" << framewidth << ", frameheight:" << frameheight;
-    if (!m_pipeline) {
+    if (!m_pipeline || !m_videoSrc || nullptr == frame) {
         qCWarning(dsrApp) << "Wayland GStreamer failed to write video frame! Recording pipeline not initialized!";
+        if (release) {
+            release(releaseData);
+        }
         return false;
     }
-    qCDebug(dsrApp) << "Pipeline initialized, proceeding to write video frame.";
-
-    //qDebug() << " ======= 取视频帧进行编码 ";
-
-    GstFlowReturn ret;
-    guint8 *ptr;
-    int size = m_recordArea.width() * m_recordArea.height() * 4;
-    ptr = (guint8 *)gstInterface::m_g_malloc(size * sizeof(uchar));
-    if (nullptr == ptr) {
-        qCWarning(dsrApp) << "GStreamer writeFrame malloc failed!";
-        return false;
+    const int srcStride = stride > 0 ? stride : framewidth * 4;
+
+    GstBuffer *buffer = nullptr;
+    if (release && RecordAreaCrop::canWrap(m_recordArea, framewidth, frameheight, srcStride)) {
+        //录制区域为整屏且每行没有填充：直接引用帧内存，GStreamer 释放缓冲时调用 release 归还
+        const gsize size = static_cast<gsize>(srcStride) * frameheight;
+        buffer = gstInterface::m_gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY, const_cast<unsigned char *>(frame),
+                                                             size, 0, size, releaseData, release);
+        qCDebug(dsrApp) << "Video frame wrapped into GstBuffer without copy.";
     } else {
-        qCDebug(dsrApp) << "Memory allocated for video frame.";
-        GstBuffer *buffer;
-        QImage img(frame, framewidth, frameheight, QImage::Format::Format_RGBA8888);
-        img = img.copy(m_recordArea);
-        memcpy(ptr, img.bits(), size);
-        buffer = gstInterface::m_gst_buffer_new_wrapped((void *)ptr, size);
-        qCDebug(dsrApp) << "Video frame copied and wrapped into GstBuffer.";
-
-//        QImage *img = new QImage(frame, m_recordArea.width(), m_recordArea.height(), QImage::Format::Format_RGBA8888);
-//        img->save(QString("/home/uos/Desktop/test/image/test_%1.png").arg(globalCount));
-//        globalCount++;
-
-        //设置时间戳
-        GST_BUFFER_PTS(buffer) = gstInterface::m_gst_clock_get_time(m_pipeline->clock) - m_pipeline->base_time;
-        //获取视频源
-        GstElement *videoSrc = gstInterface::m_gst_bin_get_by_name(getGstBin(m_pipeline), "videoSrc");
-        //注入视频帧数据
-        gstInterface::m_g_signal_emit_by_name(videoSrc, "push-buffer", buffer, &ret);
-        //释放buffer
-        //        gstInterface::m_gst_buffer_unref(buffer);
-        gstInterface::m_gst_mini_object_unref(GST_MINI_OBJECT_CAST(buffer));
+        buffer = copyRecordArea(frame, framewidth, frameheight, srcStride);
+        if (release) {
+            release(releaseData);
+        }
+        if (nullptr == buffer) {
+            qCWarning(dsrApp) << "GStreamer failed to acquire video buffer!";
+            return false;
+        }
+        qCDebug(dsrApp) << "Video frame copied into pooled GstBuffer.";
     }
 
+    //设置时间戳：使用采集时间，排队和编码的耗时不会影响输出的时间轴
+    GST_BUFFER_PTS(buffer) = videoPts(captureTimeUs);
+    GST_BUFFER_DURATION(buffer) = GST_SECOND / qMax(m_framerate, 1);
+    //注入视频帧数据，push-buffer 不接管 buffer 的引用
+    GstFlowReturn ret = GST_FLOW_ERROR;
+    gstInterface::m_g_signal_emit_by_name(m_videoSrc, "push-buffer", buffer, &ret);
+    gstInterface::m_gst_mini_object_unref(GST_MINI_OBJECT_CAST(buffer));
+
     qCDebug(dsrApp) << "waylandWriteVideoFrame finished. Returning:" << (ret == GST_FLOW_OK);
     return ret == GST_FLOW_OK;
 #endif
 }
 
+GstBuffer *GstRecordX::copyRecordArea(const unsigned char *frame, const int framewidth, const int frameheight, const int stride)
+{
+    const gsize size = RecordAreaCrop::bufferSize(m_recordArea);
+    GstBuffer *buffer = nullptr;
+    if (m_videoPool) {
+        if (gstInterface::m_gst_buffer_pool_acquire_buffer(m_videoPool, &buffer, nullptr) != GST_FLOW_OK) {
+            buffer = nullptr;
+        }
+    } else {
+        void *ptr = gstInterface::m_g_malloc(size);
+        buffer = ptr ? gstInterface::m_gst_buffer_new_wrapped(ptr, size) : nullptr;
+    }
+    if (nullptr == buffer) {
+        return nullptr;
+    }
+
+    GstMapInfo map;
+    if (!gstInterface::m_gst_buffer_map(buffer, &map, GST_MAP_WRITE)) {
+        gstInterface::m_gst_mini_object_unref(GST_MINI_OBJECT_CAST(buffer));
+        return nullptr;
+    }
+    RecordAreaCrop::copy(frame, framewidth, frameheight, stride, m_recordArea, map.data);
+    gstInterface::m_gst_buffer_unmap(buffer, &map);
+    return buffer;
+}
+
+GstClockTime GstRecordX::videoPts(const int64_t captureTimeUs)
+{
+    static_assert(CapturePts::NoPts == GST_CLOCK_TIME_NONE, "CapturePts::NoPts must match GST_CLOCK_TIME_NONE");
+    GstClockTime now = gstInterface::m_gst_clock_get_time(m_pipeline->clock);
+    const GstClockTime runningTime = now > m_pipeline->base_time ? now - m_pipeline->base_time : 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    const int64_t nowUs = static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+    return CapturePts::fromCaptureTime(runningTime, nowUs, captureTimeUs, m_lastVideoPts);
+}
+
+void GstRecordX::releaseWaylandVideoSource()
+{
+    if (m_videoSrc) {
+        gstInterface::m_gst_object_unref(m_videoSrc);
+        m_videoSrc = nullptr;
+    }
+    if (m_videoPool) {
+        gstInterface::m_gst_buffer_pool_set_active(m_videoPool, FALSE);
+        gstInterface::m_gst_object_unref(m_videoPool);
+        m_videoPool = nullptr;
+    }
+}
+
 //设置输入设备名称
 void GstRecordX::setInputDeviceName(const QString &device)
 {
@@ -322,6 +415,14 @@ void GstRecordX::setVidoeType(GstRecordX::VideoType videoType)
     qCDebug(dsrApp) << "Video type set to:" << m_videoType;
 }
 
+//设置视频编码器和复用器
+void GstRecordX::setVideoEncoder(const QString &encoder, const QString &muxer)
+{
+    qCDebug(dsrApp) << "setVideoEncoder called with encoder:" << encoder << ", muxer:" << muxer;
+    m_videoEncoder = encoder;
+    m_videoMuxer = muxer;
+}
+
 //设置视频帧率
 void GstRecordX::setFramerate(const int &framerate)
 {
@@ -354,6 +455,45 @@ void GstRecordX::setX11RecordMouse(const bool recordMouse)
     qCDebug(dsrApp) << "X11 record mouse set to:" << m_isRecordMouse;
 }
 
+//设置x11录制视频队列的限制
+void GstRecordX::setQueueLimits(int latencyMs, bool leaky)
+{
+    qCDebug(dsrApp) << "setQueueLimits called with latencyMs:" << latencyMs << ", leaky:" << leaky;
+    m_queueLatencyMs = qMax(latencyMs, 1);
+    m_queueLeaky = leaky;
+}
+
+quint64 GstRecordX::droppedBuffers() const
+{
+    return m_droppedBuffers.load(std::memory_order_relaxed);
+}
+
+//按内存预算生成x11录制的视频队列命令
+QString GstRecordX::getVideoQueue() const
+{
+    //原先队列最多缓存 1GB，编码跟不上时内存会一直增长；现按 BGRx 画面大小 x 帧率 x 时长 限制，至少容纳一帧
+    const quint64 frameBytes = static_cast<quint64>(qMax(m_recordArea.width(), 1)) * qMax(m_recordArea.height(), 1) * 4;
+    const quint64 budget = frameBytes * qMax(m_framerate, 1) * m_queueLatencyMs / 1000;
+    const quint64 maxBytes = qBound(frameBytes, budget, static_cast<quint64>(G_MAXUINT));
+    const QString queue = QString("queue name=videoQueue max-size-bytes=%1 max-size-time=%2 max-size-buffers=0 leaky=%3")
+                              .arg(maxBytes)
+                              .arg(static_cast<quint64>(m_queueLatencyMs) * GST_MSECOND)
+                              .arg(QString(m_queueLeaky ? "downstream" : "no"));
+    qCDebug(dsrApp) << "Video queue:" << queue;
+    return queue;
+}
+
+void GstRecordX::onVideoQueueOverrun(GstElement *queue, gpointer userdata)
+{
+    Q_UNUSED(queue);
+    GstRecordX *gstRecord = static_cast<GstRecordX *>(userdata);
+    const quint64 dropped = gstRecord->m_droppedBuffers.fetch_add(1, std::memory_order_relaxed) + 1;
+    //避免每帧都输出日志
+    if ((dropped & (dropped - 1)) == 0) {
+        qCWarning(dsrApp) << "x11 Gstreamer video queue full, dropped buffers:" << dropped;
+    }
+}
+
 //设置主板供应商类型
 void GstRecordX::setBoardVendorType(int boardVendorType)
 {
@@ -369,7 +509,10 @@ bool GstRecordX::createPipeline(QStringList arguments)
     qCInfo(dsrApp) << "Creating GStreamer pipeline";
     //设置编码器
     // arguments << QString("vp8enc min_quantizer=20 max_quantizer=20 cpu-used=%1 deadline=1000000 threads=%2").arg(QThread::idealThreadCount()).arg(QThread::idealThreadCount());
-    if (m_videoType == VideoType::webm) {
+    if (!m_videoEncoder.isEmpty()) {
+        qCDebug(dsrApp) << "Using selected encoder:" << m_videoEncoder;
+        arguments << m_videoEncoder;
+    } else if (m_videoType == VideoType::webm) {
         qCDebug(dsrApp) << "Using VP8 encoder for WebM";
         //vp8编码
         arguments << "vp8enc min-quantizer=1 max-quantizer=50 undershoot=95 cpu-used=5 deadline=1 static-threshold=50 error-resilient=1";
@@ -416,7 +559,10 @@ bool GstRecordX::createPipeline(QStringList arguments)
     }
     qCDebug(dsrApp) << "Audio configuration complete.";
 
-    if (m_videoType == VideoType::webm) {
+    if (!m_videoMuxer.isEmpty()) {
+        qCDebug(dsrApp) << "Using selected muxer:" << m_videoMuxer;
+        arguments << m_videoMuxer + " name=mux";
+    } else if (m_videoType == VideoType::webm) {
         qCDebug(dsrApp) << "Using WebM muxer";
         //webmmux 复用器
         arguments << "webmmux name=mux";
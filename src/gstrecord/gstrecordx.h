@@ -17,6 +17,8 @@
 
 #include <gst/gst.h>
 
+#include <atomic>
+
 class Utils;
 /**
  * @brief 此类是Gstreamer在x11环境下进行录屏的处理类
@@ -62,8 +64,15 @@ public:
 
     /**
      * @brief wayland下写入视频帧
+     * @param stride frame 每行的字节数，0 表示 framewidth * 4
+     * @param captureTimeUs 画面的采集时间（CLOCK_MONOTONIC，微秒），换算为管道运行时间后作为 PTS；
+     * 小于 0 时使用写入时的运行时间
+     * @param release 不为空时，录制区域为整屏则直接引用 frame 不拷贝，GStreamer 用完后调用 release(releaseData)；
+     * 其它情况拷贝后立即调用。只要 release 不为空，无论成功与否都会被调用一次
      */
-    bool waylandWriteVideoFrame(const unsigned char *frame, const int framewidth, const int frameheight);
+    bool waylandWriteVideoFrame(const unsigned char *frame, const int framewidth, const int frameheight,
+                                const int stride = 0, const int64_t captureTimeUs = -1,
+                                GDestroyNotify release = nullptr, gpointer releaseData = nullptr);
 
     /**
      * @brief 设置输入设备名称
@@ -94,6 +103,13 @@ public:
      */
     void setVidoeType(VideoType videoType);
 
+    /**
+     * @brief 设置视频编码器和复用器，为空时按视频类型使用默认的 vp8enc/webmmux 或 theoraenc/oggmux
+     * @param encoder 编码器管道片段
+     * @param muxer 复用器元素名
+     */
+    void setVideoEncoder(const QString &encoder, const QString &muxer);
+
     /**
      * @brief 设置视频帧率
      * @param 视频帧率
@@ -124,6 +140,18 @@ public:
      */
     void setBoardVendorType(int boardVendorType);
 
+    /**
+     * @brief 设置x11录制视频队列的限制
+     * @param latencyMs 队列最多缓存的时长（毫秒），内存上限按 录制区域 x 4 字节 x 帧率 x 时长 计算
+     * @param leaky 队列满时是否丢弃最旧的帧；为 false 时阻塞上游
+     */
+    void setQueueLimits(int latencyMs, bool leaky);
+
+    /**
+     * @brief x11录制中视频队列满而丢弃的帧数，每次开始录制时清零
+     */
+    quint64 droppedBuffers() const;
+
     GMainLoop *getGloop() {return m_gloop;}
 
 signals:
@@ -149,6 +177,16 @@ private:
      */
     QString getAudioPipeline(const QString &audioDevName, const QString &audioType, const QString &arg);
 
+    /**
+     * @brief 按内存预算生成x11录制的视频队列命令
+     */
+    QString getVideoQueue() const;
+
+    /**
+     * @brief 视频队列溢出回调，丢弃模式下每次溢出丢弃一帧
+     */
+    static void onVideoQueueOverrun(GstElement *queue, gpointer userdata);
+
     /**
      * @brief 停止管道，x11和wayland可共用
      */
@@ -170,6 +208,21 @@ private:
      * @return
      */
     GstBin *getGstBin(GstElement *element);
+
+    /**
+     * @brief 从缓冲池取一块录制区域大小的缓冲，把 frame 中录制区域的行拷贝进去
+     */
+    GstBuffer *copyRecordArea(const unsigned char *frame, const int framewidth, const int frameheight, const int stride);
+
+    /**
+     * @brief 把采集时间换算为管道的运行时间，保证严格递增
+     */
+    GstClockTime videoPts(const int64_t captureTimeUs);
+
+    /**
+     * @brief 释放 wayland 录制缓存的 appsrc 和缓冲池
+     */
+    void releaseWaylandVideoSource();
 private:
     /**
      * @brief gstreamer的管道元素
@@ -178,6 +231,32 @@ private:
 
     GMainLoop *m_gloop;
 
+    /**
+     * @brief wayland录制的 appsrc，waylandGstStartRecord 时取得，停止录制时释放
+     */
+    GstElement *m_videoSrc;
+
+    /**
+     * @brief wayland录制区域大小的缓冲池，录制过程中复用，不再每帧申请内存
+     */
+    GstBufferPool *m_videoPool;
+
+    /**
+     * @brief 上一次写入视频帧的 PTS，GST_CLOCK_TIME_NONE（CapturePts::NoPts）表示还没有写入
+     */
+    uint64_t m_lastVideoPts;
+
+    /**
+     * @brief x11录制视频队列最多缓存的时长（毫秒）及队列满时是否丢帧
+     */
+    int m_queueLatencyMs;
+    bool m_queueLeaky;
+
+    /**
+     * @brief 视频队列满而丢弃的帧数，在 GStreamer 的流线程中累加
+     */
+    std::atomic<quint64> m_droppedBuffers;
+
     /**
      * @brief 音频类型
      */
@@ -188,6 +267,12 @@ private:
      */
     VideoType m_videoType;
 
+    /**
+     * @brief 视频编码器管道片段及复用器，为空时使用视频类型的默认值
+     */
+    QString m_videoEncoder;
+    QString m_videoMuxer;
+
     /**
      * @brief 系统音频设备名称
      */
@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "recordareacrop.h"
+
+#include <cstring>
+
+bool RecordAreaCrop::canWrap(const QRect &recordArea, int frameWidth, int frameHeight, int stride)
+{
+    return recordArea == QRect(0, 0, frameWidth, frameHeight) && stride == frameWidth * 4;
+}
+
+size_t RecordAreaCrop::bufferSize(const QRect &recordArea)
+{
+    if (recordArea.isEmpty()) {
+        return 0;
+    }
+    return static_cast<size_t>(recordArea.width()) * 4 * static_cast<size_t>(recordArea.height());
+}
+
+void RecordAreaCrop::copy(const unsigned char *frame, int frameWidth, int frameHeight, int stride,
+                          const QRect &recordArea, unsigned char *dst)
+{
+    if (recordArea.isEmpty()) {
+        return;
+    }
+    const size_t rowBytes = static_cast<size_t>(recordArea.width()) * 4;
+    //按行从整屏画面中截取录制区域，只拷贝一次；区域超出画面的部分填黑
+    const QRect visible = recordArea.intersected(QRect(0, 0, frameWidth, frameHeight));
+    if (visible != recordArea) {
+        memset(dst, 0, bufferSize(recordArea));
+    }
+    if (visible.isEmpty()) {
+        return;
+    }
+    const size_t copyBytes = static_cast<size_t>(visible.width()) * 4;
+    const unsigned char *src = frame + static_cast<size_t>(visible.y()) * stride + static_cast<size_t>(visible.x()) * 4;
+    unsigned char *out = dst + static_cast<size_t>(visible.y() - recordArea.y()) * rowBytes
+                         + static_cast<size_t>(visible.x() - recordArea.x()) * 4;
+    for (int y = 0; y < visible.height(); y++) {
+        memcpy(out, src, copyBytes);
+        src += stride;
+        out += rowBytes;
+    }
+}
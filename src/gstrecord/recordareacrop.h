@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef RECORDAREACROP_H
+#define RECORDAREACROP_H
+
+#include <QRect>
+
+#include <cstddef>
+
+/**
+ * @brief Wayland GStreamer 录屏从整屏 BGRx 画面中截取录制区域，与 GStreamer 无关，便于单独测试
+ *
+ * 录制区域为整屏且每行没有填充时可以直接引用帧内存（零拷贝），否则按行拷贝到紧密排列的缓冲区，
+ * 区域超出画面的部分填黑。
+ */
+class RecordAreaCrop
+{
+public:
+    /**
+     * @brief 是否可以不拷贝，直接把整帧交给 GStreamer
+     * @param stride 每行字节数
+     */
+    static bool canWrap(const QRect &recordArea, int frameWidth, int frameHeight, int stride);
+
+    /**
+     * @brief 录制区域紧密排列时的字节数
+     */
+    static size_t bufferSize(const QRect &recordArea);
+
+    /**
+     * @brief 把 frame 中录制区域的行拷贝到 dst，dst 每行 recordArea.width() * 4 字节，大小为 bufferSize
+     */
+    static void copy(const unsigned char *frame, int frameWidth, int frameHeight, int stride,
+                     const QRect &recordArea, unsigned char *dst);
+};
+
+#endif // RECORDAREACROP_H
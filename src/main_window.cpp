@@ -1496,6 +1496,8 @@ void MainWindow::initScreenRecorder()
     m_repaintSideBar = false;
     m_screenWidth = m_backgroundRect.width();
     m_screenHeight = m_backgroundRect.height();
+    //Gstreamer录屏在用户选择录制区域时于后台测速编码器，按主屏幕的像素大小测速
+    recordProcess.prepareGstEncoder(qApp->primaryScreen()->size() * qApp->primaryScreen()->devicePixelRatio());
 
     isPressMouseLeftButton = false;
     isReleaseMouseLeftButton = false;
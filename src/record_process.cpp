@@ -8,6 +8,7 @@
 #include "utils.h"
 #include "utils/audioutils.h"
 #include "gstrecord/gstinterface.h"
+#include "gstrecord/gstencoderselector.h"
 #include "utils/log.h"
 #ifdef KF5_WAYLAND_FLAGE_ON
 #include "waylandrecord/avlibinterface.h"
@@ -136,6 +137,7 @@ RecordProcess::~RecordProcess()
         m_recorderProcess = nullptr;
     }
     */
+    GstEncoderSelector::cancelBenchmark();
     if (m_gstRecordX) {
         qCDebug(dsrApp) << "Deleting m_gstRecordX.";
         delete m_gstRecordX;
@@ -711,6 +713,8 @@ void RecordProcess::GstStartRecord()
     gstInterface::initFunctions();
     qCInfo(dsrApp) << "gstreamer依赖库已加载";
     gstInterface::m_gst_init(&argc, nullptr);
+    //录制开始后不再测速，避免与录制争抢 CPU
+    GstEncoderSelector::cancelBenchmark();
     qCDebug(dsrApp) << "Gstreamer 录屏开始！";
     GstRecordX::VideoType videoType = GstRecordX::VideoType::webm;
     GstRecordX::AudioType audioType = GstRecordX::AudioType::None;
@@ -732,14 +736,16 @@ void RecordProcess::GstStartRecord()
     }
     m_gstRecordX->setAudioType(audioType);
     QDateTime date = QDateTime::currentDateTime();
-    QString fileExtension = "webm";
     if (m_recordType == Utils::kMKV) {
         videoType =  GstRecordX::VideoType::ogg;
-        fileExtension = "ogg";
     } else {
         videoType =  GstRecordX::VideoType::webm;
-        fileExtension = "webm";
     }
+    //按缓存的测速结果选择编码器，没有覆盖本次录制的结果时使用默认编码器
+    //候选编码器都能封装进所选容器，只有开启 recorder/gst_h264_mkv 时才会选中 H.264 编码器并输出 mkv
+    GstEncoderSelector::Encoder encoder = GstEncoderSelector::select(videoType, m_recordRect.size(), m_framerate);
+    m_gstRecordX->setVideoEncoder(GstEncoderSelector::encoderElement(encoder, m_framerate), encoder.muxer);
+    QString fileExtension = encoder.extension;
     if(saveAreaName.isEmpty()){
         saveBaseName = QString("%1_%2.%3").arg(tr("Record")).arg(date.toString("yyyyMMddhhmmss")).arg(fileExtension);
     }else{
@@ -756,6 +762,8 @@ void RecordProcess::GstStartRecord()
     m_gstRecordX->setVidoeType(videoType);
     m_gstRecordX->setSavePath(savePath);
     m_gstRecordX->setX11RecordMouse(m_mouseType);
+    m_gstRecordX->setQueueLimits(m_settings->getValue("recorder", "gst_queue_latency_ms").toInt(),
+                                 m_settings->getValue("recorder", "gst_queue_leaky").toBool());
     //开始录制
 #ifndef ENABLE_UNIT_TEST
     if (Utils::isWaylandMode) {
@@ -833,6 +841,22 @@ void RecordProcess::onExitGstRecord()
     exitRecord(newSavePath);
 }
 
+//进入录屏模式时在后台测速Gstreamer编码器
+void RecordProcess::prepareGstEncoder(const QSize &screenSize)
+{
+#ifndef ENABLE_UNIT_TEST
+    if (Utils::isFFmpegEnv) {
+        return;
+    }
+    const GstRecordX::VideoType videoType = m_settings->getValue("recorder", "format").toInt() == Utils::kMKV
+                                                ? GstRecordX::VideoType::ogg
+                                                : GstRecordX::VideoType::webm;
+    GstEncoderSelector::benchmarkInBackground(videoType, screenSize, m_settings->getValue("recorder", "frame_rate").toInt());
+#else
+    Q_UNUSED(screenSize);
+#endif
+}
+
 //开始录屏
 void RecordProcess::startRecord()
 {
@@ -1022,12 +1046,20 @@ void RecordProcess::exitRecord(QString newSavePath)
         int timeout = -1;
         unsigned int id = 0;
 
+        QString body = QString(tr("Saved to %1")).arg(newSavePath);
+        //编码跟不上时视频队列丢弃的帧数
+        const quint64 droppedBuffers = m_gstRecordX ? m_gstRecordX->droppedBuffers() : 0;
+        if (droppedBuffers > 0) {
+            qCWarning(dsrApp) << "Gstreamer recording dropped" << droppedBuffers << "frames";
+            body += "\n" + tr("%1 frames were dropped because encoding could not keep up").arg(droppedBuffers);
+        }
+
         QList<QVariant> arg;
         arg << Utils::appName  //(QCoreApplication::applicationName())                 // appname
             << id                                                    // id
             << QString("deepin-screen-recorder")                     // icon
             << tr("Recording finished")                              // summary
-            << QString(tr("Saved to %1")).arg(newSavePath)           // body
+            << body                                                  // body
             << actions                                               // actions
             << hints                                                 // hints
             << timeout;                                              // timeout
@@ -52,6 +52,11 @@ public:
      * @param filename
      */
     void setRecordInfo(const QRect &recordRect, const QString &filename);
+    /**
+     * @brief 进入录屏模式时调用，Gstreamer录屏在后台线程测速编码器，开始录制时只读取测速结果
+     * @param screenSize 主屏幕的像素大小
+     */
+    void prepareGstEncoder(const QSize &screenSize);
     /**
      * @brief 开始录屏
      */
@@ -9,6 +9,7 @@
 #include "utils.h"
 #include "utils/eventlogutils.h"
 #include "utils/log.h"
+#include "utils/recordingstats.h"
 #include <QApplication>
 #include <QScreen>
 #include <QWindow>
@@ -228,6 +229,12 @@ QString Screenshot::getRecorderNormalIcon()
     return RecorderTablet::getRecorderNormalIcon();
 }
 
+QString Screenshot::GetRecordingStats()
+{
+    qCDebug(dsrApp) << "GetRecordingStats() called.";
+    return QString::fromStdString(RecordingStats::instance()->toJson());
+}
+
 bool Screenshot::isRecording() const
 {
     qCDebug(dsrApp) << "isRecording() called, returning:" << m_isRecording;
@@ -42,6 +42,10 @@ public slots:
     Q_SCRIPTABLE void stopRecord();
     Q_SCRIPTABLE void stopApp();
     Q_SCRIPTABLE QString getRecorderNormalIcon();
+    /**
+     * @brief GetRecordingStats 录屏流水线的运行统计（各阶段耗时直方图、环形缓冲区占用、丢帧计数），JSON 格式
+     */
+    Q_SCRIPTABLE QString GetRecordingStats();
     
 signals:
     Q_SCRIPTABLE void RecorderState(const bool isStart); // true begin recorder; false stop recorder;
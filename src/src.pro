@@ -97,6 +97,12 @@ equals(QT_MAJOR_VERSION, 6) {
     INCLUDEPATH += /usr/include/x86_64-linux-gnu/qt6/QtWidgets
      # Add an alternative search path because of the incorrect dtk6widget.pc
     INCLUDEPATH += /usr/include/dtk6/DWidget
+
+    # waylandrecord 依赖的 KWayland 没有 Qt6 的 qmake 模块，直接链接
+    contains(DEFINES, KF5_WAYLAND_FLAGE_ON) {
+        INCLUDEPATH += /usr/include/KWayland
+        LIBS += -lKWaylandClient -lepoxy
+    }
     
 } else {
     QT += core gui widgets network dbus multimedia multimediawidgets concurrent x11extras svg \
@@ -113,16 +119,15 @@ equals(QT_MAJOR_VERSION, 6) {
     
     # Add an alternative search path because of the incorrect dtkwidget.pc
     INCLUDEPATH += /usr/include/dtk5/DWidget
-    # Comment out or remove Wayland support for Qt5
-    # contains(DEFINES, KF5_WAYLAND_FLAGE_ON) {
-    #     QT += KI18n KWaylandClient
-    #     LIBS += -lepoxy
-    #     
-    #     if (greaterThan(SYS_MAJOR_VERSION, 20)) {
-    #         QT += DWaylandClient
-    #         DEFINES += DWAYLAND_SUPPORT
-    #     }
-    # }
+    contains(DEFINES, KF5_WAYLAND_FLAGE_ON) {
+        QT += KI18n KWaylandClient
+        LIBS += -lepoxy
+
+        greaterThan(SYS_MAJOR_VERSION, 20) {
+            QT += DWaylandClient
+            DEFINES += DWAYLAND_SUPPORT
+        }
+    }
 }
 
 TEMPLATE = app
@@ -159,6 +164,10 @@ DEFINES += _FORTIFY_SOURCE=2
 
 # Architecture specific settings
 ARCH = $$QMAKE_HOST.arch
+isEqual(ARCH, loongarch64) {
+    # I420Converter 的 LSX 实现需要编译器开启 LSX 内建函数
+    QMAKE_CXXFLAGS += -mlsx
+}
 isEqual(ARCH, mips64) {
     QMAKE_CXX += -O3 -ftree-vectorize -march=loongson3a -mhard-float -mno-micromips -mno-mips16 -flax-vector-conversions -mloongson-ext2 -mloongson-mmi
     QMAKE_CXXFLAGS += -O3 -ftree-vectorize -march=loongson3a -mhard-float -mno-micromips -mno-mips16 -flax-vector-conversions -mloongson-ext2 -mloongson-mmi
@@ -185,9 +194,12 @@ HEADERS += main_window.h \
     voicevolumewatcherext.h \
     utils/baseutils.h \
     utils/configsettings.h \
+    utils/recordingstats.h \
+    utils/dmabufmapcache.h \
     utils/dbusutils.h \
     utils/shortcut.h \
     utils/tempfile.h \
+    utils/i420converter.h \
     utils/calculaterect.h \
     utils/saveutils.h \
     utils/shapesutils.h \
@@ -227,6 +239,9 @@ HEADERS += main_window.h \
     gstrecord/gstrecordx.h \
     utils/audioutils.h \
     gstrecord/gstinterface.h \
+    gstrecord/gstencoderselector.h \
+    gstrecord/recordareacrop.h \
+    gstrecord/capturepts.h \
     camera/devnummonitor.h \
     camera/LPF_V4L2.h \
     camera/majorimageprocessingthread.h \
@@ -279,9 +294,12 @@ SOURCES += main.cpp \
     utils/proxyaudioport.cpp \
     utils/shapesutils.cpp \
     utils/tempfile.cpp \
+    utils/i420converter.cpp \
     utils/calculaterect.cpp \
     utils/shortcut.cpp \
     utils/configsettings.cpp \
+    utils/recordingstats.cpp \
+    utils/dmabufmapcache.cpp \
     utils/dbusutils.cpp \
     utils/baseutils.cpp \
     utils/voicevolumewatcher_interface.cpp \
@@ -323,6 +341,9 @@ SOURCES += main.cpp \
     gstrecord/gstrecordx.cpp \
     utils/audioutils.cpp \
     gstrecord/gstinterface.cpp \
+    gstrecord/gstencoderselector.cpp \
+    gstrecord/recordareacrop.cpp \
+    gstrecord/capturepts.cpp \
     camera/devnummonitor.cpp \
     camera/majorimageprocessingthread.cpp \
     camera/LPF_V4L2.c \
@@ -371,27 +392,59 @@ contains(DEFINES, OCR_SCROLL_FLAGE_ON) {
         widgets/previewwidget.cpp
 }
 
-# Comment out or remove Wayland support section
-# contains(DEFINES, KF5_WAYLAND_FLAGE_ON) {
-#     HEADERS += waylandrecord/writeframethread.h \
-#         waylandrecord/waylandintegration.h \
-#         waylandrecord/waylandintegration_p.h \
-#         waylandrecord/recordadmin.h \
-#         waylandrecord/avoutputstream.h \
-#         waylandrecord/avinputstream.h \
-#         waylandrecord/avlibinterface.h \
-#         utils/waylandmousesimulator.h \
-#         utils/waylandscrollmonitor.h
-# 
-#     SOURCES += waylandrecord/writeframethread.cpp \
-#         waylandrecord/waylandintegration.cpp \
-#         waylandrecord/recordadmin.cpp \
-#         waylandrecord/avinputstream.cpp \
-#         waylandrecord/avoutputstream.cpp \
-#         waylandrecord/avlibinterface.cpp \
-#         utils/waylandmousesimulator.cpp \
-#         utils/waylandscrollmonitor.cpp
-# }
+# Wayland 录屏（waylandrecord）
+contains(DEFINES, KF5_WAYLAND_FLAGE_ON) {
+    HEADERS += waylandrecord/writeframethread.h \
+        waylandrecord/waylandintegration.h \
+        waylandrecord/waylandintegration_p.h \
+        waylandrecord/recordadmin.h \
+        waylandrecord/avoutputstream.h \
+        waylandrecord/avinputstream.h \
+        waylandrecord/avlibinterface.h \
+        waylandrecord/channellayouts.h \
+        waylandrecord/waylandframe.h \
+        waylandrecord/framering.h \
+        waylandrecord/framewriter.h \
+        waylandrecord/framepacer.h \
+        waylandrecord/framecompositor.h \
+        waylandrecord/outputbuffers.h \
+        waylandrecord/slicepool.h \
+        waylandrecord/stagequeue.h \
+        waylandrecord/framededup.h \
+        waylandrecord/audiosamplefifo.h \
+        waylandrecord/reusepool.h \
+        waylandrecord/fragmentoptions.h \
+        waylandrecord/audiomixer.h \
+        waylandrecord/captureclock.h \
+        waylandrecord/audiodriftmonitor.h \
+        waylandrecord/egldmabufreader.h \
+        utils/waylandmousesimulator.h \
+        utils/waylandscrollmonitor.h
+
+    SOURCES += waylandrecord/writeframethread.cpp \
+        waylandrecord/waylandintegration.cpp \
+        waylandrecord/recordadmin.cpp \
+        waylandrecord/avinputstream.cpp \
+        waylandrecord/avoutputstream.cpp \
+        waylandrecord/avlibinterface.cpp \
+        waylandrecord/channellayouts.cpp \
+        waylandrecord/framering.cpp \
+        waylandrecord/framewriter.cpp \
+        waylandrecord/framepacer.cpp \
+        waylandrecord/framecompositor.cpp \
+        waylandrecord/outputbuffers.cpp \
+        waylandrecord/slicepool.cpp \
+        waylandrecord/stagequeue.cpp \
+        waylandrecord/framededup.cpp \
+        waylandrecord/audiosamplefifo.cpp \
+        waylandrecord/audiomixer.cpp \
+        waylandrecord/fragmentoptions.cpp \
+        waylandrecord/captureclock.cpp \
+        waylandrecord/audiodriftmonitor.cpp \
+        waylandrecord/egldmabufreader.cpp \
+        utils/waylandmousesimulator.cpp \
+        utils/waylandscrollmonitor.cpp
+}
 
 # Resources
 RESOURCES = ../assets/image/deepin-screen-recorder.qrc \
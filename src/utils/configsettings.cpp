@@ -44,7 +44,21 @@ const QMap<QString, QMap<QString, QVariant>> ConfigSettings::m_defaultConfig = {
     // curor 0 不录制鼠标，及不录制鼠标点击,1 录制鼠标,2 录制鼠标点击,3 录制鼠标，及录制鼠标点击,
     // audio 0 不录制任何音频,1 麦克风音频, 2 录制系统音频,3 录制混音,
     // save_op 保存位置视频目录 0, 桌面 1
-    {"recorder", {{"format", 1}, {"frame_rate", 24}, {"save_op", 0}, {"save_dir", ""}, {"cursor", 0}, {"audio", 3}}},
+    // encoder_preset/encoder_tune/encoder_crf H264 编码参数，encoder_crf 小于 0 不设置
+    // encoder_threads 编码线程数，0 自动；encoder_thread_type frame 帧线程，slice 条带线程
+    // mix_mic_gain/mix_sys_gain 混音时麦克风/系统音频的增益，0.5 与原 amix 电平一致
+    // fragment_seconds Wayland 录屏分段写入的间隔（秒），0 只在结束时写文件索引
+    // trace_file Wayland 录屏停止时写出 Chrome trace 的文件路径，为空不记录跟踪事件
+    // gst_encoder Gstreamer 录屏手动指定的编码器，为空时使用测速结果；gst_encoder_bench 测速结果 "编码器;宽x高@帧率;候选编码器"
+    // gst_h264_mkv webm 录制是否也测速 H.264 编码器，选中时输出 mkv
+    // gst_queue_latency_ms x11 Gstreamer 录屏视频队列最多缓存的时长（毫秒），内存上限随录制区域和帧率换算
+    // gst_queue_leaky 队列满时丢弃最旧的帧，false 时阻塞采集
+    {"recorder", {{"format", 1}, {"frame_rate", 24}, {"save_op", 0}, {"save_dir", ""}, {"cursor", 0}, {"audio", 3},
+                  {"encoder_preset", "ultrafast"}, {"encoder_tune", ""}, {"encoder_crf", -1},
+                  {"encoder_threads", 0}, {"encoder_thread_type", "frame"},
+                  {"mix_mic_gain", 0.5}, {"mix_sys_gain", 0.5}, {"fragment_seconds", 2},
+                  {"trace_file", ""}, {"gst_encoder", ""}, {"gst_encoder_bench", ""}, {"gst_h264_mkv", false},
+                  {"gst_queue_latency_ms", 500}, {"gst_queue_leaky", true}}},
 };
 
 ConfigSettings *ConfigSettings::instance()
@@ -0,0 +1,292 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dmabufmapcache.h"
+
+#include <errno.h>
+#include <linux/dma-buf.h>
+#include <linux/magic.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+
+#ifndef DMA_BUF_MAGIC
+#define DMA_BUF_MAGIC 0x444d4142
+#endif
+
+DmaBufMapCache::Access::Access()
+    : m_cache(nullptr)
+    , m_fd(-1)
+    , m_data(nullptr)
+    , m_size(0)
+    , m_sync(false)
+{
+}
+
+DmaBufMapCache::Access::~Access()
+{
+    end();
+}
+
+DmaBufMapCache::Access::Access(Access &&other) noexcept
+    : m_cache(other.m_cache)
+    , m_fd(other.m_fd)
+    , m_data(other.m_data)
+    , m_size(other.m_size)
+    , m_sync(other.m_sync)
+{
+    other.m_cache = nullptr;
+    other.m_data = nullptr;
+}
+
+DmaBufMapCache::Access &DmaBufMapCache::Access::operator=(Access &&other) noexcept
+{
+    if (this != &other) {
+        end();
+        m_cache = other.m_cache;
+        m_fd = other.m_fd;
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_sync = other.m_sync;
+        other.m_cache = nullptr;
+        other.m_data = nullptr;
+    }
+    return *this;
+}
+
+bool DmaBufMapCache::Access::isValid() const
+{
+    return m_cache != nullptr && m_data != nullptr;
+}
+
+const unsigned char *DmaBufMapCache::Access::data() const
+{
+    return m_data;
+}
+
+size_t DmaBufMapCache::Access::size() const
+{
+    return m_size;
+}
+
+void DmaBufMapCache::Access::end()
+{
+    if (!isValid()) {
+        return;
+    }
+    if (m_sync) {
+        syncEnd(m_fd);
+    }
+    m_cache->endRead(m_data);
+    m_cache = nullptr;
+    m_data = nullptr;
+    m_size = 0;
+    m_fd = -1;
+    m_sync = false;
+}
+
+DmaBufMapCache::DmaBufMapCache(int maxEntries, int idleReads)
+    : m_maxEntries(maxEntries > 0 ? maxEntries : 1)
+    , m_idleReads(idleReads > 0 ? idleReads : 1)
+    , m_reads(0)
+    , m_maps(0)
+    , m_hits(0)
+{
+}
+
+DmaBufMapCache::~DmaBufMapCache()
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    while (!m_entries.empty()) {
+        evict(m_entries.size() - 1);
+    }
+}
+
+bool DmaBufMapCache::beginRead(int fd, size_t size, Access &access)
+{
+    access.end();
+    if (fd < 0 || size == 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return false;
+    }
+    const bool cacheable = hasStableIdentity(fd);
+
+    unsigned char *data = nullptr;
+    bool sync = false;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_reads++;
+        size_t index = m_entries.size();
+        for (size_t i = 0; cacheable && i < m_entries.size(); i++) {
+            if (!m_entries[i].transient && m_entries[i].dev == st.st_dev && m_entries[i].ino == st.st_ino) {
+                index = i;
+                break;
+            }
+        }
+        if (index < m_entries.size() && m_entries[index].size < size) {
+            //同一块缓冲区需要映射更大的范围，没有在读取时重新映射
+            if (m_entries[index].readers > 0) {
+                return false;
+            }
+            evict(index);
+            index = m_entries.size();
+        }
+        if (index < m_entries.size()) {
+            m_hits++;
+        } else {
+            if (cacheable && static_cast<int>(m_entries.size()) >= m_maxEntries) {
+                //淘汰最久未用且不在读取中的映射
+                size_t oldest = m_entries.size();
+                for (size_t i = 0; i < m_entries.size(); i++) {
+                    if (m_entries[i].readers == 0
+                            && (oldest == m_entries.size() || m_entries[i].lastUse < m_entries[oldest].lastUse)) {
+                        oldest = i;
+                    }
+                }
+                if (oldest < m_entries.size()) {
+                    evict(oldest);
+                }
+            }
+            void *mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (MAP_FAILED == mapped) {
+                return false;
+            }
+            m_maps++;
+            Entry entry;
+            entry.dev = st.st_dev;
+            entry.ino = st.st_ino;
+            entry.data = static_cast<unsigned char *>(mapped);
+            entry.size = size;
+            entry.lastUse = 0;
+            entry.readers = 0;
+            entry.sync = true;
+            //无法按 inode 区分的缓冲区只用这一次，读取结束时释放
+            entry.transient = !cacheable;
+            m_entries.push_back(entry);
+            index = m_entries.size() - 1;
+        }
+        Entry &entry = m_entries[index];
+        entry.lastUse = m_reads;
+        entry.readers++;
+        data = entry.data;
+        sync = entry.sync;
+        evictIdle();
+    }
+
+    //SYNC_START 可能等待 GPU 写完，不在锁内调用
+    if (sync && !syncStart(fd)) {
+        sync = false;
+        std::lock_guard<std::mutex> locker(m_mutex);
+        for (Entry &entry : m_entries) {
+            if (entry.data == data) {
+                entry.sync = false;
+                break;
+            }
+        }
+    }
+    access.m_cache = this;
+    access.m_fd = fd;
+    access.m_data = data;
+    access.m_size = size;
+    access.m_sync = sync;
+    return true;
+}
+
+bool DmaBufMapCache::hasStableIdentity(int fd)
+{
+    struct statfs fs;
+    if (fstatfs(fd, &fs) != 0) {
+        return false;
+    }
+    return isStableIdentityFs(static_cast<unsigned long>(fs.f_type));
+}
+
+bool DmaBufMapCache::isStableIdentityFs(unsigned long fsType)
+{
+    //5.3 之前的 dma-buf 在 anon_inode 文件系统上，所有缓冲区共用一个 inode
+    return fsType == DMA_BUF_MAGIC || fsType == TMPFS_MAGIC;
+}
+
+void DmaBufMapCache::clear()
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    for (size_t i = m_entries.size(); i > 0; i--) {
+        if (m_entries[i - 1].readers == 0) {
+            evict(i - 1);
+        }
+    }
+}
+
+int DmaBufMapCache::entryCount() const
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    return static_cast<int>(m_entries.size());
+}
+
+uint64_t DmaBufMapCache::mapCount() const
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    return m_maps;
+}
+
+uint64_t DmaBufMapCache::hitCount() const
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    return m_hits;
+}
+
+void DmaBufMapCache::endRead(const unsigned char *data)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        if (m_entries[i].data == data) {
+            m_entries[i].readers--;
+            if (m_entries[i].transient && m_entries[i].readers == 0) {
+                evict(i);
+            }
+            break;
+        }
+    }
+}
+
+void DmaBufMapCache::evict(size_t index)
+{
+    munmap(m_entries[index].data, m_entries[index].size);
+    m_entries[index] = m_entries.back();
+    m_entries.pop_back();
+}
+
+void DmaBufMapCache::evictIdle()
+{
+    for (size_t i = m_entries.size(); i > 0; i--) {
+        const Entry &entry = m_entries[i - 1];
+        if (entry.readers == 0 && m_reads - entry.lastUse > static_cast<uint64_t>(m_idleReads)) {
+            evict(i - 1);
+        }
+    }
+}
+
+bool DmaBufMapCache::syncStart(int fd)
+{
+    struct dma_buf_sync sync = {DMA_BUF_SYNC_START | DMA_BUF_SYNC_READ};
+    int ret;
+    do {
+        ret = ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync);
+    } while (ret != 0 && (errno == EINTR || errno == EAGAIN));
+    //memfd、shm 等不是 dma-buf 的 fd 返回 ENOTTY，之后不再尝试
+    return ret == 0;
+}
+
+void DmaBufMapCache::syncEnd(int fd)
+{
+    struct dma_buf_sync sync = {DMA_BUF_SYNC_END | DMA_BUF_SYNC_READ};
+    int ret;
+    do {
+        ret = ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync);
+    } while (ret != 0 && (errno == EINTR || errno == EAGAIN));
+}
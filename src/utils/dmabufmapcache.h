@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DMABUFMAPCACHE_H
+#define DMABUFMAPCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * @brief dma-buf 的 CPU 映射缓存
+ *
+ * 合成器每帧送来的 fd 都是新的，但背后只是几块轮换使用的缓冲区。
+ * 原先每帧 mmap/munmap 一次，页表的建立和销毁在 60Hz 下开销明显（ARM 板卡尤甚）。
+ * 这里按缓冲区本身（fd 所指文件的 st_dev/st_ino）缓存映射，同一块缓冲区再次送来时直接复用；
+ * 映射持有缓冲区的引用，缓存期间 inode 不会被其它缓冲区复用。
+ * 只有 Linux 5.3 起 dma-buf 才有自己的文件系统和独立的 inode，之前所有 dma-buf 共用 anon_inode 的同一个 inode，
+ * 按 inode 无法区分缓冲区。因此只缓存 dma-buf 文件系统和 shmem（memfd、shm）上的 fd，其它 fd 每次读取单独映射、读完即释放。
+ *
+ * 每次 CPU 读取用 DMA_BUF_IOCTL_SYNC 的 SYNC_START/SYNC_END 包住，保证缓存一致性；
+ * 不支持该 ioctl 的 fd（如 memfd、shm）只做映射。
+ *
+ * 超过 maxEntries 时淘汰最久未用的映射；连续 idleReads 次读取都没有用到的映射也会被释放
+ * （分辨率变化、合成器重建缓冲区后旧缓冲区不会再出现）。正在读取的映射不会被淘汰。
+ */
+class DmaBufMapCache
+{
+public:
+    static const int DefaultMaxEntries = 12;
+    static const int DefaultIdleReads = 120;
+
+    /**
+     * @brief 一次 CPU 读取，RAII 管理：析构或 end 时结束读取（SYNC_END）
+     * 只能移动不能拷贝，必须在所属的 DmaBufMapCache 析构前结束
+     */
+    class Access
+    {
+    public:
+        Access();
+        ~Access();
+        Access(Access &&other) noexcept;
+        Access &operator=(Access &&other) noexcept;
+        Access(const Access &) = delete;
+        Access &operator=(const Access &) = delete;
+
+        bool isValid() const;
+        const unsigned char *data() const;
+        size_t size() const;
+        void end();
+
+    private:
+        friend class DmaBufMapCache;
+        DmaBufMapCache *m_cache;
+        int m_fd;
+        const unsigned char *m_data;
+        size_t m_size;
+        bool m_sync;
+    };
+
+    explicit DmaBufMapCache(int maxEntries = DefaultMaxEntries, int idleReads = DefaultIdleReads);
+    ~DmaBufMapCache();
+
+    DmaBufMapCache(const DmaBufMapCache &) = delete;
+    DmaBufMapCache &operator=(const DmaBufMapCache &) = delete;
+
+    /**
+     * @brief 映射 fd 对应缓冲区的前 size 字节并开始读取
+     * @param fd 调用方持有的 fd，access 结束前不能关闭；结束后可以关闭，映射仍保留在缓存中
+     * @return 映射失败返回 false
+     */
+    bool beginRead(int fd, size_t size, Access &access);
+
+    /**
+     * @brief fd 所在文件系统的 inode 是否能区分不同的缓冲区，可以按 st_dev/st_ino 缓存
+     */
+    static bool hasStableIdentity(int fd);
+    static bool isStableIdentityFs(unsigned long fsType);
+
+    /**
+     * @brief 释放所有未在读取中的映射，停止录制时调用
+     */
+    void clear();
+
+    int entryCount() const;
+    /**
+     * @brief 实际调用 mmap 的次数
+     */
+    uint64_t mapCount() const;
+    /**
+     * @brief 复用已有映射的次数
+     */
+    uint64_t hitCount() const;
+
+private:
+    struct Entry {
+        dev_t dev;
+        ino_t ino;
+        unsigned char *data;
+        size_t size;
+        uint64_t lastUse;
+        int readers;
+        bool sync;
+        bool transient;
+    };
+
+    void endRead(const unsigned char *data);
+    void evict(size_t index);
+    void evictIdle();
+    static bool syncStart(int fd);
+    static void syncEnd(int fd);
+
+    mutable std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+    int m_maxEntries;
+    int m_idleReads;
+    uint64_t m_reads;
+    uint64_t m_maps;
+    uint64_t m_hits;
+};
+
+#endif // DMABUFMAPCACHE_H
@@ -0,0 +1,535 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "i420converter.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define I420_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define I420_NEON 1
+#include <arm_neon.h>
+#elif defined(__loongarch64)
+#include <sys/auxv.h>
+#if defined(__loongarch_sx)
+#define I420_LSX 1
+#include <lsxintrin.h>
+#endif
+#ifndef HWCAP_LOONGARCH_LSX
+#define HWCAP_LOONGARCH_LSX (1 << 4)
+#endif
+#ifndef HWCAP_LOONGARCH_LASX
+#define HWCAP_LOONGARCH_LASX (1 << 5)
+#endif
+#endif
+
+namespace {
+
+/**
+ * @brief R、G、B 分量在像素中的字节偏移
+ */
+struct Layout {
+    int r;
+    int g;
+    int b;
+};
+
+Layout layoutOf(I420Converter::SourceFormat format)
+{
+    if (format == I420Converter::BGRA || format == I420Converter::BGRX) {
+        return Layout{2, 1, 0};
+    }
+    return Layout{0, 1, 2};
+}
+
+inline uint8_t lumaOf(int r, int g, int b)
+{
+    return static_cast<uint8_t>((66 * r + 129 * g + 25 * b + 0x1080) >> 8);
+}
+
+inline uint8_t chromaUOf(int r, int g, int b)
+{
+    return static_cast<uint8_t>((112 * b - 74 * g - 38 * r + 0x8080) >> 8);
+}
+
+inline uint8_t chromaVOf(int r, int g, int b)
+{
+    return static_cast<uint8_t>((112 * r - 94 * g - 18 * b + 0x8080) >> 8);
+}
+
+/**
+ * @brief 向量化实现只处理成对的行，返回已处理的像素数（偶数），剩余部分由标量实现补齐
+ */
+typedef int (*RowPairKernel)(const uint8_t *src0, const uint8_t *src1, int width, const Layout &layout,
+                             uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v);
+
+/**
+ * @brief 标量实现，从第 x 个像素开始处理一对行；src1 为空时为奇数高度的最后一行
+ */
+void scalarRows(const uint8_t *src0, const uint8_t *src1, int x, int width, const Layout &layout,
+                uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v)
+{
+    for (; x < width; x += 2) {
+        const int count = (x + 1 < width) ? 2 : 1;
+        int r = 0;
+        int g = 0;
+        int b = 0;
+        int pixels = 0;
+        for (int i = 0; i < count; i++) {
+            const uint8_t *p0 = src0 + (x + i) * 4;
+            y0[x + i] = lumaOf(p0[layout.r], p0[layout.g], p0[layout.b]);
+            r += p0[layout.r];
+            g += p0[layout.g];
+            b += p0[layout.b];
+            pixels++;
+            if (nullptr != src1) {
+                const uint8_t *p1 = src1 + (x + i) * 4;
+                y1[x + i] = lumaOf(p1[layout.r], p1[layout.g], p1[layout.b]);
+                r += p1[layout.r];
+                g += p1[layout.g];
+                b += p1[layout.b];
+                pixels++;
+            }
+        }
+        //不足 2x2 的边缘块按实际像素数取平均
+        const int half = pixels / 2;
+        r = (r + half) / pixels;
+        g = (g + half) / pixels;
+        b = (b + half) / pixels;
+        u[x / 2] = chromaUOf(r, g, b);
+        v[x / 2] = chromaVOf(r, g, b);
+    }
+}
+
+#ifdef I420_X86
+__attribute__((target("sse4.1"))) inline __m128i lumaCoeffs(const Layout &layout)
+{
+    int16_t c[8] = {0};
+    c[layout.r] = c[layout.r + 4] = 66;
+    c[layout.g] = c[layout.g + 4] = 129;
+    c[layout.b] = c[layout.b + 4] = 25;
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(c));
+}
+
+__attribute__((target("sse4.1"))) inline __m128i chromaCoeffs(const Layout &layout, int cr, int cg, int cb)
+{
+    int16_t c[8] = {0};
+    c[layout.r] = c[layout.r + 4] = static_cast<int16_t>(cr);
+    c[layout.g] = c[layout.g + 4] = static_cast<int16_t>(cg);
+    c[layout.b] = c[layout.b + 4] = static_cast<int16_t>(cb);
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(c));
+}
+
+/**
+ * @brief 4 个像素的亮度，结果为 4 个 32 位整数
+ */
+__attribute__((target("sse4.1"))) inline __m128i luma4Sse41(__m128i pixels, __m128i coeffs)
+{
+    const __m128i lo = _mm_madd_epi16(_mm_cvtepu8_epi16(pixels), coeffs);
+    const __m128i hi = _mm_madd_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(pixels, 8)), coeffs);
+    const __m128i sum = _mm_hadd_epi32(lo, hi);
+    return _mm_srli_epi32(_mm_add_epi32(sum, _mm_set1_epi32(0x1080)), 8);
+}
+
+/**
+ * @brief 两行各 4 个像素（两个 2x2 块）的色度，结果为 [u0 u1 v0 v1] 四个 32 位整数
+ */
+__attribute__((target("sse4.1"))) inline __m128i chroma2Sse41(__m128i row0, __m128i row1, __m128i uCoeffs, __m128i vCoeffs)
+{
+    const __m128i w0 = _mm_add_epi16(_mm_cvtepu8_epi16(row0), _mm_cvtepu8_epi16(row1));
+    const __m128i w1 = _mm_add_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(row0, 8)), _mm_cvtepu8_epi16(_mm_srli_si128(row1, 8)));
+    const __m128i h0 = _mm_add_epi16(w0, _mm_srli_si128(w0, 8));
+    const __m128i h1 = _mm_add_epi16(w1, _mm_srli_si128(w1, 8));
+    __m128i avg = _mm_unpacklo_epi64(h0, h1);
+    avg = _mm_srli_epi16(_mm_add_epi16(avg, _mm_set1_epi16(2)), 2);
+    const __m128i uv = _mm_hadd_epi32(_mm_madd_epi16(avg, uCoeffs), _mm_madd_epi16(avg, vCoeffs));
+    return _mm_srli_epi32(_mm_add_epi32(uv, _mm_set1_epi32(0x8080)), 8);
+}
+
+/**
+ * @brief 两行各 8 个像素的色度，写出 4 个 U 和 4 个 V
+ */
+__attribute__((target("sse4.1"))) inline void chroma8Sse41(const uint8_t *src0, const uint8_t *src1, __m128i uCoeffs, __m128i vCoeffs,
+                                                           uint8_t *u, uint8_t *v)
+{
+    const __m128i a = chroma2Sse41(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src0)),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i *>(src1)), uCoeffs, vCoeffs);
+    const __m128i b = chroma2Sse41(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src0 + 16)),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i *>(src1 + 16)), uCoeffs, vCoeffs);
+    //[u0 u1 v0 v1 u2 u3 v2 v3] -> [u0 u1 u2 u3 v0 v1 v2 v3]
+    __m128i packed = _mm_packus_epi16(_mm_packus_epi32(a, b), _mm_setzero_si128());
+    packed = _mm_shuffle_epi8(packed, _mm_setr_epi8(0, 1, 4, 5, 2, 3, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1));
+    const int uValue = _mm_cvtsi128_si32(packed);
+    const int vValue = _mm_extract_epi32(packed, 1);
+    memcpy(u, &uValue, 4);
+    memcpy(v, &vValue, 4);
+}
+
+__attribute__((target("sse4.1"))) int rowPairSse41(const uint8_t *src0, const uint8_t *src1, int width, const Layout &layout,
+                                                   uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v)
+{
+    const __m128i yCoeffs = lumaCoeffs(layout);
+    const __m128i uCoeffs = chromaCoeffs(layout, -38, -74, 112);
+    const __m128i vCoeffs = chromaCoeffs(layout, 112, -94, -18);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const uint8_t *rows[2] = {src0 + x * 4, src1 + x * 4};
+        uint8_t *lumas[2] = {y0 + x, y1 + x};
+        for (int i = 0; i < 2; i++) {
+            const __m128i a = luma4Sse41(_mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[i])), yCoeffs);
+            const __m128i b = luma4Sse41(_mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[i] + 16)), yCoeffs);
+            const __m128i packed = _mm_packus_epi16(_mm_packus_epi32(a, b), _mm_setzero_si128());
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(lumas[i]), packed);
+        }
+        chroma8Sse41(rows[0], rows[1], uCoeffs, vCoeffs, u + x / 2, v + x / 2);
+    }
+    return x;
+}
+
+/**
+ * @brief 8 个像素的亮度，结果为按像素顺序排列的 8 个 32 位整数
+ */
+__attribute__((target("avx2"))) inline __m256i luma8Avx2(const uint8_t *src, __m256i coeffs)
+{
+    const __m256i a = _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src))), coeffs);
+    const __m256i b = _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16))), coeffs);
+    //hadd 在 128 位通道内进行，得到 [p0 p1 p4 p5 | p2 p3 p6 p7]
+    const __m256i sum = _mm256_permute4x64_epi64(_mm256_hadd_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm256_srli_epi32(_mm256_add_epi32(sum, _mm256_set1_epi32(0x1080)), 8);
+}
+
+__attribute__((target("avx2"))) int rowPairAvx2(const uint8_t *src0, const uint8_t *src1, int width, const Layout &layout,
+                                                uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v)
+{
+    const __m128i coeffs = lumaCoeffs(layout);
+    const __m256i yCoeffs = _mm256_broadcastsi128_si256(coeffs);
+    const __m128i uCoeffs = chromaCoeffs(layout, -38, -74, 112);
+    const __m128i vCoeffs = chromaCoeffs(layout, 112, -94, -18);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8_t *rows[2] = {src0 + x * 4, src1 + x * 4};
+        uint8_t *lumas[2] = {y0 + x, y1 + x};
+        for (int i = 0; i < 2; i++) {
+            const __m256i a = luma8Avx2(rows[i], yCoeffs);
+            const __m256i b = luma8Avx2(rows[i] + 32, yCoeffs);
+            const __m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+            const __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(lumas[i]), packed);
+        }
+        chroma8Sse41(rows[0], rows[1], uCoeffs, vCoeffs, u + x / 2, v + x / 2);
+        chroma8Sse41(rows[0] + 32, rows[1] + 32, uCoeffs, vCoeffs, u + x / 2 + 4, v + x / 2 + 4);
+    }
+    return x;
+}
+
+bool isZhaoxin()
+{
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    char vendor[13] = {0};
+    memcpy(vendor, &ebx, 4);
+    memcpy(vendor + 4, &edx, 4);
+    memcpy(vendor + 8, &ecx, 4);
+    return strcmp(vendor, "CentaurHauls") == 0 || strcmp(vendor, "  Shanghai  ") == 0;
+}
+#endif // I420_X86
+
+#ifdef I420_NEON
+inline uint8x8_t luma8Neon(uint8x8_t r, uint8x8_t g, uint8x8_t b)
+{
+    uint16x8_t acc = vmull_u8(r, vdup_n_u8(66));
+    acc = vmlal_u8(acc, g, vdup_n_u8(129));
+    acc = vmlal_u8(acc, b, vdup_n_u8(25));
+    return vshrn_n_u16(vaddq_u16(acc, vdupq_n_u16(0x1080)), 8);
+}
+
+int rowPairNeon(const uint8_t *src0, const uint8_t *src1, int width, const Layout &layout,
+                uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16x4_t p0 = vld4q_u8(src0 + x * 4);
+        const uint8x16x4_t p1 = vld4q_u8(src1 + x * 4);
+        const uint8x16x4_t *rows[2] = {&p0, &p1};
+        uint8_t *lumas[2] = {y0 + x, y1 + x};
+        for (int i = 0; i < 2; i++) {
+            const uint8x16_t r = rows[i]->val[layout.r];
+            const uint8x16_t g = rows[i]->val[layout.g];
+            const uint8x16_t b = rows[i]->val[layout.b];
+            vst1q_u8(lumas[i], vcombine_u8(luma8Neon(vget_low_u8(r), vget_low_u8(g), vget_low_u8(b)),
+                                           luma8Neon(vget_high_u8(r), vget_high_u8(g), vget_high_u8(b))));
+        }
+        //水平相邻两像素相加后再累加下一行，得到 2x2 块之和
+        const uint16x8_t r = vrshrq_n_u16(vpadalq_u8(vpaddlq_u8(p0.val[layout.r]), p1.val[layout.r]), 2);
+        const uint16x8_t g = vrshrq_n_u16(vpadalq_u8(vpaddlq_u8(p0.val[layout.g]), p1.val[layout.g]), 2);
+        const uint16x8_t b = vrshrq_n_u16(vpadalq_u8(vpaddlq_u8(p0.val[layout.b]), p1.val[layout.b]), 2);
+        //先加偏置和正项再减负项，中间结果始终在 [4336, 61456] 内，不会溢出 16 位
+        uint16x8_t cu = vmlaq_n_u16(vdupq_n_u16(0x8080), b, 112);
+        cu = vmlsq_n_u16(vmlsq_n_u16(cu, g, 74), r, 38);
+        uint16x8_t cv = vmlaq_n_u16(vdupq_n_u16(0x8080), r, 112);
+        cv = vmlsq_n_u16(vmlsq_n_u16(cv, g, 94), b, 18);
+        vst1_u8(u + x / 2, vshrn_n_u16(cu, 8));
+        vst1_u8(v + x / 2, vshrn_n_u16(cv, 8));
+    }
+    return x;
+}
+#endif // I420_NEON
+
+#ifdef I420_LSX
+/**
+ * @brief 将 16 个像素拆成 4 个通道，ch[i] 为每个像素的第 i 个字节
+ */
+inline void deinterleaveLsx(const uint8_t *src, __m128i ch[4])
+{
+    const __m128i v0 = __lsx_vld(src, 0);
+    const __m128i v1 = __lsx_vld(src, 16);
+    const __m128i v2 = __lsx_vld(src, 32);
+    const __m128i v3 = __lsx_vld(src, 48);
+    const __m128i even01 = __lsx_vpickev_b(v1, v0);
+    const __m128i odd01 = __lsx_vpickod_b(v1, v0);
+    const __m128i even23 = __lsx_vpickev_b(v3, v2);
+    const __m128i odd23 = __lsx_vpickod_b(v3, v2);
+    ch[0] = __lsx_vpickev_b(even23, even01);
+    ch[2] = __lsx_vpickod_b(even23, even01);
+    ch[1] = __lsx_vpickev_b(odd23, odd01);
+    ch[3] = __lsx_vpickod_b(odd23, odd01);
+}
+
+inline __m128i luma8Lsx(__m128i r, __m128i g, __m128i b)
+{
+    __m128i acc = __lsx_vmul_h(r, __lsx_vreplgr2vr_h(66));
+    acc = __lsx_vadd_h(acc, __lsx_vmul_h(g, __lsx_vreplgr2vr_h(129)));
+    acc = __lsx_vadd_h(acc, __lsx_vmul_h(b, __lsx_vreplgr2vr_h(25)));
+    return __lsx_vsrli_h(__lsx_vadd_h(acc, __lsx_vreplgr2vr_h(0x1080)), 8);
+}
+
+/**
+ * @brief 两行 16 个像素某一通道的 2x2 块平均值，8 个 16 位整数
+ */
+inline __m128i blockAverageLsx(__m128i row0, __m128i row1, __m128i zero)
+{
+    const __m128i lo0 = __lsx_vilvl_b(zero, row0);
+    const __m128i hi0 = __lsx_vilvh_b(zero, row0);
+    const __m128i lo1 = __lsx_vilvl_b(zero, row1);
+    const __m128i hi1 = __lsx_vilvh_b(zero, row1);
+    const __m128i sum0 = __lsx_vadd_h(__lsx_vpickev_h(hi0, lo0), __lsx_vpickod_h(hi0, lo0));
+    const __m128i sum1 = __lsx_vadd_h(__lsx_vpickev_h(hi1, lo1), __lsx_vpickod_h(hi1, lo1));
+    return __lsx_vsrli_h(__lsx_vadd_h(__lsx_vadd_h(sum0, sum1), __lsx_vreplgr2vr_h(2)), 2);
+}
+
+inline void store8Lsx(uint8_t *dst, __m128i words)
+{
+    const int64_t value = __lsx_vpickve2gr_d(__lsx_vpickev_b(words, words), 0);
+    memcpy(dst, &value, 8);
+}
+
+int rowPairLsx(const uint8_t *src0, const uint8_t *src1, int width, const Layout &layout,
+               uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v)
+{
+    const __m128i zero = __lsx_vreplgr2vr_b(0);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i p0[4];
+        __m128i p1[4];
+        deinterleaveLsx(src0 + x * 4, p0);
+        deinterleaveLsx(src1 + x * 4, p1);
+        const __m128i *rows[2] = {p0, p1};
+        uint8_t *lumas[2] = {y0 + x, y1 + x};
+        for (int i = 0; i < 2; i++) {
+            const __m128i r = rows[i][layout.r];
+            const __m128i g = rows[i][layout.g];
+            const __m128i b = rows[i][layout.b];
+            const __m128i lo = luma8Lsx(__lsx_vilvl_b(zero, r), __lsx_vilvl_b(zero, g), __lsx_vilvl_b(zero, b));
+            const __m128i hi = luma8Lsx(__lsx_vilvh_b(zero, r), __lsx_vilvh_b(zero, g), __lsx_vilvh_b(zero, b));
+            __lsx_vst(__lsx_vpickev_b(hi, lo), lumas[i], 0);
+        }
+        const __m128i r = blockAverageLsx(p0[layout.r], p1[layout.r], zero);
+        const __m128i g = blockAverageLsx(p0[layout.g], p1[layout.g], zero);
+        const __m128i b = blockAverageLsx(p0[layout.b], p1[layout.b], zero);
+        __m128i cu = __lsx_vadd_h(__lsx_vreplgr2vr_h(0x8080), __lsx_vmul_h(b, __lsx_vreplgr2vr_h(112)));
+        cu = __lsx_vsub_h(cu, __lsx_vmul_h(g, __lsx_vreplgr2vr_h(74)));
+        cu = __lsx_vsub_h(cu, __lsx_vmul_h(r, __lsx_vreplgr2vr_h(38)));
+        __m128i cv = __lsx_vadd_h(__lsx_vreplgr2vr_h(0x8080), __lsx_vmul_h(r, __lsx_vreplgr2vr_h(112)));
+        cv = __lsx_vsub_h(cv, __lsx_vmul_h(g, __lsx_vreplgr2vr_h(94)));
+        cv = __lsx_vsub_h(cv, __lsx_vmul_h(b, __lsx_vreplgr2vr_h(18)));
+        store8Lsx(u + x / 2, __lsx_vsrli_h(cu, 8));
+        store8Lsx(v + x / 2, __lsx_vsrli_h(cv, 8));
+    }
+    return x;
+}
+#endif // I420_LSX
+
+RowPairKernel kernelOf(I420Converter::Isa isa)
+{
+    switch (isa) {
+#ifdef I420_X86
+    case I420Converter::SSE41:
+        return rowPairSse41;
+    case I420Converter::AVX2:
+        return rowPairAvx2;
+#endif
+#ifdef I420_NEON
+    case I420Converter::NEON:
+        return rowPairNeon;
+#endif
+#ifdef I420_LSX
+    case I420Converter::LSX:
+    //暂无 256 位实现，LASX 处理器使用 LSX 实现
+    case I420Converter::LASX:
+        return rowPairLsx;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+I420Converter::Isa detectIsa()
+{
+#if defined(I420_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && !isZhaoxin()) {
+        return I420Converter::AVX2;
+    }
+    //兆芯部分型号的 256 位指令拆成两次 128 位执行，SSE4.1 反而更快
+    if (__builtin_cpu_supports("sse4.1")) {
+        return I420Converter::SSE41;
+    }
+#elif defined(I420_NEON)
+    return I420Converter::NEON;
+#elif defined(I420_LSX)
+    //未启用 -mlsx 编译时没有 LSX 实现，使用标量实现
+    const unsigned long hwcap = getauxval(AT_HWCAP);
+    if (hwcap & HWCAP_LOONGARCH_LASX) {
+        return I420Converter::LASX;
+    }
+    if (hwcap & HWCAP_LOONGARCH_LSX) {
+        return I420Converter::LSX;
+    }
+#endif
+    return I420Converter::Scalar;
+}
+
+} // namespace
+
+bool I420Converter::convert(const uint8_t *src, int srcStride, SourceFormat format,
+                            int width, int height, const Planes &dst)
+{
+    return convert(activeIsa(), src, srcStride, format, width, height, dst);
+}
+
+bool I420Converter::convert(Isa isa, const uint8_t *src, int srcStride, SourceFormat format,
+                            int width, int height, const Planes &dst)
+{
+    if (nullptr == src || nullptr == dst.y || nullptr == dst.u || nullptr == dst.v
+            || width <= 0 || height <= 0 || srcStride < width * 4 || !isSupported(isa)) {
+        return false;
+    }
+    const Layout layout = layoutOf(format);
+    const RowPairKernel kernel = kernelOf(isa);
+    int row = 0;
+    for (; row + 2 <= height; row += 2) {
+        const uint8_t *src0 = src + static_cast<ptrdiff_t>(row) * srcStride;
+        const uint8_t *src1 = src0 + srcStride;
+        uint8_t *y0 = dst.y + static_cast<ptrdiff_t>(row) * dst.strideY;
+        uint8_t *y1 = y0 + dst.strideY;
+        uint8_t *u = dst.u + static_cast<ptrdiff_t>(row / 2) * dst.strideU;
+        uint8_t *v = dst.v + static_cast<ptrdiff_t>(row / 2) * dst.strideV;
+        const int done = (nullptr != kernel) ? kernel(src0, src1, width, layout, y0, y1, u, v) : 0;
+        scalarRows(src0, src1, done, width, layout, y0, y1, u, v);
+    }
+    if (row < height) {
+        scalarRows(src + static_cast<ptrdiff_t>(row) * srcStride, nullptr, 0, width, layout,
+                   dst.y + static_cast<ptrdiff_t>(row) * dst.strideY, nullptr,
+                   dst.u + static_cast<ptrdiff_t>(row / 2) * dst.strideU,
+                   dst.v + static_cast<ptrdiff_t>(row / 2) * dst.strideV);
+    }
+    return true;
+}
+
+I420Converter::Isa I420Converter::activeIsa()
+{
+    static const Isa isa = detectIsa();
+    return isa;
+}
+
+bool I420Converter::isSupported(Isa isa)
+{
+    if (isa == Scalar) {
+        return true;
+    }
+    if (nullptr == kernelOf(isa)) {
+        return false;
+    }
+#if defined(I420_X86)
+    __builtin_cpu_init();
+    if (isa == AVX2) {
+        return __builtin_cpu_supports("avx2");
+    }
+    return __builtin_cpu_supports("sse4.1");
+#elif defined(I420_LSX)
+    const unsigned long hwcap = getauxval(AT_HWCAP);
+    return (hwcap & (isa == LASX ? HWCAP_LOONGARCH_LASX : HWCAP_LOONGARCH_LSX)) != 0;
+#else
+    return true;
+#endif
+}
+
+const char *I420Converter::isaName(Isa isa)
+{
+    switch (isa) {
+    case SSE41:
+        return "sse4.1";
+    case AVX2:
+        return "avx2";
+    case NEON:
+        return "neon";
+    case LSX:
+        return "lsx";
+    case LASX:
+        return "lasx";
+    default:
+        return "scalar";
+    }
+}
+
+size_t I420Converter::bufferSize(int width, int height)
+{
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
+    const size_t chromaWidth = static_cast<size_t>((width + 1) / 2);
+    const size_t chromaHeight = static_cast<size_t>((height + 1) / 2);
+    return static_cast<size_t>(width) * static_cast<size_t>(height) + chromaWidth * chromaHeight * 2;
+}
+
+I420Converter::Planes I420Converter::packedPlanes(uint8_t *buffer, int width, int height)
+{
+    Planes planes;
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+    planes.y = buffer;
+    planes.strideY = width;
+    planes.u = buffer + static_cast<size_t>(width) * static_cast<size_t>(height);
+    planes.strideU = chromaWidth;
+    planes.v = planes.u + static_cast<size_t>(chromaWidth) * static_cast<size_t>(chromaHeight);
+    planes.strideV = chromaWidth;
+    return planes;
+}
+
+I420Converter::Planes I420Converter::slicePlanes(const Planes &planes, int y)
+{
+    Planes slice = planes;
+    slice.y += static_cast<ptrdiff_t>(y) * planes.strideY;
+    slice.u += static_cast<ptrdiff_t>(y / 2) * planes.strideU;
+    slice.v += static_cast<ptrdiff_t>(y / 2) * planes.strideV;
+    return slice;
+}
@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef I420CONVERTER_H
+#define I420CONVERTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 32位 RGB 画面转 I420（YUV420P）
+ *
+ * 使用与 libswscale 默认 RGB->YUV420P 转换相同的 BT.601 有限范围（TV range）矩阵，8 位定点系数：
+ *   Y = (66R + 129G + 25B + 0x1080) >> 8
+ *   U = (112B - 74G - 38R + 0x8080) >> 8
+ *   V = (112R - 94G - 18B + 0x8080) >> 8
+ * 色度取 2x2 像素块的平均值（四舍五入）。
+ *
+ * 按运行时检测到的 CPU 指令集选择实现：x86 上为 AVX2/SSE4.1（兆芯优先 SSE4.1），
+ * ARM64 上为 NEON，LoongArch64 上为 LSX，其余为标量实现。
+ * 所有实现都只使用整数运算，结果与标量实现逐字节相同。
+ */
+class I420Converter
+{
+public:
+    /**
+     * @brief 源画面每个像素的字节顺序
+     */
+    enum SourceFormat {
+        RGBA = 0,   // AV_PIX_FMT_RGBA、QImage::Format_RGBA8888、WL_SHM_FORMAT_ABGR8888
+        BGRA,       // AV_PIX_FMT_BGRA（小端 AV_PIX_FMT_RGB32）、QImage::Format_ARGB32
+        RGBX,       // QImage::Format_RGBX8888、WL_SHM_FORMAT_XBGR8888
+        BGRX        // QImage::Format_RGB32、WL_SHM_FORMAT_XRGB8888
+    };
+
+    /**
+     * @brief 转换实现使用的指令集
+     */
+    enum Isa {
+        Scalar = 0,
+        SSE41,
+        AVX2,
+        NEON,
+        LSX,
+        LASX
+    };
+
+    /**
+     * @brief 目标 I420 三个平面
+     */
+    struct Planes {
+        uint8_t *y;
+        int strideY;
+        uint8_t *u;
+        int strideU;
+        uint8_t *v;
+        int strideV;
+    };
+
+    /**
+     * @brief 转换 width x height 的画面
+     * 用于按条带转换时，src 与 dst 须指向同一偶数行，条带高度除最后一个条带外须为偶数
+     * @return 参数无效返回 false
+     */
+    static bool convert(const uint8_t *src, int srcStride, SourceFormat format,
+                        int width, int height, const Planes &dst);
+    /**
+     * @brief 指定指令集转换，用于测试和基准对比；当前 CPU 或编译目标不支持该指令集时返回 false
+     */
+    static bool convert(Isa isa, const uint8_t *src, int srcStride, SourceFormat format,
+                        int width, int height, const Planes &dst);
+
+    /**
+     * @brief 运行时选择的指令集，首次调用时检测
+     */
+    static Isa activeIsa();
+    static bool isSupported(Isa isa);
+    static const char *isaName(Isa isa);
+
+    /**
+     * @brief 紧密排列的 I420 缓冲区大小（奇数宽高时色度向上取整，与 ffmpeg rawvideo 一致）
+     */
+    static size_t bufferSize(int width, int height);
+    /**
+     * @brief 在紧密排列的 I420 缓冲区上划分三个平面
+     */
+    static Planes packedPlanes(uint8_t *buffer, int width, int height);
+    /**
+     * @brief 从偶数行 y 开始的条带对应的三个平面，色度平面偏移 y / 2 行
+     */
+    static Planes slicePlanes(const Planes &planes, int y);
+};
+
+#endif // I420CONVERTER_H
@@ -0,0 +1,436 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "recordingstats.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+void updateMax(std::atomic<int64_t> &target, int64_t value)
+{
+    int64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+int currentTid()
+{
+    //线程号只取一次，trace 中的 tid 与日志、top -H 中看到的线程号一致
+    static thread_local int tid = static_cast<int>(syscall(SYS_gettid));
+    return tid;
+}
+
+void appendFormat(std::string &out, const char *format, long long value)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), format, value);
+    out += buf;
+}
+} // namespace
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::reset()
+{
+    for (int i = 0; i < BucketCount; i++) {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+    m_totalNs.store(0, std::memory_order_relaxed);
+    m_maxNs.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_release);
+}
+
+int LatencyHistogram::bucketIndex(int64_t ns)
+{
+    uint64_t us = ns > 0 ? static_cast<uint64_t>(ns) / 1000 : 0;
+    int index = 0;
+    while (us > 0 && index < BucketCount - 1) {
+        us >>= 1;
+        index++;
+    }
+    return index;
+}
+
+int64_t LatencyHistogram::bucketUpperUs(int index)
+{
+    if (index < 0) {
+        index = 0;
+    } else if (index >= BucketCount) {
+        index = BucketCount - 1;
+    }
+    return static_cast<int64_t>(1) << index;
+}
+
+void LatencyHistogram::record(int64_t ns)
+{
+    ns = ns > 0 ? ns : 0;
+    m_buckets[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    m_totalNs.fetch_add(ns, std::memory_order_relaxed);
+    updateMax(m_maxNs, ns);
+    m_count.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return m_count.load(std::memory_order_acquire);
+}
+
+int64_t LatencyHistogram::averageNs() const
+{
+    const uint64_t n = count();
+    return n > 0 ? m_totalNs.load(std::memory_order_relaxed) / static_cast<int64_t>(n) : 0;
+}
+
+int64_t LatencyHistogram::maxNs() const
+{
+    return m_maxNs.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::bucket(int index) const
+{
+    if (index < 0 || index >= BucketCount) {
+        return 0;
+    }
+    return m_buckets[index].load(std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::percentileUs(double percent) const
+{
+    //各桶是分别读取的，与 count 可能有少量出入，以桶的合计为准
+    uint64_t total = 0;
+    for (int i = 0; i < BucketCount; i++) {
+        total += bucket(i);
+    }
+    if (total == 0) {
+        return 0;
+    }
+    if (percent < 0) {
+        percent = 0;
+    } else if (percent > 100) {
+        percent = 100;
+    }
+    uint64_t rank = static_cast<uint64_t>(percent * static_cast<double>(total) / 100.0 + 0.999999);
+    if (rank == 0) {
+        rank = 1;
+    }
+    const int64_t maxUs = maxNs() / 1000;
+    uint64_t seen = 0;
+    for (int i = 0; i < BucketCount; i++) {
+        seen += bucket(i);
+        if (seen >= rank) {
+            const int64_t upper = bucketUpperUs(i);
+            return (i == BucketCount - 1 || maxUs < upper) ? maxUs : upper;
+        }
+    }
+    return maxUs;
+}
+
+RecordingStats::Scope::Scope(Stage stage)
+    : m_stage(stage)
+    , m_beginNs(RecordingStats::nowNs())
+{
+}
+
+RecordingStats::Scope::~Scope()
+{
+    RecordingStats::instance()->record(m_stage, m_beginNs, RecordingStats::nowNs());
+}
+
+RecordingStats *RecordingStats::instance()
+{
+    static RecordingStats stats;
+    return &stats;
+}
+
+int64_t RecordingStats::nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+const char *RecordingStats::stageName(Stage stage)
+{
+    switch (stage) {
+    case ProcessBuffer:
+        return "processBuffer";
+    case AppendBuffer:
+        return "appendBuffer";
+    case GetFrame:
+        return "getFrame";
+    case WriteVideoFrame:
+        return "writeVideoFrame";
+    case WriteMixAudio:
+        return "writeMixAudio";
+    case GstWriteVideoFrame:
+        return "gstWriteVideoFrame";
+    default:
+        return "unknown";
+    }
+}
+
+const char *RecordingStats::counterName(Counter counter)
+{
+    switch (counter) {
+    case RingPushed:
+        return "ring_pushed";
+    case RingDropped:
+        return "ring_dropped";
+    case PacerLate:
+        return "pacer_late";
+    case PacerSkipped:
+        return "pacer_skipped";
+    case PacerDuplicated:
+        return "pacer_duplicated";
+    case StaticSkipped:
+        return "static_skipped";
+    case EncodeFailed:
+        return "encode_failed";
+    default:
+        return "unknown";
+    }
+}
+
+RecordingStats::RecordingStats()
+    : m_traceEnabled(false)
+    , m_traceEvents(nullptr)
+    , m_traceCapacity(0)
+    , m_traceNext(0)
+{
+    reset();
+}
+
+RecordingStats::~RecordingStats()
+{
+    delete[] m_traceEvents.load(std::memory_order_acquire);
+}
+
+void RecordingStats::reset()
+{
+    for (int i = 0; i < StageCount; i++) {
+        m_histograms[i].reset();
+    }
+    for (int i = 0; i < CounterCount; i++) {
+        m_counters[i].store(0, std::memory_order_relaxed);
+    }
+    m_ringSize.store(0, std::memory_order_relaxed);
+    m_ringMax.store(0, std::memory_order_relaxed);
+    m_ringCapacity.store(0, std::memory_order_relaxed);
+    m_traceNext.store(0, std::memory_order_relaxed);
+    m_traceOriginNs.store(nowNs(), std::memory_order_relaxed);
+}
+
+void RecordingStats::record(Stage stage, int64_t beginNs, int64_t endNs)
+{
+    if (stage < 0 || stage >= StageCount) {
+        return;
+    }
+    const int64_t durationNs = endNs > beginNs ? endNs - beginNs : 0;
+    m_histograms[stage].record(durationNs);
+    if (m_traceEnabled.load(std::memory_order_relaxed)) {
+        trace(stage, beginNs, durationNs);
+    }
+}
+
+const LatencyHistogram &RecordingStats::histogram(Stage stage) const
+{
+    return m_histograms[(stage >= 0 && stage < StageCount) ? stage : 0];
+}
+
+void RecordingStats::setCounter(Counter counter, uint64_t value)
+{
+    if (counter >= 0 && counter < CounterCount) {
+        m_counters[counter].store(value, std::memory_order_relaxed);
+    }
+}
+
+void RecordingStats::addCounter(Counter counter, uint64_t value)
+{
+    if (counter >= 0 && counter < CounterCount) {
+        m_counters[counter].fetch_add(value, std::memory_order_relaxed);
+    }
+}
+
+uint64_t RecordingStats::counter(Counter counter) const
+{
+    if (counter < 0 || counter >= CounterCount) {
+        return 0;
+    }
+    return m_counters[counter].load(std::memory_order_relaxed);
+}
+
+void RecordingStats::setRingOccupancy(int size, int capacity)
+{
+    m_ringSize.store(size, std::memory_order_relaxed);
+    m_ringCapacity.store(capacity, std::memory_order_relaxed);
+    int current = m_ringMax.load(std::memory_order_relaxed);
+    while (size > current && !m_ringMax.compare_exchange_weak(current, size, std::memory_order_relaxed)) {
+    }
+    if (m_traceEnabled.load(std::memory_order_relaxed)) {
+        trace(-1, nowNs(), size);
+    }
+}
+
+int RecordingStats::ringOccupancy() const
+{
+    return m_ringSize.load(std::memory_order_relaxed);
+}
+
+int RecordingStats::ringMaxOccupancy() const
+{
+    return m_ringMax.load(std::memory_order_relaxed);
+}
+
+int RecordingStats::ringCapacity() const
+{
+    return m_ringCapacity.load(std::memory_order_relaxed);
+}
+
+void RecordingStats::setTraceEnabled(bool enabled, int capacity)
+{
+    m_traceEnabled.store(false, std::memory_order_relaxed);
+    if (!enabled) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> locker(m_traceAllocMutex);
+        if (nullptr == m_traceEvents.load(std::memory_order_relaxed)) {
+            if (capacity <= 0) {
+                return;
+            }
+            TraceEvent *events = new TraceEvent[capacity];
+            m_traceCapacity.store(static_cast<size_t>(capacity), std::memory_order_relaxed);
+            m_traceEvents.store(events, std::memory_order_release);
+        }
+    }
+    m_traceNext.store(0, std::memory_order_relaxed);
+    m_traceEnabled.store(true, std::memory_order_release);
+}
+
+bool RecordingStats::isTraceEnabled() const
+{
+    return m_traceEnabled.load(std::memory_order_acquire);
+}
+
+size_t RecordingStats::traceCapacity() const
+{
+    return m_traceEvents.load(std::memory_order_acquire) ? m_traceCapacity.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t RecordingStats::traceEventCount() const
+{
+    return m_traceNext.load(std::memory_order_acquire);
+}
+
+void RecordingStats::trace(int stage, int64_t beginNs, int64_t value)
+{
+    //写满后覆盖最旧的事件，热路径上不加锁、不分配内存
+    TraceEvent *events = m_traceEvents.load(std::memory_order_acquire);
+    if (nullptr == events) {
+        return;
+    }
+    const uint64_t index = m_traceNext.fetch_add(1, std::memory_order_acq_rel);
+    TraceEvent &event = events[index % m_traceCapacity.load(std::memory_order_relaxed)];
+    event.stage.store(stage, std::memory_order_relaxed);
+    event.tid.store(currentTid(), std::memory_order_relaxed);
+    event.beginNs.store(beginNs, std::memory_order_relaxed);
+    event.value.store(value, std::memory_order_relaxed);
+}
+
+std::string RecordingStats::toJson() const
+{
+    std::string json = "{\"stages\":{";
+    for (int i = 0; i < StageCount; i++) {
+        const LatencyHistogram &h = m_histograms[i];
+        if (i > 0) {
+            json += ",";
+        }
+        json += "\"";
+        json += stageName(static_cast<Stage>(i));
+        json += "\":{";
+        appendFormat(json, "\"count\":%lld", static_cast<long long>(h.count()));
+        appendFormat(json, ",\"avg_us\":%lld", static_cast<long long>(h.averageNs() / 1000));
+        appendFormat(json, ",\"p50_us\":%lld", static_cast<long long>(h.percentileUs(50)));
+        appendFormat(json, ",\"p95_us\":%lld", static_cast<long long>(h.percentileUs(95)));
+        appendFormat(json, ",\"p99_us\":%lld", static_cast<long long>(h.percentileUs(99)));
+        appendFormat(json, ",\"max_us\":%lld", static_cast<long long>(h.maxNs() / 1000));
+        json += ",\"buckets\":[";
+        for (int b = 0; b < LatencyHistogram::BucketCount; b++) {
+            appendFormat(json, b > 0 ? ",%lld" : "%lld", static_cast<long long>(h.bucket(b)));
+        }
+        json += "]}";
+    }
+    json += "},\"ring\":{";
+    appendFormat(json, "\"size\":%lld", ringOccupancy());
+    appendFormat(json, ",\"max\":%lld", ringMaxOccupancy());
+    appendFormat(json, ",\"capacity\":%lld", ringCapacity());
+    json += "},\"counters\":{";
+    for (int i = 0; i < CounterCount; i++) {
+        if (i > 0) {
+            json += ",";
+        }
+        json += "\"";
+        json += counterName(static_cast<Counter>(i));
+        appendFormat(json, "\":%lld", static_cast<long long>(counter(static_cast<Counter>(i))));
+    }
+    json += "},\"trace\":{";
+    json += isTraceEnabled() ? "\"enabled\":true" : "\"enabled\":false";
+    appendFormat(json, ",\"events\":%lld", static_cast<long long>(traceEventCount()));
+    json += "}}";
+    return json;
+}
+
+std::string RecordingStats::toChromeTrace() const
+{
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    const uint64_t next = traceEventCount();
+    const TraceEvent *events = m_traceEvents.load(std::memory_order_acquire);
+    const size_t capacity = traceCapacity();
+    if (events && capacity > 0) {
+        const long long pid = static_cast<long long>(getpid());
+        const int64_t originNs = m_traceOriginNs.load(std::memory_order_relaxed);
+        const uint64_t first = next > capacity ? next - capacity : 0;
+        char buf[192];
+        for (uint64_t i = first; i < next; i++) {
+            const TraceEvent &event = events[i % capacity];
+            const int stage = event.stage.load(std::memory_order_relaxed);
+            const long long tid = event.tid.load(std::memory_order_relaxed);
+            //Chrome trace 的时间单位是微秒，保留到纳秒
+            const double tsUs = static_cast<double>(event.beginNs.load(std::memory_order_relaxed) - originNs) / 1000.0;
+            const int64_t value = event.value.load(std::memory_order_relaxed);
+            if (stage < 0) {
+                snprintf(buf, sizeof(buf),
+                         "{\"name\":\"ring\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%lld,\"tid\":%lld,\"args\":{\"frames\":%lld}}",
+                         tsUs, pid, tid, static_cast<long long>(value));
+            } else {
+                snprintf(buf, sizeof(buf),
+                         "{\"name\":\"%s\",\"cat\":\"record\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lld,\"tid\":%lld}",
+                         stageName(static_cast<Stage>(stage)), tsUs, static_cast<double>(value) / 1000.0, pid, tid);
+            }
+            if (i > first) {
+                json += ",";
+            }
+            json += buf;
+        }
+    }
+    json += "]}";
+    return json;
+}
+
+bool RecordingStats::writeChromeTrace(const std::string &path) const
+{
+    std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << toChromeTrace();
+    return file.good();
+}
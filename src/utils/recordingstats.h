@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef RECORDINGSTATS_H
+#define RECORDINGSTATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief 无锁耗时直方图
+ *
+ * 按微秒取以 2 为底的对数分桶：第 0 个桶统计不足 1us 的样本，
+ * 第 i 个桶统计 [2^(i-1), 2^i) us 的样本，最后一个桶同时收纳所有更长的样本。
+ * record 只做几次 relaxed 原子操作，可以在采集/编码热路径上调用。
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int BucketCount = 24;
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    void reset();
+    void record(int64_t ns);
+
+    uint64_t count() const;
+    int64_t averageNs() const;
+    int64_t maxNs() const;
+    uint64_t bucket(int index) const;
+
+    /**
+     * @brief 分位数的估计值（微秒），取样本所在桶的上界，不超过最大值
+     * @param percent 0~100
+     */
+    int64_t percentileUs(double percent) const;
+
+    /**
+     * @brief 第 index 个桶的上界（微秒）
+     */
+    static int64_t bucketUpperUs(int index);
+    static int bucketIndex(int64_t ns);
+
+private:
+    std::atomic<uint64_t> m_buckets[BucketCount];
+    std::atomic<uint64_t> m_count;
+    std::atomic<int64_t> m_totalNs;
+    std::atomic<int64_t> m_maxNs;
+};
+
+/**
+ * @brief 录屏流水线的运行统计
+ *
+ * 进程内唯一，采集、编码、写文件各线程直接写入，D-Bus 接口 GetRecordingStats 读取：
+ *   各阶段耗时直方图   processBuffer/appendBuffer/getFrame/writeVideoFrame/writeMixAudio/gstWriteVideoFrame
+ *   环形缓冲区占用     当前/最大占用帧数
+ *   帧计数             丢帧、补帧、静止画面跳过等
+ * 开启跟踪后各阶段的每次调用还会记录到预分配的事件环中（写满后覆盖最旧的事件），
+ * 停止录制时可以导出为 Chrome trace 格式（chrome://tracing、Perfetto 可直接打开）。
+ */
+class RecordingStats
+{
+public:
+    enum Stage {
+        ProcessBuffer = 0,
+        AppendBuffer,
+        GetFrame,
+        WriteVideoFrame,
+        WriteMixAudio,
+        GstWriteVideoFrame,
+        StageCount
+    };
+
+    enum Counter {
+        RingPushed = 0,    // 写入环形缓冲区的帧
+        RingDropped,       // 环形缓冲区满而丢弃的帧
+        PacerLate,         // 超过截止时间的节拍
+        PacerSkipped,      // 严重超时被跳过的节拍
+        PacerDuplicated,   // 没有新画面而重复写入上一帧的节拍
+        StaticSkipped,     // 画面静止未写入缓冲区的帧
+        EncodeFailed,      // 编码/写入管道失败的帧
+        CounterCount
+    };
+
+    //默认事件环容量，每个事件 32 字节，约 2MB
+    static constexpr int DefaultTraceEvents = 65536;
+
+    /**
+     * @brief 作用域计时，构造时开始，析构时记录到对应阶段
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(Stage stage);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Stage m_stage;
+        int64_t m_beginNs;
+    };
+
+    static RecordingStats *instance();
+    static int64_t nowNs();
+    static const char *stageName(Stage stage);
+    static const char *counterName(Counter counter);
+
+    RecordingStats();
+    ~RecordingStats();
+    RecordingStats(const RecordingStats &) = delete;
+    RecordingStats &operator=(const RecordingStats &) = delete;
+
+    /**
+     * @brief 清空所有统计，开始新一次录制前调用
+     */
+    void reset();
+
+    void record(Stage stage, int64_t beginNs, int64_t endNs);
+    const LatencyHistogram &histogram(Stage stage) const;
+
+    void setCounter(Counter counter, uint64_t value);
+    void addCounter(Counter counter, uint64_t value = 1);
+    uint64_t counter(Counter counter) const;
+
+    /**
+     * @brief 记录环形缓冲区当前占用，开启跟踪时同时记录一个计数事件
+     */
+    void setRingOccupancy(int size, int capacity);
+    int ringOccupancy() const;
+    int ringMaxOccupancy() const;
+    int ringCapacity() const;
+
+    /**
+     * @brief 开启/关闭事件跟踪
+     * 事件环在第一次开启时按 capacity 分配，之后一直保留到对象析构，不再释放或重新分配，
+     * 因此关闭跟踪时仍在 record/setRingOccupancy 中的线程不会写到已释放的内存；
+     * 再次开启时沿用已分配的事件环，忽略新的 capacity
+     */
+    void setTraceEnabled(bool enabled, int capacity = DefaultTraceEvents);
+    bool isTraceEnabled() const;
+    /**
+     * @brief 事件环容量，尚未开启过跟踪时为 0
+     */
+    size_t traceCapacity() const;
+    /**
+     * @brief 已记录的事件数，超过事件环容量的部分只保留最新的
+     */
+    uint64_t traceEventCount() const;
+
+    /**
+     * @brief 统计快照，JSON 格式，耗时单位为微秒
+     */
+    std::string toJson() const;
+    /**
+     * @brief 事件环中的事件，Chrome trace JSON 格式
+     */
+    std::string toChromeTrace() const;
+    bool writeChromeTrace(const std::string &path) const;
+
+private:
+    //stage 为 -1 表示环形缓冲区占用计数事件，value 为占用帧数；否则 value 为耗时
+    struct TraceEvent {
+        std::atomic<int> stage;
+        std::atomic<int> tid;
+        std::atomic<int64_t> beginNs;
+        std::atomic<int64_t> value;
+    };
+
+    void trace(int stage, int64_t beginNs, int64_t value);
+
+    LatencyHistogram m_histograms[StageCount];
+    std::atomic<uint64_t> m_counters[CounterCount];
+    std::atomic<int> m_ringSize;
+    std::atomic<int> m_ringMax;
+    std::atomic<int> m_ringCapacity;
+
+    std::atomic<bool> m_traceEnabled;
+    //只分配一次：先写容量再以 release 发布指针，读取方以 acquire 取指针后容量一定有效
+    std::mutex m_traceAllocMutex;
+    std::atomic<TraceEvent *> m_traceEvents;
+    std::atomic<size_t> m_traceCapacity;
+    std::atomic<uint64_t> m_traceNext;
+    std::atomic<int64_t> m_traceOriginNs;
+};
+
+#endif // RECORDINGSTATS_H
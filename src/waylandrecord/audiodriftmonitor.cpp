@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "audiodriftmonitor.h"
+
+#include <limits>
+
+static const int64_t UsPerSecond = 1000000LL;
+
+constexpr int64_t AudioDriftMonitor::WindowUs;
+constexpr int64_t AudioDriftMonitor::ToleranceUs;
+constexpr int64_t AudioDriftMonitor::ResyncUs;
+
+AudioDriftMonitor::AudioDriftMonitor()
+    : m_startUs(-1)
+    , m_driftUs(0)
+    , m_maxDriftUs(0)
+    , m_inserted(0)
+    , m_dropped(0)
+    , m_resyncs(0)
+{
+    reset(0);
+}
+
+void AudioDriftMonitor::reset(int sampleRate)
+{
+    m_sampleRate = sampleRate;
+    m_baseUs = -1;
+    m_delivered = 0;
+    m_corrected = 0;
+    m_offset = 0;
+    m_warmedUp = false;
+    m_windowStartUs = 0;
+    m_windowMax = std::numeric_limits<int64_t>::min();
+    m_estimate = 0;
+    m_hasEstimate = false;
+    m_correcting = 0;
+    m_startUs.store(-1, std::memory_order_relaxed);
+    m_driftUs.store(0, std::memory_order_relaxed);
+    m_maxDriftUs.store(0, std::memory_order_relaxed);
+    m_inserted.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_resyncs.store(0, std::memory_order_relaxed);
+}
+
+int AudioDriftMonitor::update(int64_t captureUs, int samples)
+{
+    if (m_sampleRate <= 0 || samples <= 0) {
+        return 0;
+    }
+    if (m_baseUs < 0) {
+        //第一批样本只建立起点，读到数据时最后一个样本刚采集完
+        m_baseUs = captureUs;
+        m_windowStartUs = captureUs;
+        m_startUs.store(captureUs - samplesToUs(samples), std::memory_order_release);
+        return 0;
+    }
+    m_delivered += samples;
+    const int64_t expected = (captureUs - m_baseUs) * m_sampleRate / UsPerSecond;
+    const int64_t rawDrift = m_delivered - expected;
+    if (rawDrift > m_windowMax) {
+        m_windowMax = rawDrift;
+    }
+    if (captureUs - m_windowStartUs >= WindowUs) {
+        if (!m_warmedUp) {
+            m_offset = m_windowMax;
+            m_warmedUp = true;
+        } else {
+            m_estimate = m_windowMax - m_offset;
+            m_hasEstimate = true;
+            if (samplesToUs(m_estimate + m_corrected) > ResyncUs
+                    || samplesToUs(m_estimate + m_corrected) < -ResyncUs) {
+                //漂移过大说明采集出现了断流或跳变，以当前位置重新建立基线
+                m_offset = m_windowMax + m_corrected;
+                m_estimate = -m_corrected;
+                m_correcting = 0;
+                m_resyncs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        m_windowStartUs = captureUs;
+        m_windowMax = std::numeric_limits<int64_t>::min();
+    }
+    if (!m_hasEstimate) {
+        return 0;
+    }
+
+    int64_t drift = m_estimate + m_corrected;
+    const int64_t tolerance = ToleranceUs * m_sampleRate / UsPerSecond;
+    if (m_correcting == 0) {
+        if (drift > tolerance) {
+            m_correcting = -1;
+        } else if (drift < -tolerance) {
+            m_correcting = 1;
+        }
+    } else if (drift <= tolerance / 4 && drift >= -tolerance / 4) {
+        m_correcting = 0;
+    }
+    if (m_correcting > 0) {
+        m_inserted.fetch_add(1, std::memory_order_relaxed);
+    } else if (m_correcting < 0) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_corrected += m_correcting;
+    drift += m_correcting;
+
+    const int64_t driftUs = samplesToUs(drift);
+    m_driftUs.store(driftUs, std::memory_order_relaxed);
+    const int64_t absDriftUs = driftUs < 0 ? -driftUs : driftUs;
+    if (absDriftUs > m_maxDriftUs.load(std::memory_order_relaxed)) {
+        m_maxDriftUs.store(absDriftUs, std::memory_order_relaxed);
+    }
+    return m_correcting;
+}
+
+int AudioDriftMonitor::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+int64_t AudioDriftMonitor::startUs() const
+{
+    return m_startUs.load(std::memory_order_acquire);
+}
+
+int64_t AudioDriftMonitor::driftUs() const
+{
+    return m_driftUs.load(std::memory_order_relaxed);
+}
+
+int64_t AudioDriftMonitor::maxDriftUs() const
+{
+    return m_maxDriftUs.load(std::memory_order_relaxed);
+}
+
+uint64_t AudioDriftMonitor::insertedSamples() const
+{
+    return m_inserted.load(std::memory_order_relaxed);
+}
+
+uint64_t AudioDriftMonitor::droppedSamples() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+uint64_t AudioDriftMonitor::resyncCount() const
+{
+    return m_resyncs.load(std::memory_order_relaxed);
+}
+
+int64_t AudioDriftMonitor::samplesToUs(int64_t samples) const
+{
+    return m_sampleRate > 0 ? samples * UsPerSecond / m_sampleRate : 0;
+}
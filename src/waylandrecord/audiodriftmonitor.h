@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef AUDIODRIFTMONITOR_H
+#define AUDIODRIFTMONITOR_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief 监测一路音频采集相对采集时钟的漂移，并给出插入/丢弃样本的修正量
+ *
+ * 声卡的实际采样率与标称值总有细微差别（例如 48003Hz），按样本数计算的音频时间戳
+ * 会随录制时长慢慢偏离视频：一小时可以累积上百毫秒。每次写入一批样本时调用 update，
+ * 用 "已写入样本数 - 经过时间 * 采样率" 得到漂移量：
+ *   - 采集时间戳只会因为调度延迟偏晚，因此每个统计窗口取漂移的最大值作为估计；
+ *   - 第一个窗口的估计作为基线，吸收采集设备的固有延迟和启动时的突发数据；
+ *   - 漂移超过 ToleranceUs 时开始修正，每批样本最多插入或丢弃一个样本，
+ *     回落到 ToleranceUs / 4 以内后停止，避免在阈值附近来回修正；
+ *   - 漂移超过 ResyncUs（设备切换、长时间断流）时不再逐个样本追赶，直接以当前位置作为新基线。
+ *
+ * update 只能在一个采集线程中调用，统计项可以在其他线程读取。
+ */
+class AudioDriftMonitor
+{
+public:
+    AudioDriftMonitor();
+
+    void reset(int sampleRate);
+
+    /**
+     * @brief 记录一批采集到的样本
+     * @param captureUs 读到这批样本时的采集时钟时间（微秒）
+     * @param samples 样本数（每声道）
+     * @return 本批样本需要的修正：正数为在末尾重复插入的样本数，负数为从末尾丢弃的样本数
+     */
+    int update(int64_t captureUs, int samples);
+
+    int sampleRate() const;
+    /**
+     * @brief 第一个样本的采集时间，尚未收到数据时为 -1
+     */
+    int64_t startUs() const;
+    /**
+     * @brief 修正后的当前漂移，正数表示音频样本多于经过的时间
+     */
+    int64_t driftUs() const;
+    int64_t maxDriftUs() const;
+    uint64_t insertedSamples() const;
+    uint64_t droppedSamples() const;
+    uint64_t resyncCount() const;
+
+    static constexpr int64_t WindowUs = 2000000;
+    static constexpr int64_t ToleranceUs = 20000;
+    static constexpr int64_t ResyncUs = 500000;
+
+private:
+    int64_t samplesToUs(int64_t samples) const;
+
+    int m_sampleRate;
+    int64_t m_baseUs;
+    int64_t m_delivered;
+    int64_t m_corrected;
+    int64_t m_offset;
+    bool m_warmedUp;
+    int64_t m_windowStartUs;
+    int64_t m_windowMax;
+    int64_t m_estimate;
+    bool m_hasEstimate;
+    int m_correcting;
+    std::atomic<int64_t> m_startUs;
+    std::atomic<int64_t> m_driftUs;
+    std::atomic<int64_t> m_maxDriftUs;
+    std::atomic<uint64_t> m_inserted;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic<uint64_t> m_resyncs;
+};
+
+#endif // AUDIODRIFTMONITOR_H
@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "audiomixer.h"
+
+#include <algorithm>
+
+//以下循环都是逐元素的简单运算，编译器可以自动向量化
+
+static void mixS16Saturate(const int16_t *first, const int16_t *second, int16_t *out, int values)
+{
+    for (int i = 0; i < values; i++) {
+        const int32_t sum = static_cast<int32_t>(first[i]) + static_cast<int32_t>(second[i]);
+        out[i] = static_cast<int16_t>(std::min<int32_t>(std::max<int32_t>(sum, INT16_MIN), INT16_MAX));
+    }
+}
+
+static void mixS16(const int16_t *first, const int16_t *second, int16_t *out, int values, float firstGain, float secondGain)
+{
+    for (int i = 0; i < values; i++) {
+        float sum = static_cast<float>(first[i]) * firstGain + static_cast<float>(second[i]) * secondGain;
+        sum = std::min(std::max(sum, static_cast<float>(INT16_MIN)), static_cast<float>(INT16_MAX));
+        out[i] = static_cast<int16_t>(sum + (sum >= 0.0f ? 0.5f : -0.5f));
+    }
+}
+
+static void mixS32(const int32_t *first, const int32_t *second, int32_t *out, int values, double firstGain, double secondGain)
+{
+    //32 位样本用双精度计算，避免单精度尾数不够丢失低位
+    for (int i = 0; i < values; i++) {
+        double sum = static_cast<double>(first[i]) * firstGain + static_cast<double>(second[i]) * secondGain;
+        sum = std::min(std::max(sum, static_cast<double>(INT32_MIN)), static_cast<double>(INT32_MAX));
+        out[i] = static_cast<int32_t>(sum + (sum >= 0.0 ? 0.5 : -0.5));
+    }
+}
+
+static void mixU8(const uint8_t *first, const uint8_t *second, uint8_t *out, int values, float firstGain, float secondGain)
+{
+    //无符号 8 位样本以 128 为零点
+    for (int i = 0; i < values; i++) {
+        float sum = (static_cast<float>(first[i]) - 128.0f) * firstGain + (static_cast<float>(second[i]) - 128.0f) * secondGain + 128.0f;
+        sum = std::min(std::max(sum, 0.0f), 255.0f);
+        out[i] = static_cast<uint8_t>(sum + 0.5f);
+    }
+}
+
+static void mixFloat(const float *first, const float *second, float *out, int values, float firstGain, float secondGain)
+{
+    for (int i = 0; i < values; i++) {
+        const float sum = first[i] * firstGain + second[i] * secondGain;
+        out[i] = std::min(std::max(sum, -1.0f), 1.0f);
+    }
+}
+
+AudioMixer::AudioMixer()
+    : m_type(UnsupportedSample)
+    , m_planes(0)
+    , m_firstGain(DefaultGain)
+    , m_secondGain(DefaultGain)
+{
+}
+
+bool AudioMixer::init(SampleType type, int planes)
+{
+    release();
+    if (type == UnsupportedSample || planes <= 0) {
+        return false;
+    }
+    m_type = type;
+    m_planes = planes;
+    return true;
+}
+
+void AudioMixer::release()
+{
+    m_type = UnsupportedSample;
+    m_planes = 0;
+}
+
+bool AudioMixer::isInit() const
+{
+    return m_type != UnsupportedSample;
+}
+
+AudioMixer::SampleType AudioMixer::sampleType() const
+{
+    return m_type;
+}
+
+void AudioMixer::setGains(float firstGain, float secondGain)
+{
+    m_firstGain = std::min(std::max(firstGain, 0.0f), MaxGain);
+    m_secondGain = std::min(std::max(secondGain, 0.0f), MaxGain);
+}
+
+float AudioMixer::firstGain() const
+{
+    return m_firstGain;
+}
+
+float AudioMixer::secondGain() const
+{
+    return m_secondGain;
+}
+
+bool AudioMixer::mix(const uint8_t *const *first, const uint8_t *const *second, uint8_t *const *out, int values) const
+{
+    if (!isInit() || nullptr == first || nullptr == second || nullptr == out || values < 0) {
+        return false;
+    }
+    for (int plane = 0; plane < m_planes; plane++) {
+        switch (m_type) {
+        case U8Sample:
+            mixU8(first[plane], second[plane], out[plane], values, m_firstGain, m_secondGain);
+            break;
+        case S16Sample:
+            if (m_firstGain == 1.0f && m_secondGain == 1.0f) {
+                mixS16Saturate(reinterpret_cast<const int16_t *>(first[plane]), reinterpret_cast<const int16_t *>(second[plane]),
+                               reinterpret_cast<int16_t *>(out[plane]), values);
+            } else {
+                mixS16(reinterpret_cast<const int16_t *>(first[plane]), reinterpret_cast<const int16_t *>(second[plane]),
+                       reinterpret_cast<int16_t *>(out[plane]), values, m_firstGain, m_secondGain);
+            }
+            break;
+        case S32Sample:
+            mixS32(reinterpret_cast<const int32_t *>(first[plane]), reinterpret_cast<const int32_t *>(second[plane]),
+                   reinterpret_cast<int32_t *>(out[plane]), values, m_firstGain, m_secondGain);
+            break;
+        case FloatSample:
+            mixFloat(reinterpret_cast<const float *>(first[plane]), reinterpret_cast<const float *>(second[plane]),
+                     reinterpret_cast<float *>(out[plane]), values, m_firstGain, m_secondGain);
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+#include <cstdint>
+
+/**
+ * @brief 两路音频的原生混音器，替代 libavfilter 的 amix 过滤器图
+ *
+ * 两路输入必须已经通过各自的 SwrContext 重采样成相同的格式、声道数和采样率，
+ * 混音结果为 first * firstGain + second * secondGain，超出范围时饱和截断。
+ * 默认增益均为 0.5，与两路输入时 amix 的输出电平一致。
+ *
+ * 平面格式每个声道一个平面；交错格式只有一个平面，每个平面的值个数为样本数乘以声道数。
+ * 混音器不持有缓冲区，mix 可以在任意线程调用。
+ */
+class AudioMixer
+{
+public:
+    enum SampleType {
+        UnsupportedSample = -1,
+        U8Sample = 0,
+        S16Sample,
+        S32Sample,
+        FloatSample
+    };
+
+    AudioMixer();
+
+    bool init(SampleType type, int planes);
+    void release();
+    bool isInit() const;
+    SampleType sampleType() const;
+
+    /**
+     * @brief 设置两路输入的增益，范围 [0, MaxGain]
+     */
+    void setGains(float firstGain, float secondGain);
+    float firstGain() const;
+    float secondGain() const;
+
+    /**
+     * @brief 混合两路输入，out 可以与任一路输入为同一块内存
+     * @param values 每个平面的值个数
+     */
+    bool mix(const uint8_t *const *first, const uint8_t *const *second, uint8_t *const *out, int values) const;
+
+    static constexpr float DefaultGain = 0.5f;
+    static constexpr float MaxGain = 4.0f;
+
+private:
+    SampleType m_type;
+    int m_planes;
+    float m_firstGain;
+    float m_secondGain;
+};
+
+#endif // AUDIOMIXER_H
@@ -0,0 +1,166 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "audiosamplefifo.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+AudioSampleFifo::AudioSampleFifo()
+    : m_planeBytes(0)
+    , m_planes(0)
+    , m_bytesPerSample(0)
+    , m_capacity(0)
+    , m_writePos(0)
+    , m_readPos(0)
+    , m_spaceWaiters(0)
+{
+}
+
+AudioSampleFifo::~AudioSampleFifo()
+{
+    release();
+}
+
+bool AudioSampleFifo::init(int planes, int bytesPerSample, int capacity)
+{
+    release();
+    if (planes <= 0 || bytesPerSample <= 0 || capacity <= 0) {
+        return false;
+    }
+    m_planes = planes;
+    m_bytesPerSample = bytesPerSample;
+    m_capacity = capacity;
+    m_planeBytes = static_cast<size_t>(bytesPerSample) * static_cast<size_t>(capacity);
+    m_buffer.assign(m_planeBytes * static_cast<size_t>(planes), 0);
+    m_writePos.store(0, std::memory_order_relaxed);
+    m_readPos.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void AudioSampleFifo::release()
+{
+    std::vector<uint8_t>().swap(m_buffer);
+    m_planeBytes = 0;
+    m_planes = 0;
+    m_bytesPerSample = 0;
+    m_capacity = 0;
+    m_writePos.store(0, std::memory_order_relaxed);
+    m_readPos.store(0, std::memory_order_relaxed);
+}
+
+bool AudioSampleFifo::isInit() const
+{
+    return m_capacity > 0;
+}
+
+int AudioSampleFifo::planes() const
+{
+    return m_planes;
+}
+
+int AudioSampleFifo::capacity() const
+{
+    return m_capacity;
+}
+
+int AudioSampleFifo::size() const
+{
+    const uint64_t write = m_writePos.load(std::memory_order_acquire);
+    const uint64_t read = m_readPos.load(std::memory_order_acquire);
+    return static_cast<int>(write - read);
+}
+
+int AudioSampleFifo::space() const
+{
+    return m_capacity - size();
+}
+
+bool AudioSampleFifo::waitForSpace(int samples, int timeoutMs)
+{
+    if (space() >= samples) {
+        return true;
+    }
+    //先登记等待者再检查空间，消费者发布读位置后再检查等待者，两者至少有一方能看到对方
+    m_spaceWaiters.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool enough = false;
+    {
+        std::unique_lock<std::mutex> locker(m_spaceMutex);
+        enough = m_spaceCond.wait_for(locker, std::chrono::milliseconds(timeoutMs), [this, samples]() {
+            return space() >= samples;
+        });
+    }
+    m_spaceWaiters.fetch_sub(1);
+    return enough;
+}
+
+int AudioSampleFifo::write(const uint8_t *const *data, int samples)
+{
+    if (!isInit() || nullptr == data || samples <= 0) {
+        return 0;
+    }
+    const uint64_t write = m_writePos.load(std::memory_order_relaxed);
+    const uint64_t read = m_readPos.load(std::memory_order_acquire);
+    const int count = std::min(samples, m_capacity - static_cast<int>(write - read));
+    if (count <= 0) {
+        return 0;
+    }
+    copyIn(data, write, count);
+    //先写数据再发布位置，消费者看到新位置时数据已可见
+    m_writePos.store(write + static_cast<uint64_t>(count), std::memory_order_release);
+    return count;
+}
+
+int AudioSampleFifo::read(uint8_t *const *data, int samples)
+{
+    if (!isInit() || nullptr == data || samples <= 0) {
+        return 0;
+    }
+    const uint64_t read = m_readPos.load(std::memory_order_relaxed);
+    const uint64_t write = m_writePos.load(std::memory_order_acquire);
+    const int count = std::min(samples, static_cast<int>(write - read));
+    if (count <= 0) {
+        return 0;
+    }
+    copyOut(data, read, count);
+    m_readPos.store(read + static_cast<uint64_t>(count), std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_spaceWaiters.load() > 0) {
+        //加锁后再通知，避免生产者检查完空间、尚未进入等待时错过唤醒
+        std::lock_guard<std::mutex> locker(m_spaceMutex);
+        m_spaceCond.notify_all();
+    }
+    return count;
+}
+
+void AudioSampleFifo::copyIn(const uint8_t *const *data, uint64_t position, int samples)
+{
+    //环形缓冲区末尾放不下时分两段拷贝
+    const size_t offset = static_cast<size_t>(position % static_cast<uint64_t>(m_capacity)) * static_cast<size_t>(m_bytesPerSample);
+    const size_t bytes = static_cast<size_t>(samples) * static_cast<size_t>(m_bytesPerSample);
+    const size_t first = std::min(bytes, m_planeBytes - offset);
+    for (int plane = 0; plane < m_planes; plane++) {
+        uint8_t *dst = m_buffer.data() + static_cast<size_t>(plane) * m_planeBytes;
+        memcpy(dst + offset, data[plane], first);
+        if (bytes > first) {
+            memcpy(dst, data[plane] + first, bytes - first);
+        }
+    }
+}
+
+void AudioSampleFifo::copyOut(uint8_t *const *data, uint64_t position, int samples)
+{
+    const size_t offset = static_cast<size_t>(position % static_cast<uint64_t>(m_capacity)) * static_cast<size_t>(m_bytesPerSample);
+    const size_t bytes = static_cast<size_t>(samples) * static_cast<size_t>(m_bytesPerSample);
+    const size_t first = std::min(bytes, m_planeBytes - offset);
+    for (int plane = 0; plane < m_planes; plane++) {
+        const uint8_t *src = m_buffer.data() + static_cast<size_t>(plane) * m_planeBytes;
+        memcpy(data[plane], src + offset, first);
+        if (bytes > first) {
+            memcpy(data[plane] + first, src, bytes - first);
+        }
+    }
+}
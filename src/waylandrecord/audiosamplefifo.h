@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef AUDIOSAMPLEFIFO_H
+#define AUDIOSAMPLEFIFO_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief 单生产者单消费者的无锁音频样本环形缓冲区
+ *
+ * 替代混音路径中由 m_audioReadWriteMutex 保护的 AVAudioFifo：
+ * 麦克风/系统音频采集线程各自写入自己的缓冲区，混音线程读取，两端互不加锁。
+ * 容量在 init 时一次性分配，写满时 write 只写入剩余空间能容纳的样本，不会扩容。
+ * 生产者可用 waitForSpace 等待消费者腾出空间，只有存在等待者时 read 才加锁唤醒。
+ *
+ * 平面格式（如 FLTP）每个声道一个平面，planes 为声道数，bytesPerSample 为单个样本的字节数；
+ * 交错格式只有一个平面，bytesPerSample 为单个样本的字节数乘以声道数。
+ */
+class AudioSampleFifo
+{
+public:
+    AudioSampleFifo();
+    ~AudioSampleFifo();
+
+    AudioSampleFifo(const AudioSampleFifo &) = delete;
+    AudioSampleFifo &operator=(const AudioSampleFifo &) = delete;
+
+    /**
+     * @brief 分配缓冲区，必须在生产者和消费者开始工作前调用
+     * @param capacity 可容纳的样本数
+     */
+    bool init(int planes, int bytesPerSample, int capacity);
+
+    /**
+     * @brief 释放缓冲区，调用时生产者和消费者必须都已停止
+     */
+    void release();
+
+    bool isInit() const;
+    int planes() const;
+    int capacity() const;
+
+    /**
+     * @brief 可读的样本数，任意线程可调用
+     */
+    int size() const;
+
+    /**
+     * @brief 可写的样本数，任意线程可调用
+     */
+    int space() const;
+
+    /**
+     * @brief 生产者等待可写空间达到 samples 个样本，消费者读出样本后立即唤醒
+     * @return 超时仍不足时返回 false
+     */
+    bool waitForSpace(int samples, int timeoutMs);
+
+    /**
+     * @brief 生产者写入样本
+     * @param data 每个平面一个指针
+     * @return 实际写入的样本数（空间不足时少于 samples）
+     */
+    int write(const uint8_t *const *data, int samples);
+
+    /**
+     * @brief 消费者读出样本
+     * @param data 每个平面一个指针，每个平面至少能容纳 samples 个样本
+     * @return 实际读出的样本数（数据不足时少于 samples）
+     */
+    int read(uint8_t *const *data, int samples);
+
+private:
+    void copyIn(const uint8_t *const *data, uint64_t position, int samples);
+    void copyOut(uint8_t *const *data, uint64_t position, int samples);
+
+    static constexpr size_t CacheLineSize = 64;
+
+    std::vector<uint8_t> m_buffer;
+    size_t m_planeBytes;
+    int m_planes;
+    int m_bytesPerSample;
+    int m_capacity;
+    //生产者和消费者各自的位置放在不同的缓存行，避免伪共享
+    alignas(CacheLineSize) std::atomic<uint64_t> m_writePos;
+    alignas(CacheLineSize) std::atomic<uint64_t> m_readPos;
+    std::atomic<int> m_spaceWaiters;
+    std::mutex m_spaceMutex;
+    std::condition_variable m_spaceCond;
+};
+
+#endif // AUDIOSAMPLEFIFO_H
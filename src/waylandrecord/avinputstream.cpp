@@ -11,22 +11,29 @@
 #include <QDebug>
 #include <QThread>
 #include <QMutexLocker>
-#include "recordadmin.h"
+#include <QRegularExpression>
+#include "avoutputstream.h"
+#include "channellayouts.h"
+#include "captureclock.h"
 #include "../utils/log.h"
 
-CAVInputStream::CAVInputStream(WaylandIntegration::WaylandIntegrationPrivate *context):
-    m_context(context)
+CAVInputStream::CAVInputStream(CAVOutputStream *outputStream):
+    m_outputStream(outputStream)
 {
     qCDebug(dsrApp) << "CAVInputStream initialized.";
     m_bMix = false;
     setbWriteAmix(true);
     m_hMicAudioThread = 0;
+    m_hSysAudioThread = 0;
+    m_hMixThread = 0;
     setbRunThread(true);
     //m_outPutType = MP4_MKV_;
     m_pMicAudioFormatContext = nullptr;
     m_pSysAudioFormatContext = nullptr;
     m_pAudioInputFormat = nullptr;
     m_pAudioCardInputFormat = nullptr;
+    m_pMicDecoderContext = nullptr;
+    m_pSysDecoderContext = nullptr;
     dec_pkt = nullptr;
     m_bMicAudio = false;
     m_bSysAudio = false;
@@ -50,6 +57,9 @@ CAVInputStream::~CAVInputStream(void)
     printf("Desctruction Input!\n");
     setbWriteAmix(false);
     setbRunThread(false);
+    onsFinisheStream();
+    avlibInterface::m_avcodec_free_context(&m_pMicDecoderContext);
+    avlibInterface::m_avcodec_free_context(&m_pSysDecoderContext);
 }
 
 void CAVInputStream::setMicAudioRecord(bool bRecord)
@@ -121,7 +131,7 @@ bool CAVInputStream::openMicStream()
         }
         m_micAudioindex = -1;
         for (int i = 0; i < static_cast<int>(m_pMicAudioFormatContext->nb_streams); i++) {
-            if (m_pMicAudioFormatContext->streams[i]->codec->codec_type == AVMEDIA_TYPE_AUDIO) {
+            if (m_pMicAudioFormatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
                 m_micAudioindex = i;
                 qCDebug(dsrApp) << "Found microphone audio stream at index:" << i;
                 break;
@@ -131,7 +141,8 @@ bool CAVInputStream::openMicStream()
             qCWarning(dsrApp) << "No audio stream found for microphone.";
             return false;
         }
-        if (avlibInterface::m_avcodec_open2(m_pMicAudioFormatContext->streams[m_micAudioindex]->codec, avlibInterface::m_avcodec_find_decoder(m_pMicAudioFormatContext->streams[m_micAudioindex]->codec->codec_id), nullptr) < 0) {
+        m_pMicDecoderContext = openDecoder(m_pMicAudioFormatContext->streams[m_micAudioindex]);
+        if (nullptr == m_pMicDecoderContext) {
             qCWarning(dsrApp) << "Failed to open audio codec for microphone.";
             return false;
         }
@@ -168,7 +179,7 @@ bool CAVInputStream::openSysStream()
         fflush(stdout);
         m_sysAudioindex = -1;
         for (int i = 0; i < static_cast<int>(m_pSysAudioFormatContext->nb_streams); i++) {
-            if (m_pSysAudioFormatContext->streams[i]->codec->codec_type == AVMEDIA_TYPE_AUDIO) {
+            if (m_pSysAudioFormatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
                 m_sysAudioindex = i;
                 qCDebug(dsrApp) << "Found system audio stream at index:" << i;
                 break;
@@ -178,8 +189,9 @@ bool CAVInputStream::openSysStream()
             qCWarning(dsrApp) << "No audio stream found for system audio.";
             return false;
         }
-        ///Caution, m_pAudFmtCtx->streams[m_audioindex]->codec->codec_id =14, AV_CODEC_ID_RAWVIDEO
-        if (avlibInterface::m_avcodec_open2(m_pSysAudioFormatContext->streams[m_sysAudioindex]->codec, avlibInterface::m_avcodec_find_decoder(m_pSysAudioFormatContext->streams[m_sysAudioindex]->codec->codec_id), nullptr) < 0) {
+        ///Caution, m_pAudFmtCtx->streams[m_audioindex]->codecpar->codec_id =14, AV_CODEC_ID_RAWVIDEO
+        m_pSysDecoderContext = openDecoder(m_pSysAudioFormatContext->streams[m_sysAudioindex]);
+        if (nullptr == m_pSysDecoderContext) {
             qCWarning(dsrApp) << "Failed to open audio codec for system audio.";
             return false;
         }
@@ -193,10 +205,44 @@ bool CAVInputStream::openSysStream()
     }
 }
 
+AVCodecContext *CAVInputStream::openDecoder(AVStream *stream)
+{
+    const AVCodec *decoder = avlibInterface::m_avcodec_find_decoder(stream->codecpar->codec_id);
+    if (nullptr == decoder) {
+        qCWarning(dsrApp) << "No decoder found for codec id:" << stream->codecpar->codec_id;
+        return nullptr;
+    }
+    AVCodecContext *context = avlibInterface::m_avcodec_alloc_context3(decoder);
+    if (nullptr == context) {
+        return nullptr;
+    }
+    if (avlibInterface::m_avcodec_parameters_to_context(context, stream->codecpar) < 0
+            || avlibInterface::m_avcodec_open2(context, decoder, nullptr) < 0) {
+        avlibInterface::m_avcodec_free_context(&context);
+        return nullptr;
+    }
+    return context;
+}
+
+int CAVInputStream::decodeAudioPacket(AVCodecContext *decoder, AVPacket *packet, AVFrame *frame, AudioFrameWriter writer)
+{
+    //AVPacket -> AVFrame，空包冲刷解码器中剩余的帧
+    int ret = avlibInterface::m_avcodec_send_packet(decoder, packet->size > 0 ? packet : nullptr);
+    if (ret < 0 && ret != AVERROR_EOF && ret != AVERROR(EAGAIN)) {
+        return ret;
+    }
+    /** If there is decoded data, convert and store it */
+    while (avlibInterface::m_avcodec_receive_frame(decoder, frame) >= 0) {
+        (m_outputStream->*writer)(decoder, frame, CaptureClock::nowUs());
+        avlibInterface::m_av_frame_unref(frame);
+    }
+    return 0;
+}
+
 bool CAVInputStream::audioCapture()
 {
     qCInfo(dsrApp) << "Starting audio capture";
-    m_start_time = avlibInterface::m_av_gettime();
+    m_start_time = CaptureClock::nowUs();
     qCDebug(dsrApp) << "Audio capture start time set:" << m_start_time;
     if (m_bMix) {
         qCDebug(dsrApp) << "Creating audio mixing threads";
@@ -339,16 +385,20 @@ void CAVInputStream::setbRunThread(bool bRunThread)
 void  CAVInputStream::onsFinisheStream()
 {
     qCInfo(dsrApp) << "Finishing audio streams";
+    //调用方已清除 bRunThread/bWriteMix，等待采集和混音线程写完最后一帧后退出，之后才能关闭输出
     if (m_hMixThread) {
-        qCDebug(dsrApp) << "Clearing mix thread handle";
+        qCDebug(dsrApp) << "Joining mix thread";
+        pthread_join(m_hMixThread, nullptr);
         m_hMixThread = 0;
     }
     if (m_hMicAudioThread) {
-        qCDebug(dsrApp) << "Clearing microphone audio thread handle";
+        qCDebug(dsrApp) << "Joining microphone audio thread";
+        pthread_join(m_hMicAudioThread, nullptr);
         m_hMicAudioThread = 0;
     }
     if (m_hSysAudioThread) {
-        qCDebug(dsrApp) << "Clearing system audio thread handle";
+        qCDebug(dsrApp) << "Joining system audio thread";
+        pthread_join(m_hSysAudioThread, nullptr);
         m_hSysAudioThread = 0;
     }
     qCInfo(dsrApp) << "Audio streams finished";
@@ -365,7 +415,7 @@ void CAVInputStream::writMixAudio()
 {
     qCDebug(dsrApp) << "Starting mixed audio write loop";
     while (bWriteMix() && m_bMix) {
-        m_context->m_recordAdmin->m_pOutputStream->writeMixAudio();
+        m_outputStream->writeMixAudio();
     }
     qCDebug(dsrApp) << "Mixed audio write loop ended";
 }
@@ -388,7 +438,6 @@ void *CAVInputStream::captureMicToMixAudioThreadFunc(void *param)
 int CAVInputStream::readMicAudioPacket()
 {
     qCInfo(dsrApp) << "Starting microphone audio packet reading";
-    int got_frame_ptr = 0;
     //start decode and encode
     while (bRunThread()) {
         int ret;
@@ -416,8 +465,7 @@ int CAVInputStream::readMicAudioPacket()
                 continue;
             }
         }
-        //AVPacket -> AVFrame
-        if ((ret = avlibInterface::m_avcodec_decode_audio4(m_pMicAudioFormatContext->streams[m_micAudioindex]->codec, inputFrame, &got_frame_ptr, &inputPacket)) < 0) {
+        if ((ret = decodeAudioPacket(m_pMicDecoderContext, &inputPacket, inputFrame, &CAVOutputStream::writeMicAudioFrame)) < 0) {
             qCCritical(dsrApp) << "Could not decode audio frame";
             printf("Could not decode audio frame\n");
             avlibInterface::m_av_packet_unref(&inputPacket);
@@ -425,11 +473,6 @@ int CAVInputStream::readMicAudioPacket()
             return ret;
         }
         avlibInterface::m_av_packet_unref(&inputPacket);
-        /** If there is decoded data, convert and store it */
-        if (got_frame_ptr) {
-            qCDebug(dsrApp) << "Writing decoded microphone audio frame";
-            m_context->m_recordAdmin->m_pOutputStream->writeMicAudioFrame(m_pMicAudioFormatContext->streams[m_micAudioindex], inputFrame, avlibInterface::m_av_gettime() - m_start_time);
-        }
         avlibInterface::m_av_frame_free(&inputFrame);
         fflush(stdout);
     }// -- while end
@@ -442,6 +485,7 @@ int CAVInputStream::readMicAudioPacket()
         avlibInterface::m_avformat_free_context(m_pMicAudioFormatContext);
         m_pMicAudioFormatContext = nullptr;
     }
+    avlibInterface::m_avcodec_free_context(&m_pMicDecoderContext);
     m_micAudioindex = -1;
     qCInfo(dsrApp) << "Microphone audio packet reading completed";
     return 0;
@@ -450,7 +494,6 @@ int CAVInputStream::readMicAudioPacket()
 int CAVInputStream::readMicToMixAudioPacket()
 {
     qCInfo(dsrApp) << "Starting microphone to mix audio packet reading";
-    int got_frame_ptr = 0;
     //start decode and encode
     while (bRunThread()) {
         int ret;
@@ -478,8 +521,7 @@ int CAVInputStream::readMicToMixAudioPacket()
                 continue;
             }
         }
-        //AVPacket -> AVFrame
-        if ((ret = avlibInterface::m_avcodec_decode_audio4(m_pMicAudioFormatContext->streams[m_micAudioindex]->codec, inputFrame, &got_frame_ptr, &inputPacket)) < 0) {
+        if ((ret = decodeAudioPacket(m_pMicDecoderContext, &inputPacket, inputFrame, &CAVOutputStream::writeMicToMixAudioFrame)) < 0) {
             qCCritical(dsrApp) << "Could not decode audio frame";
             printf("Could not decode audio frame\n");
             avlibInterface::m_av_packet_unref(&inputPacket);
@@ -487,11 +529,6 @@ int CAVInputStream::readMicToMixAudioPacket()
             return ret;
         }
         avlibInterface::m_av_packet_unref(&inputPacket);
-        /** If there is decoded data, convert and store it 如果有解码的数据，转换并存储它*/
-        if (got_frame_ptr) {
-            qCDebug(dsrApp) << "Writing decoded microphone frame to mix";
-            m_context->m_recordAdmin->m_pOutputStream->writeMicToMixAudioFrame(m_pMicAudioFormatContext->streams[m_micAudioindex], inputFrame, avlibInterface::m_av_gettime() - m_start_time);
-        }
         avlibInterface::m_av_frame_free(&inputFrame);
         fflush(stdout);
     }// -- while end
@@ -504,6 +541,7 @@ int CAVInputStream::readMicToMixAudioPacket()
         avlibInterface::m_avformat_free_context(m_pMicAudioFormatContext);
         m_pMicAudioFormatContext = nullptr;
     }
+    avlibInterface::m_avcodec_free_context(&m_pMicDecoderContext);
     m_micAudioindex = -1;
     qCInfo(dsrApp) << "Microphone to mix audio packet reading completed";
     return 0;
@@ -531,7 +569,6 @@ int CAVInputStream::readSysAudioPacket()
         return 1;
     }
     qCInfo(dsrApp) << "Starting system audio packet reading";
-    int got_frame_ptr = 0;
     //start decode and encode
     while (bRunThread()) {
         int ret;
@@ -557,18 +594,13 @@ int CAVInputStream::readSysAudioPacket()
                 continue;
             }
         }
-        if ((ret = avlibInterface::m_avcodec_decode_audio4(m_pSysAudioFormatContext->streams[m_sysAudioindex]->codec, input_frame, &got_frame_ptr, &inputPacket)) < 0) {
+        if ((ret = decodeAudioPacket(m_pSysDecoderContext, &inputPacket, input_frame, &CAVOutputStream::writeSysAudioFrame)) < 0) {
             printf("Could not decode audio frame\n");
             avlibInterface::m_av_packet_unref(&inputPacket);
             avlibInterface::m_av_frame_free(&input_frame);
             return ret;
         }
         avlibInterface::m_av_packet_unref(&inputPacket);
-        /** If there is decoded data, convert and store it */
-        if (got_frame_ptr) {
-            qCDebug(dsrApp) << "Writing decoded system audio frame";
-            m_context->m_recordAdmin->m_pOutputStream->writeSysAudioFrame(m_pSysAudioFormatContext->streams[m_sysAudioindex], input_frame, avlibInterface::m_av_gettime() - m_start_time);
-        }
         avlibInterface::m_av_frame_free(&input_frame);
     }// -- while end
     if (nullptr != m_pSysAudioFormatContext) {
@@ -580,6 +612,7 @@ int CAVInputStream::readSysAudioPacket()
         avlibInterface::m_avformat_free_context(m_pSysAudioFormatContext);
         m_pSysAudioFormatContext = nullptr;
     }
+    avlibInterface::m_avcodec_free_context(&m_pSysDecoderContext);
     m_sysAudioindex = -1;
     qCInfo(dsrApp) << "System audio packet reading completed";
     return 0;
@@ -588,7 +621,6 @@ int CAVInputStream::readSysAudioPacket()
 int CAVInputStream::readSysToMixAudioPacket()
 {
     qCInfo(dsrApp) << "Starting system to mix audio packet reading";
-    int got_frame_ptr = 0;
     while (bRunThread()) {
         int ret;
         AVFrame *inputFrame = avlibInterface::m_av_frame_alloc();
@@ -613,7 +645,7 @@ int CAVInputStream::readSysToMixAudioPacket()
                 continue;
             }
         }
-        if ((ret = avlibInterface::m_avcodec_decode_audio4(m_pSysAudioFormatContext->streams[m_sysAudioindex]->codec, inputFrame, &got_frame_ptr, &inputPacket)) < 0) {
+        if ((ret = decodeAudioPacket(m_pSysDecoderContext, &inputPacket, inputFrame, &CAVOutputStream::writeSysToMixAudioFrame)) < 0) {
             qCCritical(dsrApp) << "Could not decode audio frame";
             printf("Could not decode audio frame\n");
             avlibInterface::m_av_packet_unref(&inputPacket);
@@ -621,10 +653,6 @@ int CAVInputStream::readSysToMixAudioPacket()
             return ret;
         }
         avlibInterface::m_av_packet_unref(&inputPacket);
-        if (got_frame_ptr) {
-            qCDebug(dsrApp) << "Writing decoded system frame to mix";
-            m_context->m_recordAdmin->m_pOutputStream->writeSysToMixAudioFrame(m_pSysAudioFormatContext->streams[m_sysAudioindex], inputFrame, avlibInterface::m_av_gettime() - m_start_time);
-        }
         avlibInterface::m_av_frame_free(&inputFrame);
     }// -- while end
     if (nullptr != m_pSysAudioFormatContext) {
@@ -636,6 +664,7 @@ int CAVInputStream::readSysToMixAudioPacket()
         avlibInterface::m_avformat_free_context(m_pSysAudioFormatContext);
         m_pSysAudioFormatContext = nullptr;
     }
+    avlibInterface::m_avcodec_free_context(&m_pSysDecoderContext);
     m_sysAudioindex = -1;
     qCInfo(dsrApp) << "System to mix audio packet reading completed";
     return 0;
@@ -655,11 +684,11 @@ bool CAVInputStream::GetVideoInputInfo(int &width, int &height, int &frame_rate,
 bool CAVInputStream::GetAudioInputInfo(AVSampleFormat &sample_fmt, int &sample_rate, int &channels, int &layout)
 {
     qCDebug(dsrApp) << "Getting audio input information";
-    if (m_micAudioindex != -1) {
-        sample_fmt = m_pMicAudioFormatContext->streams[m_micAudioindex]->codec->sample_fmt;
-        sample_rate = m_pMicAudioFormatContext->streams[m_micAudioindex]->codec->sample_rate;
-        channels = m_pMicAudioFormatContext->streams[m_micAudioindex]->codec->channels;
-        layout = static_cast<int>(m_pMicAudioFormatContext->streams[m_micAudioindex]->codec->channel_layout);
+    if (m_micAudioindex != -1 && m_pMicDecoderContext) {
+        sample_fmt = m_pMicDecoderContext->sample_fmt;
+        sample_rate = m_pMicDecoderContext->sample_rate;
+        channels = ChannelLayouts::count(m_pMicDecoderContext);
+        layout = static_cast<int>(ChannelLayouts::mask(m_pMicDecoderContext));
         qCDebug(dsrApp) << "Audio input info - Sample rate:" << sample_rate << "Channels:" << channels;
         return true;
     }
@@ -670,11 +699,11 @@ bool CAVInputStream::GetAudioInputInfo(AVSampleFormat &sample_fmt, int &sample_r
 bool CAVInputStream::GetAudioSCardInputInfo(AVSampleFormat &sample_fmt, int &sample_rate, int &channels, int &layout)
 {
     qCDebug(dsrApp) << "Getting system audio card input information";
-    if (m_sysAudioindex != -1) {
-        sample_fmt = m_pSysAudioFormatContext->streams[m_sysAudioindex]->codec->sample_fmt;
-        sample_rate = m_pSysAudioFormatContext->streams[m_sysAudioindex]->codec->sample_rate;
-        channels = m_pSysAudioFormatContext->streams[m_sysAudioindex]->codec->channels;
-        layout = static_cast<int>(m_pSysAudioFormatContext->streams[m_sysAudioindex]->codec->channel_layout);
+    if (m_sysAudioindex != -1 && m_pSysDecoderContext) {
+        sample_fmt = m_pSysDecoderContext->sample_fmt;
+        sample_rate = m_pSysDecoderContext->sample_rate;
+        channels = ChannelLayouts::count(m_pSysDecoderContext);
+        layout = static_cast<int>(ChannelLayouts::mask(m_pSysDecoderContext));
         qCDebug(dsrApp) << "System audio input info - Sample rate:" << sample_rate << "Channels:" << channels;
         return true;
     }
@@ -685,9 +714,8 @@ bool CAVInputStream::GetAudioSCardInputInfo(AVSampleFormat &sample_fmt, int &sam
 QString CAVInputStream::currentAudioChannel()
 {
     qCDebug(dsrApp) << "Getting current audio channel";
-    QString command = QString("pacmd list-sources");
     QProcess process;
-    process.start(command);
+    process.start("pacmd", QStringList() << "list-sources");
     process.waitForFinished();
     process.waitForReadyRead();
     QString str_output = process.readAllStandardOutput();
@@ -702,7 +730,7 @@ QString CAVInputStream::currentAudioChannel()
     }
 
     if (!targetLine.isEmpty()) {
-        targetLine.remove(QRegExp(".* "));
+        targetLine.remove(QRegularExpression(".* "));
     }
 
     process.close();
@@ -11,14 +11,20 @@
 #include <qqueue.h>
 #include <QMutex>
 #include "avlibinterface.h"
-#include "waylandintegration_p.h"
 
 using namespace std;
 
+class CAVOutputStream;
+
 class CAVInputStream
 {
 public:
-    explicit CAVInputStream(WaylandIntegration::WaylandIntegrationPrivate *context);
+    /**
+     * @brief 解码后的音频帧交给输出流的写入函数
+     */
+    typedef int (CAVOutputStream::*AudioFrameWriter)(AVCodecContext *inputContext, AVFrame *inputFrame, int64_t lTimeStamp);
+
+    explicit CAVInputStream(CAVOutputStream *outputStream);
     ~CAVInputStream(void);
 
 public:
@@ -29,6 +35,9 @@ public:
      * @return 是否打成功
      */
     bool  openInputStream();
+    /**
+     * @brief 等待音频采集和混音线程退出，需先调用 setbRunThread(false) 和 setbWriteAmix(false)
+     */
     void  onsFinisheStream();
     bool  audioCapture();
     bool  GetVideoInputInfo(int &width, int &height, int &framerate, AVPixelFormat &pixFmt);
@@ -67,11 +76,15 @@ public:
     /**
      * @brief m_pAudioInputFormat 麦克风音频输入格式
      */
-    AVInputFormat  *m_pAudioInputFormat;
+    const AVInputFormat  *m_pAudioInputFormat;
     /**
      * @brief m_pAudioCardInputFormat 系统音频输入格式
      */
-    AVInputFormat  *m_pAudioCardInputFormat;
+    const AVInputFormat  *m_pAudioCardInputFormat;
+    //麦克风音频解码器上下文，由 openMicStream 按输入流的 codecpar 创建
+    AVCodecContext *m_pMicDecoderContext;
+    //系统声卡音频解码器上下文
+    AVCodecContext *m_pSysDecoderContext;
     AVPacket *dec_pkt;
     pthread_t  m_hMicAudioThread, m_hSysAudioThread; //线程句柄
     pthread_t  m_hMixThread;
@@ -108,12 +121,22 @@ protected:
      * @return 是否打开成功
      */
     bool openSysStream();
+    /**
+     * @brief 按输入流的参数创建并打开解码器
+     * @return 解码器上下文，失败时返回 nullptr
+     */
+    static AVCodecContext *openDecoder(AVStream *stream);
+    /**
+     * @brief 送入一个包并把解出的全部音频帧交给 writer；空包表示输入结束，冲刷解码器
+     * @return 送包失败时返回 FFmpeg 的错误码，否则返回 0
+     */
+    int decodeAudioPacket(AVCodecContext *decoder, AVPacket *packet, AVFrame *frame, AudioFrameWriter writer);
 private:
     bool m_bWriteMix;
     QMutex m_bWriteMixMutex;
     bool m_bRunThread;
     QMutex m_bRunThreadMutex;
-    WaylandIntegration::WaylandIntegrationPrivate *m_context;
+    CAVOutputStream *m_outputStream;
 };
 
 #endif //AVINPUTSTREAM_H
@@ -19,6 +19,10 @@ avlibInterface::p_av_get_channel_layout_nb_channels avlibInterface::m_av_get_cha
 avlibInterface::p_av_audio_fifo_read avlibInterface::m_av_audio_fifo_read = nullptr;
 avlibInterface::p_av_audio_fifo_write avlibInterface::m_av_audio_fifo_write = nullptr;
 avlibInterface::p_av_frame_get_buffer avlibInterface::m_av_frame_get_buffer = nullptr;
+avlibInterface::p_av_frame_make_writable avlibInterface::m_av_frame_make_writable = nullptr;
+avlibInterface::p_av_frame_is_writable avlibInterface::m_av_frame_is_writable = nullptr;
+avlibInterface::p_av_sample_fmt_is_planar avlibInterface::m_av_sample_fmt_is_planar = nullptr;
+avlibInterface::p_av_get_bytes_per_sample avlibInterface::m_av_get_bytes_per_sample = nullptr;
 avlibInterface::p_av_frame_apply_cropping avlibInterface::m_av_frame_apply_cropping = nullptr;
 avlibInterface::p_av_frame_unref avlibInterface::m_av_frame_unref = nullptr;
 avlibInterface::p_av_free avlibInterface::m_av_free = nullptr;
@@ -30,29 +34,36 @@ avlibInterface::p_av_samples_alloc avlibInterface::m_av_samples_alloc = nullptr;
 avlibInterface::p_av_rescale_q avlibInterface::m_av_rescale_q = nullptr;
 avlibInterface::p_av_rescale_q_rnd avlibInterface::m_av_rescale_q_rnd = nullptr;
 avlibInterface::p_av_dict_set avlibInterface::m_av_dict_set = nullptr;
+avlibInterface::p_av_dict_free avlibInterface::m_av_dict_free = nullptr;
 avlibInterface::p_av_freep avlibInterface::m_av_freep = nullptr;
 avlibInterface::p_av_audio_fifo_free avlibInterface::m_av_audio_fifo_free = nullptr;
 avlibInterface::p_av_malloc avlibInterface::m_av_malloc = nullptr;
 avlibInterface::p_av_opt_set_bin avlibInterface::m_av_opt_set_bin = nullptr;
 avlibInterface::p_av_int_list_length_for_size avlibInterface::m_av_int_list_length_for_size = nullptr;
+avlibInterface::p_av_image_get_buffer_size avlibInterface::m_av_image_get_buffer_size = nullptr;
+avlibInterface::p_av_image_fill_arrays avlibInterface::m_av_image_fill_arrays = nullptr;
+#ifdef AVLIB_CH_LAYOUT_API
+avlibInterface::p_av_channel_layout_default avlibInterface::m_av_channel_layout_default = nullptr;
+avlibInterface::p_av_channel_layout_from_mask avlibInterface::m_av_channel_layout_from_mask = nullptr;
+avlibInterface::p_av_channel_layout_copy avlibInterface::m_av_channel_layout_copy = nullptr;
+avlibInterface::p_av_channel_layout_uninit avlibInterface::m_av_channel_layout_uninit = nullptr;
+#endif
 
-avlibInterface::p_avcodec_register_all avlibInterface::m_avcodec_register_all = nullptr; //libavcodec
-avlibInterface::p_av_init_packet avlibInterface::m_av_init_packet = nullptr;
-avlibInterface::p_avcodec_decode_audio4 avlibInterface::m_avcodec_decode_audio4 = nullptr;
+avlibInterface::p_av_init_packet avlibInterface::m_av_init_packet = nullptr; //libavcodec
 avlibInterface::p_av_packet_unref avlibInterface::m_av_packet_unref = nullptr;
 avlibInterface::p_avcodec_open2 avlibInterface::m_avcodec_open2 = nullptr;
 avlibInterface::p_avcodec_find_decoder avlibInterface::m_avcodec_find_decoder = nullptr;
 avlibInterface::p_avcodec_alloc_context3 avlibInterface::m_avcodec_alloc_context3 = nullptr;
-avlibInterface::p_avcodec_encode_video2 avlibInterface::m_avcodec_encode_video2 = nullptr;
-avlibInterface::p_av_free_packet avlibInterface::m_av_free_packet = nullptr;
-avlibInterface::p_avcodec_encode_audio2 avlibInterface::m_avcodec_encode_audio2 = nullptr;
-avlibInterface::p_avcodec_close avlibInterface::m_avcodec_close = nullptr;
+avlibInterface::p_avcodec_send_frame avlibInterface::m_avcodec_send_frame = nullptr;
+avlibInterface::p_avcodec_receive_packet avlibInterface::m_avcodec_receive_packet = nullptr;
+avlibInterface::p_avcodec_free_context avlibInterface::m_avcodec_free_context = nullptr;
 avlibInterface::p_avcodec_find_encoder avlibInterface::m_avcodec_find_encoder = nullptr;
-avlibInterface::p_avpicture_get_size avlibInterface::m_avpicture_get_size = nullptr;
-avlibInterface::p_avpicture_fill avlibInterface::m_avpicture_fill = nullptr;
+avlibInterface::p_avcodec_send_packet avlibInterface::m_avcodec_send_packet = nullptr;
+avlibInterface::p_avcodec_receive_frame avlibInterface::m_avcodec_receive_frame = nullptr;
+avlibInterface::p_avcodec_parameters_from_context avlibInterface::m_avcodec_parameters_from_context = nullptr;
+avlibInterface::p_avcodec_parameters_to_context avlibInterface::m_avcodec_parameters_to_context = nullptr;
 
-avlibInterface::p_av_register_all avlibInterface::m_av_register_all = nullptr; // libavformat
-avlibInterface::p_av_read_frame avlibInterface::m_av_read_frame = nullptr;
+avlibInterface::p_av_read_frame avlibInterface::m_av_read_frame = nullptr; // libavformat
 avlibInterface::p_avformat_close_input avlibInterface::m_avformat_close_input = nullptr;
 avlibInterface::p_avformat_free_context avlibInterface::m_avformat_free_context = nullptr;
 avlibInterface::p_av_find_input_format avlibInterface::m_av_find_input_format = nullptr;
@@ -82,11 +93,16 @@ avlibInterface::p_av_buffersink_get_frame avlibInterface::m_av_buffersink_get_fr
 
 avlibInterface::p_sws_scale avlibInterface::m_sws_scale = nullptr;
 avlibInterface::p_sws_getContext avlibInterface::m_sws_getContext = nullptr;
+avlibInterface::p_sws_freeContext avlibInterface::m_sws_freeContext = nullptr;
 
 avlibInterface::p_swr_convert avlibInterface::m_swr_convert = nullptr;
 avlibInterface::p_swr_alloc_set_opts avlibInterface::m_swr_alloc_set_opts = nullptr;
 avlibInterface::p_swr_init avlibInterface::m_swr_init = nullptr;
 avlibInterface::p_swr_free avlibInterface::m_swr_free = nullptr; //新增，解决内存泄露
+avlibInterface::p_swr_get_out_samples avlibInterface::m_swr_get_out_samples = nullptr;
+#ifdef AVLIB_CH_LAYOUT_API
+avlibInterface::p_swr_alloc_set_opts2 avlibInterface::m_swr_alloc_set_opts2 = nullptr;
+#endif
 
 QLibrary avlibInterface::m_libavutil;
 QLibrary avlibInterface::m_libavcodec;
@@ -108,7 +124,11 @@ QString avlibInterface::libPath(const QString &sLib)
 {
     qCDebug(dsrApp) << "Entering avlibInterface::libPath with sLib:" << sLib;
     QDir dir;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QString path  = QLibraryInfo::path(QLibraryInfo::LibrariesPath);
+#else
     QString path  = QLibraryInfo::location(QLibraryInfo::LibrariesPath);
+#endif
     dir.setPath(path);
     qCDebug(dsrApp) << "Searching for library in path:" << dir.path();
     QStringList list = dir.entryList(QStringList() << (sLib + "*"), QDir::NoDotAndDotDot | QDir::Files); //filter name with strlib
@@ -166,6 +186,10 @@ void avlibInterface::initFunctions()
     m_av_audio_fifo_read = reinterpret_cast<p_av_audio_fifo_read>(m_libavutil.resolve("av_audio_fifo_read"));
     m_av_audio_fifo_write = reinterpret_cast<p_av_audio_fifo_write>(m_libavutil.resolve("av_audio_fifo_write"));
     m_av_frame_get_buffer = reinterpret_cast<p_av_frame_get_buffer>(m_libavutil.resolve("av_frame_get_buffer"));
+    m_av_frame_make_writable = reinterpret_cast<p_av_frame_make_writable>(m_libavutil.resolve("av_frame_make_writable"));
+    m_av_frame_is_writable = reinterpret_cast<p_av_frame_is_writable>(m_libavutil.resolve("av_frame_is_writable"));
+    m_av_sample_fmt_is_planar = reinterpret_cast<p_av_sample_fmt_is_planar>(m_libavutil.resolve("av_sample_fmt_is_planar"));
+    m_av_get_bytes_per_sample = reinterpret_cast<p_av_get_bytes_per_sample>(m_libavutil.resolve("av_get_bytes_per_sample"));
     m_av_frame_apply_cropping = reinterpret_cast<p_av_frame_apply_cropping>(m_libavutil.resolve("av_frame_apply_cropping"));
     m_av_frame_unref = reinterpret_cast<p_av_frame_unref>(m_libavutil.resolve("av_frame_unref"));
     m_av_free = reinterpret_cast<p_av_free>(m_libavutil.resolve("av_free"));
@@ -177,30 +201,37 @@ void avlibInterface::initFunctions()
     m_av_rescale_q = reinterpret_cast<p_av_rescale_q>(m_libavutil.resolve("av_rescale_q"));
     m_av_rescale_q_rnd = reinterpret_cast<p_av_rescale_q_rnd>(m_libavutil.resolve("av_rescale_q_rnd"));
     m_av_dict_set = reinterpret_cast<p_av_dict_set>(m_libavutil.resolve("av_dict_set"));
+    m_av_dict_free = reinterpret_cast<p_av_dict_free>(m_libavutil.resolve("av_dict_free"));
     m_av_freep = reinterpret_cast<p_av_freep>(m_libavutil.resolve("av_freep"));
     m_av_audio_fifo_free = reinterpret_cast<p_av_audio_fifo_free>(m_libavutil.resolve("av_audio_fifo_free"));
     m_av_malloc = reinterpret_cast<p_av_malloc>(m_libavutil.resolve("av_malloc"));
     m_av_opt_set_bin = reinterpret_cast<p_av_opt_set_bin>(m_libavutil.resolve("av_opt_set_bin"));
     m_av_int_list_length_for_size = reinterpret_cast<p_av_int_list_length_for_size>(m_libavutil.resolve("av_int_list_length_for_size"));
+    m_av_image_get_buffer_size = reinterpret_cast<p_av_image_get_buffer_size>(m_libavutil.resolve("av_image_get_buffer_size"));
+    m_av_image_fill_arrays = reinterpret_cast<p_av_image_fill_arrays>(m_libavutil.resolve("av_image_fill_arrays"));
+#ifdef AVLIB_CH_LAYOUT_API
+    m_av_channel_layout_default = reinterpret_cast<p_av_channel_layout_default>(m_libavutil.resolve("av_channel_layout_default"));
+    m_av_channel_layout_from_mask = reinterpret_cast<p_av_channel_layout_from_mask>(m_libavutil.resolve("av_channel_layout_from_mask"));
+    m_av_channel_layout_copy = reinterpret_cast<p_av_channel_layout_copy>(m_libavutil.resolve("av_channel_layout_copy"));
+    m_av_channel_layout_uninit = reinterpret_cast<p_av_channel_layout_uninit>(m_libavutil.resolve("av_channel_layout_uninit"));
+#endif
 
 
-    m_avcodec_register_all = reinterpret_cast<p_avcodec_register_all>(m_libavcodec.resolve("avcodec_register_all")); //libavcodec
-    m_av_init_packet = reinterpret_cast<p_av_init_packet>(m_libavcodec.resolve("av_init_packet"));
-    m_avcodec_decode_audio4 = reinterpret_cast<p_avcodec_decode_audio4>(m_libavcodec.resolve("avcodec_decode_audio4"));
+    m_av_init_packet = reinterpret_cast<p_av_init_packet>(m_libavcodec.resolve("av_init_packet")); //libavcodec
     m_av_packet_unref = reinterpret_cast<p_av_packet_unref>(m_libavcodec.resolve("av_packet_unref"));
     m_avcodec_open2 = reinterpret_cast<p_avcodec_open2>(m_libavcodec.resolve("avcodec_open2"));
     m_avcodec_find_decoder = reinterpret_cast<p_avcodec_find_decoder>(m_libavcodec.resolve("avcodec_find_decoder"));
     m_avcodec_alloc_context3 = reinterpret_cast<p_avcodec_alloc_context3>(m_libavcodec.resolve("avcodec_alloc_context3"));
-    m_avcodec_encode_video2 = reinterpret_cast<p_avcodec_encode_video2>(m_libavcodec.resolve("avcodec_encode_video2"));
-    m_av_free_packet = reinterpret_cast<p_av_free_packet>(m_libavcodec.resolve("av_free_packet"));
-    m_avcodec_encode_audio2 = reinterpret_cast<p_avcodec_encode_audio2>(m_libavcodec.resolve("avcodec_encode_audio2"));
-    m_avcodec_close = reinterpret_cast<p_avcodec_close>(m_libavcodec.resolve("avcodec_close"));
+    m_avcodec_send_frame = reinterpret_cast<p_avcodec_send_frame>(m_libavcodec.resolve("avcodec_send_frame"));
+    m_avcodec_receive_packet = reinterpret_cast<p_avcodec_receive_packet>(m_libavcodec.resolve("avcodec_receive_packet"));
+    m_avcodec_free_context = reinterpret_cast<p_avcodec_free_context>(m_libavcodec.resolve("avcodec_free_context"));
     m_avcodec_find_encoder = reinterpret_cast<p_avcodec_find_encoder>(m_libavcodec.resolve("avcodec_find_encoder"));
-    m_avpicture_get_size = reinterpret_cast<p_avpicture_get_size>(m_libavcodec.resolve("avpicture_get_size"));
-    m_avpicture_fill = reinterpret_cast<p_avpicture_fill>(m_libavcodec.resolve("avpicture_fill"));
+    m_avcodec_send_packet = reinterpret_cast<p_avcodec_send_packet>(m_libavcodec.resolve("avcodec_send_packet"));
+    m_avcodec_receive_frame = reinterpret_cast<p_avcodec_receive_frame>(m_libavcodec.resolve("avcodec_receive_frame"));
+    m_avcodec_parameters_from_context = reinterpret_cast<p_avcodec_parameters_from_context>(m_libavcodec.resolve("avcodec_parameters_from_context"));
+    m_avcodec_parameters_to_context = reinterpret_cast<p_avcodec_parameters_to_context>(m_libavcodec.resolve("avcodec_parameters_to_context"));
 
-    m_av_register_all = reinterpret_cast<p_av_register_all>(m_libavformat.resolve("av_register_all")); // libavformat
-    m_av_read_frame = reinterpret_cast<p_av_read_frame>(m_libavformat.resolve("av_read_frame"));
+    m_av_read_frame = reinterpret_cast<p_av_read_frame>(m_libavformat.resolve("av_read_frame")); // libavformat
     m_avformat_close_input = reinterpret_cast<p_avformat_close_input>(m_libavformat.resolve("avformat_close_input"));
     m_avformat_free_context = reinterpret_cast<p_avformat_free_context>(m_libavformat.resolve("avformat_free_context"));
     m_av_find_input_format = reinterpret_cast<p_av_find_input_format>(m_libavformat.resolve("av_find_input_format"));
@@ -231,11 +262,16 @@ void avlibInterface::initFunctions()
 
     m_sws_scale = reinterpret_cast<p_sws_scale>(m_libswscale.resolve("sws_scale"));
     m_sws_getContext = reinterpret_cast<p_sws_getContext>(m_libswscale.resolve("sws_getContext"));
+    m_sws_freeContext = reinterpret_cast<p_sws_freeContext>(m_libswscale.resolve("sws_freeContext"));
 
     m_swr_convert = reinterpret_cast<p_swr_convert>(m_libswresample.resolve("swr_convert"));
     m_swr_alloc_set_opts = reinterpret_cast<p_swr_alloc_set_opts>(m_libswresample.resolve("swr_alloc_set_opts"));;
     m_swr_init = reinterpret_cast<p_swr_init>(m_libswresample.resolve("swr_init"));
     m_swr_free = reinterpret_cast<p_swr_free>(m_libswresample.resolve("swr_free")); //新增，解决内存泄露
+    m_swr_get_out_samples = reinterpret_cast<p_swr_get_out_samples>(m_libswresample.resolve("swr_get_out_samples"));
+#ifdef AVLIB_CH_LAYOUT_API
+    m_swr_alloc_set_opts2 = reinterpret_cast<p_swr_alloc_set_opts2>(m_libswresample.resolve("swr_alloc_set_opts2"));
+#endif
 
     m_isInitFunction = true;
     qCInfo(dsrApp) << "FFmpeg library functions initialized successfully";
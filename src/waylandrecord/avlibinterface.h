@@ -20,9 +20,15 @@ extern "C"
 #include <libavutil/audio_fifo.h>
 #include <libswresample/swresample.h>
 #include <libavutil/time.h>
+#include <libavutil/imgutils.h>
 #include <libswscale/swscale.h>
 }
 
+//FFmpeg 5.1 起用 AVChannelLayout 描述声道，旧的 channels/channel_layout 字段在 FFmpeg 7 中移除
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 24, 100)
+#define AVLIB_CH_LAYOUT_API
+#endif
+
 
 class avlibInterface
 {
@@ -39,6 +45,10 @@ public:
     typedef int (*p_av_audio_fifo_read)(AVAudioFifo *, void **, int );
     typedef int (*p_av_audio_fifo_write)(AVAudioFifo *, void **, int );
     typedef int (*p_av_frame_get_buffer)(AVFrame *, int );
+    typedef int (*p_av_frame_make_writable)(AVFrame *);
+    typedef int (*p_av_frame_is_writable)(AVFrame *);
+    typedef int (*p_av_sample_fmt_is_planar)(enum AVSampleFormat);
+    typedef int (*p_av_get_bytes_per_sample)(enum AVSampleFormat);
     typedef int (*p_av_frame_apply_cropping)(AVFrame *, int );
     typedef void (*p_av_frame_unref)(AVFrame *);
     typedef void (*p_av_free)(void *);
@@ -50,34 +60,41 @@ public:
     typedef int64_t (*p_av_rescale_q)(int64_t, AVRational, AVRational) av_const;
     typedef int64_t (*p_av_rescale_q_rnd)(int64_t , AVRational , AVRational , enum AVRounding) av_const;
     typedef int (*p_av_dict_set)(AVDictionary **, const char *, const char *, int );
+    typedef void (*p_av_dict_free)(AVDictionary **);
     typedef void (*p_av_freep)(void *);
     typedef void (*p_av_audio_fifo_free)(AVAudioFifo *);
     typedef void *(*p_av_malloc)(size_t );
     typedef int (*p_av_opt_set_bin)(void *, const char *, const uint8_t *, int , int );
     typedef unsigned (*p_av_int_list_length_for_size)(unsigned, const void *, uint64_t) av_pure;
+    typedef int (*p_av_image_get_buffer_size)(enum AVPixelFormat, int, int, int);
+    typedef int (*p_av_image_fill_arrays)(uint8_t *[4], int [4], const uint8_t *, enum AVPixelFormat, int, int, int);
+#ifdef AVLIB_CH_LAYOUT_API
+    typedef void (*p_av_channel_layout_default)(AVChannelLayout *, int);
+    typedef int (*p_av_channel_layout_from_mask)(AVChannelLayout *, uint64_t);
+    typedef int (*p_av_channel_layout_copy)(AVChannelLayout *, const AVChannelLayout *);
+    typedef void (*p_av_channel_layout_uninit)(AVChannelLayout *);
+#endif
 
 
-    typedef void (*p_avcodec_register_all)(void); //libavcodec
-    typedef void (*p_av_init_packet)(AVPacket*);
-    typedef int (*p_avcodec_decode_audio4)(AVCodecContext*, AVFrame*, int*, const AVPacket*);
+    typedef void (*p_av_init_packet)(AVPacket*); //libavcodec
     typedef void (*p_av_packet_unref)(AVPacket*);
     typedef int (*p_avcodec_open2)(AVCodecContext *, const AVCodec *, AVDictionary **);
-    typedef AVCodec *(*p_avcodec_find_decoder)(enum AVCodecID );
+    typedef const AVCodec *(*p_avcodec_find_decoder)(enum AVCodecID );
     typedef AVCodecContext *(*p_avcodec_alloc_context3)(const AVCodec *);
-    typedef int (*p_avcodec_encode_video2)(AVCodecContext *, AVPacket *, const AVFrame *, int *);
-    typedef void (*p_av_free_packet)(AVPacket *);
-    typedef int (*p_avcodec_encode_audio2)(AVCodecContext *, AVPacket *, const AVFrame *, int *);
-    typedef int (*p_avcodec_close)(AVCodecContext *);
-    typedef AVCodec *(*p_avcodec_find_encoder)(enum AVCodecID id);
-    typedef int (*p_avpicture_get_size)(enum AVPixelFormat, int, int);
-    typedef int (*p_avpicture_fill)(AVPicture *, const uint8_t *, enum AVPixelFormat , int, int);
-
-    typedef void (*p_av_register_all)(void); // libavformat
-    typedef  int (*p_av_read_frame)(AVFormatContext*, AVPacket*);
+    typedef int (*p_avcodec_send_frame)(AVCodecContext *, const AVFrame *);
+    typedef int (*p_avcodec_receive_packet)(AVCodecContext *, AVPacket *);
+    typedef void (*p_avcodec_free_context)(AVCodecContext **);
+    typedef const AVCodec *(*p_avcodec_find_encoder)(enum AVCodecID id);
+    typedef int (*p_avcodec_send_packet)(AVCodecContext *, const AVPacket *);
+    typedef int (*p_avcodec_receive_frame)(AVCodecContext *, AVFrame *);
+    typedef int (*p_avcodec_parameters_from_context)(AVCodecParameters *, const AVCodecContext *);
+    typedef int (*p_avcodec_parameters_to_context)(AVCodecContext *, const AVCodecParameters *);
+
+    typedef  int (*p_av_read_frame)(AVFormatContext*, AVPacket*); // libavformat
     typedef void (*p_avformat_close_input)(AVFormatContext**);
     typedef void (*p_avformat_free_context)(AVFormatContext*);
-    typedef AVInputFormat* (*p_av_find_input_format)(const char *);
-    typedef int (*p_avformat_open_input)(AVFormatContext **, const char *, AVInputFormat *, AVDictionary **);
+    typedef const AVInputFormat* (*p_av_find_input_format)(const char *);
+    typedef int (*p_avformat_open_input)(AVFormatContext **, const char *, const AVInputFormat *, AVDictionary **);
     typedef int (*p_avformat_find_stream_info)(AVFormatContext *, AVDictionary **);
     typedef void (*p_av_dump_format)(AVFormatContext *, int, const char *, int);
     typedef AVStream *(*p_avformat_new_stream)(AVFormatContext *, const AVCodec *);
@@ -86,7 +103,7 @@ public:
     typedef int (*p_avio_close)(AVIOContext *);
     typedef int (*p_avformat_write_header)(AVFormatContext *s, AVDictionary **options);
     typedef int (*p_avio_open)(AVIOContext **s, const char *url, int flags);
-    typedef int (*p_avformat_alloc_output_context2)(AVFormatContext **, AVOutputFormat *, const char *, const char *);
+    typedef int (*p_avformat_alloc_output_context2)(AVFormatContext **, const AVOutputFormat *, const char *, const char *);
 
     typedef void (*p_avdevice_register_all)(void);//libavdevice
 
@@ -103,11 +120,16 @@ public:
 
     typedef int (*p_sws_scale)(struct SwsContext *, const uint8_t *const [],const int [], int, int , uint8_t *const [], const int []); // libswscale
     typedef struct SwsContext *(*p_sws_getContext)(int , int , enum AVPixelFormat ,int , int , enum AVPixelFormat ,int , SwsFilter *,SwsFilter *, const double *);
+    typedef void (*p_sws_freeContext)(struct SwsContext *);
 
     typedef int (*p_swr_convert)(struct SwrContext *, uint8_t **, int , const uint8_t ** , int);// libswresample
     typedef struct SwrContext *(*p_swr_alloc_set_opts)(struct SwrContext *, int64_t, enum AVSampleFormat, int, int64_t, enum AVSampleFormat, int, int, void *);
     typedef int (*p_swr_init)(struct SwrContext *);
     typedef void (*p_swr_free)(SwrContext **); //新增,解决内存泄露
+    typedef int (*p_swr_get_out_samples)(struct SwrContext *, int);
+#ifdef AVLIB_CH_LAYOUT_API
+    typedef int (*p_swr_alloc_set_opts2)(struct SwrContext **, const AVChannelLayout *, enum AVSampleFormat, int, const AVChannelLayout *, enum AVSampleFormat, int, int, void *);
+#endif
 
     static p_av_gettime m_av_gettime; // libavutil
     static p_av_frame_alloc m_av_frame_alloc;
@@ -120,6 +142,10 @@ public:
     static p_av_audio_fifo_read m_av_audio_fifo_read;
     static p_av_audio_fifo_write m_av_audio_fifo_write;
     static p_av_frame_get_buffer m_av_frame_get_buffer;
+    static p_av_frame_make_writable m_av_frame_make_writable;
+    static p_av_frame_is_writable m_av_frame_is_writable;
+    static p_av_sample_fmt_is_planar m_av_sample_fmt_is_planar;
+    static p_av_get_bytes_per_sample m_av_get_bytes_per_sample;
     static p_av_frame_apply_cropping m_av_frame_apply_cropping;
     static p_av_frame_unref m_av_frame_unref;
     static p_av_free m_av_free;
@@ -131,30 +157,37 @@ public:
     static p_av_rescale_q m_av_rescale_q;
     static p_av_rescale_q_rnd m_av_rescale_q_rnd;
     static p_av_dict_set m_av_dict_set;
+    static p_av_dict_free m_av_dict_free;
     static p_av_freep m_av_freep;
     static p_av_audio_fifo_free m_av_audio_fifo_free;
     static p_av_malloc m_av_malloc;
     static p_av_opt_set_bin m_av_opt_set_bin;
     static p_av_int_list_length_for_size m_av_int_list_length_for_size;
+    static p_av_image_get_buffer_size m_av_image_get_buffer_size;
+    static p_av_image_fill_arrays m_av_image_fill_arrays;
+#ifdef AVLIB_CH_LAYOUT_API
+    static p_av_channel_layout_default m_av_channel_layout_default;
+    static p_av_channel_layout_from_mask m_av_channel_layout_from_mask;
+    static p_av_channel_layout_copy m_av_channel_layout_copy;
+    static p_av_channel_layout_uninit m_av_channel_layout_uninit;
+#endif
 
 
-    static p_avcodec_register_all m_avcodec_register_all; //libavcodec
-    static p_av_init_packet m_av_init_packet;
-    static p_avcodec_decode_audio4 m_avcodec_decode_audio4;
+    static p_av_init_packet m_av_init_packet; //libavcodec
     static p_av_packet_unref m_av_packet_unref;
     static p_avcodec_open2 m_avcodec_open2;
     static p_avcodec_find_decoder m_avcodec_find_decoder;
     static p_avcodec_alloc_context3 m_avcodec_alloc_context3;
-    static p_avcodec_encode_video2 m_avcodec_encode_video2;
-    static p_av_free_packet m_av_free_packet;
-    static p_avcodec_encode_audio2 m_avcodec_encode_audio2;
-    static p_avcodec_close m_avcodec_close;
+    static p_avcodec_send_frame m_avcodec_send_frame;
+    static p_avcodec_receive_packet m_avcodec_receive_packet;
+    static p_avcodec_free_context m_avcodec_free_context;
     static p_avcodec_find_encoder m_avcodec_find_encoder;
-    static p_avpicture_get_size m_avpicture_get_size;
-    static p_avpicture_fill m_avpicture_fill;
+    static p_avcodec_send_packet m_avcodec_send_packet;
+    static p_avcodec_receive_frame m_avcodec_receive_frame;
+    static p_avcodec_parameters_from_context m_avcodec_parameters_from_context;
+    static p_avcodec_parameters_to_context m_avcodec_parameters_to_context;
 
-    static p_av_register_all m_av_register_all; // libavformat
-    static p_av_read_frame m_av_read_frame;
+    static p_av_read_frame m_av_read_frame; // libavformat
     static p_avformat_close_input m_avformat_close_input;
     static p_avformat_free_context m_avformat_free_context;
     static p_av_find_input_format m_av_find_input_format;
@@ -184,11 +217,16 @@ public:
 
     static p_sws_scale m_sws_scale;
     static p_sws_getContext m_sws_getContext;
+    static p_sws_freeContext m_sws_freeContext;
 
     static p_swr_convert m_swr_convert;
     static p_swr_alloc_set_opts m_swr_alloc_set_opts;
     static p_swr_init m_swr_init;
     static p_swr_free m_swr_free; //新增，解决内存泄露
+    static p_swr_get_out_samples m_swr_get_out_samples;
+#ifdef AVLIB_CH_LAYOUT_API
+    static p_swr_alloc_set_opts2 m_swr_alloc_set_opts2;
+#endif
 
     static bool m_isInitFunction;
 
@@ -18,22 +18,28 @@ DTS是AVPacket里的一个成员，表示这个压缩包应该什么时候被解
 */
 
 #include "avoutputstream.h"
+#include "channellayouts.h"
+#include "../utils/i420converter.h"
+#include "../utils/recordingstats.h"
+#include "../utils/configsettings.h"
 #include <unistd.h>
 #include <QTime>
 #include <QDebug>
-#include <QThread>
+#include <QStringList>
+#include <QElapsedTimer>
 
 #include "utils.h"
 #include "../utils/log.h"
 
-CAVOutputStream::CAVOutputStream(WaylandIntegration::WaylandIntegrationPrivate *context):
-    m_context(context),
+CAVOutputStream::CAVOutputStream():
     m_pSysAudioSwrContext(nullptr),
     m_micAudioFifo(nullptr),
-    m_sysAudioFifo(nullptr)
+    m_sysAudioFifo(nullptr),
+    m_micMixFrames(AudioMixPoolSize),
+    m_sysMixFrames(AudioMixPoolSize),
+    m_rgbFrames(1)
 {
     qCDebug(dsrApp) << "Entering CAVOutputStream constructor.";
-    Q_UNUSED(m_context)
     m_videoCodecID  = AV_CODEC_ID_NONE;
     m_micAudioCodecID = AV_CODEC_ID_NONE;
     m_sysAudioCodecID = AV_CODEC_ID_NONE;
@@ -65,18 +71,27 @@ CAVOutputStream::CAVOutputStream(WaylandIntegration::WaylandIntegrationPrivate *
     pCodec_aCard = nullptr;
     pCodec_amix = nullptr;
     pFrameYUV = nullptr;
+    m_rgbFrame = nullptr;
+    memset(&m_videoPacket, 0, sizeof(m_videoPacket));
     m_pVideoSwsContext = nullptr;
+    m_slicePool = nullptr;
+    m_videoPipelineRunning.store(false);
+    m_videoEncodePts = 0;
+    memset(m_videoFrameTimes, 0, sizeof(m_videoFrameTimes));
+    m_videoEncoderFlushed.store(false);
     m_pMicAudioSwrContext = nullptr;
     m_nb_samples = 0;
     m_convertedMicSamples = nullptr;
     m_convertedSysSamples = nullptr;
-    m_start_mix_time = 0;
+    m_convertedMicCapacity = 0;
+    m_convertedSysCapacity = 0;
+    m_audioMixAllocCount.store(0);
+    m_videoBufferAllocCount.store(0);
     m_next_vid_time = 0;
     m_next_aud_time = 0;
     audio_amix_st = nullptr;
     m_nLastAudioPresentationTime = 0;
     m_nLastAudioCardPresentationTime = 0;
-    m_nLastAudioMixPresentationTime = 0;
     m_mixCount = 0;
     m_videoType = Utils::kMP4;
     m_left = 0;
@@ -85,20 +100,13 @@ CAVOutputStream::CAVOutputStream(WaylandIntegration::WaylandIntegrationPrivate *
     m_bottom = 0;
     m_path = nullptr;
     m_isWriteFrame = false;
-    filter_graph = nullptr;
-    buffersink_ctx = nullptr;
-    buffersrc_ctx1 = nullptr;
-    buffersrc_ctx2 = nullptr;
     tmpFifoFailed = 0;
     m_isOverWrite = false;
 
     m_gopsize = 0;
+    m_fragmentSeconds = DefaultFragmentSeconds;
     m_channels_layout = 0;
     m_channels_card_layout = 0;
-    avlibInterface::m_avcodec_register_all();
-    qCDebug(dsrApp) << "Called avcodec_register_all.";
-    avlibInterface::m_av_register_all();
-    qCDebug(dsrApp) << "Called av_register_all.";
     qCDebug(dsrApp) << "Exiting CAVOutputStream constructor.";
 }
 
@@ -106,6 +114,12 @@ CAVOutputStream::~CAVOutputStream(void)
 {
     qCDebug(dsrApp) << "Entering CAVOutputStream destructor.";
     printf("Desctruction Onput!\n");
+    stopVideoPipeline();
+    if (nullptr != m_slicePool) {
+        delete m_slicePool;
+        m_slicePool = nullptr;
+    }
+    releaseAudioMixBuffers();
     if (m_micAudioFifo) {
         audioFifoFree(m_micAudioFifo);
         m_micAudioFifo = nullptr;
@@ -161,239 +175,44 @@ void CAVOutputStream::SetAudioCardCodecProp(AVCodecID codec_id, int samplerate,
     qCDebug(dsrApp) << "Exiting SetAudioCardCodecProp.";
 }
 
-int CAVOutputStream::init_filters()
+bool CAVOutputStream::initAudioMixer()
 {
-    qCInfo(dsrApp) << "Initializing audio filters";
-    static const char *filter_descr = "[in0][in1]amix=inputs=2[out]";//"[in0][in1]amix=inputs=2[out]";amerge//"aresample=8000,aformat=sample_fmts=s16:channel_layouts=mono";
-    char args1[512];
-    char args2[512];
-    int ret = 0;
-    string formatStr = "time_base=%d/%d:sample_rate=%d:sample_fmt=%s:channel_layout=0x%";
-    formatStr.append(PRIx64);
-    AVFilterInOut *filter_outputs[2];
-    const AVFilter *abuffersrc1  = avlibInterface::m_avfilter_get_by_name("abuffer");
-    const AVFilter *abuffersrc2  = avlibInterface::m_avfilter_get_by_name("abuffer");
-    const AVFilter *abuffersink = avlibInterface::m_avfilter_get_by_name("abuffersink");
-    
-    if (!abuffersrc1 || !abuffersrc2 || !abuffersink) {
-        qCCritical(dsrApp) << "Failed to get audio filters";
-        return 1;
-    }
-    
-    AVFilterInOut *outputs1 = avlibInterface::m_avfilter_inout_alloc();
-    AVFilterInOut *outputs2 = avlibInterface::m_avfilter_inout_alloc();
-    AVFilterInOut *inputs  = avlibInterface::m_avfilter_inout_alloc();
-    static  enum AVSampleFormat out_sample_fmts[] = { pCodecCtx_amix->sample_fmt, AV_SAMPLE_FMT_NONE }; //{ AV_SAMPLE_FMT_S16, AV_SAMPLE_FMT_NONE };
-    static const int64_t out_channel_layouts[] = {static_cast<int64_t>(pCodecCtx_amix->channel_layout), -1};
-    static const int out_sample_rates[] = { pCodecCtx_amix->sample_rate, -1 };
-    const AVFilterLink *outlink;
-    AVRational time_base_1 = m_pMicCodecContext->time_base;
-    AVRational time_base_2 = m_pSysCodecContext->time_base;
-    filter_graph = avlibInterface::m_avfilter_graph_alloc();
-    if (!outputs1 || !inputs || !filter_graph) {
-        ret = AVERROR(ENOMEM);
-        qCCritical(dsrApp) << "Failed to allocate filter graph resources. Error: " << ret;
-        avlibInterface::m_avfilter_inout_free(&inputs);
-
-        avlibInterface::m_avfilter_inout_free(&outputs1);
-        avlibInterface::m_avfilter_inout_free(&outputs2);
-        qCDebug(dsrApp) << "Exiting init_filters with error: Failed to allocate filter graph resources.";
-        return 1;
-    }
-    AVCodecContext *dec_ctx1;
-    AVCodecContext *dec_ctx2;
-    /* buffer audio source: the decoded frames from the decoder will be inserted here. */
-    dec_ctx1 = m_pMicCodecContext;
-    if (!dec_ctx1->channel_layout)
-        dec_ctx1->channel_layout = static_cast<uint64_t>(avlibInterface::m_av_get_default_channel_layout(dec_ctx1->channels));
-
-    qCDebug(dsrApp) << "Configuring first audio buffer source";
-    snprintf(args1,
-             sizeof(args1),
-             formatStr.c_str(),
-             time_base_1.num,
-             time_base_1.den,
-             dec_ctx1->sample_rate,
-             avlibInterface::m_av_get_sample_fmt_name(dec_ctx1->sample_fmt),
-             dec_ctx1->channel_layout);
-    ret = avlibInterface::m_avfilter_graph_create_filter(&buffersrc_ctx1, abuffersrc1, "in0",
-                                                         args1, nullptr, filter_graph);
-
-    if (ret < 0) {
-        qCCritical(dsrApp) << "Cannot create first audio buffer source";
-        avlibInterface::m_avfilter_inout_free(&inputs);
-        avlibInterface::m_avfilter_inout_free(&outputs1);
-        avlibInterface::m_avfilter_inout_free(&outputs2);
-        qCDebug(dsrApp) << "Exiting init_filters with error: Cannot create first audio buffer source.";
-        return 1;
-    }
-
-    qCDebug(dsrApp) << "Configuring second audio buffer source";
-    /* buffer audio source: the decoded frames from the decoder will be inserted here. */
-    dec_ctx2 = m_pSysCodecContext;
-    snprintf(args2, sizeof(args2),
-             formatStr.c_str(),
-             time_base_2.num, time_base_2.den, dec_ctx2->sample_rate,
-             avlibInterface::m_av_get_sample_fmt_name(dec_ctx2->sample_fmt), dec_ctx2->channel_layout);
-    ret = avlibInterface::m_avfilter_graph_create_filter(&buffersrc_ctx2, abuffersrc2, "in1",
-                                                         args2, nullptr, filter_graph);
-    if (ret < 0) {
-        qCCritical(dsrApp) << "Cannot create second audio buffer source";
-        avlibInterface::m_avfilter_inout_free(&inputs);
-        avlibInterface::m_avfilter_inout_free(&outputs1);
-        avlibInterface::m_avfilter_inout_free(&outputs2);
-        return 1;
-    }
-
-    qCDebug(dsrApp) << "Creating audio buffer sink";
-    /* buffer audio sink: to terminate the filter chain. */
-    ret = avlibInterface::m_avfilter_graph_create_filter(&buffersink_ctx, abuffersink, "out",
-                                                         nullptr, nullptr, filter_graph);
-
-    if (ret < 0) {
-        qCCritical(dsrApp) << "Cannot create audio buffer sink";
-        avlibInterface::m_avfilter_inout_free(&inputs);
-        avlibInterface::m_avfilter_inout_free(&outputs1);
-        avlibInterface::m_avfilter_inout_free(&outputs2);
-        return 1;
-    }
-
-    ret = avlibInterface::m_av_opt_set_bin(buffersink_ctx, "sample_fmts", (const uint8_t *)(out_sample_fmts),
-                                           avlibInterface::m_av_int_list_length_for_size(sizeof(*(out_sample_fmts)), out_sample_fmts, -1) * sizeof(*(out_sample_fmts)), AV_OPT_SEARCH_CHILDREN);
-
-    if (ret < 0) {
-        qCCritical(dsrApp) << "Cannot set output sample format";
-        avlibInterface::m_avfilter_inout_free(&inputs);
-        avlibInterface::m_avfilter_inout_free(&outputs1);
-        avlibInterface::m_avfilter_inout_free(&outputs2);
-        return 1;
-    }
-
-    ret = avlibInterface::m_av_opt_set_bin(buffersink_ctx, "channel_layouts", (const uint8_t *)(out_channel_layouts),
-                                           avlibInterface::m_av_int_list_length_for_size(sizeof(*(out_channel_layouts)), out_channel_layouts, -1) * sizeof(*(out_channel_layouts)), AV_OPT_SEARCH_CHILDREN);
-
-    if (ret < 0) {
-        qCCritical(dsrApp) << "Cannot set output channel layout";
-        avlibInterface::m_avfilter_inout_free(&inputs);
-        avlibInterface::m_avfilter_inout_free(&outputs1);
-        avlibInterface::m_avfilter_inout_free(&outputs2);
-        return 1;
-    }
-
-    ret = avlibInterface::m_av_opt_set_bin(buffersink_ctx, "sample_rates", (const uint8_t *)(out_sample_rates),
-                                           avlibInterface::m_av_int_list_length_for_size(sizeof(*(out_sample_rates)), out_sample_rates, -1) * sizeof(*(out_sample_rates)), AV_OPT_SEARCH_CHILDREN);
-
-    if (ret < 0) {
-        qCCritical(dsrApp) << "Cannot set output sample rate";
-        avlibInterface::m_avfilter_inout_free(&inputs);
-        avlibInterface::m_avfilter_inout_free(&outputs1);
-        avlibInterface::m_avfilter_inout_free(&outputs2);
-        return 1;
-    }
-
-    /*
-
-     * Set the endpoints for the filter graph. The filter_graph will
-
-     * be linked to the graph described by filters_descr.
-
-     */
-
-
-
-    /*
-
-     * The buffer source output must be connected to the input pad of
-
-     * the first filter described by filters_descr; since the first
-
-     * filter input label is not specified, it is set to "in" by
-
-     * default.
-
-     */
-
-    outputs1->name       = avlibInterface::m_av_strdup("in0");
-    outputs1->filter_ctx = buffersrc_ctx1;
-    outputs1->pad_idx    = 0;
-    outputs1->next       = outputs2;
-    outputs2->name       = avlibInterface::m_av_strdup("in1");
-    outputs2->filter_ctx = buffersrc_ctx2;
-    outputs2->pad_idx    = 0;
-    outputs2->next       = nullptr;
-
-    /*
-
-     * The buffer sink input must be connected to the output pad of
-
-     * the last filter described by filters_descr; since the last
-
-     * filter output label is not specified, it is set to "out" by
-
-     * default.
-
-     */
-    inputs->name       = avlibInterface::m_av_strdup("out");
-    inputs->filter_ctx = buffersink_ctx;
-    inputs->pad_idx    = 0;
-    inputs->next       = nullptr;
-
-
-    filter_outputs[0] = outputs1;
-
-    filter_outputs[1] = outputs2;
-
-
-
-
-    qCDebug(dsrApp) << "Parsing filter graph";
-    if ((ret = avlibInterface::m_avfilter_graph_parse_ptr(filter_graph, filter_descr,
-
-                                                          &inputs, filter_outputs, nullptr)) < 0)//filter_outputs
-
-    {
-
-        //av_log(nullptr, AV_LOG_ERROR, "parse ptr fail, ret: %d\n", ret);
-
-        avlibInterface::m_avfilter_inout_free(&inputs);
-
-        avlibInterface::m_avfilter_inout_free(&outputs1);
-        avlibInterface::m_avfilter_inout_free(&outputs2);
-        qCDebug(dsrApp) << "Exiting init_filters with error: Failed to parse filter graph.";
-        return 1;
-
-    }
-
-    qCDebug(dsrApp) << "Configuring filter graph";
-    if ((ret = avlibInterface::m_avfilter_graph_config(filter_graph, nullptr)) < 0) {
-        qCCritical(dsrApp) << "Failed to configure filter graph, ret:" << ret;
-        avlibInterface::m_avfilter_inout_free(&inputs);
-        avlibInterface::m_avfilter_inout_free(&outputs1);
-        avlibInterface::m_avfilter_inout_free(&outputs2);
-        qCDebug(dsrApp) << "Exiting init_filters with error: Failed to configure filter graph.";
-        return 1;
+    AudioMixer::SampleType type = AudioMixer::UnsupportedSample;
+    switch (pCodecCtx_amix->sample_fmt) {
+    case AV_SAMPLE_FMT_U8:
+    case AV_SAMPLE_FMT_U8P:
+        type = AudioMixer::U8Sample;
+        break;
+    case AV_SAMPLE_FMT_S16:
+    case AV_SAMPLE_FMT_S16P:
+        type = AudioMixer::S16Sample;
+        break;
+    case AV_SAMPLE_FMT_S32:
+    case AV_SAMPLE_FMT_S32P:
+        type = AudioMixer::S32Sample;
+        break;
+    case AV_SAMPLE_FMT_FLT:
+    case AV_SAMPLE_FMT_FLTP:
+        type = AudioMixer::FloatSample;
+        break;
+    default:
+        break;
+    }
+    //平面格式每个声道一个平面，交错格式所有声道在同一个平面
+    const int planes = avlibInterface::m_av_sample_fmt_is_planar(pCodecCtx_amix->sample_fmt) ? ChannelLayouts::count(pCodecCtx_amix) : 1;
+    if (!m_audioMixer.init(type, planes)) {
+        qCCritical(dsrApp) << "Unsupported audio mix sample format:" << pCodecCtx_amix->sample_fmt;
+        return false;
     }
-    /* Print summary of the sink buffer
-
-     * Note: args buffer is reused to store channel layout string */
-    outlink = buffersink_ctx->inputs[0];
-
-    avlibInterface::m_av_get_channel_layout_string(args1, sizeof(args1), -1, outlink->channel_layout);
+    qCInfo(dsrApp) << "Audio mixer initialized, sample format:" << pCodecCtx_amix->sample_fmt << "planes:" << planes;
+    return true;
+}
 
-    /*
-    av_log(nullptr, AV_LOG_INFO, "Output: srate:%dHz fmt:%s chlayout:%s\n",
-           outlink->sample_rate,
-           static_cast<char *>(av_x_if_null(avlibInterface::m_av_get_sample_fmt_name(static_cast<AVSampleFormat>(outlink->format)), "?")),
-           args1);
-           */
-    mMic_frame = avlibInterface::m_av_frame_alloc();
-    mSpeaker_frame = avlibInterface::m_av_frame_alloc();
-    avlibInterface::m_avfilter_inout_free(&inputs);
-    avlibInterface::m_avfilter_inout_free(filter_outputs);
-
-    qCInfo(dsrApp) << "Audio filters initialization completed successfully";
-    return ret;
+void CAVOutputStream::setAudioMixGains(float micGain, float sysGain)
+{
+    m_audioMixer.setGains(micGain, sysGain);
 }
+
 int CAVOutputStream::init_context_amix(int channel, uint64_t channel_layout, int sample_rate, int64_t bit_rate)
 {
     qCInfo(dsrApp) << "Initializing audio mix context";
@@ -411,13 +230,9 @@ int CAVOutputStream::init_context_amix(int channel, uint64_t channel_layout, int
     //pCodecCtx_amix = avlibInterface::m_avcodec_alloc_context3(pCodec_amix); //注释此行无效代码，同时解决内存泄露
     pCodecCtx_amix = avlibInterface::m_avcodec_alloc_context3(pCodec_a);
     qCDebug(dsrApp) << "Allocated codec context for audio mix.";
-    pCodecCtx_amix->channels = m_channels;
-    pCodecCtx_amix->channel_layout = static_cast<uint64_t>(m_channels_layout);
-    if (pCodecCtx_amix->channel_layout == 0) {
-        pCodecCtx_amix->channel_layout = AV_CH_LAYOUT_STEREO;
-        pCodecCtx_amix->channels = avlibInterface::m_av_get_channel_layout_nb_channels(pCodecCtx_amix->channel_layout);
-        qCDebug(dsrApp) << "Audio mix channel layout was 0, set to stereo. Channels:" << pCodecCtx_amix->channels;
-    }
+    //声道布局为 0 时使用立体声
+    ChannelLayouts::set(pCodecCtx_amix, static_cast<uint64_t>(m_channels_layout));
+    qCDebug(dsrApp) << "Audio mix channels:" << ChannelLayouts::count(pCodecCtx_amix);
 
     pCodecCtx_amix->sample_rate = m_samplerate;
     pCodecCtx_amix->sample_fmt = pCodec_amix->sample_fmts[0];
@@ -449,7 +264,7 @@ int CAVOutputStream::init_context_amix(int channel, uint64_t channel_layout, int
         }
         audio_amix_st->time_base.num = 1;
         audio_amix_st->time_base.den = pCodecCtx_amix->sample_rate;
-        audio_amix_st->codec = pCodecCtx_amix;
+        avlibInterface::m_avcodec_parameters_from_context(audio_amix_st->codecpar, pCodecCtx_amix);
         qCDebug(dsrApp) << "Audio mix stream created with sample rate:" << pCodecCtx_amix->sample_rate;
     }
 
@@ -511,8 +326,8 @@ bool CAVOutputStream::open(QString path)
             pCodecCtx->qmax = 51;
             pCodecCtx->max_b_frames = 0;
 
-            avlibInterface::m_av_dict_set(&param, "preset", "ultrafast", 0);
-            qCDebug(dsrApp) << "H264 preset set to ultrafast.";
+            applyVideoEncoderOptions(pCodecCtx, &param, m_videoEncoderOptions);
+            qCDebug(dsrApp) << "H264 preset set to" << m_videoEncoderOptions.preset;
         }
 
         if (avlibInterface::m_avcodec_open2(pCodecCtx, pCodec, &param) < 0) {
@@ -529,13 +344,22 @@ bool CAVOutputStream::open(QString path)
         qCDebug(dsrApp) << "Video stream created.";
         m_videoStream->time_base.num = 1;
         m_videoStream->time_base.den = m_framerate;
-        m_videoStream->codec = pCodecCtx;
+        //编码器上下文由本类持有，流只保存打开后的编码参数
+        if (avlibInterface::m_avcodec_parameters_from_context(m_videoStream->codecpar, pCodecCtx) < 0) {
+            qCCritical(dsrApp) << "Failed to copy video encoder parameters";
+            return false;
+        }
 
         pFrameYUV = avlibInterface::m_av_frame_alloc();
-        m_out_buffer = static_cast<uint8_t *>(avlibInterface::m_av_malloc(static_cast<size_t>(avlibInterface::m_avpicture_get_size(AV_PIX_FMT_YUV420P, pCodecCtx->width, pCodecCtx->height))));
-        avlibInterface::m_avpicture_fill((AVPicture *)pFrameYUV, m_out_buffer, AV_PIX_FMT_YUV420P, pCodecCtx->width, pCodecCtx->height);
+        m_rgbFrames.resetAllocCount();
+        m_videoBufferAllocCount.store(0);
+        m_out_buffer = static_cast<uint8_t *>(avlibInterface::m_av_malloc(static_cast<size_t>(avlibInterface::m_av_image_get_buffer_size(AV_PIX_FMT_YUV420P, pCodecCtx->width, pCodecCtx->height, 1))));
+        avlibInterface::m_av_image_fill_arrays(pFrameYUV->data, pFrameYUV->linesize, m_out_buffer, AV_PIX_FMT_YUV420P, pCodecCtx->width, pCodecCtx->height, 1);
         qCDebug(dsrApp) << "Video stream initialized with size:" << pCodecCtx->width << "x" << pCodecCtx->height;
     }
+    m_audioMixAllocCount.store(0);
+    m_micMixFrames.resetAllocCount();
+    m_sysMixFrames.resetAllocCount();
     if (m_sysAudioCodecID && m_micAudioCodecID) {
         qCDebug(dsrApp) << "Initializing audio mixing";
         m_bMix = true;
@@ -556,13 +380,8 @@ bool CAVOutputStream::open(QString path)
         }
         qCDebug(dsrApp) << "Microphone audio encoder found.";
         m_pMicCodecContext = avlibInterface::m_avcodec_alloc_context3(pCodec_a);
-        m_pMicCodecContext->channels = m_channels;
-        m_pMicCodecContext->channel_layout = static_cast<uint64_t>(m_channels_layout);
-        if (m_pMicCodecContext->channel_layout == 0) {
-            qCDebug(dsrApp) << "Using default stereo channel layout for microphone";
-            m_pMicCodecContext->channel_layout = AV_CH_LAYOUT_STEREO;
-            m_pMicCodecContext->channels = avlibInterface::m_av_get_channel_layout_nb_channels(m_pMicCodecContext->channel_layout);
-        }
+        //声道布局为 0 时使用立体声
+        ChannelLayouts::set(m_pMicCodecContext, static_cast<uint64_t>(m_channels_layout));
 
         m_pMicCodecContext->sample_rate = m_samplerate;
         m_pMicCodecContext->sample_fmt = pCodec_a->sample_fmts[0];
@@ -593,7 +412,7 @@ bool CAVOutputStream::open(QString path)
             }
             m_micAudioStream->time_base.num = 1;
             m_micAudioStream->time_base.den = m_pMicCodecContext->sample_rate;
-            m_micAudioStream->codec = m_pMicCodecContext;
+            avlibInterface::m_avcodec_parameters_from_context(m_micAudioStream->codecpar, m_pMicCodecContext);
             qCDebug(dsrApp) << "Microphone audio stream created with sample rate:" << m_pMicCodecContext->sample_rate;
         }
 
@@ -609,7 +428,9 @@ bool CAVOutputStream::open(QString path)
         * Each pointer will later point to the audio samples of the corresponding
         * channels (although it may be nullptr for interleaved formats).
         */
-        if (!(m_convertedMicSamples = static_cast<uint8_t **>(calloc(static_cast<size_t>(m_pMicCodecContext->channels), sizeof(**m_convertedMicSamples))))) {
+        //混音时重采样为混音编码器的格式，指针个数取两者的较大值
+        const int micChannels = m_bMix ? FFMAX(ChannelLayouts::count(m_pMicCodecContext), ChannelLayouts::count(pCodecCtx_amix)) : ChannelLayouts::count(m_pMicCodecContext);
+        if (!(m_convertedMicSamples = static_cast<uint8_t **>(calloc(static_cast<size_t>(micChannels), sizeof(*m_convertedMicSamples))))) {
             printf("Could not allocate converted input sample pointers\n");
             qCCritical(dsrApp) << "Failed to allocate converted input sample pointers for microphone.";;
             return false;
@@ -629,15 +450,8 @@ bool CAVOutputStream::open(QString path)
         }
         qCDebug(dsrApp) << "System audio encoder found.";
         m_pSysCodecContext = avlibInterface::m_avcodec_alloc_context3(pCodec_aCard);
-        m_pSysCodecContext->channels = m_channels_card;
-        //        pCodecCtx_aCard->channel_layout = av_get_default_channel_layout(m_channels_card);
-        m_pSysCodecContext->channel_layout = static_cast<uint64_t>(m_channels_card_layout);
-        //                pCodecCtx_aCard->channels = av_get_channel_layout_nb_channels(pAudioStream->codec->channel_layout);
-        if (m_pSysCodecContext->channel_layout == 0) {
-            qCDebug(dsrApp) << "Using default stereo channel layout for system audio.";
-            m_pSysCodecContext->channel_layout = AV_CH_LAYOUT_STEREO;
-            m_pSysCodecContext->channels = avlibInterface::m_av_get_channel_layout_nb_channels(m_pSysCodecContext->channel_layout);
-        }
+        //声道布局为 0 时使用立体声
+        ChannelLayouts::set(m_pSysCodecContext, static_cast<uint64_t>(m_channels_card_layout));
         m_pSysCodecContext->sample_rate = m_samplerate_card;
         m_pSysCodecContext->sample_fmt = pCodec_aCard->sample_fmts[0];
         m_pSysCodecContext->bit_rate = m_audio_bitrate_card;
@@ -670,11 +484,12 @@ bool CAVOutputStream::open(QString path)
             }
             m_sysAudioStream->time_base.num = 1;
             m_sysAudioStream->time_base.den = m_pSysCodecContext->sample_rate;
-            m_sysAudioStream->codec = m_pSysCodecContext;
+            avlibInterface::m_avcodec_parameters_from_context(m_sysAudioStream->codecpar, m_pSysCodecContext);
             qCDebug(dsrApp) << "System audio stream created with sample rate:" << m_pSysCodecContext->sample_rate;
         }
         m_convertedSysSamples = nullptr;
-        if (!(m_convertedSysSamples = static_cast<uint8_t **>(calloc(static_cast<size_t>(m_pSysCodecContext->channels), sizeof(**m_convertedSysSamples))))) {
+        const int sysChannels = m_bMix ? FFMAX(ChannelLayouts::count(m_pSysCodecContext), ChannelLayouts::count(pCodecCtx_amix)) : ChannelLayouts::count(m_pSysCodecContext);
+        if (!(m_convertedSysSamples = static_cast<uint8_t **>(calloc(static_cast<size_t>(sysChannels), sizeof(*m_convertedSysSamples))))) {
             printf("Could not allocate converted input sample pointers\n");
             qCCritical(dsrApp) << "Failed to allocate converted input sample pointers for system audio.";
             return false;
@@ -684,12 +499,10 @@ bool CAVOutputStream::open(QString path)
     }
 
     if (m_bMix) {
-        qCDebug(dsrApp) << "Initializing audio filters for mixing";
-        if (init_filters() != 0) {
-            qCCritical(dsrApp) << "Failed to initialize audio filters";
+        qCDebug(dsrApp) << "Initializing audio mixer";
+        if (!initAudioMixer()) {
             return false;
         }
-        qCDebug(dsrApp) << "Audio filters initialized successfully for mixing.";
     }
 
     //Open output URL,set before avformat_write_header() for muxing 打开输出URL，在avformat_write_header()之前设置muxing
@@ -704,28 +517,47 @@ bool CAVOutputStream::open(QString path)
     qCDebug(dsrApp) << "Dumped format information.";
 
     //Write File Header 写文件头
-    avlibInterface::m_avformat_write_header(m_videoFormatContext, nullptr);
+    //分段参数随文件头一起交给封装器，未识别的参数会留在字典中
+    AVDictionary *muxOptions = nullptr;
+    applyFragmentOptions(&muxOptions, m_videoType, m_fragmentSeconds);
+    if (avlibInterface::m_avformat_write_header(m_videoFormatContext, &muxOptions) < 0) {
+        qCCritical(dsrApp) << "Failed to write output header";
+    }
+    avlibInterface::m_av_dict_free(&muxOptions);
+    qCInfo(dsrApp) << "Output fragment duration:" << m_fragmentSeconds << "s";
 
     //m_vid_framecnt = 0;
     m_nb_samples = 0;
     m_nLastAudioPresentationTime = 0;
-    m_nLastAudioMixPresentationTime = 0;
     m_mixCount = 0;
     m_next_vid_time = 0;
     m_next_aud_time = 0;
     //m_first_vid_time1 = m_first_vid_time2 = -1;
     //m_first_aud_time = -1;
-    m_start_mix_time = -1;
     //m_isOverWrite = false;
+    //帧和音频包的时间戳都是相对同一个起点的采集时钟时间，未在开始录制时启动则以打开输出流为起点
+    if (!m_captureClock.isStarted()) {
+        m_captureClock.start();
+    }
+    m_micDrift.reset(0);
+    m_sysDrift.reset(0);
+    m_audioStartSamples = -1;
+    m_lastVideoPts = -1;
     setIsWriteFrame(true);
     fflush(stdout);
+    m_videoEncodePts = 0;
+    m_videoEncoderFlushed.store(false);
+    if (nullptr != m_videoStream && !startVideoPipeline()) {
+        qCWarning(dsrApp) << "Video pipeline unavailable, encoding on the capture thread";
+    }
 
     qCInfo(dsrApp) << "Output stream opened successfully";
     return true;
 }
 
-int CAVOutputStream::writeVideoFrame(WaylandIntegration::WaylandIntegrationPrivate::waylandFrame &frame)
+int CAVOutputStream::writeVideoFrame(WaylandFrame &frame)
 {
+    RecordingStats::Scope statsScope(RecordingStats::WriteVideoFrame);
     qCDebug(dsrApp) << "Starting to write video frame";
     
     if (nullptr == frame._frame || frame._width <= 0 || frame._height <= 0) {
@@ -733,90 +565,648 @@ int CAVOutputStream::writeVideoFrame(WaylandIntegration::WaylandIntegrationPriva
         return -1;
     }
 
-    qCDebug(dsrApp) << "Allocating RGB frame buffer";
-    AVFrame *pRgbFrame = avlibInterface::m_av_frame_alloc();
-    pRgbFrame->width = frame._width;
-    pRgbFrame->height = frame._height;
-    pRgbFrame->format = AV_PIX_FMT_RGB32;
-    if (0 == avlibInterface::m_av_frame_get_buffer(pRgbFrame, 32)) {
-        pRgbFrame->width  = frame._width;
-        pRgbFrame->height = frame._height;
-        //pRgbFrame->format = AV_PIX_FMT_RGB32;
-        pRgbFrame->crop_left   = static_cast<size_t>(m_left);
-        pRgbFrame->crop_top    = static_cast<size_t>(m_top);
-        pRgbFrame->crop_right  = static_cast<size_t>(m_right);
-        pRgbFrame->crop_bottom = static_cast<size_t>(m_bottom);
-        pRgbFrame->linesize[0] = frame._stride;
-        pRgbFrame->data[0]     = frame._frame;
-    }
-    if (nullptr == m_pVideoSwsContext) {
-        qCDebug(dsrApp) << "Initializing video scaling context";
-        AVPixelFormat fmt = AV_PIX_FMT_RGBA;
-        if (m_boardVendorType) {
-            fmt = AV_PIX_FMT_RGB32;
-        }
-        m_pVideoSwsContext = avlibInterface::m_sws_getContext(m_width, m_height,
-                                                              fmt,
-                                                              pCodecCtx->width,
-                                                              pCodecCtx->height,
-                                                              AV_PIX_FMT_YUV420P,
-                                                              SWS_BICUBIC,
-                                                              nullptr,
-                                                              nullptr,
-                                                              nullptr);
+    if (m_videoPipelineRunning.load(std::memory_order_acquire)) {
+        //流水线模式：本线程只做转换，编码和写文件在各自的线程中进行
+        const int64_t waitBegin = FramePacer::monotonicNs();
+        AVFrame *yuvFrame = nullptr;
+        if (!m_freeVideoFrames.pop(yuvFrame)) {
+            return -1;
+        }
+        const int64_t begin = FramePacer::monotonicNs();
+        std::lock_guard<std::mutex> locker(m_convertStageMutex);
+        if (!m_videoPipelineRunning.load(std::memory_order_acquire)) {
+            return -1;
+        }
+        if (!prepareRgbFrame(frame)) {
+            m_freeVideoFrames.push(yuvFrame);
+            return 2;
+        }
+        //空闲队列中的帧编码器已不再引用，可以直接写入
+        convertVideoFrame(m_rgbFrame, yuvFrame);
+        const int64_t end = FramePacer::monotonicNs();
+        VideoJob job;
+        job.frame = yuvFrame;
+        job.time = frame._time;
+        job.queuedNs = end;
+        if (!m_encodeQueue.push(job)) {
+            return -1;
+        }
+        m_videoStageStats[ConvertStage].record(begin - waitBegin, end - begin);
+        m_videoStageStats[EncodeStage].setDepth(m_encodeQueue.depth());
+        return 0;
     }
-    if (avlibInterface::m_av_frame_apply_cropping(pRgbFrame, AV_FRAME_CROP_UNALIGNED) < 0) {
-        qCCritical(dsrApp) << "Failed to apply frame cropping";
-        AVERROR(ERANGE);
+
+    //未启动流水线时（如 open 失败后的兜底或单元测试）在本线程依次转换、编码、写文件
+    if (!prepareRgbFrame(frame)) {
         return 2;
     }
-    
     qCDebug(dsrApp) << "Converting frame from RGB to YUV";
-    avlibInterface::m_sws_scale(m_pVideoSwsContext, pRgbFrame->data, pRgbFrame->linesize, 0, pCodecCtx->height, pFrameYUV->data, pFrameYUV->linesize);
-    pFrameYUV->width  = pRgbFrame->width;//test
-    pFrameYUV->height = pRgbFrame->height;
-    pFrameYUV->format = AV_PIX_FMT_YUV420P;
-    AVPacket packet;
-    packet.data = nullptr;
-    packet.size = 0;
-    avlibInterface::m_av_init_packet(&packet);
-    int enc_got_frame = 0;
-    
+    convertVideoFrame(m_rgbFrame, pFrameYUV);
+    //复用同一个包，编码器写入的数据在写文件后 unref
+    AVPacket &packet = m_videoPacket;
     qCDebug(dsrApp) << "Encoding video frame";
-    avlibInterface::m_avcodec_encode_video2(pCodecCtx, &packet, pFrameYUV, &enc_got_frame);
-    pFrameYUV->pts++;
-    if (1 == enc_got_frame) {
-        packet.stream_index = m_videoStream->index;
-        //packet.pts = static_cast<int64_t>(m_videoStream->time_base.den) * frame._time / AV_TIME_BASE;
-        m_videoFrameCount++;
-        if (m_videoFrameCount == 1) {
-            m_fristVideoFramePts = frame._time;
-            qCInfo(dsrApp) << "First video frame timestamp set:" << m_fristVideoFramePts;
-        }
-        packet.pts = static_cast<int64_t>(m_videoStream->time_base.den) * (frame._time - m_fristVideoFramePts) / AV_TIME_BASE;
-        //qDebug() << "video packet.pts: " << packet.pts;
-        packet.dts =  packet.pts;
-        int ret = writeFrame(m_videoFormatContext, &packet);
+    int ret = sendVideoFrame(pFrameYUV, frame._time);
+    if (ret < 0) {
+        return ret;
+    }
+    while (1 == receiveVideoPacket(&packet)) {
+        ret = writeFrame(m_videoFormatContext, &packet);
+        avlibInterface::m_av_packet_unref(&packet);
         if (ret < 0) {
             qCCritical(dsrApp) << "Failed to write video frame, error code:" << ret;
             //char tmpErrString[128] = {0};
             //printf("Could not write video frame, error: %s\n", av_make_error_string(tmpErrString, AV_ERROR_MAX_STRING_SIZE, ret));
-            avlibInterface::m_av_packet_unref(&packet);
             return ret;
         }
     }
-    avlibInterface::m_av_free_packet(&packet);
-    avlibInterface::m_av_frame_free(&pRgbFrame);
-    fflush(stdout);
+#ifdef QT_DEBUG
+    if (m_rgbFrames.allocCount() > 1) {
+        qCWarning(dsrApp) << "Video frame wrappers allocated more than once:" << m_rgbFrames.allocCount();
+    }
+#endif
     qCDebug(dsrApp) << "Video frame successfully written";
     return 0;
 }
 
+bool CAVOutputStream::prepareRgbFrame(WaylandFrame &frame)
+{
+    //只在第一帧分配，之后每帧复用；不再调用 av_frame_get_buffer，像素直接引用环形缓冲区槽位，包装帧总是可复用
+    const bool acquired = m_rgbFrames.acquire(m_rgbFrame, [](AVFrame *) {
+        return true;
+    }, [this](AVFrame *&created) {
+        qCDebug(dsrApp) << "Allocating RGB frame wrapper";
+        created = avlibInterface::m_av_frame_alloc();
+        if (nullptr == created) {
+            return false;
+        }
+        avlibInterface::m_av_init_packet(&m_videoPacket);
+        m_videoPacket.data = nullptr;
+        m_videoPacket.size = 0;
+        return true;
+    }, [](AVFrame *&) {
+        return true;
+    });
+    if (!acquired) {
+        qCCritical(dsrApp) << "Failed to allocate RGB frame wrapper";
+        return false;
+    }
+    //av_frame_apply_cropping 会改写 data、宽高和裁剪量，每帧都要重新设置
+    AVFrame *pRgbFrame = m_rgbFrame;
+    pRgbFrame->width  = frame._width;
+    pRgbFrame->height = frame._height;
+    pRgbFrame->format = AV_PIX_FMT_RGB32;
+    pRgbFrame->crop_left   = static_cast<size_t>(m_left);
+    pRgbFrame->crop_top    = static_cast<size_t>(m_top);
+    pRgbFrame->crop_right  = static_cast<size_t>(m_right);
+    pRgbFrame->crop_bottom = static_cast<size_t>(m_bottom);
+    pRgbFrame->linesize[0] = frame._stride;
+    pRgbFrame->data[0]     = frame._frame;
+    if (avlibInterface::m_av_frame_apply_cropping(pRgbFrame, AV_FRAME_CROP_UNALIGNED) < 0) {
+        qCCritical(dsrApp) << "Failed to apply frame cropping";
+        return false;
+    }
+    return true;
+}
+
+int CAVOutputStream::sendVideoFrame(AVFrame *yuvFrame, int64_t time)
+{
+    if (nullptr != yuvFrame) {
+        yuvFrame->width  = pCodecCtx->width;
+        yuvFrame->height = pCodecCtx->height;
+        yuvFrame->format = AV_PIX_FMT_YUV420P;
+        yuvFrame->pts = m_videoEncodePts++;
+        m_videoFrameTimes[yuvFrame->pts % VideoTimeSlots] = time;
+    } else if (m_videoEncoderFlushed.exchange(true)) {
+        //已经冲刷过
+        return AVERROR_EOF;
+    }
+    int ret = avlibInterface::m_avcodec_send_frame(pCodecCtx, yuvFrame);
+    if (ret < 0 && ret != AVERROR_EOF) {
+        qCWarning(dsrApp) << "Failed to send video frame to encoder, error code:" << ret;
+    }
+    return ret;
+}
+
+int CAVOutputStream::receiveVideoPacket(AVPacket *packet)
+{
+    int ret = avlibInterface::m_avcodec_receive_packet(pCodecCtx, packet);
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        return 0;
+    }
+    if (ret < 0) {
+        qCWarning(dsrApp) << "Failed to receive video packet, error code:" << ret;
+        return ret;
+    }
+    const int64_t time = m_captureClock.streamTimeUs(m_videoFrameTimes[packet->pts % VideoTimeSlots]);
+    packet->stream_index = m_videoStream->index;
+    m_videoFrameCount++;
+    if (m_videoFrameCount == 1) {
+        m_fristVideoFramePts = time;
+        qCInfo(dsrApp) << "First video frame timestamp set:" << m_fristVideoFramePts;
+    }
+    //视频与音频以采集时钟的同一起点计时；打开输出流前进入环形缓冲区的帧时间会被截到起点，需保证 pts 递增
+    int64_t pts = static_cast<int64_t>(m_videoStream->time_base.den) * time / AV_TIME_BASE;
+    if (pts <= m_lastVideoPts) {
+        pts = m_lastVideoPts + 1;
+    }
+    m_lastVideoPts = pts;
+    //不输出 B 帧，dts 与 pts 相同
+    packet->pts = pts;
+    packet->dts = packet->pts;
+    return 1;
+}
+
+void CAVOutputStream::flushVideoEncoder()
+{
+    if (nullptr == pCodecCtx || nullptr == m_videoStream || m_videoEncoderFlushed.load()) {
+        return;
+    }
+    if (sendVideoFrame(nullptr, 0) < 0) {
+        return;
+    }
+    AVPacket &packet = m_videoPacket;
+    int flushed = 0;
+    while (1 == receiveVideoPacket(&packet)) {
+        if (writeFrame(m_videoFormatContext, &packet) < 0) {
+            qCWarning(dsrApp) << "Failed to write delayed video packet";
+        }
+        avlibInterface::m_av_packet_unref(&packet);
+        flushed++;
+    }
+    qCInfo(dsrApp) << "Video encoder flushed," << flushed << "delayed packets written";
+}
+
+void CAVOutputStream::setVideoEncoderOptions(const VideoEncoderOptions &options)
+{
+    m_videoEncoderOptions = options;
+    if (!videoEncoderPresets().contains(options.preset)) {
+        qCWarning(dsrApp) << "Unknown x264 preset" << options.preset << ", using ultrafast";
+        m_videoEncoderOptions.preset = "ultrafast";
+    }
+    if (!options.tune.isEmpty() && !videoEncoderTunes().contains(options.tune)) {
+        qCWarning(dsrApp) << "Unknown x264 tune" << options.tune << ", ignored";
+        m_videoEncoderOptions.tune.clear();
+    }
+    if (options.crf > 51) {
+        m_videoEncoderOptions.crf = 51;
+    }
+    if (options.threads < 0) {
+        m_videoEncoderOptions.threads = 0;
+    }
+    qCInfo(dsrApp) << "Video encoder options - preset:" << m_videoEncoderOptions.preset
+                   << "tune:" << m_videoEncoderOptions.tune << "crf:" << m_videoEncoderOptions.crf
+                   << "threads:" << m_videoEncoderOptions.threads
+                   << (m_videoEncoderOptions.sliceThreads ? "slice" : "frame");
+}
+
+CAVOutputStream::VideoEncoderOptions CAVOutputStream::videoEncoderOptionsFromSettings(ConfigSettings *settings)
+{
+    VideoEncoderOptions options;
+    options.preset = settings->getValue("recorder", "encoder_preset").toString();
+    options.tune = settings->getValue("recorder", "encoder_tune").toString();
+    options.crf = settings->getValue("recorder", "encoder_crf").toInt();
+    options.threads = settings->getValue("recorder", "encoder_threads").toInt();
+    options.sliceThreads = settings->getValue("recorder", "encoder_thread_type").toString() == "slice";
+    return options;
+}
+
+const CAVOutputStream::VideoEncoderOptions &CAVOutputStream::videoEncoderOptions() const
+{
+    return m_videoEncoderOptions;
+}
+
+QStringList CAVOutputStream::videoEncoderPresets()
+{
+    return QStringList() << "ultrafast" << "superfast" << "veryfast" << "faster" << "fast"
+           << "medium" << "slow" << "slower" << "veryslow";
+}
+
+QStringList CAVOutputStream::videoEncoderTunes()
+{
+    return QStringList() << "zerolatency" << "animation" << "stillimage";
+}
+
+void CAVOutputStream::setFragmentDuration(int seconds)
+{
+    m_fragmentSeconds = FragmentOptions::clampSeconds(seconds);
+}
+
+int CAVOutputStream::fragmentDuration() const
+{
+    return m_fragmentSeconds;
+}
+
+void CAVOutputStream::applyFragmentOptions(AVDictionary **options, int videoType, int fragmentSeconds)
+{
+    for (const auto &option : FragmentOptions::muxOptions(videoType == Utils::kMKV, fragmentSeconds)) {
+        avlibInterface::m_av_dict_set(options, option.first.c_str(), option.second.c_str(), 0);
+    }
+}
+
+void CAVOutputStream::applyVideoEncoderOptions(AVCodecContext *codecCtx, AVDictionary **param, const VideoEncoderOptions &options)
+{
+    codecCtx->thread_count = options.threads;
+    codecCtx->thread_type = options.sliceThreads ? FF_THREAD_SLICE : FF_THREAD_FRAME;
+    avlibInterface::m_av_dict_set(param, "preset", options.preset.toLatin1().constData(), 0);
+    if (!options.tune.isEmpty()) {
+        avlibInterface::m_av_dict_set(param, "tune", options.tune.toLatin1().constData(), 0);
+    }
+    if (options.crf >= 0) {
+        avlibInterface::m_av_dict_set(param, "crf", QByteArray::number(options.crf).constData(), 0);
+    }
+}
+
+QList<CAVOutputStream::EncoderBenchmarkResult> CAVOutputStream::benchmarkVideoEncoder(int width, int height, int frames,
+                                                                                      const VideoEncoderOptions &options,
+                                                                                      const QStringList &presets)
+{
+    QList<EncoderBenchmarkResult> results;
+    const AVCodec *codec = avlibInterface::m_avcodec_find_encoder(AV_CODEC_ID_H264);
+    for (const QString &preset : presets) {
+        EncoderBenchmarkResult result;
+        result.preset = preset;
+        result.frames = 0;
+        result.fps = 0.0;
+        result.bufferAllocs = 0;
+        AVCodecContext *codecCtx = nullptr == codec ? nullptr : avlibInterface::m_avcodec_alloc_context3(codec);
+        if (nullptr == codecCtx) {
+            qCWarning(dsrApp) << "H264 encoder unavailable for benchmark";
+            results.append(result);
+            continue;
+        }
+        codecCtx->pix_fmt = AV_PIX_FMT_YUV420P;
+        codecCtx->width = width;
+        codecCtx->height = height;
+        codecCtx->time_base.num = 1;
+        codecCtx->time_base.den = 30;
+        codecCtx->gop_size = 30;
+        codecCtx->qmin = 10;
+        codecCtx->qmax = 51;
+        codecCtx->max_b_frames = 0;
+        VideoEncoderOptions presetOptions = options;
+        presetOptions.preset = preset;
+        AVDictionary *param = nullptr;
+        applyVideoEncoderOptions(codecCtx, &param, presetOptions);
+        AVFrame *yuvFrame = avlibInterface::m_av_frame_alloc();
+        yuvFrame->width = width;
+        yuvFrame->height = height;
+        yuvFrame->format = AV_PIX_FMT_YUV420P;
+        if (avlibInterface::m_avcodec_open2(codecCtx, codec, &param) < 0
+                || avlibInterface::m_av_frame_get_buffer(yuvFrame, 32) < 0) {
+            qCWarning(dsrApp) << "Failed to open encoder for benchmark, preset:" << preset;
+            avlibInterface::m_av_dict_free(&param);
+            avlibInterface::m_av_frame_free(&yuvFrame);
+            avlibInterface::m_avcodec_free_context(&codecCtx);
+            results.append(result);
+            continue;
+        }
+        avlibInterface::m_av_dict_free(&param);
+        AVPacket packet;
+        avlibInterface::m_av_init_packet(&packet);
+        packet.data = nullptr;
+        packet.size = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i <= frames; i++) {
+            if (i < frames) {
+                //每帧平移的渐变画面，避免编码器把整帧当作静止画面跳过
+                //帧仍被编码器引用时 av_frame_make_writable 会复制出新的缓冲区
+                if (!avlibInterface::m_av_frame_is_writable(yuvFrame)) {
+                    result.bufferAllocs++;
+                }
+                if (avlibInterface::m_av_frame_make_writable(yuvFrame) < 0) {
+                    break;
+                }
+                for (int y = 0; y < height; y++) {
+                    uint8_t *row = yuvFrame->data[0] + static_cast<ptrdiff_t>(y) * yuvFrame->linesize[0];
+                    for (int x = 0; x < width; x++) {
+                        row[x] = static_cast<uint8_t>(x + y * 2 + i * 3);
+                    }
+                }
+                for (int plane = 1; plane < 3; plane++) {
+                    for (int y = 0; y < (height + 1) / 2; y++) {
+                        memset(yuvFrame->data[plane] + static_cast<ptrdiff_t>(y) * yuvFrame->linesize[plane],
+                               128 + ((y + i) & 31), static_cast<size_t>((width + 1) / 2));
+                    }
+                }
+                yuvFrame->pts = i;
+            }
+            if (avlibInterface::m_avcodec_send_frame(codecCtx, i < frames ? yuvFrame : nullptr) < 0) {
+                break;
+            }
+            while (avlibInterface::m_avcodec_receive_packet(codecCtx, &packet) >= 0) {
+                result.frames++;
+                avlibInterface::m_av_packet_unref(&packet);
+            }
+        }
+        const qint64 elapsedNs = timer.nsecsElapsed();
+        result.fps = elapsedNs > 0 ? result.frames * 1000000000.0 / elapsedNs : 0.0;
+        qCInfo(dsrApp) << "Encoder benchmark" << width << "x" << height << "preset:" << preset
+                       << "tune:" << options.tune << "threads:" << options.threads
+                       << (options.sliceThreads ? "slice" : "frame") << "fps:" << result.fps
+                       << "buffer allocs:" << result.bufferAllocs;
+        avlibInterface::m_av_frame_free(&yuvFrame);
+        avlibInterface::m_avcodec_free_context(&codecCtx);
+        results.append(result);
+    }
+    return results;
+}
+
+bool CAVOutputStream::startVideoPipeline()
+{
+    stopVideoPipeline();
+    if (nullptr == pCodecCtx || nullptr == m_videoStream) {
+        return false;
+    }
+    //帧和包在启动时一次性分配，之后在各级之间循环使用
+    m_pipelineFrames.clear();
+    for (int i = 0; i < VideoPipelineDepth; i++) {
+        AVFrame *yuvFrame = avlibInterface::m_av_frame_alloc();
+        if (nullptr == yuvFrame) {
+            break;
+        }
+        yuvFrame->width = pCodecCtx->width;
+        yuvFrame->height = pCodecCtx->height;
+        yuvFrame->format = AV_PIX_FMT_YUV420P;
+        if (avlibInterface::m_av_frame_get_buffer(yuvFrame, 32) < 0) {
+            avlibInterface::m_av_frame_free(&yuvFrame);
+            break;
+        }
+        m_pipelineFrames.push_back(yuvFrame);
+    }
+    if (static_cast<int>(m_pipelineFrames.size()) != VideoPipelineDepth) {
+        qCWarning(dsrApp) << "Failed to allocate video pipeline frames";
+        for (AVFrame *yuvFrame : m_pipelineFrames) {
+            avlibInterface::m_av_frame_free(&yuvFrame);
+        }
+        m_pipelineFrames.clear();
+        return false;
+    }
+    m_pipelinePackets.assign(VideoPipelineDepth, AVPacket());
+    m_freeVideoFrames.reset(VideoPipelineDepth);
+    m_encodeQueue.reset(VideoPipelineDepth);
+    m_freeVideoPackets.reset(VideoPipelineDepth);
+    m_muxQueue.reset(VideoPipelineDepth);
+    for (int i = 0; i < VideoPipelineDepth; i++) {
+        AVPacket *packet = &m_pipelinePackets[static_cast<size_t>(i)];
+        avlibInterface::m_av_init_packet(packet);
+        packet->data = nullptr;
+        packet->size = 0;
+        m_freeVideoFrames.push(m_pipelineFrames[static_cast<size_t>(i)]);
+        m_freeVideoPackets.push(packet);
+    }
+    for (StageStats &stats : m_videoStageStats) {
+        stats.reset();
+    }
+    m_videoPipelineRunning.store(true, std::memory_order_release);
+    m_encodeThread = std::thread(&CAVOutputStream::encodeLoop, this);
+    m_muxThread = std::thread(&CAVOutputStream::muxLoop, this);
+    qCInfo(dsrApp) << "Video pipeline started, depth:" << VideoPipelineDepth;
+    return true;
+}
+
+void CAVOutputStream::stopVideoPipeline()
+{
+    if (!m_encodeThread.joinable() && !m_muxThread.joinable()) {
+        return;
+    }
+    //先停止转换级，再依次排空编码、封装队列，已采集的帧全部写入文件
+    m_freeVideoFrames.close();
+    {
+        std::lock_guard<std::mutex> locker(m_convertStageMutex);
+        m_videoPipelineRunning.store(false, std::memory_order_release);
+    }
+    m_encodeQueue.close();
+    if (m_encodeThread.joinable()) {
+        m_encodeThread.join();
+    }
+    m_muxQueue.close();
+    if (m_muxThread.joinable()) {
+        m_muxThread.join();
+    }
+    m_freeVideoPackets.close();
+    qCInfo(dsrApp) << "Video pipeline stopped," << videoPipelineReport();
+    for (AVFrame *yuvFrame : m_pipelineFrames) {
+        avlibInterface::m_av_frame_free(&yuvFrame);
+    }
+    m_pipelineFrames.clear();
+    for (AVPacket &packet : m_pipelinePackets) {
+        avlibInterface::m_av_packet_unref(&packet);
+    }
+    m_pipelinePackets.clear();
+}
+
+void CAVOutputStream::encodeLoop()
+{
+    //送入编码器的帧：编码器可能引用其缓冲区（帧线程、lookahead 延迟输出），引用释放前不能再写入
+    std::deque<AVFrame *> heldFrames;
+    VideoJob job;
+    while (m_encodeQueue.pop(job)) {
+        const int64_t begin = FramePacer::monotonicNs();
+        if (sendVideoFrame(job.frame, job.time) >= 0) {
+            forwardVideoPackets();
+        }
+        heldFrames.push_back(job.frame);
+        recycleVideoFrames(heldFrames);
+        m_videoStageStats[EncodeStage].record(begin - job.queuedNs, FramePacer::monotonicNs() - begin);
+    }
+    //队列关闭：冲刷编码器延迟的帧，交给封装级写完
+    if (sendVideoFrame(nullptr, 0) >= 0) {
+        forwardVideoPackets();
+    }
+}
+
+void CAVOutputStream::recycleVideoFrames(std::deque<AVFrame *> &heldFrames)
+{
+    for (auto itr = heldFrames.begin(); itr != heldFrames.end();) {
+        //缓冲区的引用计数为 1 时只有本帧引用
+        if (avlibInterface::m_av_frame_is_writable(*itr)) {
+            m_freeVideoFrames.push(*itr);
+            itr = heldFrames.erase(itr);
+        } else {
+            ++itr;
+        }
+    }
+    if (static_cast<int>(heldFrames.size()) < VideoPipelineDepth) {
+        return;
+    }
+    //流水线中的帧全部被编码器引用，转换级将无帧可用
+    AVFrame *yuvFrame = heldFrames.front();
+    avlibInterface::m_av_frame_unref(yuvFrame);
+    yuvFrame->width = pCodecCtx->width;
+    yuvFrame->height = pCodecCtx->height;
+    yuvFrame->format = AV_PIX_FMT_YUV420P;
+    if (avlibInterface::m_av_frame_get_buffer(yuvFrame, 32) < 0) {
+        qCCritical(dsrApp) << "Failed to reallocate video pipeline frame";
+        return;
+    }
+    m_videoBufferAllocCount++;
+    heldFrames.pop_front();
+    m_freeVideoFrames.push(yuvFrame);
+}
+
+void CAVOutputStream::forwardVideoPackets()
+{
+    for (;;) {
+        AVPacket *packet = nullptr;
+        if (!m_freeVideoPackets.pop(packet)) {
+            return;
+        }
+        if (1 != receiveVideoPacket(packet)) {
+            avlibInterface::m_av_packet_unref(packet);
+            m_freeVideoPackets.push(packet);
+            return;
+        }
+        PacketJob packetJob;
+        packetJob.packet = packet;
+        packetJob.queuedNs = FramePacer::monotonicNs();
+        if (!m_muxQueue.push(packetJob)) {
+            avlibInterface::m_av_packet_unref(packet);
+            m_freeVideoPackets.push(packet);
+            return;
+        }
+        m_videoStageStats[MuxStage].setDepth(m_muxQueue.depth());
+    }
+}
+
+void CAVOutputStream::muxLoop()
+{
+    PacketJob job;
+    while (m_muxQueue.pop(job)) {
+        const int64_t begin = FramePacer::monotonicNs();
+        int ret = writeFrame(m_videoFormatContext, job.packet);
+        if (ret < 0) {
+            qCCritical(dsrApp) << "Failed to write video frame, error code:" << ret;
+        }
+        avlibInterface::m_av_packet_unref(job.packet);
+        m_freeVideoPackets.push(job.packet);
+        m_videoStageStats[MuxStage].record(begin - job.queuedNs, FramePacer::monotonicNs() - begin);
+    }
+}
+
+const StageStats &CAVOutputStream::videoStageStats(VideoStage stage) const
+{
+    return m_videoStageStats[stage < VideoStageCount ? stage : ConvertStage];
+}
+
+QString CAVOutputStream::videoPipelineReport() const
+{
+    static const char *const names[VideoStageCount] = {"convert", "encode", "mux"};
+    QStringList parts;
+    for (int i = 0; i < VideoStageCount; i++) {
+        const StageStats &stats = m_videoStageStats[i];
+        parts << QString("%1: %2 frames, wait %3/%4 ms, process %5/%6 ms, depth %7/%8")
+              .arg(names[i])
+              .arg(stats.count())
+              .arg(stats.averageWaitNs() / 1000000.0, 0, 'f', 2)
+              .arg(stats.maxWaitNs() / 1000000.0, 0, 'f', 2)
+              .arg(stats.averageProcessNs() / 1000000.0, 0, 'f', 2)
+              .arg(stats.maxProcessNs() / 1000000.0, 0, 'f', 2)
+              .arg(stats.depth())
+              .arg(stats.maxDepth());
+    }
+    return parts.join("; ");
+}
+
+CaptureClock &CAVOutputStream::captureClock()
+{
+    return m_captureClock;
+}
+
+const AudioDriftMonitor &CAVOutputStream::micDriftMonitor() const
+{
+    return m_micDrift;
+}
+
+const AudioDriftMonitor &CAVOutputStream::sysDriftMonitor() const
+{
+    return m_sysDrift;
+}
+
+QString CAVOutputStream::audioDriftReport() const
+{
+    const AudioDriftMonitor *monitors[] = {&m_micDrift, &m_sysDrift};
+    static const char *const names[] = {"mic", "sys"};
+    QStringList parts;
+    for (int i = 0; i < 2; i++) {
+        const AudioDriftMonitor &monitor = *monitors[i];
+        if (monitor.sampleRate() <= 0) {
+            continue;
+        }
+        parts << QString("%1: drift %2 ms, max %3 ms, inserted %4, dropped %5, resyncs %6")
+              .arg(names[i])
+              .arg(monitor.driftUs() / 1000.0, 0, 'f', 2)
+              .arg(monitor.maxDriftUs() / 1000.0, 0, 'f', 2)
+              .arg(monitor.insertedSamples())
+              .arg(monitor.droppedSamples())
+              .arg(monitor.resyncCount());
+    }
+    return parts.join("; ");
+}
+
+uint64_t CAVOutputStream::videoFrameAllocCount() const
+{
+    return m_rgbFrames.allocCount() + m_videoBufferAllocCount.load();
+}
+
+uint64_t CAVOutputStream::audioMixAllocCount() const
+{
+    return m_audioMixAllocCount.load() + m_micMixFrames.allocCount() + m_sysMixFrames.allocCount();
+}
+
+void CAVOutputStream::convertVideoFrame(AVFrame *rgbFrame, AVFrame *yuvFrame)
+{
+    AVPixelFormat fmt = AV_PIX_FMT_RGBA;
+    if (m_boardVendorType) {
+        fmt = AV_PIX_FMT_RGB32;
+    }
+    if (m_width != pCodecCtx->width || m_height != pCodecCtx->height) {
+        //需要缩放时保持原来的整帧双三次插值
+        if (nullptr == m_pVideoSwsContext) {
+            qCDebug(dsrApp) << "Initializing video scaling context";
+            m_pVideoSwsContext = avlibInterface::m_sws_getContext(m_width, m_height,
+                                                                  fmt,
+                                                                  pCodecCtx->width,
+                                                                  pCodecCtx->height,
+                                                                  AV_PIX_FMT_YUV420P,
+                                                                  SWS_BICUBIC,
+                                                                  nullptr,
+                                                                  nullptr,
+                                                                  nullptr);
+        }
+        avlibInterface::m_sws_scale(m_pVideoSwsContext, rgbFrame->data, rgbFrame->linesize, 0, m_height, yuvFrame->data, yuvFrame->linesize);
+        return;
+    }
+
+    //尺寸不变时只做颜色空间转换，使用按 CPU 指令集分派的 I420Converter，按偶数行条带并行
+    if (nullptr == m_slicePool) {
+        m_slicePool = new SlicePool(SlicePool::defaultThreadCount());
+        qCInfo(dsrApp) << "Video conversion uses" << m_slicePool->threadCount() << "slices,"
+                       << I420Converter::isaName(I420Converter::activeIsa());
+    }
+    const I420Converter::SourceFormat format = m_boardVendorType ? I420Converter::BGRA : I420Converter::RGBA;
+    const int slices = m_slicePool->threadCount();
+    m_slicePool->run(slices, [this, rgbFrame, yuvFrame, format, slices](int index) {
+        int y = 0;
+        int rows = 0;
+        SlicePool::sliceRange(m_height, slices, index, 2, y, rows);
+        if (rows <= 0) {
+            return;
+        }
+        const I420Converter::Planes planes = {yuvFrame->data[0], yuvFrame->linesize[0],
+                                              yuvFrame->data[1], yuvFrame->linesize[1],
+                                              yuvFrame->data[2], yuvFrame->linesize[2]
+                                             };
+        I420Converter::convert(rgbFrame->data[0] + static_cast<ptrdiff_t>(y) * rgbFrame->linesize[0],
+                               rgbFrame->linesize[0], format, m_width, rows, I420Converter::slicePlanes(planes, y));
+    });
+}
+
 //input_st -- 输入流的信息
 //input_frame -- 输入音频帧的信息
 //lTimeStamp -- 时间戳，时间单位为1/1000000
 //
-int CAVOutputStream::writeMicAudioFrame(AVStream *stream, AVFrame *inputFrame, int64_t lTimeStamp)
+int CAVOutputStream::writeMicAudioFrame(AVCodecContext *inputContext, AVFrame *inputFrame, int64_t lTimeStamp)
 {
     qCDebug(dsrApp) << "Starting to write microphone audio frame";
     
@@ -829,26 +1219,21 @@ int CAVOutputStream::writeMicAudioFrame(AVStream *stream, AVFrame *inputFrame, i
     int ret;
     if (nullptr == m_pMicAudioSwrContext) {
         qCDebug(dsrApp) << "Initializing microphone audio resampler";
-        // Initialize the resampler to be able to convert audio sample formats
-        m_pMicAudioSwrContext = avlibInterface::m_swr_alloc_set_opts(nullptr,
-                                                                     avlibInterface::m_av_get_default_channel_layout(m_pMicCodecContext->channels),
-                                                                     m_pMicCodecContext->sample_fmt,
-                                                                     m_pMicCodecContext->sample_rate,
-                                                                     avlibInterface::m_av_get_default_channel_layout(stream->codec->channels),
-                                                                     stream->codec->sample_fmt,
-                                                                     stream->codec->sample_rate,
-                                                                     0,
-                                                                     nullptr);
         /**
         * Perform a sanity check so that the number of converted samples is
         * not greater than the number of samples to be converted.
         * If the sample rates differ, this case has to be handled differently
         */
-        assert(m_pMicCodecContext->sample_rate == stream->codec->sample_rate);
-        avlibInterface::m_swr_init(m_pMicAudioSwrContext);
+        assert(m_pMicCodecContext->sample_rate == inputContext->sample_rate);
+        // Initialize the resampler to be able to convert audio sample formats
+        m_pMicAudioSwrContext = ChannelLayouts::createResampler(m_pMicCodecContext, inputContext);
+        if (nullptr == m_pMicAudioSwrContext) {
+            qCCritical(dsrApp) << "Could not create microphone audio resampler";
+            return AVERROR(EINVAL);
+        }
         if (nullptr == m_micAudioFifo) {
             qCDebug(dsrApp) << "Allocating microphone audio FIFO buffer";
-            m_micAudioFifo = audioFifoAlloc(m_pMicCodecContext->sample_fmt, m_pMicCodecContext->channels, 20 * inputFrame->nb_samples);
+            m_micAudioFifo = audioFifoAlloc(m_pMicCodecContext->sample_fmt, ChannelLayouts::count(m_pMicCodecContext), 20 * inputFrame->nb_samples);
         }
         is_fifo_scardinit++;
     }
@@ -858,7 +1243,7 @@ int CAVOutputStream::writeMicAudioFrame(AVStream *stream, AVFrame *inputFrame, i
     * block for convenience.
     */
 
-    if ((ret = avlibInterface::m_av_samples_alloc(m_convertedMicSamples, nullptr, m_pMicCodecContext->channels, inputFrame->nb_samples, m_pMicCodecContext->sample_fmt, 0)) < 0) {
+    if ((ret = avlibInterface::m_av_samples_alloc(m_convertedMicSamples, nullptr, ChannelLayouts::count(m_pMicCodecContext), inputFrame->nb_samples, m_pMicCodecContext->sample_fmt, 0)) < 0) {
         printf("Could not allocate converted input samples\n");
         avlibInterface::m_av_freep(&(*m_convertedMicSamples)[0]);
         free(*m_convertedMicSamples);
@@ -878,17 +1263,22 @@ int CAVOutputStream::writeMicAudioFrame(AVStream *stream, AVFrame *inputFrame, i
         return ret;
     }
     freeSwrContext(m_pMicAudioSwrContext);
-    AVRational rational;
+    if (m_micDrift.sampleRate() != m_pMicCodecContext->sample_rate) {
+        m_micDrift.reset(m_pMicCodecContext->sample_rate);
+    }
+    const int correction = m_micDrift.update(lTimeStamp, inputFrame->nb_samples);
+    lTimeStamp = m_captureClock.streamTimeUs(lTimeStamp);
+    AVRational rational = {1, AV_TIME_BASE };
     int audioSize = audioFifoSize(m_micAudioFifo);
     //因为Fifo里有之前未读完的数据，所以从Fifo队列里面取出的第一个音频包的时间戳等于当前时间减掉缓冲部分的时长
-    int64_t timeshift = static_cast<int64_t>(audioSize * AV_TIME_BASE) / static_cast<int64_t>(stream->codec->sample_rate);
+    int64_t timeshift = static_cast<int64_t>(audioSize * AV_TIME_BASE) / static_cast<int64_t>(inputContext->sample_rate);
     /** Add the converted input samples to the FIFO buffer for later processing. */
 
     /**
     * Make the FIFO as large as it needs to be to hold both,
     * the old and the new samples.
     */
-    if ((ret = audioFifoRealloc(m_micAudioFifo, audioFifoSize(m_micAudioFifo) + inputFrame->nb_samples)) < 0) {
+    if ((ret = audioFifoRealloc(m_micAudioFifo, audioFifoSize(m_micAudioFifo) + inputFrame->nb_samples + 1)) < 0) {
         printf("Could not reallocate FIFO\n");
         return ret;
     }
@@ -896,11 +1286,18 @@ int CAVOutputStream::writeMicAudioFrame(AVStream *stream, AVFrame *inputFrame, i
     /** Store the new samples in the FIFO buffer. */
     //write m_convertedMicSamples
     //static_cast、dynamic_cast、const_cast、reinterpret_cast
-    if (audioWrite(m_micAudioFifo, reinterpret_cast<void **>(m_convertedMicSamples), inputFrame->nb_samples) < inputFrame->nb_samples) {
+    //漂移修正：丢弃末尾的样本，或在末尾重复最后一个样本
+    const int writeSamples = correction < 0 ? inputFrame->nb_samples + correction : inputFrame->nb_samples;
+    if (audioWrite(m_micAudioFifo, reinterpret_cast<void **>(m_convertedMicSamples), writeSamples) < writeSamples) {
         printf("Could not write data to FIFO\n");
         return AVERROR_EXIT;
     }
-    int64_t timeinc = static_cast<int64_t>(m_pMicCodecContext->frame_size * AV_TIME_BASE / stream->codec->sample_rate);
+    if (correction > 0) {
+        uint8_t *lastSample[AV_NUM_DATA_POINTERS] = {nullptr};
+        lastSamplePlanes(m_convertedMicSamples, m_pMicCodecContext, inputFrame->nb_samples, lastSample);
+        audioWrite(m_micAudioFifo, reinterpret_cast<void **>(lastSample), correction);
+    }
+    int64_t timeinc = static_cast<int64_t>(m_pMicCodecContext->frame_size * AV_TIME_BASE / inputContext->sample_rate);
     //当前帧的时间戳不能小于上一帧的值
     if (lTimeStamp - timeshift > m_nLastAudioPresentationTime) {
         m_nLastAudioPresentationTime = lTimeStamp - timeshift;
@@ -932,7 +1329,7 @@ int CAVOutputStream::writeMicAudioFrame(AVStream *stream, AVFrame *inputFrame, i
         * are assumed for simplicity.
         */
         outputFrame->nb_samples = frame_size;
-        outputFrame->channel_layout = m_pMicCodecContext->channel_layout;
+        ChannelLayouts::copyToFrame(outputFrame, m_pMicCodecContext);
         outputFrame->format = m_pMicCodecContext->sample_fmt;
         outputFrame->sample_rate = m_pMicCodecContext->sample_rate;
         outputFrame->pts = avlibInterface::m_av_rescale_q(m_nLastAudioPresentationTime, rational, m_micAudioStream->time_base);
@@ -963,28 +1360,31 @@ int CAVOutputStream::writeMicAudioFrame(AVStream *stream, AVFrame *inputFrame, i
         avlibInterface::m_av_init_packet(&outputPacket);
         outputPacket.data = nullptr;
         outputPacket.size = 0;
-        int enc_got_frame_a = 0;
         /**
             * Encode the audio frame and store it in the temporary packet.
             * The output audio stream encoder is used to do this.
             */
         //outputFrame -> outputPacket
-        if ((ret = avlibInterface::m_avcodec_encode_audio2(m_pMicCodecContext, &outputPacket, outputFrame, &enc_got_frame_a)) < 0) {
+        if ((ret = avlibInterface::m_avcodec_send_frame(m_pMicCodecContext, outputFrame)) < 0) {
             printf("Could not encode frame\n");
-            avlibInterface::m_av_packet_unref(&outputPacket);
+            avlibInterface::m_av_frame_free(&outputFrame);
             return ret;
         }
         /** Write one audio frame from the temporary packet to the output file. */
-        if (enc_got_frame_a) {
+        //编码器有延迟时一帧可能没有输出，取出当前可输出的全部包
+        while (avlibInterface::m_avcodec_receive_packet(m_pMicCodecContext, &outputPacket) >= 0) {
             outputPacket.stream_index = m_micAudioStream->index;
             printf("output_packet.stream_index1  audio_st =%d\n", outputPacket.stream_index);
             //outputPacket.pts = avlibInterface::m_av_rescale_q(m_nLastAudioPresentationTime, rational, m_micAudioStream->time_base);
+            //音频流从第一个样本的采集时间起算，之后按样本数递增
+            const int64_t samplePts = audioStartSamples(m_micDrift.startUs(), m_pMicCodecContext->sample_rate)
+                                      + m_singleCount * m_pMicCodecContext->frame_size;
             if (m_videoType == Utils::kMKV) {
                 //显示时间戳，应大于或等于解码时间戳
-                outputPacket.pts = m_singleCount * m_pMicCodecContext->frame_size * 1000 / m_pMicCodecContext->sample_rate;
+                outputPacket.pts = samplePts * 1000 / m_pMicCodecContext->sample_rate;
             } else {
                 //显示时间戳，应大于或等于解码时间戳
-                outputPacket.pts = m_singleCount * m_pMicCodecContext->frame_size;
+                outputPacket.pts = samplePts;
             }
             outputPacket.dts = outputPacket.pts;
             //qDebug() << m_singleCount << " mic audio outputPacket.pts: " << outputPacket.pts;
@@ -1007,75 +1407,61 @@ int CAVOutputStream::writeMicAudioFrame(AVStream *stream, AVFrame *inputFrame, i
     return 0;
 }
 
-int CAVOutputStream::writeMicToMixAudioFrame(AVStream *stream, AVFrame *inputFrame, int64_t lTimeStamp)
+int CAVOutputStream::writeMicToMixAudioFrame(AVCodecContext *inputContext, AVFrame *inputFrame, int64_t lTimeStamp)
 {
     qCDebug(dsrApp) << "Starting to write microphone audio frame for mixing";
     
-    Q_UNUSED(lTimeStamp)
     int ret;
     if (nullptr == m_pMicAudioSwrContext) {
         qCDebug(dsrApp) << "Initializing microphone audio resampler for mixing";
-        // Initialize the resampler to be able to convert audio sample formats
-        m_pMicAudioSwrContext = avlibInterface::m_swr_alloc_set_opts(nullptr,
-                                                                     avlibInterface::m_av_get_default_channel_layout(m_pMicCodecContext->channels),
-                                                                     m_pMicCodecContext->sample_fmt,
-                                                                     m_pMicCodecContext->sample_rate,
-                                                                     avlibInterface::m_av_get_default_channel_layout(stream->codec->channels),
-                                                                     stream->codec->sample_fmt,
-                                                                     stream->codec->sample_rate,
-                                                                     0,
-                                                                     nullptr);
-        assert(m_pMicCodecContext->sample_rate == stream->codec->sample_rate);
-        avlibInterface::m_swr_init(m_pMicAudioSwrContext);
-        if (nullptr == m_micAudioFifo) {
+        //两路音频都重采样为混音编码器的格式，混音器只需逐样本相加
+        m_pMicAudioSwrContext = ChannelLayouts::createResampler(pCodecCtx_amix, inputContext);
+        if (nullptr == m_pMicAudioSwrContext) {
+            qCCritical(dsrApp) << "Could not create microphone audio resampler";
+            return AVERROR(EINVAL);
+        }
+        m_audioMixAllocCount++;
+        if (!m_micMixFifo.isInit()) {
             qCDebug(dsrApp) << "Allocating microphone audio FIFO buffer for mixing";
-            m_micAudioFifo = audioFifoAlloc(m_pMicCodecContext->sample_fmt, m_pMicCodecContext->channels, 20 * inputFrame->nb_samples);
+            if (!initMixFifo(m_micMixFifo, pCodecCtx_amix, 20 * inputFrame->nb_samples)) {
+                return AVERROR(EINVAL);
+            }
         }
         is_fifo_scardinit++;
     }
-    if ((ret = avlibInterface::m_av_samples_alloc(m_convertedMicSamples, nullptr, m_pMicCodecContext->channels, inputFrame->nb_samples, m_pMicCodecContext->sample_fmt, 0)) < 0) {
-        printf("Could not allocate converted input samples\n");
-        avlibInterface::m_av_freep(&(*m_convertedMicSamples)[0]);
-        free(*m_convertedMicSamples);
-        freeSwrContext(m_pMicAudioSwrContext);
-        return ret;
+    //重采样上下文和输出缓冲区在整个录制过程中复用，close 时释放
+    const int outSamples = mixOutSamples(m_pMicAudioSwrContext, inputFrame->nb_samples);
+    if (!ensureConvertedSamples(m_convertedMicSamples, m_convertedMicCapacity, pCodecCtx_amix, outSamples)) {
+        qCCritical(dsrApp) << "Could not allocate converted microphone samples";
+        return AVERROR(ENOMEM);
     }
-    if ((ret = avlibInterface::m_swr_convert(m_pMicAudioSwrContext, m_convertedMicSamples, inputFrame->nb_samples, const_cast<const uint8_t **>(inputFrame->extended_data), inputFrame->nb_samples)) < 0) {
+    if ((ret = avlibInterface::m_swr_convert(m_pMicAudioSwrContext, m_convertedMicSamples, outSamples, const_cast<const uint8_t **>(inputFrame->extended_data), inputFrame->nb_samples)) < 0) {
         printf("Could not convert input samples\n");
-        freeSwrContext(m_pMicAudioSwrContext);
         return ret;
     }
-    freeSwrContext(m_pMicAudioSwrContext);
-    int fifoSpace = audioFifoSpace(m_micAudioFifo);
-    if (fifoSpace < inputFrame->nb_samples) {
-        fifoSpace = avlibInterface::m_av_audio_fifo_size(m_micAudioFifo);
-        if (INT_MAX / 2 - fifoSpace < inputFrame->nb_samples) {
-            qDebug() << "麦克风音频缓存空间不对称!";
-            return AVERROR(EINVAL);
-        }
-        if ((ret = audioFifoRealloc(m_micAudioFifo, audioFifoSize(m_micAudioFifo) + inputFrame->nb_samples)) < 0) {
-            printf("Could not reallocate FIFO\n");
-            return ret;
-        }
-        fifoSpace = audioFifoSpace(m_micAudioFifo);
-    }
-    int checkTime = 0;
-    while (fifoSpace < inputFrame->nb_samples
-            && isWriteFrame()
-            && checkTime <= 1000) {
-        fifoSpace = audioFifoSpace(m_micAudioFifo);
-        usleep(10 * 1000);
-        checkTime ++;
-        //printf("_fifo_spk full  m_fifo!\n");
+    const int samples = ret;
+    if (m_micDrift.sampleRate() != pCodecCtx_amix->sample_rate) {
+        m_micDrift.reset(pCodecCtx_amix->sample_rate);
     }
-
-    if (fifoSpace >= inputFrame->nb_samples) {
+    //声卡时钟与采集时钟存在漂移时，在末尾丢弃或重复一个样本
+    const int correction = m_micDrift.update(lTimeStamp, samples);
+    const int writeSamples = correction < 0 ? samples + correction : samples;
+    const int needSamples = correction > 0 ? samples + correction : writeSamples;
+    if (waitForMixFifoSpace(m_micMixFifo, needSamples)) {
         //write m_convertedMicSamples
-        if (audioWrite(m_micAudioFifo, (void **)m_convertedMicSamples, inputFrame->nb_samples) < inputFrame->nb_samples) {
+        if (m_micMixFifo.write(m_convertedMicSamples, writeSamples) < writeSamples) {
             printf("Could not write data to FIFO\n");
             return AVERROR_EXIT;
         }
-        printf("_fifo_spk write secceffull  m_fifo!\n");
+        if (correction > 0) {
+            uint8_t *lastSample[AV_NUM_DATA_POINTERS] = {nullptr};
+            lastSamplePlanes(m_convertedMicSamples, pCodecCtx_amix, samples, lastSample);
+            for (int i = 0; i < correction; i++) {
+                m_micMixFifo.write(lastSample, 1);
+            }
+        }
+    } else {
+        qCWarning(dsrApp) << "Microphone mix FIFO full, dropped" << samples << "samples";
     }
     return 0;
 }
@@ -1090,15 +1476,12 @@ int CAVOutputStream::write_filter_audio_frame(AVStream *&outst, AVCodecContext *
     output_packet.data = nullptr;
     output_packet.size = 0;
 
-    int enc_got_frame_a = 0;
-
     /**
      * Encode the audio frame and store it in the temporary packet.
      * The output audio stream encoder is used to do this.
      */
-    if ((ret = avlibInterface::m_avcodec_encode_audio2(codecCtx_audio, &output_packet, output_frame, &enc_got_frame_a)) < 0) {
+    if ((ret = avlibInterface::m_avcodec_send_frame(codecCtx_audio, output_frame)) < 0) {
         printf("Could not encode frame\n");
-        avlibInterface::m_av_packet_unref(&output_packet);
         return ret;
     }
 
@@ -1106,7 +1489,7 @@ int CAVOutputStream::write_filter_audio_frame(AVStream *&outst, AVCodecContext *
 
 
     /** Write one audio frame from the temporary packet to the output file. */
-    if (enc_got_frame_a) {
+    while (avlibInterface::m_avcodec_receive_packet(codecCtx_audio, &output_packet) >= 0) {
         //output_packet.flags |= AV_PKT_FLAG_KEY;
         output_packet.stream_index = outst->index;
         printf("output_packet.stream_index2  audio_st =%d\n", output_packet.stream_index);
@@ -1133,7 +1516,7 @@ int CAVOutputStream::write_filter_audio_frame(AVStream *&outst, AVCodecContext *
         }
 
         avlibInterface::m_av_packet_unref(&output_packet);
-    }//if (enc_got_frame_a)
+    }//while receive_packet
 
 
     //     m_nb_samples += output_frame->nb_samples;
@@ -1151,8 +1534,13 @@ int CAVOutputStream::write_filter_audio_frame(AVStream *&outst, AVCodecContext *
 bool CAVOutputStream::isNotAudioFifoEmty()
 {
     bool flag  = false;
-    if ((m_micAudioFifo != nullptr && audioFifoSize(m_micAudioFifo) >= m_pMicCodecContext->frame_size) ||
-            (m_sysAudioFifo != nullptr && audioFifoSize(m_sysAudioFifo) >= m_pSysCodecContext->frame_size)) {
+    //编码器上下文在 close 时释放，缓冲区则保留到析构
+    if ((m_micAudioFifo != nullptr && m_pMicCodecContext != nullptr && audioFifoSize(m_micAudioFifo) >= m_pMicCodecContext->frame_size) ||
+            (m_sysAudioFifo != nullptr && m_pSysCodecContext != nullptr && audioFifoSize(m_sysAudioFifo) >= m_pSysCodecContext->frame_size)) {
+        flag = true;
+    }
+    if ((m_micMixFifo.isInit() && m_micMixFifo.size() >= pCodecCtx_amix->frame_size) ||
+            (m_sysMixFifo.isInit() && m_sysMixFifo.size() >= pCodecCtx_amix->frame_size)) {
         flag = true;
     }
     //qDebug () << "isNotAudioFifoEmty() : " << flag << audioFifoSize(m_sysAudioFifo) << audioFifoSpace(m_sysAudioFifo) << " , " << audioFifoSize(m_micAudioFifo) << audioFifoSpace(m_micAudioFifo);
@@ -1163,122 +1551,82 @@ bool CAVOutputStream::isNotAudioFifoEmty()
 void CAVOutputStream::writeMixAudio()
 {
     qCDebug(dsrApp) << "Starting to write mixed audio";
-    if (is_fifo_scardinit < 2 || nullptr == m_sysAudioFifo || nullptr == m_micAudioFifo) {
+    if (is_fifo_scardinit < 2 || !m_sysMixFifo.isInit() || !m_micMixFifo.isInit() || !m_audioMixer.isInit()) {
         qCDebug(dsrApp) << "Audio FIFOs not initialized, skipping mix";
         return;
     }
-    AVFrame *pFrame_sys = avlibInterface::m_av_frame_alloc();
-    AVFrame *pFrame_mic = avlibInterface::m_av_frame_alloc();
-    int sysFifosize = audioFifoSize(m_sysAudioFifo);
-    int micFifoSize = audioFifoSize(m_micAudioFifo);
-    int minMicFrameSize = m_pMicCodecContext->frame_size;
-    int minSysFrameSize = m_pSysCodecContext->frame_size;
-    if (micFifoSize >= minMicFrameSize && sysFifosize >= minSysFrameSize) {
+    int sysFifosize = m_sysMixFifo.size();
+    int micFifoSize = m_micMixFifo.size();
+    //两路缓冲区都已是混音编码器的格式，每次各取一帧编码器所需的样本数
+    int frameSize = pCodecCtx_amix->frame_size;
+    if (micFifoSize >= frameSize && sysFifosize >= frameSize) {
+        //只统计实际混音编码的耗时，不含等待缓冲区数据的休眠
+        RecordingStats::Scope statsScope(RecordingStats::WriteMixAudio);
         int ret;
         tmpFifoFailed = 0;
-        AVRational time_base_q;
-        // 样本数量 1152
-        pFrame_sys->nb_samples = minSysFrameSize;
-        //通道布局
-        pFrame_sys->channel_layout = m_pSysCodecContext->channel_layout;
-        //样本格式
-        pFrame_sys->format = m_pSysCodecContext->sample_fmt;
-        //采样率
-        pFrame_sys->sample_rate = m_pSysCodecContext->sample_rate;
-        avlibInterface::m_av_frame_get_buffer(pFrame_sys, 0);
-        pFrame_mic->nb_samples = minMicFrameSize;
-        pFrame_mic->channel_layout = m_pMicCodecContext->channel_layout;
-        pFrame_mic->format = m_pMicCodecContext->sample_fmt;
-        pFrame_mic->sample_rate = m_pMicCodecContext->sample_rate;
-        avlibInterface::m_av_frame_get_buffer(pFrame_mic, 0);
-        //从fifo缓存区中将数据读取到pFrame_sys->datap
-        audioRead(m_sysAudioFifo, reinterpret_cast<void **>(pFrame_sys->data), minSysFrameSize);
-        //从fifo缓存区中将数据读取到pFrame_mic->datap
-        audioRead(m_micAudioFifo, reinterpret_cast<void **>(pFrame_mic->data), minMicFrameSize);
-        int nFifoSamples = pFrame_sys->nb_samples;
-        if (m_start_mix_time == -1) {
-            //printf("First Audio timestamp: %ld \n", av_gettime());
-            m_start_mix_time = avlibInterface::m_av_gettime();
-            qCDebug(dsrApp) << "First audio mix timestamp set";
-        }
-        int64_t lTimeStamp = avlibInterface::m_av_gettime() - m_start_mix_time;
-        int64_t timeshift = (int64_t)nFifoSamples * AV_TIME_BASE / (int64_t)(audio_amix_st->codec->sample_rate);
-        if (lTimeStamp - timeshift > m_nLastAudioMixPresentationTime) {
-            m_nLastAudioMixPresentationTime = lTimeStamp - timeshift;
-        }
-        pFrame_sys->pts = avlibInterface::m_av_rescale_q(m_nLastAudioMixPresentationTime, time_base_q, audio_amix_st->time_base);
-        pFrame_mic->pts = pFrame_sys->pts;
-        int64_t timeinc = (int64_t)pCodecCtx_amix->frame_size * AV_TIME_BASE / (int64_t)(audio_amix_st->codec->sample_rate);
-        m_nLastAudioMixPresentationTime += timeinc;
-        ret = avlibInterface::m_av_buffersrc_add_frame_flags(buffersrc_ctx1, pFrame_mic, 0);
-        if (ret < 0) {
-            qCCritical(dsrApp) << "Failed to add microphone frame to buffer source";
-            printf("Mixer: failed to call av_buffersrc_add_frame (speaker)\n");
+        //帧池中的帧已按编码器参数（样本数 frame_size、通道布局、样本格式、采样率）分配好缓冲区
+        AVFrame *pFrame_sys = acquireMixFrame(m_sysMixFrames, pCodecCtx_amix);
+        AVFrame *pFrame_mic = acquireMixFrame(m_micMixFrames, pCodecCtx_amix);
+        if (nullptr == pFrame_sys || nullptr == pFrame_mic) {
+            qCCritical(dsrApp) << "Failed to acquire audio mix frame";
+            return;
+        }
+        //从无锁缓冲区中将数据读取到pFrame_sys->data
+        m_sysMixFifo.read(pFrame_sys->data, frameSize);
+        //从无锁缓冲区中将数据读取到pFrame_mic->data
+        m_micMixFifo.read(pFrame_mic->data, frameSize);
+        //混音结果写回麦克风帧，交错格式一个平面内包含所有声道的样本
+        int values = frameSize;
+        if (!avlibInterface::m_av_sample_fmt_is_planar(pCodecCtx_amix->sample_fmt)) {
+            values *= ChannelLayouts::count(pCodecCtx_amix);
+        }
+        if (!m_audioMixer.mix(pFrame_mic->data, pFrame_sys->data, pFrame_mic->data, values)) {
+            qCCritical(dsrApp) << "Failed to mix audio frame";
             return;
         }
-        ret = avlibInterface::m_av_buffersrc_add_frame_flags(buffersrc_ctx2, pFrame_sys, 0);
+        //两路缓冲区的第一个样本对齐后一起输出，音频流从较早开始采集的一路的采集时间起算
+        int64_t startUs = m_micDrift.startUs();
+        if (startUs < 0 || (m_sysDrift.startUs() >= 0 && m_sysDrift.startUs() < startUs)) {
+            startUs = m_sysDrift.startUs();
+        }
+        //之后的时间戳按样本数递增，声卡与采集时钟的偏差由漂移监测在写入缓冲区时修正
+        const int64_t samplePts = audioStartSamples(startUs, pCodecCtx_amix->sample_rate) + m_mixCount * frameSize;
+        pFrame_mic->pts = samplePts;
+
+        AVPacket packet_out;
+        avlibInterface::m_av_init_packet(&packet_out);
+        packet_out.data = nullptr;
+        packet_out.size = 0;
+        ret = avlibInterface::m_avcodec_send_frame(pCodecCtx_amix, pFrame_mic);
         if (ret < 0) {
-            qCCritical(dsrApp) << "Failed to add system frame to buffer source";
-            printf("Mixer: failed to call av_buffersrc_add_frame (microphone)\n");
+            qCCritical(dsrApp) << "Failed to encode mixed audio frame";
             return;
         }
-        while (isWriteFrame() || isNotAudioFifoEmty()) {
-            //两种音频混合后输出的帧
-            AVFrame *pFrame_out = avlibInterface::m_av_frame_alloc();
-            //AVERROR(EAGAIN) 返回这个表示还没转换完成既 不存在帧，则返回AVERROR（EAGAIN）
-            //从缓冲源中获取一个带有过滤数据的帧并将其放入pFrame_out中
-            ret = avlibInterface::m_av_buffersink_get_frame(buffersink_ctx, pFrame_out);
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-                //printf("%d %d \n", AVERROR(EAGAIN), AVERROR_EOF);
+        while (avlibInterface::m_avcodec_receive_packet(pCodecCtx_amix, &packet_out) >= 0) {
+            packet_out.stream_index = audio_amix_st->index;
+
+            if (m_videoType == Utils::kMKV) {
+                //显示时间戳，应大于或等于解码时间戳
+                packet_out.pts = samplePts * 1000 / pCodecCtx_amix->sample_rate;
+            } else {
+                //显示时间戳，应大于或等于解码时间戳
+                packet_out.pts = samplePts;
             }
+            qDebug() << m_mixCount << " mix audio packet_out.pts: " << packet_out.pts ;
+
+            packet_out.dts = packet_out.pts;
+            packet_out.duration = pCodecCtx_amix->frame_size;
+            packet_out.duration = avlibInterface::m_av_rescale_q_rnd(packet_out.duration,
+                                                                     pCodecCtx_amix->time_base,
+                                                                     audio_amix_st->time_base,
+                                                                     (AVRounding)(AV_ROUND_NEAR_INF | AV_ROUND_PASS_MINMAX));
+
+            m_mixCount++;
+            ret = writeFrame(m_videoFormatContext, &packet_out);
             if (ret < 0) {
-                qCCritical(dsrApp) << "Failed to get frame from buffer sink, ret:" << ret;
-                printf("Mixer: failed to call av_buffersink_get_frame_flags ret : %d \n", ret);
-                break;
+                qCCritical(dsrApp) << "Failed to write mixed audio frame";
             }
-            fflush(stdout);
-            if (pFrame_out->data[0] != nullptr) {
-                AVPacket packet_out;
-                avlibInterface::m_av_init_packet(&packet_out);
-                packet_out.data = nullptr;
-                packet_out.size = 0;
-                int got_packet_ptr;
-                ret = avlibInterface::m_avcodec_encode_audio2(pCodecCtx_amix, &packet_out, pFrame_out, &got_packet_ptr);
-                if (ret < 0) {
-                    qCCritical(dsrApp) << "Failed to encode mixed audio frame";
-                    printf("Mixer: failed to call avcodec_decode_audio4\n");
-                    break;
-                }
-                if (got_packet_ptr) {
-                    packet_out.stream_index = audio_amix_st->index;
-
-                    if (m_videoType == Utils::kMKV) {
-                        //显示时间戳，应大于或等于解码时间戳
-                        packet_out.pts = m_mixCount * pCodecCtx_amix->frame_size * 1000 / pFrame_out->sample_rate;
-                    } else {
-                        //显示时间戳，应大于或等于解码时间戳
-                        packet_out.pts = m_mixCount * pCodecCtx_amix->frame_size;
-                    }
-                    qDebug() << m_mixCount << " mix audio packet_out.pts: " << packet_out.pts ;
-
-                    packet_out.dts = packet_out.pts;
-                    packet_out.duration = pCodecCtx_amix->frame_size;
-                    packet_out.duration = avlibInterface::m_av_rescale_q_rnd(packet_out.duration,
-                                                                             pCodecCtx_amix->time_base,
-                                                                             audio_amix_st->time_base,
-                                                                             (AVRounding)(AV_ROUND_NEAR_INF | AV_ROUND_PASS_MINMAX));
-
-                    m_mixCount++;
-                    ret = writeFrame(m_videoFormatContext, &packet_out);
-                    if (ret < 0) {
-                        qCCritical(dsrApp) << "Failed to write mixed audio frame";
-                        printf("Mixer: failed to call av_interleaved_write_frame\n");
-                    }
-                    printf("-------Mixer: write frame to file got_packet_ptr =%d\n", got_packet_ptr);
-                }
-                avlibInterface::m_av_free_packet(&packet_out);
-            }
-            avlibInterface::m_av_frame_free(&pFrame_out);
+            avlibInterface::m_av_packet_unref(&packet_out);
         }
     } else {
         tmpFifoFailed++;
@@ -1289,12 +1637,10 @@ void CAVOutputStream::writeMixAudio()
             return;
         }
     }
-    avlibInterface::m_av_frame_free(&pFrame_sys);
-    avlibInterface::m_av_frame_free(&pFrame_mic);
     qCDebug(dsrApp) << "Mixed audio processing completed";
 }
 
-int  CAVOutputStream::writeSysAudioFrame(AVStream *stream, AVFrame *inputFrame, int64_t lTimeStamp)
+int  CAVOutputStream::writeSysAudioFrame(AVCodecContext *inputContext, AVFrame *inputFrame, int64_t lTimeStamp)
 {
     if (nullptr == m_sysAudioStream)
         return -1;
@@ -1302,30 +1648,24 @@ int  CAVOutputStream::writeSysAudioFrame(AVStream *stream, AVFrame *inputFrame,
     int ret;
     //因为Fifo里有之前未读完的数据，所以从Fifo队列里面取出的第一个音频包的时间戳等于当前时间减掉缓冲部分的时长
     if (nullptr == m_pSysAudioSwrContext) {
-        // Initialize the resampler to be able to convert audio sample formats
-        m_pSysAudioSwrContext = avlibInterface::m_swr_alloc_set_opts(nullptr,
-                                                                     avlibInterface::m_av_get_default_channel_layout(m_pSysCodecContext->channels),
-                                                                     m_pSysCodecContext->sample_fmt,
-                                                                     m_pSysCodecContext->sample_rate,
-                                                                     avlibInterface::m_av_get_default_channel_layout(stream->codec->channels),
-                                                                     stream->codec->sample_fmt,
-                                                                     stream->codec->sample_rate,
-                                                                     0,
-                                                                     nullptr);
-
         /**
         * Perform a sanity check so that the number of converted samples is
         * not greater than the number of samples to be converted.
         * If the sample rates differ, this case has to be handled differently
         */
-        assert(m_pSysCodecContext->sample_rate == stream->codec->sample_rate);
-        avlibInterface::m_swr_init(m_pSysAudioSwrContext);
+        assert(m_pSysCodecContext->sample_rate == inputContext->sample_rate);
+        // Initialize the resampler to be able to convert audio sample formats
+        m_pSysAudioSwrContext = ChannelLayouts::createResampler(m_pSysCodecContext, inputContext);
+        if (nullptr == m_pSysAudioSwrContext) {
+            qCCritical(dsrApp) << "Could not create system audio resampler";
+            return AVERROR(EINVAL);
+        }
         if (nullptr == m_sysAudioFifo) {
             if (m_videoType == Utils::kMKV) {
-                m_sysAudioFifo = audioFifoAlloc(m_pSysCodecContext->sample_fmt, m_pSysCodecContext->channels,  inputFrame->nb_samples);
+                m_sysAudioFifo = audioFifoAlloc(m_pSysCodecContext->sample_fmt, ChannelLayouts::count(m_pSysCodecContext),  inputFrame->nb_samples);
                 m_initFifoSpace = audioFifoSpace(m_sysAudioFifo);
             } else {
-                m_sysAudioFifo = audioFifoAlloc(m_pSysCodecContext->sample_fmt, m_pSysCodecContext->channels,  40 * inputFrame->nb_samples);
+                m_sysAudioFifo = audioFifoAlloc(m_pSysCodecContext->sample_fmt, ChannelLayouts::count(m_pSysCodecContext),  40 * inputFrame->nb_samples);
             }
             //qDebug() << "init m_sysAudioFifo audioFifoSize: " << audioFifoSize(m_sysAudioFifo);
             //qDebug() << "init m_sysAudioFifo audioFifoSpace: " << audioFifoSpace(m_sysAudioFifo);
@@ -1337,7 +1677,7 @@ int  CAVOutputStream::writeSysAudioFrame(AVStream *stream, AVFrame *inputFrame,
     * block for convenience.为方便起见，在一个连续块中为所有通道的样本分配内存。
     */
 
-    if ((ret = avlibInterface::m_av_samples_alloc(m_convertedSysSamples, nullptr, m_pSysCodecContext->channels, inputFrame->nb_samples, m_pSysCodecContext->sample_fmt, 0)) < 0) {
+    if ((ret = avlibInterface::m_av_samples_alloc(m_convertedSysSamples, nullptr, ChannelLayouts::count(m_pSysCodecContext), inputFrame->nb_samples, m_pSysCodecContext->sample_fmt, 0)) < 0) {
         avlibInterface::m_av_freep(&(*m_convertedSysSamples)[0]);
         free(*m_convertedSysSamples);
         freeSwrContext(m_pSysAudioSwrContext);
@@ -1354,9 +1694,14 @@ int  CAVOutputStream::writeSysAudioFrame(AVStream *stream, AVFrame *inputFrame,
         return ret;
     }
     freeSwrContext(m_pSysAudioSwrContext);
+    if (m_sysDrift.sampleRate() != m_pSysCodecContext->sample_rate) {
+        m_sysDrift.reset(m_pSysCodecContext->sample_rate);
+    }
+    const int correction = m_sysDrift.update(lTimeStamp, inputFrame->nb_samples);
+    lTimeStamp = m_captureClock.streamTimeUs(lTimeStamp);
     AVRational rational = {1, AV_TIME_BASE };
     int audioSize = audioFifoSize(m_sysAudioFifo);
-    int64_t timeshift = (int64_t)audioSize * AV_TIME_BASE / (int64_t)(stream->codec->sample_rate);
+    int64_t timeshift = (int64_t)audioSize * AV_TIME_BASE / (int64_t)(inputContext->sample_rate);
     /** Add the converted input samples to the FIFO buffer for later processing. 将转换后的输入样本添加到FIFO缓冲器中以供后续处理。*/
     /**
     * Make the FIFO as large as it needs to be to hold both,
@@ -1372,22 +1717,29 @@ int  CAVOutputStream::writeSysAudioFrame(AVStream *stream, AVFrame *inputFrame,
             }
         }
         //对比某个时间段缓冲区是否有可用空间，没有直接丢帧处理
-        if (audioFifoSpace(m_sysAudioFifo) < inputFrame->nb_samples) {
+        if (audioFifoSpace(m_sysAudioFifo) < inputFrame->nb_samples + (correction > 0 ? correction : 0)) {
             return 0;
         }
     } else {
-        if ((ret = audioFifoRealloc(m_sysAudioFifo, audioFifoSize(m_sysAudioFifo) + inputFrame->nb_samples)) < 0) {
+        if ((ret = audioFifoRealloc(m_sysAudioFifo, audioFifoSize(m_sysAudioFifo) + inputFrame->nb_samples + 1)) < 0) {
             printf("Could not reallocate FIFO\n");
             return ret;
         }
     }
     /** Store the new samples in the FIFO buffer. 将新样品存储在FIFO缓冲区中。*/
-    if (audioWrite(m_sysAudioFifo, reinterpret_cast<void **>(m_convertedSysSamples), inputFrame->nb_samples) < inputFrame->nb_samples) {
+    //漂移修正：丢弃末尾的样本，或在末尾重复最后一个样本
+    const int writeSamples = correction < 0 ? inputFrame->nb_samples + correction : inputFrame->nb_samples;
+    if (audioWrite(m_sysAudioFifo, reinterpret_cast<void **>(m_convertedSysSamples), writeSamples) < writeSamples) {
         printf("Could not write data to FIFO\n");
         return AVERROR_EXIT;
     }
+    if (correction > 0) {
+        uint8_t *lastSample[AV_NUM_DATA_POINTERS] = {nullptr};
+        lastSamplePlanes(m_convertedSysSamples, m_pSysCodecContext, inputFrame->nb_samples, lastSample);
+        audioWrite(m_sysAudioFifo, reinterpret_cast<void **>(lastSample), correction);
+    }
 
-    int64_t timeinc = static_cast<int64_t>(m_pSysCodecContext->frame_size * AV_TIME_BASE / stream->codec->sample_rate);
+    int64_t timeinc = static_cast<int64_t>(m_pSysCodecContext->frame_size * AV_TIME_BASE / inputContext->sample_rate);
     //当前帧的时间戳不能小于上一帧的值
     if (lTimeStamp - timeshift > m_nLastAudioCardPresentationTime) {
         m_nLastAudioCardPresentationTime = lTimeStamp - timeshift;
@@ -1417,7 +1769,7 @@ int  CAVOutputStream::writeSysAudioFrame(AVStream *stream, AVFrame *inputFrame,
             * are assumed for simplicity.
             */
         output_frame->nb_samples = frame_size;
-        output_frame->channel_layout = m_pSysCodecContext->channel_layout;
+        ChannelLayouts::copyToFrame(output_frame, m_pSysCodecContext);
         output_frame->format = m_pSysCodecContext->sample_fmt;
         output_frame->sample_rate = m_pSysCodecContext->sample_rate;
         output_frame->pts = avlibInterface::m_av_rescale_q(m_nLastAudioCardPresentationTime, rational, m_sysAudioStream->time_base);
@@ -1445,26 +1797,28 @@ int  CAVOutputStream::writeSysAudioFrame(AVStream *stream, AVFrame *inputFrame,
         avlibInterface::m_av_init_packet(&outputPacket);
         outputPacket.data = nullptr;
         outputPacket.size = 0;
-        int enc_got_frame_a = 0;
         /**
                 * Encode the audio frame and store it in the temporary packet.
                 * The output audio stream encoder is used to do this.
                 */
-        if ((ret = avlibInterface::m_avcodec_encode_audio2(m_pSysCodecContext, &outputPacket, output_frame, &enc_got_frame_a)) < 0) {
+        if ((ret = avlibInterface::m_avcodec_send_frame(m_pSysCodecContext, output_frame)) < 0) {
             printf("Could not encode frame\n");
-            avlibInterface::m_av_packet_unref(&outputPacket);
+            avlibInterface::m_av_frame_free(&output_frame);
             return ret;
         }
         /** Write one audio frame from the temporary packet to the output file. */
-        if (enc_got_frame_a) {
+        //编码器有延迟时一帧可能没有输出，取出当前可输出的全部包
+        while (avlibInterface::m_avcodec_receive_packet(m_pSysCodecContext, &outputPacket) >= 0) {
             outputPacket.stream_index = m_sysAudioStream->index;
             //            outputPacket.pts = m_singleCount * m_pSysCodecContext->frame_size * 1000 / m_pSysCodecContext->sample_rate;
+            const int64_t samplePts = audioStartSamples(m_sysDrift.startUs(), m_pSysCodecContext->sample_rate)
+                                      + m_singleCount * m_pSysCodecContext->frame_size;
             if (m_videoType == Utils::kMKV) {
                 //显示时间戳，应大于或等于解码时间戳
-                outputPacket.pts = m_singleCount * m_pSysCodecContext->frame_size * 1000 / m_pSysCodecContext->sample_rate;
+                outputPacket.pts = samplePts * 1000 / m_pSysCodecContext->sample_rate;
             } else {
                 //显示时间戳，应大于或等于解码时间戳
-                outputPacket.pts = m_singleCount * m_pSysCodecContext->frame_size;
+                outputPacket.pts = samplePts;
                 outputPacket.dts = outputPacket.pts;
             }
             outputPacket.duration = m_pSysCodecContext->frame_size;
@@ -1477,7 +1831,7 @@ int  CAVOutputStream::writeSysAudioFrame(AVStream *stream, AVFrame *inputFrame,
                 return ret;
             }
             avlibInterface::m_av_packet_unref(&outputPacket);
-        }//if (enc_got_frame_a)
+        }//while receive_packet
         m_nb_samples += output_frame->nb_samples;
         m_nLastAudioCardPresentationTime += timeinc;
         avlibInterface::m_av_frame_free(&output_frame);
@@ -1485,35 +1839,31 @@ int  CAVOutputStream::writeSysAudioFrame(AVStream *stream, AVFrame *inputFrame,
     return 0;
 }
 
-int CAVOutputStream::writeSysToMixAudioFrame(AVStream *stream, AVFrame *inputFrame, int64_t lTimeStamp)
+int CAVOutputStream::writeSysToMixAudioFrame(AVCodecContext *inputContext, AVFrame *inputFrame, int64_t lTimeStamp)
 {
-    Q_UNUSED(lTimeStamp)
     int ret;
     if (nullptr == m_pSysAudioSwrContext) {
-        m_pSysAudioSwrContext = avlibInterface::m_swr_alloc_set_opts(nullptr,
-                                                                     avlibInterface::m_av_get_default_channel_layout(m_pSysCodecContext->channels),
-                                                                     m_pSysCodecContext->sample_fmt,
-                                                                     m_pSysCodecContext->sample_rate,
-                                                                     avlibInterface::m_av_get_default_channel_layout(stream->codec->channels),
-                                                                     stream->codec->sample_fmt,
-                                                                     stream->codec->sample_rate,
-                                                                     0,
-                                                                     nullptr);
-        assert(m_pSysCodecContext->sample_rate == stream->codec->sample_rate);
-        avlibInterface::m_swr_init(m_pSysAudioSwrContext);
-        if (nullptr == m_sysAudioFifo) {
+        //系统音频的采样率、声道数可能与麦克风不同，同样重采样为混音编码器的格式
+        m_pSysAudioSwrContext = ChannelLayouts::createResampler(pCodecCtx_amix, inputContext);
+        if (nullptr == m_pSysAudioSwrContext) {
+            qCCritical(dsrApp) << "Could not create system audio resampler";
+            return AVERROR(EINVAL);
+        }
+        m_audioMixAllocCount++;
+        if (!m_sysMixFifo.isInit()) {
             //根据采样格式，通道数，样本个数 划分系统音频fifo缓存空间的大小
-            m_sysAudioFifo = audioFifoAlloc(m_pSysCodecContext->sample_fmt, m_pSysCodecContext->channels, 20 * inputFrame->nb_samples);
+            if (!initMixFifo(m_sysMixFifo, pCodecCtx_amix, 20 * inputFrame->nb_samples)) {
+                return AVERROR(EINVAL);
+            }
         }
         is_fifo_scardinit ++;
     }
 
-    //为nb_samples样本分配一个样本缓冲区，并相应地填充数据指针和行大小。已分配的样本缓冲区可以通过使用av_freep(&audio_data[0])来释放。已分配的数据将被初始化为静默。
-    if ((ret = avlibInterface::m_av_samples_alloc(m_convertedSysSamples, nullptr, m_pSysCodecContext->channels, inputFrame->nb_samples, m_pSysCodecContext->sample_fmt, 0)) < 0) {
-        avlibInterface::m_av_freep(&(*m_convertedSysSamples)[0]);
-        free(*m_convertedSysSamples);
-        freeSwrContext(m_pSysAudioSwrContext);
-        return ret;
+    //输出缓冲区只在第一次或输入样本数变大时申请，之后复用
+    const int outSamples = mixOutSamples(m_pSysAudioSwrContext, inputFrame->nb_samples);
+    if (!ensureConvertedSamples(m_convertedSysSamples, m_convertedSysCapacity, pCodecCtx_amix, outSamples)) {
+        qCCritical(dsrApp) << "Could not allocate converted system audio samples";
+        return AVERROR(ENOMEM);
     }
     /*
      * 转换音频。
@@ -1521,42 +1871,31 @@ int CAVOutputStream::writeSysToMixAudioFrame(AVStream *stream, AVFrame *inputFra
      * 如果提供的输入大于输出空间，则输入将被缓冲。
      * 可以通过使用swr_get_out_samples()检索给定输入样本数量所需输出样本数量的上限来避免这种缓冲。只要有可能，转换将直接运行而不进行复制。
      */
-    if ((ret = avlibInterface::m_swr_convert(m_pSysAudioSwrContext, m_convertedSysSamples, inputFrame->nb_samples, const_cast<const uint8_t **>(inputFrame->extended_data), inputFrame->nb_samples)) < 0) {
-        freeSwrContext(m_pSysAudioSwrContext);
+    if ((ret = avlibInterface::m_swr_convert(m_pSysAudioSwrContext, m_convertedSysSamples, outSamples, const_cast<const uint8_t **>(inputFrame->extended_data), inputFrame->nb_samples)) < 0) {
         return ret;
     }
-
-    freeSwrContext(m_pSysAudioSwrContext);
-
-    int fifoSpace = audioFifoSpace(m_sysAudioFifo);
-    if (fifoSpace < inputFrame->nb_samples) {
-        fifoSpace = avlibInterface::m_av_audio_fifo_size(m_sysAudioFifo);
-        if (INT_MAX / 2 - fifoSpace < inputFrame->nb_samples) {
-            qDebug() << "系统音频缓存空间不对称!";
-            return AVERROR(EINVAL);
-        }
-        if ((ret = audioFifoRealloc(m_sysAudioFifo, audioFifoSize(m_sysAudioFifo) + inputFrame->nb_samples)) < 0) {
-            return ret;
-        }
-        fifoSpace = audioFifoSpace(m_sysAudioFifo);
-    }
-    int checkTime = 0;
-    while (fifoSpace < inputFrame->nb_samples
-            && isWriteFrame()
-            && checkTime < 1000) {
-        fifoSpace = audioFifoSpace(m_sysAudioFifo);
-        //Sleep usseconds微秒，或者直到信号到达没有被阻塞或忽略。
-        usleep(10 * 1000);
-        checkTime ++;
-        //printf("_fifo_spk full m_fifo_scard!\n");
+    const int samples = ret;
+    if (m_sysDrift.sampleRate() != pCodecCtx_amix->sample_rate) {
+        m_sysDrift.reset(pCodecCtx_amix->sample_rate);
     }
-
-    if (fifoSpace >= inputFrame->nb_samples) {
-        //数据写入到m_sysAudioFifo,如果可用的空间小于传入的inputFrame->nb_samples，m_sysAudioFifo会自动重新分配空间，但此处做了限制的只有大于等于的情况才进来
-        if (audioWrite(m_sysAudioFifo, reinterpret_cast<void **>(m_convertedSysSamples), inputFrame->nb_samples) < inputFrame->nb_samples) {
+    const int correction = m_sysDrift.update(lTimeStamp, samples);
+    const int writeSamples = correction < 0 ? samples + correction : samples;
+    const int needSamples = correction > 0 ? samples + correction : writeSamples;
+    if (waitForMixFifoSpace(m_sysMixFifo, needSamples)) {
+        //缓冲区容量固定不扩容，只有空间足够时才写入
+        if (m_sysMixFifo.write(m_convertedSysSamples, writeSamples) < writeSamples) {
             printf("Could not write data to FIFO\n");
             return AVERROR_EXIT;
         }
+        if (correction > 0) {
+            uint8_t *lastSample[AV_NUM_DATA_POINTERS] = {nullptr};
+            lastSamplePlanes(m_convertedSysSamples, pCodecCtx_amix, samples, lastSample);
+            for (int i = 0; i < correction; i++) {
+                m_sysMixFifo.write(lastSample, 1);
+            }
+        }
+    } else {
+        qCWarning(dsrApp) << "System audio mix FIFO full, dropped" << samples << "samples";
     }
     return 0;
 }
@@ -1564,7 +1903,12 @@ int CAVOutputStream::writeSysToMixAudioFrame(AVStream *stream, AVFrame *inputFra
 void CAVOutputStream::close()
 {
     qCInfo(dsrApp) << "Closing output stream";
-    QThread::msleep(500);
+    const int64_t closeBeginUs = CaptureClock::nowUs();
+    //写文件尾之前排空视频流水线，未启用流水线时在本线程冲刷编码器
+    stopVideoPipeline();
+    flushVideoEncoder();
+    qCInfo(dsrApp) << "Audio drift:" << audioDriftReport();
+    m_captureClock.reset();
     if (nullptr != m_videoFormatContext
             || nullptr != m_videoStream
             || nullptr != m_micAudioStream
@@ -1576,31 +1920,26 @@ void CAVOutputStream::close()
         qDebug() << __LINE__ << __func__ << "写文件尾完成";
     }
 
-    if (m_videoStream) {
-        qCDebug(dsrApp) << "Closing video stream";
-        avlibInterface::m_avcodec_close(m_videoStream->codec);
-        m_videoStream = nullptr;
-    }
-    if (m_micAudioStream) {
-        qCDebug(dsrApp) << "Closing microphone audio stream";
-        avlibInterface::m_avcodec_close(m_micAudioStream->codec);
-        m_micAudioStream = nullptr;
-    }
-    //    if (audio_scard_st)
-    //    {
-    //        avcodec_close(audio_scard_st->codec);
-    //        audio_scard_st = nullptr;
-    //    }
-    if (audio_amix_st) {
-        qCDebug(dsrApp) << "Closing audio mix stream";
-        avlibInterface::m_avcodec_close(audio_amix_st->codec);
-        audio_amix_st = nullptr;
-    }
+    //流归 m_videoFormatContext 所有，编码器上下文由本类申请，在这里释放
+    m_videoStream = nullptr;
+    m_micAudioStream = nullptr;
+    m_sysAudioStream = nullptr;
+    audio_amix_st = nullptr;
+    qCDebug(dsrApp) << "Freeing encoder contexts";
+    avlibInterface::m_avcodec_free_context(&pCodecCtx);
+    avlibInterface::m_avcodec_free_context(&m_pMicCodecContext);
+    avlibInterface::m_avcodec_free_context(&m_pSysCodecContext);
+    avlibInterface::m_avcodec_free_context(&pCodecCtx_amix);
 
     if (m_out_buffer) {
         avlibInterface::m_av_free(m_out_buffer);
         m_out_buffer = nullptr;
     }
+    //m_rgbFrame 不持有像素内存，释放时不会影响环形缓冲区
+    m_rgbFrames.clear([](AVFrame *&frame) {
+        avlibInterface::m_av_frame_free(&frame);
+    });
+    m_rgbFrame = nullptr;
     if (m_convertedMicSamples) {
         avlibInterface::m_av_freep(&m_convertedMicSamples[0]);
         m_convertedMicSamples = nullptr;
@@ -1609,6 +1948,7 @@ void CAVOutputStream::close()
         avlibInterface::m_av_freep(&m_convertedSysSamples[0]);
         m_convertedSysSamples = nullptr;
     }
+    releaseAudioMixBuffers();
     is_fifo_scardinit = 0;
     if (m_videoFormatContext) {
         avlibInterface::m_avio_close(m_videoFormatContext->pb);
@@ -1621,9 +1961,8 @@ void CAVOutputStream::close()
     if (m_bMix) {
         avlibInterface::m_av_frame_free(&mMic_frame);
         avlibInterface::m_av_frame_free(&mSpeaker_frame);
-        avlibInterface::m_avfilter_graph_free(&filter_graph);
     }
-    qCInfo(dsrApp) << "Output stream closed successfully";
+    qCInfo(dsrApp) << "Output stream closed successfully in" << (CaptureClock::nowUs() - closeBeginUs) / 1000 << "ms";
 }
 
 void CAVOutputStream::setIsOverWrite(bool isCOntinue)
@@ -1735,7 +2074,7 @@ void CAVOutputStream::setBoardVendor(int boardVendorType)
 }
 
 //释放swrContext
-void CAVOutputStream::freeSwrContext(SwrContext *swrContext)
+void CAVOutputStream::freeSwrContext(SwrContext *&swrContext)
 {
     if (swrContext != nullptr) {
         qCDebug(dsrApp) << "Freeing SwrContext";
@@ -1744,3 +2083,122 @@ void CAVOutputStream::freeSwrContext(SwrContext *swrContext)
     }
 }
 
+bool CAVOutputStream::initMixFifo(AudioSampleFifo &fifo, AVCodecContext *codecContext, int samples)
+{
+    const int bytesPerSample = avlibInterface::m_av_get_bytes_per_sample(codecContext->sample_fmt);
+    //平面格式每个声道一个平面，交错格式所有声道在同一个平面
+    if (avlibInterface::m_av_sample_fmt_is_planar(codecContext->sample_fmt)) {
+        return fifo.init(ChannelLayouts::count(codecContext), bytesPerSample, samples);
+    }
+    return fifo.init(1, bytesPerSample * ChannelLayouts::count(codecContext), samples);
+}
+
+bool CAVOutputStream::waitForMixFifoSpace(AudioSampleFifo &fifo, int samples)
+{
+    //混音线程读出样本后立即唤醒；分段等待以便停止录制时及时退出，最多等待 10 秒
+    QElapsedTimer timer;
+    timer.start();
+    while (!fifo.waitForSpace(samples, MixFifoWaitSliceMs)) {
+        if (!isWriteFrame() || timer.elapsed() >= MixFifoWaitTimeoutMs) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CAVOutputStream::ensureConvertedSamples(uint8_t **&samples, int &capacity, AVCodecContext *codecContext, int nbSamples)
+{
+    if (nullptr == samples) {
+        samples = static_cast<uint8_t **>(calloc(static_cast<size_t>(ChannelLayouts::count(codecContext)), sizeof(*samples)));
+        if (nullptr == samples) {
+            return false;
+        }
+        capacity = 0;
+        m_audioMixAllocCount++;
+    }
+    return growCapacity(capacity, nbSamples, [&](int needed) {
+        if (capacity > 0) {
+            avlibInterface::m_av_freep(&samples[0]);
+        }
+        if (avlibInterface::m_av_samples_alloc(samples, nullptr, ChannelLayouts::count(codecContext), needed, codecContext->sample_fmt, 0) < 0) {
+            return false;
+        }
+        m_audioMixAllocCount++;
+        return true;
+    });
+}
+
+int CAVOutputStream::mixOutSamples(SwrContext *swrContext, int inSamples)
+{
+    //采样率不同时输出样本数会多于输入，再加上重采样器内部缓存的样本
+    const int outSamples = avlibInterface::m_swr_get_out_samples(swrContext, inSamples);
+    return outSamples > inSamples ? outSamples : inSamples;
+}
+
+AVFrame *CAVOutputStream::acquireMixFrame(ReusePool<AVFrame *> &pool, AVCodecContext *codecContext)
+{
+    AVFrame *frame = nullptr;
+    const bool acquired = pool.acquire(frame, [](AVFrame *pooled) {
+        return avlibInterface::m_av_frame_is_writable(pooled) != 0;
+    }, [codecContext](AVFrame *&created) {
+        created = avlibInterface::m_av_frame_alloc();
+        if (nullptr == created) {
+            return false;
+        }
+        created->nb_samples = codecContext->frame_size;
+        created->format = codecContext->sample_fmt;
+        created->sample_rate = codecContext->sample_rate;
+        if (!ChannelLayouts::copyToFrame(created, codecContext) || avlibInterface::m_av_frame_get_buffer(created, 0) < 0) {
+            avlibInterface::m_av_frame_free(&created);
+            return false;
+        }
+        return true;
+    }, [](AVFrame *&pooled) {
+        //编码器积压的帧超过帧池大小，复制出新的缓冲区
+        qCWarning(dsrApp) << "Audio mix frame pool exhausted, copying frame buffer";
+        return avlibInterface::m_av_frame_make_writable(pooled) >= 0;
+    });
+    return acquired ? frame : nullptr;
+}
+
+void CAVOutputStream::releaseAudioMixBuffers()
+{
+    const auto freeFrame = [](AVFrame *&frame) {
+        avlibInterface::m_av_frame_free(&frame);
+    };
+    m_micMixFrames.clear(freeFrame);
+    m_sysMixFrames.clear(freeFrame);
+    m_micMixFifo.release();
+    m_sysMixFifo.release();
+    m_audioMixer.release();
+    freeSwrContext(m_pMicAudioSwrContext);
+    freeSwrContext(m_pSysAudioSwrContext);
+    m_convertedMicCapacity = 0;
+    m_convertedSysCapacity = 0;
+}
+
+void CAVOutputStream::lastSamplePlanes(uint8_t **samples, AVCodecContext *codecContext, int nbSamples, uint8_t **planes)
+{
+    const int bytesPerSample = avlibInterface::m_av_get_bytes_per_sample(codecContext->sample_fmt);
+    //平面格式每个声道取一个地址，交错格式一个样本包含所有声道
+    if (avlibInterface::m_av_sample_fmt_is_planar(codecContext->sample_fmt)) {
+        const int channels = FFMIN(ChannelLayouts::count(codecContext), AV_NUM_DATA_POINTERS);
+        for (int i = 0; i < channels; i++) {
+            planes[i] = samples[i] + (nbSamples - 1) * bytesPerSample;
+        }
+    } else {
+        planes[0] = samples[0] + (nbSamples - 1) * bytesPerSample * ChannelLayouts::count(codecContext);
+    }
+}
+
+int64_t CAVOutputStream::audioStartSamples(int64_t startUs, int sampleRate)
+{
+    if (m_audioStartSamples < 0) {
+        //第一个音频包写出后起点不能再变，采集时间未知时从 0 开始
+        const int64_t startTime = startUs >= 0 ? m_captureClock.streamTimeUs(startUs) : 0;
+        m_audioStartSamples = sampleRate > 0 ? startTime * sampleRate / AV_TIME_BASE : 0;
+        qCInfo(dsrApp) << "Audio stream starts" << startTime / 1000 << "ms after capture origin";
+    }
+    return m_audioStartSamples;
+}
+
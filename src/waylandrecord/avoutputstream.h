@@ -6,17 +6,35 @@
 #define AVOUTPUTSTREAM_H
 
 #include <string>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <assert.h>
 #include <QMutex>
+#include <QList>
+#include <QStringList>
 #include "avlibinterface.h"
-#include "waylandintegration_p.h"
+#include "slicepool.h"
+#include "stagequeue.h"
+#include "audiosamplefifo.h"
+#include "audiomixer.h"
+#include "reusepool.h"
+#include "fragmentoptions.h"
+#include "captureclock.h"
+#include "audiodriftmonitor.h"
+#include "framepacer.h"
+#include "waylandframe.h"
 
 using namespace std;
 
+class ConfigSettings;
+
 class CAVOutputStream
 {
 public:
-    explicit CAVOutputStream(WaylandIntegration::WaylandIntegrationPrivate *context);
+    CAVOutputStream();
     ~CAVOutputStream(void);
 
     //初始化视频编码器
@@ -42,13 +60,25 @@ public:
      * @param frame:rgb帧
      * @return
      */
-    int writeVideoFrame(WaylandIntegration::WaylandIntegrationPrivate::waylandFrame &frame);
-    int writeMicAudioFrame(AVStream *stream, AVFrame *inputFrame, int64_t lTimeStamp);
-    int writeMicToMixAudioFrame(AVStream *stream, AVFrame *inputFrame, int64_t lTimeStamp);
-    int writeSysAudioFrame(AVStream *stream, AVFrame *inputFrame, int64_t lTimeStamp);
-    int writeSysToMixAudioFrame(AVStream *stream, AVFrame *inputFrame, int64_t lTimeStamp);
+    int writeVideoFrame(WaylandFrame &frame);
+    /**
+     * @brief 写入一帧解码后的音频
+     * @param inputContext:解码该帧的解码器上下文，提供输入的采样格式、采样率和声道数
+     */
+    int writeMicAudioFrame(AVCodecContext *inputContext, AVFrame *inputFrame, int64_t lTimeStamp);
+    int writeMicToMixAudioFrame(AVCodecContext *inputContext, AVFrame *inputFrame, int64_t lTimeStamp);
+    int writeSysAudioFrame(AVCodecContext *inputContext, AVFrame *inputFrame, int64_t lTimeStamp);
+    int writeSysToMixAudioFrame(AVCodecContext *inputContext, AVFrame *inputFrame, int64_t lTimeStamp);
     int write_filter_audio_frame(AVStream *&outst, AVCodecContext *&codecCtx_audio, AVFrame *&outframe);
-    int init_filters();
+    /**
+     * @brief 按混音编码器的采样格式初始化混音器，两路音频都重采样为该格式后相加
+     * @return 采样格式不支持时返回 false
+     */
+    bool initAudioMixer();
+    /**
+     * @brief 设置麦克风和系统音频的混音增益，默认各 0.5，与 amix 两路输入的电平一致
+     */
+    void setAudioMixGains(float micGain, float sysGain);
     int init_context_amix(int channel, uint64_t channel_layout, int sample_rate, int64_t bit_rate);
     void writeMixAudio();
     void setIsOverWrite(bool isCOntinue);
@@ -103,8 +133,178 @@ public:
      * @return
      */
     bool isNotAudioFifoEmty();
+    /**
+     * @brief 写视频帧路径上申请 AVFrame/AVPacket 及帧缓冲区的次数（open 时清零），稳态下每帧不应再增加
+     * 编码器仍引用流水线中全部帧时为帧重新申请的缓冲区也计入
+     * @return
+     */
+    uint64_t videoFrameAllocCount() const;
+    /**
+     * @brief 混音路径上申请帧、样本缓冲区和重采样上下文的次数（open 时清零）
+     * 帧池和缓冲区在前几帧内建立，之后稳态混音不应再增加
+     * @return
+     */
+    uint64_t audioMixAllocCount() const;
+
+    /**
+     * @brief 视频流水线的三级：转换（WriteFrameThread 线程）、编码、封装（各自独立线程）
+     */
+    enum VideoStage {
+        ConvertStage = 0,
+        EncodeStage,
+        MuxStage,
+        VideoStageCount
+    };
+    /**
+     * @brief 某一级的处理数量、等待/处理耗时和输入队列深度
+     */
+    const StageStats &videoStageStats(VideoStage stage) const;
+    /**
+     * @brief 各级计数的单行汇总，用于日志
+     */
+    QString videoPipelineReport() const;
+
+    /**
+     * @brief 音视频共用的采集时钟，RecordAdmin 在开始录制时启动
+     */
+    CaptureClock &captureClock();
+    /**
+     * @brief 麦克风/系统音频的漂移监测
+     */
+    const AudioDriftMonitor &micDriftMonitor() const;
+    const AudioDriftMonitor &sysDriftMonitor() const;
+    /**
+     * @brief 两路音频漂移修正的单行汇总，用于日志
+     */
+    QString audioDriftReport() const;
+
+    /**
+     * @brief H264 编码参数，由录屏设置（recorder 分组）传入
+     */
+    struct VideoEncoderOptions {
+        QString preset = "ultrafast";   //ultrafast ~ veryslow
+        QString tune;                   //zerolatency/animation/stillimage，为空不设置
+        int crf = -1;                   //0~51，小于 0 不设置
+        int threads = 0;                //编码线程数，0 由编码器按 CPU 核数决定
+        bool sliceThreads = false;      //true 条带线程（延迟低），false 帧线程（吞吐高）
+    };
+    /**
+     * @brief 设置编码参数，在 open 之前调用；无效的取值回退到默认值
+     */
+    void setVideoEncoderOptions(const VideoEncoderOptions &options);
+    /**
+     * @brief 读取录屏设置 recorder 分组中的编码参数（encoder_preset 等），取值的校验由 setVideoEncoderOptions 完成
+     */
+    static VideoEncoderOptions videoEncoderOptionsFromSettings(ConfigSettings *settings);
+    const VideoEncoderOptions &videoEncoderOptions() const;
+    static QStringList videoEncoderPresets();
+    static QStringList videoEncoderTunes();
+
+    /**
+     * @brief 设置分段写入的间隔（秒），在 open 之前调用；0 表示只在结束时写文件索引
+     * MP4 输出为 fragmented MP4，MKV 按间隔切分 cluster。每段写完立即写入文件，
+     * 进程中途退出时已写入的分段仍可播放；停止录制时只需写最后一段，耗时与录制时长无关
+     */
+    void setFragmentDuration(int seconds);
+    int fragmentDuration() const;
+    /**
+     * @brief 按输出格式生成 avformat_write_header 的分段参数
+     */
+    static void applyFragmentOptions(AVDictionary **options, int videoType, int fragmentSeconds);
+    static constexpr int DefaultFragmentSeconds = FragmentOptions::DefaultSeconds;
+    static constexpr int MaxFragmentSeconds = FragmentOptions::MaxSeconds;
+
+    struct EncoderBenchmarkResult {
+        QString preset;
+        int frames;
+        double fps;
+        //测试画面被编码器引用时 av_frame_make_writable 重新申请缓冲区的次数
+        uint64_t bufferAllocs;
+    };
+    /**
+     * @brief 在本机上用合成画面依次测试各 preset 的编码帧率
+     * @param options 除 preset 外的编码参数
+     * @return 每个 preset 一项，编码器打开失败时 fps 为 0
+     */
+    static QList<EncoderBenchmarkResult> benchmarkVideoEncoder(int width, int height, int frames,
+                                                               const VideoEncoderOptions &options,
+                                                               const QStringList &presets = videoEncoderPresets());
 protected:
-    void freeSwrContext(struct SwrContext *swrContext);
+    /**
+     * @brief 将裁剪后的 RGB 帧转换为 yuvFrame 中的 YUV420P
+     * 尺寸不变时按条带并行，使用 I420Converter；需要缩放时（VIDEO_RESCALE）整帧使用 SWS_BICUBIC
+     */
+    void convertVideoFrame(AVFrame *rgbFrame, AVFrame *yuvFrame);
+    /**
+     * @brief 按当前裁剪区域设置引用环形缓冲区槽位的 RGB 帧
+     * @return 裁剪失败返回 false
+     */
+    bool prepareRgbFrame(WaylandFrame &frame);
+    /**
+     * @brief 把编码参数写入编码器上下文和 avcodec_open2 的选项
+     */
+    static void applyVideoEncoderOptions(AVCodecContext *codecCtx, AVDictionary **param, const VideoEncoderOptions &options);
+    /**
+     * @brief 送一帧给编码器并记下它的采集时间；yuvFrame 为空时进入冲刷
+     * @return avcodec_send_frame 的返回值
+     */
+    int sendVideoFrame(AVFrame *yuvFrame, int64_t time);
+    /**
+     * @brief 取一个编码好的包，时间戳由该帧的采集时间换算
+     * @return 1 取到一个包，0 编码器暂无输出或已冲刷完，小于 0 为错误
+     */
+    int receiveVideoPacket(AVPacket *packet);
+    /**
+     * @brief 未启用流水线时，close 前在本线程冲刷编码器并写出剩余的包
+     */
+    void flushVideoEncoder();
+    /**
+     * @brief open 成功后启动编码、封装线程；close 时排空队列并停止
+     */
+    bool startVideoPipeline();
+    void stopVideoPipeline();
+    void encodeLoop();
+    /**
+     * @brief 编码器已释放引用的帧交还给转换级
+     * 编码器持有流水线中的全部帧时，最早的帧改用新申请的缓冲区，旧缓冲区留给编码器
+     */
+    void recycleVideoFrames(std::deque<AVFrame *> &heldFrames);
+    /**
+     * @brief 取出编码器当前可输出的全部包，交给封装级
+     */
+    void forwardVideoPackets();
+    void muxLoop();
+    void freeSwrContext(struct SwrContext *&swrContext);
+    /**
+     * @brief 按编码器的采样格式初始化混音用的无锁缓冲区
+     */
+    bool initMixFifo(AudioSampleFifo &fifo, AVCodecContext *codecContext, int samples);
+    /**
+     * @brief 等待混音缓冲区能写入 samples 个样本，停止录制或超时返回 false
+     */
+    bool waitForMixFifoSpace(AudioSampleFifo &fifo, int samples);
+    /**
+     * @brief 保证重采样输出缓冲区至少能容纳 nbSamples 个样本，只在容量不足时重新申请
+     */
+    bool ensureConvertedSamples(uint8_t **&samples, int &capacity, AVCodecContext *codecContext, int nbSamples);
+    /**
+     * @brief 重采样 inSamples 个输入样本最多能输出的样本数，不小于 inSamples
+     */
+    int mixOutSamples(struct SwrContext *swrContext, int inSamples);
+    /**
+     * @brief 从帧池中取一个可写的帧，帧的样本数为编码器的 frame_size
+     * 帧被编码器引用时不可写，池中没有空闲帧才新申请，池满后退化为 av_frame_make_writable
+     */
+    AVFrame *acquireMixFrame(ReusePool<AVFrame *> &pool, AVCodecContext *codecContext);
+    void releaseAudioMixBuffers();
+    /**
+     * @brief 取 nbSamples 个样本中最后一个样本在各平面的地址，用于漂移修正时重复写入
+     */
+    void lastSamplePlanes(uint8_t **samples, AVCodecContext *codecContext, int nbSamples, uint8_t **planes);
+    /**
+     * @brief 音频流第一个样本相对录制起点的样本数，第一次能确定时计算并缓存
+     */
+    int64_t audioStartSamples(int64_t startUs, int sampleRate);
 public:
     //截图区域
     int m_left;
@@ -125,7 +325,6 @@ private:
     QMutex m_writeFrameMutex;
     bool m_isWriteFrame;
     QMutex m_isWriteFrameMutex;
-    WaylandIntegration::WaylandIntegrationPrivate *m_context;
     AVStream *m_videoStream;
     /**
      * @brief 麦克风音频流
@@ -160,21 +359,82 @@ private:
     /**
      * @brief 视频编码器
      */
-    AVCodec *pCodec;  //videos
+    const AVCodec *pCodec;  //videos
     /**
      * @brief 麦克风音频编码器
      */
-    AVCodec *pCodec_a;  //audio
+    const AVCodec *pCodec_a;  //audio
     /**
      * @brief 系统音频编码器
      */
-    AVCodec *pCodec_aCard;
+    const AVCodec *pCodec_aCard;
     /**
      * @brief 混合音频编码器
      */
-    AVCodec *pCodec_amix;
+    const AVCodec *pCodec_amix;
     AVFrame *pFrameYUV;   ///转换为YUV420P保存的图像
+    /**
+     * @brief 引用环形缓冲区槽位的RGB帧，只在第一帧时分配，不持有像素内存
+     */
+    AVFrame *m_rgbFrame;
+    /**
+     * @brief 视频编码输出复用的包
+     */
+    AVPacket m_videoPacket;
+    /**
+     * @brief m_rgbFrame 的池，只有一个包装帧且总是可复用，allocCount 即写视频帧路径上的分配计数
+     */
+    ReusePool<AVFrame *> m_rgbFrames;
+    /**
+     * @brief recycleVideoFrames 为仍被编码器引用的流水线帧重新申请缓冲区的次数
+     */
+    std::atomic<uint64_t> m_videoBufferAllocCount;
     struct SwsContext *m_pVideoSwsContext;
+    /**
+     * @brief 条带转换线程池，第一次转换时创建
+     */
+    SlicePool *m_slicePool;
+
+    /**
+     * @brief 转换后等待编码的帧，time 为采集时间，queuedNs 为入队时刻
+     */
+    struct VideoJob {
+        AVFrame *frame;
+        int64_t time;
+        int64_t queuedNs;
+    };
+    /**
+     * @brief 编码后等待写文件的包
+     */
+    struct PacketJob {
+        AVPacket *packet;
+        int64_t queuedNs;
+    };
+    /**
+     * @brief 流水线中同时存在的帧数和包数，决定了各级之间可以错开的帧数
+     */
+    static const int VideoPipelineDepth = 3;
+    std::vector<AVFrame *> m_pipelineFrames;
+    std::vector<AVPacket> m_pipelinePackets;
+    StageQueue<AVFrame *> m_freeVideoFrames;
+    StageQueue<VideoJob> m_encodeQueue;
+    StageQueue<AVPacket *> m_freeVideoPackets;
+    StageQueue<PacketJob> m_muxQueue;
+    StageStats m_videoStageStats[VideoStageCount];
+    std::thread m_encodeThread;
+    std::thread m_muxThread;
+    /**
+     * @brief 转换级持有该锁期间不会停止流水线，保证正在写入的 YUV 帧不被释放
+     */
+    std::mutex m_convertStageMutex;
+    std::atomic<bool> m_videoPipelineRunning;
+    int64_t m_videoEncodePts;
+    //帧线程和 lookahead 会让编码器延迟输出，按编码器内的 pts 取回对应帧的采集时间
+    static const int VideoTimeSlots = 256;
+    int64_t m_videoFrameTimes[VideoTimeSlots];
+    std::atomic<bool> m_videoEncoderFlushed;
+    VideoEncoderOptions m_videoEncoderOptions;
+    int m_fragmentSeconds;
     struct SwrContext *m_pMicAudioSwrContext;
     struct SwrContext *m_pSysAudioSwrContext;
     /**
@@ -189,12 +449,10 @@ private:
     int is_fifo_scardinit;
     int  m_nb_samples;
     //int64_t m_first_vid_time1, m_first_vid_time2; //前者是采集视频的第一帧的时间，后者是编码器输出的第一帧的时间
-    int64_t m_start_mix_time; //第一个音频帧的时间
     int64_t m_next_vid_time;
     int64_t m_next_aud_time;
     int64_t  m_nLastAudioPresentationTime; //记录上一帧的音频时间戳
     int64_t  m_nLastAudioCardPresentationTime;
-    int64_t  m_nLastAudioMixPresentationTime;
     /**
      * @brief 混合音频帧的数量
      */
@@ -212,23 +470,41 @@ private:
      * @brief 写入第一帧视频的时间戳
      */
     int64_t m_fristVideoFramePts = 0;
+    /**
+     * @brief 上一个视频包的 pts，保证 pts 严格递增
+     */
+    int64_t m_lastVideoPts = -1;
+    /**
+     * @brief 音视频时间戳的共同起点，帧和音频包都携带 CaptureClock::nowUs 的时间
+     */
+    CaptureClock m_captureClock;
+    AudioDriftMonitor m_micDrift;
+    AudioDriftMonitor m_sysDrift;
+    /**
+     * @brief 音频流起点相对录制起点的样本数，-1 表示尚未确定
+     */
+    int64_t m_audioStartSamples = -1;
 
     uint8_t **m_convertedMicSamples;
     uint8_t **m_convertedSysSamples;
-    uint8_t *m_out_buffer;
-    AVFilterGraph *filter_graph;
+    int m_convertedMicCapacity;
+    int m_convertedSysCapacity;
     /**
-     * @brief 过滤器上下文
+     * @brief 混音路径的麦克风/系统音频缓冲区，采集线程写、混音线程读，不再经过 m_audioReadWriteMutex
      */
-    AVFilterContext *buffersink_ctx;
+    AudioSampleFifo m_micMixFifo;
+    AudioSampleFifo m_sysMixFifo;
     /**
-     * @brief 麦克风音频过滤器上下文
+     * @brief 混音用的预分配帧，混音结果写回麦克风帧后直接送编码器
      */
-    AVFilterContext *buffersrc_ctx1;
-    /**
-     * @brief 系统音频过滤器上下文
-     */
-    AVFilterContext *buffersrc_ctx2;
+    static const int AudioMixPoolSize = 4;
+    static const int MixFifoWaitSliceMs = 50;
+    static const int MixFifoWaitTimeoutMs = 10000;
+    ReusePool<AVFrame *> m_micMixFrames;
+    ReusePool<AVFrame *> m_sysMixFrames;
+    AudioMixer m_audioMixer;
+    std::atomic<uint64_t> m_audioMixAllocCount;
+    uint8_t *m_out_buffer;
     /**
      * @brief 写混合音频时，用来计数是否可以读取缓冲区的次数
      * 每当写混合音频时，会比较fifo缓冲区中的可读取帧数是否大于编码可用来编码的最小帧数，
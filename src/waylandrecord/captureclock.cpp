@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "captureclock.h"
+
+#include <time.h>
+
+CaptureClock::CaptureClock()
+    : m_originUs(-1)
+{
+}
+
+void CaptureClock::start()
+{
+    m_originUs.store(nowUs(), std::memory_order_release);
+}
+
+void CaptureClock::reset()
+{
+    m_originUs.store(-1, std::memory_order_release);
+}
+
+bool CaptureClock::isStarted() const
+{
+    return m_originUs.load(std::memory_order_acquire) >= 0;
+}
+
+int64_t CaptureClock::originUs() const
+{
+    return m_originUs.load(std::memory_order_acquire);
+}
+
+int64_t CaptureClock::streamTimeUs(int64_t captureUs) const
+{
+    const int64_t origin = m_originUs.load(std::memory_order_acquire);
+    if (origin < 0 || captureUs <= origin) {
+        return 0;
+    }
+    return captureUs - origin;
+}
+
+int64_t CaptureClock::nowUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000LL + ts.tv_nsec / 1000;
+}
@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CAPTURECLOCK_H
+#define CAPTURECLOCK_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Wayland 录制统一使用的采集时钟（CLOCK_MONOTONIC，微秒）
+ *
+ * 视频帧在 appendFrameToList 采样时、音频包在采集线程读到数据时都用 nowUs 打时间戳，
+ * 编码端再用 streamTimeUs 换算成相对录制起点的时间，音视频的时间戳因此处于同一个时钟域，
+ * 不受系统时间调整的影响。
+ *
+ * start 在输出流打开时调用一次，之后可以在任意线程读取起点。
+ */
+class CaptureClock
+{
+public:
+    CaptureClock();
+
+    /**
+     * @brief 以当前时间作为录制起点
+     */
+    void start();
+    void reset();
+    bool isStarted() const;
+    int64_t originUs() const;
+
+    /**
+     * @brief 采集时间相对录制起点的时长，早于起点的时间按 0 处理
+     */
+    int64_t streamTimeUs(int64_t captureUs) const;
+
+    /**
+     * @brief CLOCK_MONOTONIC 当前时间（微秒）
+     */
+    static int64_t nowUs();
+
+private:
+    std::atomic<int64_t> m_originUs;
+};
+
+#endif // CAPTURECLOCK_H
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "channellayouts.h"
+
+int ChannelLayouts::count(const AVCodecContext *codecContext)
+{
+#ifdef AVLIB_CH_LAYOUT_API
+    return codecContext->ch_layout.nb_channels;
+#else
+    return codecContext->channels;
+#endif
+}
+
+uint64_t ChannelLayouts::mask(const AVCodecContext *codecContext)
+{
+#ifdef AVLIB_CH_LAYOUT_API
+    return codecContext->ch_layout.order == AV_CHANNEL_ORDER_NATIVE ? codecContext->ch_layout.u.mask : 0;
+#else
+    return codecContext->channel_layout;
+#endif
+}
+
+void ChannelLayouts::set(AVCodecContext *codecContext, uint64_t mask)
+{
+    if (0 == mask) {
+        mask = AV_CH_LAYOUT_STEREO;
+    }
+#ifdef AVLIB_CH_LAYOUT_API
+    avlibInterface::m_av_channel_layout_uninit(&codecContext->ch_layout);
+    avlibInterface::m_av_channel_layout_from_mask(&codecContext->ch_layout, mask);
+#else
+    codecContext->channel_layout = mask;
+    codecContext->channels = avlibInterface::m_av_get_channel_layout_nb_channels(mask);
+#endif
+}
+
+bool ChannelLayouts::copyToFrame(AVFrame *frame, const AVCodecContext *codecContext)
+{
+#ifdef AVLIB_CH_LAYOUT_API
+    return avlibInterface::m_av_channel_layout_copy(&frame->ch_layout, &codecContext->ch_layout) >= 0;
+#else
+    frame->channels = codecContext->channels;
+    frame->channel_layout = codecContext->channel_layout;
+    return true;
+#endif
+}
+
+SwrContext *ChannelLayouts::createResampler(const AVCodecContext *out, const AVCodecContext *in)
+{
+    SwrContext *swrContext = nullptr;
+#ifdef AVLIB_CH_LAYOUT_API
+    AVChannelLayout outLayout;
+    AVChannelLayout inLayout;
+    avlibInterface::m_av_channel_layout_default(&outLayout, count(out));
+    avlibInterface::m_av_channel_layout_default(&inLayout, count(in));
+    if (avlibInterface::m_swr_alloc_set_opts2(&swrContext, &outLayout, out->sample_fmt, out->sample_rate,
+                                              &inLayout, in->sample_fmt, in->sample_rate, 0, nullptr) < 0) {
+        swrContext = nullptr;
+    }
+    avlibInterface::m_av_channel_layout_uninit(&outLayout);
+    avlibInterface::m_av_channel_layout_uninit(&inLayout);
+#else
+    swrContext = avlibInterface::m_swr_alloc_set_opts(nullptr,
+                                                      avlibInterface::m_av_get_default_channel_layout(count(out)),
+                                                      out->sample_fmt,
+                                                      out->sample_rate,
+                                                      avlibInterface::m_av_get_default_channel_layout(count(in)),
+                                                      in->sample_fmt,
+                                                      in->sample_rate,
+                                                      0,
+                                                      nullptr);
+#endif
+    if (nullptr != swrContext && avlibInterface::m_swr_init(swrContext) < 0) {
+        avlibInterface::m_swr_free(&swrContext);
+    }
+    return swrContext;
+}
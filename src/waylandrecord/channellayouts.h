@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CHANNELLAYOUTS_H
+#define CHANNELLAYOUTS_H
+
+#include "avlibinterface.h"
+
+/**
+ * @brief 声道数和声道布局的读写，屏蔽 FFmpeg 5.1 前后两套声道 API 的差异
+ *
+ * 旧版本使用 channels/channel_layout 字段，新版本使用 AVChannelLayout（ch_layout），
+ * 旧字段在 FFmpeg 7 中已移除。函数都经由 avlibInterface 调用，需先执行 initFunctions。
+ */
+class ChannelLayouts
+{
+public:
+    /**
+     * @brief 编解码器上下文的声道数
+     */
+    static int count(const AVCodecContext *codecContext);
+
+    /**
+     * @brief 编解码器上下文的声道掩码，布局不是按掩码描述时返回 0
+     */
+    static uint64_t mask(const AVCodecContext *codecContext);
+
+    /**
+     * @brief 按掩码设置编码器的声道布局和声道数，mask 为 0 时使用立体声
+     */
+    static void set(AVCodecContext *codecContext, uint64_t mask);
+
+    /**
+     * @brief 把上下文的声道布局复制给帧，在 av_frame_get_buffer 之前调用
+     * @return 复制失败返回 false
+     */
+    static bool copyToFrame(AVFrame *frame, const AVCodecContext *codecContext);
+
+    /**
+     * @brief 创建并初始化从 in 的格式重采样到 out 的格式的上下文，两端都使用各自声道数的默认布局
+     * @return 失败返回 nullptr
+     */
+    static SwrContext *createResampler(const AVCodecContext *out, const AVCodecContext *in);
+};
+
+#endif // CHANNELLAYOUTS_H
@@ -0,0 +1,312 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "egldmabufreader.h"
+#include "../utils/dmabufmapcache.h"
+
+#include <cstring>
+#include <sys/stat.h>
+
+EglDmaBufReader::EglDmaBufReader(int maxImports, int idleReads)
+    : m_display(EGL_NO_DISPLAY)
+    , m_context(EGL_NO_CONTEXT)
+    , m_maxImports(maxImports > 0 ? maxImports : 1)
+    , m_idleReads(idleReads > 0 ? idleReads : 1)
+    , m_reads(0)
+    , m_importTotal(0)
+    , m_hits(0)
+{
+}
+
+EglDmaBufReader::~EglDmaBufReader()
+{
+    release();
+}
+
+void EglDmaBufReader::setContext(EGLDisplay display, EGLContext context)
+{
+    if (display == m_display && context == m_context) {
+        return;
+    }
+    release();
+    m_display = display;
+    m_context = context;
+}
+
+bool EglDmaBufReader::isValid() const
+{
+    return m_display != EGL_NO_DISPLAY && m_context != EGL_NO_CONTEXT;
+}
+
+bool EglDmaBufReader::read(uint32_t stream, int fd, uint32_t width, uint32_t height, uint32_t stride, uint32_t format, unsigned char *dst,
+                           int64_t captureUs, int64_t *pixelsUs)
+{
+    if (fd < 0 || width == 0 || height == 0 || nullptr == dst || !makeCurrent()) {
+        return false;
+    }
+    const bool cacheable = DmaBufMapCache::hasStableIdentity(fd);
+    const GLuint fbo = importBuffer(fd, width, height, stride, format, cacheable);
+    if (0 == fbo) {
+        return false;
+    }
+    const bool ok = readFramebuffer(stream, fbo, width, height, dst, captureUs, pixelsUs);
+    if (!cacheable) {
+        //无法按 inode 区分的缓冲区每帧重新导入，读回已提交，GL 对象在传输完成后才真正释放
+        for (size_t i = 0; i < m_imports.size(); i++) {
+            if (m_imports[i].fbo == fbo) {
+                destroyImport(i, true);
+                break;
+            }
+        }
+    }
+    return ok;
+}
+
+bool EglDmaBufReader::readFramebuffer(uint32_t stream, GLuint fbo, uint32_t width, uint32_t height, unsigned char *dst,
+                                      int64_t captureUs, int64_t *pixelsUs)
+{
+    if (0 == fbo || width == 0 || height == 0 || nullptr == dst || !makeCurrent()) {
+        return false;
+    }
+    const size_t bytes = static_cast<size_t>(width) * height * 4;
+    Stream &s = m_streams[stream];
+    if (s.pbo[0] == 0 || s.width != width || s.height != height) {
+        //首次读取或尺寸变化时重新分配，之后每帧复用
+        if (s.pbo[0] != 0) {
+            glDeleteBuffers(2, s.pbo);
+        }
+        glGenBuffers(2, s.pbo);
+        for (int i = 0; i < 2; i++) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+            s.filled[i] = false;
+            s.returned[i] = false;
+            s.captureUs[i] = 0;
+        }
+        s.current = 0;
+        s.width = width;
+        s.height = height;
+    }
+
+    //读入当前 PBO，glReadPixels 只提交传输，不等待完成
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo[s.current]);
+    glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    s.filled[s.current] = true;
+    s.returned[s.current] = false;
+    s.captureUs[s.current] = captureUs;
+
+    //上一次读入的 PBO 早已传输完成，映射时不需要等待；没有时只能同步等待本次传输
+    const int previous = 1 - s.current;
+    const int source = s.filled[previous] ? previous : s.current;
+    if (source != s.current) {
+        glFlush();
+    }
+    s.current = previous;
+
+    const bool ok = mapPixels(s.pbo[source], bytes, dst);
+    if (ok) {
+        s.returned[source] = true;
+        if (pixelsUs) {
+            *pixelsUs = s.captureUs[source];
+        }
+    }
+    return ok;
+}
+
+bool EglDmaBufReader::flush(uint32_t stream, unsigned char *dst, int64_t *pixelsUs)
+{
+    auto itr = m_streams.find(stream);
+    if (itr == m_streams.end() || nullptr == dst || !makeCurrent()) {
+        return false;
+    }
+    Stream &s = itr->second;
+    //最后读入的是 current 的另一个
+    const int last = 1 - s.current;
+    if (s.pbo[last] == 0 || !s.filled[last] || s.returned[last]) {
+        return false;
+    }
+    if (!mapPixels(s.pbo[last], static_cast<size_t>(s.width) * s.height * 4, dst)) {
+        return false;
+    }
+    s.returned[last] = true;
+    if (pixelsUs) {
+        *pixelsUs = s.captureUs[last];
+    }
+    return true;
+}
+
+bool EglDmaBufReader::mapPixels(GLuint pbo, size_t bytes, unsigned char *dst)
+{
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    const void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes), GL_MAP_READ_BIT);
+    if (mapped) {
+        memcpy(dst, mapped, bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return mapped != nullptr;
+}
+
+void EglDmaBufReader::release()
+{
+    if (!isValid()) {
+        return;
+    }
+    //取不到上下文时 GL 对象无法删除，随上下文一起销毁
+    const bool hasContext = makeCurrent();
+    while (!m_imports.empty()) {
+        destroyImport(m_imports.size() - 1, hasContext);
+    }
+    if (hasContext) {
+        for (auto itr = m_streams.begin(); itr != m_streams.end(); ++itr) {
+            if (itr->second.pbo[0] != 0) {
+                glDeleteBuffers(2, itr->second.pbo);
+            }
+        }
+    }
+    m_streams.clear();
+}
+
+int EglDmaBufReader::importCount() const
+{
+    return static_cast<int>(m_imports.size());
+}
+
+uint64_t EglDmaBufReader::importTotal() const
+{
+    return m_importTotal;
+}
+
+uint64_t EglDmaBufReader::hitCount() const
+{
+    return m_hits;
+}
+
+bool EglDmaBufReader::makeCurrent()
+{
+    if (!isValid()) {
+        return false;
+    }
+    if (eglGetCurrentContext() == m_context) {
+        return true;
+    }
+    return eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_context) == EGL_TRUE;
+}
+
+GLuint EglDmaBufReader::importBuffer(int fd, uint32_t width, uint32_t height, uint32_t stride, uint32_t format, bool cacheable)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return 0;
+    }
+    m_reads++;
+    size_t index = m_imports.size();
+    for (size_t i = 0; cacheable && i < m_imports.size(); i++) {
+        if (m_imports[i].dev == st.st_dev && m_imports[i].ino == st.st_ino) {
+            index = i;
+            break;
+        }
+    }
+    if (index < m_imports.size()) {
+        const Import &import = m_imports[index];
+        if (import.width != width || import.height != height || import.stride != stride || import.format != format) {
+            //同一块缓冲区换了布局，按新参数重新导入
+            destroyImport(index, true);
+            index = m_imports.size();
+        }
+    }
+
+    if (index < m_imports.size()) {
+        m_hits++;
+    } else {
+        if (static_cast<int>(m_imports.size()) >= m_maxImports) {
+            size_t oldest = 0;
+            for (size_t i = 1; i < m_imports.size(); i++) {
+                if (m_imports[i].lastUse < m_imports[oldest].lastUse) {
+                    oldest = i;
+                }
+            }
+            destroyImport(oldest, true);
+        }
+        EGLint importAttributes[] = {EGL_WIDTH,
+                                     static_cast<EGLint>(width),
+                                     EGL_HEIGHT,
+                                     static_cast<EGLint>(height),
+                                     EGL_LINUX_DRM_FOURCC_EXT,
+                                     static_cast<EGLint>(format),
+                                     EGL_DMA_BUF_PLANE0_FD_EXT,
+                                     fd,
+                                     EGL_DMA_BUF_PLANE0_OFFSET_EXT,
+                                     0,
+                                     EGL_DMA_BUF_PLANE0_PITCH_EXT,
+                                     static_cast<EGLint>(stride),
+                                     EGL_NONE};
+        EGLImageKHR image = eglCreateImageKHR(m_display, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr, importAttributes);
+        if (image == EGL_NO_IMAGE_KHR) {
+            return 0;
+        }
+        m_importTotal++;
+
+        Import import;
+        import.dev = st.st_dev;
+        import.ino = st.st_ino;
+        import.width = width;
+        import.height = height;
+        import.stride = stride;
+        import.format = format;
+        import.image = image;
+        import.lastUse = 0;
+        glGenTextures(1, &import.texture);
+        glBindTexture(GL_TEXTURE_2D, import.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, image);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &import.fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, import.fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, import.texture, 0);
+        const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        m_imports.push_back(import);
+        index = m_imports.size() - 1;
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            destroyImport(index, true);
+            return 0;
+        }
+    }
+    m_imports[index].lastUse = m_reads;
+    const GLuint fbo = m_imports[index].fbo;
+    evictIdle();
+    return fbo;
+}
+
+void EglDmaBufReader::destroyImport(size_t index, bool hasContext)
+{
+    Import &import = m_imports[index];
+    if (hasContext) {
+        glDeleteFramebuffers(1, &import.fbo);
+        glDeleteTextures(1, &import.texture);
+    }
+    eglDestroyImageKHR(m_display, import.image);
+    m_imports[index] = m_imports.back();
+    m_imports.pop_back();
+}
+
+void EglDmaBufReader::evictIdle()
+{
+    //分辨率变化、合成器重建缓冲区后旧缓冲区不会再出现
+    for (size_t i = m_imports.size(); i > 0; i--) {
+        if (m_reads - m_imports[i - 1].lastUse > static_cast<uint64_t>(m_idleReads)) {
+            destroyImport(i - 1, true);
+        }
+    }
+}
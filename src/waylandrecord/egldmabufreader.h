@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef EGLDMABUFREADER_H
+#define EGLDMABUFREADER_H
+
+#include <epoxy/egl.h>
+#include <epoxy/gl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * @brief 通过 EGL 导入 dma-buf 并读回像素（x86 录屏路径）
+ *
+ * 原先每帧都要 eglCreateImageKHR、创建纹理和 FBO、同步 glReadPixels，再全部销毁。
+ * 这里按缓冲区本身（fd 所指文件的 st_dev/st_ino）缓存 EGLImage、纹理和 FBO，
+ * 合成器轮换使用的几块缓冲区各只导入一次；EGLImage 持有缓冲区的引用，缓存期间 inode 不会被复用。
+ * Linux 5.3 之前所有 dma-buf 共用同一个 inode，无法区分（见 DmaBufMapCache::hasStableIdentity），这时每帧重新导入。
+ * 超过 maxImports 时淘汰最久未用的导入，连续 idleReads 次读取都没有用到的导入也会被释放。
+ *
+ * 读回使用两个像素缓冲对象（PBO）交替：本次把画面异步读入一个 PBO，同时映射上一次读入的另一个取数据，
+ * CPU 不必等待本帧的传输完成。代价是输出比输入晚一帧：每路画面的第一帧（或尺寸变化后的第一帧）
+ * 同步读回，下一次读取会重复输出这一帧。每个 PBO 记录读入时的采集时间，随像素一起返回，
+ * 调用方按像素实际的采集时间打时间戳；停止录制前用 flush 取出最后读入、尚未输出的一帧。
+ *
+ * 所有方法都要在同一线程调用，导入和读回前会把 setContext 指定的上下文设为当前上下文。
+ */
+class EglDmaBufReader
+{
+public:
+    static const int DefaultMaxImports = 12;
+    static const int DefaultIdleReads = 120;
+
+    explicit EglDmaBufReader(int maxImports = DefaultMaxImports, int idleReads = DefaultIdleReads);
+    ~EglDmaBufReader();
+
+    EglDmaBufReader(const EglDmaBufReader &) = delete;
+    EglDmaBufReader &operator=(const EglDmaBufReader &) = delete;
+
+    /**
+     * @brief 设置导入和读回使用的 EGL 显示与上下文，切换前释放已有的导入和 PBO
+     */
+    void setContext(EGLDisplay display, EGLContext context);
+    bool isValid() const;
+
+    /**
+     * @brief 导入 fd 对应的缓冲区并读回 RGBA 像素
+     * @param stream 画面来源（输出），每路画面各有一对 PBO
+     * @param dst 至少 width * height * 4 字节，每行 width * 4 字节
+     * @param captureUs 本帧的采集时间
+     * @param pixelsUs 不为空时返回 dst 中画面的采集时间，通常是上一次读取的 captureUs
+     * @return 导入或读回失败返回 false
+     */
+    bool read(uint32_t stream, int fd, uint32_t width, uint32_t height, uint32_t stride, uint32_t format, unsigned char *dst,
+              int64_t captureUs = 0, int64_t *pixelsUs = nullptr);
+
+    /**
+     * @brief 经 PBO 双缓冲从 fbo 读回 RGBA 像素，参数同 read
+     */
+    bool readFramebuffer(uint32_t stream, GLuint fbo, uint32_t width, uint32_t height, unsigned char *dst,
+                         int64_t captureUs = 0, int64_t *pixelsUs = nullptr);
+
+    /**
+     * @brief 取出 stream 最后读入、尚未输出的一帧，停止录制、release 之前调用
+     * @param dst 至少 width * height * 4 字节，尺寸为该路最后一次读取的尺寸
+     * @return 没有待输出的画面或映射失败返回 false
+     */
+    bool flush(uint32_t stream, unsigned char *dst, int64_t *pixelsUs = nullptr);
+
+    /**
+     * @brief 释放所有导入的缓冲区和 PBO，停止录制时调用
+     */
+    void release();
+
+    int importCount() const;
+    /**
+     * @brief 实际调用 eglCreateImageKHR 的次数
+     */
+    uint64_t importTotal() const;
+    /**
+     * @brief 复用已有导入的次数
+     */
+    uint64_t hitCount() const;
+
+private:
+    struct Import {
+        dev_t dev;
+        ino_t ino;
+        uint32_t width;
+        uint32_t height;
+        uint32_t stride;
+        uint32_t format;
+        EGLImageKHR image;
+        GLuint texture;
+        GLuint fbo;
+        uint64_t lastUse;
+    };
+
+    struct Stream {
+        GLuint pbo[2];
+        bool filled[2];
+        //已经映射输出过，flush 时不再输出
+        bool returned[2];
+        int64_t captureUs[2];
+        int current;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    bool makeCurrent();
+    bool mapPixels(GLuint pbo, size_t bytes, unsigned char *dst);
+    GLuint importBuffer(int fd, uint32_t width, uint32_t height, uint32_t stride, uint32_t format, bool cacheable);
+    void destroyImport(size_t index, bool hasContext);
+    void evictIdle();
+
+    EGLDisplay m_display;
+    EGLContext m_context;
+    std::vector<Import> m_imports;
+    std::map<uint32_t, Stream> m_streams;
+    int m_maxImports;
+    int m_idleReads;
+    uint64_t m_reads;
+    uint64_t m_importTotal;
+    uint64_t m_hits;
+};
+
+#endif // EGLDMABUFREADER_H
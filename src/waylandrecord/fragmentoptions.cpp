@@ -0,0 +1,32 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fragmentoptions.h"
+
+#include <algorithm>
+
+int FragmentOptions::clampSeconds(int seconds)
+{
+    return std::min(std::max(seconds, 0), MaxSeconds);
+}
+
+FragmentOptions::Options FragmentOptions::muxOptions(bool matroska, int seconds)
+{
+    Options options;
+    if (seconds <= 0) {
+        return options;
+    }
+    if (matroska) {
+        //cluster 写完即输出，没有写入 Cues 的文件同样可以播放
+        options.emplace_back("cluster_time_limit", std::to_string(static_cast<long long>(seconds) * 1000));
+    } else {
+        //文件头写入空的 moov，之后每个分段自带 moof 索引；分段从间隔之后的第一个关键帧开始
+        //min_frag_duration 的单位为微秒（AV_TIME_BASE）
+        options.emplace_back("movflags", "frag_keyframe+empty_moov+default_base_moof");
+        options.emplace_back("min_frag_duration", std::to_string(static_cast<long long>(seconds) * 1000000));
+    }
+    //每次写包后刷新 IO 缓冲区，完成的分段不会滞留在进程内
+    options.emplace_back("flush_packets", "1");
+    return options;
+}
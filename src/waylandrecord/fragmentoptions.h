@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FRAGMENTOPTIONS_H
+#define FRAGMENTOPTIONS_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 分段写入的封装参数，与 FFmpeg 无关，便于单独测试
+ *
+ * MP4 输出为 fragmented MP4，MKV 按间隔切分 cluster。参数由 CAVOutputStream 逐个写入
+ * avformat_write_header 的 AVDictionary。
+ */
+class FragmentOptions
+{
+public:
+    typedef std::vector<std::pair<std::string, std::string>> Options;
+
+    /**
+     * @brief 将分段间隔限制在 [0, MaxSeconds]，0 表示只在结束时写文件索引
+     */
+    static int clampSeconds(int seconds);
+
+    /**
+     * @brief 按输出格式生成分段参数，seconds 不大于 0 时为空
+     * @param matroska 输出是否为 MKV，否则按 MP4 处理
+     */
+    static Options muxOptions(bool matroska, int seconds);
+
+    static constexpr int DefaultSeconds = 2;
+    static constexpr int MaxSeconds = 60;
+};
+
+#endif // FRAGMENTOPTIONS_H
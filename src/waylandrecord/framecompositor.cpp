@@ -0,0 +1,243 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "framecompositor.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+static const size_t CanvasAlignment = 64;
+static const uint32_t AlphaMask = 0xff000000u;
+
+FrameCompositor::FrameCompositor()
+    : m_canvas(nullptr)
+    , m_width(0)
+    , m_height(0)
+    , m_order(RGBA)
+    , m_blitted(0)
+    , m_skipped(0)
+{
+}
+
+FrameCompositor::~FrameCompositor()
+{
+    release();
+}
+
+bool FrameCompositor::resize(int width, int height, PixelOrder order)
+{
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    if (nullptr != m_canvas && width == m_width && height == m_height && order == m_order) {
+        return true;
+    }
+    release();
+    void *memory = nullptr;
+    if (posix_memalign(&memory, CanvasAlignment, static_cast<size_t>(width) * 4 * static_cast<size_t>(height)) != 0) {
+        return false;
+    }
+    m_canvas = static_cast<unsigned char *>(memory);
+    m_width = width;
+    m_height = height;
+    m_order = order;
+    invalidate();
+    return true;
+}
+
+void FrameCompositor::release()
+{
+    free(m_canvas);
+    m_canvas = nullptr;
+    m_width = 0;
+    m_height = 0;
+    m_states.clear();
+}
+
+void FrameCompositor::invalidate()
+{
+    m_states.clear();
+    if (nullptr == m_canvas) {
+        return;
+    }
+    //屏幕未覆盖的区域为不透明的黑色
+    const uint32_t black = AlphaMask;
+    uint32_t *pixels = reinterpret_cast<uint32_t *>(m_canvas);
+    const size_t count = static_cast<size_t>(m_width) * static_cast<size_t>(m_height);
+    for (size_t i = 0; i < count; i++) {
+        pixels[i] = black;
+    }
+}
+
+bool FrameCompositor::blit(uint64_t generation, const unsigned char *src, int width, int height, int stride,
+                           PixelOrder order, bool opaque, int x, int y)
+{
+    if (nullptr == m_canvas || nullptr == src || width <= 0 || height <= 0 || stride < width * 4) {
+        return false;
+    }
+    const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    auto itr = m_states.find(key);
+    if (itr != m_states.end() && itr->second.generation == generation && itr->second.width == width
+            && itr->second.height == height && itr->second.order == order) {
+        //画面未变化，画布中已是该画面
+        m_skipped++;
+        return false;
+    }
+
+    //裁剪到画布范围内
+    int srcX = 0;
+    int srcY = 0;
+    int dstX = x;
+    int dstY = y;
+    int copyWidth = width;
+    int copyHeight = height;
+    if (dstX < 0) {
+        srcX = -dstX;
+        copyWidth += dstX;
+        dstX = 0;
+    }
+    if (dstY < 0) {
+        srcY = -dstY;
+        copyHeight += dstY;
+        dstY = 0;
+    }
+    if (dstX + copyWidth > m_width) {
+        copyWidth = m_width - dstX;
+    }
+    if (dstY + copyHeight > m_height) {
+        copyHeight = m_height - dstY;
+    }
+    if (copyWidth <= 0 || copyHeight <= 0) {
+        return false;
+    }
+
+    const size_t dstStride = static_cast<size_t>(m_width) * 4;
+    const unsigned char *srcRow = src + static_cast<size_t>(srcY) * static_cast<size_t>(stride) + static_cast<size_t>(srcX) * 4;
+    unsigned char *dstRow = m_canvas + static_cast<size_t>(dstY) * dstStride + static_cast<size_t>(dstX) * 4;
+    const bool swap = (order != m_order);
+    for (int row = 0; row < copyHeight; row++) {
+        if (swap) {
+            swizzleRow(dstRow, srcRow, copyWidth, opaque);
+        } else {
+            copyRow(dstRow, srcRow, copyWidth, opaque);
+        }
+        srcRow += stride;
+        dstRow += dstStride;
+    }
+    BlitState state;
+    state.generation = generation;
+    state.width = width;
+    state.height = height;
+    state.order = order;
+    m_states[key] = state;
+    m_blitted++;
+    return true;
+}
+
+void FrameCompositor::swizzleRow(unsigned char *dst, const unsigned char *src, int pixels, bool opaque)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i agMask = _mm_set1_epi32(static_cast<int>(0xff00ff00u));
+    const __m128i lowMask = _mm_set1_epi32(0x000000ff);
+    const __m128i alpha = _mm_set1_epi32(opaque ? static_cast<int>(AlphaMask) : 0);
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+        __m128i ag = _mm_and_si128(p, agMask);
+        __m128i r = _mm_and_si128(_mm_srli_epi32(p, 16), lowMask);
+        __m128i b = _mm_slli_epi32(_mm_and_si128(p, lowMask), 16);
+        p = _mm_or_si128(_mm_or_si128(ag, r), _mm_or_si128(b, alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), p);
+    }
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x4_t p = vld4q_u8(src + i * 4);
+        uint8x16_t tmp = p.val[0];
+        p.val[0] = p.val[2];
+        p.val[2] = tmp;
+        if (opaque) {
+            p.val[3] = vdupq_n_u8(0xff);
+        }
+        vst4q_u8(dst + i * 4, p);
+    }
+#endif
+    for (; i < pixels; i++) {
+        uint32_t p;
+        memcpy(&p, src + i * 4, 4);
+        p = (p & 0xff00ff00u) | ((p >> 16) & 0xffu) | ((p & 0xffu) << 16);
+        if (opaque) {
+            p |= AlphaMask;
+        }
+        memcpy(dst + i * 4, &p, 4);
+    }
+}
+
+void FrameCompositor::copyRow(unsigned char *dst, const unsigned char *src, int pixels, bool opaque)
+{
+    if (!opaque) {
+        //libc 的 memcpy 已按平台向量化
+        memcpy(dst, src, static_cast<size_t>(pixels) * 4);
+        return;
+    }
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(AlphaMask));
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_or_si128(p, alpha));
+    }
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+    const uint8x16_t alpha = vreinterpretq_u8_u32(vdupq_n_u32(AlphaMask));
+    for (; i + 4 <= pixels; i += 4) {
+        vst1q_u8(dst + i * 4, vorrq_u8(vld1q_u8(src + i * 4), alpha));
+    }
+#endif
+    for (; i < pixels; i++) {
+        uint32_t p;
+        memcpy(&p, src + i * 4, 4);
+        p |= AlphaMask;
+        memcpy(dst + i * 4, &p, 4);
+    }
+}
+
+unsigned char *FrameCompositor::data() const
+{
+    return m_canvas;
+}
+
+int FrameCompositor::width() const
+{
+    return m_width;
+}
+
+int FrameCompositor::height() const
+{
+    return m_height;
+}
+
+int FrameCompositor::stride() const
+{
+    return m_width * 4;
+}
+
+FrameCompositor::PixelOrder FrameCompositor::order() const
+{
+    return m_order;
+}
+
+uint64_t FrameCompositor::blittedCount() const
+{
+    return m_blitted;
+}
+
+uint64_t FrameCompositor::skippedCount() const
+{
+    return m_skipped;
+}
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FRAMECOMPOSITOR_H
+#define FRAMECOMPOSITOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+/**
+ * @brief 多屏录制的画面合成器
+ *
+ * 替代 appendFrameToList 中每帧 "new QImage + fill + QPainter::drawImage" 的写法：
+ * 画布只在尺寸或像素顺序变化时分配，各屏幕的画面按行直接拷贝到画布对应位置，
+ * 像素顺序不同（RGBA/BGRA）时在拷贝的同时交换 R、B 通道（SSE2/NEON 向量化）。
+ * 同一位置的屏幕画面代数（generation）未变化时跳过拷贝，画布中保留上一次的内容。
+ *
+ * 画布每行 width * 4 字节，与 appendBuffer 的 stride 约定一致。
+ */
+class FrameCompositor
+{
+public:
+    /**
+     * @brief 32位像素在内存中的字节顺序
+     */
+    enum PixelOrder {
+        RGBA = 0,   // QImage::Format_RGBA8888 / Format_RGBX8888
+        BGRA        // QImage::Format_RGB32 / Format_ARGB32（小端）
+    };
+
+    FrameCompositor();
+    ~FrameCompositor();
+    FrameCompositor(const FrameCompositor &) = delete;
+    FrameCompositor &operator=(const FrameCompositor &) = delete;
+
+    /**
+     * @brief 设置画布尺寸和像素顺序，只有变化时才重新分配并清成黑色
+     * @return 分配失败返回 false
+     */
+    bool resize(int width, int height, PixelOrder order);
+    void release();
+
+    /**
+     * @brief 将一块屏幕画面拷贝到画布 (x, y) 处，超出画布的部分被裁掉
+     * @param generation 画面代数，与该位置上一次拷贝的代数相同时跳过
+     * @param src 源画面
+     * @param width 源画面宽
+     * @param height 源画面高
+     * @param stride 源画面每行字节数
+     * @param order 源画面像素顺序
+     * @param opaque 源画面为 X 通道格式时置为 true，拷贝时把 alpha 通道填成 0xff
+     * @return 实际拷贝返回 true，跳过或参数无效返回 false
+     */
+    bool blit(uint64_t generation, const unsigned char *src, int width, int height, int stride,
+              PixelOrder order, bool opaque, int x, int y);
+
+    /**
+     * @brief 清空画布并使所有位置的代数失效，下一次 blit 必定拷贝（屏幕布局变化时调用）
+     */
+    void invalidate();
+
+    unsigned char *data() const;
+    int width() const;
+    int height() const;
+    int stride() const;
+    PixelOrder order() const;
+
+    uint64_t blittedCount() const;
+    uint64_t skippedCount() const;
+
+    /**
+     * @brief 拷贝一行像素，同时交换 R、B 通道
+     */
+    static void swizzleRow(unsigned char *dst, const unsigned char *src, int pixels, bool opaque);
+    /**
+     * @brief 拷贝一行像素，像素顺序不变
+     */
+    static void copyRow(unsigned char *dst, const unsigned char *src, int pixels, bool opaque);
+
+private:
+    struct BlitState {
+        uint64_t generation;
+        int width;
+        int height;
+        PixelOrder order;
+    };
+
+    unsigned char *m_canvas;
+    int m_width;
+    int m_height;
+    PixelOrder m_order;
+    uint64_t m_blitted;
+    uint64_t m_skipped;
+    //按目标位置记录上一次拷贝的画面代数
+    std::map<uint64_t, BlitState> m_states;
+};
+
+#endif // FRAMECOMPOSITOR_H
@@ -0,0 +1,171 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "framededup.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const uint64_t HashSeed = 0x243f6a8885a308d3ULL;
+static const uint64_t HashPrime1 = 0x9e3779b97f4a7c15ULL;
+static const uint64_t HashPrime2 = 0xc2b2ae3d27d4eb4fULL;
+
+static inline uint64_t rotl64(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t mixWord(uint64_t hash, uint64_t word)
+{
+    return rotl64((hash ^ word) * HashPrime1, 31);
+}
+
+static inline uint64_t loadWord(const unsigned char *p)
+{
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+//一行中属于同一分块的字节；四路独立累加，避免乘法延迟串行
+static uint64_t hashSegment(uint64_t hash, const unsigned char *p, size_t bytes)
+{
+    uint64_t a = hash;
+    uint64_t b = hash ^ HashPrime2;
+    uint64_t c = rotl64(hash, 17);
+    uint64_t d = rotl64(hash, 41) ^ HashPrime1;
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        a = mixWord(a, loadWord(p + i));
+        b = mixWord(b, loadWord(p + i + 8));
+        c = mixWord(c, loadWord(p + i + 16));
+        d = mixWord(d, loadWord(p + i + 24));
+    }
+    for (; i + 8 <= bytes; i += 8) {
+        a = mixWord(a, loadWord(p + i));
+    }
+    if (i < bytes) {
+        uint64_t tail = 0;
+        memcpy(&tail, p + i, bytes - i);
+        b = mixWord(b, tail ^ (static_cast<uint64_t>(bytes - i) << 56));
+    }
+    uint64_t h = a ^ rotl64(b, 13) ^ rotl64(c, 29) ^ rotl64(d, 47);
+    return (h ^ (h >> 32)) * HashPrime2;
+}
+
+FrameDedup::FrameDedup()
+    : m_enabled(true)
+    , m_maxInterval(0)
+    , m_width(0)
+    , m_height(0)
+    , m_tilesX(0)
+    , m_lastAcceptedTime(0)
+    , m_hasBaseline(false)
+    , m_checked(0)
+    , m_skipped(0)
+    , m_lastChangedTiles(0)
+{
+}
+
+void FrameDedup::reset()
+{
+    m_width = 0;
+    m_height = 0;
+    m_tilesX = 0;
+    m_lastAcceptedTime = 0;
+    m_hasBaseline = false;
+    m_checked.store(0, std::memory_order_relaxed);
+    m_skipped.store(0, std::memory_order_relaxed);
+    m_lastChangedTiles.store(0, std::memory_order_relaxed);
+}
+
+void FrameDedup::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+bool FrameDedup::isEnabled() const
+{
+    return m_enabled;
+}
+
+void FrameDedup::setMaxInterval(int64_t interval)
+{
+    m_maxInterval = interval;
+}
+
+bool FrameDedup::accept(const unsigned char *frame, int width, int height, int stride, int64_t time, bool sourceChanged)
+{
+    if (!m_enabled || nullptr == frame || width <= 0 || height <= 0 || stride < width * 4) {
+        return true;
+    }
+    m_checked.fetch_add(1, std::memory_order_relaxed);
+    const bool sizeChanged = width != m_width || height != m_height;
+    const bool keepAlive = m_maxInterval > 0 && time - m_lastAcceptedTime >= m_maxInterval;
+    if (m_hasBaseline && !sizeChanged && !sourceChanged && !keepAlive) {
+        //采集端没有新画面，内容必然相同
+        m_skipped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (sizeChanged) {
+        m_width = width;
+        m_height = height;
+        m_tilesX = (width + TileSize - 1) / TileSize;
+        const size_t tiles = static_cast<size_t>(m_tilesX) * static_cast<size_t>((height + TileSize - 1) / TileSize);
+        m_baseline.assign(tiles, 0);
+        m_current.assign(tiles, 0);
+        m_hasBaseline = false;
+    }
+    hashTiles(frame, width, height, stride);
+    int changedTiles = 0;
+    for (size_t i = 0; i < m_current.size(); i++) {
+        if (m_current[i] != m_baseline[i]) {
+            changedTiles++;
+        }
+    }
+    m_lastChangedTiles.store(changedTiles, std::memory_order_relaxed);
+    if (m_hasBaseline && 0 == changedTiles && !keepAlive) {
+        m_skipped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_baseline.swap(m_current);
+    m_hasBaseline = true;
+    m_lastAcceptedTime = time;
+    return true;
+}
+
+void FrameDedup::hashTiles(const unsigned char *frame, int width, int height, int stride)
+{
+    std::fill(m_current.begin(), m_current.end(), HashSeed);
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    const size_t tileBytes = static_cast<size_t>(TileSize) * 4;
+    for (int y = 0; y < height; y++) {
+        const unsigned char *row = frame + static_cast<ptrdiff_t>(y) * stride;
+        uint64_t *hashes = m_current.data() + static_cast<size_t>(y / TileSize) * static_cast<size_t>(m_tilesX);
+        for (int tx = 0; tx < m_tilesX; tx++) {
+            const size_t offset = static_cast<size_t>(tx) * tileBytes;
+            hashes[tx] = hashSegment(hashes[tx], row + offset, std::min(tileBytes, rowBytes - offset));
+        }
+    }
+}
+
+uint64_t FrameDedup::checkedCount() const
+{
+    return m_checked.load(std::memory_order_relaxed);
+}
+
+uint64_t FrameDedup::skippedCount() const
+{
+    return m_skipped.load(std::memory_order_relaxed);
+}
+
+int FrameDedup::lastChangedTiles() const
+{
+    return m_lastChangedTiles.load(std::memory_order_relaxed);
+}
+
+int FrameDedup::tileCount() const
+{
+    return static_cast<int>(m_baseline.size());
+}
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FRAMEDEDUP_H
+#define FRAMEDEDUP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 静止画面检测：按 64x64 像素分块计算哈希，与上一次写入的帧比较
+ *
+ * appendFrameToList 在帧进入环形缓冲区前调用 accept，画面没有变化的帧不再写入，
+ * 编码端按采集时间换算时间戳，输出为可变帧率。
+ * 采集端没有送来新画面时（sourceChanged 为 false）直接判定为重复，不再计算哈希。
+ * 为了让播放器能定位、文件时长不至于停在最后一次变化处，
+ * 距上一次写入超过 maxInterval 时即使画面相同也写入一帧。
+ *
+ * 只由 appendFrameToList 线程调用；计数可在其他线程读取。
+ */
+class FrameDedup
+{
+public:
+    static constexpr int TileSize = 64;
+
+    FrameDedup();
+
+    /**
+     * @brief 清空上一帧的哈希和计数，录制开始时调用
+     */
+    void reset();
+
+    /**
+     * @brief 关闭后 accept 始终返回 true（GStreamer 按固定帧率打时间戳，不能丢帧）
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    /**
+     * @brief 画面不变时两次写入的最大间隔，与 accept 的 time 单位相同；小于等于 0 表示不限制
+     */
+    void setMaxInterval(int64_t interval);
+
+    /**
+     * @brief 判断当前帧是否需要写入
+     * @param frame 4 字节像素的画面
+     * @param stride frame 每行的字节数
+     * @param time 采集时间
+     * @param sourceChanged 采集端本节拍是否送来了新画面
+     * @return true 写入；false 与上一次写入的帧相同，跳过
+     */
+    bool accept(const unsigned char *frame, int width, int height, int stride, int64_t time, bool sourceChanged = true);
+
+    /**
+     * @brief 检查过的帧数
+     */
+    uint64_t checkedCount() const;
+    /**
+     * @brief 因画面未变化而跳过的帧数
+     */
+    uint64_t skippedCount() const;
+    /**
+     * @brief 最近一次计算哈希时变化的分块数
+     */
+    int lastChangedTiles() const;
+    int tileCount() const;
+
+private:
+    void hashTiles(const unsigned char *frame, int width, int height, int stride);
+
+    bool m_enabled;
+    int64_t m_maxInterval;
+    int m_width;
+    int m_height;
+    int m_tilesX;
+    int64_t m_lastAcceptedTime;
+    bool m_hasBaseline;
+    std::vector<uint64_t> m_baseline;
+    std::vector<uint64_t> m_current;
+    std::atomic<uint64_t> m_checked;
+    std::atomic<uint64_t> m_skipped;
+    std::atomic<int> m_lastChangedTiles;
+};
+
+#endif // FRAMEDEDUP_H
@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "framepacer.h"
+
+#include <errno.h>
+#include <time.h>
+
+static const int64_t NsPerSecond = 1000000000LL;
+
+FramePacer::FramePacer()
+    : m_now(&FramePacer::monotonicNs)
+    , m_sleepUntil(&FramePacer::sleepUntil)
+    , m_fps(0)
+    , m_periodNs(0)
+    , m_nextDeadlineNs(0)
+    , m_startNs(0)
+    , m_lastTickNs(0)
+    , m_ticks(0)
+    , m_late(0)
+    , m_skipped(0)
+    , m_duplicates(0)
+{
+}
+
+void FramePacer::setClock(NowFunc now, SleepFunc sleepUntil)
+{
+    m_now = now ? now : NowFunc(&FramePacer::monotonicNs);
+    m_sleepUntil = sleepUntil ? sleepUntil : SleepFunc(&FramePacer::sleepUntil);
+}
+
+void FramePacer::start(int fps)
+{
+    m_fps = fps > 0 ? fps : 1;
+    m_periodNs = NsPerSecond / m_fps;
+    int64_t now = m_now();
+    m_nextDeadlineNs = now;
+    m_startNs.store(now, std::memory_order_relaxed);
+    m_lastTickNs.store(now, std::memory_order_relaxed);
+    m_ticks.store(0, std::memory_order_relaxed);
+    m_late.store(0, std::memory_order_relaxed);
+    m_skipped.store(0, std::memory_order_relaxed);
+    m_duplicates.store(0, std::memory_order_relaxed);
+}
+
+bool FramePacer::waitNextTick()
+{
+    const int64_t now = m_now();
+    if (m_ticks.load(std::memory_order_relaxed) == 0) {
+        //第一个节拍立即到期，以此为起点建立节拍网格
+        m_startNs.store(now, std::memory_order_relaxed);
+        m_lastTickNs.store(now, std::memory_order_relaxed);
+        m_nextDeadlineNs = now + m_periodNs;
+        m_ticks.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+    const int64_t deadline = m_nextDeadlineNs;
+    bool onTime = true;
+    if (now > deadline) {
+        //上一帧处理超时，本节拍不再睡眠；错过整周期的节拍直接跳过，截止时间仍对齐到原有网格上
+        onTime = false;
+        int64_t missed = (now - deadline) / m_periodNs;
+        m_late.fetch_add(1, std::memory_order_relaxed);
+        m_skipped.fetch_add(static_cast<uint64_t>(missed), std::memory_order_relaxed);
+        m_nextDeadlineNs = deadline + (missed + 1) * m_periodNs;
+        m_lastTickNs.store(now, std::memory_order_relaxed);
+    } else {
+        m_sleepUntil(deadline);
+        m_nextDeadlineNs = deadline + m_periodNs;
+        m_lastTickNs.store(deadline, std::memory_order_relaxed);
+    }
+    m_ticks.fetch_add(1, std::memory_order_release);
+    return onTime;
+}
+
+void FramePacer::markDuplicate()
+{
+    m_duplicates.fetch_add(1, std::memory_order_relaxed);
+}
+
+int FramePacer::targetFps() const
+{
+    return m_fps;
+}
+
+double FramePacer::achievedFps() const
+{
+    uint64_t ticks = m_ticks.load(std::memory_order_acquire);
+    int64_t elapsed = m_lastTickNs.load(std::memory_order_relaxed) - m_startNs.load(std::memory_order_relaxed);
+    //第一个节拍在 start 时立即到期，n 个节拍之间只有 n - 1 个周期
+    if (ticks < 2 || elapsed <= 0) {
+        return 0.0;
+    }
+    return static_cast<double>(ticks - 1) * NsPerSecond / static_cast<double>(elapsed);
+}
+
+uint64_t FramePacer::tickCount() const
+{
+    return m_ticks.load(std::memory_order_relaxed);
+}
+
+uint64_t FramePacer::lateCount() const
+{
+    return m_late.load(std::memory_order_relaxed);
+}
+
+uint64_t FramePacer::skippedCount() const
+{
+    return m_skipped.load(std::memory_order_relaxed);
+}
+
+uint64_t FramePacer::duplicateCount() const
+{
+    return m_duplicates.load(std::memory_order_relaxed);
+}
+
+int64_t FramePacer::periodNs() const
+{
+    return m_periodNs;
+}
+
+int64_t FramePacer::monotonicNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * NsPerSecond + ts.tv_nsec;
+}
+
+void FramePacer::sleepUntil(int64_t deadlineNs)
+{
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(deadlineNs / NsPerSecond);
+    ts.tv_nsec = static_cast<long>(deadlineNs % NsPerSecond);
+    //绝对时间睡眠被信号打断后重新调用即可，不会累积误差
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief 基于绝对截止时间的视频帧节拍器
+ *
+ * 替代 appendFrameToList 中 "处理一帧 + msleep(1000 / fps + 1)" 的写法：
+ * 第 n 个节拍的截止时间固定为 start + n * period（CLOCK_MONOTONIC），
+ * 用 clock_nanosleep(TIMER_ABSTIME) 睡到截止时间，处理耗时不会累积成帧率漂移。
+ *
+ * 统计项可在其他线程读取：
+ *   lateCount      处理超时、醒来时已错过截止时间的节拍
+ *   skippedCount   因严重超时被整体跳过的节拍（不补帧，避免之后突发写入）
+ *   duplicateCount 采集端没有新画面、重复写入上一帧画面的节拍
+ */
+class FramePacer
+{
+public:
+    //读取当前时间（纳秒）
+    typedef std::function<int64_t()> NowFunc;
+    //睡眠到绝对截止时间（纳秒）
+    typedef std::function<void(int64_t)> SleepFunc;
+
+    FramePacer();
+
+    /**
+     * @brief 替换时钟与睡眠函数，默认为 monotonicNs 与 clock_nanosleep，测试中注入模拟时钟
+     * 需在 start 之前调用；传入空函数时恢复默认
+     */
+    void setClock(NowFunc now, SleepFunc sleepUntil);
+
+    /**
+     * @brief 以目标帧率开始计时，第一个节拍立即到期
+     */
+    void start(int fps);
+
+    /**
+     * @brief 阻塞到下一个节拍的截止时间
+     * @return 本节拍是否按时（false 表示已错过截止时间，未睡眠）
+     */
+    bool waitNextTick();
+
+    /**
+     * @brief 标记当前节拍写入的是重复画面
+     */
+    void markDuplicate();
+
+    int targetFps() const;
+    /**
+     * @brief 从 start 到最近一个节拍的实际帧率
+     */
+    double achievedFps() const;
+
+    uint64_t tickCount() const;
+    uint64_t lateCount() const;
+    uint64_t skippedCount() const;
+    uint64_t duplicateCount() const;
+
+    int64_t periodNs() const;
+
+    /**
+     * @brief CLOCK_MONOTONIC 当前时间（纳秒）
+     */
+    static int64_t monotonicNs();
+
+private:
+    static void sleepUntil(int64_t deadlineNs);
+
+    NowFunc m_now;
+    SleepFunc m_sleepUntil;
+    int m_fps;
+    int64_t m_periodNs;
+    int64_t m_nextDeadlineNs;
+    std::atomic<int64_t> m_startNs;
+    std::atomic<int64_t> m_lastTickNs;
+    std::atomic<uint64_t> m_ticks;
+    std::atomic<uint64_t> m_late;
+    std::atomic<uint64_t> m_skipped;
+    std::atomic<uint64_t> m_duplicates;
+};
+
+#endif // FRAMEPACER_H
@@ -0,0 +1,393 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "framering.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+FrameRing::FrameRing()
+    : m_slots(nullptr)
+    , m_memory(nullptr)
+    , m_capacity(0)
+    , m_frameBytes(0)
+    , m_policy(DropOldest)
+    , m_head(0)
+    , m_tail(0)
+    , m_pushed(0)
+    , m_dropped(0)
+    , m_closed(false)
+    , m_consumerWaiters(0)
+    , m_producerWaiters(0)
+{
+}
+
+FrameRing::~FrameRing()
+{
+    release();
+}
+
+bool FrameRing::init(int capacity, size_t frameBytes, OverflowPolicy policy)
+{
+    release();
+    //只有一个槽位时"第 index 帧已写好"与"可写入第 index + 1 帧"的序号相同，至少需要两个槽位
+    if (capacity < 2 || frameBytes == 0) {
+        return false;
+    }
+    //每帧按cache line对齐，保证每个槽位的帧数据起始地址对齐
+    size_t alignedBytes = (frameBytes + CacheLineSize - 1) / CacheLineSize * CacheLineSize;
+    void *memory = nullptr;
+    if (posix_memalign(&memory, CacheLineSize, alignedBytes * static_cast<size_t>(capacity)) != 0) {
+        return false;
+    }
+    m_memory = static_cast<unsigned char *>(memory);
+    m_slots = new Slot[static_cast<size_t>(capacity)];
+    for (int i = 0; i < capacity; i++) {
+        m_slots[i].seq.store(static_cast<uint64_t>(i), std::memory_order_relaxed);
+        m_slots[i].time = 0;
+        m_slots[i].width = 0;
+        m_slots[i].height = 0;
+        m_slots[i].stride = 0;
+        m_slots[i].data = m_memory + alignedBytes * static_cast<size_t>(i);
+    }
+    m_capacity = capacity;
+    m_frameBytes = frameBytes;
+    m_policy.store(policy, std::memory_order_relaxed);
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_relaxed);
+    m_pushed.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_release);
+    return true;
+}
+
+void FrameRing::release()
+{
+    delete[] m_slots;
+    m_slots = nullptr;
+    free(m_memory);
+    m_memory = nullptr;
+    m_capacity = 0;
+    m_frameBytes = 0;
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_relaxed);
+}
+
+bool FrameRing::isInit() const
+{
+    return nullptr != m_slots;
+}
+
+FrameRing::Slot &FrameRing::slotAt(uint64_t index) const
+{
+    return m_slots[index % static_cast<uint64_t>(m_capacity)];
+}
+
+void FrameRing::writeSlot(Slot &slot, uint64_t index, const unsigned char *frame,
+                          int width, int height, int stride, int srcStride, int64_t time)
+{
+    //槽位已预分配且会被整帧覆盖，无需memset
+    if (srcStride == stride) {
+        memcpy(slot.data, frame, static_cast<size_t>(height) * static_cast<size_t>(stride));
+    } else {
+        unsigned char *dst = slot.data;
+        for (int row = 0; row < height; row++) {
+            memcpy(dst, frame, static_cast<size_t>(stride));
+            dst += stride;
+            frame += srcStride;
+        }
+    }
+    slot.time = time;
+    slot.width = width;
+    slot.height = height;
+    slot.stride = stride;
+    slot.seq.store(index + 1, std::memory_order_release);
+    m_head.store(index + 1, std::memory_order_release);
+    m_pushed.fetch_add(1, std::memory_order_relaxed);
+    notifyWaiters(m_consumerWaiters, m_frameCond);
+}
+
+void FrameRing::notifyWaiters(std::atomic<int> &waiters, std::condition_variable &cond)
+{
+    //与等待方的 fence 配对：要么等待方看到新状态，要么这里看到等待方已登记
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) > 0) {
+        //加锁保证通知不会落在等待方检查条件与进入wait之间
+        std::lock_guard<std::mutex> locker(m_waitMutex);
+        cond.notify_all();
+    }
+}
+
+bool FrameRing::isSlotFree(const Slot &slot, uint64_t index) const
+{
+    return slot.seq.load(std::memory_order_acquire) == index;
+}
+
+bool FrameRing::hasFrame() const
+{
+    if (!isInit()) {
+        return false;
+    }
+    uint64_t tail = m_tail.load(std::memory_order_acquire);
+    return slotAt(tail).seq.load(std::memory_order_acquire) == tail + 1;
+}
+
+bool FrameRing::push(const unsigned char *frame, int width, int height, int stride, int64_t time, int srcStride)
+{
+    if (srcStride == 0) {
+        srcStride = stride;
+    }
+    if (!isInit() || isClosed() || nullptr == frame || height <= 0 || stride <= 0 || srcStride < stride
+            || static_cast<size_t>(height) * static_cast<size_t>(stride) > m_frameBytes) {
+        return false;
+    }
+    const uint64_t capacity = static_cast<uint64_t>(m_capacity);
+    const uint64_t head = m_head.load(std::memory_order_relaxed);
+    Slot &slot = slotAt(head);
+    if (!isSlotFree(slot, head)) {
+        //缓冲区已满，slot中是第 head - capacity 帧
+        switch (m_policy.load(std::memory_order_relaxed)) {
+        case DropOldest: {
+            //与消费者竞争最旧的一帧：抢到则直接覆盖，抢不到说明消费者正在读取该帧，只能丢弃当前帧
+            uint64_t oldest = head - capacity;
+            if (!m_tail.compare_exchange_strong(oldest, oldest + 1, std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        case DropNewest:
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        case Block: {
+            std::unique_lock<std::mutex> locker(m_waitMutex);
+            m_producerWaiters.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_spaceCond.wait(locker, [&]() {
+                return isSlotFree(slot, head) || isClosed();
+            });
+            m_producerWaiters.fetch_sub(1, std::memory_order_relaxed);
+            if (!isSlotFree(slot, head)) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            break;
+        }
+        }
+    }
+    writeSlot(slot, head, frame, width, height, stride, srcStride, time);
+    return true;
+}
+
+FrameRing::Slot *FrameRing::claim(uint64_t &index)
+{
+    if (!isInit()) {
+        return nullptr;
+    }
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot *slot = &slotAt(tail);
+        if (slot->seq.load(std::memory_order_acquire) != tail + 1) {
+            return nullptr;
+        }
+        //DropOldest策略下生产者可能同时在回收该槽位，需CAS认领
+        if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel,
+                                         std::memory_order_relaxed)) {
+            index = tail;
+            return slot;
+        }
+    }
+}
+
+void FrameRing::recycle(Slot *slot, uint64_t index)
+{
+    //归还槽位，供第 index + capacity 帧写入
+    slot->seq.store(index + static_cast<uint64_t>(m_capacity), std::memory_order_release);
+    notifyWaiters(m_producerWaiters, m_spaceCond);
+}
+
+bool FrameRing::waitForFrame(int timeoutMs)
+{
+    if (hasFrame()) {
+        return true;
+    }
+    std::unique_lock<std::mutex> locker(m_waitMutex);
+    m_consumerWaiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    m_frameCond.wait_for(locker, std::chrono::milliseconds(timeoutMs > 0 ? timeoutMs : 0), [this]() {
+        return hasFrame() || isClosed();
+    });
+    m_consumerWaiters.fetch_sub(1, std::memory_order_relaxed);
+    return hasFrame();
+}
+
+void FrameRing::close()
+{
+    {
+        std::lock_guard<std::mutex> locker(m_waitMutex);
+        m_closed.store(true, std::memory_order_release);
+    }
+    m_frameCond.notify_all();
+    m_spaceCond.notify_all();
+}
+
+void FrameRing::reopen()
+{
+    m_closed.store(false, std::memory_order_release);
+}
+
+bool FrameRing::isClosed() const
+{
+    return m_closed.load(std::memory_order_acquire);
+}
+
+bool FrameRing::pop(unsigned char *dst, int &width, int &height, int &stride, int64_t &time)
+{
+    if (nullptr == dst) {
+        return false;
+    }
+    uint64_t index = 0;
+    Slot *slot = claim(index);
+    if (nullptr == slot) {
+        return false;
+    }
+    memcpy(dst, slot->data, static_cast<size_t>(slot->height) * static_cast<size_t>(slot->stride));
+    width = slot->width;
+    height = slot->height;
+    stride = slot->stride;
+    time = slot->time;
+    recycle(slot, index);
+    return true;
+}
+
+bool FrameRing::acquire(Lease &lease)
+{
+    lease.release();
+    uint64_t index = 0;
+    Slot *slot = claim(index);
+    if (nullptr == slot) {
+        return false;
+    }
+    lease.m_ring = this;
+    lease.m_slot = slot;
+    lease.m_index = index;
+    return true;
+}
+
+int FrameRing::size() const
+{
+    uint64_t tail = m_tail.load(std::memory_order_acquire);
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    return head > tail ? static_cast<int>(head - tail) : 0;
+}
+
+bool FrameRing::isEmpty() const
+{
+    return size() == 0;
+}
+
+int FrameRing::capacity() const
+{
+    return m_capacity;
+}
+
+size_t FrameRing::frameBytes() const
+{
+    return m_frameBytes;
+}
+
+FrameRing::OverflowPolicy FrameRing::policy() const
+{
+    return static_cast<OverflowPolicy>(m_policy.load(std::memory_order_relaxed));
+}
+
+void FrameRing::setPolicy(OverflowPolicy policy)
+{
+    m_policy.store(policy, std::memory_order_relaxed);
+}
+
+uint64_t FrameRing::pushedCount() const
+{
+    return m_pushed.load(std::memory_order_relaxed);
+}
+
+uint64_t FrameRing::droppedCount() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+FrameRing::Lease::Lease()
+    : m_ring(nullptr)
+    , m_slot(nullptr)
+    , m_index(0)
+{
+}
+
+FrameRing::Lease::~Lease()
+{
+    release();
+}
+
+FrameRing::Lease::Lease(Lease &&other) noexcept
+    : m_ring(other.m_ring)
+    , m_slot(other.m_slot)
+    , m_index(other.m_index)
+{
+    other.m_ring = nullptr;
+    other.m_slot = nullptr;
+}
+
+FrameRing::Lease &FrameRing::Lease::operator=(Lease &&other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_ring = other.m_ring;
+        m_slot = other.m_slot;
+        m_index = other.m_index;
+        other.m_ring = nullptr;
+        other.m_slot = nullptr;
+    }
+    return *this;
+}
+
+bool FrameRing::Lease::isValid() const
+{
+    return nullptr != m_slot;
+}
+
+void FrameRing::Lease::release()
+{
+    if (nullptr != m_ring && nullptr != m_slot) {
+        m_ring->recycle(m_slot, m_index);
+    }
+    m_ring = nullptr;
+    m_slot = nullptr;
+}
+
+unsigned char *FrameRing::Lease::data() const
+{
+    return m_slot ? m_slot->data : nullptr;
+}
+
+int FrameRing::Lease::width() const
+{
+    return m_slot ? m_slot->width : 0;
+}
+
+int FrameRing::Lease::height() const
+{
+    return m_slot ? m_slot->height : 0;
+}
+
+int FrameRing::Lease::stride() const
+{
+    return m_slot ? m_slot->stride : 0;
+}
+
+int64_t FrameRing::Lease::time() const
+{
+    return m_slot ? m_slot->time : 0;
+}
@@ -0,0 +1,205 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief 单生产者/单消费者(SPSC)无锁视频帧环形缓冲区
+ *
+ * 替代原先 m_mutex 保护下的帧链表与空闲内存链表：
+ * 槽位和帧内存在 init 时一次性预分配，录制过程中不再申请、释放内存；
+ * 生产者（appendBuffer）与消费者（getFrame）之间只通过每个槽位的原子序号同步。
+ *
+ * 序号约定（index 为单调递增的写入/读取序号）：
+ *   seq == index      槽位空闲，可写入第 index 帧
+ *   seq == index + 1  第 index 帧已写好，可读取
+ *
+ * 消费者可以通过 acquire 租借槽位（Lease），直接读取槽位内存而无需再拷贝一次，
+ * Lease 析构时槽位自动归还给生产者。
+ *
+ * 缓冲区为空时消费者调用 waitForFrame 阻塞等待，而不是空转；
+ * 停止录制时生产者调用 close，消费者取完剩余帧后 waitForFrame 立即返回 false。
+ * 只有确实有线程在等待时才会加锁通知，快路径上仍然无锁。
+ */
+class FrameRing
+{
+    struct Slot;
+
+public:
+    /**
+     * @brief 缓冲区满时的处理策略
+     */
+    enum OverflowPolicy {
+        DropOldest = 0, // 丢弃最旧的一帧，写入当前帧（与原帧链表的行为一致）
+        DropNewest,     // 丢弃当前要写入的帧
+        Block           // 等待消费者腾出槽位
+    };
+
+    static constexpr size_t CacheLineSize = 64;
+
+    /**
+     * @brief 槽位租约，RAII管理：持有期间槽位不会被生产者覆盖，析构或release时归还
+     *
+     * 租约只能移动不能拷贝，必须在 FrameRing::release 之前释放。
+     * 持有租约期间若缓冲区写满，DropOldest 策略会退化为丢弃新帧。
+     */
+    class Lease
+    {
+    public:
+        Lease();
+        ~Lease();
+        Lease(Lease &&other) noexcept;
+        Lease &operator=(Lease &&other) noexcept;
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+
+        bool isValid() const;
+        /**
+         * @brief 归还槽位，之后 data() 不可再访问
+         */
+        void release();
+
+        //槽位内存只读，供编码器直接引用
+        unsigned char *data() const;
+        int width() const;
+        int height() const;
+        int stride() const;
+        int64_t time() const;
+
+    private:
+        friend class FrameRing;
+        FrameRing *m_ring;
+        Slot *m_slot;
+        uint64_t m_index;
+    };
+
+    FrameRing();
+    ~FrameRing();
+
+    FrameRing(const FrameRing &) = delete;
+    FrameRing &operator=(const FrameRing &) = delete;
+
+    /**
+     * @brief 预分配槽位和帧内存，必须在生产者/消费者开始工作前调用
+     * @param capacity 槽位数量，至少为2
+     * @param frameBytes 单帧最大字节数（height * stride）
+     * @param policy 缓冲区满时的处理策略
+     */
+    bool init(int capacity, size_t frameBytes, OverflowPolicy policy = DropOldest);
+
+    /**
+     * @brief 释放所有槽位内存，调用时生产者和消费者必须都已停止
+     */
+    void release();
+
+    bool isInit() const;
+
+    /**
+     * @brief 生产者写入一帧（拷贝 frame 中 height * stride 字节）
+     * @param srcStride frame 每行的字节数，大于 stride 时逐行拷贝每行的前 stride 字节，
+     *        用于直接从整屏画面中截取录制区域；0 表示与 stride 相同
+     * @return 当前帧是否写入缓冲区
+     */
+    bool push(const unsigned char *frame, int width, int height, int stride, int64_t time, int srcStride = 0);
+
+    /**
+     * @brief 消费者取出最旧的一帧，拷贝到 dst
+     * @param dst 目标内存，大小不小于 frameBytes()
+     * @return 缓冲区为空时返回 false
+     */
+    bool pop(unsigned char *dst, int &width, int &height, int &stride, int64_t &time);
+
+    /**
+     * @brief 消费者租借最旧的一帧，不拷贝帧数据
+     * @param lease 租约，原先持有的槽位会先被归还
+     * @return 缓冲区为空时返回 false
+     */
+    bool acquire(Lease &lease);
+
+    /**
+     * @brief 消费者等待新帧
+     * @param timeoutMs 最长等待时间（毫秒）
+     * @return 有可读帧时返回 true；超时或已 close 且缓冲区为空时返回 false
+     */
+    bool waitForFrame(int timeoutMs);
+
+    /**
+     * @brief 生产者声明不再写入，唤醒所有等待中的消费者/生产者
+     * 之后 push 均返回 false，消费者仍可取完缓冲区中剩余的帧
+     */
+    void close();
+
+    /**
+     * @brief 重新允许写入，开始新一次录制前调用
+     */
+    void reopen();
+
+    bool isClosed() const;
+
+    int size() const;
+    bool isEmpty() const;
+    int capacity() const;
+    size_t frameBytes() const;
+
+    OverflowPolicy policy() const;
+    void setPolicy(OverflowPolicy policy);
+
+    /**
+     * @brief 已写入缓冲区的帧数
+     */
+    uint64_t pushedCount() const;
+
+    /**
+     * @brief 因缓冲区满而丢弃的帧数（包括被覆盖的旧帧和被拒绝的新帧）
+     */
+    uint64_t droppedCount() const;
+
+private:
+    struct alignas(CacheLineSize) Slot {
+        std::atomic<uint64_t> seq;
+        int64_t time;
+        int width;
+        int height;
+        int stride;
+        unsigned char *data;
+    };
+
+    Slot &slotAt(uint64_t index) const;
+    Slot *claim(uint64_t &index);
+    void recycle(Slot *slot, uint64_t index);
+    bool isSlotFree(const Slot &slot, uint64_t index) const;
+    bool hasFrame() const;
+    void notifyWaiters(std::atomic<int> &waiters, std::condition_variable &cond);
+    void writeSlot(Slot &slot, uint64_t index, const unsigned char *frame,
+                   int width, int height, int stride, int srcStride, int64_t time);
+
+    Slot *m_slots;
+    unsigned char *m_memory;
+    int m_capacity;
+    size_t m_frameBytes;
+    std::atomic<int> m_policy;
+
+    //生产者写序号与消费者读序号分别独占一个cache line，避免伪共享
+    alignas(CacheLineSize) std::atomic<uint64_t> m_head;
+    alignas(CacheLineSize) std::atomic<uint64_t> m_tail;
+    alignas(CacheLineSize) std::atomic<uint64_t> m_pushed;
+    std::atomic<uint64_t> m_dropped;
+
+    //阻塞等待只在慢路径上使用：m_xxxWaiters 非0时才需要加锁通知
+    std::atomic<bool> m_closed;
+    std::atomic<int> m_consumerWaiters;
+    std::atomic<int> m_producerWaiters;
+    std::mutex m_waitMutex;
+    std::condition_variable m_frameCond;
+    std::condition_variable m_spaceCond;
+};
+
+#endif // FRAMERING_H
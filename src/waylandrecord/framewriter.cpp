@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "framewriter.h"
+#include "../utils/recordingstats.h"
+
+bool FrameWriter::acquire(FrameRing &ring, FrameRing::Lease &lease, WaylandFrame &frame, int &index)
+{
+    if (!ring.acquire(lease)) {
+        frame._width = 0;
+        frame._height = 0;
+        frame._frame = nullptr;
+        return false;
+    }
+    frame._width = lease.width();
+    frame._height = lease.height();
+    frame._stride = lease.stride();
+    frame._time = lease.time();
+    frame._frame = lease.data();
+    frame._index = index++;
+    return true;
+}
+
+bool FrameWriter::write(const WriteFunc &writeFrame, WaylandFrame &frame, FrameRing::Lease &lease)
+{
+    const bool written = writeFrame(frame) >= 0;
+    if (!written) {
+        RecordingStats::instance()->addCounter(RecordingStats::EncodeFailed);
+    }
+    //编码器已经转换完画面，槽位归还给采集端
+    lease.release();
+    return written;
+}
@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FRAMEWRITER_H
+#define FRAMEWRITER_H
+
+#include "framering.h"
+#include "waylandframe.h"
+
+#include <functional>
+
+/**
+ * @brief 写帧线程从 FrameRing 取帧、交给编码器的步骤，与 KWayland 无关，便于单独测试
+ *
+ * WaylandIntegrationPrivate::getFrame 和 WriteFrameThread::run 都由它实现，
+ * 录制基准测试也用它驱动 CAVOutputStream。
+ */
+class FrameWriter
+{
+public:
+    typedef std::function<int(WaylandFrame &frame)> WriteFunc;
+
+    /**
+     * @brief 租用最旧的一帧（先进先出）并填写 frame，直接引用槽位内存，不拷贝
+     * @param index 帧序号，成功时写入 frame._index 后递增
+     * @return 缓冲区为空时返回 false，此时 frame 的画面为空，lease 无效，index 不变
+     */
+    static bool acquire(FrameRing &ring, FrameRing::Lease &lease, WaylandFrame &frame, int &index);
+
+    /**
+     * @brief 把租用的一帧交给 writeFrame，写完立即归还槽位
+     * writeFrame 返回负数时计入 RecordingStats::EncodeFailed
+     * @return 是否写入成功
+     */
+    static bool write(const WriteFunc &writeFrame, WaylandFrame &frame, FrameRing::Lease &lease);
+};
+
+#endif // FRAMEWRITER_H
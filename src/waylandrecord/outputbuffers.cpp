@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "outputbuffers.h"
+
+#include <initializer_list>
+#include <utility>
+
+quint32 OutputBuffers::outputKey(const QHash<const void *, quint32> &names, const void *output, const QRect &geometry)
+{
+    auto itr = names.constFind(output);
+    if (itr != names.constEnd()) {
+        return itr.value();
+    }
+    return static_cast<quint32>(qHash(qMakePair(geometry.x(), geometry.y()))) | 0x80000000u;
+}
+
+int OutputBuffers::expectedCount(int screenCount, bool screenExtension)
+{
+    return (screenCount == 1 || !screenExtension) ? 1 : screenCount;
+}
+
+int OutputBuffers::readyCount(const Map &buffers)
+{
+    int count = 0;
+    for (auto itr = buffers.constBegin(); itr != buffers.constEnd(); ++itr) {
+        if (itr->_ready) {
+            count++;
+        }
+    }
+    return count;
+}
+
+unsigned char *OutputBuffers::staging(Map &buffers, quint32 key, size_t bytes, bool &reallocated)
+{
+    OutputBuffer &buffer = buffers[key];
+    reallocated = buffer._bytes != bytes;
+    if (reallocated) {
+        //被租用的缓冲仍在锁外读取，归还时再释放
+        for (unsigned char *old : {buffer._staging, buffer._published, buffer._spare}) {
+            if (old && old == buffer._leased) {
+                buffer._retired = old;
+            } else {
+                delete[] old;
+            }
+        }
+        buffer._staging = new unsigned char[bytes];
+        buffer._published = new unsigned char[bytes];
+        buffer._spare = nullptr;
+        buffer._bytes = bytes;
+        buffer._ready = false;
+        buffer._hasFrame = false;
+    }
+    return buffer._staging;
+}
+
+OutputBuffer &OutputBuffers::publish(Map &buffers, quint32 key)
+{
+    OutputBuffer &buffer = buffers[key];
+    if (buffer._leased && buffer._leased == buffer._published) {
+        //被租用的画面移到 _spare，下次交换不会写入它
+        if (!buffer._spare) {
+            buffer._spare = new unsigned char[buffer._bytes];
+        }
+        unsigned char *leased = buffer._published;
+        buffer._published = buffer._staging;
+        buffer._staging = buffer._spare;
+        buffer._spare = leased;
+    } else {
+        std::swap(buffer._staging, buffer._published);
+    }
+    buffer._serial++;
+    buffer._ready = true;
+    buffer._hasFrame = true;
+    return buffer;
+}
+
+const OutputBuffer *OutputBuffers::reuseLast(Map &buffers, quint32 key)
+{
+    auto itr = buffers.find(key);
+    if (itr == buffers.end() || !itr->_hasFrame) {
+        return nullptr;
+    }
+    //上一帧仍保存在 _published 中，标记为可用即可，无需再拷贝
+    itr->_ready = true;
+    return &itr.value();
+}
+
+void OutputBuffers::drop(Map &buffers, quint32 key)
+{
+    auto itr = buffers.find(key);
+    if (itr != buffers.end()) {
+        itr->_ready = false;
+        itr->_hasFrame = false;
+    }
+}
+
+const OutputBuffer *OutputBuffers::lease(Map &buffers, quint32 key)
+{
+    auto itr = buffers.find(key);
+    if (itr == buffers.end() || !itr->_hasFrame || itr->_leased) {
+        return nullptr;
+    }
+    itr->_leased = itr->_published;
+    return &itr.value();
+}
+
+void OutputBuffers::endLease(Map &buffers, quint32 key)
+{
+    auto itr = buffers.find(key);
+    if (itr == buffers.end()) {
+        return;
+    }
+    delete[] itr->_retired;
+    itr->_retired = nullptr;
+    itr->_leased = nullptr;
+}
+
+void OutputBuffers::release(Map &buffers)
+{
+    for (auto itr = buffers.begin(); itr != buffers.end(); ++itr) {
+        delete[] itr->_staging;
+        delete[] itr->_published;
+        delete[] itr->_spare;
+        delete[] itr->_retired;
+    }
+    buffers.clear();
+}
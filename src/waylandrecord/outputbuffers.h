@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef OUTPUTBUFFERS_H
+#define OUTPUTBUFFERS_H
+
+#include <QHash>
+#include <QImage>
+#include <QMap>
+#include <QRect>
+
+#include <cstddef>
+
+namespace KWayland {
+namespace Client {
+class RemoteBuffer;
+}
+}
+
+/**
+ * @brief 单个输出（屏幕）的采集缓冲，按 wl_output 的注册名索引，支持任意数量的屏幕
+ * _staging 只由采集线程写入，写完后在 m_bGetScreenImageMutex 保护下与 _published 交换，
+ * 取帧线程只读取 _published。内存在首次采集（或分辨率变化）时分配，录制过程中复用。
+ * 取帧线程可以租用 _published 后在锁外读取：租用期间它不会再被交换成暂存缓冲，
+ * 采集线程改用 _spare 继续写入。
+ */
+struct OutputBuffer {
+    QRect _rect;
+    quint32 _width = 0;
+    quint32 _height = 0;
+    quint32 _stride = 0;
+    QImage::Format _format = QImage::Format_RGBA8888;
+    size_t _bytes = 0;
+    unsigned char *_staging = nullptr;
+    unsigned char *_published = nullptr;
+    //租用期间代替被租用的缓冲参与交换，租用期间分配
+    unsigned char *_spare = nullptr;
+    //被取帧线程租用、锁外读取中的缓冲，为 _published 或 _spare
+    const unsigned char *_leased = nullptr;
+    //租用期间重新分配时暂不释放的旧缓冲，归还时释放
+    unsigned char *_retired = nullptr;
+    //_published 中画面的代数，每次采集到新画面递增，合成时未变化的屏幕跳过拷贝
+    quint64 _serial = 0;
+    //_published 中有尚未合成的画面
+    bool _ready = false;
+    //_published 中已有画面，远程buffer没有送来新数据时沿用
+    bool _hasFrame = false;
+    //收到的buffer数，用于抽帧
+    quint64 _receivedCount = 0;
+    //等待拷贝的远程buffer（KWAYLAND_REMOTE_BUFFER_RELEASE_FLAGE_ON）
+    KWayland::Client::RemoteBuffer *_pendingBuf = nullptr;
+};
+
+/**
+ * @brief hw 机器多屏采集缓冲的簿记，与 KWayland 无关，便于单独测试
+ *
+ * 只操作调用方传入的容器，不加锁：调用方需持有保护容器的锁（m_bGetScreenImageMutex）。
+ */
+class OutputBuffers
+{
+public:
+    typedef QMap<quint32, OutputBuffer> Map;
+
+    /**
+     * @brief 由 bufferReady 给出的 wl_output 查找输出的注册名
+     * 未经 addOutput/bindOutput 绑定的输出按其位置生成键值，最高位置 1 避免与注册名冲突
+     */
+    static quint32 outputKey(const QHash<const void *, quint32> &names, const void *output, const QRect &geometry);
+
+    /**
+     * @brief 合成一帧需要的输出数量，单屏或复制模式为 1
+     */
+    static int expectedCount(int screenCount, bool screenExtension);
+
+    /**
+     * @brief 已有待合成画面的输出数量
+     */
+    static int readyCount(const Map &buffers);
+
+    /**
+     * @brief 取 key 的暂存缓冲；首次采集或大小变为 bytes 时重新分配两块缓冲，此时输出没有可用的画面
+     * @param reallocated 返回是否重新分配，之前的 _published 已释放
+     */
+    static unsigned char *staging(Map &buffers, quint32 key, size_t bytes, bool &reallocated);
+
+    /**
+     * @brief 暂存缓冲写完后与 _published 交换，代数加 1 并标记为待合成；画面的尺寸等由调用方填写
+     * _published 被租用时改为与 _spare 轮换，被租用的缓冲不会成为暂存缓冲
+     */
+    static OutputBuffer &publish(Map &buffers, quint32 key);
+
+    /**
+     * @brief 远程buffer没有送来新数据时沿用上一帧：已有画面时标记为待合成，代数不变
+     * @return 沿用的缓冲，输出不存在或还没有画面时返回 nullptr
+     */
+    static const OutputBuffer *reuseLast(Map &buffers, quint32 key);
+
+    /**
+     * @brief 输出被移除后不再参与合成；拷贝线程可能仍在使用缓冲，内存在 release 时统一释放
+     */
+    static void drop(Map &buffers, quint32 key);
+
+    /**
+     * @brief 租用 key 当前的画面，调用方释放锁后读取，读完在锁内调用 endLease 归还
+     * 画面在 _leased 中，调用方需在锁内取出它和尺寸等字段；同一输出同时只能有一个租用
+     * @return 画面所在的缓冲，输出不存在、还没有画面或已被租用时返回 nullptr
+     */
+    static const OutputBuffer *lease(Map &buffers, quint32 key);
+
+    /**
+     * @brief 归还 lease 租用的画面；租用期间重新分配过时释放旧缓冲
+     */
+    static void endLease(Map &buffers, quint32 key);
+
+    /**
+     * @brief 释放所有输出的缓冲并清空容器，调用方需保证没有未归还的租用
+     */
+    static void release(Map &buffers);
+};
+
+#endif // OUTPUTBUFFERS_H
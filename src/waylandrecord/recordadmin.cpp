@@ -14,6 +14,7 @@
 #include <qtimer.h>
 #include <QDebug>
 #include "../utils/log.h"
+#include "../utils/configsettings.h"
 
 #include "utils.h"
 
@@ -49,10 +50,8 @@ RecordAdmin::RecordAdmin(QStringList list, WaylandIntegration::WaylandIntegratio
         m_filePath = m_filePath.replace("gif", "mp4");
         qCDebug(dsrApp) << "GIF mode detected, adjusted settings - FPS:" << m_fps << "File:" << m_filePath;
     }
-    m_pInputStream  = new CAVInputStream(context);
-    m_pOutputStream = new CAVOutputStream(context);
-    avlibInterface::m_avcodec_register_all();
-    avlibInterface::m_av_register_all();
+    m_pOutputStream = new CAVOutputStream();
+    m_pInputStream  = new CAVInputStream(m_pOutputStream);
     avlibInterface::m_avdevice_register_all();
     m_writeFrameThread = new WriteFrameThread(context);
     qCDebug(dsrApp) << "RecordAdmin initialization completed";
@@ -142,12 +141,35 @@ void RecordAdmin::init(int screenWidth, int screenHeight)
         qCDebug(dsrApp) << "Adjusted height due to bottom boundary:" << m_selectHeight;
     }
     setRecordAudioType(m_audioType);
+    //以开始录制的时刻为音视频时间戳的起点，输出流打开前采集到的帧也不会被截到起点
+    m_pOutputStream->captureClock().start();
     QtConcurrent::run(this, &RecordAdmin::startStream);
 
 //    pthread_create(&m_mainThread, nullptr, stream, static_cast<void *>(this));
 //    pthread_detach(m_mainThread);
 }
 
+QRect RecordAdmin::captureRegion(int screenWidth, int screenHeight) const
+{
+    int x = qBound(0, m_x, screenWidth);
+    int y = qBound(0, m_y, screenHeight);
+    //录屏不支持奇数，转偶数
+    int width = qMin(m_selectWidth, screenWidth - x) / 2 * 2;
+    int height = qMin(m_selectHeight, screenHeight - y) / 2 * 2;
+    return QRect(x, y, width, height);
+}
+
+void RecordAdmin::initCropped(const QRect &region)
+{
+    qCDebug(dsrApp) << "Initializing RecordAdmin with frames cropped at capture:" << region;
+    //采集到的帧已经是录制区域，原点移到 (0, 0)，编码端裁剪量均为 0
+    m_x = 0;
+    m_y = 0;
+    m_selectWidth = region.width();
+    m_selectHeight = region.height();
+    init(region.width(), region.height());
+}
+
 int RecordAdmin::startStream()
 {
     qCInfo(dsrApp) << "Starting recording stream";
@@ -182,6 +204,12 @@ int RecordAdmin::startStream()
         qCWarning(dsrApp) << "Failed to get audio card information";
     }
     
+    ConfigSettings *settings = ConfigSettings::instance();
+    m_pOutputStream->setVideoEncoderOptions(CAVOutputStream::videoEncoderOptionsFromSettings(settings));
+    m_pOutputStream->setAudioMixGains(settings->getValue("recorder", "mix_mic_gain").toFloat(),
+                                      settings->getValue("recorder", "mix_sys_gain").toFloat());
+    m_pOutputStream->setFragmentDuration(settings->getValue("recorder", "fragment_seconds").toInt());
+
     qInfo() << "打开输出!";
     bRet = m_pOutputStream->open(m_filePath);
     if (!bRet) {
@@ -237,6 +265,10 @@ int RecordAdmin::stopStream()
     //设置是否写混音,此时采集音频流并将音频流写入音频fifo缓冲区
     m_pInputStream->setbWriteAmix(false);
     qCDebug(dsrApp) << "Audio mixing stopped";
+
+    //等待音频线程写完最后一帧并退出，关闭输出时不再有线程写入
+    m_pInputStream->onsFinisheStream();
+    qCDebug(dsrApp) << "Audio threads joined";
     
     //设置是否写音频帧，此时将音频缓冲区的数据写入到输出媒体文件
     m_pOutputStream->setIsWriteFrame(false);
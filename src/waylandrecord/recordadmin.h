@@ -45,6 +45,20 @@ public:
      */
     void init(int screenWidth, int screenHeight);
 
+    /**
+     * @brief captureRegion:录制区域，已裁剪到原图范围内，宽高为偶数
+     * @param screenWidth:原图宽度
+     * @param screenHeight:原图高度
+     * @return 录制区域
+     */
+    QRect captureRegion(int screenWidth, int screenHeight) const;
+
+    /**
+     * @brief initCropped:采集端已按录制区域裁剪时初始化录屏管理，编码端不再裁剪
+     * @param region:录制区域（captureRegion 的返回值）
+     */
+    void initCropped(const QRect &region);
+
     /**
      * @brief stopStream:停止录屏
      * @return
@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef REUSEPOOL_H
+#define REUSEPOOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 混音路径复用帧和样本缓冲区的策略，与 FFmpeg 无关，便于单独测试稳态下不再申请内存
+ *
+ * 池中最多保存 maxSize 个对象，acquire 优先返回空闲的对象，没有空闲对象时新建，池满后让第一个对象重新变为空闲
+ * （如 av_frame_make_writable 复制出新的缓冲区）。新建和重新变为空闲都计入 allocCount。
+ * 对象的判断、创建和释放由调用方传入，acquire 只在混音线程调用。
+ */
+template <typename T>
+class ReusePool
+{
+public:
+    explicit ReusePool(int maxSize)
+        : m_maxSize(maxSize)
+        , m_allocCount(0)
+    {
+    }
+
+    ReusePool(const ReusePool &) = delete;
+    ReusePool &operator=(const ReusePool &) = delete;
+
+    /**
+     * @param isFree bool(const T &)，对象是否可以复用
+     * @param create bool(T &)，新建对象，失败返回 false
+     * @param makeFree bool(T &)，池满时让对象重新可用，失败返回 false
+     * @return 失败时返回 false，item 不变
+     */
+    template <typename IsFree, typename Create, typename MakeFree>
+    bool acquire(T &item, IsFree isFree, Create create, MakeFree makeFree)
+    {
+        for (const T &pooled : m_items) {
+            if (isFree(pooled)) {
+                item = pooled;
+                return true;
+            }
+        }
+        if (static_cast<int>(m_items.size()) < m_maxSize) {
+            T created;
+            if (!create(created)) {
+                return false;
+            }
+            m_allocCount++;
+            m_items.push_back(created);
+            item = created;
+            return true;
+        }
+        if (m_items.empty() || !makeFree(m_items.front())) {
+            return false;
+        }
+        m_allocCount++;
+        item = m_items.front();
+        return true;
+    }
+
+    /**
+     * @param destroy void(T &)，释放对象
+     */
+    template <typename Destroy>
+    void clear(Destroy destroy)
+    {
+        for (T &item : m_items) {
+            destroy(item);
+        }
+        m_items.clear();
+    }
+
+    int size() const
+    {
+        return static_cast<int>(m_items.size());
+    }
+
+    /**
+     * @brief 新建或重新变为空闲的次数，任意线程可调用
+     */
+    uint64_t allocCount() const
+    {
+        return m_allocCount.load();
+    }
+
+    void resetAllocCount()
+    {
+        m_allocCount.store(0);
+    }
+
+private:
+    std::vector<T> m_items;
+    int m_maxSize;
+    std::atomic<uint64_t> m_allocCount;
+};
+
+/**
+ * @brief 只增不减的缓冲区容量：needed 不超过 capacity 时直接复用，否则调用 grow(needed) 重新分配
+ * @param grow bool(int needed)，调用时 capacity 仍为旧容量，失败返回 false
+ * @return grow 失败时返回 false，capacity 置 0
+ */
+template <typename Grow>
+bool growCapacity(int &capacity, int needed, Grow grow)
+{
+    if (capacity >= needed) {
+        return true;
+    }
+    if (!grow(needed)) {
+        capacity = 0;
+        return false;
+    }
+    capacity = needed;
+    return true;
+}
+
+#endif // REUSEPOOL_H
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "slicepool.h"
+
+#include <algorithm>
+
+SlicePool::SlicePool(int threads)
+    : m_job(nullptr)
+    , m_slices(0)
+    , m_nextSlice(0)
+    , m_pendingSlices(0)
+    , m_generation(0)
+    , m_quit(false)
+{
+    const int workers = std::max(threads, 1) - 1;
+    m_workers.reserve(static_cast<size_t>(workers));
+    for (int i = 0; i < workers; i++) {
+        m_workers.emplace_back(&SlicePool::workerLoop, this);
+    }
+}
+
+SlicePool::~SlicePool()
+{
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_quit = true;
+    }
+    m_startCond.notify_all();
+    for (std::thread &worker : m_workers) {
+        worker.join();
+    }
+}
+
+void SlicePool::run(int slices, const SliceJob &job)
+{
+    if (slices <= 0) {
+        return;
+    }
+    if (m_workers.empty() || slices == 1) {
+        for (int i = 0; i < slices; i++) {
+            job(i);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_job = &job;
+        m_slices = slices;
+        m_nextSlice = 0;
+        m_pendingSlices = slices;
+        m_generation++;
+    }
+    m_startCond.notify_all();
+    //调用线程也领取条带，而不是空等
+    runSlices();
+    std::unique_lock<std::mutex> locker(m_mutex);
+    m_doneCond.wait(locker, [this] { return m_pendingSlices == 0; });
+    m_job = nullptr;
+}
+
+void SlicePool::runSlices()
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    while (m_nextSlice < m_slices) {
+        const int index = m_nextSlice++;
+        const SliceJob *job = m_job;
+        locker.unlock();
+        (*job)(index);
+        locker.lock();
+        if (--m_pendingSlices == 0) {
+            m_doneCond.notify_one();
+        }
+    }
+}
+
+void SlicePool::workerLoop()
+{
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            m_startCond.wait(locker, [&] { return m_quit || m_generation != seenGeneration; });
+            if (m_quit) {
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+        runSlices();
+    }
+}
+
+int SlicePool::threadCount() const
+{
+    return static_cast<int>(m_workers.size()) + 1;
+}
+
+int SlicePool::defaultThreadCount(int maxThreads)
+{
+    const int cores = static_cast<int>(std::thread::hardware_concurrency());
+    //留出一个核心给采集和音频线程
+    return std::max(1, std::min(maxThreads, cores - 1));
+}
+
+void SlicePool::sliceRange(int height, int slices, int index, int align, int &y, int &rows)
+{
+    y = 0;
+    rows = 0;
+    if (height <= 0 || slices <= 0 || index < 0 || index >= slices) {
+        return;
+    }
+    align = std::max(align, 1);
+    const int units = (height + align - 1) / align;
+    const int begin = static_cast<int>(static_cast<int64_t>(units) * index / slices) * align;
+    const int end = std::min(height, static_cast<int>(static_cast<int64_t>(units) * (index + 1) / slices) * align);
+    y = std::min(begin, height);
+    rows = std::max(0, end - y);
+}
@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SLICEPOOL_H
+#define SLICEPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 按水平条带并行处理一帧画面的小型线程池
+ *
+ * 编码线程调用 run 后自己也参与处理，所有条带完成后 run 才返回，
+ * 因此条带任务可以直接引用调用方栈上的数据。
+ * 录屏进程中 QThreadPool::globalInstance() 已被若干常驻任务占满（见 RecordProcess），
+ * 这里使用独立的线程，避免每帧的转换任务排队等待。
+ */
+class SlicePool
+{
+public:
+    /**
+     * @brief 条带任务，index 为条带序号，取值 [0, slices)
+     */
+    typedef std::function<void(int index)> SliceJob;
+
+    /**
+     * @param threads 参与处理的线程总数（包含调用 run 的线程），小于 1 时按 1 处理
+     */
+    explicit SlicePool(int threads);
+    ~SlicePool();
+    SlicePool(const SlicePool &) = delete;
+    SlicePool &operator=(const SlicePool &) = delete;
+
+    /**
+     * @brief 并行执行 slices 个条带任务，全部完成后返回
+     */
+    void run(int slices, const SliceJob &job);
+
+    int threadCount() const;
+
+    /**
+     * @brief 根据 CPU 核心数给出默认线程数，最多 maxThreads 个
+     */
+    static int defaultThreadCount(int maxThreads = 4);
+
+    /**
+     * @brief 将 height 行均分为 slices 个条带，每个条带的起始行和行数都是 align 的整数倍（最后一个条带除外）
+     * @param index 条带序号
+     * @param y 条带起始行
+     * @param rows 条带行数，可能为 0
+     */
+    static void sliceRange(int height, int slices, int index, int align, int &y, int &rows);
+
+private:
+    void workerLoop();
+    void runSlices();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_startCond;
+    std::condition_variable m_doneCond;
+    const SliceJob *m_job;
+    int m_slices;
+    int m_nextSlice;
+    int m_pendingSlices;
+    uint64_t m_generation;
+    bool m_quit;
+};
+
+#endif // SLICEPOOL_H
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stagequeue.h"
+
+StageStats::StageStats()
+{
+    reset();
+}
+
+void StageStats::reset()
+{
+    m_count.store(0, std::memory_order_relaxed);
+    m_waitTotalNs.store(0, std::memory_order_relaxed);
+    m_waitMaxNs.store(0, std::memory_order_relaxed);
+    m_processTotalNs.store(0, std::memory_order_relaxed);
+    m_processMaxNs.store(0, std::memory_order_relaxed);
+    m_depth.store(0, std::memory_order_relaxed);
+    m_maxDepth.store(0, std::memory_order_relaxed);
+}
+
+void StageStats::record(int64_t waitNs, int64_t processNs)
+{
+    waitNs = waitNs > 0 ? waitNs : 0;
+    processNs = processNs > 0 ? processNs : 0;
+    m_waitTotalNs.fetch_add(waitNs, std::memory_order_relaxed);
+    m_processTotalNs.fetch_add(processNs, std::memory_order_relaxed);
+    updateMax(m_waitMaxNs, waitNs);
+    updateMax(m_processMaxNs, processNs);
+    m_count.fetch_add(1, std::memory_order_release);
+}
+
+void StageStats::setDepth(size_t depth)
+{
+    m_depth.store(depth, std::memory_order_relaxed);
+    size_t current = m_maxDepth.load(std::memory_order_relaxed);
+    while (depth > current && !m_maxDepth.compare_exchange_weak(current, depth, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t StageStats::count() const
+{
+    return m_count.load(std::memory_order_acquire);
+}
+
+int64_t StageStats::averageWaitNs() const
+{
+    const uint64_t n = count();
+    return n > 0 ? m_waitTotalNs.load(std::memory_order_relaxed) / static_cast<int64_t>(n) : 0;
+}
+
+int64_t StageStats::maxWaitNs() const
+{
+    return m_waitMaxNs.load(std::memory_order_relaxed);
+}
+
+int64_t StageStats::averageProcessNs() const
+{
+    const uint64_t n = count();
+    return n > 0 ? m_processTotalNs.load(std::memory_order_relaxed) / static_cast<int64_t>(n) : 0;
+}
+
+int64_t StageStats::maxProcessNs() const
+{
+    return m_processMaxNs.load(std::memory_order_relaxed);
+}
+
+size_t StageStats::depth() const
+{
+    return m_depth.load(std::memory_order_relaxed);
+}
+
+size_t StageStats::maxDepth() const
+{
+    return m_maxDepth.load(std::memory_order_relaxed);
+}
+
+void StageStats::updateMax(std::atomic<int64_t> &target, int64_t value)
+{
+    int64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
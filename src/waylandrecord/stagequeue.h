@@ -0,0 +1,174 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef STAGEQUEUE_H
+#define STAGEQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief 流水线相邻两级之间的有界队列
+ *
+ * 容量在 reset 时确定，之后 push/pop 不再申请内存。
+ * 队列满时 push 阻塞（反压到上一级），队列空时 pop 阻塞；
+ * close 之后 push 立即失败，pop 取完剩余元素后失败，用于停止时排空流水线。
+ */
+template <typename T>
+class StageQueue
+{
+public:
+    explicit StageQueue(size_t capacity = 1)
+    {
+        reset(capacity);
+    }
+    StageQueue(const StageQueue &) = delete;
+    StageQueue &operator=(const StageQueue &) = delete;
+
+    /**
+     * @brief 清空队列并重新打开，容量至少为 1
+     */
+    void reset(size_t capacity)
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_items.assign(capacity > 0 ? capacity : 1, T());
+        m_head = 0;
+        m_count = 0;
+        m_maxDepth = 0;
+        m_blockedPushes = 0;
+        m_closed = false;
+    }
+
+    /**
+     * @brief 队列满时阻塞，队列已关闭返回 false
+     */
+    bool push(const T &item)
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        if (!m_closed && m_count == m_items.size()) {
+            m_blockedPushes++;
+            m_notFull.wait(locker, [this] { return m_closed || m_count < m_items.size(); });
+        }
+        if (m_closed) {
+            return false;
+        }
+        m_items[(m_head + m_count) % m_items.size()] = item;
+        m_count++;
+        if (m_count > m_maxDepth) {
+            m_maxDepth = m_count;
+        }
+        locker.unlock();
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief 队列空时阻塞，队列已关闭且为空返回 false
+     */
+    bool pop(T &item)
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        m_notEmpty.wait(locker, [this] { return m_closed || m_count > 0; });
+        if (m_count == 0) {
+            return false;
+        }
+        item = m_items[m_head];
+        m_head = (m_head + 1) % m_items.size();
+        m_count--;
+        locker.unlock();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> locker(m_mutex);
+            m_closed = true;
+        }
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+    size_t depth() const
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        return m_count;
+    }
+
+    size_t maxDepth() const
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        return m_maxDepth;
+    }
+
+    size_t capacity() const
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        return m_items.size();
+    }
+
+    /**
+     * @brief 生产者因队列满而阻塞的次数
+     */
+    uint64_t blockedPushCount() const
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        return m_blockedPushes;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::vector<T> m_items;
+    size_t m_head;
+    size_t m_count;
+    size_t m_maxDepth;
+    uint64_t m_blockedPushes;
+    bool m_closed;
+};
+
+/**
+ * @brief 流水线一级的计数：处理数量、等待输入的耗时、处理耗时和输入队列深度
+ * 由该级的线程写入，其它线程随时读取
+ */
+class StageStats
+{
+public:
+    StageStats();
+
+    void reset();
+    /**
+     * @param waitNs 从元素进入本级输入队列（或开始等待空闲缓冲区）到开始处理的时间
+     * @param processNs 本级处理耗时
+     */
+    void record(int64_t waitNs, int64_t processNs);
+    void setDepth(size_t depth);
+
+    uint64_t count() const;
+    int64_t averageWaitNs() const;
+    int64_t maxWaitNs() const;
+    int64_t averageProcessNs() const;
+    int64_t maxProcessNs() const;
+    size_t depth() const;
+    size_t maxDepth() const;
+
+private:
+    static void updateMax(std::atomic<int64_t> &target, int64_t value);
+
+    std::atomic<uint64_t> m_count;
+    std::atomic<int64_t> m_waitTotalNs;
+    std::atomic<int64_t> m_waitMaxNs;
+    std::atomic<int64_t> m_processTotalNs;
+    std::atomic<int64_t> m_processMaxNs;
+    std::atomic<size_t> m_depth;
+    std::atomic<size_t> m_maxDepth;
+};
+
+#endif // STAGEQUEUE_H
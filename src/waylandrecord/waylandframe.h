@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef WAYLANDFRAME_H
+#define WAYLANDFRAME_H
+
+#include <cstdint>
+
+/**
+ * @brief 取帧线程交给编码器的一帧 RGB 画面，像素内存归帧环形缓冲区所有
+ * 单独成文件，编码层不依赖 KWayland
+ */
+struct WaylandFrame {
+    //时间戳
+    int64_t _time;
+    //索引
+    int _index;
+    int _width;
+    int _height;
+    int _stride;
+    unsigned char *_frame;
+};
+
+#endif // WAYLANDFRAME_H
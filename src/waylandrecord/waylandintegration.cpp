@@ -10,12 +10,12 @@
 #include <QDBusArgument>
 #include <QDBusMetaType>
 
+#include <QElapsedTimer>
 #include <QEventLoop>
 #include <QLoggingCategory>
 #include <QThread>
 #include <QTimer>
 #include <QFile>
-#include <QPainter>
 #include <QImage>
 #include <QtConcurrent>
 #include <QtDBus>
@@ -48,8 +48,13 @@
 #include <sys/mman.h>
 #include <qdir.h>
 #include "recordadmin.h"
+#include "captureclock.h"
+#include "framewriter.h"
+#include "../utils/configsettings.h"
+#include "../utils/recordingstats.h"
 
 #include <string.h>
+#include <limits>
 #include <QMutexLocker>
 
 Q_LOGGING_CATEGORY(XdgDesktopPortalKdeWaylandIntegration, "xdp-kde-wayland-integration")
@@ -95,7 +100,9 @@ bool WaylandIntegration::WaylandIntegrationPrivate::stopVideoRecord()
         qCDebug(dsrApp) << "FFmpeg environment detected for video recording.";
         if (m_recordAdmin) {
             qCDebug(dsrApp) << "Stopping FFmpeg video recording";
-            return m_recordAdmin->stopStream();
+            const bool ret = m_recordAdmin->stopStream();
+            finishRecordingStats();
+            return ret;
         } else {
             qCWarning(dsrApp) << "m_recordAdmin is not init!";
             return false;
@@ -203,7 +210,6 @@ WaylandIntegration::WaylandIntegrationPrivate::WaylandIntegrationPrivate()
     m_bufferSize = 200;
     qCDebug(dsrApp) << "Architecture detected: Other. Buffer size set to" << m_bufferSize;
 #endif
-    m_ffmFrame = nullptr;
     qDBusRegisterMetaType<WaylandIntegrationPrivate::Stream>();
     qDBusRegisterMetaType<WaylandIntegrationPrivate::Streams>();
     m_recordAdmin = nullptr;
@@ -214,8 +220,6 @@ WaylandIntegration::WaylandIntegrationPrivate::WaylandIntegrationPrivate()
     // m_recordTIme = -1;
     initScreenFrameBuffer();
     qCDebug(dsrApp) << "Screen frame buffer initialized.";
-    m_currentScreenBufs[0] = nullptr;
-    m_currentScreenBufs[1] = nullptr;
     m_screenCount = 1;
     qCDebug(dsrApp) << "Exiting WaylandIntegrationPrivate constructor";
 }
@@ -223,25 +227,9 @@ WaylandIntegration::WaylandIntegrationPrivate::WaylandIntegrationPrivate()
 WaylandIntegration::WaylandIntegrationPrivate::~WaylandIntegrationPrivate()
 {
     qCDebug(dsrApp) << "Entering WaylandIntegrationPrivate destructor";
-    QMutexLocker locker(&m_mutex);
-    for (int i = 0; i < m_freeList.size(); i++) {
-        if (m_freeList[i]) {
-            delete m_freeList[i];
-            m_freeList[i] = nullptr; // Ensure pointer is nulled after deletion
-            qCDebug(dsrApp) << "Deleted item from free list at index:" << i;
-        }
-    }
-    m_freeList.clear();
-    qCDebug(dsrApp) << "Free list cleared. Size:" << m_freeList.size();
-    for (int i = 0; i < m_waylandList.size(); i++) {
-        delete m_waylandList[i]._frame;
-    }
-    m_waylandList.clear();
-    qCDebug(dsrApp) << "Wayland list cleared. Size:" << m_waylandList.size();
-    if (nullptr != m_ffmFrame) {
-        delete[] m_ffmFrame;
-        m_ffmFrame = nullptr;
-    }
+    m_frameRing.release();
+    qCDebug(dsrApp) << "Frame ring released.";
+    releaseOutputBuffers();
     if (nullptr != m_recordAdmin) {
         delete m_recordAdmin;
         m_recordAdmin = nullptr;
@@ -258,6 +246,7 @@ void WaylandIntegration::WaylandIntegrationPrivate::bindOutput(int outputName, i
     qCDebug(dsrApp) << "Entering WaylandIntegrationPrivate::bindOutput with name:" << outputName << ", version:" << outputVersion;
     KWayland::Client::Output *output = new KWayland::Client::Output(this);
     output->setup(m_registry->bindOutput(static_cast<uint32_t>(outputName), static_cast<uint32_t>(outputVersion)));
+    m_wlOutputNames.insert(static_cast<wl_output *>(*output), static_cast<quint32>(outputName));
     m_bindOutputs << output;
     qCDebug(dsrApp) << "Output bound and added to bindOutputs list.";
     qCDebug(dsrApp) << "Exiting WaylandIntegrationPrivate::bindOutput";
@@ -288,8 +277,16 @@ void WaylandIntegration::WaylandIntegrationPrivate::stopStreaming()
             qDebug() << "m_remoteAccessManager已释放";
 #endif
         }
+        for (KWayland::Client::Output *output : m_bindOutputs) {
+            m_wlOutputNames.remove(static_cast<wl_output *>(*output));
+        }
         qDeleteAll(m_bindOutputs);
         m_bindOutputs.clear();
+        m_dmaBufMaps.clear();
+        flushReadback();
+        m_eglReader.release();
+        m_readbackRects.clear();
+        m_readbackImages.clear();
         //        if (m_stream) {
         //            delete m_stream;
         //            m_stream = nullptr;
@@ -320,6 +317,7 @@ void WaylandIntegration::WaylandIntegrationPrivate::initWayland(QStringList list
     qCDebug(dsrApp) << "Setting FPS to:" << m_fps;
     m_recordAdmin = new RecordAdmin(list, this);
     m_recordAdmin->setBoardVendor(m_boardVendorType);
+    initRecordingStats();
     //初始化wayland服务链接
     initConnectWayland();
     qCDebug(dsrApp) << "Wayland initialization completed";
@@ -339,6 +337,7 @@ void WaylandIntegration::WaylandIntegrationPrivate::initWayland(QStringList list
     m_fps = list[5].toInt();
     m_gstRecordX = gstRecord;
     m_gstRecordX->setBoardVendorType(m_boardVendorType);
+    initRecordingStats();
     //初始化wayland服务链接
     initConnectWayland();
     qCDebug(dsrApp) << "Wayland initialization with GstRecordX completed";
@@ -485,6 +484,8 @@ void WaylandIntegration::WaylandIntegrationPrivate::addOutput(quint32 name, quin
     qCDebug(dsrApp) << "Adding output with name:" << name << "version:" << version;
     KWayland::Client::Output *output = new KWayland::Client::Output(this);
     output->setup(m_registry->bindOutput(name, version));
+    //bufferReady 只给出 wl_output，记录其注册名以便按输出索引采集缓冲
+    m_wlOutputNames.insert(static_cast<wl_output *>(*output), name);
 
     connect(output, &KWayland::Client::Output::changed, this, [this, name, version, output]() {
         qCDebug(XdgDesktopPortalKdeWaylandIntegration) << "Adding output:";
@@ -519,6 +520,18 @@ void WaylandIntegration::WaylandIntegrationPrivate::addOutput(quint32 name, quin
 void WaylandIntegration::WaylandIntegrationPrivate::removeOutput(quint32 name)
 {
     WaylandOutput output = m_outputMap.take(name);
+    for (auto itr = m_wlOutputNames.begin(); itr != m_wlOutputNames.end();) {
+        if (itr.value() == name) {
+            itr = m_wlOutputNames.erase(itr);
+        } else {
+            ++itr;
+        }
+    }
+    {
+        //拷贝线程可能仍在使用该输出的缓冲，这里只让它不再参与合成，内存在析构时统一释放
+        QMutexLocker locker(&m_bGetScreenImageMutex);
+        OutputBuffers::drop(m_outputBuffers, name);
+    }
     qCDebug(XdgDesktopPortalKdeWaylandIntegration) << "Removing output:";
     qCDebug(XdgDesktopPortalKdeWaylandIntegration) << "    manufacturer: " << output.manufacturer();
     qCDebug(XdgDesktopPortalKdeWaylandIntegration) << "    model: " << output.model();
@@ -561,6 +574,7 @@ void WaylandIntegration::WaylandIntegrationPrivate::onDeviceChanged(quint32 name
 
 void WaylandIntegration::WaylandIntegrationPrivate::processBuffer(const KWayland::Client::RemoteBuffer *rbuf, const QRect rect)
 {
+    RecordingStats::Scope statsScope(RecordingStats::ProcessBuffer);
     qCInfo(dsrApp) << __FUNCTION__ << __LINE__ << "开始处理buffer...";
     qDebug() << ">>>>>> open fd!" << rbuf->fd();
     //    QScopedPointer<const KWayland::Client::RemoteBuffer> guard(rbuf);
@@ -575,11 +589,13 @@ void WaylandIntegration::WaylandIntegrationPrivate::processBuffer(const KWayland
         m_bInitRecordAdmin = false;
         if (Utils::isFFmpegEnv) {
             qCDebug(dsrApp) << "Using FFmpeg environment";
-            m_recordAdmin->init(static_cast<int>(m_screenSize.width()), static_cast<int>(m_screenSize.height()));
-            frameStartTime = avlibInterface::m_av_gettime();
+            //按录制区域在采集时裁剪，缓冲区和编码端都只处理区域内的像素
+            m_captureRegion = m_recordAdmin->captureRegion(m_screenSize.width(), m_screenSize.height());
+            m_recordAdmin->initCropped(m_captureRegion);
+            frameStartTime = CaptureClock::nowUs();
         } else {
             qCDebug(dsrApp) << "Using GStreamer environment";
-            frameStartTime = QDateTime::currentMSecsSinceEpoch();
+            frameStartTime = CaptureClock::nowUs();
             isGstWriteVideoFrame = true;
             if (m_gstRecordX) {
                 m_gstRecordX->waylandGstStartRecord();
@@ -594,10 +610,12 @@ void WaylandIntegration::WaylandIntegrationPrivate::processBuffer(const KWayland
         QtConcurrent::run(this, &WaylandIntegrationPrivate::appendFrameToList);
         qCDebug(dsrApp) << "appendFrameToList started in concurrent thread.";
     }
-    unsigned char *mapData = static_cast<unsigned char *>(mmap(nullptr, stride * height, PROT_READ, MAP_SHARED, dma_fd, 0));
-    if (MAP_FAILED == mapData) {
+    DmaBufMapCache::Access access;
+    if (!m_dmaBufMaps.beginRead(dma_fd, static_cast<size_t>(stride) * height, access)) {
         qCWarning(XdgDesktopPortalKdeWaylandIntegration) << "dma fd " << dma_fd << " mmap failed - ";
+        return;
     }
+    const unsigned char *mapData = access.data();
     // QString pngName = "/home/uos/Desktop/test/"+QDateTime::currentDateTime().toString(QLatin1String("hh:mm:ss.zzz ") +
     // QString("%1_").arg(rect.x())); QImage(mapData, width, height, QImage::Format_RGB32).copy().save(pngName + ".png");
     if (m_screenCount == 1 || !m_isScreenExtension) {
@@ -606,6 +624,7 @@ void WaylandIntegration::WaylandIntegrationPrivate::processBuffer(const KWayland
         {
             QMutexLocker locker(&m_bGetScreenImageMutex);
             m_curNewImage.second = QImage(mapData, width, height, QImage::Format_RGBA8888).copy();
+            m_screenImageSerial++;
             qCDebug(dsrApp) << "Single screen image copied.";
         }
     } else {
@@ -620,18 +639,20 @@ void WaylandIntegration::WaylandIntegrationPrivate::processBuffer(const KWayland
             for (auto itr = m_ScreenDateBuf.begin(); itr != m_ScreenDateBuf.end(); ++itr) {
                 m_curNewImageScreen.append(*itr);
             }
+            m_screenImageSerial++;
             m_ScreenDateBuf.clear();
         }
     }
-    munmap(mapData, stride * height);
-    qCDebug(dsrApp) << "Buffer unmapped from memory.";
+    access.end();
+    qCDebug(dsrApp) << "Buffer read finished.";
     qCDebug(dsrApp) << "Exiting WaylandIntegrationPrivate::processBuffer";
 }
 
 void WaylandIntegration::WaylandIntegrationPrivate::processBufferHw(const KWayland::Client::RemoteBuffer *rbuf,
                                                                     const QRect rect,
-                                                                    int screenId)
+                                                                    quint32 outputKey)
 {
+    RecordingStats::Scope statsScope(RecordingStats::ProcessBuffer);
     qCInfo(dsrApp) << __FUNCTION__ << __LINE__ << "开始处理buffer...";
     qDebug() << ">>>>>> open fd!" << rbuf->fd();
     //    QScopedPointer<const KWayland::Client::RemoteBuffer> guard(rbuf);
@@ -646,11 +667,13 @@ void WaylandIntegration::WaylandIntegrationPrivate::processBufferHw(const KWayla
         m_bInitRecordAdmin = false;
         if (Utils::isFFmpegEnv) {
             qCDebug(dsrApp) << "Using FFmpeg environment";
-            m_recordAdmin->init(static_cast<int>(m_screenSize.width()), static_cast<int>(m_screenSize.height()));
-            frameStartTime = avlibInterface::m_av_gettime();
+            //按录制区域在采集时裁剪，缓冲区和编码端都只处理区域内的像素
+            m_captureRegion = m_recordAdmin->captureRegion(m_screenSize.width(), m_screenSize.height());
+            m_recordAdmin->initCropped(m_captureRegion);
+            frameStartTime = CaptureClock::nowUs();
         } else {
             qCDebug(dsrApp) << "Using GStreamer environment";
-            frameStartTime = QDateTime::currentMSecsSinceEpoch();
+            frameStartTime = CaptureClock::nowUs();
             isGstWriteVideoFrame = true;
             if (m_gstRecordX) {
                 m_gstRecordX->waylandGstStartRecord();
@@ -665,202 +688,129 @@ void WaylandIntegration::WaylandIntegrationPrivate::processBufferHw(const KWayla
         QtConcurrent::run(this, &WaylandIntegrationPrivate::appendFrameToList);
         qCDebug(dsrApp) << "appendFrameToList started in concurrent thread.";
     }
-    unsigned char *mapData = static_cast<unsigned char *>(mmap(nullptr, stride * height, PROT_READ, MAP_SHARED, dma_fd, 0));
-    if (MAP_FAILED == mapData) {
+    const bool isSingleScreen = (m_screenCount == 1 || !m_isScreenExtension);
+    //单屏（或复制模式）只使用键值为 0 的输出缓冲
+    const quint32 key = isSingleScreen ? 0 : outputKey;
+    DmaBufMapCache::Access access;
+    if (!m_dmaBufMaps.beginRead(dma_fd, static_cast<size_t>(stride) * height, access)) {
         qCWarning(XdgDesktopPortalKdeWaylandIntegration) << "dma fd " << dma_fd << " mmap failed - ";
-    }
-    // QString pngName = "/home/uos/Desktop/test/"+QDateTime::currentDateTime().toString(QLatin1String("hh:mm:ss.zzz ") +
-    // QString("%1_").arg(rect.x())); QImage(mapData, width, height, QImage::Format_RGB32).copy().save(pngName + ".png");
-    if (m_screenCount == 1 || !m_isScreenExtension) {
-        qCDebug(dsrApp) << "Processing single screen hardware buffer";
-        if (!m_isExistFirstScreenData) {
-            qCDebug(dsrApp) << "Allocating first screen data buffer";
-            m_firstScreenData = new unsigned char[stride * height];
-            m_isExistFirstScreenData = true;
-#ifdef KWAYLAND_REMOTE_BUFFER_RELEASE_FLAGE_ON
-            m_lastScreenDatas[0]._frame = new unsigned char[stride * height];
-            m_lastScreenDatas[0]._width = width;
-            m_lastScreenDatas[0]._height = height;
-            m_lastScreenDatas[0]._stride = height;
-            m_lastScreenDatas[0]._format = getImageFormat(rbuf->format());
-            m_lastScreenDatas[0]._rect = rect;
-#endif
-        }
-        //单屏
-        // qDebug() << ">>>>>> new unsigned char: " << stride *height;
-        // memcpy(m_firstScreenData, mapData, stride * height);
-        copyBuffer(m_firstScreenData, mapData, rbuf);
-        qCDebug(dsrApp) << "Single screen hardware buffer copied.";
-#ifdef KWAYLAND_REMOTE_BUFFER_RELEASE_FLAGE_ON
-        // memcpy(m_lastScreenDatas[0]._frame, mapData, stride * height);
-        copyBuffer(m_lastScreenDatas[0]._frame, mapData, rbuf);
-        qCDebug(dsrApp) << "Remote buffer released for single screen.";
-#endif
-        // qDebug() << ">>>>>> memcpy: " << stride *height;
-        QMutexLocker locker(&m_bGetScreenImageMutex);
-        m_curNewImageData._frame = m_firstScreenData;
-        m_curNewImageData._width = width;
-        m_curNewImageData._height = height;
-        m_curNewImageData._format = QImage::Format_RGBA8888;
-        m_curNewImageData._rect = QRect(0, 0, 0, 0);
-        qCDebug(dsrApp) << "Single screen image data updated.";
-    } else if (m_screenCount == 2 && m_isScreenExtension) {
-        qCDebug(dsrApp) << "Processing dual screen extended hardware buffer. Screen ID:" << screenId;
-        if (screenId == 0) {
-            qCDebug(dsrApp) << "Processing first screen of dual setup.";
-            if (!m_isExistFirstScreenData) {
-                qCDebug(dsrApp) << "Allocating first screen data buffer";
-                m_firstScreenData = new unsigned char[stride * height];
-                m_isExistFirstScreenData = true;
-                m_firstScreenData = new unsigned char[stride * height];
-                qCDebug(dsrApp) << "Allocated memory for first screen data.";
-            }
-#ifdef KWAYLAND_REMOTE_BUFFER_RELEASE_FLAGE_ON
-            if (!m_isExistLastScreenDatas[0]) {
-                m_isExistLastScreenDatas[0] = true;
-                m_lastScreenDatas[0]._frame = new unsigned char[stride * height];
-                m_lastScreenDatas[0]._width = width;
-                m_lastScreenDatas[0]._height = height;
-                m_lastScreenDatas[0]._stride = height;
-                m_lastScreenDatas[0]._format = getImageFormat(rbuf->format());
-                m_lastScreenDatas[0]._rect = rect;
-#endif
+    } else {
+        const unsigned char *mapData = access.data();
+        //录制区域与本输出相交的部分（输出内坐标），只拷贝这部分的行和列；未指定区域时拷贝整屏
+        const QRect outputRect = isSingleScreen ? QRect(0, 0, static_cast<int>(width), static_cast<int>(height))
+                                                : QRect(rect.topLeft(), QSize(static_cast<int>(width), static_cast<int>(height)));
+        const bool cropped = m_captureRegion.isValid();
+        const QRect copyRect = cropped ? outputRect.intersected(m_captureRegion).translated(-outputRect.topLeft())
+                                       : QRect(0, 0, static_cast<int>(width), static_cast<int>(height));
+        const quint32 rowBytes = cropped ? static_cast<quint32>(copyRect.width()) * 4
+                                         : static_cast<quint32>(getPadStride(static_cast<int>(width), 4, 32));
+        const size_t bytes = cropped ? static_cast<size_t>(rowBytes) * static_cast<size_t>(copyRect.height())
+                                     : static_cast<size_t>(stride) * height;
+        unsigned char *staging = nullptr;
+        {
+            QMutexLocker locker(&m_bGetScreenImageMutex);
+            bool reallocated = false;
+            //首次采集或分辨率变化时分配，之后每帧复用
+            staging = OutputBuffers::staging(m_outputBuffers, key, bytes, reallocated);
+            if (reallocated) {
+                qCDebug(dsrApp) << "Allocated output buffers for output" << key << "size:" << bytes;
+                if (isSingleScreen) {
+                    m_curNewImageData._frame = nullptr;
+                }
             }
-            // qDebug() << ">>>>>> memcpy1: " << stride *height;
-            // memcpy(m_firstScreenData, mapData, stride * height);
-            copyBuffer(m_firstScreenData, mapData, rbuf);
-            qCDebug(dsrApp) << "Copied buffer to first screen data.";
-#ifdef KWAYLAND_REMOTE_BUFFER_RELEASE_FLAGE_ON
-            // memcpy(m_lastScreenDatas[0]._frame, mapData, stride * height);
-            copyBuffer(m_lastScreenDatas[0]._frame, mapData, rbuf);
-            qCDebug(dsrApp) << "Copied buffer to lastScreenDatas[0].";
-#endif
-            // qDebug() << ">>>>>> memcpy2: " << stride *height;
-            m_ScreenDateBufFrames[0]._frame = m_firstScreenData;
-            m_ScreenDateBufFrames[0]._width = width;
-            m_ScreenDateBufFrames[0]._height = height;
-            m_ScreenDateBufFrames[0]._format = getImageFormat(rbuf->format());
-            m_ScreenDateBufFrames[0]._rect = rect;
-            m_ScreenDateBufFrames[0]._flag = true;
+        }
+        //暂存缓冲只有采集线程写入，拷贝时不持锁
+        if (cropped) {
+            copyBufferRegion(staging, mapData, static_cast<int>(stride), copyRect);
         } else {
-            if (!m_isExistSecondScreenData) {
-                qCDebug(dsrApp) << "Allocating second screen data buffer";
-                m_secondScreenData = new unsigned char[stride * height];
-                m_isExistSecondScreenData = true;
-#ifdef KWAYLAND_REMOTE_BUFFER_RELEASE_FLAGE_ON
-                m_lastScreenDatas[1]._frame = new unsigned char[stride * height];
-                m_lastScreenDatas[1]._width = width;
-                m_lastScreenDatas[1]._height = height;
-                m_lastScreenDatas[1]._stride = height;
-                m_lastScreenDatas[1]._format = getImageFormat(rbuf->format());
-                m_lastScreenDatas[1]._rect = rect;
-#endif
-            }
-            // qDebug() << ">>>>>> memcpy1: " << stride *height;
-            // memcpy(m_secondScreenData, mapData, stride * height);
-            copyBuffer(m_secondScreenData, mapData, rbuf);
-            qCDebug(dsrApp) << "Copied buffer to second screen data.";
-#ifdef KWAYLAND_REMOTE_BUFFER_RELEASE_FLAGE_ON
-            // memcpy(m_lastScreenDatas[1]._frame, mapData, stride * height);
-            copyBuffer(m_lastScreenDatas[1]._frame, mapData, rbuf);
-            qCDebug(dsrApp) << "Copied buffer to lastScreenDatas[1].";
-#endif
-            // qDebug() << ">>>>>> memcpy2: " << stride *height;
-            m_ScreenDateBufFrames[1]._frame = m_secondScreenData;
-            m_ScreenDateBufFrames[1]._width = width;
-            m_ScreenDateBufFrames[1]._height = height;
-            m_ScreenDateBufFrames[1]._format = getImageFormat(rbuf->format());
-            m_ScreenDateBufFrames[1]._rect = rect;
-            m_ScreenDateBufFrames[1]._flag = true;
+            copyBuffer(staging, mapData, rbuf);
         }
-
-        if (m_ScreenDateBufFrames[0]._flag && m_ScreenDateBufFrames[1]._flag) {
-            qCDebug(dsrApp) << "Both screen buffers ready, merging frames";
+        qCDebug(dsrApp) << "Copied hardware buffer to output" << key;
+        {
             QMutexLocker locker(&m_bGetScreenImageMutex);
-            for (int i = 0; i < 2; i++) {
-                m_curNewImageScreenFrames[i]._frame = m_ScreenDateBufFrames[i]._frame;
-                m_curNewImageScreenFrames[i]._width = m_ScreenDateBufFrames[i]._width;
-                m_curNewImageScreenFrames[i]._height = m_ScreenDateBufFrames[i]._height;
-                m_curNewImageScreenFrames[i]._format = m_ScreenDateBufFrames[i]._format;
-                m_curNewImageScreenFrames[i]._rect = m_ScreenDateBufFrames[i]._rect;
-                m_curNewImageScreenFrames[i]._flag = m_ScreenDateBufFrames[i]._flag;
-                m_ScreenDateBufFrames[i]._flag = false;
+            OutputBuffer &buffer = OutputBuffers::publish(m_outputBuffers, key);
+            buffer._rect = copyRect.translated(outputRect.topLeft());
+            buffer._width = static_cast<quint32>(copyRect.width());
+            buffer._height = static_cast<quint32>(copyRect.height());
+            buffer._stride = rowBytes;
+            buffer._format = isSingleScreen ? QImage::Format_RGBA8888 : getImageFormat(rbuf->format());
+            if (isSingleScreen) {
+                m_curNewImageData._frame = buffer._published;
+                m_curNewImageData._key = key;
+                m_curNewImageData._width = buffer._width;
+                m_curNewImageData._height = buffer._height;
+                m_curNewImageData._stride = buffer._stride;
+                m_curNewImageData._format = buffer._format;
+                m_curNewImageData._rect = QRect(0, 0, 0, 0);
+                m_curNewImageData._flag = true;
+                m_screenImageSerial++;
+            } else if (readyOutputCount() >= expectedOutputCount()) {
+                //所有输出都已送来新画面，可以合成一帧
+                m_screenImageSerial++;
             }
         }
-    } else {
-        qWarning() << "screen count > 2!!!";
+        access.end();
+        qCDebug(dsrApp) << "Hardware buffer read finished.";
     }
 #ifdef KWAYLAND_REMOTE_BUFFER_RELEASE_FLAGE_ON
-    if (screenId == 0) {
-        if (m_currentScreenBufs[0] != nullptr) {
-            close(m_currentScreenBufs[0]->fd());
-            m_currentScreenBufs[0]->release();
-            m_currentScreenBufs[0] = nullptr;
-            // qDebug() << "m_currentScreenBufs[0] is release!";
-            m_mutex.unlock();
-        }
-    } else {
-        if (m_currentScreenBufs[1] != nullptr) {
-            close(m_currentScreenBufs[1]->fd());
-            m_currentScreenBufs[1]->release();
-            m_currentScreenBufs[1] = nullptr;
-            // qDebug() << "m_currentScreenBufs[1] is release!";
-            m_mutex.unlock();
+    KWayland::Client::RemoteBuffer *pendingBuf = nullptr;
+    {
+        QMutexLocker locker(&m_bGetScreenImageMutex);
+        auto itr = m_outputBuffers.find(key);
+        if (itr != m_outputBuffers.end()) {
+            pendingBuf = itr->_pendingBuf;
+            itr->_pendingBuf = nullptr;
         }
     }
+    if (pendingBuf != nullptr) {
+        close(pendingBuf->fd());
+        pendingBuf->release();
+        m_mutex.unlock();
+    }
 #endif
-    munmap(mapData, stride * height);
-    qCDebug(dsrApp) << "Hardware buffer unmapped from memory.";
     qCDebug(dsrApp) << "Exiting WaylandIntegrationPrivate::processBufferHw.";
 }
 
 //拷贝数据，当远程buffer没有数据传过来时，调用此接口，将上一次的屏幕数据做为当前的屏幕数据
-void WaylandIntegration::WaylandIntegrationPrivate::copyScreenData(int screenId)
+void WaylandIntegration::WaylandIntegrationPrivate::copyScreenData(quint32 outputKey)
 {
-    qCDebug(dsrApp) << "Copying screen data for screen" << screenId;
+    qCDebug(dsrApp) << "Copying screen data for output" << outputKey;
+    QMutexLocker locker(&m_bGetScreenImageMutex);
+    const OutputBuffer *buffer = OutputBuffers::reuseLast(m_outputBuffers, outputKey);
+    if (nullptr == buffer) {
+        return;
+    }
     if (m_screenCount == 1 || !m_isScreenExtension) {
-        qCDebug(dsrApp) << "Copying single screen data";
-        m_curNewImageData._frame = m_lastScreenDatas[0]._frame;
-        m_curNewImageData._width = m_lastScreenDatas[0]._width;
-        m_curNewImageData._height = m_lastScreenDatas[0]._height;
-        m_curNewImageData._format = m_lastScreenDatas[0]._format;
-        m_curNewImageData._rect = m_lastScreenDatas[0]._rect;
+        m_curNewImageData._frame = buffer->_published;
+        m_curNewImageData._key = outputKey;
+        m_curNewImageData._width = buffer->_width;
+        m_curNewImageData._height = buffer->_height;
+        m_curNewImageData._stride = buffer->_stride;
+        m_curNewImageData._format = buffer->_format;
+        m_curNewImageData._rect = buffer->_rect;
         m_curNewImageData._flag = true;
-    } else if (m_screenCount == 2 && m_isScreenExtension) {
-        qCDebug(dsrApp) << "Copying multi-screen data for screen" << screenId;
-        if (screenId == 0) {
-            m_ScreenDateBufFrames[0]._frame = m_lastScreenDatas[0]._frame;
-            m_ScreenDateBufFrames[0]._width = m_lastScreenDatas[0]._width;
-            m_ScreenDateBufFrames[0]._height = m_lastScreenDatas[0]._height;
-            m_ScreenDateBufFrames[0]._format = m_lastScreenDatas[0]._format;
-            m_ScreenDateBufFrames[0]._rect = m_lastScreenDatas[0]._rect;
-            m_ScreenDateBufFrames[0]._flag = true;
-        } else {
-            m_ScreenDateBufFrames[1]._frame = m_lastScreenDatas[1]._frame;
-            m_ScreenDateBufFrames[1]._width = m_lastScreenDatas[1]._width;
-            m_ScreenDateBufFrames[1]._height = m_lastScreenDatas[1]._height;
-            m_ScreenDateBufFrames[1]._format = m_lastScreenDatas[1]._format;
-            m_ScreenDateBufFrames[1]._rect = m_lastScreenDatas[1]._rect;
-            m_ScreenDateBufFrames[1]._flag = true;
-        }
-        if (m_ScreenDateBufFrames[0]._flag && m_ScreenDateBufFrames[1]._flag && m_lastScreenDatas[0]._frame != nullptr &&
-            m_lastScreenDatas[1]._frame != nullptr) {
-            qCDebug(dsrApp) << "Both screen buffers ready, merging frames";
-            QMutexLocker locker(&m_bGetScreenImageMutex);
-            for (int i = 0; i < 2; i++) {
-                m_curNewImageScreenFrames[i]._frame = m_ScreenDateBufFrames[i]._frame;
-                m_curNewImageScreenFrames[i]._width = m_ScreenDateBufFrames[i]._width;
-                m_curNewImageScreenFrames[i]._height = m_ScreenDateBufFrames[i]._height;
-                m_curNewImageScreenFrames[i]._format = m_ScreenDateBufFrames[i]._format;
-                m_curNewImageScreenFrames[i]._rect = m_ScreenDateBufFrames[i]._rect;
-                m_curNewImageScreenFrames[i]._flag = m_ScreenDateBufFrames[i]._flag;
-                m_ScreenDateBufFrames[i]._flag = false;
-            }
-        }
     }
     qCDebug(dsrApp) << "Screen data copy completed";
 }
 
+quint32 WaylandIntegration::WaylandIntegrationPrivate::outputName(const void *output, const QRect &geometry) const
+{
+    if (!m_wlOutputNames.contains(output)) {
+        qCWarning(dsrApp) << "Unknown wl_output, keyed by geometry:" << geometry;
+    }
+    return OutputBuffers::outputKey(m_wlOutputNames, output, geometry);
+}
+
+int WaylandIntegration::WaylandIntegrationPrivate::expectedOutputCount() const
+{
+    return OutputBuffers::expectedCount(m_screenCount, m_isScreenExtension);
+}
+
+int WaylandIntegration::WaylandIntegrationPrivate::readyOutputCount() const
+{
+    return OutputBuffers::readyCount(m_outputBuffers);
+}
+
 //根据wayland客户端bufferReady给过来的像素格式，转成QImage的格式
 QImage::Format WaylandIntegration::WaylandIntegrationPrivate::getImageFormat(quint32 format)
 {
@@ -904,8 +854,32 @@ QImage::Format WaylandIntegration::WaylandIntegrationPrivate::getImageFormat(qui
     }
 }
 
-void WaylandIntegration::WaylandIntegrationPrivate::processBufferX86(const KWayland::Client::RemoteBuffer *rbuf, const QRect rect)
+//QImage 格式对应的内存字节顺序，X 通道格式合成时把 alpha 填成 0xff
+FrameCompositor::PixelOrder WaylandIntegration::WaylandIntegrationPrivate::pixelOrder(QImage::Format format, bool &opaque)
 {
+    switch (format) {
+        case QImage::Format_RGBX8888:
+            opaque = true;
+            return FrameCompositor::RGBA;
+        case QImage::Format_RGBA8888:
+        case QImage::Format_RGBA8888_Premultiplied:
+            opaque = false;
+            return FrameCompositor::RGBA;
+        case QImage::Format_ARGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+            opaque = false;
+            return FrameCompositor::BGRA;
+        default:
+            opaque = true;
+            return FrameCompositor::BGRA;
+    }
+}
+
+void WaylandIntegration::WaylandIntegrationPrivate::processBufferX86(const KWayland::Client::RemoteBuffer *rbuf,
+                                                                     const QRect rect,
+                                                                     quint32 outputKey)
+{
+    RecordingStats::Scope statsScope(RecordingStats::ProcessBuffer);
     qCInfo(dsrApp) << __FUNCTION__ << __LINE__ << "开始处理buffer...";
     qDebug() << ">>>>>> open fd!" << rbuf->fd();
     // QScopedPointer<const KWayland::Client::RemoteBuffer> guard(rbuf);
@@ -918,11 +892,13 @@ void WaylandIntegration::WaylandIntegrationPrivate::processBufferX86(const KWayl
         m_bInitRecordAdmin = false;
         if (Utils::isFFmpegEnv) {
             qCDebug(dsrApp) << "Using FFmpeg environment";
-            m_recordAdmin->init(static_cast<int>(m_screenSize.width()), static_cast<int>(m_screenSize.height()));
-            frameStartTime = avlibInterface::m_av_gettime();
+            //按录制区域在采集时裁剪，缓冲区和编码端都只处理区域内的像素
+            m_captureRegion = m_recordAdmin->captureRegion(m_screenSize.width(), m_screenSize.height());
+            m_recordAdmin->initCropped(m_captureRegion);
+            frameStartTime = CaptureClock::nowUs();
         } else {
             qCDebug(dsrApp) << "Using GStreamer environment";
-            frameStartTime = QDateTime::currentMSecsSinceEpoch();
+            frameStartTime = CaptureClock::nowUs();
             isGstWriteVideoFrame = true;
             if (m_gstRecordX) {
                 m_gstRecordX->waylandGstStartRecord();
@@ -935,16 +911,23 @@ void WaylandIntegration::WaylandIntegrationPrivate::processBufferX86(const KWayl
         QtConcurrent::run(this, &WaylandIntegrationPrivate::appendFrameToList);
     }
 
-    QImage img(m_screenSize, QImage::Format_RGBA8888);
+    //读回的画面比本次送来的晚一帧，时间戳跟随画面实际的采集时间
+    const int64_t captureUs = CaptureClock::nowUs();
+    int64_t pixelsUs = captureUs;
     if (m_screenCount == 1 || !m_isScreenExtension) {
-        m_curNewImage.first = 0;  // avlibInterface::m_av_gettime() - frameStartTime;
-        {
-            QMutexLocker locker(&m_bGetScreenImageMutex);
-            m_curNewImage.second = getImage(dma_fd, width, height, stride, rbuf->format());
+        QImage image = getImage(dma_fd, width, height, stride, rbuf->format(), 0, captureUs, &pixelsUs);
+        QMutexLocker locker(&m_bGetScreenImageMutex);
+        //首帧同步读回，下一次读取重复输出首帧，采集时间相同，不算新画面
+        if (m_curNewImage.second.isNull() || m_curNewImage.first != pixelsUs) {
+            m_screenImageSerial++;
         }
+        m_curNewImage.first = pixelsUs;
+        m_curNewImage.second = image;
     } else {
         qCDebug(dsrApp) << "Processing multi-screen x86 buffer";
-        m_ScreenDateBuf.append(QPair<QRect, QImage>(rect, getImage(dma_fd, width, height, stride, rbuf->format())));
+        m_readbackRects[outputKey] = rect;
+        m_ScreenDateBuf.append(QPair<QRect, QImage>(rect, getImage(dma_fd, width, height, stride, rbuf->format(), outputKey, captureUs, &pixelsUs)));
+        m_screenDataUs = m_screenDataUs < 0 ? pixelsUs : qMin(m_screenDataUs, pixelsUs);
         if (m_ScreenDateBuf.size() == m_screenCount) {
             qCDebug(dsrApp) << "All screen buffers collected, merging images";
             QMutexLocker locker(&m_bGetScreenImageMutex);
@@ -952,54 +935,164 @@ void WaylandIntegration::WaylandIntegrationPrivate::processBufferX86(const KWayl
             for (auto itr = m_ScreenDateBuf.begin(); itr != m_ScreenDateBuf.end(); ++itr) {
                 m_curNewImageScreen.append(*itr);
             }
+            m_curNewImageScreenUs = m_screenDataUs;
+            m_screenImageSerial++;
             m_ScreenDateBuf.clear();
+            m_screenDataUs = -1;
         }
     }
 }
-//通过线程每30ms钟向数据池中取出一张图片添加到环形缓冲区，以便后续视频编码
+
+void WaylandIntegration::WaylandIntegrationPrivate::flushReadback()
+{
+    if (m_boardVendorType || m_readbackImages.isEmpty()) {
+        return;
+    }
+    quint64 serial = 0;
+    if (m_screenCount == 1 || !m_isScreenExtension) {
+        const QImage &last = m_readbackImages[0].first;
+        QImage image(last.size(), last.format());
+        int64_t pixelsUs = 0;
+        if (last.isNull() || !m_eglReader.flush(0, image.bits(), &pixelsUs)) {
+            return;
+        }
+        QMutexLocker locker(&m_bGetScreenImageMutex);
+        m_curNewImage.first = pixelsUs;
+        m_curNewImage.second = image;
+        serial = ++m_screenImageSerial;
+    } else {
+        QVector<QPair<QRect, QImage>> screens;
+        int64_t screensUs = -1;
+        {
+            QMutexLocker locker(&m_bGetScreenImageMutex);
+            screens = m_curNewImageScreen;
+        }
+        for (auto itr = m_readbackRects.begin(); itr != m_readbackRects.end(); ++itr) {
+            const QImage &last = m_readbackImages[itr.key()].first;
+            QImage image(last.size(), last.format());
+            int64_t pixelsUs = 0;
+            if (last.isNull() || !m_eglReader.flush(itr.key(), image.bits(), &pixelsUs)) {
+                continue;
+            }
+            for (auto screen = screens.begin(); screen != screens.end(); ++screen) {
+                if (screen->first == itr.value()) {
+                    screen->second = image;
+                }
+            }
+            screensUs = screensUs < 0 ? pixelsUs : qMin(screensUs, pixelsUs);
+        }
+        if (screensUs < 0 || screens.size() != m_screenCount) {
+            return;
+        }
+        QMutexLocker locker(&m_bGetScreenImageMutex);
+        m_curNewImageScreen = screens;
+        m_curNewImageScreenUs = screensUs;
+        serial = ++m_screenImageSerial;
+    }
+    //最多等三个节拍，写入线程已退出时不等待
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 timeoutMs = 3000 / qMax(m_fps, 1);
+    while (m_appendFrameToListFlag && m_appendedImageSerial.load() < serial && timer.elapsed() < timeoutMs) {
+        QThread::msleep(2);
+    }
+}
+//按帧率节拍向数据池中取出一张图片添加到环形缓冲区，以便后续视频编码
 void WaylandIntegration::WaylandIntegrationPrivate::appendFrameToList()
 {
-    int64_t delayTime = 1000 / m_fps + 1;
-#ifdef __mips__
-    // delayTime = 150;
-#endif
+    //按绝对截止时间调度，处理耗时不会累积成帧率漂移
+    m_framePacer.start(m_fps);
+    quint64 lastImageSerial = 0;
+    //FFmpeg 编码端按采集时间打时间戳，静止画面可以不写入，输出可变帧率；GStreamer 按固定帧率打时间戳，不能丢帧
+    m_frameDedup.reset();
+    m_frameDedup.setEnabled(Utils::isFFmpegEnv);
+    m_frameDedup.setMaxInterval(StaticFrameKeepAliveUs);
+    qCInfo(dsrApp) << "Frame pacer started, target fps:" << m_framePacer.targetFps();
 
     while (m_appendFrameToListFlag) {
+        //上一个节拍已处理完 lastImageSerial 及之前的画面
+        m_appendedImageSerial = lastImageSerial;
+        m_framePacer.waitNextTick();
+        if (!m_appendFrameToListFlag) {
+            break;
+        }
+        updateFrameCounters();
         if (m_screenCount == 1 || !m_isScreenExtension) {
+            if (m_boardVendorType) {
+                //持锁只租用已发布的输出缓冲，租用期间采集线程改写其它缓冲；
+                //去重的哈希和写入环形缓冲区的拷贝在锁外进行，不阻塞采集线程
+                const unsigned char *frame = nullptr;
+                quint32 frameKey = 0;
+                int frameWidth = 0;
+                int frameHeight = 0;
+                int frameStride = 0;
+                bool sourceChanged = false;
+                {
+                    QMutexLocker locker(&m_bGetScreenImageMutex);
+                    if (nullptr != m_curNewImageData._frame) {
+                        const OutputBuffer *leased = OutputBuffers::lease(m_outputBuffers, m_curNewImageData._key);
+                        if (nullptr != leased) {
+                            frame = leased->_leased;
+                            frameKey = m_curNewImageData._key;
+                            frameWidth = static_cast<int>(m_curNewImageData._width);
+                            frameHeight = static_cast<int>(m_curNewImageData._height);
+                            frameStride = static_cast<int>(m_curNewImageData._stride);
+                            sourceChanged = m_screenImageSerial != lastImageSerial;
+                            lastImageSerial = m_screenImageSerial;
+                        }
+                    }
+                }
+                if (nullptr == frame) {
+                    continue;
+                }
+                if (!sourceChanged) {
+                    m_framePacer.markDuplicate();
+                }
+                //FFmpeg 与 GStreamer 录制都使用采集时钟打时间戳，与音频处于同一时钟域
+                int64_t temptime = CaptureClock::nowUs();
+                //未裁剪时每行按 32 字节对齐，行字节数大于 width * 4
+                if (m_frameDedup.accept(frame, frameWidth, frameHeight, frameStride, temptime, sourceChanged)) {
+                    appendBuffer(frame, frameWidth, frameHeight, frameWidth * 4, temptime, frameStride);
+                }
+                QMutexLocker locker(&m_bGetScreenImageMutex);
+                OutputBuffers::endLease(m_outputBuffers, frameKey);
+                continue;
+            }
             QImage tempImage;
+            quint64 imageSerial = 0;
+            int64_t imageUs = 0;
             {
                 QMutexLocker locker(&m_bGetScreenImageMutex);
-                if (m_boardVendorType) {
-                    tempImage = QImage(
-                        m_curNewImageData._frame, m_curNewImageData._width, m_curNewImageData._height, m_curNewImageData._format);
-                } else {
-                tempImage = m_curNewImage.second.copy();
-                }
+                //采集线程每次整体替换 m_curNewImage.second，浅拷贝即可保证画面不被改写
+                tempImage = m_curNewImage.second;
+                imageUs = m_curNewImage.first;
+                imageSerial = m_screenImageSerial;
             }
             if (!tempImage.isNull()) {
-                int64_t temptime = 0;
-                if (Utils::isFFmpegEnv) {
-                    temptime = avlibInterface::m_av_gettime();
-
-                } else {
-                    temptime = QDateTime::currentMSecsSinceEpoch();
+                //采集端在本节拍内没有送来新画面；GStreamer 录制仍写入上一帧以保持恒定帧率
+                const bool sourceChanged = imageSerial != lastImageSerial;
+                if (!sourceChanged) {
+                    m_framePacer.markDuplicate();
+                }
+                lastImageSerial = imageSerial;
+                //新画面按实际采集时间打时间戳（PBO 读回晚一帧），重复的画面按节拍时间；两端编码器都会把不递增的时间戳顺延
+                int64_t temptime = sourceChanged ? imageUs : CaptureClock::nowUs();
+                //只拷贝录制区域内的行和列
+                const QRect region = m_captureRegion.isValid() ? m_captureRegion.intersected(tempImage.rect()) : tempImage.rect();
+                const unsigned char *regionBits = tempImage.constBits() + region.y() * tempImage.bytesPerLine() + region.x() * 4;
+                if (!region.isEmpty()
+                        && m_frameDedup.accept(regionBits, region.width(), region.height(), tempImage.bytesPerLine(), temptime, sourceChanged)) {
+                    appendBuffer(regionBits,
+                                 region.width(),
+                                 region.height(),
+                                 region.width() * 4,
+                                 temptime,
+                                 tempImage.bytesPerLine());
                 }
-                appendBuffer(tempImage.bits(),
-                             static_cast<int>(tempImage.width()),
-                             static_cast<int>(tempImage.height()),
-                             static_cast<int>(tempImage.width() * 4),
-                             temptime);
             }
-            QThread::msleep(static_cast<unsigned long>(delayTime));
         } else {
             //多屏录制
-            int64_t curFramTime = 0;
-            if (Utils::isFFmpegEnv) {
-                curFramTime = avlibInterface::m_av_gettime();
-
-            } else {
-                curFramTime = QDateTime::currentMSecsSinceEpoch();
-            }
+            int64_t curFramTime = CaptureClock::nowUs();
 #if 0
             cv::Mat res;
             res.create(cv::Size(m_screenSize.width(), m_screenSize.height()), CV_8UC4);
@@ -1014,69 +1107,127 @@ void WaylandIntegration::WaylandIntegrationPrivate::appendFrameToList()
 #else
 
             QVector<QPair<QRect, QImage> > tempImageVec;
+            quint64 imageSerial = 0;
+            int64_t imageUs = 0;
+            //hw 画布为 RGB32（内存中 BGRA），其他为 RGBA8888，与原先 QPainter 合成的格式一致
+            const FrameCompositor::PixelOrder canvasOrder = m_boardVendorType ? FrameCompositor::BGRA : FrameCompositor::RGBA;
+            //画布只覆盖录制区域，区域外的像素在合成时被裁掉
+            const QRect canvasRect = m_captureRegion.isValid() ? m_captureRegion : QRect(QPoint(0, 0), m_screenSize);
+            if (m_compositor.width() != canvasRect.width() || m_compositor.height() != canvasRect.height()
+                    || m_compositor.order() != canvasOrder) {
+                qCDebug(dsrApp) << "Allocating composite canvas:" << canvasRect;
+                if (!m_compositor.resize(canvasRect.width(), canvasRect.height(), canvasOrder)) {
+                    continue;
+                }
+            }
             {
                 QMutexLocker locker(&m_bGetScreenImageMutex);
+                //画面未拼齐时等待下一个节拍，不再空转
                 if (m_boardVendorType) {
-                    if (!m_curNewImageScreenFrames[0]._flag || !m_curNewImageScreenFrames[1]._flag)
+                    if (readyOutputCount() < expectedOutputCount())
                         continue;
-                    for (int i = 0; i < 2; i++) {
-                        QImage tempImage = QImage(m_curNewImageScreenFrames[i]._frame,
-                                                  static_cast<int>(m_curNewImageScreenFrames[i]._width),
-                                                  static_cast<int>(m_curNewImageScreenFrames[i]._height),
-                                                  m_curNewImageScreenFrames[i]._format)
-                                               .copy();
-                        tempImageVec.append(QPair<QRect, QImage>(m_curNewImageScreenFrames[i]._rect, tempImage));
-                        m_curNewImageScreenFrames[i]._flag = false;
+                    //直接从各输出已发布的缓冲按行拷贝到画布，持锁期间采集线程不会交换这些缓冲；画面未变化的屏幕跳过
+                    for (auto itr = m_outputBuffers.begin(); itr != m_outputBuffers.end(); ++itr) {
+                        if (!itr->_ready)
+                            continue;
+                        bool opaque = false;
+                        FrameCompositor::PixelOrder order = pixelOrder(itr->_format, opaque);
+                        m_compositor.blit(itr->_serial,
+                                          itr->_published,
+                                          static_cast<int>(itr->_width),
+                                          static_cast<int>(itr->_height),
+                                          static_cast<int>(itr->_stride),
+                                          order,
+                                          opaque,
+                                          itr->_rect.x() - canvasRect.x(),
+                                          itr->_rect.y() - canvasRect.y());
+                        itr->_ready = false;
                     }
                 } else {
                     if (m_curNewImageScreen.size() != m_screenCount)
                         continue;
-                for (auto itr = m_curNewImageScreen.begin(); itr != m_curNewImageScreen.end(); ++itr) {
-                    tempImageVec.append(*itr);
+                    for (auto itr = m_curNewImageScreen.begin(); itr != m_curNewImageScreen.end(); ++itr) {
+                        tempImageVec.append(*itr);
                     }
+                    imageUs = m_curNewImageScreenUs;
                 }
+                imageSerial = m_screenImageSerial;
             }
-            QImage img(m_screenSize, QImage::Format_RGBA8888);
-            if (m_boardVendorType) {
-                img = img.convertToFormat(QImage::Format_RGB32);
+            const bool sourceChanged = imageSerial != lastImageSerial;
+            if (!sourceChanged) {
+                m_framePacer.markDuplicate();
+            } else if (!m_boardVendorType) {
+                //x86 经 PBO 读回，画面晚一帧，按其中最早的采集时间打时间戳
+                curFramTime = imageUs;
             }
-            img.fill(Qt::GlobalColor::black);
-            QPainter painter(&img);
+            lastImageSerial = imageSerial;
+            //QImage 是隐式共享的，cacheKey 不变说明还是同一张画面
             for (auto itr = tempImageVec.begin(); itr != tempImageVec.end(); ++itr) {
-                painter.drawImage(itr->first.topLeft(), itr->second);
+                const QImage &image = itr->second;
+                bool opaque = false;
+                FrameCompositor::PixelOrder order = pixelOrder(image.format(), opaque);
+                m_compositor.blit(static_cast<uint64_t>(image.cacheKey()),
+                                  image.constBits(),
+                                  image.width(),
+                                  image.height(),
+                                  image.bytesPerLine(),
+                                  order,
+                                  opaque,
+                                  itr->first.x() - canvasRect.x(),
+                                  itr->first.y() - canvasRect.y());
             }
             tempImageVec.clear();
 #endif
-            appendBuffer(img.bits(), img.width(), img.height(), img.width() * 4, curFramTime /*- frameStartTime*/);
-            // 计算拼接的时的耗时
-            int64_t t = 0;
-            if (Utils::isFFmpegEnv) {
-                t = (avlibInterface::m_av_gettime() - curFramTime) / 1000;
-
-            } else {
-                t = (QDateTime::currentMSecsSinceEpoch() - curFramTime) / 1000;
-            }
-            qDebug() << delayTime - t;
-            if (t < delayTime) {
-                QThread::msleep(static_cast<unsigned long>(delayTime - t));
+            if (!m_frameDedup.accept(m_compositor.data(), m_compositor.width(), m_compositor.height(),
+                                     m_compositor.stride(), curFramTime, sourceChanged)) {
+                continue;
             }
+            appendBuffer(m_compositor.data(),
+                         m_compositor.width(),
+                         m_compositor.height(),
+                         m_compositor.stride(),
+                         curFramTime /*- frameStartTime*/);
         }
     }
+    updateFrameCounters();
+    qCInfo(dsrApp) << "Frame pacer stopped, target fps:" << m_framePacer.targetFps()
+                   << "achieved fps:" << m_framePacer.achievedFps()
+                   << "ticks:" << m_framePacer.tickCount()
+                   << "late:" << m_framePacer.lateCount()
+                   << "skipped:" << m_framePacer.skippedCount()
+                   << "duplicated:" << m_framePacer.duplicateCount()
+                   << "static skipped:" << m_frameDedup.skippedCount();
 }
 
 //通过线程循环向gstreamer管道写入视频帧数据
+void WaylandIntegration::WaylandIntegrationPrivate::releaseFrameLease(void *lease)
+{
+    //可能在 GStreamer 的流线程中调用，槽位归还只涉及原子操作
+    delete static_cast<FrameRing::Lease *>(lease);
+}
+
 void WaylandIntegration::WaylandIntegrationPrivate::gstWriteVideoFrame()
 {
     qCInfo(dsrApp) << "Starting GStreamer video frame write thread";
     waylandFrame frame;
+    FrameRing::Lease lease;
     while (isWriteVideo()) {
-        if (getFrame(frame)) {
+        if (!waitForFrame(FrameWaitTimeoutMs)) {
+            continue;
+        }
+        if (getFrame(frame, lease)) {
             qCDebug(dsrApp) << "Writing frame to GStreamer pipeline";
             if (m_gstRecordX) {
-                m_gstRecordX->waylandWriteVideoFrame(frame._frame, frame._width, frame._height);
+                //租约交给 GStreamer：录制区域为整屏时直接引用槽位内存，缓冲释放时归还槽位
+                FrameRing::Lease *heldLease = new FrameRing::Lease(std::move(lease));
+                if (!m_gstRecordX->waylandWriteVideoFrame(frame._frame, frame._width, frame._height, frame._stride,
+                                                          frame._time, releaseFrameLease, heldLease)) {
+                    RecordingStats::instance()->addCounter(RecordingStats::EncodeFailed);
+                }
             } else {
                 qWarning() << "m_gstRecordX is nullptr!";
             }
+            lease.release();
         } else {
             // qDebug() << "视频缓冲区无数据！";
         }
@@ -1088,55 +1239,57 @@ void WaylandIntegration::WaylandIntegrationPrivate::gstWriteVideoFrame()
     } else {
         qWarning() << "m_gstRecordX is nullptr!";
     }
+    finishRecordingStats();
     qCInfo(dsrApp) << "GStreamer video frame write thread stopped";
 }
 
+void WaylandIntegration::WaylandIntegrationPrivate::initRecordingStats()
+{
+    RecordingStats *stats = RecordingStats::instance();
+    stats->reset();
+    m_traceFile = ConfigSettings::instance()->getValue("recorder", "trace_file").toString();
+    stats->setTraceEnabled(!m_traceFile.isEmpty());
+    qCInfo(dsrApp) << "Recording stats reset, trace file:" << m_traceFile;
+}
+
+void WaylandIntegration::WaylandIntegrationPrivate::updateFrameCounters()
+{
+    RecordingStats *stats = RecordingStats::instance();
+    stats->setCounter(RecordingStats::PacerLate, m_framePacer.lateCount());
+    stats->setCounter(RecordingStats::PacerSkipped, m_framePacer.skippedCount());
+    stats->setCounter(RecordingStats::PacerDuplicated, m_framePacer.duplicateCount());
+    stats->setCounter(RecordingStats::StaticSkipped, m_frameDedup.skippedCount());
+}
+
+void WaylandIntegration::WaylandIntegrationPrivate::finishRecordingStats()
+{
+    RecordingStats *stats = RecordingStats::instance();
+    qCInfo(dsrApp) << "Recording stats:" << QString::fromStdString(stats->toJson());
+    if (!stats->isTraceEnabled()) {
+        return;
+    }
+    stats->setTraceEnabled(false);
+    if (stats->writeChromeTrace(m_traceFile.toStdString())) {
+        qCInfo(dsrApp) << "Recording trace written to" << m_traceFile << "events:" << stats->traceEventCount();
+    } else {
+        qCWarning(dsrApp) << "Failed to write recording trace to" << m_traceFile;
+    }
+}
+
 QImage WaylandIntegration::WaylandIntegrationPrivate::getImage(
-    int32_t fd, uint32_t width, uint32_t height, uint32_t stride, uint32_t format)
+    int32_t fd, uint32_t width, uint32_t height, uint32_t stride, uint32_t format, quint32 outputKey, int64_t captureUs, int64_t *pixelsUs)
 {
-    QImage tempImage;
-    tempImage = QImage(static_cast<int>(width), static_cast<int>(height), QImage::Format_RGBA8888);
-    eglMakeCurrent(m_eglstruct.dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, m_eglstruct.ctx);
-    EGLint importAttributes[] = {EGL_WIDTH,
-                                 static_cast<int>(width),
-                                 EGL_HEIGHT,
-                                 static_cast<int>(height),
-                                 EGL_LINUX_DRM_FOURCC_EXT,
-                                 static_cast<int>(format),
-                                 EGL_DMA_BUF_PLANE0_FD_EXT,
-                                 fd,
-                                 EGL_DMA_BUF_PLANE0_OFFSET_EXT,
-                                 0,
-                                 EGL_DMA_BUF_PLANE0_PITCH_EXT,
-                                 static_cast<int>(stride),
-                                 EGL_NONE};
-    EGLImageKHR image = eglCreateImageKHR(m_eglstruct.dpy, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr, importAttributes);
-    if (image == EGL_NO_IMAGE_KHR) {
+    //轮换使用两张图片：上一张仍由 m_curNewImage 持有，另一张已无人引用时直接复用，不必每帧重新分配
+    QPair<QImage, QImage> &images = m_readbackImages[outputKey];
+    std::swap(images.first, images.second);
+    QImage &tempImage = images.first;
+    if (!tempImage.isDetached() || tempImage.width() != static_cast<int>(width) || tempImage.height() != static_cast<int>(height)) {
+        tempImage = QImage(static_cast<int>(width), static_cast<int>(height), QImage::Format_RGBA8888);
+    }
+    //EGLImage、纹理和 FBO 按缓冲区缓存，读回经 PBO 双缓冲，不等待本帧传输完成
+    if (!m_eglReader.read(outputKey, fd, width, height, stride, format, tempImage.bits(), captureUs, pixelsUs)) {
         qDebug() << "未获取到图片！！！";
-        return tempImage;
     }
-
-    // create GL 2D texture for framebuffer
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, image);
-
-    GLuint fbo;
-    glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
-    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, tempImage.bits());
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    glDeleteFramebuffers(1, &fbo);
-    glDeleteTextures(1, &texture);
-    eglDestroyImageKHR(m_eglstruct.dpy, image);
-
     return tempImage;
 }
 static int frameCount = 0;
@@ -1183,7 +1336,7 @@ void WaylandIntegration::WaylandIntegrationPrivate::setupRegistry()
                         (KWayland::Client::Output::get(reinterpret_cast<wl_output *>(const_cast<void *>(output))))->geometry();
                     // qDebug() << "screenGeometry: " << screenGeometry;
                     // qDebug() << "rbuf->isValid(): " << rbuf->isValid();
-            connect(rbuf, &KWayland::Client::RemoteBuffer::parametersObtained, this, [this, rbuf, screenGeometry] {
+            connect(rbuf, &KWayland::Client::RemoteBuffer::parametersObtained, this, [this, output, rbuf, screenGeometry] {
                         qDebug() << "正在处理buffer..."
                                  << "fd:" << rbuf->fd() << "frameCount: " << frameCount;
                         if (frameCount == 0) {
@@ -1197,106 +1350,52 @@ void WaylandIntegration::WaylandIntegrationPrivate::setupRegistry()
                             qDebug() << "Whether the current screen is in extended mode? " << m_isScreenExtension;
                         }
 
+                        //单屏（或复制模式）只使用键值为 0 的输出缓冲，多屏按 wl_output 的注册名区分
+                        const quint32 key = (m_screenCount == 1 || !m_isScreenExtension) ? 0 : outputName(output, screenGeometry);
 #ifdef KWAYLAND_REMOTE_BUFFER_RELEASE_FLAGE_ON
-                        if (m_screenCount == 1 || !m_isScreenExtension) {
-                            if (m_currentScreenBufs[0] == nullptr) {
+                        int pendingCount = 0;
+                        {
+                            QMutexLocker locker(&m_bGetScreenImageMutex);
+                            OutputBuffer &buffer = m_outputBuffers[key];
+                            if (buffer._pendingBuf == nullptr) {
                                 m_isReleaseCurrentBuffer = false;
-                                m_currentScreenRects[0] = screenGeometry;
-                                m_currentScreenBufs[0] = rbuf;
-                                // qDebug() << "m_currentScreenBufs[0] is save! fd:" << rbuf->fd();
+                                buffer._rect = screenGeometry;
+                                buffer._pendingBuf = rbuf;
                             } else {
-                                // qDebug() << "m_currentScreenBufs[0] m_isReleaseCurrentBuffer";
                                 m_isReleaseCurrentBuffer = true;
                             }
-                            frameCount++;
-                            if (m_currentScreenBufs[0] != nullptr && !m_isAppendRemoteBuffer) {
-                                m_isAppendRemoteBuffer = true;
-                                qCInfo(dsrApp) << "How many frames of data are waiting? " << frameCount;
-                                frameCount = 0;
-                                QtConcurrent::run(this, &WaylandIntegrationPrivate::appendRemoteBuffer);
-                            }
-                        } else if (m_screenCount == 2 && m_isScreenExtension) {
-                            qCDebug(dsrApp) << "Processing multi-screen buffer";
-                            if (screenGeometry.x() == 0 && screenGeometry.y() == 0) {
-                                if (m_currentScreenBufs[0] == nullptr) {
-                                    m_isReleaseCurrentBuffer = false;
-                                    m_currentScreenRects[0] = screenGeometry;
-                                    m_currentScreenBufs[0] = rbuf;
-                                    // qDebug() << "m_currentScreenBufs[0] is save! fd:" << rbuf->fd();
-                                } else {
-                                    // qDebug() << "m_currentScreenBufs[0] m_isReleaseCurrentBuffer";
-                                    m_isReleaseCurrentBuffer = true;
+                            for (auto itr = m_outputBuffers.constBegin(); itr != m_outputBuffers.constEnd(); ++itr) {
+                                if (itr->_pendingBuf != nullptr) {
+                                    pendingCount++;
                                 }
-                            } else {
-                                if (m_currentScreenBufs[1] == nullptr) {
-                                    m_isReleaseCurrentBuffer = false;
-                                    m_currentScreenBufs[1] = rbuf;
-                                    m_currentScreenRects[1] = screenGeometry;
-                                    // qDebug() << "m_currentScreenBufs[1] is save! fd:" << rbuf->fd();
-                                } else {
-                                    // qDebug() << "m_currentScreenBufs[1] m_isReleaseCurrentBuffer";
-                                    m_isReleaseCurrentBuffer = true;
-                                }
-                            }
-                            frameCount++;
-                            if ((m_currentScreenBufs[0] != nullptr && m_currentScreenBufs[1] != nullptr) &&
-                                !m_isAppendRemoteBuffer) {
-                                m_isAppendRemoteBuffer = true;
-                                qCInfo(dsrApp) << "How many frames of data are waiting? " << frameCount;
-                                frameCount = 0;
-                                QtConcurrent::run(this, &WaylandIntegrationPrivate::appendRemoteBuffer);
                             }
                         }
+                        frameCount++;
+                        //所有输出都有待拷贝的buffer后启动拷贝线程
+                        if (pendingCount >= expectedOutputCount() && !m_isAppendRemoteBuffer) {
+                            m_isAppendRemoteBuffer = true;
+                            qCInfo(dsrApp) << "How many frames of data are waiting? " << frameCount;
+                            frameCount = 0;
+                            QtConcurrent::run(this, &WaylandIntegrationPrivate::appendRemoteBuffer);
+                        }
 #else
-                bool flag = false;
-                int screenId = 0;
-                if (m_screenCount == 1 || !m_isScreenExtension)
-                {
-                    //抽帧（数据过来60帧，取一半，由于memcpy一帧数据需要30ms，无法满足1s60帧的速度，所以需要抽帧）
-                    flag = (frameCount++ % 2 == 0);
-                    if (flag)
-                    {
-                        if (m_boardVendorType) {
-                            //arm hw
-                            //processBuffer(rbuf, screenGeometry);
-                            processBufferHw(rbuf, screenGeometry, screenId);
-                        } else {
-                            //other
-                    processBufferX86(rbuf, screenGeometry);
-                }
-                    }
-                }
-                else if(m_screenCount == 2 && m_isScreenExtension){
-                    if (frameCount == 0) {
-                        //第一帧画面的坐标不是从（0,0）开始，从第二帧开始取
-                        if (screenGeometry.x() != 0 || screenGeometry.y() != 0) {
-                            frameCount += 1;
+                        frameCount++;
+                        //抽帧（每个输出的数据过来60帧，取一半，由于memcpy一帧数据需要30ms，无法满足1s60帧的速度，所以需要抽帧）
+                        bool flag = false;
+                        {
+                            QMutexLocker locker(&m_bGetScreenImageMutex);
+                            flag = (m_outputBuffers[key]._receivedCount++ % 2 == 0);
                         }
-                    }
-                    //抽帧（数据过来60帧，取一半）
-                    if (frameCount % 4 == 0) {
-                        screenId = 0;
-                    } else if ((frameCount - 1) % 4 == 0) {
-                        screenId = 1;
-                    }
-                    flag = (frameCount % 4 == 0) || (((frameCount - 1) != 0) && (frameCount - 1) % 4 == 0);
-                    frameCount++;
-                    if (flag)
-                    {
-                        if (m_boardVendorType) {
-                            //arm hw
-                            //processBuffer(rbuf, screenGeometry);
-                            processBufferHw(rbuf, screenGeometry, screenId);
-                        } else {
-                            //other
-                            processBufferX86(rbuf, screenGeometry);
+                        if (flag) {
+                            if (m_boardVendorType) {
+                                //arm hw
+                                processBufferHw(rbuf, screenGeometry, key);
+                            } else {
+                                //other
+                                processBufferX86(rbuf, screenGeometry, key);
+                            }
                         }
-                    }
-                }
 #endif
-                        else {
-                            qWarning() << "Currently,recording with more than two screens is not supported!";
-                        }
 #ifdef KWAYLAND_REMOTE_FLAGE_ON
                         // qDebug() << "rbuf->frame(): " << rbuf->frame();
                         if (rbuf->frame() == 0) {
@@ -1374,126 +1473,94 @@ void WaylandIntegration::WaylandIntegrationPrivate::initEgl()
         qCCritical(dsrApp) << "Failed to create EGL context";
         return;
     }
+    m_eglReader.setContext(m_eglstruct.dpy, m_eglstruct.ctx);
 
     printf("egl init success!\n");
 }
 void WaylandIntegration::WaylandIntegrationPrivate::appendBuffer(
-    unsigned char *frame, int width, int height, int stride, int64_t time)
+    const unsigned char *frame, int width, int height, int stride, int64_t time, int srcStride)
 {
+    RecordingStats::Scope statsScope(RecordingStats::AppendBuffer);
     qCDebug(dsrApp) << "Appending buffer with dimensions:" << width << "x" << height;
     if (!bGetFrame() || nullptr == frame || width <= 0 || height <= 0) {
         qCWarning(dsrApp) << "Invalid buffer parameters, skipping append";
         return;
     }
     int size = height * stride;
-    unsigned char *ch = nullptr;
     if (m_bInit) {
         qCDebug(dsrApp) << "Initializing buffer with size:" << size;
         m_bInit = false;
         m_width = width;
         m_height = height;
         m_stride = stride;
-        m_ffmFrame = new unsigned char[static_cast<unsigned long>(size)];
-        for (int i = 0; i < m_bufferSize; i++) {
-            ch = new unsigned char[static_cast<unsigned long>(size)];
-            m_freeList.append(ch);
-            // qDebug() << "创建内存空间";
+        //一次性预分配所有槽位，录制过程中不再申请内存
+        if (!m_frameRing.init(m_bufferSize, static_cast<size_t>(size), m_frameRingPolicy)) {
+            qCCritical(dsrApp) << "Failed to allocate frame ring, capacity:" << m_bufferSize << "frame size:" << size;
+            return;
         }
     }
-    QMutexLocker locker(&m_mutex);
-    if (m_waylandList.size() >= m_bufferSize) {
-        qCDebug(dsrApp) << "Buffer full, recycling first frame";
-        waylandFrame wFrame = m_waylandList.first();
-        memset(wFrame._frame, 0, static_cast<size_t>(size));
-        //拷贝当前帧
-        memcpy(wFrame._frame, frame, static_cast<size_t>(size));
-        wFrame._time = time;
-        wFrame._width = width;
-        wFrame._height = height;
-        wFrame._stride = stride;
-        wFrame._index = 0;
-        m_waylandList.first()._frame = nullptr;
-        //删队首
-        m_waylandList.removeFirst();
-        //存队尾
-        m_waylandList.append(wFrame);
-        // qDebug() << "环形缓冲区已满，删队首，存队尾";
-    } else if (0 <= m_waylandList.size() && m_waylandList.size() < m_bufferSize) {
-        if (m_freeList.size() > 0) {
-            qCDebug(dsrApp) << "Adding new frame to buffer";
-            waylandFrame wFrame;
-            wFrame._time = time;
-            wFrame._width = width;
-            wFrame._height = height;
-            wFrame._stride = stride;
-            wFrame._index = 0;
-            //分配空闲内存
-            wFrame._frame = m_freeList.first();
-            memset(wFrame._frame, 0, static_cast<size_t>(size));
-            //拷贝wayland推送的视频帧
-            memcpy(wFrame._frame, frame, static_cast<size_t>(size));
-            m_waylandList.append(wFrame);
-            // qDebug() << "环形缓冲区未满，存队尾"
-            //空闲内存占用，仅删除索引，不删除空间
-            m_freeList.removeFirst();
-        }
+    //缓冲区满时按 m_frameRingPolicy 处理（默认丢弃最旧的一帧）
+    if (!m_frameRing.push(frame, width, height, stride, time, srcStride)) {
+        qCDebug(dsrApp) << "Frame dropped, total dropped:" << m_frameRing.droppedCount();
     }
-    qCDebug(dsrApp) << "Buffer append completed, current size:" << m_waylandList.size();
+    RecordingStats *stats = RecordingStats::instance();
+    stats->setCounter(RecordingStats::RingPushed, m_frameRing.pushedCount());
+    stats->setCounter(RecordingStats::RingDropped, m_frameRing.droppedCount());
+    stats->setRingOccupancy(m_frameRing.size(), m_frameRing.capacity());
+    qCDebug(dsrApp) << "Buffer append completed, current size:" << m_frameRing.size();
 }
 
 void WaylandIntegration::WaylandIntegrationPrivate::initScreenFrameBuffer()
 {
     qCDebug(dsrApp) << "Initializing screen frame buffers";
-    m_ScreenDateBufFrames[0]._frame = nullptr;
-    m_ScreenDateBufFrames[0]._width = 0;
-    m_ScreenDateBufFrames[0]._height = 0;
-    m_ScreenDateBufFrames[0]._format = QImage::Format_RGBA8888;
-    m_ScreenDateBufFrames[0]._rect = QRect(0, 0, 0, 0);
-    m_ScreenDateBufFrames[0]._flag = false;
-    m_ScreenDateBufFrames[1]._frame = nullptr;
-    m_ScreenDateBufFrames[1]._width = 0;
-    m_ScreenDateBufFrames[1]._height = 0;
-    m_ScreenDateBufFrames[1]._format = QImage::Format_RGBA8888;
-    m_ScreenDateBufFrames[1]._rect = QRect(0, 0, 0, 0);
-    m_ScreenDateBufFrames[1]._flag = false;
-    m_curNewImageScreenFrames[0]._frame = nullptr;
-    m_curNewImageScreenFrames[0]._width = 0;
-    m_curNewImageScreenFrames[0]._height = 0;
-    m_curNewImageScreenFrames[0]._format = QImage::Format_RGBA8888;
-    m_curNewImageScreenFrames[0]._rect = QRect(0, 0, 0, 0);
-    m_curNewImageScreenFrames[0]._flag = false;
-    m_curNewImageScreenFrames[1]._frame = nullptr;
-    m_curNewImageScreenFrames[1]._width = 0;
-    m_curNewImageScreenFrames[1]._height = 0;
-    m_curNewImageScreenFrames[1]._format = QImage::Format_RGBA8888;
-    m_curNewImageScreenFrames[1]._rect = QRect(0, 0, 0, 0);
-    m_curNewImageScreenFrames[1]._flag = false;
+    m_curNewImageData._frame = nullptr;
+    m_curNewImageData._width = 0;
+    m_curNewImageData._height = 0;
+    m_curNewImageData._stride = 0;
+    m_curNewImageData._format = QImage::Format_RGBA8888;
+    m_curNewImageData._rect = QRect(0, 0, 0, 0);
+    m_curNewImageData._flag = false;
     qCDebug(dsrApp) << "Screen frame buffers initialized";
 }
 
+void WaylandIntegration::WaylandIntegrationPrivate::releaseOutputBuffers()
+{
+    QMutexLocker locker(&m_bGetScreenImageMutex);
+    OutputBuffers::release(m_outputBuffers);
+    m_curNewImageData._frame = nullptr;
+    qCDebug(dsrApp) << "Output buffers released.";
+}
+
 void WaylandIntegration::WaylandIntegrationPrivate::appendRemoteBuffer()
 {
     qCInfo(dsrApp) << "Start append remote buffer...";
     while (m_isAppendRemoteBuffer) {
-        // qDebug() << "Appending remote buffer...";
-        if (m_currentScreenBufs[0] != nullptr) {
-            qCDebug(dsrApp) << "Processing first screen buffer";
-            m_mutex.lock();
-            processBufferHw(m_currentScreenBufs[0], m_currentScreenRects[0], 0);
-        } else {
-            qCDebug(dsrApp) << "Copying screen data for first screen";
-            copyScreenData(0);
-        }
-        
-        if (m_screenCount == 2 && m_isScreenExtension) {
-            qCDebug(dsrApp) << "Processing multi-screen setup";
-            if (m_currentScreenBufs[1] != nullptr) {
-                qCDebug(dsrApp) << "Processing second screen buffer";
+        //按键值依次处理每个输出，每次只在查找时持锁，循环中不分配内存
+        quint32 nextKey = 0;
+        bool hasNext = true;
+        while (hasNext) {
+            quint32 key = 0;
+            QRect rect;
+            KWayland::Client::RemoteBuffer *rbuf = nullptr;
+            {
+                QMutexLocker locker(&m_bGetScreenImageMutex);
+                auto itr = m_outputBuffers.lowerBound(nextKey);
+                if (itr == m_outputBuffers.end()) {
+                    break;
+                }
+                key = itr.key();
+                rect = itr->_rect;
+                rbuf = itr->_pendingBuf;
+            }
+            hasNext = key != std::numeric_limits<quint32>::max();
+            nextKey = key + 1;
+            if (rbuf != nullptr) {
+                qCDebug(dsrApp) << "Processing remote buffer of output" << key;
                 m_mutex.lock();
-                processBufferHw(m_currentScreenBufs[1], m_currentScreenRects[1], 1);
+                processBufferHw(rbuf, rect, key);
             } else {
-                qCDebug(dsrApp) << "Copying screen data for second screen";
-                copyScreenData(1);
+                qCDebug(dsrApp) << "Copying screen data for output" << key;
+                copyScreenData(key);
             }
         }
     }
@@ -1502,42 +1569,32 @@ void WaylandIntegration::WaylandIntegrationPrivate::appendRemoteBuffer()
 
 int WaylandIntegration::WaylandIntegrationPrivate::frameIndex = 0;
 
-bool WaylandIntegration::WaylandIntegrationPrivate::getFrame(waylandFrame &frame)
+bool WaylandIntegration::WaylandIntegrationPrivate::getFrame(waylandFrame &frame, FrameRing::Lease &lease)
 {
+    RecordingStats::Scope statsScope(RecordingStats::GetFrame);
     qCDebug(dsrApp) << "Attempting to get frame from buffer";
-    QMutexLocker locker(&m_mutex);
-    if (m_waylandList.size() <= 0 || nullptr == m_ffmFrame) {
+    //取最旧的一帧（先进先出），直接引用槽位内存，lease释放后槽位归还给生产者
+    if (!FrameWriter::acquire(m_frameRing, lease, frame, frameIndex)) {
         qCDebug(dsrApp) << "No frames available in buffer or frame buffer not initialized";
-        frame._width = 0;
-        frame._height = 0;
-        frame._frame = nullptr;
         return false;
-    } else {
-        int size = m_height * m_stride;
-        //取队首，先进先出
-        waylandFrame wFrame = m_waylandList.first();
-        frame._width = wFrame._width;
-        frame._height = wFrame._height;
-        frame._stride = wFrame._stride;
-        frame._time = wFrame._time;
-        // m_ffmFrame 视频帧缓存
-        frame._frame = m_ffmFrame;
-        frame._index = frameIndex++;
-        //拷贝到 m_ffmFrame 视频帧缓存
-        memcpy(frame._frame, wFrame._frame, static_cast<size_t>(size));
-        m_waylandList.first()._frame = nullptr;
-        //删队首视频帧 waylandFrame，未删空闲内存 waylandFrame::_frame，只删索引，不删内存空间
-        m_waylandList.removeFirst();
-        //回收空闲内存，重复使用
-        m_freeList.append(wFrame._frame);
-        // qDebug() << "获取视频帧";
-        return true;
     }
+    return true;
+}
+
+bool WaylandIntegration::WaylandIntegrationPrivate::waitForFrame(int timeoutMs)
+{
+    return m_frameRing.waitForFrame(timeoutMs);
 }
 
 bool WaylandIntegration::WaylandIntegrationPrivate::isWriteVideo()
 {
-    QMutexLocker locker(&m_mutex);
+    if (!m_frameRing.isEmpty()) {
+        return true;
+    }
+    //采集端已停止且缓冲区已取空，写帧线程可以退出
+    if (m_frameRing.isClosed()) {
+        return false;
+    }
     if (Utils::isFFmpegEnv) {
         if (m_recordAdmin->m_writeFrameThread->bWriteFrame()) {
             return true;
@@ -1547,7 +1604,7 @@ bool WaylandIntegration::WaylandIntegrationPrivate::isWriteVideo()
             return true;
         }
     }
-    return !m_waylandList.isEmpty();
+    return false;
 }
 
 bool WaylandIntegration::WaylandIntegrationPrivate::bGetFrame()
@@ -1560,6 +1617,12 @@ void WaylandIntegration::WaylandIntegrationPrivate::setBGetFrame(bool bGetFrame)
 {
     QMutexLocker locker(&m_bGetFrameMutex);
     m_bGetFrame = bGetFrame;
+    //停止采集时关闭环形缓冲区，唤醒阻塞等待的写帧线程，取完剩余帧后退出
+    if (bGetFrame) {
+        m_frameRing.reopen();
+    } else {
+        m_frameRing.close();
+    }
 }
 
 int WaylandIntegration::WaylandIntegrationPrivate::getPadStride(int width, int depth, int pad)
@@ -1571,12 +1634,27 @@ int WaylandIntegration::WaylandIntegrationPrivate::getPadStride(int width, int d
     return content + pad - content % pad;
 }
 
+void WaylandIntegration::WaylandIntegrationPrivate::copyBufferRegion(unsigned char *dst,
+                                                                     const unsigned char *src,
+                                                                     int srcStride,
+                                                                     const QRect &region)
+{
+    const size_t rowBytes = static_cast<size_t>(region.width()) * 4;
+    const unsigned char *row = src + static_cast<size_t>(region.y()) * static_cast<size_t>(srcStride)
+                               + static_cast<size_t>(region.x()) * 4;
+    for (int i = 0; i < region.height(); i++) {
+        memcpy(dst, row, rowBytes);
+        row += srcStride;
+        dst += rowBytes;
+    }
+}
+
 void WaylandIntegration::WaylandIntegrationPrivate::copyBuffer(unsigned char *tmpDst,
-                                                               unsigned char *tmpSrc,
+                                                               const unsigned char *tmpSrc,
                                                                const KWayland::Client::RemoteBuffer *rbuf)
 {
     unsigned char *dst = tmpDst;
-    unsigned char *buf = tmpSrc;
+    const unsigned char *buf = tmpSrc;
     int srcStride = getPadStride(rbuf->width(), 4, 32);
     qDebug() << "current strade" << srcStride;
 
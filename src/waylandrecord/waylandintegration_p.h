@@ -10,12 +10,22 @@
 #include <QDateTime>
 #include <QObject>
 #include <QMap>
+#include <QHash>
 #include <QImage>
 #include <gbm.h>
 #include <epoxy/egl.h>
 #include <epoxy/gl.h>
 #include <QMutex>
 #include <EGL/egl.h>
+#include <atomic>
+#include "framering.h"
+#include "waylandframe.h"
+#include "framepacer.h"
+#include "framededup.h"
+#include "framecompositor.h"
+#include "outputbuffers.h"
+#include "egldmabufreader.h"
+#include "../utils/dmabufmapcache.h"
 
 class RecordAdmin;
 class ScreenCastStream;
@@ -44,16 +54,7 @@ public:
         EGLConfig conf;
     };
     //缓存帧
-    struct waylandFrame {
-        //时间戳
-        int64_t _time;
-        //索引
-        int _index;
-        int _width;
-        int _height;
-        int _stride;
-        unsigned char *_frame;
-    };
+    typedef WaylandFrame waylandFrame;
 
     struct FrameData {
         quint32 _width;
@@ -63,6 +64,8 @@ public:
         QImage::Format _format;
         QRect _rect ;
         bool _flag;
+        //_frame 所在输出缓冲的键值，取帧时按它租用画面
+        quint32 _key;
     };
 
     typedef struct {
@@ -128,13 +131,19 @@ protected Q_SLOTS:
      * @param rbuf
      */
     void processBuffer(const KWayland::Client::RemoteBuffer *rbuf, const QRect rect);
-    void processBufferHw(const KWayland::Client::RemoteBuffer *rbuf, const QRect rect,int screenId = 0);
+    /**
+     * @brief processBufferHw hw机器拷贝远程buffer的数据到对应输出的缓冲
+     * @param rbuf
+     * @param rect 屏幕在虚拟桌面中的位置
+     * @param outputKey 输出的键值，单屏（或复制模式）为 0，见 outputName()
+     */
+    void processBufferHw(const KWayland::Client::RemoteBuffer *rbuf, const QRect rect, quint32 outputKey = 0);
 
     /**
      * @brief copyScreenData 拷贝数据，当远程buffer没有数据传过来时，调用此接口，将上一次的屏幕数据做为当前的屏幕数据
-     * @param screenId
+     * @param outputKey 输出的键值
      */
-    void copyScreenData(int screenId);
+    void copyScreenData(quint32 outputKey);
 
     /**
      * @brief getImageFormat 根据wayland客户端bufferReady给过来的像素格式，转成QImage的格式
@@ -143,11 +152,20 @@ protected Q_SLOTS:
      */
     QImage::Format getImageFormat(quint32 format);
 
+    /**
+     * @brief pixelOrder QImage格式对应的内存字节顺序，用于多屏合成
+     * @param format QImage的格式
+     * @param opaque 是否为 X 通道格式（合成时 alpha 填成 0xff）
+     * @return 字节顺序
+     */
+    static FrameCompositor::PixelOrder pixelOrder(QImage::Format format, bool &opaque);
+
     /**
      * @brief 此接口为了解决x86架构录屏mmap失败及花屏问题
      * @param rbuf
+     * @param outputKey 输出的键值，单屏（或复制模式）为 0，见 outputName()
      */
-    void processBufferX86(const KWayland::Client::RemoteBuffer *rbuf, const QRect rect);
+    void processBufferX86(const KWayland::Client::RemoteBuffer *rbuf, const QRect rect, quint32 outputKey = 0);
     /**
      * @brief 通过线程每30ms钟向数据池中取出一张图片添加到环形缓冲区，以便后续视频编码
      */
@@ -158,6 +176,24 @@ protected Q_SLOTS:
      */
     void gstWriteVideoFrame();
 
+    /**
+     * @brief GStreamer 用完视频帧后归还环形缓冲区的槽位，lease 为 new 出的 FrameRing::Lease
+     */
+    static void releaseFrameLease(void *lease);
+
+    /**
+     * @brief 开始录制前清空运行统计，按配置 recorder/trace_file 决定是否记录跟踪事件
+     */
+    void initRecordingStats();
+    /**
+     * @brief 将取帧线程的节拍、静止画面计数同步到运行统计
+     */
+    void updateFrameCounters();
+    /**
+     * @brief 停止录制后输出运行统计，开启跟踪时写出 Chrome trace 文件
+     */
+    void finishRecordingStats();
+
     /**
         * @brief 从wayland客户端获取当前屏幕的截图
         * @param fd
@@ -165,9 +201,19 @@ protected Q_SLOTS:
         * @param height
         * @param stride
         * @param format
-        * @return
+        * @param outputKey 输出的键值，每个输出各自做双缓冲读回
+        * @param captureUs 本次画面的采集时间
+        * @param pixelsUs 返回画面的采集时间
+        * @return 该输出上一次送来的画面（首帧为本次画面）
         */
-    QImage getImage(int32_t fd, uint32_t width, uint32_t height, uint32_t stride, uint32_t format);
+    QImage getImage(int32_t fd, uint32_t width, uint32_t height, uint32_t stride, uint32_t format, quint32 outputKey,
+                    int64_t captureUs, int64_t *pixelsUs);
+
+    /**
+     * @brief x86 路径停止前取出各输出最后读入、尚未输出的画面，等待 appendFrameToList 写入
+     * PBO 双缓冲的输出比输入晚一帧，不取出时录像会少最后一帧
+     */
+    void flushReadback();
 
     /**
      * @brief 安装注册wayland客户服务
@@ -187,25 +233,72 @@ private:
      * @param height:视频帧高
      * @param stride:通道数
      * @param time:时间戳
+     * @param srcStride:frame每行的字节数，从整屏画面中截取区域时大于 stride，0 表示与 stride 相同
      */
-    void appendBuffer(unsigned char *frame, int width, int height, int stride, int64_t time);
+    void appendBuffer(const unsigned char *frame, int width, int height, int stride, int64_t time, int srcStride = 0);
     /**
-     * @brief initScreenFrameBuffer 初始化屏幕数据数组
+     * @brief initScreenFrameBuffer 初始化屏幕数据
      */
     void initScreenFrameBuffer();
+    /**
+     * @brief releaseOutputBuffers 释放所有输出的采集缓冲
+     */
+    void releaseOutputBuffers();
+    /**
+     * @brief outputName 由 bufferReady 给出的 wl_output 查找输出的注册名
+     * @param output wl_output
+     * @param geometry 屏幕位置，未绑定的输出按位置生成键值
+     * @return 输出的键值
+     */
+    quint32 outputName(const void *output, const QRect &geometry) const;
+    /**
+     * @brief expectedOutputCount 合成一帧需要的输出数量，单屏或复制模式为 1
+     */
+    int expectedOutputCount() const;
+    /**
+     * @brief readyOutputCount 已有待合成画面的输出数量，调用方需持有 m_bGetScreenImageMutex
+     */
+    int readyOutputCount() const;
     /**
      * @brief appendRemoteBuffer 在线程中拷贝远程buffer（remoteaccess传过来的屏幕buffer）的数据
      */
     void appendRemoteBuffer();
 public:
     /**
-     * @ 内存由getFrame函数内部申请
-     * @ 保存视频帧之后，无需：delete <unsigned char* frame>
+     * @ frame._frame 直接指向环形缓冲区的槽位内存，不再拷贝
+     * @ 槽位在 lease 释放（析构）前不会被覆盖，写完视频帧后应尽快释放 lease
      * @brief getFrame:获取帧
      * @param frame:视频帧
+     * @param lease:槽位租约
      * @return
      */
-    bool getFrame(waylandFrame &frame);
+    bool getFrame(waylandFrame &frame, FrameRing::Lease &lease);
+
+    /**
+     * @brief pushFrame 不经过 KWayland 采集，直接向环形缓冲区写入一帧
+     * 供录制基准测试等没有合成器的场景驱动编码流程，行为与采集线程调用 appendBuffer 相同
+     * @param time 采集时间（CaptureClock::nowUs）
+     */
+    void pushFrame(const unsigned char *frame, int width, int height, int stride, int64_t time)
+    {
+        appendBuffer(frame, width, height, stride, time);
+    }
+
+    /**
+     * @brief waitForFrame 阻塞等待缓冲区中有可读的视频帧，替代写帧线程的空转
+     * @param timeoutMs 最长等待时间，超时后调用方应重新检查 isWriteVideo
+     * @return 有可读帧时返回 true
+     */
+    bool waitForFrame(int timeoutMs);
+
+    /**
+     * @brief 写帧线程等待视频帧的超时时间（毫秒）
+     */
+    static const int FrameWaitTimeoutMs = 100;
+    /**
+     * @brief 画面静止时至少每隔多久仍写入一帧（微秒，与 av_gettime 相同）
+     */
+    static const int64_t StaticFrameKeepAliveUs = 1000000;
 
     bool isWriteVideo();
 
@@ -218,6 +311,14 @@ public:
      */
     bool m_appendFrameToListFlag = false;
 
+    /**
+     * @brief 取帧线程的节拍统计（目标/实际帧率、迟到与重复节拍数）
+     */
+    const FramePacer &framePacer() const
+    {
+        return m_framePacer;
+    }
+
     /**
      * @brief getPadStride
      * @param width: rbuf width
@@ -233,7 +334,16 @@ public:
      * @param tmpSrc: kde cache
      * @param rbuf
      */
-    void copyBuffer(unsigned char * tmpDst, unsigned char * tmpSrc, const KWayland::Client::RemoteBuffer *rbuf);
+    void copyBuffer(unsigned char * tmpDst, const unsigned char * tmpSrc, const KWayland::Client::RemoteBuffer *rbuf);
+
+    /**
+     * @brief copyBufferRegion 只拷贝录制区域内的行和列，目标每行 region.width() * 4 字节
+     * @param dst: app cache
+     * @param src: kde cache
+     * @param srcStride: kde cache 每行字节数
+     * @param region: 区域（src 内坐标）
+     */
+    void copyBufferRegion(unsigned char *dst, const unsigned char *src, int srcStride, const QRect &region);
 private:
     /**
      * @brief 是否是hw电脑
@@ -247,18 +357,17 @@ private:
     int m_stride = 0;
     bool m_bInit;
     QMutex m_mutex;
-    //wayland缓冲区
-    QList<waylandFrame> m_waylandList;
-    //空闲内存
-    QList<unsigned char *> m_freeList;
+    //wayland缓冲区，appendBuffer写入、getFrame读取的无锁环形缓冲区
+    FrameRing m_frameRing;
+    //缓冲区满时的处理策略
+    FrameRing::OverflowPolicy m_frameRingPolicy = FrameRing::DropOldest;
 
+    //x86 单屏最新画面，first 为画面的采集时间
     QPair<qint64, QImage> m_curNewImage;
     FrameData m_curNewImageData;
 
 
 
-    //ffmpeg视频帧
-    unsigned char *m_ffmFrame;
     //起始时间戳
     int64_t frameStartTime = 0;
     //是否获取视频帧
@@ -292,27 +401,70 @@ private:
      * @brief 自定义egl的结构体
      */
     struct EglStruct m_eglstruct;
+    /**
+     * @brief m_eglReader 缓存 dma-buf 的 EGL 导入，经 PBO 双缓冲读回像素（x86 路径）
+     */
+    EglDmaBufReader m_eglReader;
+    /**
+     * @brief m_readbackImages getImage 每个输出轮换使用的两张图片
+     */
+    QMap<quint32, QPair<QImage, QImage>> m_readbackImages;
     QMutex m_bGetScreenImageMutex;
+    /**
+     * @brief m_screenImageSerial 采集到新画面时递增（受 m_bGetScreenImageMutex 保护），用于识别重复帧
+     */
+    quint64 m_screenImageSerial = 0;
+    /**
+     * @brief m_appendedImageSerial appendFrameToList 已处理完的画面代数，flushReadback 等待它追上最后一帧
+     */
+    std::atomic<quint64> m_appendedImageSerial{0};
+    /**
+     * @brief m_framePacer appendFrameToList 的帧节拍器
+     */
+    FramePacer m_framePacer;
+    /**
+     * @brief m_frameDedup 静止画面检测，画面未变化的帧不进入环形缓冲区（仅 FFmpeg 录制）
+     */
+    FrameDedup m_frameDedup;
+    /**
+     * @brief m_dmaBufMaps 合成器缓冲区的映射缓存，按缓冲区复用映射，停止录制时释放
+     */
+    DmaBufMapCache m_dmaBufMaps;
+    /**
+     * @brief m_traceFile 跟踪事件的输出文件，为空时不记录跟踪事件
+     */
+    QString m_traceFile;
     QMap<QString, QRect> m_screenId2Point;
-    //双屏情况
+    //多屏情况
     QVector<QPair<QRect, QImage>> m_ScreenDateBuf;
     QVector<QPair<QRect, QImage>> m_curNewImageScreen;
-    //hw双屏
-    unsigned char *m_firstScreenData = nullptr;
-    unsigned char *m_secondScreenData = nullptr;
-
-    //第一次拷贝数据的时候需要开辟内存空间
-    bool m_isExistFirstScreenData = false;
-    bool m_isExistSecondScreenData = false;
-    FrameData m_ScreenDateBufFrames[2];
-    FrameData m_curNewImageScreenFrames[2];
-
     /**
-     * @brief m_lastScreenData 上一帧数据
+     * @brief m_screenDataUs/m_curNewImageScreenUs x86 多屏画面中最早的采集时间
+     */
+    int64_t m_screenDataUs = -1;
+    int64_t m_curNewImageScreenUs = 0;
+    /**
+     * @brief m_readbackRects x86 多屏各输出的位置，flushReadback 取出的画面按它拼接
+     */
+    QMap<quint32, QRect> m_readbackRects;
+    /**
+     * @brief m_outputBuffers hw机器各输出的采集缓冲，键为 wl_output 的注册名（受 m_bGetScreenImageMutex 保护）
+     */
+    OutputBuffers::Map m_outputBuffers;
+    /**
+     * @brief m_wlOutputNames 已绑定的 wl_output 到注册名的映射
      */
-    FrameData m_lastScreenDatas[2];
+    QHash<const void *, quint32> m_wlOutputNames;
+    /**
+     * @brief m_compositor 多屏合成画布，只在屏幕布局变化时重新分配
+     */
+    FrameCompositor m_compositor;
 
     QSize m_screenSize;
+    /**
+     * @brief m_captureRegion 录制区域（虚拟桌面坐标），有效时采集端即按该区域裁剪，缓冲区按区域大小分配
+     */
+    QRect m_captureRegion;
     int m_screenCount;
 
     /**
@@ -330,15 +482,6 @@ private:
      * @brief m_isAppendRemoteBuffer 拷贝远程buffer（remoteaccess传过来的屏幕buffer）的线程是否继续执行
      */
     bool m_isAppendRemoteBuffer = false;
-    /**
-     * @brief m_currentScreenRect 当前屏幕的大小
-     */
-    QRect m_currentScreenRects[2];
-
-    /**
-     * @brief m_currentScreenBuf 当前屏幕的远程buffer（remoteaccess传过来的屏幕buffer）
-     */
-    KWayland::Client::RemoteBuffer * m_currentScreenBufs[2];
 
     /**
      * @brief m_isScreenExtension 当前屏幕模式是否是扩展模式
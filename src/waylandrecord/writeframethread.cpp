@@ -8,6 +8,7 @@
 #include <qdebug.h>
 #include <qimage.h>
 #include "recordadmin.h"
+#include "framewriter.h"
 #include "../utils/log.h"
 
 WriteFrameThread::WriteFrameThread(WaylandIntegration::WaylandIntegrationPrivate* context, QObject *parent) :
@@ -28,12 +29,22 @@ void WriteFrameThread::run()
     }
 
     m_context->m_recordAdmin->m_cacheMutex.lock();
+    CAVOutputStream *outputStream = m_context->m_recordAdmin->m_pOutputStream;
+    const FrameWriter::WriteFunc writeFrame = [outputStream](WaylandFrame &frame) {
+        return outputStream->writeVideoFrame(frame);
+    };
     WaylandIntegration::WaylandIntegrationPrivate::waylandFrame frame;
+    FrameRing::Lease lease;
     qCDebug(dsrApp) << "Starting frame writing loop";
     while (m_context->isWriteVideo()) {
-        if (m_context->getFrame(frame)) {
+        //缓冲区为空时阻塞等待，停止录制时 setBGetFrame(false) 会立即唤醒
+        if (!m_context->waitForFrame(WaylandIntegration::WaylandIntegrationPrivate::FrameWaitTimeoutMs)) {
+            continue;
+        }
+        if (m_context->getFrame(frame, lease)) {
             qCDebug(dsrApp) << "Received frame, writing video frame";
-            m_context->m_recordAdmin->m_pOutputStream->writeVideoFrame(frame);
+            //编码器直接读取环形缓冲区槽位，写完立即归还
+            FrameWriter::write(writeFrame, frame, lease);
         } else {
             qCDebug(dsrApp) << "No frame available, continuing loop";
         }
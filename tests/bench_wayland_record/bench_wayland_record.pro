@@ -0,0 +1,74 @@
+######################################################################
+# Wayland 录屏编码吞吐量基准测试，不需要 KWayland 合成器，可在无界面的 CI 机器上运行
+######################################################################
+TEMPLATE = app
+TARGET = bench_wayland_record
+CONFIG += console c++17 link_pkgconfig
+CONFIG -= app_bundle
+
+# 只编译不依赖 KWayland 的编码层（与 ut_screen_shot_recorder.pro 相同），画面经 FrameRing 直接交给
+# CAVOutputStream，不编译 waylandintegration/writeframethread/recordadmin，在 KF6 和 FFmpeg 5 以上的环境中同样可以构建。
+# 录制流程在 benchrun.cpp 中，单元测试也编译它，见 ut_screen_shot_recorder/waylandrecord/ut_benchrun.h
+INCLUDEPATH += . ../../src/ \
+            ../compat
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+QT += core gui widgets dbus concurrent
+LIBS += -ldl
+PKGCONFIG += dtk6gui dtk6widget glib-2.0 gstreamer-1.0
+
+QMAKE_CXXFLAGS += -O2 -g
+QMAKE_CXXFLAGS += -Wno-error=deprecated-declarations -Wno-deprecated-declarations
+
+HEADERS += benchrun.h \
+    syntheticframes.h \
+    ../../src/waylandrecord/avoutputstream.h \
+    ../../src/waylandrecord/avlibinterface.h \
+    ../../src/waylandrecord/channellayouts.h \
+    ../../src/waylandrecord/waylandframe.h \
+    ../../src/waylandrecord/framering.h \
+    ../../src/waylandrecord/framewriter.h \
+    ../../src/waylandrecord/framepacer.h \
+    ../../src/waylandrecord/slicepool.h \
+    ../../src/waylandrecord/stagequeue.h \
+    ../../src/waylandrecord/audiosamplefifo.h \
+    ../../src/waylandrecord/reusepool.h \
+    ../../src/waylandrecord/fragmentoptions.h \
+    ../../src/waylandrecord/audiomixer.h \
+    ../../src/waylandrecord/captureclock.h \
+    ../../src/waylandrecord/audiodriftmonitor.h \
+    ../../src/gstrecord/gstrecordx.h \
+    ../../src/gstrecord/gstinterface.h \
+    ../../src/gstrecord/recordareacrop.h \
+    ../../src/gstrecord/capturepts.h \
+    ../../src/utils/configsettings.h \
+    ../../src/utils/i420converter.h \
+    ../../src/utils/recordingstats.h \
+    ../../src/utils/log.h
+
+SOURCES += main.cpp \
+    benchrun.cpp \
+    syntheticframes.cpp \
+    benchutils.cpp \
+    ../../src/waylandrecord/avoutputstream.cpp \
+    ../../src/waylandrecord/avlibinterface.cpp \
+    ../../src/waylandrecord/channellayouts.cpp \
+    ../../src/waylandrecord/framering.cpp \
+    ../../src/waylandrecord/framewriter.cpp \
+    ../../src/waylandrecord/framepacer.cpp \
+    ../../src/waylandrecord/slicepool.cpp \
+    ../../src/waylandrecord/stagequeue.cpp \
+    ../../src/waylandrecord/audiosamplefifo.cpp \
+    ../../src/waylandrecord/audiomixer.cpp \
+    ../../src/waylandrecord/fragmentoptions.cpp \
+    ../../src/waylandrecord/captureclock.cpp \
+    ../../src/waylandrecord/audiodriftmonitor.cpp \
+    ../../src/gstrecord/gstrecordx.cpp \
+    ../../src/gstrecord/gstinterface.cpp \
+    ../../src/gstrecord/recordareacrop.cpp \
+    ../../src/gstrecord/capturepts.cpp \
+    ../../src/utils/configsettings.cpp \
+    ../../src/utils/i420converter.cpp \
+    ../../src/utils/recordingstats.cpp \
+    ../../src/utils/log.cpp
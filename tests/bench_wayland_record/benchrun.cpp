@@ -0,0 +1,162 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "benchrun.h"
+
+#include "../../src/waylandrecord/avlibinterface.h"
+#include "../../src/waylandrecord/avoutputstream.h"
+#include "../../src/waylandrecord/captureclock.h"
+#include "../../src/waylandrecord/framepacer.h"
+#include "../../src/waylandrecord/framering.h"
+#include "../../src/waylandrecord/framewriter.h"
+#include "../../src/gstrecord/gstinterface.h"
+#include "../../src/gstrecord/gstrecordx.h"
+#include "../../src/utils/configsettings.h"
+#include "../../src/utils/recordingstats.h"
+#include "../../src/utils.h"
+
+#include <thread>
+#include <time.h>
+
+namespace {
+//与 WaylandIntegrationPrivate 在普通机器上的缓冲帧数和取帧超时一致
+const int FrameRingCapacity = 60;
+const int FrameWaitTimeoutMs = 100;
+
+int64_t threadCpuUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief 按目标帧率生成画面并交给 write，返回生成的帧数
+ */
+template <typename Write>
+uint64_t driveFrames(const BenchOptions &options, SyntheticFrames &frames, BenchResult &result, Write write)
+{
+    FramePacer pacer;
+    pacer.start(options.fps);
+    const uint64_t total = static_cast<uint64_t>(options.fps) * options.seconds;
+    uint64_t index = 0;
+    while (index < total) {
+        pacer.waitNextTick();
+        const int64_t generateBegin = threadCpuUs();
+        const unsigned char *frame = frames.frame(index);
+        result.generateCpuUs += threadCpuUs() - generateBegin;
+        write(frame);
+        index++;
+    }
+    RecordingStats *stats = RecordingStats::instance();
+    stats->setCounter(RecordingStats::PacerLate, pacer.lateCount());
+    stats->setCounter(RecordingStats::PacerSkipped, pacer.skippedCount());
+    return index;
+}
+
+/**
+ * @brief 写帧线程：与 WriteFrameThread 相同，经 FrameWriter 租用最旧的一帧交给编码器，写完立即归还
+ * 环形缓冲区 close 后取完剩余的帧再退出
+ */
+uint64_t writeFrames(FrameRing &ring, CAVOutputStream &output)
+{
+    const FrameWriter::WriteFunc writeFrame = [&output](WaylandFrame &frame) {
+        return output.writeVideoFrame(frame);
+    };
+    uint64_t written = 0;
+    int index = 0;
+    WaylandFrame frame;
+    FrameRing::Lease lease;
+    for (;;) {
+        if (!ring.waitForFrame(FrameWaitTimeoutMs)) {
+            if (ring.isClosed() && ring.isEmpty()) {
+                break;
+            }
+            continue;
+        }
+        if (FrameWriter::acquire(ring, lease, frame, index) && FrameWriter::write(writeFrame, frame, lease)) {
+            written++;
+        }
+    }
+    return written;
+}
+} // namespace
+
+bool BenchRun::runFFmpeg(const BenchOptions &options, SyntheticFrames &frames, BenchResult &result)
+{
+    avlibInterface::initFunctions();
+    Utils::isFFmpegEnv = true;
+    //编码参数与 RecordAdmin::startStream 相同，不录制音频
+    CAVOutputStream output;
+    output.m_videoType = options.format == "mkv" ? Utils::kMKV : Utils::kMP4;
+    output.SetVideoCodecProp(AV_CODEC_ID_H264, options.fps, 500000, 30, frames.width(), frames.height());
+    ConfigSettings *settings = ConfigSettings::instance();
+    output.setVideoEncoderOptions(CAVOutputStream::videoEncoderOptionsFromSettings(settings));
+    output.setFragmentDuration(settings->getValue("recorder", "fragment_seconds").toInt());
+    output.captureClock().start();
+    if (!output.open(options.output)) {
+        return false;
+    }
+
+    FrameRing ring;
+    if (!ring.init(FrameRingCapacity, static_cast<size_t>(frames.height()) * frames.stride())) {
+        output.close();
+        return false;
+    }
+    uint64_t written = 0;
+    std::thread writer([&]() {
+        written = writeFrames(ring, output);
+    });
+
+    RecordingStats *stats = RecordingStats::instance();
+    const int64_t beginNs = FramePacer::monotonicNs();
+    result.generated = driveFrames(options, frames, result, [&](const unsigned char *frame) {
+        ring.push(frame, frames.width(), frames.height(), frames.stride(), CaptureClock::nowUs());
+        stats->setCounter(RecordingStats::RingPushed, ring.pushedCount());
+        stats->setCounter(RecordingStats::RingDropped, ring.droppedCount());
+        stats->setRingOccupancy(ring.size(), ring.capacity());
+    });
+    //与 RecordAdmin::stopStream 相同：等写帧线程取完缓冲区中的帧后再关闭输出
+    const int64_t stopBegin = CaptureClock::nowUs();
+    ring.close();
+    writer.join();
+    output.close();
+    result.stopUs = CaptureClock::nowUs() - stopBegin;
+    result.elapsedNs = FramePacer::monotonicNs() - beginNs;
+    result.written = written;
+    ring.release();
+    return true;
+}
+
+bool BenchRun::runGStreamer(const BenchOptions &options, SyntheticFrames &frames, BenchResult &result)
+{
+    int argc = 1;
+    gstInterface::initFunctions();
+    gstInterface::m_gst_init(&argc, nullptr);
+    Utils::isFFmpegEnv = false;
+    GstRecordX gstRecord;
+    gstRecord.setFramerate(options.fps);
+    gstRecord.setRecordArea(QRect(0, 0, frames.width(), frames.height()));
+    gstRecord.setSavePath(options.output);
+    gstRecord.setAudioType(GstRecordX::AudioType::None);
+    gstRecord.setVidoeType(options.format == "ogg" ? GstRecordX::VideoType::ogg : GstRecordX::VideoType::webm);
+    gstRecord.setBoardVendorType(0);
+    gstRecord.waylandGstStartRecord();
+
+    uint64_t written = 0;
+    const int64_t beginNs = FramePacer::monotonicNs();
+    result.generated = driveFrames(options, frames, result, [&](const unsigned char *frame) {
+        if (gstRecord.waylandWriteVideoFrame(frame, frames.width(), frames.height(), frames.stride(), CaptureClock::nowUs())) {
+            written++;
+        } else {
+            RecordingStats::instance()->addCounter(RecordingStats::EncodeFailed);
+        }
+    });
+    const int64_t stopBegin = CaptureClock::nowUs();
+    gstRecord.waylandGstStopRecord();
+    result.stopUs = CaptureClock::nowUs() - stopBegin;
+    result.elapsedNs = FramePacer::monotonicNs() - beginNs;
+    result.written = written;
+    return true;
+}
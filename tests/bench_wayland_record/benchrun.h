@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BENCHRUN_H
+#define BENCHRUN_H
+
+#include "syntheticframes.h"
+
+#include <QString>
+#include <QStringList>
+
+#include <cstdint>
+
+/**
+ * @brief 基准测试的参数，由 main.cpp 从命令行解析
+ */
+struct BenchOptions {
+    QString backend;
+    QString format;
+    SyntheticFrames::Pattern pattern = SyntheticFrames::ScrollingText;
+    int width = 1920;
+    int height = 1080;
+    int fps = 30;
+    int seconds = 10;
+    double minFps = 0;
+    QString output;
+    bool keepOutput = false;
+    bool encoderBenchmark = false;
+    QStringList presets;
+    QString tune;
+};
+
+struct BenchResult {
+    uint64_t generated = 0;
+    uint64_t written = 0;
+    int64_t elapsedNs = 0;
+    int64_t cpuUs = 0;
+    int64_t generateCpuUs = 0;
+    int64_t stopUs = 0;
+};
+
+/**
+ * @brief 录制一段合成画面，两个后端只依赖不需要 KWayland 的编码层，单元测试中同样可以调用
+ *
+ * ffmpeg：画面经 FrameRing 交给写帧线程，由 CAVOutputStream::writeVideoFrame 编码，
+ *         与 WriteFrameThread 从环形缓冲区取帧的流程相同，不经过 RecordAdmin 和 KWayland 采集
+ * gstreamer：直接调用 GstRecordX::waylandWriteVideoFrame
+ *
+ * 按 options.fps 和 options.seconds 生成画面，结果写入 result；后端打开输出失败时返回 false。
+ */
+namespace BenchRun {
+bool runFFmpeg(const BenchOptions &options, SyntheticFrames &frames, BenchResult &result);
+bool runGStreamer(const BenchOptions &options, SyntheticFrames &frames, BenchResult &result);
+}
+
+#endif // BENCHRUN_H
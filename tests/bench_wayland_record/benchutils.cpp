@@ -0,0 +1,9 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "../../src/utils.h"
+
+//基准测试只链接录制相关的源码，录制流程用到的 Utils 静态成员在此定义，不链接依赖 X11/DBus 的 utils.cpp
+bool Utils::isFFmpegEnv = true;
+int Utils::specialRecordingScreenMode = -1;
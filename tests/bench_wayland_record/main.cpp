@@ -0,0 +1,224 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+ * Wayland 录屏编码吞吐量基准测试
+ *
+ * 不依赖 KWayland 合成器：由合成画面按目标帧率经 FrameRing 驱动 CAVOutputStream（ffmpeg）
+ * 或 GstRecordX::waylandWriteVideoFrame（gstreamer），见 benchrun.h，录制结束后输出 JSON：
+ *   sustained_fps  编码端实际写入的帧数 / 从开始到文件关闭的总时长
+ *   cpu_us_per_frame  进程 CPU 时间（扣除画面生成）/ 写入帧数
+ *   peak_rss_kb / output_bytes / 各阶段耗时直方图与丢帧计数
+ * 指定 --min-fps 时，实际帧率低于该值返回 1，可在无界面的 CI 机器上检测性能回退。
+ *
+ * --encoder-benchmark 只测 H.264 编码器：按 --presets 依次用帧线程和条带线程各编码 --fps x --duration 帧，
+ * 输出每个 preset 的编码帧率；指定 --min-fps 时最快的一项低于该值返回 1。
+ */
+
+#include "benchrun.h"
+#include "syntheticframes.h"
+
+#include "../../src/waylandrecord/avlibinterface.h"
+#include "../../src/waylandrecord/avoutputstream.h"
+#include "../../src/utils/recordingstats.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <cstdio>
+#include <sys/resource.h>
+
+namespace {
+int64_t processCpuUs()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (static_cast<int64_t>(usage.ru_utime.tv_sec) + usage.ru_stime.tv_sec) * 1000000
+           + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+long peakRssKb()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * @brief 用 CAVOutputStream::benchmarkVideoEncoder 测试各 preset 的编码帧率，不封装、不写文件
+ * @return 进程返回值
+ */
+int runEncoderBenchmark(const BenchOptions &options)
+{
+    avlibInterface::initFunctions();
+    const int frames = options.fps * options.seconds;
+    CAVOutputStream::VideoEncoderOptions encoderOptions;
+    encoderOptions.tune = options.tune;
+    QJsonArray results;
+    double bestFps = 0;
+    for (bool sliceThreads : {false, true}) {
+        encoderOptions.sliceThreads = sliceThreads;
+        const QList<CAVOutputStream::EncoderBenchmarkResult> list =
+            CAVOutputStream::benchmarkVideoEncoder(options.width, options.height, frames, encoderOptions, options.presets);
+        for (const CAVOutputStream::EncoderBenchmarkResult &item : list) {
+            QJsonObject result;
+            result["preset"] = item.preset;
+            result["threads"] = sliceThreads ? "slice" : "frame";
+            result["frames"] = item.frames;
+            result["fps"] = item.fps;
+            results.append(result);
+            bestFps = qMax(bestFps, item.fps);
+        }
+    }
+
+    QJsonObject report;
+    report["backend"] = "x264";
+    report["width"] = options.width;
+    report["height"] = options.height;
+    report["tune"] = options.tune;
+    report["frames_per_preset"] = frames;
+    report["results"] = results;
+    printf("%s\n", QJsonDocument(report).toJson(QJsonDocument::Indented).constData());
+
+    //编码器不可用时所有 fps 为 0
+    if (bestFps <= 0) {
+        fprintf(stderr, "H264 encoder unavailable\n");
+        return 2;
+    }
+    if (options.minFps > 0 && bestFps < options.minFps) {
+        fprintf(stderr, "fastest preset %.2f fps below required %.2f\n", bestFps, options.minFps);
+        return 1;
+    }
+    return 0;
+}
+
+bool parseOptions(const QCoreApplication &app, BenchOptions &options)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless Wayland recording encoder benchmark");
+    parser.addHelpOption();
+    parser.addOption({"backend", "ffmpeg or gstreamer.", "backend", "ffmpeg"});
+    parser.addOption({"format", "mp4/mkv (ffmpeg), webm/ogg (gstreamer).", "format"});
+    parser.addOption({"pattern", "static, scroll or noise.", "pattern", "scroll"});
+    parser.addOption({"width", "Frame width.", "pixels", "1920"});
+    parser.addOption({"height", "Frame height.", "pixels", "1080"});
+    parser.addOption({"fps", "Target frame rate.", "fps", "30"});
+    parser.addOption({"duration", "Recording length in seconds.", "seconds", "10"});
+    parser.addOption({"min-fps", "Exit with 1 when the sustained fps is below this value.", "fps", "0"});
+    parser.addOption({"output", "Output file, removed afterwards unless --keep.", "path"});
+    parser.addOption({"keep", "Keep the output file."});
+    parser.addOption({"encoder-benchmark", "Only measure the H.264 encoder speed of each preset, with frame and slice threads."});
+    parser.addOption({"presets", "Comma separated x264 presets for --encoder-benchmark.", "presets",
+                      "ultrafast,superfast,veryfast,medium"});
+    parser.addOption({"tune", "x264 tune for --encoder-benchmark, empty for none.", "tune", "zerolatency"});
+    parser.process(app);
+
+    options.backend = parser.value("backend");
+    if (options.backend != "ffmpeg" && options.backend != "gstreamer") {
+        fprintf(stderr, "unknown backend: %s\n", qPrintable(options.backend));
+        return false;
+    }
+    options.format = parser.value("format");
+    if (options.format.isEmpty()) {
+        options.format = options.backend == "ffmpeg" ? "mp4" : "webm";
+    }
+    if (!SyntheticFrames::parsePattern(parser.value("pattern").toStdString(), options.pattern)) {
+        fprintf(stderr, "unknown pattern: %s\n", qPrintable(parser.value("pattern")));
+        return false;
+    }
+    //编码器要求宽高为偶数
+    options.width = parser.value("width").toInt() / 2 * 2;
+    options.height = parser.value("height").toInt() / 2 * 2;
+    options.fps = parser.value("fps").toInt();
+    options.seconds = parser.value("duration").toInt();
+    options.minFps = parser.value("min-fps").toDouble();
+    if (options.width <= 0 || options.height <= 0 || options.fps <= 0 || options.seconds <= 0) {
+        fprintf(stderr, "width, height, fps and duration must be positive\n");
+        return false;
+    }
+    options.output = parser.value("output");
+    if (options.output.isEmpty()) {
+        options.output = QDir::temp().filePath(QString("bench_wayland_record_%1.%2")
+                                               .arg(QCoreApplication::applicationPid())
+                                               .arg(options.format));
+    }
+    options.keepOutput = parser.isSet("keep");
+    options.encoderBenchmark = parser.isSet("encoder-benchmark");
+    options.presets = parser.value("presets").split(',', Qt::SkipEmptyParts);
+    for (const QString &preset : options.presets) {
+        if (!CAVOutputStream::videoEncoderPresets().contains(preset)) {
+            fprintf(stderr, "unknown preset: %s\n", qPrintable(preset));
+            return false;
+        }
+    }
+    options.tune = parser.value("tune");
+    if (!options.tune.isEmpty() && !CAVOutputStream::videoEncoderTunes().contains(options.tune)) {
+        fprintf(stderr, "unknown tune: %s\n", qPrintable(options.tune));
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    BenchOptions options;
+    if (!parseOptions(app, options)) {
+        return 2;
+    }
+    if (options.encoderBenchmark) {
+        return runEncoderBenchmark(options);
+    }
+
+    SyntheticFrames frames(options.pattern, options.width, options.height);
+    RecordingStats::instance()->reset();
+    BenchResult result;
+    const int64_t cpuBegin = processCpuUs();
+    const bool ok = options.backend == "ffmpeg" ? BenchRun::runFFmpeg(options, frames, result)
+                                                : BenchRun::runGStreamer(options, frames, result);
+    result.cpuUs = processCpuUs() - cpuBegin;
+    if (!ok) {
+        return 2;
+    }
+
+    const double elapsedSec = static_cast<double>(result.elapsedNs) / 1e9;
+    const double sustainedFps = elapsedSec > 0 ? static_cast<double>(result.written) / elapsedSec : 0;
+    const int64_t pipelineCpuUs = result.cpuUs - result.generateCpuUs;
+
+    QJsonObject report;
+    report["backend"] = options.backend;
+    report["format"] = options.format;
+    report["pattern"] = SyntheticFrames::patternName(options.pattern);
+    report["width"] = options.width;
+    report["height"] = options.height;
+    report["target_fps"] = options.fps;
+    report["duration_s"] = options.seconds;
+    report["frames_generated"] = static_cast<qint64>(result.generated);
+    report["frames_written"] = static_cast<qint64>(result.written);
+    report["elapsed_ms"] = static_cast<qint64>(result.elapsedNs / 1000000);
+    report["stop_ms"] = static_cast<qint64>(result.stopUs / 1000);
+    report["sustained_fps"] = sustainedFps;
+    report["cpu_us_per_frame"] = result.written > 0 ? static_cast<qint64>(pipelineCpuUs / static_cast<int64_t>(result.written)) : 0;
+    report["generate_cpu_ms"] = static_cast<qint64>(result.generateCpuUs / 1000);
+    report["peak_rss_kb"] = static_cast<qint64>(peakRssKb());
+    report["output_bytes"] = QFileInfo(options.output).size();
+    report["stats"] = QJsonDocument::fromJson(QByteArray::fromStdString(RecordingStats::instance()->toJson())).object();
+    printf("%s\n", QJsonDocument(report).toJson(QJsonDocument::Indented).constData());
+
+    if (!options.keepOutput) {
+        QFile::remove(options.output);
+    }
+    if (options.minFps > 0 && sustainedFps < options.minFps) {
+        fprintf(stderr, "sustained fps %.2f below required %.2f\n", sustainedFps, options.minFps);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,32 @@
+#!/bin/bash
+
+# SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+
+# 用法: ./run_bench.sh [bench_wayland_record 的参数...]
+# 例如: ./run_bench.sh --backend ffmpeg --pattern noise --width 1920 --height 1080 --fps 30 --duration 10 --min-fps 28
+# 默认依次跑三种画面，任意一项低于 --min-fps 时返回非 0
+# 只测 H.264 各 preset 的编码帧率: ./run_bench.sh --encoder-benchmark --width 1280 --height 720 --duration 1
+
+export QT_QPA_PLATFORM=offscreen
+export QT_LOGGING_RULES="*=false"
+
+cd "$(dirname "$0")" || exit 1
+rm -rf ./build-bench
+mkdir ./build-bench
+cd ./build-bench || exit 1
+export QT_SELECT=qt6
+qmake6 ../ || exit 1
+make -j"$(nproc)" || exit 1
+
+if [ $# -gt 0 ]; then
+    ./bench_wayland_record "$@"
+    exit $?
+fi
+
+ret=0
+for pattern in static scroll noise; do
+    ./bench_wayland_record --pattern "$pattern" || ret=1
+done
+exit $ret
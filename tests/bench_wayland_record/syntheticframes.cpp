@@ -0,0 +1,147 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "syntheticframes.h"
+
+#include <cstring>
+
+namespace {
+uint32_t xorshift32(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+} // namespace
+
+SyntheticFrames::SyntheticFrames(Pattern pattern, int width, int height)
+    : m_pattern(pattern)
+    , m_width(width > 0 ? width : 1)
+    , m_height(height > 0 ? height : 1)
+    , m_frame(static_cast<size_t>(m_width) * m_height * 4)
+{
+    if (m_pattern == Static) {
+        renderGradient();
+    } else if (m_pattern == ScrollingText) {
+        renderTextPage();
+    }
+}
+
+const unsigned char *SyntheticFrames::frame(uint64_t index)
+{
+    if (m_pattern == ScrollingText) {
+        //整页高度为两屏，取模后逐行拷贝，跨过页尾时从页首继续
+        const size_t rowBytes = static_cast<size_t>(stride());
+        const int pageHeight = m_height * 2;
+        const int offset = static_cast<int>((index * ScrollLinesPerFrame) % static_cast<uint64_t>(pageHeight));
+        const int firstRows = pageHeight - offset < m_height ? pageHeight - offset : m_height;
+        memcpy(m_frame.data(), m_page.data() + offset * rowBytes, firstRows * rowBytes);
+        if (firstRows < m_height) {
+            memcpy(m_frame.data() + firstRows * rowBytes, m_page.data(), (m_height - firstRows) * rowBytes);
+        }
+    } else if (m_pattern == Noise) {
+        renderNoise(index);
+    }
+    return m_frame.data();
+}
+
+int SyntheticFrames::width() const
+{
+    return m_width;
+}
+
+int SyntheticFrames::height() const
+{
+    return m_height;
+}
+
+int SyntheticFrames::stride() const
+{
+    return m_width * 4;
+}
+
+SyntheticFrames::Pattern SyntheticFrames::pattern() const
+{
+    return m_pattern;
+}
+
+bool SyntheticFrames::parsePattern(const std::string &name, Pattern &pattern)
+{
+    for (int i = Static; i <= Noise; i++) {
+        if (name == patternName(static_cast<Pattern>(i))) {
+            pattern = static_cast<Pattern>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *SyntheticFrames::patternName(Pattern pattern)
+{
+    switch (pattern) {
+    case Static:
+        return "static";
+    case ScrollingText:
+        return "scroll";
+    case Noise:
+        return "noise";
+    default:
+        return "unknown";
+    }
+}
+
+void SyntheticFrames::renderGradient()
+{
+    unsigned char *p = m_frame.data();
+    for (int y = 0; y < m_height; y++) {
+        for (int x = 0; x < m_width; x++) {
+            *p++ = static_cast<unsigned char>(x * 255 / m_width);
+            *p++ = static_cast<unsigned char>(y * 255 / m_height);
+            *p++ = 128;
+            *p++ = 255;
+        }
+    }
+}
+
+void SyntheticFrames::renderTextPage()
+{
+    //白底，每行文字高 16 像素、行距 8 像素，"单词"为随机宽度的深色块，字符之间留 2 像素
+    const int pageHeight = m_height * 2;
+    const size_t rowBytes = static_cast<size_t>(stride());
+    m_page.assign(rowBytes * pageHeight, 255);
+    uint32_t seed = 0x2545f491;
+    const int lineHeight = 16;
+    const int lineGap = 8;
+    const int margin = m_width / 20;
+    for (int top = lineGap; top + lineHeight <= pageHeight; top += lineHeight + lineGap) {
+        int x = margin;
+        const int right = m_width - margin - static_cast<int>(xorshift32(seed) % static_cast<uint32_t>(m_width / 4 + 1));
+        while (x < right) {
+            const int letters = 2 + static_cast<int>(xorshift32(seed) % 8);
+            for (int l = 0; l < letters && x + 8 < right; l++) {
+                const int glyphTop = top + static_cast<int>(xorshift32(seed) % 5);
+                for (int y = glyphTop; y < top + lineHeight; y++) {
+                    uint32_t *row = reinterpret_cast<uint32_t *>(m_page.data() + y * rowBytes) + x;
+                    for (int i = 0; i < 6; i++) {
+                        row[i] = 0xff282828u;
+                    }
+                }
+                x += 8;
+            }
+            x += 10;
+        }
+    }
+}
+
+void SyntheticFrames::renderNoise(uint64_t index)
+{
+    uint32_t state = static_cast<uint32_t>(index * 2654435761u) | 1u;
+    uint32_t *p = reinterpret_cast<uint32_t *>(m_frame.data());
+    const size_t pixels = static_cast<size_t>(m_width) * m_height;
+    for (size_t i = 0; i < pixels; i++) {
+        //alpha 固定为不透明
+        p[i] = xorshift32(state) | 0xff000000u;
+    }
+}
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SYNTHETICFRAMES_H
+#define SYNTHETICFRAMES_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 录制基准测试用的合成画面，RGBA8888，每行 width * 4 字节
+ *
+ *   Static         静止的渐变画面，每帧内容相同
+ *   ScrollingText  白底文字块逐行向上滚动，模拟浏览网页、翻阅文档
+ *   Noise          每帧都是新的随机噪声，编码器的最坏情况
+ *
+ * 画面内容只由帧序号决定，同样的参数每次运行得到的帧完全一致。
+ */
+class SyntheticFrames
+{
+public:
+    enum Pattern {
+        Static = 0,
+        ScrollingText,
+        Noise
+    };
+
+    SyntheticFrames(Pattern pattern, int width, int height);
+
+    /**
+     * @brief 生成第 index 帧，返回的内存在下一次调用前有效
+     */
+    const unsigned char *frame(uint64_t index);
+
+    int width() const;
+    int height() const;
+    int stride() const;
+    Pattern pattern() const;
+
+    static bool parsePattern(const std::string &name, Pattern &pattern);
+    static const char *patternName(Pattern pattern);
+
+    //滚动画面每帧移动的行数
+    static const int ScrollLinesPerFrame = 4;
+
+private:
+    void renderGradient();
+    void renderTextPage();
+    void renderNoise(uint64_t index);
+
+    Pattern m_pattern;
+    int m_width;
+    int m_height;
+    std::vector<unsigned char> m_frame;
+    //滚动画面的整页内容，高度为 2 * m_height，按偏移截取
+    std::vector<unsigned char> m_page;
+};
+
+#endif // SYNTHETICFRAMES_H
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <cstdint>
+
+#include "../../src/gstrecord/capturepts.h"
+
+using namespace testing;
+
+TEST(CapturePtsTest, subtractsFrameAge)
+{
+    uint64_t last = CapturePts::NoPts;
+    //运行 1 秒时推入 40 毫秒前采集的帧
+    EXPECT_EQ(960000000u, CapturePts::fromCaptureTime(1000000000u, 5000000, 4960000, last));
+    EXPECT_EQ(960000000u, last);
+    //管道时钟与 CLOCK_MONOTONIC 起点不同，只有两者的差值起作用
+    EXPECT_EQ(993000000u, CapturePts::fromCaptureTime(1010000000u, 5017000, 5000000, last));
+}
+
+TEST(CapturePtsTest, missingOrFutureCaptureTime)
+{
+    uint64_t last = CapturePts::NoPts;
+    //没有采集时间时使用推入时的运行时间
+    EXPECT_EQ(500000000u, CapturePts::fromCaptureTime(500000000u, 9000000, -1, last));
+    //采集时间晚于推入时间时不做调整
+    EXPECT_EQ(600000000u, CapturePts::fromCaptureTime(600000000u, 9000000, 9000500, last));
+}
+
+TEST(CapturePtsTest, ageLongerThanRunningTimeClampsToZero)
+{
+    uint64_t last = CapturePts::NoPts;
+    //管道刚启动时推入启动前采集的帧
+    EXPECT_EQ(0u, CapturePts::fromCaptureTime(10000000u, 2000000, 1000000, last));
+    EXPECT_EQ(0u, last);
+    //第一帧为 0 后，下一帧也被夹到 0 时仍严格递增
+    EXPECT_EQ(1u, CapturePts::fromCaptureTime(20000000u, 2010000, 1000000, last));
+}
+
+TEST(CapturePtsTest, outOfOrderCaptureTimesStayIncreasing)
+{
+    uint64_t last = CapturePts::NoPts;
+    const uint64_t first = CapturePts::fromCaptureTime(2000000000u, 10000000, 9990000, last);
+    EXPECT_EQ(1990000000u, first);
+    //后推入的帧采集得更早（如多屏合成时较慢的输出），PTS 取上一帧加 1
+    const uint64_t second = CapturePts::fromCaptureTime(2005000000u, 10005000, 9980000, last);
+    EXPECT_EQ(first + 1, second);
+    //采集时间相同的重复帧
+    const uint64_t third = CapturePts::fromCaptureTime(2005000000u, 10005000, 9980000, last);
+    EXPECT_EQ(second + 1, third);
+    //恢复正常顺序后回到按采集时间换算的值
+    EXPECT_EQ(2030000000u, CapturePts::fromCaptureTime(2040000000u, 10040000, 10030000, last));
+    EXPECT_EQ(2030000000u, last);
+}
+
+TEST(CapturePtsTest, sequenceAtFrameRateKeepsCaptureSpacing)
+{
+    //推入时间抖动（排队、编码器卡顿）不影响输出的帧间隔
+    uint64_t last = CapturePts::NoPts;
+    const int64_t captureBeginUs = 100000000;
+    const int64_t pushDelayUs[] = {1000, 25000, 3000, 40000, 2000};
+    for (int i = 0; i < 5; i++) {
+        const int64_t captureUs = captureBeginUs + i * 33333;
+        const int64_t nowUs = captureUs + pushDelayUs[i];
+        const uint64_t runningTimeNs = static_cast<uint64_t>(nowUs - captureBeginUs + 500000) * 1000;
+        EXPECT_EQ(static_cast<uint64_t>(i * 33333 + 500000) * 1000,
+                  CapturePts::fromCaptureTime(runningTimeNs, nowUs, captureUs, last));
+    }
+}
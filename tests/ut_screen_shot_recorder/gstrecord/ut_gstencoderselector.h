@@ -0,0 +1,162 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <QThread>
+
+#include "../../src/gstrecord/gstencoderselector.h"
+#include "../../src/utils/configsettings.h"
+
+using namespace testing;
+
+TEST(GstEncoderSelectorTest, encoderTable)
+{
+    //ogg 只有 theora，不需要测速
+    QList<GstEncoderSelector::Encoder> ogg = GstEncoderSelector::encoders(GstRecordX::VideoType::ogg);
+    ASSERT_EQ(1, ogg.size());
+    EXPECT_EQ(QString("theoraenc"), ogg.first().name);
+    EXPECT_EQ(QString("oggmux"), ogg.first().muxer);
+
+    //webm 默认仍为 vp8enc，默认只有 webm 能封装的编码器
+    QList<GstEncoderSelector::Encoder> webm = GstEncoderSelector::encoders(GstRecordX::VideoType::webm);
+    ASSERT_EQ(2, webm.size());
+    EXPECT_EQ(QString("vp8enc"), webm.first().name);
+    for (const GstEncoderSelector::Encoder &encoder : webm) {
+        EXPECT_EQ(QString("webmmux"), encoder.muxer);
+        EXPECT_EQ(QString("webm"), encoder.extension);
+    }
+
+    //开启 H.264 后才加入 H.264 编码器，输出 mkv
+    QList<GstEncoderSelector::Encoder> h264 = GstEncoderSelector::encoders(GstRecordX::VideoType::webm, true);
+    ASSERT_EQ(4, h264.size());
+    EXPECT_EQ(QString("vp8enc"), h264.first().name);
+    for (const GstEncoderSelector::Encoder &encoder : h264) {
+        EXPECT_TRUE(encoder.element.contains(encoder.name + " "));
+        //vp9enc、x264enc 也接受 Y444，需限定为 I420，测速与实际录制的管道一致
+        if (encoder.name == "vp9enc" || encoder.name == "x264enc") {
+            EXPECT_TRUE(encoder.element.startsWith("video/x-raw, format=I420 ! " + encoder.name));
+        }
+        if (encoder.muxer == "matroskamux") {
+            EXPECT_EQ(QString("mkv"), encoder.extension);
+            EXPECT_TRUE(encoder.element.endsWith("h264parse"));
+        } else {
+            EXPECT_EQ(QString("webm"), encoder.extension);
+        }
+    }
+    EXPECT_EQ(1, GstEncoderSelector::encoders(GstRecordX::VideoType::ogg, true).size());
+}
+
+TEST(GstEncoderSelectorTest, encoderElementFillsThreadsAndKeyframes)
+{
+    GstEncoderSelector::Encoder vp8 = GstEncoderSelector::encoders(GstRecordX::VideoType::webm).first();
+    const QString element = GstEncoderSelector::encoderElement(vp8, 30);
+    EXPECT_TRUE(element.contains(QString("threads=%1").arg(qMax(QThread::idealThreadCount(), 1))));
+    EXPECT_TRUE(element.contains("keyframe-max-dist=150"));
+    EXPECT_FALSE(element.contains("%"));
+
+    GstEncoderSelector::Encoder theora = GstEncoderSelector::encoders(GstRecordX::VideoType::ogg).first();
+    EXPECT_EQ(theora.element, GstEncoderSelector::encoderElement(theora, 30));
+}
+
+TEST(GstEncoderSelectorTest, pickFastestAvailable)
+{
+    EXPECT_EQ(-1, GstEncoderSelector::pick({}));
+    EXPECT_EQ(-1, GstEncoderSelector::pick({-1, -1}));
+    EXPECT_EQ(2, GstEncoderSelector::pick({18.5, -1, 64.0, 40.0}));
+    //超时的编码器仍比不可用的好
+    EXPECT_EQ(1, GstEncoderSelector::pick({-1, 0}));
+    //速度相同时表中靠前的优先
+    EXPECT_EQ(0, GstEncoderSelector::pick({30.0, 30.0}));
+}
+
+TEST(GstEncoderSelectorTest, benchCondition)
+{
+    const QString bench = GstEncoderSelector::benchCondition(QSize(1920, 1080), 30);
+    EXPECT_EQ(QString("1920x1080@30"), bench);
+    EXPECT_TRUE(GstEncoderSelector::benchCovers(bench, QSize(1920, 1080), 30));
+    EXPECT_TRUE(GstEncoderSelector::benchCovers(bench, QSize(1280, 720), 30));
+    EXPECT_TRUE(GstEncoderSelector::benchCovers(bench, QSize(1920, 1080), 24));
+    EXPECT_FALSE(GstEncoderSelector::benchCovers(bench, QSize(1920, 1080), 60));
+    EXPECT_FALSE(GstEncoderSelector::benchCovers(bench, QSize(2560, 1440), 30));
+    EXPECT_FALSE(GstEncoderSelector::benchCovers(QString(), QSize(1, 1), 1));
+    EXPECT_FALSE(GstEncoderSelector::benchCovers("1920x1080", QSize(1, 1), 1));
+}
+
+TEST(GstEncoderSelectorTest, selectOnlyReadsCache)
+{
+    ConfigSettings *settings = ConfigSettings::instance();
+    const QVariant encoder = settings->getValue("recorder", "gst_encoder");
+    const QVariant bench = settings->getValue("recorder", "gst_encoder_bench");
+    const QVariant h264Mkv = settings->getValue("recorder", "gst_h264_mkv");
+    const QList<GstEncoderSelector::Encoder> webm = GstEncoderSelector::encoders(GstRecordX::VideoType::webm);
+    const QList<GstEncoderSelector::Encoder> h264 = GstEncoderSelector::encoders(GstRecordX::VideoType::webm, true);
+
+    //没有缓存时不测速，直接使用默认编码器
+    settings->setValue("recorder", "gst_encoder", "");
+    settings->setValue("recorder", "gst_encoder_bench", "");
+    settings->setValue("recorder", "gst_h264_mkv", false);
+    EXPECT_TRUE(GstEncoderSelector::needsBenchmark(GstRecordX::VideoType::webm, QSize(1920, 1080), 30));
+    EXPECT_FALSE(GstEncoderSelector::needsBenchmark(GstRecordX::VideoType::ogg, QSize(1920, 1080), 30));
+    EXPECT_EQ(QString("vp8enc"), GstEncoderSelector::select(GstRecordX::VideoType::webm, QSize(1920, 1080), 30).name);
+
+    //编码器和测速条件是一个值
+    const QString result = GstEncoderSelector::benchResult("vp9enc", QSize(1920, 1080), 30, webm);
+    EXPECT_EQ(QString("vp9enc;1920x1080@30;vp8enc,vp9enc"), result);
+    settings->setValue("recorder", "gst_encoder_bench", result);
+    EXPECT_FALSE(GstEncoderSelector::needsBenchmark(GstRecordX::VideoType::webm, QSize(1280, 720), 30));
+    EXPECT_EQ(QString("vp9enc"), GstEncoderSelector::select(GstRecordX::VideoType::webm, QSize(1280, 720), 30).name);
+    //缓存不能覆盖时也不在开始录制时测速
+    EXPECT_TRUE(GstEncoderSelector::needsBenchmark(GstRecordX::VideoType::webm, QSize(3840, 2160), 30));
+    EXPECT_EQ(QString("vp8enc"), GstEncoderSelector::select(GstRecordX::VideoType::webm, QSize(3840, 2160), 30).name);
+    EXPECT_EQ(QString("theoraenc"), GstEncoderSelector::select(GstRecordX::VideoType::ogg, QSize(1280, 720), 30).name);
+    //旧格式和不完整的值不使用
+    settings->setValue("recorder", "gst_encoder_bench", "1920x1080@30");
+    EXPECT_TRUE(GstEncoderSelector::needsBenchmark(GstRecordX::VideoType::webm, QSize(1280, 720), 30));
+
+    //H.264 测速结果在未开启 H.264 时不使用，webm 不会变成 mkv
+    settings->setValue("recorder", "gst_encoder_bench", GstEncoderSelector::benchResult("x264enc", QSize(1920, 1080), 30, h264));
+    EXPECT_TRUE(GstEncoderSelector::needsBenchmark(GstRecordX::VideoType::webm, QSize(1280, 720), 30));
+    EXPECT_EQ(QString("webm"), GstEncoderSelector::select(GstRecordX::VideoType::webm, QSize(1280, 720), 30).extension);
+    settings->setValue("recorder", "gst_h264_mkv", true);
+    EXPECT_FALSE(GstEncoderSelector::needsBenchmark(GstRecordX::VideoType::webm, QSize(1280, 720), 30));
+    EXPECT_EQ(QString("mkv"), GstEncoderSelector::select(GstRecordX::VideoType::webm, QSize(1280, 720), 30).extension);
+    //候选编码器变化后原先只在 vp8/vp9 中测速的结果需要重测
+    settings->setValue("recorder", "gst_encoder_bench", result);
+    EXPECT_TRUE(GstEncoderSelector::needsBenchmark(GstRecordX::VideoType::webm, QSize(1280, 720), 30));
+
+    //手动指定时总是使用，不在候选中时忽略
+    settings->setValue("recorder", "gst_encoder", "openh264enc");
+    EXPECT_EQ(QString("openh264enc"), GstEncoderSelector::select(GstRecordX::VideoType::webm, QSize(3840, 2160), 60).name);
+    settings->setValue("recorder", "gst_h264_mkv", false);
+    EXPECT_EQ(QString("vp8enc"), GstEncoderSelector::select(GstRecordX::VideoType::webm, QSize(3840, 2160), 60).name);
+    settings->setValue("recorder", "gst_encoder", "vp9enc");
+    EXPECT_FALSE(GstEncoderSelector::needsBenchmark(GstRecordX::VideoType::webm, QSize(3840, 2160), 60));
+    EXPECT_EQ(QString("vp9enc"), GstEncoderSelector::select(GstRecordX::VideoType::webm, QSize(3840, 2160), 60).name);
+
+    settings->setValue("recorder", "gst_encoder", encoder);
+    settings->setValue("recorder", "gst_encoder_bench", bench);
+    settings->setValue("recorder", "gst_h264_mkv", h264Mkv);
+}
+
+TEST(GstEncoderSelectorTest, cancelledBenchmarkStaysCancelled)
+{
+    const int first = GstEncoderSelector::beginBenchmark();
+    EXPECT_FALSE(GstEncoderSelector::isCancelled(first));
+    GstEncoderSelector::cancelBenchmark();
+    EXPECT_TRUE(GstEncoderSelector::isCancelled(first));
+
+    //再次进入录屏模式开始新的测速，已取消的测速不会恢复
+    const int second = GstEncoderSelector::beginBenchmark();
+    EXPECT_NE(first, second);
+    EXPECT_TRUE(GstEncoderSelector::isCancelled(first));
+    EXPECT_FALSE(GstEncoderSelector::isCancelled(second));
+
+    //新的测速取代尚未结束的测速
+    const int third = GstEncoderSelector::beginBenchmark();
+    EXPECT_TRUE(GstEncoderSelector::isCancelled(second));
+    EXPECT_FALSE(GstEncoderSelector::isCancelled(third));
+    GstEncoderSelector::cancelBenchmark();
+    EXPECT_TRUE(GstEncoderSelector::isCancelled(third));
+}
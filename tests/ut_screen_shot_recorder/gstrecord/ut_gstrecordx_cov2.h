@@ -149,6 +149,20 @@ TEST_F(GstRecordXCov2Test, waylandWriteVideoFrameStubReturnsFalse)
     EXPECT_FALSE(ok);
 }
 
+// ---------- waylandWriteVideoFrame: release callback runs exactly once ----------
+static void countRelease(gpointer data)
+{
+    ++*static_cast<int *>(data);
+}
+
+TEST_F(GstRecordXCov2Test, waylandWriteVideoFrameReleasesFrame)
+{
+    unsigned char data[16] = {0};
+    int released = 0;
+    EXPECT_FALSE(m_gst->waylandWriteVideoFrame(data, 2, 2, 8, 0, countRelease, &released));
+    EXPECT_EQ(1, released);
+}
+
 // ---------- x11GstStopRecord: m_pipeline null (warning branch) ----------
 TEST_F(GstRecordXCov2Test, x11GstStopRecordNullPipelineWarning)
 {
@@ -25,6 +25,7 @@
 ACCESS_PRIVATE_FUN(GstRecordX, void(), x11GstStartRecord);
 ACCESS_PRIVATE_FUN(GstRecordX, void(), x11GstStopRecord);
 ACCESS_PRIVATE_FUN(GstRecordX, bool(QStringList), createPipeline);
+ACCESS_PRIVATE_FUN(GstRecordX, QString() const, getVideoQueue);
 
 // Stub replacement for GstRecordX::createPipeline — avoids touching real
 // GStreamer (gst_parse_launch) which would risk an ASan abort in headless CI.
@@ -77,3 +78,24 @@ TEST_F(GstRecordXX11CovTest, X11StartThenStopIsCrashFree)
     EXPECT_NO_FATAL_FAILURE(call_private_fun::GstRecordXx11GstStartRecord(*m_gst));
     EXPECT_NO_FATAL_FAILURE(call_private_fun::GstRecordXx11GstStopRecord(*m_gst));
 }
+
+// The video queue is bounded by area x 4 bytes x fps x latency instead of the
+// old fixed 1 GB, and drops the oldest frames unless leaky mode is disabled.
+TEST_F(GstRecordXX11CovTest, VideoQueueIsMemoryBudgeted)
+{
+    m_gst->setQueueLimits(500, true);
+    QString queue = call_private_fun::GstRecordXgetVideoQueue(*m_gst);
+    EXPECT_TRUE(queue.contains("name=videoQueue"));
+    EXPECT_TRUE(queue.contains("max-size-bytes=300000 "));
+    EXPECT_TRUE(queue.contains("max-size-time=500000000 "));
+    EXPECT_TRUE(queue.contains("max-size-buffers=0"));
+    EXPECT_TRUE(queue.endsWith("leaky=downstream"));
+
+    // A latency shorter than one frame still holds one frame.
+    m_gst->setQueueLimits(1, false);
+    queue = call_private_fun::GstRecordXgetVideoQueue(*m_gst);
+    EXPECT_TRUE(queue.contains("max-size-bytes=40000 "));
+    EXPECT_TRUE(queue.endsWith("leaky=no"));
+
+    EXPECT_EQ(0u, m_gst->droppedBuffers());
+}
@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+#include "../../src/gstrecord/recordareacrop.h"
+
+using namespace testing;
+
+/**
+ * @brief 每个像素的 4 个字节依次为 x、y、x + y、0xff，每行末尾有 padding 字节的填充
+ */
+static std::vector<uint8_t> cropTestFrame(int width, int height, int padding)
+{
+    const int stride = width * 4 + padding;
+    std::vector<uint8_t> frame(static_cast<size_t>(stride) * height, 0xee);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t *pixel = frame.data() + static_cast<size_t>(y) * stride + x * 4;
+            pixel[0] = static_cast<uint8_t>(x);
+            pixel[1] = static_cast<uint8_t>(y);
+            pixel[2] = static_cast<uint8_t>(x + y);
+            pixel[3] = 0xff;
+        }
+    }
+    return frame;
+}
+
+/**
+ * @brief 检查 dst 中的每个像素：在画面内等于画面对应位置，否则为黑
+ */
+static void expectCropped(const std::vector<uint8_t> &dst, const QRect &area, int frameWidth, int frameHeight)
+{
+    ASSERT_EQ(RecordAreaCrop::bufferSize(area), dst.size());
+    for (int row = 0; row < area.height(); row++) {
+        for (int col = 0; col < area.width(); col++) {
+            const int x = area.x() + col;
+            const int y = area.y() + row;
+            const uint8_t *pixel = dst.data() + (static_cast<size_t>(row) * area.width() + col) * 4;
+            if (x >= 0 && y >= 0 && x < frameWidth && y < frameHeight) {
+                ASSERT_EQ(static_cast<uint8_t>(x), pixel[0]) << "x " << x << " y " << y;
+                ASSERT_EQ(static_cast<uint8_t>(y), pixel[1]) << "x " << x << " y " << y;
+                ASSERT_EQ(static_cast<uint8_t>(x + y), pixel[2]) << "x " << x << " y " << y;
+                ASSERT_EQ(0xff, pixel[3]) << "x " << x << " y " << y;
+            } else {
+                for (int i = 0; i < 4; i++) {
+                    ASSERT_EQ(0, pixel[i]) << "x " << x << " y " << y;
+                }
+            }
+        }
+    }
+}
+
+TEST(RecordAreaCropTest, wrapOnlyWholeUnpaddedFrame)
+{
+    EXPECT_TRUE(RecordAreaCrop::canWrap(QRect(0, 0, 64, 32), 64, 32, 64 * 4));
+    //每行有填充时 GStreamer 要求的紧密排列与帧内存不一致
+    EXPECT_FALSE(RecordAreaCrop::canWrap(QRect(0, 0, 64, 32), 64, 32, 64 * 4 + 64));
+    EXPECT_FALSE(RecordAreaCrop::canWrap(QRect(1, 0, 64, 32), 64, 32, 64 * 4));
+    EXPECT_FALSE(RecordAreaCrop::canWrap(QRect(0, 0, 63, 32), 64, 32, 64 * 4));
+    //分辨率改变后录制区域不再覆盖整帧
+    EXPECT_FALSE(RecordAreaCrop::canWrap(QRect(0, 0, 64, 32), 128, 32, 128 * 4));
+}
+
+TEST(RecordAreaCropTest, bufferSize)
+{
+    EXPECT_EQ(static_cast<size_t>(5 * 3 * 4), RecordAreaCrop::bufferSize(QRect(7, 9, 5, 3)));
+    EXPECT_EQ(0u, RecordAreaCrop::bufferSize(QRect()));
+    EXPECT_EQ(static_cast<size_t>(3840) * 2160 * 4, RecordAreaCrop::bufferSize(QRect(0, 0, 3840, 2160)));
+}
+
+TEST(RecordAreaCropTest, oddOffsetsInsideFrame)
+{
+    const int width = 37;
+    const int height = 21;
+    const int padding = 12;
+    const std::vector<uint8_t> frame = cropTestFrame(width, height, padding);
+    for (const QRect &area : {QRect(3, 1, 5, 3), QRect(1, 7, 35, 13), QRect(0, 0, width, height), QRect(36, 20, 1, 1)}) {
+        //预先填入非零值，确认区域在画面内时每个字节都被覆盖
+        std::vector<uint8_t> dst(RecordAreaCrop::bufferSize(area), 0x5a);
+        RecordAreaCrop::copy(frame.data(), width, height, width * 4 + padding, area, dst.data());
+        expectCropped(dst, area, width, height);
+    }
+}
+
+TEST(RecordAreaCropTest, partlyOffFrameFillsBlack)
+{
+    const int width = 33;
+    const int height = 17;
+    const int padding = 4;
+    const std::vector<uint8_t> frame = cropTestFrame(width, height, padding);
+    //左上、右下、四周都超出
+    for (const QRect &area : {QRect(-3, -5, 9, 11), QRect(29, 13, 7, 9), QRect(-1, -1, width + 2, height + 2)}) {
+        std::vector<uint8_t> dst(RecordAreaCrop::bufferSize(area), 0x5a);
+        RecordAreaCrop::copy(frame.data(), width, height, width * 4 + padding, area, dst.data());
+        expectCropped(dst, area, width, height);
+    }
+}
+
+TEST(RecordAreaCropTest, fullyOffFrameIsBlack)
+{
+    const std::vector<uint8_t> frame = cropTestFrame(8, 8, 0);
+    const QRect area(20, 3, 4, 2);
+    std::vector<uint8_t> dst(RecordAreaCrop::bufferSize(area), 0x5a);
+    RecordAreaCrop::copy(frame.data(), 8, 8, 8 * 4, area, dst.data());
+    expectCropped(dst, area, 8, 8);
+}
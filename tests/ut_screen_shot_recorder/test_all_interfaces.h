@@ -9,6 +9,24 @@
 //#include "waylandrecord/ut_waylandintegration.h"
 //#include "waylandrecord/ut_waylandintegration_p.h"
 //#include "waylandrecord/ut_writeframethread.h"
+#include "waylandrecord/ut_avoutputstream_encode.h"
+#include "waylandrecord/ut_benchrun.h"
+#include "waylandrecord/ut_framering.h"
+#include "waylandrecord/ut_framewriter.h"
+#include "waylandrecord/ut_framepacer.h"
+#include "waylandrecord/ut_framecompositor.h"
+#include "waylandrecord/ut_outputbuffers.h"
+#include "waylandrecord/ut_slicepool.h"
+#include "waylandrecord/ut_stagequeue.h"
+#include "waylandrecord/ut_framededup.h"
+#include "waylandrecord/ut_audiosamplefifo.h"
+#include "waylandrecord/ut_reusepool.h"
+#include "waylandrecord/ut_audiomixer.h"
+#include "waylandrecord/ut_audiomixer_amix.h"
+#include "waylandrecord/ut_fragmentoptions.h"
+#include "waylandrecord/ut_captureclock.h"
+#include "waylandrecord/ut_audiodriftmonitor.h"
+#include "waylandrecord/ut_egldmabufreader.h"
 //#include "widgets/ut_shapeswidget.h" // API drift: paintRect/paintEllipse
 // signatures now take an extra `int radius`, paintText is overloaded, and the
 // test references a non-existent Toolshape::isStraight field. Re-enable after
@@ -19,10 +37,14 @@
 #include "utils/ut_audioutils.h"
 #include "utils/ut_baseutils.h"
 #include "utils/ut_configsettings.h"
+#include "utils/ut_recordingstats.h"
+#include "utils/ut_dmabufmapcache.h"
 //#include "utils/ut_desktopinfo.h"
 #include "utils/ut_screengrabber.h"
 #include "utils/ut_shortcut.h"
 #include "utils/ut_tempfile.h"
+#include "utils/ut_i420converter.h"
+#include "utils/ut_i420converter_sws.h"
 #include "utils/ut_utils_other.h"
 #include "utils/ut_calculaterect.h"
 #include "widgets/ut_keybuttonwidget.h"
@@ -68,6 +90,9 @@
 #include "ext-image-capture/ut_extcapturesession.h"
 #include "ext-image-capture/ut_multiscreencapturecoordinator.h"
 #include "gstrecord/ut_gstinterface.h"
+#include "gstrecord/ut_gstencoderselector.h"
+#include "gstrecord/ut_recordareacrop.h"
+#include "gstrecord/ut_capturepts.h"
 #include "utils/ut_borderprocessinterface.h"
 #include "ut_event_monitor.h"
 #include "widgets/ut_shapeswidget_ext.h"
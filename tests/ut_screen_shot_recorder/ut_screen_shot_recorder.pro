@@ -23,10 +23,10 @@ INCLUDEPATH += . ../../src/ \
 DEFINES += DDE_START_FLAGE_ON
 DEFINES += OCR_SCROLL_FLAGE_ON
 DEFINES += ENABLE_UNIT_TEST
-# KF5_WAYLAND_FLAGE_ON disabled: KF6 KWayland lacks ClientManagement and the
-# waylandrecord module depends on removed ffmpeg 5.x APIs (AVPicture,
-# AVStream::codec, avcodec_decode_audio4). Re-enabling requires porting both
-# KWayland::Client::ClientManagement and the waylandrecord ffmpeg layer.
+# KF5_WAYLAND_FLAGE_ON disabled: KF6 KWayland lacks ClientManagement. The
+# waylandrecord ffmpeg layer (avlibinterface, avinputstream, avoutputstream) no
+# longer depends on KWayland and is built below; writeframethread,
+# waylandintegration and recordadmin still need KWayland::Client and stay out.
 #DEFINES += KF5_WAYLAND_FLAGE_ON
 
 QT += core gui testlib
@@ -112,11 +112,15 @@ HEADERS += test_all_interfaces.h \
            utils/ut_baseutils.h \
            utils/ut_calculaterect.h \
            utils/ut_configsettings.h \
+           utils/ut_recordingstats.h \
+           utils/ut_dmabufmapcache.h \
            #utils/ut_dbusutils.h \
            #utils/ut_desktopinfo.h \
            utils/ut_screengrabber.h \
            utils/ut_shortcut.h \
            utils/ut_tempfile.h \
+           utils/ut_i420converter.h \
+           utils/ut_i420converter_sws.h \
            utils/ut_utils_other.h \
            widgets/ut_colortoolwidget.h \
            widgets/ut_keybuttonwidget.h \
@@ -126,11 +130,14 @@ HEADERS += test_all_interfaces.h \
         ../../src/utils/baseutils.h \
         ../../src/utils/calculaterect.h \
         ../../src/utils/configsettings.h \
+        ../../src/utils/recordingstats.h \
+        ../../src/utils/dmabufmapcache.h \
         #../../src/utils/dbusutils.h \
         #../../src/utils/desktopinfo.h \
         ../../src/utils/screengrabber.h \
         ../../src/utils/shortcut.h \
         ../../src/utils/tempfile.h \
+        ../../src/utils/i420converter.h \
         ../../src/utils/shapesutils.h \
         ../../src/utils/camerawatcher.h \
         ../../src/utils/voicevolumewatcher.h \
@@ -176,9 +183,28 @@ HEADERS += test_all_interfaces.h \
      #../../src/waylandrecord/waylandintegration.h \
      #../../src/waylandrecord/waylandintegration_p.h \
      #../../src/waylandrecord/recordadmin.h \
-     #../../src/waylandrecord/avoutputstream.h \
-     #../../src/waylandrecord/avinputstream.h \
-     #../../src/waylandrecord/avlibinterface.h \
+        ../../src/waylandrecord/avoutputstream.h \
+        ../../src/waylandrecord/avinputstream.h \
+        ../../src/waylandrecord/avlibinterface.h \
+        ../../src/waylandrecord/channellayouts.h \
+        ../../src/waylandrecord/waylandframe.h \
+        ../../src/waylandrecord/framering.h \
+        ../../src/waylandrecord/framewriter.h \
+        ../../src/waylandrecord/framepacer.h \
+        ../../src/waylandrecord/framecompositor.h \
+        ../../src/waylandrecord/outputbuffers.h \
+        ../../src/waylandrecord/slicepool.h \
+        ../../src/waylandrecord/stagequeue.h \
+        ../../src/waylandrecord/framededup.h \
+        ../../src/waylandrecord/audiosamplefifo.h \
+        ../../src/waylandrecord/reusepool.h \
+        ../../src/waylandrecord/audiomixer.h \
+        ../../src/waylandrecord/fragmentoptions.h \
+        ../../src/waylandrecord/captureclock.h \
+        ../../src/waylandrecord/audiodriftmonitor.h \
+        ../../src/waylandrecord/egldmabufreader.h \
+        ../bench_wayland_record/benchrun.h \
+        ../bench_wayland_record/syntheticframes.h \
         widgets/ut_shapeswidget.h \
         widgets/ut_toptips.h \
         widgets/ut_camerawidget.h \
@@ -205,6 +231,24 @@ HEADERS += test_all_interfaces.h \
     #waylandrecord/ut_waylandintegration_p.h \
     #waylandrecord/ut_waylandintegration.h \
     #waylandrecord/ut_writeframethread.h \
+    waylandrecord/ut_avoutputstream_encode.h \
+    waylandrecord/ut_benchrun.h \
+    waylandrecord/ut_framering.h \
+    waylandrecord/ut_framewriter.h \
+    waylandrecord/ut_framepacer.h \
+    waylandrecord/ut_framecompositor.h \
+    waylandrecord/ut_outputbuffers.h \
+    waylandrecord/ut_slicepool.h \
+    waylandrecord/ut_stagequeue.h \
+    waylandrecord/ut_framededup.h \
+    waylandrecord/ut_audiosamplefifo.h \
+    waylandrecord/ut_reusepool.h \
+    waylandrecord/ut_audiomixer.h \
+    waylandrecord/ut_audiomixer_amix.h \
+    waylandrecord/ut_fragmentoptions.h \
+    waylandrecord/ut_captureclock.h \
+    waylandrecord/ut_audiodriftmonitor.h \
+    waylandrecord/ut_egldmabufreader.h \
     utils/ut_voiceVolumeWatcher.h \
     utils/ut_WaylandScrollMonitor.h \
     ext-image-capture/ut_extcaptureframebuffer.h \
@@ -216,6 +260,9 @@ HEADERS += test_all_interfaces.h \
     ext-image-capture/ut_extcapturesession.h \
     ext-image-capture/ut_multiscreencapturecoordinator.h \
     gstrecord/ut_gstinterface.h \
+    gstrecord/ut_gstencoderselector.h \
+    gstrecord/ut_recordareacrop.h \
+    gstrecord/ut_capturepts.h \
     utils/ut_borderprocessinterface.h \
     ut_event_monitor.h \
     widgets/ut_shapeswidget_ext.h \
@@ -253,6 +300,8 @@ HEADERS += test_all_interfaces.h \
     ../../src/capture.h \
     ../../src/camera/devnummonitor.h \
     ../../src/gstrecord/gstrecordx.h \
+    ../../src/gstrecord/recordareacrop.h \
+    ../../src/gstrecord/capturepts.h \
     ../../src/utils/borderprocessinterface.h \
     ../../src/utils/voicevolumewatcher_interface.h \
     ../../src/widgets/imagemenu.h \
@@ -330,6 +379,8 @@ SOURCES += main.cpp \
     ../../src/utils/baseutils.cpp \
     ../../src/utils/calculaterect.cpp \
     ../../src/utils/configsettings.cpp \
+    ../../src/utils/recordingstats.cpp \
+    ../../src/utils/dmabufmapcache.cpp \
     ../../src/utils/log.cpp \
     ../../src/utils/dbusutils.cpp \
     ../../src/utils/eventlogutils.cpp \
@@ -338,6 +389,7 @@ SOURCES += main.cpp \
     ../../src/utils/screengrabber.cpp \
     ../../src/utils/shortcut.cpp \
     ../../src/utils/tempfile.cpp \
+    ../../src/utils/i420converter.cpp \
     ../../src/utils/shapesutils.cpp \
     ../../src/utils/camerawatcher.cpp \
     ../../src/utils/voicevolumewatcher.cpp \
@@ -369,6 +421,9 @@ SOURCES += main.cpp \
     ../../src/dbusinterface/aiassistantinterface.cpp \
     ../../src/gstrecord/gstrecordx.cpp \
     ../../src/gstrecord/gstinterface.cpp \
+    ../../src/gstrecord/gstencoderselector.cpp \
+    ../../src/gstrecord/recordareacrop.cpp \
+    ../../src/gstrecord/capturepts.cpp \
     ../../src/ext-image-capture/extcapturebridge.cpp \
     ../../src/ext-image-capture/extcaptureframebuffer.cpp \
     ../../src/ext-image-capture/extcaptureintegration.cpp \
@@ -382,9 +437,26 @@ SOURCES += main.cpp \
     #../../src/waylandrecord/writeframethread.cpp \
     #../../src/waylandrecord/waylandintegration.cpp \
     #../../src/waylandrecord/recordadmin.cpp \
-    #../../src/waylandrecord/avinputstream.cpp \
-    #../../src/waylandrecord/avoutputstream.cpp \
-    #../../src/waylandrecord/avlibinterface.cpp \
+    ../../src/waylandrecord/avinputstream.cpp \
+    ../../src/waylandrecord/avoutputstream.cpp \
+    ../../src/waylandrecord/avlibinterface.cpp \
+    ../../src/waylandrecord/channellayouts.cpp \
+    ../../src/waylandrecord/framering.cpp \
+    ../../src/waylandrecord/framewriter.cpp \
+    ../../src/waylandrecord/framepacer.cpp \
+    ../../src/waylandrecord/framecompositor.cpp \
+    ../../src/waylandrecord/outputbuffers.cpp \
+    ../../src/waylandrecord/slicepool.cpp \
+    ../../src/waylandrecord/stagequeue.cpp \
+    ../../src/waylandrecord/framededup.cpp \
+    ../../src/waylandrecord/audiosamplefifo.cpp \
+    ../../src/waylandrecord/audiomixer.cpp \
+    ../../src/waylandrecord/fragmentoptions.cpp \
+    ../../src/waylandrecord/captureclock.cpp \
+    ../../src/waylandrecord/audiodriftmonitor.cpp \
+    ../../src/waylandrecord/egldmabufreader.cpp \
+    ../bench_wayland_record/benchrun.cpp \
+    ../bench_wayland_record/syntheticframes.cpp \
     ../../src/menucontroller/menucontroller.cpp \
     ../../src/dbusinterface/dbusnotify.cpp \
     ../../src/dbusinterface/ocrinterface.cpp \
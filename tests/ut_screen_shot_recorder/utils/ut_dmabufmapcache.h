@@ -0,0 +1,198 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <linux/magic.h>
+#include <sys/mman.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+#include "../../src/utils/dmabufmapcache.h"
+
+using namespace testing;
+
+namespace {
+//用 memfd 代替合成器送来的 dma-buf，内容为 size 个 value
+int createStandInBuffer(size_t size, unsigned char value)
+{
+    int fd = memfd_create("ut_dmabufmapcache", MFD_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close(fd);
+        return -1;
+    }
+    unsigned char *data = static_cast<unsigned char *>(mmap(nullptr, size, PROT_WRITE, MAP_SHARED, fd, 0));
+    memset(data, value, size);
+    munmap(data, size);
+    return fd;
+}
+} // namespace
+
+TEST(DmaBufMapCacheTest, reuseMappingAcrossFds)
+{
+    const size_t size = 4096 * 4;
+    int fd = createStandInBuffer(size, 0x5a);
+    ASSERT_GE(fd, 0);
+
+    DmaBufMapCache cache;
+    DmaBufMapCache::Access access;
+    EXPECT_FALSE(cache.beginRead(-1, size, access));
+    EXPECT_FALSE(cache.beginRead(fd, 0, access));
+
+    ASSERT_TRUE(cache.beginRead(fd, size, access));
+    EXPECT_TRUE(access.isValid());
+    EXPECT_EQ(size, access.size());
+    EXPECT_EQ(0x5a, access.data()[size - 1]);
+    const unsigned char *first = access.data();
+    access.end();
+    EXPECT_FALSE(access.isValid());
+
+    //合成器每帧送来新的 fd，同一块缓冲区复用已有映射
+    int next = dup(fd);
+    close(fd);
+    ASSERT_TRUE(cache.beginRead(next, size / 2, access));
+    EXPECT_EQ(first, access.data());
+    EXPECT_EQ(1u, cache.mapCount());
+    EXPECT_EQ(1u, cache.hitCount());
+    access.end();
+    close(next);
+
+    //fd 全部关闭后映射仍然有效，停止录制时统一释放
+    EXPECT_EQ(1, cache.entryCount());
+    cache.clear();
+    EXPECT_EQ(0, cache.entryCount());
+}
+
+TEST(DmaBufMapCacheTest, remapLargerRange)
+{
+    int fd = createStandInBuffer(8192, 1);
+    ASSERT_GE(fd, 0);
+    DmaBufMapCache cache;
+    DmaBufMapCache::Access access;
+    ASSERT_TRUE(cache.beginRead(fd, 4096, access));
+    access.end();
+    ASSERT_TRUE(cache.beginRead(fd, 8192, access));
+    EXPECT_EQ(8192u, access.size());
+    EXPECT_EQ(2u, cache.mapCount());
+    EXPECT_EQ(1, cache.entryCount());
+    access.end();
+    close(fd);
+}
+
+TEST(DmaBufMapCacheTest, evictLeastRecentlyUsed)
+{
+    const size_t size = 4096;
+    int fds[3];
+    for (int i = 0; i < 3; i++) {
+        fds[i] = createStandInBuffer(size, static_cast<unsigned char>(i));
+        ASSERT_GE(fds[i], 0);
+    }
+
+    DmaBufMapCache cache(2);
+    DmaBufMapCache::Access reading;
+    DmaBufMapCache::Access access;
+    //第 0 块缓冲区一直在读取中，不会被淘汰
+    ASSERT_TRUE(cache.beginRead(fds[0], size, reading));
+    ASSERT_TRUE(cache.beginRead(fds[1], size, access));
+    access.end();
+    ASSERT_TRUE(cache.beginRead(fds[2], size, access));
+    EXPECT_EQ(2, access.data()[0]);
+    access.end();
+    EXPECT_EQ(2, cache.entryCount());
+    EXPECT_EQ(0, reading.data()[0]);
+
+    //第 1 块已被淘汰，需要重新映射
+    ASSERT_TRUE(cache.beginRead(fds[1], size, access));
+    EXPECT_EQ(1, access.data()[0]);
+    EXPECT_EQ(4u, cache.mapCount());
+    access.end();
+
+    //正在读取的映射 clear 时保留
+    cache.clear();
+    EXPECT_EQ(1, cache.entryCount());
+    reading.end();
+    cache.clear();
+    EXPECT_EQ(0, cache.entryCount());
+
+    for (int i = 0; i < 3; i++) {
+        close(fds[i]);
+    }
+}
+
+TEST(DmaBufMapCacheTest, evictIdleMappings)
+{
+    const size_t size = 4096;
+    int stale = createStandInBuffer(size, 0);
+    int live = createStandInBuffer(size, 0);
+    ASSERT_GE(stale, 0);
+    ASSERT_GE(live, 0);
+
+    DmaBufMapCache cache(8, 4);
+    DmaBufMapCache::Access access;
+    ASSERT_TRUE(cache.beginRead(stale, size, access));
+    access.end();
+    //分辨率变化后旧缓冲区不再出现，若干次读取后自动释放
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TRUE(cache.beginRead(live, size, access));
+        access.end();
+    }
+    EXPECT_EQ(1, cache.entryCount());
+    EXPECT_EQ(2u, cache.mapCount());
+    EXPECT_EQ(4u, cache.hitCount());
+
+    close(stale);
+    close(live);
+}
+
+TEST(DmaBufMapCacheTest, stableIdentityFsTypes)
+{
+    //5.3 起的 dma-buf 文件系统和 shmem 每块缓冲区各有 inode
+    EXPECT_TRUE(DmaBufMapCache::isStableIdentityFs(0x444d4142));
+    EXPECT_TRUE(DmaBufMapCache::isStableIdentityFs(TMPFS_MAGIC));
+    //5.3 之前的 dma-buf 共用 anon_inode 的 inode，不能缓存
+    EXPECT_FALSE(DmaBufMapCache::isStableIdentityFs(ANON_INODE_FS_MAGIC));
+    EXPECT_FALSE(DmaBufMapCache::isStableIdentityFs(EXT4_SUPER_MAGIC));
+
+    int fd = createStandInBuffer(4096, 0);
+    ASSERT_GE(fd, 0);
+    EXPECT_TRUE(DmaBufMapCache::hasStableIdentity(fd));
+    close(fd);
+    EXPECT_FALSE(DmaBufMapCache::hasStableIdentity(-1));
+}
+
+TEST(DmaBufMapCacheTest, mapPerReadWithoutStableIdentity)
+{
+    //当前目录一般不在 tmpfs 上，用普通文件代替无法按 inode 区分的缓冲区
+    char path[] = "ut_dmabufmapcache_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    unlink(path);
+    if (DmaBufMapCache::hasStableIdentity(fd)) {
+        close(fd);
+        GTEST_SKIP() << "working directory is on tmpfs";
+    }
+    const size_t size = 4096;
+    ASSERT_EQ(0, ftruncate(fd, static_cast<off_t>(size)));
+
+    DmaBufMapCache cache;
+    DmaBufMapCache::Access access;
+    for (unsigned char value = 1; value <= 3; value++) {
+        //每次读取都能看到文件当前的内容，不复用上一次的映射
+        ASSERT_EQ(static_cast<ssize_t>(1), pwrite(fd, &value, 1, 0));
+        ASSERT_TRUE(cache.beginRead(fd, size, access));
+        EXPECT_EQ(value, access.data()[0]);
+        EXPECT_EQ(1, cache.entryCount());
+        access.end();
+        EXPECT_EQ(0, cache.entryCount());
+    }
+    EXPECT_EQ(3u, cache.mapCount());
+    EXPECT_EQ(0u, cache.hitCount());
+    close(fd);
+}
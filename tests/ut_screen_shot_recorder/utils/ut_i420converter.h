@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#ifdef __loongarch64
+#include <sys/auxv.h>
+#endif
+
+#include "../../src/utils/i420converter.h"
+
+using namespace testing;
+
+class I420ConverterTest : public testing::Test
+{
+public:
+    struct Image {
+        std::vector<uint8_t> rgb;
+        int width;
+        int height;
+        int stride;
+    };
+
+    struct Output {
+        std::vector<uint8_t> buffer;
+        I420Converter::Planes planes;
+    };
+
+    static Image randomImage(int width, int height, int padding, unsigned seed)
+    {
+        Image image;
+        image.width = width;
+        image.height = height;
+        image.stride = width * 4 + padding;
+        image.rgb.resize(static_cast<size_t>(image.stride) * height);
+        std::mt19937 rng(seed);
+        for (uint8_t &byte : image.rgb) {
+            byte = static_cast<uint8_t>(rng());
+        }
+        return image;
+    }
+
+    static Output makeOutput(int width, int height)
+    {
+        Output output;
+        output.buffer.assign(I420Converter::bufferSize(width, height), 0xcd);
+        output.planes = I420Converter::packedPlanes(output.buffer.data(), width, height);
+        return output;
+    }
+
+    static const I420Converter::Isa AllIsas[];
+    static const I420Converter::SourceFormat AllFormats[];
+};
+
+const I420Converter::Isa I420ConverterTest::AllIsas[] = {
+    I420Converter::SSE41, I420Converter::AVX2, I420Converter::NEON, I420Converter::LSX, I420Converter::LASX
+};
+
+const I420Converter::SourceFormat I420ConverterTest::AllFormats[] = {
+    I420Converter::RGBA, I420Converter::BGRA, I420Converter::RGBX, I420Converter::BGRX
+};
+
+TEST_F(I420ConverterTest, knownColors)
+{
+    //BT.601 有限范围：黑 (16,128,128)，白 (235,128,128)，红 (82,90,240)，绿 (144,54,34)，蓝 (41,240,110)
+    const uint8_t colors[5][3] = {{0, 0, 0}, {255, 255, 255}, {255, 0, 0}, {0, 255, 0}, {0, 0, 255}};
+    const uint8_t expected[5][3] = {{16, 128, 128}, {235, 128, 128}, {82, 90, 240}, {144, 54, 34}, {41, 240, 110}};
+    for (int c = 0; c < 5; c++) {
+        std::vector<uint8_t> bgra(4 * 4 * 2);
+        for (size_t i = 0; i < bgra.size(); i += 4) {
+            bgra[i] = colors[c][2];
+            bgra[i + 1] = colors[c][1];
+            bgra[i + 2] = colors[c][0];
+            bgra[i + 3] = 0xff;
+        }
+        Output output = makeOutput(4, 2);
+        ASSERT_TRUE(I420Converter::convert(I420Converter::Scalar, bgra.data(), 16, I420Converter::BGRA, 4, 2, output.planes));
+        EXPECT_EQ(expected[c][0], output.planes.y[7]);
+        EXPECT_EQ(expected[c][1], output.planes.u[1]);
+        EXPECT_EQ(expected[c][2], output.planes.v[1]);
+    }
+}
+
+TEST_F(I420ConverterTest, invalidArguments)
+{
+    std::vector<uint8_t> rgb(16, 0);
+    Output output = makeOutput(2, 2);
+    EXPECT_FALSE(I420Converter::convert(nullptr, 8, I420Converter::RGBA, 2, 2, output.planes));
+    EXPECT_FALSE(I420Converter::convert(rgb.data(), 4, I420Converter::RGBA, 2, 2, output.planes));
+    EXPECT_FALSE(I420Converter::convert(rgb.data(), 8, I420Converter::RGBA, 0, 2, output.planes));
+    EXPECT_TRUE(I420Converter::convert(rgb.data(), 8, I420Converter::RGBA, 2, 2, output.planes));
+}
+
+TEST_F(I420ConverterTest, oddSizeEdges)
+{
+    //3x3：右侧一列和底部一行的色度块只有 2 个或 1 个像素
+    Image image = randomImage(3, 3, 0, 7);
+    Output output = makeOutput(3, 3);
+    ASSERT_TRUE(I420Converter::convert(I420Converter::Scalar, image.rgb.data(), image.stride, I420Converter::RGBA, 3, 3, output.planes));
+    EXPECT_EQ(I420Converter::bufferSize(3, 3), 9u + 4u + 4u);
+    const uint8_t *corner = image.rgb.data() + 2 * image.stride + 2 * 4;
+    const int r = corner[0];
+    const int g = corner[1];
+    const int b = corner[2];
+    EXPECT_EQ((112 * b - 74 * g - 38 * r + 0x8080) >> 8, output.planes.u[3]);
+    EXPECT_EQ((112 * r - 94 * g - 18 * b + 0x8080) >> 8, output.planes.v[3]);
+}
+
+TEST_F(I420ConverterTest, simdBitExact)
+{
+    const int sizes[][2] = {{1, 1}, {7, 3}, {16, 2}, {33, 5}, {64, 8}, {127, 9}, {1920, 4}};
+    unsigned seed = 1;
+    for (I420Converter::Isa isa : AllIsas) {
+        if (!I420Converter::isSupported(isa)) {
+            continue;
+        }
+        for (const auto &size : sizes) {
+            for (I420Converter::SourceFormat format : AllFormats) {
+                Image image = randomImage(size[0], size[1], 12, seed++);
+                Output expected = makeOutput(size[0], size[1]);
+                Output actual = makeOutput(size[0], size[1]);
+                ASSERT_TRUE(I420Converter::convert(I420Converter::Scalar, image.rgb.data(), image.stride, format,
+                                                   image.width, image.height, expected.planes));
+                ASSERT_TRUE(I420Converter::convert(isa, image.rgb.data(), image.stride, format,
+                                                   image.width, image.height, actual.planes));
+                EXPECT_EQ(expected.buffer, actual.buffer) << I420Converter::isaName(isa) << " "
+                                                          << size[0] << "x" << size[1] << " format " << format;
+            }
+        }
+    }
+}
+
+TEST_F(I420ConverterTest, sliced)
+{
+    //按偶数行条带分段转换与整帧转换结果相同
+    Image image = randomImage(50, 21, 0, 99);
+    Output whole = makeOutput(50, 21);
+    Output sliced = makeOutput(50, 21);
+    ASSERT_TRUE(I420Converter::convert(image.rgb.data(), image.stride, I420Converter::BGRX, 50, 21, whole.planes));
+    const int bounds[] = {0, 6, 14, 21};
+    for (int i = 0; i < 3; i++) {
+        const int y = bounds[i];
+        I420Converter::Planes planes = sliced.planes;
+        planes.y += y * planes.strideY;
+        planes.u += y / 2 * planes.strideU;
+        planes.v += y / 2 * planes.strideV;
+        ASSERT_TRUE(I420Converter::convert(image.rgb.data() + y * image.stride, image.stride, I420Converter::BGRX,
+                                           50, bounds[i + 1] - y, planes));
+    }
+    EXPECT_EQ(whole.buffer, sliced.buffer);
+}
+
+TEST_F(I420ConverterTest, activeIsaForBuild)
+{
+    //运行时选择的指令集与编译目标一致，保证向量化实现确实被使用和测试
+    const I420Converter::Isa isa = I420Converter::activeIsa();
+    EXPECT_TRUE(I420Converter::isSupported(isa));
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.1")) {
+        EXPECT_TRUE(isa == I420Converter::AVX2 || isa == I420Converter::SSE41) << I420Converter::isaName(isa);
+    }
+#elif defined(__aarch64__)
+    EXPECT_EQ(I420Converter::NEON, isa);
+#elif defined(__loongarch_sx)
+    //HWCAP_LOONGARCH_LSX
+    if (getauxval(AT_HWCAP) & (1 << 4)) {
+        EXPECT_TRUE(isa == I420Converter::LASX || isa == I420Converter::LSX) << I420Converter::isaName(isa);
+    }
+#else
+    EXPECT_EQ(I420Converter::Scalar, isa);
+#endif
+}
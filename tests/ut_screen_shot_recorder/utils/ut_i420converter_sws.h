@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../../src/utils/i420converter.h"
+
+extern "C" {
+#include <libswscale/swscale.h>
+#include <libavutil/pixfmt.h>
+}
+
+using namespace testing;
+
+/**
+ * @brief 用 libswscale 转换 BGRA 画面，作为 I420Converter 的对照
+ */
+static std::vector<uint8_t> swsI420(const std::vector<uint8_t> &bgra, int width, int height)
+{
+    std::vector<uint8_t> yuv(I420Converter::bufferSize(width, height));
+    SwsContext *context = sws_getContext(width, height, AV_PIX_FMT_BGRA, width, height, AV_PIX_FMT_YUV420P,
+                                         SWS_POINT | SWS_ACCURATE_RND | SWS_BITEXACT, nullptr, nullptr, nullptr);
+    if (nullptr == context) {
+        return std::vector<uint8_t>();
+    }
+    const I420Converter::Planes planes = I420Converter::packedPlanes(yuv.data(), width, height);
+    const uint8_t *src[4] = {bgra.data(), nullptr, nullptr, nullptr};
+    const int srcStride[4] = {width * 4, 0, 0, 0};
+    uint8_t *dst[4] = {planes.y, planes.u, planes.v, nullptr};
+    const int dstStride[4] = {planes.strideY, planes.strideU, planes.strideV, 0};
+    sws_scale(context, src, srcStride, 0, height, dst, dstStride);
+    sws_freeContext(context);
+    return yuv;
+}
+
+//纯色画面上 I420Converter 与 libswscale 的结果一致（定点精度不同，允许相差 1）
+TEST(I420ConverterSwsTest, solidColorsMatchSws)
+{
+    static constexpr int Width = 64;
+    static constexpr int Height = 16;
+    const uint8_t colors[][3] = {{0, 0, 0}, {255, 255, 255}, {255, 0, 0}, {0, 255, 0}, {0, 0, 255}, {30, 144, 255}, {200, 120, 40}};
+    for (const auto &color : colors) {
+        std::vector<uint8_t> bgra(static_cast<size_t>(Width) * Height * 4);
+        for (size_t i = 0; i < bgra.size(); i += 4) {
+            bgra[i] = color[2];
+            bgra[i + 1] = color[1];
+            bgra[i + 2] = color[0];
+            bgra[i + 3] = 0xff;
+        }
+        const std::vector<uint8_t> expected = swsI420(bgra, Width, Height);
+        ASSERT_EQ(I420Converter::bufferSize(Width, Height), expected.size());
+        std::vector<uint8_t> actual(expected.size());
+        ASSERT_TRUE(I420Converter::convert(bgra.data(), Width * 4, I420Converter::BGRA, Width, Height,
+                                           I420Converter::packedPlanes(actual.data(), Width, Height)));
+        for (size_t i = 0; i < expected.size(); i++) {
+            ASSERT_LE(std::abs(static_cast<int>(expected[i]) - static_cast<int>(actual[i])), 1) << "offset " << i;
+        }
+    }
+}
+
+//随机画面的亮度与 libswscale 逐像素一致（允许相差 1），色度为 2x2 块平均，与 SWS_POINT 的取样不同，只比较整体偏差
+TEST(I420ConverterSwsTest, randomLumaMatchesSws)
+{
+    static constexpr int Width = 96;
+    static constexpr int Height = 32;
+    std::mt19937 rng(11);
+    std::vector<uint8_t> bgra(static_cast<size_t>(Width) * Height * 4);
+    for (uint8_t &byte : bgra) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    const std::vector<uint8_t> expected = swsI420(bgra, Width, Height);
+    ASSERT_EQ(I420Converter::bufferSize(Width, Height), expected.size());
+    std::vector<uint8_t> actual(expected.size());
+    ASSERT_TRUE(I420Converter::convert(bgra.data(), Width * 4, I420Converter::BGRA, Width, Height,
+                                       I420Converter::packedPlanes(actual.data(), Width, Height)));
+    const size_t lumaSize = static_cast<size_t>(Width) * Height;
+    for (size_t i = 0; i < lumaSize; i++) {
+        ASSERT_LE(std::abs(static_cast<int>(expected[i]) - static_cast<int>(actual[i])), 1) << "luma offset " << i;
+    }
+}
@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "../../src/utils/recordingstats.h"
+
+using namespace testing;
+
+TEST(LatencyHistogramTest, buckets)
+{
+    EXPECT_EQ(0, LatencyHistogram::bucketIndex(0));
+    EXPECT_EQ(0, LatencyHistogram::bucketIndex(999));
+    EXPECT_EQ(1, LatencyHistogram::bucketIndex(1000));
+    EXPECT_EQ(2, LatencyHistogram::bucketIndex(3000));
+    EXPECT_EQ(11, LatencyHistogram::bucketIndex(1500000));
+    EXPECT_EQ(LatencyHistogram::BucketCount - 1, LatencyHistogram::bucketIndex(3600LL * 1000000000LL));
+    EXPECT_EQ(2048, LatencyHistogram::bucketUpperUs(11));
+
+    LatencyHistogram histogram;
+    EXPECT_EQ(0, histogram.percentileUs(99));
+    //90 个 100us 左右的样本和 10 个 20ms 的慢样本
+    for (int i = 0; i < 90; i++) {
+        histogram.record(100000);
+    }
+    for (int i = 0; i < 10; i++) {
+        histogram.record(20000000);
+    }
+    EXPECT_EQ(100u, histogram.count());
+    EXPECT_EQ(2090000, histogram.averageNs());
+    EXPECT_EQ(20000000, histogram.maxNs());
+    EXPECT_EQ(90u, histogram.bucket(LatencyHistogram::bucketIndex(100000)));
+    EXPECT_EQ(128, histogram.percentileUs(50));
+    EXPECT_EQ(128, histogram.percentileUs(90));
+    //慢样本所在桶的上界 32768us 大于最大值，取最大值
+    EXPECT_EQ(20000, histogram.percentileUs(95));
+    EXPECT_EQ(20000, histogram.percentileUs(100));
+
+    histogram.reset();
+    EXPECT_EQ(0u, histogram.count());
+    EXPECT_EQ(0, histogram.maxNs());
+}
+
+TEST(LatencyHistogramTest, concurrentRecord)
+{
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&histogram, t] {
+            for (int i = 0; i < 10000; i++) {
+                histogram.record((t + 1) * 1000);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(40000u, histogram.count());
+    EXPECT_EQ(4000, histogram.maxNs());
+    uint64_t total = 0;
+    for (int i = 0; i < LatencyHistogram::BucketCount; i++) {
+        total += histogram.bucket(i);
+    }
+    EXPECT_EQ(40000u, total);
+}
+
+TEST(RecordingStatsTest, statsJson)
+{
+    RecordingStats stats;
+    stats.record(RecordingStats::AppendBuffer, 1000, 501000);
+    stats.record(RecordingStats::AppendBuffer, 2000, 1000);
+    stats.setRingOccupancy(3, 60);
+    stats.setRingOccupancy(1, 60);
+    stats.setCounter(RecordingStats::RingDropped, 5);
+    stats.addCounter(RecordingStats::EncodeFailed);
+    stats.addCounter(RecordingStats::EncodeFailed);
+
+    EXPECT_EQ(2u, stats.histogram(RecordingStats::AppendBuffer).count());
+    //结束时间早于开始时间按 0 处理
+    EXPECT_EQ(500000, stats.histogram(RecordingStats::AppendBuffer).maxNs());
+    EXPECT_EQ(1, stats.ringOccupancy());
+    EXPECT_EQ(3, stats.ringMaxOccupancy());
+    EXPECT_EQ(60, stats.ringCapacity());
+    EXPECT_EQ(2u, stats.counter(RecordingStats::EncodeFailed));
+
+    const std::string json = stats.toJson();
+    EXPECT_NE(std::string::npos, json.find("\"appendBuffer\":{\"count\":2,"));
+    EXPECT_NE(std::string::npos, json.find("\"max_us\":500"));
+    EXPECT_NE(std::string::npos, json.find("\"ring\":{\"size\":1,\"max\":3,\"capacity\":60}"));
+    EXPECT_NE(std::string::npos, json.find("\"ring_dropped\":5"));
+    EXPECT_NE(std::string::npos, json.find("\"encode_failed\":2"));
+    EXPECT_NE(std::string::npos, json.find("\"trace\":{\"enabled\":false,\"events\":0}"));
+
+    stats.reset();
+    EXPECT_EQ(0u, stats.histogram(RecordingStats::AppendBuffer).count());
+    EXPECT_EQ(0, stats.ringMaxOccupancy());
+    EXPECT_EQ(0u, stats.counter(RecordingStats::RingDropped));
+}
+
+TEST(RecordingStatsTest, chromeTrace)
+{
+    RecordingStats stats;
+    //未开启跟踪时不记录事件
+    stats.record(RecordingStats::GetFrame, 0, 1000);
+    EXPECT_EQ(0u, stats.traceEventCount());
+    EXPECT_EQ("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[]}", stats.toChromeTrace());
+
+    stats.setTraceEnabled(true, 4);
+    EXPECT_TRUE(stats.isTraceEnabled());
+    const int64_t now = RecordingStats::nowNs();
+    for (int i = 0; i < 5; i++) {
+        stats.record(RecordingStats::WriteVideoFrame, now + i * 1000000, now + i * 1000000 + 250000);
+    }
+    stats.setRingOccupancy(7, 60);
+    EXPECT_EQ(6u, stats.traceEventCount());
+
+    //事件环只保留最新的 4 个事件
+    const std::string trace = stats.toChromeTrace();
+    size_t events = 0;
+    for (size_t pos = trace.find("\"ph\":\"X\""); pos != std::string::npos; pos = trace.find("\"ph\":\"X\"", pos + 1)) {
+        events++;
+    }
+    EXPECT_EQ(3u, events);
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"writeVideoFrame\""));
+    EXPECT_NE(std::string::npos, trace.find("\"dur\":250.000"));
+    EXPECT_NE(std::string::npos, trace.find("\"args\":{\"frames\":7}"));
+
+    const std::string path = "/tmp/ut_recordingstats_trace.json";
+    ASSERT_TRUE(stats.writeChromeTrace(path));
+    std::ifstream file(path.c_str());
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_EQ(trace, content.str());
+    std::remove(path.c_str());
+
+    stats.setTraceEnabled(false);
+    stats.record(RecordingStats::WriteVideoFrame, now, now + 1000);
+    EXPECT_FALSE(stats.isTraceEnabled());
+    EXPECT_EQ(6u, stats.traceEventCount());
+}
+
+TEST(RecordingStatsTest, traceToggleWhileRecording)
+{
+    //录制线程仍在写入时反复开关跟踪，事件环不能被释放或重新分配
+    RecordingStats stats;
+    EXPECT_EQ(0u, stats.traceCapacity());
+    stats.setTraceEnabled(true, 8);
+    EXPECT_EQ(8u, stats.traceCapacity());
+
+    std::atomic<bool> running(true);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 3; t++) {
+        producers.emplace_back([&stats, &running] {
+            while (running.load()) {
+                const int64_t now = RecordingStats::nowNs();
+                stats.record(RecordingStats::AppendBuffer, now, now + 1000);
+                stats.setRingOccupancy(1, 4);
+            }
+        });
+    }
+    for (int i = 0; i < 2000; i++) {
+        stats.setTraceEnabled(i % 2 == 0, 16 + i);
+    }
+    running.store(false);
+    for (std::thread &producer : producers) {
+        producer.join();
+    }
+    //再次开启沿用第一次分配的事件环
+    EXPECT_EQ(8u, stats.traceCapacity());
+    stats.setTraceEnabled(true, 4);
+    EXPECT_EQ(8u, stats.traceCapacity());
+    const int64_t now = RecordingStats::nowNs();
+    stats.record(RecordingStats::GetFrame, now, now + 1000);
+    EXPECT_EQ(1u, stats.traceEventCount());
+    stats.setTraceEnabled(false);
+}
@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <cstdlib>
+
+#include "../../src/waylandrecord/audiodriftmonitor.h"
+
+using namespace testing;
+
+namespace {
+//模拟采集线程：声卡按 actualRate 产生样本，每次读到 packet 个样本，读取时间带有 0~jitterUs 的调度延迟
+struct DriftSimulation {
+    DriftSimulation(int rate, int packetSamples, int64_t jitter)
+        : actualRate(rate), packet(packetSamples), jitterUs(jitter), seed(1), delivered(0), corrected(0) {}
+
+    int actualRate;
+    int packet;
+    int64_t jitterUs;
+    uint32_t seed;
+    int64_t delivered;
+    int64_t corrected;
+
+    int64_t nextJitter()
+    {
+        seed = seed * 1103515245u + 12345u;
+        return jitterUs > 0 ? static_cast<int64_t>((seed >> 8) % static_cast<uint32_t>(jitterUs)) : 0;
+    }
+
+    void run(AudioDriftMonitor &monitor, int64_t startUs, int64_t durationUs)
+    {
+        const int64_t end = startUs + durationUs;
+        for (;;) {
+            const int64_t produced = delivered + packet;
+            const int64_t trueUs = startUs + produced * 1000000LL / actualRate;
+            if (trueUs > end) {
+                break;
+            }
+            delivered = produced;
+            corrected += monitor.update(trueUs + nextJitter(), packet);
+        }
+    }
+};
+}
+
+TEST(AudioDriftMonitorTest, nominalRateNeedsNoCorrection)
+{
+    AudioDriftMonitor monitor;
+    monitor.reset(48000);
+    DriftSimulation sim(48000, 1024, 8000);
+    sim.run(monitor, 1000000, 600LL * 1000000);
+    EXPECT_EQ(0u, monitor.insertedSamples());
+    EXPECT_EQ(0u, monitor.droppedSamples());
+    EXPECT_EQ(0u, monitor.resyncCount());
+    EXPECT_LE(monitor.maxDriftUs(), AudioDriftMonitor::ToleranceUs);
+}
+
+TEST(AudioDriftMonitorTest, fastClockHourLongRecording)
+{
+    //48003Hz 的声卡一小时多出 10800 个样本（225ms），修正后漂移应保持在容差以内
+    AudioDriftMonitor monitor;
+    monitor.reset(48000);
+    DriftSimulation sim(48003, 1024, 8000);
+    const int64_t hourUs = 3600LL * 1000000;
+    sim.run(monitor, 1000000, hourUs);
+    EXPECT_EQ(0u, monitor.insertedSamples());
+    EXPECT_EQ(0u, monitor.resyncCount());
+    EXPECT_NEAR(10800.0, static_cast<double>(monitor.droppedSamples()), 48000.0 * AudioDriftMonitor::ToleranceUs / 1000000);
+    EXPECT_EQ(-static_cast<int64_t>(monitor.droppedSamples()), sim.corrected);
+    EXPECT_LE(std::llabs(monitor.driftUs()), AudioDriftMonitor::ToleranceUs);
+    EXPECT_LE(monitor.maxDriftUs(), AudioDriftMonitor::ToleranceUs + 1000);
+
+    //写入文件的样本数与经过的时间之差
+    const int64_t written = sim.delivered + sim.corrected;
+    const int64_t elapsedUs = sim.delivered * 1000000LL / 48003;
+    const int64_t skewUs = written * 1000000LL / 48000 - elapsedUs;
+    EXPECT_LE(std::llabs(skewUs), AudioDriftMonitor::ToleranceUs + 1000);
+}
+
+TEST(AudioDriftMonitorTest, slowClockInsertsSamples)
+{
+    AudioDriftMonitor monitor;
+    monitor.reset(44100);
+    DriftSimulation sim(44096, 940, 5000);
+    sim.run(monitor, 0, 1800LL * 1000000);
+    EXPECT_EQ(0u, monitor.droppedSamples());
+    EXPECT_GT(monitor.insertedSamples(), 0u);
+    EXPECT_EQ(static_cast<int64_t>(monitor.insertedSamples()), sim.corrected);
+    EXPECT_LE(std::llabs(monitor.driftUs()), AudioDriftMonitor::ToleranceUs);
+}
+
+TEST(AudioDriftMonitorTest, startupBurstIsBaseline)
+{
+    //采集设备启动时一次性送出缓存的数据，第一个窗口作为基线，不会因此丢弃样本
+    AudioDriftMonitor monitor;
+    monitor.reset(48000);
+    int64_t now = 5000000;
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(0, monitor.update(now, 1024));
+    }
+    EXPECT_EQ(5000000 - 1024 * 1000000LL / 48000, monitor.startUs());
+    DriftSimulation sim(48000, 1024, 2000);
+    sim.delivered = 20 * 1024;
+    sim.run(monitor, now - sim.delivered * 1000000LL / 48000, 300LL * 1000000);
+    EXPECT_EQ(0u, monitor.droppedSamples());
+    EXPECT_EQ(0u, monitor.insertedSamples());
+}
+
+TEST(AudioDriftMonitorTest, longGapResyncs)
+{
+    //设备断流两秒，漂移超过 ResyncUs 后直接以当前位置为基线，不逐个样本补齐
+    AudioDriftMonitor monitor;
+    monitor.reset(48000);
+    DriftSimulation sim(48000, 1024, 1000);
+    sim.run(monitor, 0, 60LL * 1000000);
+    DriftSimulation resumed(48000, 1024, 1000);
+    resumed.run(monitor, 62LL * 1000000, 60LL * 1000000);
+    EXPECT_EQ(1u, monitor.resyncCount());
+    EXPECT_LE(monitor.insertedSamples(), 48u * 10);
+    EXPECT_LE(std::llabs(monitor.driftUs()), AudioDriftMonitor::ToleranceUs);
+}
+
+TEST(AudioDriftMonitorTest, reset)
+{
+    AudioDriftMonitor monitor;
+    EXPECT_EQ(0, monitor.update(1000, 1024));
+    monitor.reset(48000);
+    EXPECT_EQ(-1, monitor.startUs());
+    EXPECT_EQ(0, monitor.update(1000, 0));
+    EXPECT_EQ(-1, monitor.startUs());
+    EXPECT_EQ(48000, monitor.sampleRate());
+}
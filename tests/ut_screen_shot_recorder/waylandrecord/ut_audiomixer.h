@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "../../src/waylandrecord/audiomixer.h"
+
+using namespace testing;
+
+TEST(AudioMixerTest, initAndGains)
+{
+    AudioMixer mixer;
+    EXPECT_FALSE(mixer.isInit());
+    EXPECT_FALSE(mixer.init(AudioMixer::UnsupportedSample, 2));
+    EXPECT_FALSE(mixer.init(AudioMixer::FloatSample, 0));
+    EXPECT_TRUE(mixer.init(AudioMixer::FloatSample, 2));
+    EXPECT_FLOAT_EQ(AudioMixer::DefaultGain, mixer.firstGain());
+    mixer.setGains(-1.0f, 10.0f);
+    EXPECT_FLOAT_EQ(0.0f, mixer.firstGain());
+    EXPECT_FLOAT_EQ(AudioMixer::MaxGain, mixer.secondGain());
+    mixer.release();
+    EXPECT_FALSE(mixer.isInit());
+}
+
+TEST(AudioMixerTest, s16SaturatingAdd)
+{
+    AudioMixer mixer;
+    ASSERT_TRUE(mixer.init(AudioMixer::S16Sample, 1));
+    mixer.setGains(1.0f, 1.0f);
+    std::vector<int16_t> first = {30000, -30000, 100, -5};
+    std::vector<int16_t> second = {10000, -10000, 200, 5};
+    std::vector<int16_t> out(first.size());
+    const uint8_t *a[1] = {reinterpret_cast<const uint8_t *>(first.data())};
+    const uint8_t *b[1] = {reinterpret_cast<const uint8_t *>(second.data())};
+    uint8_t *o[1] = {reinterpret_cast<uint8_t *>(out.data())};
+    ASSERT_TRUE(mixer.mix(a, b, o, static_cast<int>(out.size())));
+    EXPECT_EQ(32767, out[0]);
+    EXPECT_EQ(-32768, out[1]);
+    EXPECT_EQ(300, out[2]);
+    EXPECT_EQ(0, out[3]);
+    //默认增益取两路平均
+    mixer.setGains(AudioMixer::DefaultGain, AudioMixer::DefaultGain);
+    ASSERT_TRUE(mixer.mix(a, b, o, static_cast<int>(out.size())));
+    EXPECT_EQ(20000, out[0]);
+    EXPECT_EQ(-20000, out[1]);
+    EXPECT_EQ(150, out[2]);
+}
+
+TEST(AudioMixerTest, floatPlanarInPlace)
+{
+    //输出写回第一路输入
+    AudioMixer mixer;
+    ASSERT_TRUE(mixer.init(AudioMixer::FloatSample, 2));
+    mixer.setGains(1.0f, 0.25f);
+    std::vector<float> left = {0.5f, 0.9f, -0.9f};
+    std::vector<float> right = {-0.5f, 0.1f, 0.0f};
+    std::vector<float> sysLeft = {0.4f, 0.8f, -0.8f};
+    std::vector<float> sysRight = {0.4f, 0.0f, 0.4f};
+    const uint8_t *a[2] = {reinterpret_cast<const uint8_t *>(left.data()), reinterpret_cast<const uint8_t *>(right.data())};
+    const uint8_t *b[2] = {reinterpret_cast<const uint8_t *>(sysLeft.data()), reinterpret_cast<const uint8_t *>(sysRight.data())};
+    uint8_t *o[2] = {reinterpret_cast<uint8_t *>(left.data()), reinterpret_cast<uint8_t *>(right.data())};
+    ASSERT_TRUE(mixer.mix(a, b, o, 3));
+    EXPECT_FLOAT_EQ(0.6f, left[0]);
+    EXPECT_FLOAT_EQ(1.0f, left[1]);
+    EXPECT_FLOAT_EQ(-1.0f, left[2]);
+    EXPECT_FLOAT_EQ(-0.4f, right[0]);
+    EXPECT_FLOAT_EQ(0.1f, right[1]);
+    EXPECT_FLOAT_EQ(0.1f, right[2]);
+}
+
+TEST(AudioMixerTest, integerFormats)
+{
+    AudioMixer mixer;
+    ASSERT_TRUE(mixer.init(AudioMixer::U8Sample, 1));
+    std::vector<uint8_t> first = {128, 255, 0, 138};
+    std::vector<uint8_t> second = {128, 255, 0, 148};
+    std::vector<uint8_t> out(first.size());
+    const uint8_t *a[1] = {first.data()};
+    const uint8_t *b[1] = {second.data()};
+    uint8_t *o[1] = {out.data()};
+    ASSERT_TRUE(mixer.mix(a, b, o, 4));
+    EXPECT_EQ(128, out[0]);
+    EXPECT_EQ(255, out[1]);
+    EXPECT_EQ(0, out[2]);
+    EXPECT_EQ(143, out[3]);
+
+    //32 位样本保留低位精度
+    ASSERT_TRUE(mixer.init(AudioMixer::S32Sample, 1));
+    mixer.setGains(1.0f, 1.0f);
+    std::vector<int32_t> first32 = {2000000001, -2000000000, 123456789};
+    std::vector<int32_t> second32 = {2000000000, -2000000000, 1};
+    std::vector<int32_t> out32(first32.size());
+    const uint8_t *a32[1] = {reinterpret_cast<const uint8_t *>(first32.data())};
+    const uint8_t *b32[1] = {reinterpret_cast<const uint8_t *>(second32.data())};
+    uint8_t *o32[1] = {reinterpret_cast<uint8_t *>(out32.data())};
+    ASSERT_TRUE(mixer.mix(a32, b32, o32, 3));
+    EXPECT_EQ(INT32_MAX, out32[0]);
+    EXPECT_EQ(INT32_MIN, out32[1]);
+    EXPECT_EQ(123456790, out32[2]);
+}
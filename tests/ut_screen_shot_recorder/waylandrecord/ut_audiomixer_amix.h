@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../../src/waylandrecord/audiomixer.h"
+
+extern "C" {
+#include <libavfilter/avfilter.h>
+#include <libavfilter/buffersink.h>
+#include <libavfilter/buffersrc.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/frame.h>
+#include <libavutil/opt.h>
+}
+
+using namespace testing;
+
+/**
+ * @brief 用 libavfilter 的 amix 混合两路 48kHz 立体声平面浮点音频，作为 AudioMixer 的对照
+ * 输入和输出均为左声道在前、右声道在后依次排列，失败返回空
+ */
+static std::vector<float> amixReference(const std::vector<float> &first, const std::vector<float> &second, int nbSamples)
+{
+    std::vector<float> left;
+    std::vector<float> right;
+    AVFilterGraph *graph = avfilter_graph_alloc();
+    AVFilterContext *sources[2] = {nullptr, nullptr};
+    AVFilterContext *amix = nullptr;
+    AVFilterContext *sink = nullptr;
+    const char *args = "time_base=1/48000:sample_rate=48000:sample_fmt=fltp:channel_layout=stereo";
+    const enum AVSampleFormat sinkFormats[] = {AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_NONE};
+    if (nullptr == graph
+            || avfilter_graph_create_filter(&sources[0], avfilter_get_by_name("abuffer"), "in0", args, nullptr, graph) < 0
+            || avfilter_graph_create_filter(&sources[1], avfilter_get_by_name("abuffer"), "in1", args, nullptr, graph) < 0
+            || avfilter_graph_create_filter(&amix, avfilter_get_by_name("amix"), "amix", "inputs=2", nullptr, graph) < 0
+            || avfilter_graph_create_filter(&sink, avfilter_get_by_name("abuffersink"), "out", nullptr, nullptr, graph) < 0
+            || av_opt_set_int_list(sink, "sample_fmts", sinkFormats, AV_SAMPLE_FMT_NONE, AV_OPT_SEARCH_CHILDREN) < 0
+            || avfilter_link(sources[0], 0, amix, 0) < 0
+            || avfilter_link(sources[1], 0, amix, 1) < 0
+            || avfilter_link(amix, 0, sink, 0) < 0
+            || avfilter_graph_config(graph, nullptr) < 0) {
+        avfilter_graph_free(&graph);
+        return std::vector<float>();
+    }
+    const std::vector<float> *inputs[2] = {&first, &second};
+    for (int i = 0; i < 2; i++) {
+        AVFrame *frame = av_frame_alloc();
+        frame->nb_samples = nbSamples;
+        frame->format = AV_SAMPLE_FMT_FLTP;
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 24, 100)
+        av_channel_layout_default(&frame->ch_layout, 2);
+#else
+        frame->channel_layout = AV_CH_LAYOUT_STEREO;
+        frame->channels = 2;
+#endif
+        frame->sample_rate = 48000;
+        frame->pts = 0;
+        if (av_frame_get_buffer(frame, 0) < 0) {
+            av_frame_free(&frame);
+            avfilter_graph_free(&graph);
+            return std::vector<float>();
+        }
+        for (int ch = 0; ch < 2; ch++) {
+            memcpy(frame->data[ch], inputs[i]->data() + ch * nbSamples, static_cast<size_t>(nbSamples) * sizeof(float));
+        }
+        av_buffersrc_add_frame(sources[i], frame);
+        av_frame_free(&frame);
+        //送入结束标记，amix 输出全部缓存的样本
+        av_buffersrc_add_frame(sources[i], nullptr);
+    }
+    AVFrame *out = av_frame_alloc();
+    while (av_buffersink_get_frame(sink, out) >= 0) {
+        const float *l = reinterpret_cast<const float *>(out->data[0]);
+        const float *r = reinterpret_cast<const float *>(out->data[1]);
+        left.insert(left.end(), l, l + out->nb_samples);
+        right.insert(right.end(), r, r + out->nb_samples);
+        av_frame_unref(out);
+    }
+    av_frame_free(&out);
+    avfilter_graph_free(&graph);
+    left.insert(left.end(), right.begin(), right.end());
+    return left;
+}
+
+TEST(AudioMixerAmixTest, nativeMixMatchesAmix)
+{
+    //两路不同频率的正弦波和噪声，幅度不超过 0.5，避免混音器的截断与 amix 不一致
+    const int nbSamples = 1024;
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    std::vector<float> mic(2 * nbSamples);
+    std::vector<float> sys(2 * nbSamples);
+    for (int i = 0; i < nbSamples; i++) {
+        mic[i] = 0.5f * static_cast<float>(sin(2 * M_PI * 440.0 * i / 48000.0));
+        mic[nbSamples + i] = 0.4f * static_cast<float>(sin(2 * M_PI * 660.0 * i / 48000.0));
+        sys[i] = 0.3f * static_cast<float>(sin(2 * M_PI * 1000.0 * i / 48000.0));
+        sys[nbSamples + i] = noise(random);
+    }
+    const std::vector<float> reference = amixReference(mic, sys, nbSamples);
+    ASSERT_EQ(static_cast<size_t>(2 * nbSamples), reference.size());
+
+    AudioMixer mixer;
+    ASSERT_TRUE(mixer.init(AudioMixer::FloatSample, 2));
+    std::vector<float> mixed(2 * nbSamples);
+    const uint8_t *first[2] = {reinterpret_cast<const uint8_t *>(mic.data()), reinterpret_cast<const uint8_t *>(mic.data() + nbSamples)};
+    const uint8_t *second[2] = {reinterpret_cast<const uint8_t *>(sys.data()), reinterpret_cast<const uint8_t *>(sys.data() + nbSamples)};
+    uint8_t *out[2] = {reinterpret_cast<uint8_t *>(mixed.data()), reinterpret_cast<uint8_t *>(mixed.data() + nbSamples)};
+    ASSERT_TRUE(mixer.mix(first, second, out, nbSamples));
+
+    for (int i = 0; i < 2 * nbSamples; i++) {
+        ASSERT_NEAR(reference[i], mixed[i], 1e-6) << "sample " << i % nbSamples << " channel " << i / nbSamples;
+    }
+}
@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../../src/waylandrecord/audiosamplefifo.h"
+
+using namespace testing;
+
+TEST(AudioSampleFifoTest, initArguments)
+{
+    AudioSampleFifo fifo;
+    EXPECT_FALSE(fifo.isInit());
+    EXPECT_FALSE(fifo.init(0, 2, 16));
+    EXPECT_FALSE(fifo.init(2, 2, 0));
+    EXPECT_TRUE(fifo.init(2, 2, 16));
+    EXPECT_EQ(16, fifo.capacity());
+    EXPECT_EQ(0, fifo.size());
+    EXPECT_EQ(16, fifo.space());
+    fifo.release();
+    EXPECT_FALSE(fifo.isInit());
+}
+
+TEST(AudioSampleFifoTest, planarWrapAround)
+{
+    //两个平面，每个样本 2 字节，容量 5 个样本
+    AudioSampleFifo fifo;
+    ASSERT_TRUE(fifo.init(2, 2, 5));
+    uint8_t left[8];
+    uint8_t right[8];
+    uint8_t outLeft[8];
+    uint8_t outRight[8];
+    const uint8_t *in[2] = {left, right};
+    uint8_t *out[2] = {outLeft, outRight};
+    uint8_t value = 0;
+    for (int round = 0; round < 6; round++) {
+        for (int i = 0; i < 8; i++) {
+            left[i] = value;
+            right[i] = static_cast<uint8_t>(value + 100);
+            value++;
+        }
+        EXPECT_EQ(3, fifo.write(in, 3));
+        EXPECT_EQ(3, fifo.size());
+        EXPECT_EQ(3, fifo.read(out, 4));
+        for (int i = 0; i < 6; i++) {
+            EXPECT_EQ(left[i], outLeft[i]);
+            EXPECT_EQ(right[i], outRight[i]);
+        }
+    }
+}
+
+TEST(AudioSampleFifoTest, fullAndEmpty)
+{
+    AudioSampleFifo fifo;
+    ASSERT_TRUE(fifo.init(1, 4, 4));
+    std::vector<uint8_t> data(32, 0x11);
+    const uint8_t *in[1] = {data.data()};
+    uint8_t *out[1] = {data.data()};
+    //空间不足时只写入能容纳的部分
+    EXPECT_EQ(4, fifo.write(in, 6));
+    EXPECT_EQ(0, fifo.space());
+    EXPECT_EQ(0, fifo.write(in, 1));
+    EXPECT_EQ(4, fifo.read(out, 8));
+    EXPECT_EQ(0, fifo.read(out, 1));
+}
+
+TEST(AudioSampleFifoTest, concurrentProducerConsumer)
+{
+    static constexpr int Total = 200000;
+    static constexpr int Chunk = 37;
+    AudioSampleFifo fifo;
+    ASSERT_TRUE(fifo.init(2, 4, 256));
+    std::thread producer([&fifo] {
+        std::vector<uint32_t> left(Chunk);
+        std::vector<uint32_t> right(Chunk);
+        int next = 0;
+        while (next < Total) {
+            const int count = std::min(Chunk, Total - next);
+            for (int i = 0; i < count; i++) {
+                left[static_cast<size_t>(i)] = static_cast<uint32_t>(next + i);
+                right[static_cast<size_t>(i)] = ~static_cast<uint32_t>(next + i);
+            }
+            const uint8_t *in[2] = {reinterpret_cast<const uint8_t *>(left.data()),
+                                    reinterpret_cast<const uint8_t *>(right.data())
+                                   };
+            const int written = fifo.write(in, count);
+            if (written == 0) {
+                std::this_thread::yield();
+            }
+            next += written;
+            //未写入的部分下一轮重新生成
+        }
+    });
+    std::vector<uint32_t> left(64);
+    std::vector<uint32_t> right(64);
+    uint32_t expected = 0;
+    bool ordered = true;
+    while (expected < static_cast<uint32_t>(Total)) {
+        uint8_t *out[2] = {reinterpret_cast<uint8_t *>(left.data()), reinterpret_cast<uint8_t *>(right.data())};
+        const int count = fifo.read(out, 64);
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+        for (int i = 0; i < count; i++) {
+            ordered = ordered && left[static_cast<size_t>(i)] == expected && right[static_cast<size_t>(i)] == ~expected;
+            expected++;
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(0, fifo.size());
+}
+
+TEST(AudioSampleFifoTest, waitForSpaceWakesOnRead)
+{
+    AudioSampleFifo fifo;
+    ASSERT_TRUE(fifo.init(1, 4, 8));
+    std::vector<uint8_t> data(64, 0x22);
+    const uint8_t *in[1] = {data.data()};
+    uint8_t *out[1] = {data.data()};
+    EXPECT_TRUE(fifo.waitForSpace(8, 0));
+    ASSERT_EQ(8, fifo.write(in, 8));
+
+    //空间不足时等到超时
+    const auto timeoutBegin = std::chrono::steady_clock::now();
+    EXPECT_FALSE(fifo.waitForSpace(4, 30));
+    EXPECT_GE(std::chrono::steady_clock::now() - timeoutBegin, std::chrono::milliseconds(30));
+
+    //消费者读出样本后立即唤醒，不必等到超时
+    std::thread consumer([&fifo, &out] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        fifo.read(out, 2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        fifo.read(out, 4);
+    });
+    const auto wakeBegin = std::chrono::steady_clock::now();
+    EXPECT_TRUE(fifo.waitForSpace(6, 10000));
+    EXPECT_LT(std::chrono::steady_clock::now() - wakeBegin, std::chrono::milliseconds(5000));
+    EXPECT_EQ(6, fifo.space());
+    consumer.join();
+}
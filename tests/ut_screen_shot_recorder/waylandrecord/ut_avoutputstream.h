@@ -13,6 +13,7 @@
 #include <QHBoxLayout>
 #include  <QFont>
 #include <QScreen>
+#include <vector>
 #include "stub.h"
 #include "addr_pri.h"
 #include "../../src/waylandrecord/avoutputstream.h"
@@ -117,10 +118,10 @@ int av_get_channel_layout_nb_channels_stub(uint64_t channel_layout)
 
 }
 
-int init_filters_stub()
+bool initAudioMixer_stub()
 {
-    qDebug() << "替换ffmpeg: init_filters!";
-    return 1;
+    qDebug() << "替换: initAudioMixer!";
+    return true;
 }
 
 int avio_open_stub(AVIOContext **s, const char *url, int flags)
@@ -153,6 +154,18 @@ int avcodec_encode_video2_stub(AVCodecContext *avctx, AVPacket *avpkt,
     return 1;
 }
 
+int avcodec_send_frame_stub(AVCodecContext *avctx, const AVFrame *frame)
+{
+    qDebug() << "替换ffmpeg: avcodec_send_frame!";
+    return 0;
+}
+
+int avcodec_receive_packet_stub(AVCodecContext *avctx, AVPacket *avpkt)
+{
+    qDebug() << "替换ffmpeg: avcodec_receive_packet!";
+    return AVERROR(EAGAIN);
+}
+
 int av_samples_alloc_stub(uint8_t **audio_data, int *linesize, int nb_channels,
                           int nb_samples, enum AVSampleFormat sample_fmt, int align)
 {
@@ -188,58 +201,6 @@ int avcodec_encode_audio2_stub(AVCodecContext *avctx, AVPacket *avpkt,
     return 1;
 }
 
-int avfilter_graph_create_filter_stub(AVFilterContext **filt_ctx, const AVFilter *filt,
-                                      const char *name, const char *args, void *opaque,
-                                      AVFilterGraph *graph_ctx)
-{
-    qDebug() << "替换ffmpeg: avfilter_graph_set_auto_convert!";
-
-
-    return 1;
-}
-
-int av_opt_set_bin_stub(void *obj, const char *name, const uint8_t *val, int size, int search_flags)
-{
-    qDebug() << "替换ffmpeg: av_opt_set_bin!";
-
-    return 1;
-}
-
-int avfilter_graph_parse_ptr_stub(AVFilterGraph *graph, const char *filters,
-                                  AVFilterInOut **inputs, AVFilterInOut **outputs,
-                                  void *log_ctx)
-{
-    qDebug() << "替换ffmpeg: avfilter_graph_parse_ptr!";
-
-    return 1;
-}
-
-int avfilter_graph_config_stub(AVFilterGraph *graphctx, void *log_ctx)
-{
-    qDebug() << "替换ffmpeg: avfilter_graph_config!";
-    return 1;
-}
-
-void av_get_channel_layout_string_stub(char *buf, int buf_size, int nb_channels, uint64_t channel_layout)
-{
-    qDebug() << "替换ffmpeg: av_get_channel_layout_string!";
-
-}
-
-int av_buffersrc_add_frame_flags_stub(AVFilterContext *buffer_src,
-                                      AVFrame *frame, int flags)
-{
-    qDebug() << "替换ffmpeg: av_buffersrc_add_frame_flags!";
-    return 1;
-}
-
-int av_buffersink_get_frame_stub(AVFilterContext *ctx, AVFrame *frame)
-{
-
-    qDebug() << "替换ffmpeg: av_buffersink_get_frame!";
-    return 1;
-}
-
 int av_audio_fifo_read_stub(AVAudioFifo *af, void **data, int nb_samples)
 {
     qDebug() << "替换ffmpeg: av_audio_fifo_read!";
@@ -319,19 +280,17 @@ ACCESS_PRIVATE_FIELD(CAVOutputStream, AVCodecContext *, m_pSysCodecContext);
 ACCESS_PRIVATE_FIELD(CAVOutputStream, SwrContext *, m_pSysAudioSwrContext);
 ACCESS_PRIVATE_FIELD(CAVOutputStream, AVAudioFifo *, m_sysAudioFifo);
 ACCESS_PRIVATE_FIELD(CAVOutputStream, AVCodecContext *, pCodecCtx_amix);
-ACCESS_PRIVATE_FIELD(CAVOutputStream, AVFilterContext *, buffersink_ctx);
 ACCESS_PRIVATE_FIELD(CAVOutputStream,   AVFormatContext *, m_videoFormatContext);
 ACCESS_PRIVATE_FIELD(CAVOutputStream, int, is_fifo_scardinit);
-ACCESS_PRIVATE_FIELD(CAVOutputStream, int64_t, m_start_mix_time);
-ACCESS_PRIVATE_FIELD(CAVOutputStream, int64_t, m_nLastAudioMixPresentationTime);
 ACCESS_PRIVATE_FIELD(CAVOutputStream, AVStream *, audio_amix_st);
 ACCESS_PRIVATE_FIELD(CAVOutputStream, bool, m_isOverWrite);
 ACCESS_PRIVATE_FIELD(CAVOutputStream, bool, m_isWriteFrame);
 ACCESS_PRIVATE_FIELD(CAVOutputStream, AVStream *, m_videoStream);
 ACCESS_PRIVATE_FIELD(CAVOutputStream, uint8_t *, m_out_buffer);
-ACCESS_PRIVATE_FIELD(CAVOutputStream, AVFilterGraph *, filter_graph);
 ACCESS_PRIVATE_FIELD(CAVOutputStream, AVFrame *, mMic_frame);
 ACCESS_PRIVATE_FIELD(CAVOutputStream, AVFrame *, mSpeaker_frame);
+ACCESS_PRIVATE_FIELD(CAVOutputStream, AudioSampleFifo, m_micMixFifo);
+ACCESS_PRIVATE_FIELD(CAVOutputStream, AudioSampleFifo, m_sysMixFifo);
 
 TEST_F(CAVOutputStreamTest, SetVideoCodecProp)
 {
@@ -364,7 +323,7 @@ TEST_F(CAVOutputStreamTest, open)
     stub.set(avpicture_get_size, avpicture_get_size_stub);
     stub.set(ADDR(CAVOutputStream, init_context_amix), init_context_amix_stub);
     stub.set(av_get_channel_layout_nb_channels, av_get_channel_layout_nb_channels_stub);
-    stub.set(ADDR(CAVOutputStream, init_filters), init_filters_stub);
+    stub.set(ADDR(CAVOutputStream, initAudioMixer), initAudioMixer_stub);
     stub.set(avcodec_open2, avcodec_open2_stub1);
     stub.set(avformat_new_stream, avformat_new_stream_stub);
     stub.set(av_dump_format, av_dump_format_stub1);
@@ -379,6 +338,9 @@ TEST_F(CAVOutputStreamTest, open)
     int sample_rate = 48000;
     int64_t bit_rate = 48000;
     m_avOutputStream->SetAudioCodecProp(AV_CODEC_ID_AAC, sample_rate, channel, channel_layout, bit_rate);
+    //init_context_amix 被替换，混音编码器上下文由测试提供
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream) = new AVCodecContext();
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->channels = channel;
     m_avOutputStream->open("tmp/test.mp4");
 
     stub.reset(avformat_alloc_output_context2);
@@ -389,7 +351,7 @@ TEST_F(CAVOutputStreamTest, open)
     stub.reset(avpicture_get_size);
     stub.reset(ADDR(CAVOutputStream, init_context_amix));
     stub.reset(av_get_channel_layout_nb_channels);
-    stub.reset(ADDR(CAVOutputStream, init_filters));
+    stub.reset(ADDR(CAVOutputStream, initAudioMixer));
     stub.reset(avio_open);
     stub.reset(avformat_new_stream);
     stub.reset(av_dump_format);
@@ -405,6 +367,7 @@ TEST_F(CAVOutputStreamTest, open)
     delete  access_private_field::CAVOutputStreampCodecCtx(*m_avOutputStream);
     delete  access_private_field::CAVOutputStreamm_pMicCodecContext(*m_avOutputStream);
     delete  access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream);
+    delete  access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream);
     delete  access_private_field::CAVOutputStreamm_videoFormatContext(*m_avOutputStream)->oformat;
     delete  access_private_field::CAVOutputStreamm_videoFormatContext(*m_avOutputStream);
 }
@@ -437,17 +400,49 @@ TEST_F(CAVOutputStreamTest, writeVideoFrame)
     access_private_field::CAVOutputStreampCodecCtx(*m_avOutputStream)->height = image.height();
     access_private_field::CAVOutputStreampFrameYUV(*m_avOutputStream) = av_frame_alloc();
 
-    stub.set(avcodec_encode_video2, avcodec_encode_video2_stub);
+    stub.set(avcodec_send_frame, avcodec_send_frame_stub);
+    stub.set(avcodec_receive_packet, avcodec_receive_packet_stub);
 
     m_avOutputStream->SetVideoCodecProp(AVCodecID::AV_CODEC_ID_H264, 24, 48000, 100, 1920, 1080);
     m_avOutputStream->writeVideoFrame(frame);
+    //稳态下不再申请新的帧和包
+    m_avOutputStream->writeVideoFrame(frame);
+    EXPECT_EQ(1u, m_avOutputStream->videoFrameAllocCount());
 
-    stub.reset(avcodec_encode_video2);
+    stub.reset(avcodec_send_frame);
+    stub.reset(avcodec_receive_packet);
 
     delete access_private_field::CAVOutputStreampCodecCtx(*m_avOutputStream);
     sws_freeContext(access_private_field::CAVOutputStreamm_pVideoSwsContext(*m_avOutputStream));
 }
 
+TEST_F(CAVOutputStreamTest, videoEncoderOptions)
+{
+    CAVOutputStream::VideoEncoderOptions options;
+    options.preset = "veryfast";
+    options.tune = "stillimage";
+    options.crf = 23;
+    options.threads = 4;
+    options.sliceThreads = true;
+    m_avOutputStream->setVideoEncoderOptions(options);
+    EXPECT_EQ(QString("veryfast"), m_avOutputStream->videoEncoderOptions().preset);
+    EXPECT_EQ(QString("stillimage"), m_avOutputStream->videoEncoderOptions().tune);
+    EXPECT_EQ(23, m_avOutputStream->videoEncoderOptions().crf);
+    EXPECT_EQ(4, m_avOutputStream->videoEncoderOptions().threads);
+    EXPECT_TRUE(m_avOutputStream->videoEncoderOptions().sliceThreads);
+
+    //无效取值回退
+    options.preset = "placebo1";
+    options.tune = "film1";
+    options.crf = 99;
+    options.threads = -2;
+    m_avOutputStream->setVideoEncoderOptions(options);
+    EXPECT_EQ(QString("ultrafast"), m_avOutputStream->videoEncoderOptions().preset);
+    EXPECT_TRUE(m_avOutputStream->videoEncoderOptions().tune.isEmpty());
+    EXPECT_EQ(51, m_avOutputStream->videoEncoderOptions().crf);
+    EXPECT_EQ(0, m_avOutputStream->videoEncoderOptions().threads);
+}
+
 int audioWrite_stub(AVAudioFifo *af, void **data, int nb_samples)
 {
     return 49000;
@@ -553,6 +548,13 @@ TEST_F(CAVOutputStreamTest, writeMicToMixAudioFrame)
     access_private_field::CAVOutputStreamm_pMicCodecContext(*m_avOutputStream)->channel_layout = 2;
     access_private_field::CAVOutputStreamm_pMicAudioSwrContext(*m_avOutputStream) = nullptr;
     access_private_field::CAVOutputStreamm_micAudioFifo(*m_avOutputStream) = nullptr;
+    //混音路径重采样为混音编码器的格式
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream) = new AVCodecContext();
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->frame_size = 1152;
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->channels = 2;
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->sample_fmt = AVSampleFormat::AV_SAMPLE_FMT_U8P;
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->sample_rate = 48000;
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->channel_layout = AV_CH_LAYOUT_STEREO;
     AVStream *stream = new AVStream();
     stream->codec = new AVCodecContext();
     stream->codec->sample_fmt = AVSampleFormat::AV_SAMPLE_FMT_U8P;
@@ -561,7 +563,6 @@ TEST_F(CAVOutputStreamTest, writeMicToMixAudioFrame)
     AVFrame *inputFrame = new AVFrame();
     inputFrame->nb_samples = 48000;
 
-    stub.set(av_samples_alloc, av_samples_alloc_stub);
     stub.set(swr_convert, swr_convert_stub);
     stub.set(ADDR(CAVOutputStream, audioWrite), audioWrite_stub);
     stub.set(av_rescale_q, av_rescale_q_stub);
@@ -570,8 +571,14 @@ TEST_F(CAVOutputStreamTest, writeMicToMixAudioFrame)
 
     //正式执行需测试的方法
     m_avOutputStream->writeMicToMixAudioFrame(stream, inputFrame, 1111);
+    //swr_convert 桩函数返回转换出 1 个样本
+    EXPECT_EQ(1, access_private_field::CAVOutputStreamm_micMixFifo(*m_avOutputStream).size());
+    const uint64_t allocCount = m_avOutputStream->audioMixAllocCount();
+    m_avOutputStream->writeMicToMixAudioFrame(stream, inputFrame, 1111);
+    EXPECT_EQ(2, access_private_field::CAVOutputStreamm_micMixFifo(*m_avOutputStream).size());
+    //重采样上下文和输出缓冲区第二帧起复用
+    EXPECT_EQ(allocCount, m_avOutputStream->audioMixAllocCount());
 
-    stub.reset(av_samples_alloc);
     stub.reset(swr_convert);
     stub.reset(ADDR(CAVOutputStream, audioWrite));
     stub.reset(av_rescale_q);
@@ -581,9 +588,13 @@ TEST_F(CAVOutputStreamTest, writeMicToMixAudioFrame)
     delete inputFrame;
     delete stream->codec;
     delete stream;
+    delete access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream);
     delete access_private_field::CAVOutputStreamm_pMicCodecContext(*m_avOutputStream);
     delete access_private_field::CAVOutputStreamm_micAudioStream(*m_avOutputStream);
     swr_free(&access_private_field::CAVOutputStreamm_pMicAudioSwrContext(*m_avOutputStream));
+    av_freep(&access_private_field::CAVOutputStreamm_convertedMicSamples(*m_avOutputStream)[0]);
+    free(access_private_field::CAVOutputStreamm_convertedMicSamples(*m_avOutputStream));
+    access_private_field::CAVOutputStreamm_convertedMicSamples(*m_avOutputStream) = nullptr;
 }
 
 
@@ -645,6 +656,13 @@ TEST_F(CAVOutputStreamTest, writeSysToMixAudioFrame)
     access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream)->channel_layout = 2;
     access_private_field::CAVOutputStreamm_pSysAudioSwrContext(*m_avOutputStream) = nullptr;
     access_private_field::CAVOutputStreamm_sysAudioFifo(*m_avOutputStream) = nullptr;
+    //混音路径重采样为混音编码器的格式
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream) = new AVCodecContext();
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->frame_size = 1152;
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->channels = 2;
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->sample_fmt = AVSampleFormat::AV_SAMPLE_FMT_U8P;
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->sample_rate = 48000;
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->channel_layout = AV_CH_LAYOUT_STEREO;
     AVStream *stream = new AVStream();
     stream->codec = new AVCodecContext();
     stream->codec->sample_fmt = AVSampleFormat::AV_SAMPLE_FMT_U8P;
@@ -653,7 +671,6 @@ TEST_F(CAVOutputStreamTest, writeSysToMixAudioFrame)
     AVFrame *inputFrame = new AVFrame();
     inputFrame->nb_samples = 48000;
 
-    stub.set(av_samples_alloc, av_samples_alloc_stub);
     stub.set(swr_convert, swr_convert_stub);
     stub.set(ADDR(CAVOutputStream, audioWrite), audioWrite_stub);
     stub.set(av_rescale_q, av_rescale_q_stub);
@@ -662,8 +679,14 @@ TEST_F(CAVOutputStreamTest, writeSysToMixAudioFrame)
 
     //正式执行需测试的方法
     m_avOutputStream->writeSysToMixAudioFrame(stream, inputFrame, 1111);
+    //swr_convert 桩函数返回转换出 1 个样本
+    EXPECT_EQ(1, access_private_field::CAVOutputStreamm_sysMixFifo(*m_avOutputStream).size());
+    const uint64_t allocCount = m_avOutputStream->audioMixAllocCount();
+    m_avOutputStream->writeSysToMixAudioFrame(stream, inputFrame, 1111);
+    EXPECT_EQ(2, access_private_field::CAVOutputStreamm_sysMixFifo(*m_avOutputStream).size());
+    //重采样上下文和输出缓冲区第二帧起复用
+    EXPECT_EQ(allocCount, m_avOutputStream->audioMixAllocCount());
 
-    stub.reset(av_samples_alloc);
     stub.reset(swr_convert);
     stub.reset(ADDR(CAVOutputStream, audioWrite));
     stub.reset(av_rescale_q);
@@ -673,9 +696,13 @@ TEST_F(CAVOutputStreamTest, writeSysToMixAudioFrame)
     delete inputFrame;
     delete stream->codec;
     delete stream;
+    delete access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream);
     delete access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream);
     delete access_private_field::CAVOutputStreamm_sysAudioStream(*m_avOutputStream);
     swr_free(&access_private_field::CAVOutputStreamm_pSysAudioSwrContext(*m_avOutputStream));
+    av_freep(&access_private_field::CAVOutputStreamm_convertedSysSamples(*m_avOutputStream)[0]);
+    free(access_private_field::CAVOutputStreamm_convertedSysSamples(*m_avOutputStream));
+    access_private_field::CAVOutputStreamm_convertedSysSamples(*m_avOutputStream) = nullptr;
 }
 
 TEST_F(CAVOutputStreamTest, write_filter_audio_frame)
@@ -704,50 +731,6 @@ TEST_F(CAVOutputStreamTest, write_filter_audio_frame)
 }
 
 
-TEST_F(CAVOutputStreamTest, init_filters)
-{
-    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream) = new AVCodecContext();
-    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->sample_fmt = AVSampleFormat::AV_SAMPLE_FMT_S16;
-    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->channel_layout = 2;
-    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->sample_rate = 48000;
-    access_private_field::CAVOutputStreamm_pMicCodecContext(*m_avOutputStream) = new AVCodecContext();
-    access_private_field::CAVOutputStreamm_pMicCodecContext(*m_avOutputStream)->channel_layout = 2;
-    access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream) = new AVCodecContext();
-    access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream)->sample_fmt = AVSampleFormat::AV_SAMPLE_FMT_S16;
-    access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream)->channel_layout = 2;
-    AVFilterContext *filtdd = new AVFilterContext();
-    AVFilterLink *filterLink = new AVFilterLink();
-    AVFilterLink **filterLinks = nullptr;
-    filterLinks = &filterLink;
-    filtdd->inputs = filterLinks;
-    access_private_field::CAVOutputStreambuffersink_ctx(*m_avOutputStream) = filtdd;
-
-    stub.set(avfilter_graph_create_filter, avfilter_graph_create_filter_stub);
-    stub.set(av_opt_set_bin, av_opt_set_bin_stub);
-    stub.set(avfilter_graph_parse_ptr, avfilter_graph_parse_ptr_stub);
-    stub.set(avfilter_graph_config, avfilter_graph_config_stub);
-    stub.set(av_get_channel_layout_string, av_get_channel_layout_string_stub);
-
-    //正式执行需测试的方法
-    m_avOutputStream->init_filters();
-
-    stub.reset(avfilter_graph_create_filter);
-    stub.reset(avcodec_encode_audio2);
-    stub.reset(avfilter_graph_parse_ptr);
-    stub.reset(avfilter_graph_config);
-    stub.reset(av_get_channel_layout_string);
-
-    delete filterLink;
-    delete filtdd;
-    avfilter_graph_free(&access_private_field::CAVOutputStreamfilter_graph(*m_avOutputStream));
-    av_frame_free(&access_private_field::CAVOutputStreammMic_frame(*m_avOutputStream));
-    av_frame_free(&access_private_field::CAVOutputStreammSpeaker_frame(*m_avOutputStream));
-    delete access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream);
-    delete access_private_field::CAVOutputStreamm_pMicCodecContext(*m_avOutputStream);
-    delete access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream);
-
-}
-
 TEST_F(CAVOutputStreamTest, init_context_amix)
 {
     //access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream) = new AVCodecContext();
@@ -795,72 +778,70 @@ int writeFrame_stub(AVFormatContext *s, AVPacket *pkt)
 {
     return 1;
 }
-int audioFifoSize_stub1(AVAudioFifo *af)
-{
-    g_first2++;
-    if (g_first2 == 1 || g_first2 == 2) {
-        return 1153;
-    }
-    g_first2 = 0;
-    return 1;
-
-}
 
 
 TEST_F(CAVOutputStreamTest, writeMixAudio)
 {
     access_private_field::CAVOutputStreamis_fifo_scardinit(*m_avOutputStream) = 1152;
-    access_private_field::CAVOutputStreamm_sysAudioFifo(*m_avOutputStream) = av_audio_fifo_alloc(AVSampleFormat::AV_SAMPLE_FMT_S16, 2, 20 * 1152);
-    access_private_field::CAVOutputStreamm_micAudioFifo(*m_avOutputStream) = av_audio_fifo_alloc(AVSampleFormat::AV_SAMPLE_FMT_S16, 2, 20 * 1152);
+    //U8P 双声道，两个平面，每个样本 1 字节，预先写入两帧数据
+    AudioSampleFifo &micFifo = access_private_field::CAVOutputStreamm_micMixFifo(*m_avOutputStream);
+    AudioSampleFifo &sysFifo = access_private_field::CAVOutputStreamm_sysMixFifo(*m_avOutputStream);
+    ASSERT_TRUE(micFifo.init(2, 1, 20 * 1152));
+    ASSERT_TRUE(sysFifo.init(2, 1, 20 * 1152));
+    std::vector<uint8_t> samples(2 * 1152, 0x80);
+    const uint8_t *planes[2] = {samples.data(), samples.data()};
+    micFifo.write(planes, 2 * 1152);
+    sysFifo.write(planes, 2 * 1152);
 
     access_private_field::CAVOutputStreamm_pMicCodecContext(*m_avOutputStream) = new AVCodecContext();
     access_private_field::CAVOutputStreamm_pMicCodecContext(*m_avOutputStream)->frame_size = 1152;
     access_private_field::CAVOutputStreamm_pMicCodecContext(*m_avOutputStream)->channels = 2;
     access_private_field::CAVOutputStreamm_pMicCodecContext(*m_avOutputStream)->sample_fmt = AVSampleFormat::AV_SAMPLE_FMT_U8P;
     access_private_field::CAVOutputStreamm_pMicCodecContext(*m_avOutputStream)->sample_rate = 48000;
-    access_private_field::CAVOutputStreamm_pMicCodecContext(*m_avOutputStream)->channel_layout = 2;
+    access_private_field::CAVOutputStreamm_pMicCodecContext(*m_avOutputStream)->channel_layout = AV_CH_LAYOUT_STEREO;
 
     access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream) = new AVCodecContext();
     access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream)->frame_size = 1152;
     access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream)->channels = 2;
     access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream)->sample_fmt = AVSampleFormat::AV_SAMPLE_FMT_U8P;
     access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream)->sample_rate = 48000;
-    access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream)->channel_layout = 2;
-
-    access_private_field::CAVOutputStreamm_start_mix_time(*m_avOutputStream) = -1;
-    access_private_field::CAVOutputStreamm_nLastAudioMixPresentationTime(*m_avOutputStream) = 1;
+    access_private_field::CAVOutputStreamm_pSysCodecContext(*m_avOutputStream)->channel_layout = AV_CH_LAYOUT_STEREO;
 
     access_private_field::CAVOutputStreamaudio_amix_st(*m_avOutputStream) = new AVStream();
 
     access_private_field::CAVOutputStreamaudio_amix_st(*m_avOutputStream)->codec = new AVCodecContext();
     access_private_field::CAVOutputStreamaudio_amix_st(*m_avOutputStream)->codec->sample_rate = 48000;
 
+    //两路缓冲区已是混音编码器的格式
     access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream) = new AVCodecContext();
-    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->sample_fmt = AVSampleFormat::AV_SAMPLE_FMT_S16;
-    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->channel_layout = 2;
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->sample_fmt = AVSampleFormat::AV_SAMPLE_FMT_U8P;
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->channels = 2;
+    access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->channel_layout = AV_CH_LAYOUT_STEREO;
     access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->sample_rate = 48000;
     access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream)->frame_size = 1152;
+    ASSERT_TRUE(m_avOutputStream->initAudioMixer());
 
-    stub.set(ADDR(CAVOutputStream, audioFifoSize), audioFifoSize_stub1);
-    stub.set(ADDR(CAVOutputStream, audioRead), audioRead_stub);
     stub.set(av_rescale_q, av_rescale_q_stub);
-    stub.set(av_buffersrc_add_frame_flags, av_buffersrc_add_frame_flags_stub);
     stub.set(ADDR(CAVOutputStream, isWriteFrame), isWriteFrame_stub1);
     stub.set(avcodec_encode_audio2, avcodec_encode_audio2_stub);
     stub.set(ADDR(CAVOutputStream, writeFrame), writeFrame_stub);
-    stub.set(av_buffersink_get_frame, av_buffersink_get_frame_stub);
 
     //正式执行需测试的方法
     m_avOutputStream->writeMixAudio();
+    EXPECT_EQ(1152, micFifo.size());
+    EXPECT_EQ(1152, sysFifo.size());
+    //第一次混音建立帧池，之后稳态混音不再申请内存
+    const uint64_t allocCount = m_avOutputStream->audioMixAllocCount();
+    EXPECT_GT(allocCount, 0u);
+    m_avOutputStream->writeMixAudio();
+    EXPECT_EQ(0, micFifo.size());
+    EXPECT_EQ(0, sysFifo.size());
+    EXPECT_EQ(allocCount, m_avOutputStream->audioMixAllocCount());
 
-    stub.reset(ADDR(CAVOutputStream, audioFifoSize));
-    stub.reset(ADDR(CAVOutputStream, audioRead));
     stub.reset(av_rescale_q);
-    stub.reset(av_buffersrc_add_frame_flags);
     stub.reset(ADDR(CAVOutputStream, isWriteFrame));
     stub.reset(avcodec_encode_audio2);
     stub.reset(ADDR(CAVOutputStream, writeFrame));
-    stub.reset(av_buffersink_get_frame);
 
     delete access_private_field::CAVOutputStreampCodecCtx_amix(*m_avOutputStream);
     delete access_private_field::CAVOutputStreamaudio_amix_st(*m_avOutputStream)->codec;
@@ -0,0 +1,521 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../../src/waylandrecord/avoutputstream.h"
+#include "../../src/waylandrecord/channellayouts.h"
+#include "../../src/utils/configsettings.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/dict.h>
+}
+
+using namespace testing;
+
+namespace {
+//applyVideoEncoderOptions 供 open 和基准测试内部使用，测试中通过子类调用
+class EncoderOptionsProbe : public CAVOutputStream
+{
+public:
+    using CAVOutputStream::applyVideoEncoderOptions;
+};
+
+QString dictValue(AVDictionary *dict, const char *key)
+{
+    AVDictionaryEntry *entry = av_dict_get(dict, key, nullptr, 0);
+    return entry ? QString::fromLatin1(entry->value) : QString();
+}
+
+//解码文件中第一路音频流第一个声道的样本，只支持 AAC 解码输出的平面浮点格式，失败返回空
+std::vector<float> decodeFirstChannel(const QString &path)
+{
+    std::vector<float> samples;
+    AVFormatContext *format = nullptr;
+    if (avformat_open_input(&format, path.toLocal8Bit().constData(), nullptr, nullptr) < 0) {
+        return samples;
+    }
+    int index = -1;
+    if (avformat_find_stream_info(format, nullptr) >= 0) {
+        index = av_find_best_stream(format, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    }
+    const AVCodec *codec = index < 0 ? nullptr : avcodec_find_decoder(format->streams[index]->codecpar->codec_id);
+    AVCodecContext *decoder = codec ? avcodec_alloc_context3(codec) : nullptr;
+    if (nullptr == decoder
+            || avcodec_parameters_to_context(decoder, format->streams[index]->codecpar) < 0
+            || avcodec_open2(decoder, codec, nullptr) < 0) {
+        avcodec_free_context(&decoder);
+        avformat_close_input(&format);
+        return samples;
+    }
+    AVPacket *packet = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
+    bool draining = false;
+    while (!draining) {
+        if (av_read_frame(format, packet) < 0) {
+            draining = true;
+            avcodec_send_packet(decoder, nullptr);
+        } else if (packet->stream_index == index) {
+            avcodec_send_packet(decoder, packet);
+        }
+        av_packet_unref(packet);
+        while (avcodec_receive_frame(decoder, frame) >= 0) {
+            if (frame->format == AV_SAMPLE_FMT_FLTP) {
+                const float *data = reinterpret_cast<const float *>(frame->data[0]);
+                samples.insert(samples.end(), data, data + frame->nb_samples);
+            }
+            av_frame_unref(frame);
+        }
+    }
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    avcodec_free_context(&decoder);
+    avformat_close_input(&format);
+    return samples;
+}
+
+//文件中第一路 type 流第一个包的开始时间和最后一个包的结束时间（秒），没有该类型的包时返回 false
+bool streamSpan(const QString &path, AVMediaType type, double &begin, double &end)
+{
+    AVFormatContext *format = nullptr;
+    if (avformat_open_input(&format, path.toLocal8Bit().constData(), nullptr, nullptr) < 0) {
+        return false;
+    }
+    const int index = avformat_find_stream_info(format, nullptr) < 0 ? -1 : av_find_best_stream(format, type, -1, -1, nullptr, 0);
+    bool found = false;
+    AVPacket *packet = av_packet_alloc();
+    while (index >= 0 && av_read_frame(format, packet) >= 0) {
+        if (packet->stream_index == index && packet->pts != AV_NOPTS_VALUE) {
+            const double timeBase = av_q2d(format->streams[index]->time_base);
+            const double packetBegin = packet->pts * timeBase;
+            const double packetEnd = (packet->pts + packet->duration) * timeBase;
+            begin = found ? std::min(begin, packetBegin) : packetBegin;
+            end = found ? std::max(end, packetEnd) : packetEnd;
+            found = true;
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+    avformat_close_input(&format);
+    return found;
+}
+
+//去掉编码器起始和结尾的过渡段后的均方根
+double steadyRms(const std::vector<float> &samples)
+{
+    const size_t margin = 4096;
+    if (samples.size() <= margin * 2) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (size_t i = margin; i < samples.size() - margin; i++) {
+        sum += static_cast<double>(samples[i]) * samples[i];
+    }
+    return std::sqrt(sum / static_cast<double>(samples.size() - margin * 2));
+}
+}
+
+/**
+ * 用本机的 FFmpeg 把合成的 RGB 画面编码成 H.264 文件，不经过 KWayland 采集；
+ * 没有 H.264 编码器时跳过
+ */
+class AVOutputStreamEncodeTest : public testing::Test
+{
+public:
+    static const int Width = 64;
+    static const int Height = 48;
+    static const int FrameRate = 25;
+    static const int SampleRate = 48000;
+    static const int AudioFrameSamples = 1024;
+
+    void SetUp() override
+    {
+        avlibInterface::initFunctions();
+        if (!avlibInterface::m_avcodec_find_encoder || !avlibInterface::m_avcodec_find_encoder(AV_CODEC_ID_H264)) {
+            GTEST_SKIP() << "H.264 encoder unavailable";
+        }
+        ASSERT_TRUE(m_dir.isValid());
+        m_rgb.assign(static_cast<size_t>(Width) * Height * 4, 0);
+    }
+
+    QString filePath(const QString &name) const
+    {
+        return m_dir.filePath(name);
+    }
+
+    bool openVideo(CAVOutputStream &output, const QString &path)
+    {
+        output.SetVideoCodecProp(AV_CODEC_ID_H264, FrameRate, 500000, 30, Width, Height);
+        CAVOutputStream::VideoEncoderOptions options;
+        options.preset = "ultrafast";
+        output.setVideoEncoderOptions(options);
+        return output.open(path);
+    }
+
+    //第 index 帧：逐帧平移的渐变画面，时间戳按帧率递增
+    int writeFrame(CAVOutputStream &output, int index, int64_t startUs)
+    {
+        for (int y = 0; y < Height; y++) {
+            for (int x = 0; x < Width; x++) {
+                unsigned char *pixel = m_rgb.data() + (static_cast<size_t>(y) * Width + x) * 4;
+                pixel[0] = static_cast<unsigned char>(x * 4 + index);
+                pixel[1] = static_cast<unsigned char>(y * 4 + index * 2);
+                pixel[2] = static_cast<unsigned char>(index * 8);
+                pixel[3] = 0xff;
+            }
+        }
+        WaylandFrame frame;
+        frame._time = startUs + static_cast<int64_t>(index) * 1000000 / FrameRate;
+        frame._index = index;
+        frame._width = Width;
+        frame._height = Height;
+        frame._stride = Width * 4;
+        frame._frame = m_rgb.data();
+        return output.writeVideoFrame(frame);
+    }
+
+    //麦克风和系统音频都录制时走混音路径，两路都编码为 AAC
+    bool openMixed(CAVOutputStream &output, const QString &path)
+    {
+        output.SetVideoCodecProp(AV_CODEC_ID_H264, FrameRate, 500000, 30, Width, Height);
+        output.SetAudioCodecProp(AV_CODEC_ID_AAC, SampleRate, 2, 0, 128000);
+        output.SetAudioCardCodecProp(AV_CODEC_ID_AAC, SampleRate, 2, 0, 128000);
+        return output.open(path);
+    }
+
+    //与 pulse 采集到的格式一致：48kHz 立体声 S16 交错
+    static AVCodecContext *createAudioInput()
+    {
+        AVCodecContext *input = avlibInterface::m_avcodec_alloc_context3(nullptr);
+        input->sample_fmt = AV_SAMPLE_FMT_S16;
+        input->sample_rate = SampleRate;
+        ChannelLayouts::set(input, AV_CH_LAYOUT_STEREO);
+        return input;
+    }
+
+    static AVFrame *createAudioFrame(AVCodecContext *input)
+    {
+        AVFrame *frame = avlibInterface::m_av_frame_alloc();
+        frame->nb_samples = AudioFrameSamples;
+        frame->format = input->sample_fmt;
+        frame->sample_rate = input->sample_rate;
+        if (!ChannelLayouts::copyToFrame(frame, input) || avlibInterface::m_av_frame_get_buffer(frame, 0) < 0) {
+            avlibInterface::m_av_frame_free(&frame);
+        }
+        return frame;
+    }
+
+    //第 index 帧的 1kHz 正弦波，amplitude 为 0 时静音
+    static void fillTone(AVFrame *frame, int index, double amplitude)
+    {
+        int16_t *samples = reinterpret_cast<int16_t *>(frame->data[0]);
+        for (int i = 0; i < frame->nb_samples; i++) {
+            const double t = static_cast<double>(index * frame->nb_samples + i) / SampleRate;
+            const int16_t value = static_cast<int16_t>(amplitude * 32767.0 * std::sin(2.0 * M_PI * 1000.0 * t));
+            samples[i * 2] = value;
+            samples[i * 2 + 1] = value;
+        }
+    }
+
+    //按采集时钟写入一帧麦克风和一帧系统音频，再混音编码一帧
+    static void writeMixedAudio(CAVOutputStream &output, AVCodecContext *input, AVFrame *mic, AVFrame *sys, int index, int64_t startUs)
+    {
+        const int64_t timeUs = startUs + static_cast<int64_t>(index) * AudioFrameSamples * 1000000 / SampleRate;
+        ASSERT_GE(output.writeMicToMixAudioFrame(input, mic, timeUs), 0);
+        ASSERT_GE(output.writeSysToMixAudioFrame(input, sys, timeUs), 0);
+        output.writeMixAudio();
+    }
+
+    QTemporaryDir m_dir;
+    std::vector<unsigned char> m_rgb;
+};
+
+TEST_F(AVOutputStreamEncodeTest, steadyStateVideoAllocations)
+{
+    CAVOutputStream output;
+    ASSERT_TRUE(openVideo(output, filePath("steady.mp4")));
+    const int64_t startUs = CaptureClock::nowUs();
+    for (int i = 0; i < 5; i++) {
+        ASSERT_EQ(0, writeFrame(output, i, startUs));
+    }
+    //包装帧和流水线的帧缓冲区在前几帧内建立，编码器释放引用后帧回到空闲队列，不再重新申请
+    const uint64_t warmedUp = output.videoFrameAllocCount();
+    EXPECT_GE(warmedUp, 1u);
+    for (int i = 5; i < 60; i++) {
+        ASSERT_EQ(0, writeFrame(output, i, startUs));
+    }
+    EXPECT_EQ(warmedUp, output.videoFrameAllocCount());
+    output.close();
+}
+
+TEST_F(AVOutputStreamEncodeTest, benchmarkReusesFrameBuffer)
+{
+    CAVOutputStream::VideoEncoderOptions options;
+    const QList<CAVOutputStream::EncoderBenchmarkResult> results =
+        CAVOutputStream::benchmarkVideoEncoder(Width, Height, 16, options, QStringList() << "ultrafast");
+    ASSERT_EQ(1, results.size());
+    EXPECT_EQ(16, results[0].frames);
+    //每帧送入后都取完了输出，测试画面不会因仍被编码器引用而复制
+    EXPECT_EQ(0u, results[0].bufferAllocs);
+}
+
+TEST_F(AVOutputStreamEncodeTest, encoderOptionsFromSettings)
+{
+    ConfigSettings *settings = ConfigSettings::instance();
+    const QStringList keys = QStringList() << "encoder_preset" << "encoder_tune" << "encoder_crf"
+                                           << "encoder_threads" << "encoder_thread_type";
+    QVariantList saved;
+    for (const QString &key : keys) {
+        saved << settings->getValue("recorder", key);
+    }
+    settings->setValue("recorder", "encoder_preset", "veryfast");
+    settings->setValue("recorder", "encoder_tune", "zerolatency");
+    settings->setValue("recorder", "encoder_crf", 23);
+    settings->setValue("recorder", "encoder_threads", 2);
+    settings->setValue("recorder", "encoder_thread_type", "slice");
+    const CAVOutputStream::VideoEncoderOptions options = CAVOutputStream::videoEncoderOptionsFromSettings(settings);
+    for (int i = 0; i < keys.size(); i++) {
+        settings->setValue("recorder", keys[i], saved[i]);
+    }
+    EXPECT_EQ(QString("veryfast"), options.preset);
+    EXPECT_EQ(QString("zerolatency"), options.tune);
+    EXPECT_EQ(23, options.crf);
+    EXPECT_EQ(2, options.threads);
+    EXPECT_TRUE(options.sliceThreads);
+}
+
+TEST_F(AVOutputStreamEncodeTest, applyVideoEncoderOptions)
+{
+    AVCodecContext *codecCtx = avlibInterface::m_avcodec_alloc_context3(avlibInterface::m_avcodec_find_encoder(AV_CODEC_ID_H264));
+    ASSERT_NE(nullptr, codecCtx);
+    CAVOutputStream::VideoEncoderOptions options;
+    options.preset = "veryfast";
+    options.tune = "zerolatency";
+    options.crf = 23;
+    options.threads = 2;
+    options.sliceThreads = true;
+    AVDictionary *param = nullptr;
+    EncoderOptionsProbe::applyVideoEncoderOptions(codecCtx, &param, options);
+    EXPECT_EQ(2, codecCtx->thread_count);
+    EXPECT_EQ(FF_THREAD_SLICE, codecCtx->thread_type);
+    EXPECT_EQ(QString("veryfast"), dictValue(param, "preset"));
+    EXPECT_EQ(QString("zerolatency"), dictValue(param, "tune"));
+    EXPECT_EQ(QString("23"), dictValue(param, "crf"));
+    avlibInterface::m_av_dict_free(&param);
+
+    //未设置的 tune 和 crf 不写入选项，默认使用帧线程
+    CAVOutputStream::VideoEncoderOptions defaults;
+    EncoderOptionsProbe::applyVideoEncoderOptions(codecCtx, &param, defaults);
+    EXPECT_EQ(0, codecCtx->thread_count);
+    EXPECT_EQ(FF_THREAD_FRAME, codecCtx->thread_type);
+    EXPECT_EQ(QString("ultrafast"), dictValue(param, "preset"));
+    EXPECT_TRUE(dictValue(param, "tune").isEmpty());
+    EXPECT_TRUE(dictValue(param, "crf").isEmpty());
+    avlibInterface::m_av_dict_free(&param);
+    avlibInterface::m_avcodec_free_context(&codecCtx);
+}
+
+TEST_F(AVOutputStreamEncodeTest, openWithEncoderOptions)
+{
+    CAVOutputStream output;
+    CAVOutputStream::VideoEncoderOptions options;
+    options.preset = "veryslower";
+    options.tune = "zerolatency";
+    options.crf = 80;
+    options.threads = -1;
+    options.sliceThreads = true;
+    output.setVideoEncoderOptions(options);
+    //无效的取值回退到默认值
+    EXPECT_EQ(QString("ultrafast"), output.videoEncoderOptions().preset);
+    EXPECT_EQ(51, output.videoEncoderOptions().crf);
+    EXPECT_EQ(0, output.videoEncoderOptions().threads);
+
+    output.SetVideoCodecProp(AV_CODEC_ID_H264, FrameRate, 500000, 30, Width, Height);
+    ASSERT_TRUE(output.open(filePath("options.mp4")));
+    const int64_t startUs = CaptureClock::nowUs();
+    for (int i = 0; i < 10; i++) {
+        ASSERT_EQ(0, writeFrame(output, i, startUs));
+    }
+    output.close();
+}
+
+TEST_F(AVOutputStreamEncodeTest, steadyStateMixAllocations)
+{
+    CAVOutputStream output;
+    ASSERT_TRUE(openMixed(output, filePath("mix.mp4")));
+    AVCodecContext *input = createAudioInput();
+    AVFrame *mic = createAudioFrame(input);
+    AVFrame *sys = createAudioFrame(input);
+    ASSERT_NE(nullptr, mic);
+    ASSERT_NE(nullptr, sys);
+    const int64_t startUs = CaptureClock::nowUs();
+    for (int i = 0; i < 8; i++) {
+        fillTone(mic, i, 0.3);
+        fillTone(sys, i, 0.2);
+        writeMixedAudio(output, input, mic, sys, i, startUs);
+    }
+    //重采样上下文、缓冲区和帧池在前几帧内建立，之后混音不再申请
+    const uint64_t warmedUp = output.audioMixAllocCount();
+    EXPECT_GE(warmedUp, 1u);
+    for (int i = 8; i < 200; i++) {
+        fillTone(mic, i, 0.3);
+        fillTone(sys, i, 0.2);
+        writeMixedAudio(output, input, mic, sys, i, startUs);
+    }
+    EXPECT_EQ(warmedUp, output.audioMixAllocCount());
+    output.close();
+    avlibInterface::m_av_frame_free(&mic);
+    avlibInterface::m_av_frame_free(&sys);
+    avlibInterface::m_avcodec_free_context(&input);
+}
+
+TEST_F(AVOutputStreamEncodeTest, mixedAudioLevelInFile)
+{
+    //默认增益各 0.5：只有麦克风有声音时，混音后幅度减半
+    CAVOutputStream halved;
+    ASSERT_TRUE(openMixed(halved, filePath("halved.mp4")));
+    //两路增益都为 1 时幅度相加
+    CAVOutputStream summed;
+    summed.setAudioMixGains(1.0f, 1.0f);
+    ASSERT_TRUE(openMixed(summed, filePath("summed.mp4")));
+    AVCodecContext *input = createAudioInput();
+    AVFrame *mic = createAudioFrame(input);
+    AVFrame *sys = createAudioFrame(input);
+    ASSERT_NE(nullptr, mic);
+    ASSERT_NE(nullptr, sys);
+    const int64_t startUs = CaptureClock::nowUs();
+    for (int i = 0; i < 100; i++) {
+        fillTone(mic, i, 0.4);
+        fillTone(sys, i, 0.0);
+        writeMixedAudio(halved, input, mic, sys, i, startUs);
+        fillTone(mic, i, 0.2);
+        fillTone(sys, i, 0.2);
+        writeMixedAudio(summed, input, mic, sys, i, startUs);
+    }
+    halved.close();
+    summed.close();
+    avlibInterface::m_av_frame_free(&mic);
+    avlibInterface::m_av_frame_free(&sys);
+    avlibInterface::m_avcodec_free_context(&input);
+
+    //正弦波的均方根为幅度除以根号 2，AAC 有损编码留 10% 的余量
+    const double expected = 0.2 / std::sqrt(2.0);
+    EXPECT_NEAR(expected, steadyRms(decodeFirstChannel(filePath("halved.mp4"))), expected * 0.1);
+    const double summedExpected = 0.4 / std::sqrt(2.0);
+    EXPECT_NEAR(summedExpected, steadyRms(decodeFirstChannel(filePath("summed.mp4"))), summedExpected * 0.1);
+}
+
+TEST_F(AVOutputStreamEncodeTest, videoAndAudioShareCaptureClock)
+{
+    CAVOutputStream output;
+    ASSERT_TRUE(openMixed(output, filePath("clock.mp4")));
+    AVCodecContext *input = createAudioInput();
+    AVFrame *mic = createAudioFrame(input);
+    AVFrame *sys = createAudioFrame(input);
+    ASSERT_NE(nullptr, mic);
+    ASSERT_NE(nullptr, sys);
+    //视频帧和音频包都用同一个采集时钟打时间戳：视频从起点开始，音频晚 400ms 才采集到第一批样本
+    const int64_t originUs = output.captureClock().originUs();
+    const int64_t audioDelayUs = 400000;
+    const int videoFrames = 4 * FrameRate;
+    int audioFrames = 0;
+    for (int i = 0; i < videoFrames; i++) {
+        const int64_t frameUs = originUs + static_cast<int64_t>(i) * 1000000 / FrameRate;
+        //写入这一帧之前已经读到的音频，读到时这批样本的最后一个刚采集完
+        for (;;) {
+            const int64_t readUs = originUs + audioDelayUs + static_cast<int64_t>(audioFrames + 1) * AudioFrameSamples * 1000000 / SampleRate;
+            if (readUs > frameUs) {
+                break;
+            }
+            fillTone(mic, audioFrames, 0.3);
+            fillTone(sys, audioFrames, 0.2);
+            writeMixedAudio(output, input, mic, sys, audioFrames, originUs + audioDelayUs + static_cast<int64_t>(AudioFrameSamples) * 1000000 / SampleRate);
+            audioFrames++;
+        }
+        ASSERT_EQ(0, writeFrame(output, i, originUs));
+    }
+    output.close();
+    avlibInterface::m_av_frame_free(&mic);
+    avlibInterface::m_av_frame_free(&sys);
+    avlibInterface::m_avcodec_free_context(&input);
+
+    double videoBegin = 0.0;
+    double videoEnd = 0.0;
+    double audioBegin = 0.0;
+    double audioEnd = 0.0;
+    ASSERT_TRUE(streamSpan(filePath("clock.mp4"), AVMEDIA_TYPE_VIDEO, videoBegin, videoEnd));
+    ASSERT_TRUE(streamSpan(filePath("clock.mp4"), AVMEDIA_TYPE_AUDIO, audioBegin, audioEnd));
+    //音频起点比视频晚采集延迟，两路在同一时刻结束；允许两个音频帧（AAC 编码延迟）的误差
+    const double tolerance = 2.0 * AudioFrameSamples / SampleRate;
+    EXPECT_NEAR(0.0, videoBegin, 1.0 / FrameRate);
+    EXPECT_NEAR(audioDelayUs / 1000000.0, audioBegin - videoBegin, tolerance);
+    EXPECT_NEAR(videoEnd, audioEnd, tolerance + 1.0 / FrameRate);
+    //时间戳完全按标称采样率给出，不应触发漂移修正
+    EXPECT_EQ(0u, output.micDriftMonitor().insertedSamples() + output.micDriftMonitor().droppedSamples());
+    EXPECT_EQ(0u, output.sysDriftMonitor().insertedSamples() + output.sysDriftMonitor().droppedSamples());
+}
+
+TEST_F(AVOutputStreamEncodeTest, killedRecordingStillDemuxes)
+{
+    const QString path = filePath("killed.mp4");
+    //子进程录制到一半被 SIGKILL 杀死，不调用 close()，文件没有写文件尾
+    const pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (0 == pid) {
+        CAVOutputStream output;
+        output.setFragmentDuration(1);
+        if (!openMixed(output, path)) {
+            _exit(1);
+        }
+        AVCodecContext *input = createAudioInput();
+        AVFrame *mic = createAudioFrame(input);
+        AVFrame *sys = createAudioFrame(input);
+        if (nullptr == mic || nullptr == sys) {
+            _exit(1);
+        }
+        const int64_t originUs = output.captureClock().originUs();
+        int audioFrames = 0;
+        for (int i = 0; i < 4 * FrameRate; i++) {
+            const int64_t frameUs = originUs + static_cast<int64_t>(i) * 1000000 / FrameRate;
+            while (static_cast<int64_t>(audioFrames + 1) * AudioFrameSamples * 1000000 / SampleRate <= frameUs - originUs) {
+                fillTone(mic, audioFrames, 0.3);
+                fillTone(sys, audioFrames, 0.2);
+                writeMixedAudio(output, input, mic, sys, audioFrames, originUs + static_cast<int64_t>(AudioFrameSamples) * 1000000 / SampleRate);
+                audioFrames++;
+            }
+            if (0 != writeFrame(output, i, originUs)) {
+                _exit(1);
+            }
+        }
+        //视频流水线在另一个线程编码，给它时间处理已提交的帧，但编码器仍未冲刷
+        usleep(200000);
+        kill(getpid(), SIGKILL);
+        _exit(1);
+    }
+    int status = 0;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFSIGNALED(status));
+    EXPECT_EQ(SIGKILL, WTERMSIG(status));
+
+    //已写完的分段自带索引，没有文件尾也能解封装；GOP 为 30 帧，1 秒后的关键帧处已切出至少一个分段
+    double videoBegin = 0.0;
+    double videoEnd = 0.0;
+    double audioBegin = 0.0;
+    double audioEnd = 0.0;
+    ASSERT_TRUE(streamSpan(path, AVMEDIA_TYPE_VIDEO, videoBegin, videoEnd));
+    ASSERT_TRUE(streamSpan(path, AVMEDIA_TYPE_AUDIO, audioBegin, audioEnd));
+    EXPECT_NEAR(0.0, videoBegin, 1.0 / FrameRate);
+    EXPECT_GE(videoEnd, 1.0);
+    EXPECT_GT(audioEnd, audioBegin);
+}
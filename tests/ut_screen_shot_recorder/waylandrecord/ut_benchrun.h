@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <cstring>
+#include <vector>
+
+#include "../../bench_wayland_record/benchrun.h"
+#include "../../bench_wayland_record/syntheticframes.h"
+#include "../../src/waylandrecord/avlibinterface.h"
+#include "../../src/utils/recordingstats.h"
+
+using namespace testing;
+
+/**
+ * 录制基准测试的 ffmpeg 后端：合成画面经 FrameRing 和写帧线程编码成文件，
+ * 与 bench_wayland_record 使用同一份 benchrun.cpp；没有 H.264 编码器时跳过
+ */
+class BenchRunTest : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        avlibInterface::initFunctions();
+        if (!avlibInterface::m_avcodec_find_encoder || !avlibInterface::m_avcodec_find_encoder(AV_CODEC_ID_H264)) {
+            GTEST_SKIP() << "H.264 encoder unavailable";
+        }
+        ASSERT_TRUE(m_dir.isValid());
+        RecordingStats::instance()->reset();
+    }
+
+    BenchOptions options(const QString &format) const
+    {
+        BenchOptions options;
+        options.backend = "ffmpeg";
+        options.format = format;
+        options.width = 160;
+        options.height = 120;
+        options.fps = 25;
+        options.seconds = 1;
+        options.output = m_dir.filePath("bench." + format);
+        return options;
+    }
+
+    QTemporaryDir m_dir;
+};
+
+TEST_F(BenchRunTest, ffmpegWritesEveryFrame)
+{
+    for (const QString &format : {QString("mp4"), QString("mkv")}) {
+        const BenchOptions bench = options(format);
+        SyntheticFrames frames(SyntheticFrames::ScrollingText, bench.width, bench.height);
+        BenchResult result;
+        ASSERT_TRUE(BenchRun::runFFmpeg(bench, frames, result)) << format.toStdString();
+        //160x120 的画面编码远快于 25fps，环形缓冲区不会丢帧
+        EXPECT_EQ(static_cast<uint64_t>(bench.fps * bench.seconds), result.generated) << format.toStdString();
+        EXPECT_EQ(result.generated, result.written) << format.toStdString();
+        EXPECT_EQ(0u, RecordingStats::instance()->counter(RecordingStats::RingDropped)) << format.toStdString();
+        EXPECT_GT(result.elapsedNs, 0) << format.toStdString();
+        EXPECT_GT(QFileInfo(bench.output).size(), 0) << format.toStdString();
+    }
+}
+
+TEST_F(BenchRunTest, syntheticFramesAreDeterministic)
+{
+    SyntheticFrames first(SyntheticFrames::Noise, 64, 48);
+    SyntheticFrames second(SyntheticFrames::Noise, 64, 48);
+    const size_t bytes = static_cast<size_t>(first.stride()) * first.height();
+    const unsigned char *data = first.frame(3);
+    std::vector<unsigned char> frame(data, data + bytes);
+    EXPECT_EQ(0, std::memcmp(frame.data(), second.frame(3), bytes));
+    //噪声画面每帧都不同
+    EXPECT_NE(0, std::memcmp(frame.data(), second.frame(4), bytes));
+}
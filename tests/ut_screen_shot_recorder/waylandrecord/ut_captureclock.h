@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+
+#include "../../src/waylandrecord/captureclock.h"
+
+using namespace testing;
+
+TEST(CaptureClockTest, streamTime)
+{
+    CaptureClock clock;
+    EXPECT_FALSE(clock.isStarted());
+    EXPECT_EQ(0, clock.streamTimeUs(CaptureClock::nowUs()));
+
+    const int64_t before = CaptureClock::nowUs();
+    clock.start();
+    EXPECT_TRUE(clock.isStarted());
+    EXPECT_GE(clock.originUs(), before);
+    EXPECT_LE(clock.originUs(), CaptureClock::nowUs());
+    //早于起点的帧（例如输出流打开前已进入环形缓冲区的帧）按 0 处理
+    EXPECT_EQ(0, clock.streamTimeUs(clock.originUs() - 1000));
+    EXPECT_EQ(40000, clock.streamTimeUs(clock.originUs() + 40000));
+
+    clock.reset();
+    EXPECT_FALSE(clock.isStarted());
+}
@@ -0,0 +1,245 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+#include "../../src/waylandrecord/egldmabufreader.h"
+#include "../../src/utils/dmabufmapcache.h"
+
+using namespace testing;
+
+/**
+ * 使用 Mesa 的 surfaceless 平台（无显示设备时为 llvmpipe 软件渲染）创建上下文，
+ * 平台不可用时跳过
+ */
+class EglDmaBufReaderTest : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (!clientExtensions || !strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+            GTEST_SKIP() << "EGL surfaceless platform unavailable";
+        }
+        m_display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        EGLint major = 0;
+        EGLint minor = 0;
+        if (m_display == EGL_NO_DISPLAY || !eglInitialize(m_display, &major, &minor) || !eglBindAPI(EGL_OPENGL_API)) {
+            GTEST_SKIP() << "EGL initialization failed";
+        }
+        m_context = eglCreateContext(m_display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, nullptr);
+        if (m_context == EGL_NO_CONTEXT || !eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_context)) {
+            GTEST_SKIP() << "EGL context unavailable";
+        }
+    }
+
+    void TearDown() override
+    {
+        if (m_context != EGL_NO_CONTEXT) {
+            eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(m_display, m_context);
+        }
+        if (m_display != EGL_NO_DISPLAY) {
+            eglTerminate(m_display);
+        }
+    }
+
+    //创建 width x height 的纹理及以它为颜色附件的 FBO，内容为 color
+    GLuint createTarget(int width, int height, uint32_t color, GLuint &texture)
+    {
+        glGenTextures(1, &texture);
+        fill(texture, width, height, color);
+        GLuint fbo = 0;
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return fbo;
+    }
+
+    static void fill(GLuint texture, int width, int height, uint32_t color)
+    {
+        std::vector<uint32_t> pixels(static_cast<size_t>(width) * height, color);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    static uint32_t pixel(const std::vector<unsigned char> &frame, size_t index)
+    {
+        uint32_t value = 0;
+        memcpy(&value, frame.data() + index * 4, 4);
+        return value;
+    }
+
+    EGLDisplay m_display = EGL_NO_DISPLAY;
+    EGLContext m_context = EGL_NO_CONTEXT;
+};
+
+TEST_F(EglDmaBufReaderTest, invalidArguments)
+{
+    std::vector<unsigned char> frame(16);
+    EglDmaBufReader reader;
+    EXPECT_FALSE(reader.isValid());
+    EXPECT_FALSE(reader.readFramebuffer(0, 1, 2, 2, frame.data()));
+
+    reader.setContext(m_display, m_context);
+    EXPECT_TRUE(reader.isValid());
+    EXPECT_FALSE(reader.read(0, -1, 2, 2, 8, 0, frame.data()));
+    EXPECT_FALSE(reader.readFramebuffer(0, 0, 2, 2, frame.data()));
+    EXPECT_FALSE(reader.readFramebuffer(0, 1, 2, 2, nullptr));
+}
+
+TEST_F(EglDmaBufReaderTest, doubleBufferedReadback)
+{
+    const int width = 8;
+    const int height = 4;
+    GLuint texture = 0;
+    GLuint fbo = createTarget(width, height, 0xff0000ffu, texture);
+    std::vector<unsigned char> frame(static_cast<size_t>(width) * height * 4);
+
+    EglDmaBufReader reader;
+    reader.setContext(m_display, m_context);
+    //第一帧同步读回
+    ASSERT_TRUE(reader.readFramebuffer(0, fbo, width, height, frame.data()));
+    EXPECT_EQ(0xff0000ffu, pixel(frame, 0));
+    EXPECT_EQ(0xff0000ffu, pixel(frame, width * height - 1));
+
+    //之后输出上一次读入的画面，比输入晚一帧
+    fill(texture, width, height, 0xff00ff00u);
+    ASSERT_TRUE(reader.readFramebuffer(0, fbo, width, height, frame.data()));
+    EXPECT_EQ(0xff0000ffu, pixel(frame, 0));
+    fill(texture, width, height, 0xffff0000u);
+    ASSERT_TRUE(reader.readFramebuffer(0, fbo, width, height, frame.data()));
+    EXPECT_EQ(0xff00ff00u, pixel(frame, 0));
+    ASSERT_TRUE(reader.readFramebuffer(0, fbo, width, height, frame.data()));
+    EXPECT_EQ(0xffff0000u, pixel(frame, width * height - 1));
+
+    //每路画面各自缓冲
+    ASSERT_TRUE(reader.readFramebuffer(1, fbo, width, height, frame.data()));
+    EXPECT_EQ(0xffff0000u, pixel(frame, 0));
+
+    reader.release();
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &texture);
+}
+
+TEST_F(EglDmaBufReaderTest, pixelsKeepCaptureTime)
+{
+    const int width = 4;
+    const int height = 4;
+    GLuint texture = 0;
+    GLuint fbo = createTarget(width, height, 0xff0000ffu, texture);
+    std::vector<unsigned char> frame(static_cast<size_t>(width) * height * 4);
+    int64_t pixelsUs = -1;
+
+    EglDmaBufReader reader;
+    reader.setContext(m_display, m_context);
+    //还没有读取过的画面来源没有可取出的画面
+    EXPECT_FALSE(reader.flush(0, frame.data(), &pixelsUs));
+
+    //第一帧同步读回，时间戳就是本帧的采集时间
+    ASSERT_TRUE(reader.readFramebuffer(0, fbo, width, height, frame.data(), 1000, &pixelsUs));
+    EXPECT_EQ(1000, pixelsUs);
+    //之后输出的画面带着它读入时的采集时间，而不是本次读取的时间
+    fill(texture, width, height, 0xff00ff00u);
+    ASSERT_TRUE(reader.readFramebuffer(0, fbo, width, height, frame.data(), 2000, &pixelsUs));
+    EXPECT_EQ(0xff0000ffu, pixel(frame, 0));
+    EXPECT_EQ(1000, pixelsUs);
+    fill(texture, width, height, 0xffff0000u);
+    ASSERT_TRUE(reader.readFramebuffer(0, fbo, width, height, frame.data(), 3000, &pixelsUs));
+    EXPECT_EQ(0xff00ff00u, pixel(frame, 0));
+    EXPECT_EQ(2000, pixelsUs);
+
+    //停止时取出最后读入、尚未输出的一帧，只取一次
+    ASSERT_TRUE(reader.flush(0, frame.data(), &pixelsUs));
+    EXPECT_EQ(0xffff0000u, pixel(frame, 0));
+    EXPECT_EQ(3000, pixelsUs);
+    EXPECT_FALSE(reader.flush(0, frame.data(), &pixelsUs));
+    EXPECT_FALSE(reader.flush(1, frame.data(), &pixelsUs));
+
+    //第一帧同步读回后没有待输出的画面
+    ASSERT_TRUE(reader.readFramebuffer(2, fbo, width, height, frame.data(), 4000, &pixelsUs));
+    EXPECT_FALSE(reader.flush(2, frame.data(), &pixelsUs));
+
+    reader.release();
+    EXPECT_FALSE(reader.flush(0, frame.data(), &pixelsUs));
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &texture);
+}
+
+TEST_F(EglDmaBufReaderTest, resizeRestartsReadback)
+{
+    GLuint texture = 0;
+    GLuint fbo = createTarget(4, 4, 0xff111111u, texture);
+    std::vector<unsigned char> frame(8 * 2 * 4);
+
+    EglDmaBufReader reader;
+    reader.setContext(m_display, m_context);
+    ASSERT_TRUE(reader.readFramebuffer(0, fbo, 4, 4, frame.data()));
+    ASSERT_TRUE(reader.readFramebuffer(0, fbo, 4, 4, frame.data()));
+
+    //尺寸变化后不再输出旧尺寸的画面
+    fill(texture, 8, 2, 0xff222222u);
+    ASSERT_TRUE(reader.readFramebuffer(0, fbo, 8, 2, frame.data()));
+    EXPECT_EQ(0xff222222u, pixel(frame, 15));
+
+    reader.release();
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &texture);
+}
+
+TEST_F(EglDmaBufReaderTest, reuseImportAcrossFds)
+{
+    //导出纹理得到 dma-buf，模拟合成器送来的缓冲区；驱动不支持导入导出时跳过
+    const char *extensions = eglQueryString(m_display, EGL_EXTENSIONS);
+    if (!strstr(extensions, "EGL_EXT_image_dma_buf_import") || !strstr(extensions, "EGL_MESA_image_dma_buf_export")) {
+        GTEST_SKIP() << "dma-buf import/export unsupported";
+    }
+    const int width = 16;
+    const int height = 8;
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    fill(texture, width, height, 0xff336699u);
+    EGLImageKHR image = eglCreateImageKHR(m_display, m_context, EGL_GL_TEXTURE_2D_KHR,
+                                          reinterpret_cast<EGLClientBuffer>(static_cast<uintptr_t>(texture)), nullptr);
+    ASSERT_NE(EGL_NO_IMAGE_KHR, image);
+    int fourcc = 0;
+    int planes = 0;
+    ASSERT_TRUE(eglExportDMABUFImageQueryMESA(m_display, image, &fourcc, &planes, nullptr));
+    int fd = -1;
+    EGLint stride = 0;
+    EGLint offset = 0;
+    ASSERT_TRUE(eglExportDMABUFImageMESA(m_display, image, &fd, &stride, &offset));
+    glFinish();
+
+    std::vector<unsigned char> frame(static_cast<size_t>(width) * height * 4);
+    EglDmaBufReader reader;
+    reader.setContext(m_display, m_context);
+    ASSERT_TRUE(reader.read(0, fd, width, height, static_cast<uint32_t>(stride), static_cast<uint32_t>(fourcc), frame.data()));
+    EXPECT_EQ(0xff336699u, pixel(frame, 0));
+    int next = dup(fd);
+    ASSERT_TRUE(reader.read(0, next, width, height, static_cast<uint32_t>(stride), static_cast<uint32_t>(fourcc), frame.data()));
+    if (DmaBufMapCache::hasStableIdentity(fd)) {
+        EXPECT_EQ(1u, reader.importTotal());
+        EXPECT_EQ(1u, reader.hitCount());
+        EXPECT_EQ(1, reader.importCount());
+    } else {
+        //5.3 之前的内核无法按 inode 区分 dma-buf，每帧重新导入，不保留导入
+        EXPECT_EQ(2u, reader.importTotal());
+        EXPECT_EQ(0u, reader.hitCount());
+        EXPECT_EQ(0, reader.importCount());
+    }
+
+    reader.release();
+    EXPECT_EQ(0, reader.importCount());
+    close(next);
+    close(fd);
+    eglDestroyImageKHR(m_display, image);
+    glDeleteTextures(1, &texture);
+}
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <string>
+
+#include "../../src/waylandrecord/fragmentoptions.h"
+
+using namespace testing;
+
+static std::string fragmentOption(const FragmentOptions::Options &options, const std::string &key)
+{
+    for (const auto &option : options) {
+        if (option.first == key) {
+            return option.second;
+        }
+    }
+    return std::string();
+}
+
+TEST(FragmentOptionsTest, clampSeconds)
+{
+    EXPECT_EQ(0, FragmentOptions::clampSeconds(-1));
+    EXPECT_EQ(0, FragmentOptions::clampSeconds(0));
+    EXPECT_EQ(FragmentOptions::DefaultSeconds, FragmentOptions::clampSeconds(FragmentOptions::DefaultSeconds));
+    EXPECT_EQ(FragmentOptions::MaxSeconds, FragmentOptions::clampSeconds(FragmentOptions::MaxSeconds));
+    EXPECT_EQ(FragmentOptions::MaxSeconds, FragmentOptions::clampSeconds(1000));
+}
+
+TEST(FragmentOptionsTest, disabledSetsNothing)
+{
+    //关闭分段时不设置任何封装参数
+    EXPECT_TRUE(FragmentOptions::muxOptions(false, 0).empty());
+    EXPECT_TRUE(FragmentOptions::muxOptions(true, 0).empty());
+    EXPECT_TRUE(FragmentOptions::muxOptions(false, -3).empty());
+}
+
+TEST(FragmentOptionsTest, mp4Fragments)
+{
+    const FragmentOptions::Options options = FragmentOptions::muxOptions(false, 2);
+    ASSERT_EQ(3u, options.size());
+    EXPECT_EQ("frag_keyframe+empty_moov+default_base_moof", fragmentOption(options, "movflags"));
+    EXPECT_EQ("2000000", fragmentOption(options, "min_frag_duration"));
+    EXPECT_EQ("1", fragmentOption(options, "flush_packets"));
+    EXPECT_TRUE(fragmentOption(options, "cluster_time_limit").empty());
+    //最大间隔的微秒数不溢出
+    EXPECT_EQ("60000000", fragmentOption(FragmentOptions::muxOptions(false, FragmentOptions::MaxSeconds), "min_frag_duration"));
+}
+
+TEST(FragmentOptionsTest, mkvClusters)
+{
+    const FragmentOptions::Options options = FragmentOptions::muxOptions(true, 3);
+    ASSERT_EQ(2u, options.size());
+    EXPECT_EQ("3000", fragmentOption(options, "cluster_time_limit"));
+    EXPECT_EQ("1", fragmentOption(options, "flush_packets"));
+    EXPECT_TRUE(fragmentOption(options, "movflags").empty());
+    EXPECT_TRUE(fragmentOption(options, "min_frag_duration").empty());
+}
@@ -0,0 +1,171 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "../../src/waylandrecord/framecompositor.h"
+
+using namespace testing;
+
+class FrameCompositorTest : public testing::Test
+{
+public:
+    FrameCompositor *m_compositor;
+
+    virtual void SetUp() override
+    {
+        m_compositor = new FrameCompositor();
+    }
+
+    virtual void TearDown() override
+    {
+        delete m_compositor;
+    }
+
+    static uint32_t pixelAt(const FrameCompositor *compositor, int x, int y)
+    {
+        uint32_t p;
+        memcpy(&p, compositor->data() + y * compositor->stride() + x * 4, 4);
+        return p;
+    }
+};
+
+TEST_F(FrameCompositorTest, resize)
+{
+    EXPECT_FALSE(m_compositor->resize(0, 10, FrameCompositor::RGBA));
+    ASSERT_TRUE(m_compositor->resize(8, 4, FrameCompositor::RGBA));
+    EXPECT_EQ(8, m_compositor->width());
+    EXPECT_EQ(4, m_compositor->height());
+    EXPECT_EQ(32, m_compositor->stride());
+    //新画布为不透明的黑色
+    EXPECT_EQ(0xff000000u, pixelAt(m_compositor, 7, 3));
+    //尺寸不变时不重新分配
+    unsigned char *canvas = m_compositor->data();
+    EXPECT_TRUE(m_compositor->resize(8, 4, FrameCompositor::RGBA));
+    EXPECT_EQ(canvas, m_compositor->data());
+}
+
+TEST_F(FrameCompositorTest, blitSameOrder)
+{
+    ASSERT_TRUE(m_compositor->resize(8, 4, FrameCompositor::RGBA));
+    //源画面每行带 8 字节填充
+    std::vector<uint32_t> src(6 * 2, 0);
+    for (int y = 0; y < 2; y++) {
+        for (int x = 0; x < 4; x++) {
+            src[y * 6 + x] = 0x11223300u + static_cast<uint32_t>(y * 4 + x);
+        }
+    }
+    EXPECT_TRUE(m_compositor->blit(1, reinterpret_cast<unsigned char *>(src.data()), 4, 2, 24,
+                                   FrameCompositor::RGBA, false, 4, 1));
+    EXPECT_EQ(0x11223300u, pixelAt(m_compositor, 4, 1));
+    EXPECT_EQ(0x11223307u, pixelAt(m_compositor, 7, 2));
+    EXPECT_EQ(0xff000000u, pixelAt(m_compositor, 3, 1));
+    EXPECT_EQ(0xff000000u, pixelAt(m_compositor, 4, 3));
+}
+
+TEST_F(FrameCompositorTest, blitSwizzle)
+{
+    ASSERT_TRUE(m_compositor->resize(37, 2, FrameCompositor::BGRA));
+    //宽度 37 覆盖向量化部分和逐像素的尾部
+    std::vector<unsigned char> src(37 * 4 * 2);
+    for (size_t i = 0; i < src.size(); i += 4) {
+        src[i] = 0x10;      // R
+        src[i + 1] = 0x20;  // G
+        src[i + 2] = 0x30;  // B
+        src[i + 3] = 0x00;  // X
+    }
+    EXPECT_TRUE(m_compositor->blit(1, src.data(), 37, 2, 37 * 4, FrameCompositor::RGBA, true, 0, 0));
+    for (int x = 0; x < 37; x++) {
+        const unsigned char *p = m_compositor->data() + 37 * 4 + x * 4;
+        EXPECT_EQ(0x30, p[0]);
+        EXPECT_EQ(0x20, p[1]);
+        EXPECT_EQ(0x10, p[2]);
+        EXPECT_EQ(0xff, p[3]);
+    }
+}
+
+TEST_F(FrameCompositorTest, copyRowOpaque)
+{
+    std::vector<uint32_t> src(19, 0x00445566u);
+    std::vector<uint32_t> dst(19, 0);
+    FrameCompositor::copyRow(reinterpret_cast<unsigned char *>(dst.data()),
+                             reinterpret_cast<unsigned char *>(src.data()), 19, true);
+    for (uint32_t p : dst) {
+        EXPECT_EQ(0xff445566u, p);
+    }
+}
+
+TEST_F(FrameCompositorTest, clipToCanvas)
+{
+    ASSERT_TRUE(m_compositor->resize(4, 4, FrameCompositor::RGBA));
+    std::vector<uint32_t> src(4 * 4, 0x12345678u);
+    EXPECT_TRUE(m_compositor->blit(1, reinterpret_cast<unsigned char *>(src.data()), 4, 4, 16,
+                                   FrameCompositor::RGBA, false, 2, -2));
+    EXPECT_EQ(0x12345678u, pixelAt(m_compositor, 3, 1));
+    EXPECT_EQ(0xff000000u, pixelAt(m_compositor, 1, 1));
+    EXPECT_EQ(0xff000000u, pixelAt(m_compositor, 3, 2));
+    EXPECT_FALSE(m_compositor->blit(1, reinterpret_cast<unsigned char *>(src.data()), 4, 4, 16,
+                                    FrameCompositor::RGBA, false, 8, 0));
+}
+
+TEST_F(FrameCompositorTest, skipUnchanged)
+{
+    ASSERT_TRUE(m_compositor->resize(4, 2, FrameCompositor::RGBA));
+    std::vector<uint32_t> src(2 * 2, 0x01020304u);
+    unsigned char *data = reinterpret_cast<unsigned char *>(src.data());
+    EXPECT_TRUE(m_compositor->blit(7, data, 2, 2, 8, FrameCompositor::RGBA, false, 0, 0));
+    EXPECT_TRUE(m_compositor->blit(7, data, 2, 2, 8, FrameCompositor::RGBA, false, 2, 0));
+    //同一位置代数未变化时跳过
+    src[0] = 0u;
+    EXPECT_FALSE(m_compositor->blit(7, data, 2, 2, 8, FrameCompositor::RGBA, false, 0, 0));
+    EXPECT_EQ(0x01020304u, pixelAt(m_compositor, 0, 0));
+    EXPECT_EQ(1u, m_compositor->skippedCount());
+    EXPECT_TRUE(m_compositor->blit(8, data, 2, 2, 8, FrameCompositor::RGBA, false, 0, 0));
+    EXPECT_EQ(0u, pixelAt(m_compositor, 0, 0));
+    //invalidate 后必定重新拷贝
+    m_compositor->invalidate();
+    EXPECT_EQ(0xff000000u, pixelAt(m_compositor, 0, 0));
+    EXPECT_TRUE(m_compositor->blit(8, data, 2, 2, 8, FrameCompositor::RGBA, false, 0, 0));
+    EXPECT_EQ(4u, m_compositor->blittedCount());
+}
+
+TEST_F(FrameCompositorTest, benchmarkDual4K)
+{
+    //两块 4K 屏幕左右拼接，一块与画布像素顺序相同，一块需要交换 R、B 通道
+    static constexpr int ScreenWidth = 3840;
+    static constexpr int ScreenHeight = 2160;
+    static constexpr int Frames = 20;
+    ASSERT_TRUE(m_compositor->resize(ScreenWidth * 2, ScreenHeight, FrameCompositor::BGRA));
+    std::vector<unsigned char> left(static_cast<size_t>(ScreenWidth) * ScreenHeight * 4, 0x40);
+    std::vector<unsigned char> right(static_cast<size_t>(ScreenWidth) * ScreenHeight * 4, 0x80);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < Frames; i++) {
+        m_compositor->blit(static_cast<uint64_t>(i), left.data(), ScreenWidth, ScreenHeight, ScreenWidth * 4,
+                           FrameCompositor::BGRA, false, 0, 0);
+        m_compositor->blit(static_cast<uint64_t>(i), right.data(), ScreenWidth, ScreenHeight, ScreenWidth * 4,
+                           FrameCompositor::RGBA, true, ScreenWidth, 0);
+    }
+    double changedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / Frames;
+
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < Frames; i++) {
+        m_compositor->blit(static_cast<uint64_t>(Frames), left.data(), ScreenWidth, ScreenHeight, ScreenWidth * 4,
+                           FrameCompositor::BGRA, false, 0, 0);
+        m_compositor->blit(static_cast<uint64_t>(Frames), right.data(), ScreenWidth, ScreenHeight, ScreenWidth * 4,
+                           FrameCompositor::RGBA, true, ScreenWidth, 0);
+    }
+    double unchangedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / Frames;
+
+    std::cout << "[ benchmark ] 2x4K composite: " << changedMs << " ms/frame changed, "
+              << unchangedMs << " ms/frame unchanged" << std::endl;
+    EXPECT_EQ(0x80, m_compositor->data()[ScreenWidth * 4]);
+    EXPECT_EQ(0xff, m_compositor->data()[ScreenWidth * 4 + 3]);
+    EXPECT_LT(unchangedMs, changedMs);
+}
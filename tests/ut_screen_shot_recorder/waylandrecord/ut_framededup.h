@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "../../src/waylandrecord/framededup.h"
+
+using namespace testing;
+
+class FrameDedupTest : public testing::Test
+{
+public:
+    static std::vector<unsigned char> makeFrame(int height, int stride, unsigned char value)
+    {
+        return std::vector<unsigned char>(static_cast<size_t>(stride) * height, value);
+    }
+};
+
+TEST_F(FrameDedupTest, identicalFramesSkipped)
+{
+    FrameDedup dedup;
+    std::vector<unsigned char> frame = makeFrame(70, 400, 0x40);
+    EXPECT_TRUE(dedup.accept(frame.data(), 100, 70, 400, 0));
+    EXPECT_EQ(4, dedup.tileCount());
+    EXPECT_FALSE(dedup.accept(frame.data(), 100, 70, 400, 1));
+    EXPECT_FALSE(dedup.accept(frame.data(), 100, 70, 400, 2));
+    EXPECT_EQ(3u, dedup.checkedCount());
+    EXPECT_EQ(2u, dedup.skippedCount());
+    EXPECT_EQ(0, dedup.lastChangedTiles());
+}
+
+TEST_F(FrameDedupTest, singlePixelChange)
+{
+    //右下角不满 64x64 的分块中改动一个字节
+    FrameDedup dedup;
+    std::vector<unsigned char> frame = makeFrame(70, 416, 0x10);
+    EXPECT_TRUE(dedup.accept(frame.data(), 100, 70, 416, 0));
+    frame[69 * 416 + 99 * 4 + 2] ^= 1;
+    EXPECT_TRUE(dedup.accept(frame.data(), 100, 70, 416, 1));
+    EXPECT_EQ(1, dedup.lastChangedTiles());
+    //行尾填充的字节不属于画面
+    frame[10 * 416 + 405] ^= 0xff;
+    EXPECT_FALSE(dedup.accept(frame.data(), 100, 70, 416, 2));
+}
+
+TEST_F(FrameDedupTest, sourceUnchangedSkipsHashing)
+{
+    FrameDedup dedup;
+    std::vector<unsigned char> frame = makeFrame(64, 256, 0);
+    EXPECT_TRUE(dedup.accept(frame.data(), 64, 64, 256, 0, true));
+    frame[0] = 1;
+    //采集端声明没有新画面时不再比较内容
+    EXPECT_FALSE(dedup.accept(frame.data(), 64, 64, 256, 1, false));
+    EXPECT_TRUE(dedup.accept(frame.data(), 64, 64, 256, 2, true));
+}
+
+TEST_F(FrameDedupTest, keepAliveInterval)
+{
+    FrameDedup dedup;
+    dedup.setMaxInterval(1000);
+    std::vector<unsigned char> frame = makeFrame(32, 128, 7);
+    EXPECT_TRUE(dedup.accept(frame.data(), 32, 32, 128, 0));
+    EXPECT_FALSE(dedup.accept(frame.data(), 32, 32, 128, 500));
+    EXPECT_FALSE(dedup.accept(frame.data(), 32, 32, 128, 999, false));
+    EXPECT_TRUE(dedup.accept(frame.data(), 32, 32, 128, 1000, false));
+    EXPECT_FALSE(dedup.accept(frame.data(), 32, 32, 128, 1500));
+}
+
+TEST_F(FrameDedupTest, sizeChangeAndDisable)
+{
+    FrameDedup dedup;
+    std::vector<unsigned char> frame = makeFrame(128, 512, 3);
+    EXPECT_TRUE(dedup.accept(frame.data(), 128, 128, 512, 0));
+    EXPECT_TRUE(dedup.accept(frame.data(), 64, 128, 512, 1));
+    dedup.setEnabled(false);
+    EXPECT_TRUE(dedup.accept(frame.data(), 64, 128, 512, 2));
+    dedup.reset();
+    dedup.setEnabled(true);
+    EXPECT_EQ(0u, dedup.skippedCount());
+    EXPECT_TRUE(dedup.accept(frame.data(), 64, 128, 512, 3));
+}
+
+TEST_F(FrameDedupTest, benchmark)
+{
+    const int sizes[][2] = {{1920, 1080}, {3840, 2160}};
+    for (const auto &size : sizes) {
+        const int stride = size[0] * 4;
+        std::vector<unsigned char> frame = makeFrame(size[1], stride, 0x5a);
+        FrameDedup dedup;
+        dedup.accept(frame.data(), size[0], size[1], stride, 0);
+        static constexpr int Frames = 20;
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 1; i <= Frames; i++) {
+            EXPECT_FALSE(dedup.accept(frame.data(), size[0], size[1], stride, i));
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / Frames;
+        std::cout << "[ benchmark ] tile hash " << size[0] << "x" << size[1] << " " << ms << "ms" << std::endl;
+    }
+}
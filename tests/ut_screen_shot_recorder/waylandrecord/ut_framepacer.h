@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "../../src/waylandrecord/framepacer.h"
+
+using namespace testing;
+
+class FramePacerTest : public testing::Test
+{
+public:
+    FramePacer *m_pacer;
+    //模拟时钟（纳秒），睡眠直接把时间推进到截止时间
+    int64_t m_nowNs = 0;
+    //每次睡眠的截止时间
+    std::vector<int64_t> m_deadlines;
+
+    virtual void SetUp() override
+    {
+        m_pacer = new FramePacer();
+        m_nowNs = 1000000000LL;
+        m_pacer->setClock([this] { return m_nowNs; },
+                          [this](int64_t deadlineNs) {
+                              m_deadlines.push_back(deadlineNs);
+                              if (deadlineNs > m_nowNs) {
+                                  m_nowNs = deadlineNs;
+                              }
+                          });
+    }
+
+    virtual void TearDown() override
+    {
+        delete m_pacer;
+    }
+
+    //模拟处理一帧的耗时
+    void process(int64_t ns)
+    {
+        m_nowNs += ns;
+    }
+};
+
+TEST_F(FramePacerTest, start)
+{
+    m_pacer->start(50);
+    EXPECT_EQ(50, m_pacer->targetFps());
+    EXPECT_EQ(20000000, m_pacer->periodNs());
+    EXPECT_EQ(0u, m_pacer->tickCount());
+    EXPECT_DOUBLE_EQ(0.0, m_pacer->achievedFps());
+
+    m_pacer->start(0);
+    EXPECT_EQ(1, m_pacer->targetFps());
+}
+
+TEST_F(FramePacerTest, holdsTargetRate)
+{
+    m_pacer->start(100);
+    const int64_t begin = m_nowNs;
+    for (int i = 0; i < 31; i++) {
+        EXPECT_TRUE(m_pacer->waitNextTick());
+    }
+    //第一个节拍立即到期，31 个节拍跨越 30 个周期
+    EXPECT_EQ(begin + 30 * 10000000LL, m_nowNs);
+    ASSERT_EQ(30u, m_deadlines.size());
+    for (size_t i = 0; i < m_deadlines.size(); i++) {
+        EXPECT_EQ(begin + static_cast<int64_t>(i + 1) * 10000000LL, m_deadlines[i]);
+    }
+    EXPECT_EQ(31u, m_pacer->tickCount());
+    EXPECT_DOUBLE_EQ(100.0, m_pacer->achievedFps());
+}
+
+TEST_F(FramePacerTest, processingTimeDoesNotDrift)
+{
+    //每帧处理耗时小于周期时，截止时间仍是 start + n * period，不会像 msleep 那样逐帧累加
+    m_pacer->start(50);
+    const int64_t begin = m_nowNs;
+    for (int i = 0; i < 11; i++) {
+        EXPECT_TRUE(m_pacer->waitNextTick());
+        EXPECT_EQ(begin + i * 20000000LL, m_nowNs);
+        process(8000000);
+    }
+    ASSERT_EQ(10u, m_deadlines.size());
+    EXPECT_EQ(begin + 10 * 20000000LL, m_deadlines.back());
+    EXPECT_EQ(0u, m_pacer->lateCount());
+    EXPECT_EQ(0u, m_pacer->skippedCount());
+    EXPECT_DOUBLE_EQ(50.0, m_pacer->achievedFps());
+}
+
+TEST_F(FramePacerTest, lateAndSkippedTicks)
+{
+    m_pacer->start(100);
+    const int64_t begin = m_nowNs;
+    EXPECT_TRUE(m_pacer->waitNextTick());
+    //处理耗时 35ms，错过了 10ms 的截止时间以及 20ms、30ms 两个完整周期
+    process(35000000);
+    EXPECT_FALSE(m_pacer->waitNextTick());
+    EXPECT_TRUE(m_deadlines.empty());
+    EXPECT_EQ(1u, m_pacer->lateCount());
+    EXPECT_EQ(2u, m_pacer->skippedCount());
+    //跳过后重新对齐到原有节拍网格，下一个节拍是 40ms
+    EXPECT_TRUE(m_pacer->waitNextTick());
+    ASSERT_EQ(1u, m_deadlines.size());
+    EXPECT_EQ(begin + 40000000LL, m_deadlines[0]);
+    EXPECT_EQ(1u, m_pacer->lateCount());
+
+    //恰好在截止时间醒来仍算按时
+    process(10000000);
+    EXPECT_TRUE(m_pacer->waitNextTick());
+    EXPECT_EQ(begin + 50000000LL, m_deadlines.back());
+    EXPECT_EQ(1u, m_pacer->lateCount());
+    EXPECT_EQ(2u, m_pacer->skippedCount());
+}
+
+TEST_F(FramePacerTest, realClockSleepsUntilDeadline)
+{
+    //默认时钟只检查睡眠不会早于截止时间，不对调度延迟设上限
+    FramePacer pacer;
+    pacer.start(100);
+    const int64_t begin = FramePacer::monotonicNs();
+    for (int i = 0; i < 4; i++) {
+        pacer.waitNextTick();
+    }
+    EXPECT_GE(FramePacer::monotonicNs() - begin, 3 * pacer.periodNs());
+    EXPECT_EQ(4u, pacer.tickCount());
+}
+
+TEST_F(FramePacerTest, markDuplicate)
+{
+    m_pacer->start(30);
+    m_pacer->markDuplicate();
+    m_pacer->markDuplicate();
+    EXPECT_EQ(2u, m_pacer->duplicateCount());
+    m_pacer->start(30);
+    EXPECT_EQ(0u, m_pacer->duplicateCount());
+}
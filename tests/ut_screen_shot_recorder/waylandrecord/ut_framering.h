@@ -0,0 +1,391 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <time.h>
+
+#include "../../src/waylandrecord/framering.h"
+
+using namespace testing;
+
+class FrameRingTest : public testing::Test
+{
+public:
+    static constexpr int kWidth = 8;
+    static constexpr int kHeight = 4;
+    static constexpr int kStride = kWidth * 4;
+    static constexpr int kFrameBytes = kHeight * kStride;
+
+    FrameRing *m_ring;
+    std::vector<unsigned char> m_src;
+    std::vector<unsigned char> m_dst;
+
+    virtual void SetUp() override
+    {
+        m_ring = new FrameRing();
+        m_src.assign(kFrameBytes, 0);
+        m_dst.assign(kFrameBytes, 0);
+    }
+
+    virtual void TearDown() override
+    {
+        delete m_ring;
+    }
+
+    bool pushValue(unsigned char value, int64_t time)
+    {
+        std::fill(m_src.begin(), m_src.end(), value);
+        return m_ring->push(m_src.data(), kWidth, kHeight, kStride, time);
+    }
+
+    bool popValue(unsigned char &value, int64_t &time)
+    {
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+        if (!m_ring->pop(m_dst.data(), width, height, stride, time)) {
+            return false;
+        }
+        value = m_dst[0];
+        return width == kWidth && height == kHeight && stride == kStride && m_dst[kFrameBytes - 1] == value;
+    }
+};
+
+TEST_F(FrameRingTest, initAndRelease)
+{
+    EXPECT_FALSE(m_ring->isInit());
+    EXPECT_FALSE(m_ring->init(0, kFrameBytes));
+    EXPECT_FALSE(m_ring->init(1, kFrameBytes));
+    EXPECT_FALSE(m_ring->init(4, 0));
+    EXPECT_TRUE(m_ring->init(4, kFrameBytes));
+    EXPECT_TRUE(m_ring->isInit());
+    EXPECT_EQ(4, m_ring->capacity());
+    EXPECT_TRUE(m_ring->isEmpty());
+    m_ring->release();
+    EXPECT_FALSE(m_ring->isInit());
+    EXPECT_FALSE(pushValue(1, 1));
+}
+
+TEST_F(FrameRingTest, pushPopFifo)
+{
+    ASSERT_TRUE(m_ring->init(4, kFrameBytes));
+    EXPECT_TRUE(pushValue(1, 100));
+    EXPECT_TRUE(pushValue(2, 200));
+    EXPECT_EQ(2, m_ring->size());
+
+    unsigned char value = 0;
+    int64_t time = 0;
+    EXPECT_TRUE(popValue(value, time));
+    EXPECT_EQ(1, value);
+    EXPECT_EQ(100, time);
+    EXPECT_TRUE(popValue(value, time));
+    EXPECT_EQ(2, value);
+    EXPECT_EQ(200, time);
+    EXPECT_FALSE(popValue(value, time));
+    EXPECT_TRUE(m_ring->isEmpty());
+}
+
+TEST_F(FrameRingTest, rejectOversizedFrame)
+{
+    ASSERT_TRUE(m_ring->init(2, kFrameBytes - 1));
+    EXPECT_FALSE(pushValue(1, 1));
+    EXPECT_TRUE(m_ring->isEmpty());
+}
+
+TEST_F(FrameRingTest, pushRegion)
+{
+    //从 16x8 的整屏画面中截取 (4, 2) 起 8x4 的区域
+    static constexpr int kScreenStride = 16 * 4;
+    std::vector<unsigned char> screen(kScreenStride * 8);
+    for (size_t i = 0; i < screen.size(); i++) {
+        screen[i] = static_cast<unsigned char>(i / kScreenStride * 16 + i % kScreenStride / 4);
+    }
+    ASSERT_TRUE(m_ring->init(2, kFrameBytes));
+    const unsigned char *origin = screen.data() + 2 * kScreenStride + 4 * 4;
+    EXPECT_FALSE(m_ring->push(origin, kWidth, kHeight, kStride, 1, kStride - 4));
+    ASSERT_TRUE(m_ring->push(origin, kWidth, kHeight, kStride, 1, kScreenStride));
+
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    int64_t time = 0;
+    ASSERT_TRUE(m_ring->pop(m_dst.data(), width, height, stride, time));
+    EXPECT_EQ(kStride, stride);
+    for (int y = 0; y < kHeight; y++) {
+        for (int x = 0; x < kWidth; x++) {
+            EXPECT_EQ((y + 2) * 16 + x + 4, m_dst[y * kStride + x * 4]);
+        }
+    }
+}
+
+TEST_F(FrameRingTest, dropOldest)
+{
+    ASSERT_TRUE(m_ring->init(3, kFrameBytes, FrameRing::DropOldest));
+    for (int i = 1; i <= 5; i++) {
+        EXPECT_TRUE(pushValue(static_cast<unsigned char>(i), i));
+    }
+    EXPECT_EQ(3, m_ring->size());
+    EXPECT_EQ(2u, m_ring->droppedCount());
+
+    unsigned char value = 0;
+    int64_t time = 0;
+    for (int i = 3; i <= 5; i++) {
+        EXPECT_TRUE(popValue(value, time));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_TRUE(m_ring->isEmpty());
+}
+
+TEST_F(FrameRingTest, dropNewest)
+{
+    ASSERT_TRUE(m_ring->init(3, kFrameBytes, FrameRing::DropNewest));
+    for (int i = 1; i <= 3; i++) {
+        EXPECT_TRUE(pushValue(static_cast<unsigned char>(i), i));
+    }
+    EXPECT_FALSE(pushValue(4, 4));
+    EXPECT_EQ(1u, m_ring->droppedCount());
+
+    unsigned char value = 0;
+    int64_t time = 0;
+    for (int i = 1; i <= 3; i++) {
+        EXPECT_TRUE(popValue(value, time));
+        EXPECT_EQ(i, value);
+    }
+}
+
+TEST_F(FrameRingTest, blockKeepsEveryFrame)
+{
+    ASSERT_TRUE(m_ring->init(4, kFrameBytes, FrameRing::Block));
+    const int frameCount = 2000;
+    std::thread producer([this, frameCount]() {
+        std::vector<unsigned char> src(kFrameBytes);
+        for (int i = 0; i < frameCount; i++) {
+            std::fill(src.begin(), src.end(), static_cast<unsigned char>(i));
+            m_ring->push(src.data(), kWidth, kHeight, kStride, i);
+        }
+    });
+
+    int received = 0;
+    bool ordered = true;
+    while (received < frameCount) {
+        unsigned char value = 0;
+        int64_t time = 0;
+        if (popValue(value, time)) {
+            ordered = ordered && time == received && value == static_cast<unsigned char>(received);
+            received++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(0u, m_ring->droppedCount());
+    EXPECT_EQ(static_cast<uint64_t>(frameCount), m_ring->pushedCount());
+}
+
+TEST_F(FrameRingTest, dropOldestConcurrent)
+{
+    ASSERT_TRUE(m_ring->init(4, kFrameBytes, FrameRing::DropOldest));
+    const int frameCount = 5000;
+    std::atomic<bool> finished(false);
+    std::thread producer([this, frameCount, &finished]() {
+        std::vector<unsigned char> src(kFrameBytes);
+        for (int i = 1; i <= frameCount; i++) {
+            std::fill(src.begin(), src.end(), static_cast<unsigned char>(i));
+            m_ring->push(src.data(), kWidth, kHeight, kStride, i);
+        }
+        finished = true;
+    });
+
+    int64_t lastTime = 0;
+    bool ordered = true;
+    bool intact = true;
+    uint64_t received = 0;
+    while (true) {
+        unsigned char value = 0;
+        int64_t time = 0;
+        if (popValue(value, time)) {
+            //丢帧时时间戳仍应单调递增，且帧内容不能被写了一半
+            ordered = ordered && time > lastTime;
+            intact = intact && value == static_cast<unsigned char>(time);
+            lastTime = time;
+            received++;
+        } else if (finished && m_ring->isEmpty()) {
+            break;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(intact);
+    EXPECT_EQ(static_cast<uint64_t>(frameCount), received + m_ring->droppedCount());
+}
+
+TEST_F(FrameRingTest, leaseReadsSlotWithoutCopy)
+{
+    ASSERT_TRUE(m_ring->init(2, kFrameBytes));
+    EXPECT_TRUE(pushValue(7, 700));
+
+    FrameRing::Lease lease;
+    ASSERT_TRUE(m_ring->acquire(lease));
+    EXPECT_TRUE(lease.isValid());
+    EXPECT_NE(m_src.data(), lease.data());
+    EXPECT_EQ(7, lease.data()[0]);
+    EXPECT_EQ(7, lease.data()[kFrameBytes - 1]);
+    EXPECT_EQ(kWidth, lease.width());
+    EXPECT_EQ(kHeight, lease.height());
+    EXPECT_EQ(kStride, lease.stride());
+    EXPECT_EQ(700, lease.time());
+    EXPECT_FALSE(m_ring->acquire(lease));
+    EXPECT_FALSE(lease.isValid());
+}
+
+TEST_F(FrameRingTest, leaseBlocksOverwriteUntilReleased)
+{
+    ASSERT_TRUE(m_ring->init(3, kFrameBytes, FrameRing::DropOldest));
+    EXPECT_TRUE(pushValue(1, 1));
+    EXPECT_TRUE(pushValue(2, 2));
+
+    {
+        FrameRing::Lease lease;
+        ASSERT_TRUE(m_ring->acquire(lease));
+        EXPECT_TRUE(pushValue(3, 3));
+        //租借中的槽位不能被覆盖，只能丢弃新帧
+        EXPECT_FALSE(pushValue(4, 4));
+        EXPECT_EQ(1, lease.data()[0]);
+    }
+
+    EXPECT_TRUE(pushValue(5, 5));
+    unsigned char value = 0;
+    int64_t time = 0;
+    EXPECT_TRUE(popValue(value, time));
+    EXPECT_EQ(2, value);
+    EXPECT_TRUE(popValue(value, time));
+    EXPECT_EQ(3, value);
+    EXPECT_TRUE(popValue(value, time));
+    EXPECT_EQ(5, value);
+    EXPECT_FALSE(popValue(value, time));
+}
+
+TEST_F(FrameRingTest, leaseMove)
+{
+    ASSERT_TRUE(m_ring->init(2, kFrameBytes, FrameRing::DropOldest));
+    EXPECT_TRUE(pushValue(1, 1));
+
+    FrameRing::Lease first;
+    ASSERT_TRUE(m_ring->acquire(first));
+    FrameRing::Lease second(std::move(first));
+    EXPECT_FALSE(first.isValid());
+    EXPECT_TRUE(second.isValid());
+    EXPECT_TRUE(pushValue(2, 2));
+    EXPECT_FALSE(pushValue(3, 3));
+
+    second.release();
+    EXPECT_TRUE(pushValue(4, 4));
+}
+
+TEST_F(FrameRingTest, waitForFrameTimeout)
+{
+    ASSERT_TRUE(m_ring->init(2, kFrameBytes));
+    auto begin = std::chrono::steady_clock::now();
+    EXPECT_FALSE(m_ring->waitForFrame(50));
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+    EXPECT_GE(elapsed.count(), 40);
+
+    EXPECT_TRUE(pushValue(1, 1));
+    EXPECT_TRUE(m_ring->waitForFrame(50));
+}
+
+TEST_F(FrameRingTest, waitForFrameWakesOnPush)
+{
+    ASSERT_TRUE(m_ring->init(2, kFrameBytes));
+    std::thread producer([this]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        pushValue(1, 1);
+    });
+    auto begin = std::chrono::steady_clock::now();
+    EXPECT_TRUE(m_ring->waitForFrame(5000));
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+    EXPECT_LT(elapsed.count(), 2000);
+    producer.join();
+}
+
+TEST_F(FrameRingTest, closeDrainsAndWakesConsumer)
+{
+    ASSERT_TRUE(m_ring->init(4, kFrameBytes));
+    EXPECT_TRUE(pushValue(1, 1));
+    EXPECT_TRUE(pushValue(2, 2));
+
+    //消费者按 waitForFrame 驱动的循环取帧，close 后取完剩余帧立即退出
+    std::atomic<int> received(0);
+    std::thread consumer([this, &received]() {
+        std::vector<unsigned char> dst(kFrameBytes);
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+        int64_t time = 0;
+        while (m_ring->waitForFrame(5000)) {
+            if (m_ring->pop(dst.data(), width, height, stride, time)) {
+                received++;
+            }
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto begin = std::chrono::steady_clock::now();
+    m_ring->close();
+    consumer.join();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+    EXPECT_LT(elapsed.count(), 2000);
+    EXPECT_EQ(2, received);
+    EXPECT_TRUE(m_ring->isClosed());
+    EXPECT_FALSE(pushValue(3, 3));
+
+    m_ring->reopen();
+    EXPECT_TRUE(pushValue(3, 3));
+}
+
+TEST_F(FrameRingTest, closeWakesBlockedProducer)
+{
+    ASSERT_TRUE(m_ring->init(2, kFrameBytes, FrameRing::Block));
+    EXPECT_TRUE(pushValue(1, 1));
+    EXPECT_TRUE(pushValue(2, 2));
+
+    std::atomic<bool> pushed(true);
+    std::thread producer([this, &pushed]() {
+        std::vector<unsigned char> src(kFrameBytes, 3);
+        pushed = m_ring->push(src.data(), kWidth, kHeight, kStride, 3);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    m_ring->close();
+    producer.join();
+    EXPECT_FALSE(pushed);
+}
+
+TEST_F(FrameRingTest, idleConsumerCostsNoCpu)
+{
+    ASSERT_TRUE(m_ring->init(2, kFrameBytes));
+    //空闲的环形缓冲区上，消费者线程应阻塞等待而不是空转
+    std::atomic<long> cpuNs(0);
+    std::thread consumer([this, &cpuNs]() {
+        timespec begin;
+        timespec end;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &begin);
+        while (!m_ring->isClosed()) {
+            m_ring->waitForFrame(20);
+        }
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+        cpuNs = (end.tv_sec - begin.tv_sec) * 1000000000L + (end.tv_nsec - begin.tv_nsec);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    m_ring->close();
+    consumer.join();
+    //500ms 墙钟时间内 CPU 占用应低于 5%
+    EXPECT_LT(cpuNs.load(), 25L * 1000 * 1000);
+}
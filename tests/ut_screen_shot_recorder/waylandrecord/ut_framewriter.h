@@ -0,0 +1,167 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "../../src/waylandrecord/framewriter.h"
+#include "../../src/utils/recordingstats.h"
+
+using namespace testing;
+
+class FrameWriterTest : public testing::Test
+{
+public:
+    static constexpr int kWidth = 8;
+    static constexpr int kHeight = 4;
+    static constexpr int kStride = kWidth * 4;
+    static constexpr int kFrameBytes = kHeight * kStride;
+
+    FrameRing m_ring;
+    std::vector<unsigned char> m_src;
+    //写入编码器的每帧的首字节和序号
+    std::vector<unsigned char> m_values;
+    std::vector<int> m_indexes;
+
+    virtual void SetUp() override
+    {
+        m_src.assign(kFrameBytes, 0);
+        RecordingStats::instance()->reset();
+    }
+
+    virtual void TearDown() override
+    {
+        m_ring.release();
+    }
+
+    bool pushValue(unsigned char value, int64_t time)
+    {
+        std::fill(m_src.begin(), m_src.end(), value);
+        return m_ring.push(m_src.data(), kWidth, kHeight, kStride, time);
+    }
+
+    //模拟编码器：记录画面，返回 result
+    FrameWriter::WriteFunc recorder(int result = 0)
+    {
+        return [this, result](WaylandFrame &frame) {
+            m_values.push_back(frame._frame[0]);
+            m_indexes.push_back(frame._index);
+            return result;
+        };
+    }
+};
+
+//原 WaylandIntegrationPrivate::getFrame 的行为：缓冲区为空时不给出画面
+TEST_F(FrameWriterTest, acquireFromEmptyRing)
+{
+    ASSERT_TRUE(m_ring.init(2, kFrameBytes));
+    WaylandFrame frame;
+    frame._width = kWidth;
+    frame._height = kHeight;
+    frame._frame = m_src.data();
+    FrameRing::Lease lease;
+    int index = 5;
+    EXPECT_FALSE(FrameWriter::acquire(m_ring, lease, frame, index));
+    EXPECT_FALSE(lease.isValid());
+    EXPECT_EQ(nullptr, frame._frame);
+    EXPECT_EQ(0, frame._width);
+    EXPECT_EQ(0, frame._height);
+    EXPECT_EQ(5, index);
+}
+
+TEST_F(FrameWriterTest, acquireOldestFrame)
+{
+    ASSERT_TRUE(m_ring.init(4, kFrameBytes));
+    ASSERT_TRUE(pushValue(1, 100));
+    ASSERT_TRUE(pushValue(2, 200));
+    WaylandFrame frame;
+    FrameRing::Lease lease;
+    int index = 0;
+    ASSERT_TRUE(FrameWriter::acquire(m_ring, lease, frame, index));
+    EXPECT_TRUE(lease.isValid());
+    EXPECT_EQ(kWidth, frame._width);
+    EXPECT_EQ(kHeight, frame._height);
+    EXPECT_EQ(kStride, frame._stride);
+    EXPECT_EQ(100, frame._time);
+    EXPECT_EQ(0, frame._index);
+    EXPECT_EQ(1, index);
+    //直接引用槽位内存，不拷贝
+    EXPECT_EQ(lease.data(), frame._frame);
+    EXPECT_EQ(1, frame._frame[kFrameBytes - 1]);
+
+    ASSERT_TRUE(FrameWriter::acquire(m_ring, lease, frame, index));
+    EXPECT_EQ(200, frame._time);
+    EXPECT_EQ(1, frame._index);
+    EXPECT_EQ(2, index);
+}
+
+TEST_F(FrameWriterTest, writeReleasesSlot)
+{
+    ASSERT_TRUE(m_ring.init(2, kFrameBytes, FrameRing::DropNewest));
+    ASSERT_TRUE(pushValue(1, 100));
+    ASSERT_TRUE(pushValue(2, 200));
+    EXPECT_FALSE(pushValue(3, 300));
+    WaylandFrame frame;
+    FrameRing::Lease lease;
+    int index = 0;
+    ASSERT_TRUE(FrameWriter::acquire(m_ring, lease, frame, index));
+    EXPECT_TRUE(FrameWriter::write(recorder(), frame, lease));
+    EXPECT_FALSE(lease.isValid());
+    //写完后槽位归还给采集端
+    EXPECT_TRUE(pushValue(3, 300));
+    EXPECT_EQ(std::vector<unsigned char>({1}), m_values);
+    EXPECT_EQ(0u, RecordingStats::instance()->counter(RecordingStats::EncodeFailed));
+}
+
+TEST_F(FrameWriterTest, failedWriteCountsEncodeFailed)
+{
+    ASSERT_TRUE(m_ring.init(2, kFrameBytes));
+    ASSERT_TRUE(pushValue(7, 100));
+    WaylandFrame frame;
+    FrameRing::Lease lease;
+    int index = 0;
+    ASSERT_TRUE(FrameWriter::acquire(m_ring, lease, frame, index));
+    EXPECT_FALSE(FrameWriter::write(recorder(-1), frame, lease));
+    //写入失败同样归还槽位
+    EXPECT_FALSE(lease.isValid());
+    EXPECT_TRUE(m_ring.isEmpty());
+    EXPECT_EQ(1u, RecordingStats::instance()->counter(RecordingStats::EncodeFailed));
+}
+
+//与 WriteFrameThread::run 相同的循环：等待新帧、取帧、写帧，采集端 close 后取完剩余的帧再退出
+TEST_F(FrameWriterTest, writeLoopDrainsRingInOrder)
+{
+    const int frames = 200;
+    ASSERT_TRUE(m_ring.init(4, kFrameBytes, FrameRing::Block));
+    const FrameWriter::WriteFunc writeFrame = recorder();
+    std::thread writer([&]() {
+        WaylandFrame frame;
+        FrameRing::Lease lease;
+        int index = 0;
+        for (;;) {
+            if (!m_ring.waitForFrame(100)) {
+                if (m_ring.isClosed() && m_ring.isEmpty()) {
+                    break;
+                }
+                continue;
+            }
+            if (FrameWriter::acquire(m_ring, lease, frame, index)) {
+                FrameWriter::write(writeFrame, frame, lease);
+            }
+        }
+    });
+    for (int i = 0; i < frames; i++) {
+        EXPECT_TRUE(pushValue(static_cast<unsigned char>(i), i));
+    }
+    m_ring.close();
+    writer.join();
+
+    ASSERT_EQ(static_cast<size_t>(frames), m_values.size());
+    for (int i = 0; i < frames; i++) {
+        EXPECT_EQ(static_cast<unsigned char>(i), m_values[i]);
+        EXPECT_EQ(i, m_indexes[i]);
+    }
+}
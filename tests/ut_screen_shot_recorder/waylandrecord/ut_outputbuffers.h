@@ -0,0 +1,258 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <cstring>
+#include <QList>
+
+#include "../../src/waylandrecord/outputbuffers.h"
+
+using namespace testing;
+
+/**
+ * @brief 模拟 processBufferHw 采集到一帧：写入暂存缓冲后发布
+ */
+static void captureOutput(OutputBuffers::Map &buffers, quint32 key, const QRect &rect, unsigned char value)
+{
+    const size_t bytes = static_cast<size_t>(rect.width()) * rect.height() * 4;
+    bool reallocated = false;
+    unsigned char *staging = OutputBuffers::staging(buffers, key, bytes, reallocated);
+    memset(staging, value, bytes);
+    OutputBuffer &buffer = OutputBuffers::publish(buffers, key);
+    buffer._rect = rect;
+    buffer._width = static_cast<quint32>(rect.width());
+    buffer._height = static_cast<quint32>(rect.height());
+    buffer._stride = static_cast<quint32>(rect.width()) * 4;
+}
+
+/**
+ * @brief 模拟 appendFrameToList 合成一帧：所有输出拼齐时清除待合成标记
+ * @return 是否合成
+ */
+static bool compositeOutputs(OutputBuffers::Map &buffers, int expected)
+{
+    if (OutputBuffers::readyCount(buffers) < expected) {
+        return false;
+    }
+    for (auto itr = buffers.begin(); itr != buffers.end(); ++itr) {
+        itr->_ready = false;
+    }
+    return true;
+}
+
+TEST(OutputBuffersTest, expectedCount)
+{
+    EXPECT_EQ(1, OutputBuffers::expectedCount(1, false));
+    EXPECT_EQ(1, OutputBuffers::expectedCount(1, true));
+    //复制模式所有屏幕画面相同，只用一个输出
+    EXPECT_EQ(1, OutputBuffers::expectedCount(3, false));
+    EXPECT_EQ(3, OutputBuffers::expectedCount(3, true));
+    EXPECT_EQ(4, OutputBuffers::expectedCount(4, true));
+}
+
+TEST(OutputBuffersTest, unboundOutputsKeyedByGeometry)
+{
+    //四个输出中前三个已绑定，第四个未经 addOutput/bindOutput 绑定
+    int outputs[4] = {0, 0, 0, 0};
+    QHash<const void *, quint32> names;
+    names.insert(&outputs[0], 31);
+    names.insert(&outputs[1], 32);
+    names.insert(&outputs[2], 33);
+    const QRect geometries[4] = {QRect(0, 0, 1920, 1080), QRect(1920, 0, 1920, 1080),
+                                 QRect(3840, 0, 1280, 1024), QRect(0, 1080, 2560, 1440)};
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(static_cast<quint32>(31 + i), OutputBuffers::outputKey(names, &outputs[i], geometries[i]));
+    }
+
+    const quint32 unbound = OutputBuffers::outputKey(names, &outputs[3], geometries[3]);
+    EXPECT_NE(0u, unbound & 0x80000000u);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_NE(static_cast<quint32>(31 + i), unbound);
+    }
+    //同一位置的键值稳定，只由位置决定，与尺寸无关
+    EXPECT_EQ(unbound, OutputBuffers::outputKey(names, &outputs[3], geometries[3]));
+    EXPECT_EQ(unbound, OutputBuffers::outputKey(names, &outputs[3], QRect(0, 1080, 1920, 1080)));
+
+    //多个未绑定的输出按位置区分
+    QHash<const void *, quint32> empty;
+    QList<quint32> keys;
+    for (int i = 0; i < 4; i++) {
+        const quint32 key = OutputBuffers::outputKey(empty, &outputs[i], geometries[i]);
+        EXPECT_NE(0u, key & 0x80000000u);
+        EXPECT_FALSE(keys.contains(key)) << "output " << i;
+        keys.append(key);
+    }
+}
+
+TEST(OutputBuffersTest, threeOutputsCarryOverLastFrame)
+{
+    const QRect rects[3] = {QRect(0, 0, 8, 4), QRect(8, 0, 8, 4), QRect(16, 0, 6, 4)};
+    const int expected = OutputBuffers::expectedCount(3, true);
+    OutputBuffers::Map buffers;
+
+    //还没有采集到画面的输出不能沿用
+    for (quint32 key = 1; key <= 3; key++) {
+        EXPECT_EQ(nullptr, OutputBuffers::reuseLast(buffers, key));
+    }
+    EXPECT_EQ(0, OutputBuffers::readyCount(buffers));
+
+    captureOutput(buffers, 1, rects[0], 0x11);
+    captureOutput(buffers, 2, rects[1], 0x22);
+    EXPECT_EQ(2, OutputBuffers::readyCount(buffers));
+    EXPECT_FALSE(compositeOutputs(buffers, expected));
+    captureOutput(buffers, 3, rects[2], 0x33);
+    EXPECT_EQ(3, OutputBuffers::readyCount(buffers));
+    ASSERT_TRUE(compositeOutputs(buffers, expected));
+    EXPECT_EQ(0, OutputBuffers::readyCount(buffers));
+
+    //下一轮只有输出 2 送来新画面，另外两个沿用上一帧
+    const quint64 serial1 = buffers[1]._serial;
+    const quint64 serial3 = buffers[3]._serial;
+    captureOutput(buffers, 2, rects[1], 0x44);
+    EXPECT_FALSE(compositeOutputs(buffers, expected));
+    const OutputBuffer *reused = OutputBuffers::reuseLast(buffers, 1);
+    ASSERT_NE(nullptr, reused);
+    EXPECT_EQ(rects[0], reused->_rect);
+    EXPECT_EQ(0x11, reused->_published[0]);
+    ASSERT_NE(nullptr, OutputBuffers::reuseLast(buffers, 3));
+    EXPECT_EQ(3, OutputBuffers::readyCount(buffers));
+    //沿用的画面代数不变，合成时跳过拷贝
+    EXPECT_EQ(serial1, buffers[1]._serial);
+    EXPECT_EQ(serial3, buffers[3]._serial);
+    EXPECT_EQ(0x44, buffers[2]._published[0]);
+    EXPECT_TRUE(compositeOutputs(buffers, expected));
+
+    //重复沿用不会让一个输出计数两次
+    OutputBuffers::reuseLast(buffers, 1);
+    OutputBuffers::reuseLast(buffers, 1);
+    EXPECT_EQ(1, OutputBuffers::readyCount(buffers));
+    OutputBuffers::release(buffers);
+    EXPECT_TRUE(buffers.isEmpty());
+}
+
+TEST(OutputBuffersTest, fourOutputsWaitForSlowOutput)
+{
+    const QRect rects[4] = {QRect(0, 0, 4, 2), QRect(4, 0, 4, 2), QRect(0, 2, 4, 2), QRect(4, 2, 4, 2)};
+    const int expected = OutputBuffers::expectedCount(4, true);
+    OutputBuffers::Map buffers;
+    for (quint32 key = 0; key < 3; key++) {
+        captureOutput(buffers, key, rects[key], static_cast<unsigned char>(key));
+    }
+    //第四个输出还没有画面，其余三个沿用也拼不齐
+    for (quint32 key = 0; key < 4; key++) {
+        OutputBuffers::reuseLast(buffers, key);
+    }
+    EXPECT_EQ(3, OutputBuffers::readyCount(buffers));
+    EXPECT_FALSE(compositeOutputs(buffers, expected));
+
+    captureOutput(buffers, 3, rects[3], 3);
+    EXPECT_EQ(4, OutputBuffers::readyCount(buffers));
+    EXPECT_TRUE(compositeOutputs(buffers, expected));
+
+    //移除一个输出后它不再沿用，也不参与计数，直到重新采集到画面
+    OutputBuffers::drop(buffers, 2);
+    for (quint32 key = 0; key < 4; key++) {
+        OutputBuffers::reuseLast(buffers, key);
+    }
+    EXPECT_EQ(3, OutputBuffers::readyCount(buffers));
+    EXPECT_TRUE(compositeOutputs(buffers, OutputBuffers::expectedCount(3, true)));
+    captureOutput(buffers, 2, rects[2], 2);
+    EXPECT_EQ(1, OutputBuffers::readyCount(buffers));
+    OutputBuffers::release(buffers);
+}
+
+TEST(OutputBuffersTest, reallocateOnlyOnResolutionChange)
+{
+    OutputBuffers::Map buffers;
+    bool reallocated = false;
+    unsigned char *first = OutputBuffers::staging(buffers, 7, 64, reallocated);
+    EXPECT_TRUE(reallocated);
+    ASSERT_NE(nullptr, first);
+    OutputBuffers::publish(buffers, 7);
+    //暂存和发布的两块缓冲交替使用，稳态下不再分配
+    unsigned char *second = OutputBuffers::staging(buffers, 7, 64, reallocated);
+    EXPECT_FALSE(reallocated);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(first, buffers[7]._published);
+    OutputBuffers::publish(buffers, 7);
+    EXPECT_EQ(first, OutputBuffers::staging(buffers, 7, 64, reallocated));
+    EXPECT_FALSE(reallocated);
+    OutputBuffers::publish(buffers, 7);
+    EXPECT_TRUE(buffers[7]._hasFrame);
+
+    //另一个输出分辨率改变时重新分配，旧画面不能再沿用
+    captureOutput(buffers, 8, QRect(0, 0, 4, 4), 0x55);
+    const quint64 serial = buffers[8]._serial;
+    OutputBuffers::staging(buffers, 8, 8 * 8 * 4, reallocated);
+    EXPECT_TRUE(reallocated);
+    EXPECT_EQ(static_cast<size_t>(8 * 8 * 4), buffers[8]._bytes);
+    EXPECT_FALSE(buffers[8]._ready);
+    EXPECT_EQ(nullptr, OutputBuffers::reuseLast(buffers, 8));
+    EXPECT_EQ(1, OutputBuffers::readyCount(buffers));
+    captureOutput(buffers, 8, QRect(0, 0, 8, 8), 0x66);
+    EXPECT_EQ(serial + 1, buffers[8]._serial);
+    EXPECT_EQ(0x66, buffers[8]._published[8 * 8 * 4 - 1]);
+    //未变化的输出不受影响
+    EXPECT_EQ(static_cast<size_t>(64), buffers[7]._bytes);
+    EXPECT_TRUE(buffers[7]._hasFrame);
+    OutputBuffers::release(buffers);
+}
+
+TEST(OutputBuffersTest, leasedFrameSurvivesCapture)
+{
+    const QRect rect(0, 0, 4, 2);
+    const size_t bytes = static_cast<size_t>(rect.width()) * rect.height() * 4;
+    OutputBuffers::Map buffers;
+    EXPECT_EQ(nullptr, OutputBuffers::lease(buffers, 0));
+    captureOutput(buffers, 0, rect, 0x11);
+
+    //取帧线程租用画面后在锁外读取，采集线程继续写入不会覆盖它
+    const OutputBuffer *leased = OutputBuffers::lease(buffers, 0);
+    ASSERT_NE(nullptr, leased);
+    const unsigned char *frame = leased->_leased;
+    EXPECT_EQ(buffers[0]._published, frame);
+    //同一输出同时只能有一个租用
+    EXPECT_EQ(nullptr, OutputBuffers::lease(buffers, 0));
+    for (unsigned char value = 0x20; value < 0x25; value++) {
+        captureOutput(buffers, 0, rect, value);
+        EXPECT_NE(frame, buffers[0]._staging);
+        EXPECT_EQ(value, buffers[0]._published[0]);
+    }
+    for (size_t i = 0; i < bytes; i++) {
+        ASSERT_EQ(0x11, frame[i]) << "byte " << i;
+    }
+    OutputBuffers::endLease(buffers, 0);
+
+    //归还后再次租用得到最新画面，三块缓冲轮换，不再分配
+    leased = OutputBuffers::lease(buffers, 0);
+    ASSERT_NE(nullptr, leased);
+    EXPECT_EQ(0x24, leased->_leased[0]);
+    const unsigned char *spare = buffers[0]._spare;
+    captureOutput(buffers, 0, rect, 0x30);
+    captureOutput(buffers, 0, rect, 0x31);
+    EXPECT_EQ(0x24, leased->_leased[0]);
+    OutputBuffers::endLease(buffers, 0);
+    EXPECT_TRUE(spare == buffers[0]._staging || spare == buffers[0]._published || spare == buffers[0]._spare);
+    OutputBuffers::release(buffers);
+}
+
+TEST(OutputBuffersTest, reallocateWhileLeased)
+{
+    OutputBuffers::Map buffers;
+    captureOutput(buffers, 5, QRect(0, 0, 4, 4), 0x42);
+    const OutputBuffer *leased = OutputBuffers::lease(buffers, 5);
+    ASSERT_NE(nullptr, leased);
+    const unsigned char *frame = leased->_leased;
+
+    //分辨率改变时被租用的旧缓冲保留到归还
+    captureOutput(buffers, 5, QRect(0, 0, 8, 8), 0x43);
+    EXPECT_EQ(frame, buffers[5]._retired);
+    EXPECT_EQ(0x42, frame[4 * 4 * 4 - 1]);
+    EXPECT_EQ(0x43, buffers[5]._published[0]);
+    OutputBuffers::endLease(buffers, 5);
+    EXPECT_EQ(nullptr, buffers[5]._retired);
+    EXPECT_EQ(nullptr, buffers[5]._leased);
+    OutputBuffers::release(buffers);
+}
@@ -0,0 +1,168 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "../../src/waylandrecord/reusepool.h"
+
+using namespace testing;
+
+namespace {
+//模拟 AVFrame：被编码器引用时不可写
+struct PoolFrame {
+    int id;
+    bool referenced;
+};
+}
+
+TEST(ReusePoolTest, steadyStateReusesFrames)
+{
+    ReusePool<PoolFrame *> pool(4);
+    std::vector<PoolFrame *> created;
+    const auto isFree = [](PoolFrame *frame) {
+        return !frame->referenced;
+    };
+    const auto create = [&created](PoolFrame *&frame) {
+        frame = new PoolFrame{static_cast<int>(created.size()), false};
+        created.push_back(frame);
+        return true;
+    };
+    int copies = 0;
+    const auto makeFree = [&copies](PoolFrame *&frame) {
+        copies++;
+        frame->referenced = false;
+        return true;
+    };
+
+    //混音每次取麦克风、系统音频各一帧，编码器立即释放引用：第一次建立后不再申请
+    PoolFrame *frame = nullptr;
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(pool.acquire(frame, isFree, create, makeFree));
+        frame->referenced = true;
+        frame->referenced = false;
+    }
+    EXPECT_EQ(1, pool.size());
+    EXPECT_EQ(1u, pool.allocCount());
+
+    //编码器最多积压两帧时池中只有三帧
+    std::vector<PoolFrame *> inFlight;
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(pool.acquire(frame, isFree, create, makeFree));
+        frame->referenced = true;
+        inFlight.push_back(frame);
+        if (inFlight.size() > 2) {
+            inFlight.front()->referenced = false;
+            inFlight.erase(inFlight.begin());
+        }
+    }
+    EXPECT_EQ(3, pool.size());
+    EXPECT_EQ(3u, pool.allocCount());
+    EXPECT_EQ(0, copies);
+
+    pool.resetAllocCount();
+    EXPECT_EQ(0u, pool.allocCount());
+    pool.clear([](PoolFrame *&pooled) {
+        delete pooled;
+        pooled = nullptr;
+    });
+    EXPECT_EQ(0, pool.size());
+}
+
+TEST(ReusePoolTest, exhaustedPoolCopiesFront)
+{
+    ReusePool<PoolFrame *> pool(2);
+    std::vector<PoolFrame> frames(2, PoolFrame{0, false});
+    size_t next = 0;
+    const auto isFree = [](PoolFrame *frame) {
+        return !frame->referenced;
+    };
+    const auto create = [&frames, &next](PoolFrame *&frame) {
+        frame = &frames[next++];
+        return true;
+    };
+    const auto makeFree = [](PoolFrame *&frame) {
+        frame->referenced = false;
+        return true;
+    };
+    PoolFrame *first = nullptr;
+    PoolFrame *frame = nullptr;
+    ASSERT_TRUE(pool.acquire(first, isFree, create, makeFree));
+    first->referenced = true;
+    ASSERT_TRUE(pool.acquire(frame, isFree, create, makeFree));
+    frame->referenced = true;
+    EXPECT_NE(first, frame);
+    //池满且都被引用时让第一帧重新可写，计入申请次数
+    ASSERT_TRUE(pool.acquire(frame, isFree, create, makeFree));
+    EXPECT_EQ(first, frame);
+    EXPECT_EQ(2, pool.size());
+    EXPECT_EQ(3u, pool.allocCount());
+
+    //创建失败时不放入池中
+    ReusePool<PoolFrame *> failing(2);
+    frame = nullptr;
+    EXPECT_FALSE(failing.acquire(frame, isFree, [](PoolFrame *&) {
+        return false;
+    }, makeFree));
+    EXPECT_EQ(nullptr, frame);
+    EXPECT_EQ(0, failing.size());
+    EXPECT_EQ(0u, failing.allocCount());
+}
+
+TEST(ReusePoolTest, growCapacityOnlyWhenNeeded)
+{
+    int capacity = 0;
+    std::vector<int> grows;
+    const auto grow = [&grows](int needed) {
+        grows.push_back(needed);
+        return true;
+    };
+    //重采样输出样本数略有波动，只在超过容量时重新申请
+    const int samples[] = {1024, 1024, 1030, 1024, 1030, 512, 1030};
+    for (int needed : samples) {
+        EXPECT_TRUE(growCapacity(capacity, needed, grow));
+        EXPECT_GE(capacity, needed);
+    }
+    EXPECT_EQ((std::vector<int>{1024, 1030}), grows);
+    EXPECT_EQ(1030, capacity);
+
+    EXPECT_FALSE(growCapacity(capacity, 2048, [](int) {
+        return false;
+    }));
+    EXPECT_EQ(0, capacity);
+}
+
+TEST(ReusePoolTest, videoWrapperAllocatedOncePerRecording)
+{
+    //视频路径的 RGB 包装帧不持有像素内存，总是可复用
+    ReusePool<PoolFrame *> pool(1);
+    int allocated = 0;
+    const auto always = [](PoolFrame *) {
+        return true;
+    };
+    const auto create = [&allocated](PoolFrame *&frame) {
+        frame = new PoolFrame{allocated++, false};
+        return true;
+    };
+    const auto destroy = [](PoolFrame *&frame) {
+        delete frame;
+        frame = nullptr;
+    };
+    for (int recording = 0; recording < 2; recording++) {
+        pool.resetAllocCount();
+        PoolFrame *frame = nullptr;
+        PoolFrame *first = nullptr;
+        for (int i = 0; i < 600; i++) {
+            ASSERT_TRUE(pool.acquire(frame, always, create, always));
+            if (nullptr == first) {
+                first = frame;
+            }
+            EXPECT_EQ(first, frame);
+        }
+        EXPECT_EQ(1u, pool.allocCount());
+        pool.clear(destroy);
+    }
+    EXPECT_EQ(2, allocated);
+}
@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../../src/waylandrecord/slicepool.h"
+#include "../../src/utils/i420converter.h"
+
+using namespace testing;
+
+TEST(SlicePoolTest, sliceRangeCoversAllRows)
+{
+    static constexpr int Height = 1081;
+    for (int slices = 1; slices <= 6; slices++) {
+        int expectedY = 0;
+        for (int i = 0; i < slices; i++) {
+            int y = -1;
+            int rows = -1;
+            SlicePool::sliceRange(Height, slices, i, 2, y, rows);
+            EXPECT_EQ(expectedY, y);
+            //除最后一个条带外，起始行和行数都为偶数
+            EXPECT_EQ(0, y % 2);
+            if (i + 1 < slices) {
+                EXPECT_EQ(0, rows % 2);
+            }
+            expectedY += rows;
+        }
+        EXPECT_EQ(Height, expectedY);
+    }
+    int y = 0;
+    int rows = 0;
+    SlicePool::sliceRange(Height, 4, 4, 2, y, rows);
+    EXPECT_EQ(0, rows);
+}
+
+TEST(SlicePoolTest, runAllSlices)
+{
+    SlicePool pool(4);
+    EXPECT_EQ(4, pool.threadCount());
+    for (int round = 0; round < 50; round++) {
+        std::vector<int> hits(7, 0);
+        pool.run(7, [&hits](int index) {
+            hits[static_cast<size_t>(index)]++;
+        });
+        for (int hit : hits) {
+            EXPECT_EQ(1, hit);
+        }
+    }
+}
+
+TEST(SlicePoolTest, runInParallel)
+{
+    SlicePool pool(3);
+    std::atomic<int> running(0);
+    std::atomic<int> peak(0);
+    pool.run(3, [&](int) {
+        int now = ++running;
+        int expected = peak.load();
+        while (now > expected && !peak.compare_exchange_weak(expected, now)) {
+        }
+        //等待其它条带开始，最多 1 秒
+        for (int i = 0; i < 1000 && peak.load() < 3; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        --running;
+    });
+    EXPECT_EQ(3, peak.load());
+}
+
+TEST(SlicePoolTest, singleThread)
+{
+    SlicePool pool(0);
+    EXPECT_EQ(1, pool.threadCount());
+    const std::thread::id caller = std::this_thread::get_id();
+    int count = 0;
+    pool.run(3, [&](int) {
+        EXPECT_EQ(caller, std::this_thread::get_id());
+        count++;
+    });
+    EXPECT_EQ(3, count);
+    EXPECT_GE(SlicePool::defaultThreadCount(), 1);
+    EXPECT_LE(SlicePool::defaultThreadCount(), 4);
+}
+
+TEST(SlicePoolTest, slicedI420MatchesWholeFrame)
+{
+    //与 CAVOutputStream::convertVideoFrame 相同的分段方式：偶数行条带，各条带并行转换
+    const int sizes[][2] = {{64, 36}, {50, 21}, {1920, 1080}, {33, 7}, {8, 1}};
+    std::mt19937 rng(5);
+    for (const auto &size : sizes) {
+        const int width = size[0];
+        const int height = size[1];
+        const int stride = width * 4 + 16;
+        std::vector<uint8_t> rgb(static_cast<size_t>(stride) * height);
+        for (uint8_t &byte : rgb) {
+            byte = static_cast<uint8_t>(rng());
+        }
+        std::vector<uint8_t> whole(I420Converter::bufferSize(width, height), 0xcd);
+        ASSERT_TRUE(I420Converter::convert(rgb.data(), stride, I420Converter::RGBA, width, height,
+                                           I420Converter::packedPlanes(whole.data(), width, height)));
+        for (int threads = 1; threads <= 4; threads++) {
+            SlicePool pool(threads);
+            std::vector<uint8_t> sliced(whole.size(), 0xcd);
+            const I420Converter::Planes planes = I420Converter::packedPlanes(sliced.data(), width, height);
+            pool.run(threads, [&](int index) {
+                int y = 0;
+                int rows = 0;
+                SlicePool::sliceRange(height, threads, index, 2, y, rows);
+                if (rows <= 0) {
+                    return;
+                }
+                I420Converter::convert(rgb.data() + static_cast<size_t>(y) * stride, stride, I420Converter::RGBA,
+                                       width, rows, I420Converter::slicePlanes(planes, y));
+            });
+            EXPECT_EQ(whole, sliced) << width << "x" << height << " threads " << threads;
+        }
+    }
+}
@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: 2022-2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+#include "../../src/waylandrecord/stagequeue.h"
+
+using namespace testing;
+
+TEST(StageQueueTest, fifoOrder)
+{
+    StageQueue<int> queue(3);
+    EXPECT_EQ(3u, queue.capacity());
+    for (int round = 0; round < 4; round++) {
+        EXPECT_TRUE(queue.push(round * 10 + 1));
+        EXPECT_TRUE(queue.push(round * 10 + 2));
+        int value = 0;
+        EXPECT_TRUE(queue.pop(value));
+        EXPECT_EQ(round * 10 + 1, value);
+        EXPECT_TRUE(queue.pop(value));
+        EXPECT_EQ(round * 10 + 2, value);
+    }
+    EXPECT_EQ(0u, queue.depth());
+    EXPECT_EQ(2u, queue.maxDepth());
+}
+
+TEST(StageQueueTest, closeDrains)
+{
+    StageQueue<int> queue(2);
+    EXPECT_TRUE(queue.push(1));
+    queue.close();
+    EXPECT_FALSE(queue.push(2));
+    int value = 0;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(1, value);
+    EXPECT_FALSE(queue.pop(value));
+    //reset 之后重新可用
+    queue.reset(2);
+    EXPECT_TRUE(queue.push(3));
+}
+
+TEST(StageQueueTest, fullQueueBlocksProducer)
+{
+    StageQueue<int> queue(1);
+    EXPECT_TRUE(queue.push(1));
+    std::thread consumer([&queue] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        int value = 0;
+        queue.pop(value);
+    });
+    EXPECT_TRUE(queue.push(2));
+    consumer.join();
+    EXPECT_EQ(1u, queue.blockedPushCount());
+}
+
+TEST(StageQueueTest, closeWakesBlockedConsumer)
+{
+    StageQueue<int> queue(1);
+    std::thread closer([&queue] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        queue.close();
+    });
+    int value = 0;
+    EXPECT_FALSE(queue.pop(value));
+    closer.join();
+}
+
+TEST(StageQueueTest, stageStats)
+{
+    StageStats stats;
+    stats.record(100, 1000);
+    stats.record(300, 3000);
+    stats.setDepth(2);
+    stats.setDepth(1);
+    EXPECT_EQ(2u, stats.count());
+    EXPECT_EQ(200, stats.averageWaitNs());
+    EXPECT_EQ(300, stats.maxWaitNs());
+    EXPECT_EQ(2000, stats.averageProcessNs());
+    EXPECT_EQ(3000, stats.maxProcessNs());
+    EXPECT_EQ(1u, stats.depth());
+    EXPECT_EQ(2u, stats.maxDepth());
+    stats.reset();
+    EXPECT_EQ(0u, stats.count());
+    EXPECT_EQ(0, stats.averageWaitNs());
+}
+
+TEST(StageQueueTest, pipelineThroughput)
+{
+    //三级各耗时 4ms：串行处理每帧 12ms，流水线后每帧约 4ms
+    static constexpr int Frames = 30;
+    static constexpr int StageMs = 4;
+    StageQueue<int> encodeQueue(2);
+    StageQueue<int> muxQueue(2);
+    auto work = [] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(StageMs));
+    };
+    auto begin = std::chrono::steady_clock::now();
+    std::thread encoder([&] {
+        int value = 0;
+        while (encodeQueue.pop(value)) {
+            work();
+            muxQueue.push(value);
+        }
+        muxQueue.close();
+    });
+    int muxed = 0;
+    std::thread muxer([&] {
+        int value = 0;
+        while (muxQueue.pop(value)) {
+            work();
+            EXPECT_EQ(muxed, value);
+            muxed++;
+        }
+    });
+    for (int i = 0; i < Frames; i++) {
+        work();
+        encodeQueue.push(i);
+    }
+    encodeQueue.close();
+    encoder.join();
+    muxer.join();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    EXPECT_EQ(Frames, muxed);
+    EXPECT_LT(ms, Frames * StageMs * 3 * 0.6);
+}
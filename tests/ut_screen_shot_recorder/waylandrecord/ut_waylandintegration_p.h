@@ -133,19 +133,20 @@ QPixmap grabEntireDesktop()
     return g_tempPixmap;
 
 }
-void appendBuffer_stub(unsigned char *frame, int width, int height, int stride, int64_t time)
+void appendBuffer_stub(const unsigned char *frame, int width, int height, int stride, int64_t time, int srcStride)
 {
     Q_UNUSED(frame);
     Q_UNUSED(width);
     Q_UNUSED(height);
     Q_UNUSED(stride);
     Q_UNUSED(time);
+    Q_UNUSED(srcStride);
 
 }
 
 //无法构造出KWayland::Client::RemoteBuffer 相关数据
 //ACCESS_PRIVATE_FUN(WaylandIntegrationPrivate, void(const KWayland::Client::RemoteBuffer *rbuf), processBuffer);
-//ACCESS_PRIVATE_FUN(WaylandIntegrationPrivate, void(unsigned char *frame, int width, int height, int stride, int64_t time), appendBuffer);
+//ACCESS_PRIVATE_FUN(WaylandIntegrationPrivate, void(const unsigned char *frame, int width, int height, int stride, int64_t time, int srcStride), appendBuffer);
 //TEST_F(WaylandIntegrationPrivateTest, processBuffer)
 //{
 
@@ -223,7 +224,7 @@ TEST_F(WaylandIntegrationPrivateTest, setupRegistry)
     stub.reset(ADDR(KWayland::Client::Registry, setup));
 }
 
-//ACCESS_PRIVATE_FUN(WaylandIntegrationPrivate, void(unsigned char *frame, int width, int height, int stride, int64_t time), appendBuffer);
+//ACCESS_PRIVATE_FUN(WaylandIntegrationPrivate, void(const unsigned char *frame, int width, int height, int stride, int64_t time, int srcStride), appendBuffer);
 //ACCESS_PRIVATE_FIELD(WaylandIntegrationPrivate, unsigned char *, m_ffmFrame);
 //ACCESS_PRIVATE_FIELD(WaylandIntegrationPrivate, QList<unsigned char *>, m_freeList);
 //ACCESS_PRIVATE_FIELD(WaylandIntegrationPrivate, QList<WaylandIntegrationPrivate::waylandFrame>, m_waylandList);
@@ -272,7 +273,9 @@ TEST_F(WaylandIntegrationPrivateTest, setupRegistry)
 TEST_F(WaylandIntegrationPrivateTest, getFrame)
 {
     WaylandIntegrationPrivate::waylandFrame frame;
-    m_waylandIntegrationPrivate->getFrame(frame);
+    FrameRing::Lease lease;
+    EXPECT_FALSE(m_waylandIntegrationPrivate->getFrame(frame, lease));
+    EXPECT_FALSE(lease.isValid());
 
 }
 
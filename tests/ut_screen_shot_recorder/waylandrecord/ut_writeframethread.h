@@ -58,10 +58,15 @@ bool isWriteVideo_stub()
         return false;
     }
 }
-bool getFrame_stub(WaylandIntegration::WaylandIntegrationPrivate::waylandFrame &frame)
+bool getFrame_stub(WaylandIntegration::WaylandIntegrationPrivate::waylandFrame &frame, FrameRing::Lease &lease)
 {
     return true;
 }
+bool waitForFrame_stub(int timeoutMs)
+{
+    Q_UNUSED(timeoutMs);
+    return true;
+}
 int writeVideoFrame_stub(WaylandIntegration::WaylandIntegrationPrivate::waylandFrame &frame)
 {
     return 1;
@@ -71,6 +76,7 @@ TEST_F(WriteFrameThreadTest, run)
 {
     stub.set(ADDR(WaylandIntegration::WaylandIntegrationPrivate, isWriteVideo), isWriteVideo_stub);
     stub.set(ADDR(WaylandIntegration::WaylandIntegrationPrivate, getFrame), getFrame_stub);
+    stub.set(ADDR(WaylandIntegration::WaylandIntegrationPrivate, waitForFrame), waitForFrame_stub);
     stub.set(ADDR(CAVOutputStream, writeVideoFrame), writeVideoFrame_stub);
 
     auto &WriteFrameThread_m_context = access_private_field::WriteFrameThreadm_context(*m_writeFrameThread);
@@ -88,6 +94,7 @@ TEST_F(WriteFrameThreadTest, run)
 
     stub.reset(ADDR(WaylandIntegration::WaylandIntegrationPrivate, isWriteVideo));
     stub.reset(ADDR(WaylandIntegration::WaylandIntegrationPrivate, getFrame));
+    stub.reset(ADDR(WaylandIntegration::WaylandIntegrationPrivate, waitForFrame));
     stub.reset(ADDR(CAVOutputStream, writeVideoFrame));
 
 //    delete WriteFrameThread_m_context->m_recordAdmin;